@@ -0,0 +1,106 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+using namespace std;
+
+#include <pthread.h>
+
+#include "gtest.h"
+
+#include "avrdevice.h"
+#include "atmega16_32.h"
+#include "avrerror.h"
+#include "helper.h"
+#include "flash.h"
+#include "simulationcontext.h"
+
+//! A device with trace on, which runs in own context and thread until a fatal error
+struct ConsoleRun {
+    unsigned char value; //!< value for ldi, which identifies the trace of this run
+    ostringstream trace;
+    ostringstream warnings;
+    string error;
+
+    ConsoleRun(unsigned char v): value(v) {}
+
+    //! Opcode of ldi r16,value
+    unsigned short Ldi(void) { return 0xe000 | ((value & 0xf0) << 4) | (value & 0x0f); }
+
+    void Run(void) {
+        SystemConsoleHandler console;
+        console.SetUseExit(false);
+        console.SetWarningStream(&warnings);
+        console.SetTraceStream(&trace);
+        SimulationContext ctx(&console);
+        SimulationContext::Scope scope(ctx);
+        AvrDevice *dev = new AvrDevice_atmega32;
+
+        // nop ; ldi r16,value ; dec r17 ; brne to ldi ; illegal opcode
+        unsigned short ldi = Ldi();
+        unsigned char code[] = { 0x00, 0x00, (unsigned char)(ldi & 0xff), (unsigned char)(ldi >> 8),
+                                 0x1a, 0x95, 0xe9, 0xf7, 0xff, 0xff };
+        dev->Flash->WriteMem(code, 0, sizeof(code));
+        dev->SetCoreReg(17, 0);
+        dev->trace_on = 1;
+        avr_warning("run 0x%02x", value);
+        try {
+            for(;;) {
+                bool done = false;
+                dev->Step(done);
+            }
+        } catch(const char *msg) {
+            error = msg;
+        }
+        delete dev;
+    }
+};
+
+static void *RunThread(void *arg) {
+    ((ConsoleRun *)arg)->Run();
+    return NULL;
+}
+
+//! Returns the number of occurrences of text in s
+static int Count(const string &s, const string &text) {
+    int n = 0;
+    for(size_t pos = s.find(text); pos != string::npos; pos = s.find(text, pos + 1))
+        n++;
+    return n;
+}
+
+// Two contexts in parallel threads write trace, warnings and errors only to
+// their own console handler
+TEST( SESSION_CONSOLE, PARALLEL_CONTEXTS )
+{
+    ConsoleRun a(0x11), b(0x22);
+    pthread_t ta, tb;
+    pthread_create(&ta, NULL, RunThread, &a);
+    pthread_create(&tb, NULL, RunThread, &b);
+    pthread_join(ta, NULL);
+    pthread_join(tb, NULL);
+
+    ConsoleRun *runs[] = { &a, &b };
+    for(int i = 0; i < 2; i++) {
+        ConsoleRun *own = runs[i];
+        ConsoleRun *other = runs[1 - i];
+        ostringstream ownLdi, otherLdi, ownOpcode, otherOpcode, ownRun, otherRun;
+        ownLdi << "LDI R16, " << HexChar(own->value);
+        otherLdi << "LDI R16, " << HexChar(other->value);
+        ownOpcode << " " << hex << own->Ldi() << " ";
+        otherOpcode << " " << hex << other->Ldi() << " ";
+        ownRun << "run 0x" << hex << (int)own->value;
+        otherRun << "run 0x" << hex << (int)other->value;
+        string trace = own->trace.str();
+        string warnings = own->warnings.str();
+
+        EXPECT_EQ(256, Count(trace, ownLdi.str())) << "Own trace incomplete in run " << i << endl;
+        EXPECT_EQ(0, Count(trace, otherLdi.str())) << "Trace of other context in run " << i << endl;
+        EXPECT_NE(string::npos, own->error.find("Illegal opcode")) << "Wrong error in run " << i << ": " << own->error << endl;
+        // the error itself is thrown, the flight recorder report goes to the warning stream
+        EXPECT_EQ(1, Count(warnings, "Flight recorder of")) << "Not only own report in run " << i << ": " << warnings << endl;
+        EXPECT_NE(0, Count(warnings, ownOpcode.str())) << "Own instructions not in report of run " << i << endl;
+        EXPECT_EQ(0, Count(warnings, otherOpcode.str())) << "Instructions of other context in report of run " << i << endl;
+        EXPECT_EQ(1, Count(warnings, ownRun.str())) << "Own warning missing in run " << i << endl;
+        EXPECT_EQ(0, Count(warnings, otherRun.str())) << "Warning of other context in run " << i << endl;
+    }
+}
@@ -0,0 +1,161 @@
+#include <iostream>
+#include <vector>
+using namespace std;
+
+#include "gtest.h"
+
+#include "avrdevice.h"
+#include "atmega16_32.h"
+#include "at8515.h"
+#include "flash.h"
+#include "decoder.h"
+
+//! Firmware: nop, then loop with ldi r16,1 ; inc r17 ; rjmp to ldi
+static const unsigned short firmware[] = { 0x0000, 0xe001, 0x9513, 0xcffd };
+static const int firmwareWords = sizeof(firmware) / sizeof(firmware[0]);
+
+//! Write words to flash like a program load or SPM
+static void Program(AvrDevice *dev, const unsigned short *words, int n) {
+    vector<unsigned char> code;
+    for(int i = 0; i < n; i++) {
+        code.push_back(words[i] & 0xff);
+        code.push_back(words[i] >> 8);
+    }
+    dev->Flash->WriteMem(&code[0], 0, code.size());
+}
+
+//! Process one instruction including wait cycles
+static void Instruction(AvrDevice *dev) {
+    bool done = false;
+    do {
+        dev->Step(done);
+    } while(!done);
+}
+
+// Devices with the same firmware and instruction set share all decoded
+// instructions, a device with other instruction set uses own instances
+TEST( SESSION_DECODER, SHARED_RECORDS )
+{
+    AvrDevice *a = new AvrDevice_atmega32;
+    AvrDevice *b = new AvrDevice_atmega32;
+    AvrDevice *other = new AvrDevice_at90s8515;
+    Program(a, firmware, firmwareWords);
+    Program(b, firmware, firmwareWords);
+    Program(other, firmware, firmwareWords);
+
+    for(int pc = 0; pc < firmwareWords; pc++) {
+        EXPECT_EQ(a->Flash->GetInstruction(pc), b->Flash->GetInstruction(pc)) << "Not shared at PC " << pc << endl;
+        EXPECT_NE(a->Flash->GetInstruction(pc), other->Flash->GetInstruction(pc)) << "Shared with other instruction set at PC " << pc << endl;
+        EXPECT_EQ(a->Flash->GetDecodedRecord(pc).handler, b->Flash->GetDecodedRecord(pc).handler) << "Other handler at PC " << pc << endl;
+    }
+    // also erased flash behind the program
+    EXPECT_EQ(a->Flash->GetInstruction(100), b->Flash->GetInstruction(100)) << "Erased flash not shared" << endl;
+
+    delete other;
+    delete b;
+    delete a;
+}
+
+// A flash write by SPM (WriteMem) or gdb (WriteMemByte and Decode) in one
+// device doesn't change the instructions of the other device
+TEST( SESSION_DECODER, FLASH_WRITE_NO_LEAK )
+{
+    AvrDevice *a = new AvrDevice_atmega32;
+    AvrDevice *b = new AvrDevice_atmega32;
+    Program(a, firmware, firmwareWords);
+    Program(b, firmware, firmwareWords);
+    DecodedInstruction *ldi = b->Flash->GetInstruction(1);
+    DecodedInstruction *inc = b->Flash->GetInstruction(2);
+
+    // SPM: ldi r16,2 instead of ldi r16,1
+    unsigned short patched[] = { 0x0000, 0xe002 };
+    Program(a, patched, 2);
+    // gdb: dec r17 instead of inc r17
+    a->Flash->WriteMemByte(0x95, 4);
+    a->Flash->WriteMemByte(0x1a, 5);
+    a->Flash->Decode(4, 2);
+
+    EXPECT_EQ(ldi, b->Flash->GetInstruction(1)) << "SPM write changed other device" << endl;
+    EXPECT_EQ(inc, b->Flash->GetInstruction(2)) << "gdb write changed other device" << endl;
+    EXPECT_NE(ldi, a->Flash->GetInstruction(1)) << "SPM write not decoded" << endl;
+    EXPECT_NE(inc, a->Flash->GetInstruction(2)) << "gdb write not decoded" << endl;
+
+    a->SetCoreReg(17, 0);
+    b->SetCoreReg(17, 0);
+    for(int i = 0; i < 3; i++) {
+        Instruction(a);
+        Instruction(b);
+    }
+    EXPECT_EQ(2, a->GetCoreReg(16)) << "patched ldi not executed" << endl;
+    EXPECT_EQ(0xff, a->GetCoreReg(17)) << "patched dec not executed" << endl;
+    EXPECT_EQ(1, b->GetCoreReg(16)) << "other device executed patched ldi" << endl;
+    EXPECT_EQ(1, b->GetCoreReg(17)) << "other device executed patched dec" << endl;
+
+    delete b;
+    delete a;
+}
+
+// Instructions live as long as a device uses them, also if another device
+// with the same instruction set is destroyed
+TEST( SESSION_DECODER, TABLE_LIFETIME )
+{
+    AvrDevice *a = new AvrDevice_atmega32;
+    Program(a, firmware, firmwareWords);
+    AvrDevice *b = new AvrDevice_atmega32;
+    Program(b, firmware, firmwareWords);
+    delete b;
+
+    a->SetCoreReg(17, 0);
+    for(int i = 0; i < 7; i++)
+        Instruction(a);
+    EXPECT_EQ(1, a->GetCoreReg(16)) << "ldi not executed" << endl;
+    EXPECT_EQ(2, a->GetCoreReg(17)) << "inc not executed twice" << endl;
+
+    delete a;
+}
+
+// Each flash word has a record with handler and operands of its instruction,
+// a skip over a 2 word instruction uses the size of the record behind
+TEST( SESSION_DECODER, DECODED_RECORDS )
+{
+    // nop ; ldi r16,0x5a ; sts 0x0100,r16 ; sbrs r16,1 ; sts 0x0101,r16 ; inc r17 ; rjmp .-2
+    const unsigned short program[] = { 0x0000, 0xe50a, 0x9300, 0x0100, 0xff01, 0x9300, 0x0101, 0x9513, 0xcfff };
+    AvrDevice *dev = new AvrDevice_atmega32;
+    Program(dev, program, sizeof(program) / sizeof(program[0]));
+
+    const DecodedRecord &ldi = dev->Flash->GetDecodedRecord(1);
+    EXPECT_EQ(&avr_op_LDI::Exec, ldi.handler) << "Wrong handler for ldi" << endl;
+    EXPECT_EQ(16, ldi.op1) << "Wrong register for ldi" << endl;
+    EXPECT_EQ(0x5a, ldi.op2) << "Wrong constant for ldi" << endl;
+    EXPECT_FALSE(ldi.size2Word) << "ldi has 1 word" << endl;
+    EXPECT_EQ(&avr_op_STS::Exec, dev->Flash->GetDecodedRecord(2).handler) << "Wrong handler for sts" << endl;
+    EXPECT_TRUE(dev->Flash->IsInstruction2Words(2)) << "sts has 2 words" << endl;
+    EXPECT_FALSE(dev->Flash->IsInstruction2Words(4)) << "sbrs has 1 word" << endl;
+    EXPECT_TRUE(dev->Flash->IsInstruction2Words(5)) << "skipped sts has 2 words" << endl;
+    EXPECT_FALSE(dev->Flash->IsInstruction2Words(dev->Flash->GetSize() / 2)) << "Word behind flash has 2 words" << endl;
+    for(int pc = 0; pc < 9; pc++) {
+        const DecodedRecord &rec = dev->Flash->GetDecodedRecord(pc);
+        const DecodedRecord &inst = dev->Flash->GetInstruction(pc)->GetRecord();
+        EXPECT_TRUE(rec.handler == inst.handler && rec.op1 == inst.op1 && rec.op2 == inst.op2 &&
+                    rec.k == inst.k && rec.size2Word == inst.size2Word) << "Record differs from instruction at PC " << pc << endl;
+    }
+
+    // handler of record executes without instruction instance
+    dev->PC = 1;
+    dev->SetCoreReg(16, 0);
+    EXPECT_EQ(1, ldi.handler(dev, ldi)) << "Wrong clocks for ldi" << endl;
+    EXPECT_EQ(0x5a, dev->GetCoreReg(16)) << "ldi not executed by handler" << endl;
+
+    dev->PC = 0;
+    dev->SetCoreReg(17, 0);
+    dev->SetRWMem(0x0100, 0);
+    dev->SetRWMem(0x0101, 0);
+    for(int i = 0; i < 5; i++)
+        Instruction(dev);
+    EXPECT_EQ(8u, dev->PC) << "Wrong PC after skip of 2 word instruction" << endl;
+    EXPECT_EQ(0x5a, dev->GetRWMem(0x0100)) << "sts not executed" << endl;
+    EXPECT_EQ(0, dev->GetRWMem(0x0101)) << "Skipped sts executed" << endl;
+    EXPECT_EQ(1, dev->GetCoreReg(17)) << "inc not executed" << endl;
+
+    delete dev;
+}
@@ -0,0 +1,263 @@
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "gtest.h"
+
+#include "config.h"
+#ifdef HAVE_ZLIB
+#   include <zlib.h>
+#endif
+
+#include "avrdevice.h"
+#include "atmega16_32.h"
+#include "flash.h"
+#include "helper.h"
+#include "traceval.h"
+#include "systemclock.h"
+#include "simulationcontext.h"
+
+//! Dumper, which records all marks for the values, it traces
+class RecordDumper: public Dumper {
+    public:
+        //! Name without device and group (Dev1.CORE.)
+        static string Name(const TraceValue *t) {
+            string n = t->name();
+            return n.substr(n.rfind('.') + 1);
+        }
+
+        set<string> traced;
+        vector<string> log;
+
+        RecordDumper(const TraceSet &vals) {
+            for(size_t i = 0; i < vals.size(); i++)
+                traced.insert(vals[i]->name());
+        }
+        void cycle() { log.push_back("cycle"); }
+        void markRead(const TraceValue *t) { log.push_back("R " + Name(t)); }
+        void markWrite(const TraceValue *t) { log.push_back("W " + Name(t)); }
+        void markChange(const TraceValue *t) { log.push_back("C " + Name(t)); }
+        bool enabled(const TraceValue *t) const { return traced.count(t->name()) > 0; }
+
+        //! Number of log entries, which are equal to s
+        int Count(const string &s) const {
+            int n = 0;
+            for(size_t i = 0; i < log.size(); i++)
+                if(log[i] == s)
+                    n++;
+            return n;
+        }
+        //! Index of first log entry equal to s or -1
+        int Find(const string &s) const {
+            for(size_t i = 0; i < log.size(); i++)
+                if(log[i] == s)
+                    return i;
+            return -1;
+        }
+        //! Number of log entries for a value
+        int CountValue(const string &name) const {
+            return Count("R " + name) + Count("W " + name) + Count("C " + name);
+        }
+};
+
+static TraceSet Values(AvrDevice *dev, const char **names, int n) {
+    TraceSet s;
+    for(int i = 0; i < n; i++) {
+        TraceValue *t = dev->coreTraceGroup.GetTraceValueByName(names[i]);
+        EXPECT_TRUE(t != NULL) << "No trace value " << names[i] << endl;
+        if(t != NULL)
+            s.push_back(t);
+    }
+    return s;
+}
+
+// Only accessed values are dumped, to all dumpers which trace them, and
+// only values with a shadow (PC) are polled on each cycle
+TEST( SESSION_DUMP, ACCESS_DRIVEN )
+{
+    SimulationContext ctx;
+    SimulationContext::Scope scope(ctx);
+    AvrDevice *dev = new AvrDevice_atmega32;
+
+    // nop ; ldi r16,0x5a ; sts 0x0200,r16 ; mov r18,r16 ; rjmp .-1
+    unsigned char code[] = { 0x00, 0x00, 0x0a, 0xe5, 0x00, 0x93, 0x00, 0x02, 0x20, 0x2f, 0xff, 0xcf };
+    dev->Flash->WriteMem(code, 0, sizeof(code));
+    dev->SetCoreReg(16, 0);
+    dev->SetCoreReg(18, 0);
+
+    const char *namesA[] = { "r16", "r17", "IRAM416", "PC" };
+    const char *namesB[] = { "r16", "r18" };
+    RecordDumper *a = new RecordDumper(Values(dev, namesA, 4));
+    RecordDumper *b = new RecordDumper(Values(dev, namesB, 2));
+    DumpManager *dm = ctx.GetDumpManager();
+    dm->addDumper(a, Values(dev, namesA, 4));
+    dm->addDumper(b, Values(dev, namesB, 2));
+    dm->start();
+    EXPECT_EQ(5u, dm->active.size()) << "Wrong count of active values" << endl;
+    EXPECT_EQ(1u, dm->polledValues.size()) << "Not only PC polled" << endl;
+
+    for(int i = 0; i < 10; i++) {
+        bool done;
+        dev->Step(done);
+        EXPECT_TRUE(dm->changed.empty()) << "Changed list not cleared in cycle " << i << endl;
+    }
+
+    EXPECT_EQ(0, a->CountValue("r17")) << "Not accessed value dumped" << endl;
+    EXPECT_EQ(1, a->Count("W r16")) << "ldi not dumped" << endl;
+    EXPECT_EQ(1, a->Count("C r16")) << "Change by ldi not dumped" << endl;
+    EXPECT_EQ(1, a->Count("W IRAM416")) << "sts not dumped" << endl;
+    EXPECT_LE(4, a->Count("C PC")) << "Polled PC not dumped" << endl;
+    // values in order of activation
+    int read = a->Find("R r16");
+    int write = a->Find("W IRAM416");
+    EXPECT_TRUE(read >= 0 && read < write) << "Wrong order in sts cycle" << endl;
+
+    // the second dumper sees also the flags of the shared value
+    EXPECT_EQ(1, b->Count("W r16")) << "ldi not dumped to second dumper" << endl;
+    EXPECT_EQ(2, b->Count("R r16")) << "sts and mov read not dumped to second dumper" << endl;
+    EXPECT_EQ(1, b->Count("W r18")) << "mov not dumped" << endl;
+    EXPECT_EQ(0, b->CountValue("IRAM416") + b->CountValue("PC")) << "Value of other dumper dumped" << endl;
+
+    delete dev;
+}
+
+//! Read a file, a gzip compressed one, if zlib is available
+static string ReadFile(const string &name) {
+    string content;
+    char buf[4096];
+#ifdef HAVE_ZLIB
+    gzFile f = gzopen(name.c_str(), "rb");
+    if(f == NULL)
+        return content;
+    int l;
+    while((l = gzread(f, buf, sizeof(buf))) > 0)
+        content.append(buf, l);
+    gzclose(f);
+#else
+    ifstream f(name.c_str(), ios::binary);
+    while(f.read(buf, sizeof(buf)) || f.gcount() > 0)
+        content.append(buf, f.gcount());
+#endif
+    return content;
+}
+
+//! Binary value in VCD form without leading zeros
+static string VcdBinary(unsigned v) {
+    string s;
+    do {
+        s.insert(s.begin(), (v & 1) ? '1' : '0');
+        v >>= 1;
+    } while(v);
+    return "b" + s;
+}
+
+// More than 94 signals get identifier codes with 2 characters, 1 bit values
+// are written scalar, vectors without leading zeros, no time marker without
+// changes, and the gzip output is the same as the plain one
+TEST( SESSION_DUMP, VCD_WRITER )
+{
+    char dirName[] = "/tmp/simulavr_vcd_XXXXXX";
+    string dir = mkdtemp(dirName);
+    string plainFile = dir + "/dump.vcd";
+    string gzFile = dir + "/dump.vcd.gz";
+
+    SimulationContext ctx;
+    SimulationContext::Scope scope(ctx);
+    SystemClock &clock = ctx.GetSystemClock();
+    AvrDevice *dev = new AvrDevice_atmega32;
+    dev->SetClockFreq(250);
+    clock.Add(dev);
+
+    // nop ; ldi r16,0x5a ; loop: inc r17 ; sts 0x0060,r17 ; rjmp loop
+    unsigned char code[] = { 0x00, 0x00, 0x0a, 0xe5, 0x13, 0x95, 0x10, 0x93, 0x60, 0x00, 0xfc, 0xcf };
+    dev->Flash->WriteMem(code, 0, sizeof(code));
+    dev->SetCoreReg(16, 0);
+    dev->SetCoreReg(17, 0);
+
+    // 96 values with read and write strobe: 288 signals
+    TraceSet vals;
+    for(int i = 0; i < 32; i++)
+        vals.push_back(dev->coreTraceGroup.GetTraceValueByName("r" + int2str(i)));
+    for(int i = 0; i < 64; i++)
+        vals.push_back(dev->coreTraceGroup.GetTraceValueByName("IRAM" + int2str(i)));
+    DumpManager *dm = ctx.GetDumpManager();
+    dm->addDumper(new DumpVCD(plainFile, "ns", true, true), vals);
+#ifdef HAVE_ZLIB
+    dm->addDumper(new DumpVCD(gzFile, "ns", true, true), vals);
+#endif
+    dm->start();
+    clock.RunTimeRange(20000);
+    unsigned char counter = dev->GetCoreReg(17);
+    dm->stopApplication();
+    delete dev;
+
+    string plain = ReadFile(plainFile);
+    istringstream in(plain);
+    string line;
+    map<string, string> ids; // name to id
+    set<string> idSet;
+    while(getline(in, line) && line != "$enddefinitions $end") {
+        istringstream l(line);
+        string var, wire, bits, id, name;
+        l >> var >> wire >> bits >> id >> name;
+        if(var != "$var")
+            continue;
+        EXPECT_TRUE(idSet.insert(id).second) << "Identifier code used twice: " << id << endl;
+        for(size_t i = 0; i < id.size(); i++)
+            EXPECT_TRUE(id[i] >= '!' && id[i] <= '~') << "Wrong character in identifier code: " << id << endl;
+        ids[name] = id;
+    }
+    EXPECT_EQ(288u, idSet.size()) << "Wrong count of signals" << endl;
+    EXPECT_EQ(2u, ids["IRAM63_W"].size()) << "Last signal hasn't 2 characters" << endl;
+
+    bool lastWasTime = false;
+    long lastTime = -1;
+    int times = 0;
+    string lastIram0;
+    bool r16Value = false, r17Strobe = false;
+    while(getline(in, line)) {
+        if(line.empty() || line[0] == '$')
+            continue;
+        if(line[0] == '#') {
+            long t = atol(line.c_str() + 1);
+            EXPECT_FALSE(lastWasTime) << "Time marker without change before #" << t << endl;
+            EXPECT_LT(lastTime, t) << "Time goes back at #" << t << endl;
+            lastTime = t;
+            lastWasTime = true;
+            times++;
+            continue;
+        }
+        lastWasTime = false;
+        if(line == VcdBinary(0x5a) + " " + ids["r16"])
+            r16Value = true;
+        if(line == "1" + ids["r17_W"])
+            r17Strobe = true;
+        if(line[0] == 'b' && line.substr(line.find(' ') + 1) == ids["IRAM0"])
+            lastIram0 = line.substr(0, line.find(' '));
+    }
+    EXPECT_LT(10, times) << "Too few time markers" << endl;
+    EXPECT_TRUE(r16Value) << "ldi r16 not dumped without leading zeros" << endl;
+    EXPECT_TRUE(r17Strobe) << "Write strobe not dumped scalar" << endl;
+    EXPECT_EQ(VcdBinary(counter), lastIram0) << "Wrong last value of IRAM0" << endl;
+
+#ifdef HAVE_ZLIB
+    FILE *f = fopen(gzFile.c_str(), "rb");
+    ASSERT_TRUE(f != NULL) << "No compressed file" << endl;
+    int magic1 = fgetc(f), magic2 = fgetc(f);
+    fclose(f);
+    EXPECT_TRUE(magic1 == 0x1f && magic2 == 0x8b) << "Compressed file isn't gzip" << endl;
+    EXPECT_EQ(plain, ReadFile(gzFile)) << "Compressed output differs" << endl;
+    unlink(gzFile.c_str());
+#endif
+    unlink(plainFile.c_str());
+    rmdir(dir.c_str());
+}
@@ -0,0 +1,232 @@
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "gtest.h"
+
+#include "avrdevice.h"
+#include "atmega16_32.h"
+#include "flash.h"
+#include "simulationcontext.h"
+
+static const char *firmware = "session_parallel/tc1.atmega32.o";
+static const char *otherFirmware = "session_parallel/tc2.atmega32.o";
+
+//! A device, which is loaded with firmware cache in own context
+struct CachedLoad {
+    SimulationContext ctx;
+    AvrDevice *dev;
+
+    CachedLoad(const string &dir, const string &elf) {
+        ctx.SetFirmwareCacheDirectory(dir);
+        SimulationContext::Scope scope(ctx);
+        dev = new AvrDevice_atmega32;
+        dev->Load(elf.c_str());
+    }
+    ~CachedLoad() {
+        SimulationContext::Scope scope(ctx);
+        delete dev;
+    }
+};
+
+//! Temporary cache directory with a copy of the firmware
+struct CacheDir {
+    string dir;
+    string elf;
+
+    CacheDir() {
+        char name[] = "/tmp/simulavr_fwc_XXXXXX";
+        dir = mkdtemp(name);
+        elf = dir + "/fw.elf";
+    }
+    ~CacheDir() {
+        vector<string> files = Files("");
+        for(size_t i = 0; i < files.size(); i++)
+            remove((dir + "/" + files[i]).c_str());
+        rmdir(dir.c_str());
+    }
+
+    //! Names of files in directory with suffix
+    vector<string> Files(const string &suffix) {
+        vector<string> files;
+        DIR *d = opendir(dir.c_str());
+        while(struct dirent *e = readdir(d)) {
+            string name = e->d_name;
+            if(name == "." || name == "..")
+                continue;
+            if(name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+                files.push_back(name);
+        }
+        closedir(d);
+        return files;
+    }
+
+    //! Copy file to elf and set its modification time
+    void Copy(const char *from, time_t mtime) {
+        FILE *in = fopen(from, "rb");
+        FILE *out = fopen(elf.c_str(), "wb");
+        char buf[4096];
+        size_t l;
+        while((l = fread(buf, 1, sizeof(buf), in)) > 0)
+            fwrite(buf, 1, l, out);
+        fclose(in);
+        fclose(out);
+        SetMtime(elf, mtime);
+    }
+
+    //! Change first program byte of elf in place, the file keeps size, inode and modification time
+    void PatchProgram(time_t mtime) {
+        FILE *f = fopen(elf.c_str(), "r+b");
+        unsigned char h[4];
+        // offset of first program header, then offset of its segment (ELF32, little endian)
+        fseek(f, 0x1c, SEEK_SET);
+        fread(h, 1, 4, f);
+        fseek(f, h[0] + (h[1] << 8) + (h[2] << 16) + (h[3] << 24) + 4, SEEK_SET);
+        fread(h, 1, 4, f);
+        long offset = h[0] + (h[1] << 8) + (h[2] << 16) + (h[3] << 24);
+        fseek(f, offset, SEEK_SET);
+        fread(h, 1, 1, f);
+        h[0] ^= 0x5a;
+        fseek(f, offset, SEEK_SET);
+        fwrite(h, 1, 1, f);
+        fclose(f);
+        SetMtime(elf, mtime);
+    }
+
+    static void SetMtime(const string &path, time_t mtime) {
+        struct utimbuf t;
+        t.actime = mtime;
+        t.modtime = mtime;
+        utime(path.c_str(), &t);
+    }
+};
+
+//! True, if both devices have the same flash content
+static bool SameFlash(AvrDevice *a, AvrDevice *b) {
+    for(unsigned int i = 0; i < a->Flash->GetSize(); i++)
+        if(a->Flash->ReadMemRaw(i) != b->Flash->ReadMemRaw(i))
+            return false;
+    return true;
+}
+
+// First load writes a cache file, the second load takes it without reading
+// the elf file: a change, which keeps size, inode and time, isn't seen
+TEST( SESSION_ELFCACHE, MISS_AND_HIT )
+{
+    CacheDir cd;
+    time_t past = time(NULL) - 100;
+    cd.Copy(firmware, past);
+
+    CachedLoad first(cd.dir, cd.elf);
+    EXPECT_EQ(1u, cd.Files(".fwc").size()) << "No cache file written" << endl;
+    CachedLoad plain("", firmware);
+    EXPECT_TRUE(SameFlash(plain.dev, first.dev)) << "Wrong flash on miss" << endl;
+
+    cd.PatchProgram(past);
+    CachedLoad second(cd.dir, cd.elf);
+    EXPECT_TRUE(SameFlash(plain.dev, second.dev)) << "Cache not used on hit" << endl;
+    EXPECT_EQ(1u, cd.Files(".fwc").size()) << "Cache file written on hit" << endl;
+}
+
+// A changed elf file (other time or size) gets a new cache file
+TEST( SESSION_ELFCACHE, CHANGED_FILE_MISS )
+{
+    CacheDir cd;
+    cd.Copy(firmware, time(NULL) - 100);
+    CachedLoad first(cd.dir, cd.elf);
+
+    cd.Copy(otherFirmware, time(NULL) - 50);
+    CachedLoad second(cd.dir, cd.elf);
+    CachedLoad plain("", otherFirmware);
+    EXPECT_TRUE(SameFlash(plain.dev, second.dev)) << "Old cache file used for changed elf file" << endl;
+    EXPECT_EQ(2u, cd.Files(".fwc").size()) << "No new cache file written" << endl;
+}
+
+// A invalid cache file is ignored and written again
+TEST( SESSION_ELFCACHE, INVALID_FILE_REBUILD )
+{
+    CacheDir cd;
+    cd.Copy(firmware, time(NULL) - 100);
+    { CachedLoad first(cd.dir, cd.elf); }
+    vector<string> files = cd.Files(".fwc");
+    ASSERT_EQ(1u, files.size()) << "No cache file written" << endl;
+    string cacheFile = cd.dir + "/" + files[0];
+    struct stat st;
+    stat(cacheFile.c_str(), &st);
+
+    FILE *f = fopen(cacheFile.c_str(), "wb");
+    fputs("garbage", f);
+    fclose(f);
+
+    CachedLoad second(cd.dir, cd.elf);
+    CachedLoad plain("", firmware);
+    EXPECT_TRUE(SameFlash(plain.dev, second.dev)) << "Wrong flash with invalid cache file" << endl;
+    struct stat st2;
+    stat(cacheFile.c_str(), &st2);
+    EXPECT_EQ(st.st_size, st2.st_size) << "Invalid cache file not written again" << endl;
+}
+
+// A elf file changed in the same second as the cache file was written is
+// checked by content hash
+TEST( SESSION_ELFCACHE, RACY_CONTENT_CHECK )
+{
+    CacheDir cd;
+    time_t past = time(NULL) - 100;
+    cd.Copy(firmware, past);
+    { CachedLoad first(cd.dir, cd.elf); }
+    vector<string> files = cd.Files(".fwc");
+    ASSERT_EQ(1u, files.size()) << "No cache file written" << endl;
+    // as if cache file was written in same second as elf file
+    CacheDir::SetMtime(cd.dir + "/" + files[0], past);
+
+    cd.PatchProgram(past);
+    CachedLoad second(cd.dir, cd.elf);
+    CachedLoad plain("", firmware);
+    EXPECT_FALSE(SameFlash(plain.dev, second.dev)) << "Changed elf file not detected" << endl;
+}
+
+//! Thread, which loads a device with cache
+static void *LoadThread(void *arg) {
+    CacheDir *cd = (CacheDir *)arg;
+    CachedLoad *load = new CachedLoad(cd->dir, cd->elf);
+    return load;
+}
+
+// Parallel loads with the same elf file write a single valid cache file
+TEST( SESSION_ELFCACHE, CONCURRENT_WRITERS )
+{
+    const int count = 8;
+    CacheDir cd;
+    time_t past = time(NULL) - 100;
+    cd.Copy(firmware, past);
+    CachedLoad plain("", firmware);
+
+    pthread_t threads[count];
+    for(int i = 0; i < count; i++)
+        pthread_create(&threads[i], NULL, LoadThread, &cd);
+    for(int i = 0; i < count; i++) {
+        void *result;
+        pthread_join(threads[i], &result);
+        CachedLoad *load = (CachedLoad *)result;
+        EXPECT_TRUE(SameFlash(plain.dev, load->dev)) << "Wrong flash in thread " << i << endl;
+        delete load;
+    }
+    EXPECT_EQ(1u, cd.Files(".fwc").size()) << "Not one cache file" << endl;
+    EXPECT_EQ(0u, cd.Files(".tmp").size()) << "Temporary file left" << endl;
+
+    // the cache file is valid: a hit doesn't see the changed elf file
+    cd.PatchProgram(past);
+    CachedLoad after(cd.dir, cd.elf);
+    EXPECT_TRUE(SameFlash(plain.dev, after.dev)) << "Cache file not valid after parallel writes" << endl;
+}
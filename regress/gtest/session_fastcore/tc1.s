@@ -0,0 +1,43 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#undef _SFR_IO8
+#define _SFR_IO8(x) (x)
+#undef _SFR_IO16
+#define _SFR_IO16(x) (x)
+
+; a loop of register operations, where some flags are overwritten by the
+; next instruction, and a timer irq, which reads SREG in between
+.global main
+main:
+    ldi r16, (1<<TOIE0)    ; timer 0 overflow irq
+    out TIMSK, r16
+    ldi r16, (1<<CS00)     ; timer 0 clock is cpu clock
+    out TCCR0, r16
+    ldi r17, 0x37
+    ldi r19, 0x5a
+    ldi r22, 0x81
+    sei
+
+loop:
+    add r16, r17           ; flags overwritten by sub
+    sub r18, r19
+    adc r20, r16           ; reads C of sub
+    inc r21
+    neg r23
+    eor r24, r23
+    dec r25
+    cpc r26, r22
+    lsr r27
+    adiw r28, 3
+    subi r30, 0x11         ; flags overwritten by sbci, except Z
+    sbci r31, 0x22
+    com r2
+    rjmp loop
+
+.global TIMER0_OVF_vect
+TIMER0_OVF_vect:
+    in r15, SREG           ; SREG seen by irq
+    inc r14                ; count of irqs
+    out SREG, r15
+    reti
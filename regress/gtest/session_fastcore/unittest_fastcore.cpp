@@ -0,0 +1,52 @@
+#include <iostream>
+using namespace std;
+
+#include "gtest.h"
+
+#include "avrdevice.h"
+#include "atmega16_32.h"
+#include "systemclock.h"
+#include "simulationcontext.h"
+
+//! A device with own context and clock
+struct FastCoreRun {
+    SimulationContext ctx;
+    AvrDevice *dev;
+
+    FastCoreRun(bool fastCore) {
+        SimulationContext::Scope scope(ctx);
+        dev = new AvrDevice_atmega32;
+        dev->Load("session_fastcore/tc1.atmega32.o");
+        dev->SetClockFreq(125);     // 8MHz
+        dev->SetFastCoreMode(fastCore);
+        ctx.GetSystemClock().Add(dev);
+    }
+    ~FastCoreRun() {
+        SimulationContext::Scope scope(ctx);
+        delete dev;
+    }
+
+    void Run(SystemClockOffset t) {
+        SimulationContext::Scope scope(ctx);
+        ctx.GetSystemClock().RunTimeRange(t);
+    }
+};
+
+// Fast core mode has the same registers, SREG and PC as normal mode after each
+// run, also if a run ends inside a block of register operations
+TEST( SESSION_FASTCORE, COMPARE_NORMAL )
+{
+    FastCoreRun normal(false), fast(true);
+
+    for(int i = 0; i < 2000; i++) {
+        // end of runs moves through the loop and the irqs
+        SystemClockOffset t = (1 + (i % 7)) * 125;
+        normal.Run(t);
+        fast.Run(t);
+        ASSERT_EQ((int)*normal.dev->status, (int)*fast.dev->status) << "Different SREG after run " << i << endl;
+        ASSERT_EQ(normal.dev->PC, fast.dev->PC) << "Different PC after run " << i << endl;
+        for(int r = 0; r < 32; r++)
+            ASSERT_EQ(normal.dev->GetCoreReg(r), fast.dev->GetCoreReg(r)) << "Different r" << r << " after run " << i << endl;
+    }
+    EXPECT_LT(10, normal.dev->GetCoreReg(14)) << "Not enough irqs" << endl;
+}
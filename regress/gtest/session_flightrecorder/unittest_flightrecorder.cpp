@@ -0,0 +1,83 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+using namespace std;
+
+#include "gtest.h"
+
+#include "avrdevice.h"
+#include "atmega16_32.h"
+#include "avrerror.h"
+#include "flash.h"
+#include "hwsreg.h"
+#include "simulationcontext.h"
+
+//! Process one instruction including wait cycles
+static void Instruction(AvrDevice *dev) {
+    bool done = false;
+    do {
+        dev->Step(done);
+    } while(!done);
+}
+
+//! Returns line of report, which contains text, or a empty string
+static string Line(const string &report, const string &text) {
+    size_t pos = report.find(text);
+    if(pos == string::npos)
+        return "";
+    size_t begin = report.rfind('\n', pos);
+    size_t end = report.find('\n', pos);
+    begin = (begin == string::npos) ? 0 : begin + 1;
+    return report.substr(begin, end - begin);
+}
+
+// A fatal error with exceptions (python, gtest) writes the flight recorder
+// to the warning stream: PC, opcode, SREG before each instruction (lazy flags
+// included) and memory writes
+TEST( SESSION_FLIGHTRECORDER, FATAL_REPORT )
+{
+    SystemConsoleHandler console;
+    ostringstream warnings;
+    console.SetUseExit(false);
+    console.SetWarningStream(&warnings);
+    SimulationContext ctx(&console);
+    SimulationContext::Scope scope(ctx);
+    AvrDevice *dev = new AvrDevice_atmega32;
+
+    // ldi r16,0x5a ; sts 0x0100,r16 ; sec ; sub r16,r16 ; illegal opcode
+    unsigned char code[] = { 0x0a, 0xe5, 0x00, 0x93, 0x00, 0x01, 0x08, 0x94, 0x00, 0x1b, 0xff, 0xff };
+    dev->Flash->WriteMem(code, 0, sizeof(code));
+    *(dev->status) = 0;
+
+    bool caught = false;
+    try {
+        for(int i = 0; i < 10; i++)
+            Instruction(dev);
+    } catch(const char *msg) {
+        caught = true;
+        EXPECT_NE(string::npos, string(msg).find("Illegal opcode")) << "Wrong error: " << msg << endl;
+    }
+    ASSERT_TRUE(caught) << "No fatal error on illegal opcode" << endl;
+
+    string report = warnings.str();
+    EXPECT_NE(string::npos, report.find("Flight recorder of")) << "No report: " << report << endl;
+    EXPECT_NE(string::npos, report.find("Last 5 instructions (oldest first):")) << "Wrong count: " << report << endl;
+
+    string line = Line(report, ": 0x0000 ");
+    EXPECT_NE(string::npos, line.find(" e50a ")) << "ldi: " << line << endl;
+    EXPECT_NE(string::npos, line.find("SREG=[--------]")) << "ldi: " << line << endl;
+    line = Line(report, ": 0x0002 ");
+    EXPECT_NE(string::npos, line.find(" 9300 ")) << "sts: " << line << endl;
+    EXPECT_NE(string::npos, line.find("[0x0100]=0x5a")) << "sts: " << line << endl;
+    line = Line(report, ": 0x0006 ");
+    EXPECT_NE(string::npos, line.find(" 9408 ")) << "sec: " << line << endl;
+    EXPECT_EQ(string::npos, line.find("]=0x")) << "sec: " << line << endl;
+    line = Line(report, ": 0x0008 ");
+    EXPECT_NE(string::npos, line.find(" 1b00 ")) << "sub: " << line << endl;
+    EXPECT_NE(string::npos, line.find("SREG=[-------C]")) << "sub: " << line << endl;
+    line = Line(report, ": 0x000a ");
+    EXPECT_NE(string::npos, line.find(" ffff ")) << "illegal: " << line << endl;
+    EXPECT_NE(string::npos, line.find("SREG=[------Z-]")) << "illegal: " << line << endl;
+
+    delete dev;
+}
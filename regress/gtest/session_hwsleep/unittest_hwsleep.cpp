@@ -0,0 +1,114 @@
+#include <iostream>
+#include <vector>
+using namespace std;
+
+#include "gtest.h"
+
+#include "avrdevice.h"
+#include "atmega16_32.h"
+#include "flash.h"
+#include "net.h"
+
+// atmega32 io registers (data memory addresses)
+static const unsigned TCNT0 = 0x52;
+static const unsigned TIFR = 0x58;
+static const unsigned UCSRA = 0x2b;
+
+//! Firmware: timer0 with prescaler 8, count 3 overflows in r18 by polling TOV0,
+//! then switch to prescaler 64 and count further
+static const unsigned short timerFirmware[] = {
+    0x0000, 0xe002, 0xbf03, 0xb718, 0xff10, 0xcffd, 0xbf18, 0x9523,
+    0x3023, 0xf7c9, 0xe003, 0xbf03, 0xcff6
+};
+
+//! Firmware: uart with UBRR=3, rx and tx enabled; send r18 and increment it on
+//! UDRE, receive to r19 and count in r20 on RXC
+static const unsigned short uartFirmware[] = {
+    0x0000, 0xe003, 0xb909, 0xe108, 0xb90a, 0x9b5d, 0xc002, 0xb92c,
+    0x9523, 0x9b5f, 0xcffa, 0xb13c, 0x9543, 0xcff7
+};
+
+//! Write words to flash like a program load
+static void Program(AvrDevice *dev, const unsigned short *words, int n) {
+    vector<unsigned char> code;
+    for(int i = 0; i < n; i++) {
+        code.push_back(words[i] & 0xff);
+        code.push_back(words[i] >> 8);
+    }
+    dev->Flash->WriteMem(&code[0], 0, code.size());
+    for(int r = 16; r < 21; r++)
+        dev->SetCoreReg(r, 0);
+}
+
+//! Runs the same firmware on a event driven device and on a device, where all
+//! parts in cycle list are woken up on each cycle like in a polling simulation
+class SleepCompare {
+    public:
+        AvrDevice *sleeping;
+        AvrDevice *polling;
+        int skipped; //!< steps, in which the sleeping device skipped all parts in cycle list
+
+        SleepCompare(const unsigned short *words, int n): skipped(0) {
+            sleeping = new AvrDevice_atmega32;
+            polling = new AvrDevice_atmega32;
+            Program(sleeping, words, n);
+            Program(polling, words, n);
+        }
+        ~SleepCompare() {
+            delete polling;
+            delete sleeping;
+        }
+
+        //! Step both devices for a cycle, returns false, if they differ
+        bool Step(void) {
+            bool done;
+            if(sleeping->nextHwCycle > sleeping->GetCycleCounter() + 1)
+                skipped++;
+            sleeping->Step(done);
+            polling->WakeUpAllHardware();
+            polling->Step(done);
+            return sleeping->GetCycleCounter() == polling->GetCycleCounter() &&
+                   sleeping->PC == polling->PC &&
+                   Same(TCNT0) && Same(TIFR) && Same(UCSRA) &&
+                   sleeping->GetCoreReg(18) == polling->GetCoreReg(18) &&
+                   sleeping->GetCoreReg(19) == polling->GetCoreReg(19) &&
+                   sleeping->GetCoreReg(20) == polling->GetCoreReg(20);
+        }
+
+        bool Same(unsigned addr) {
+            return sleeping->GetRWMemDebug(addr) == polling->GetRWMemDebug(addr);
+        }
+};
+
+// Timer overflows happen in the same cycle as with polling, also after a
+// prescaler change
+TEST( SESSION_HWSLEEP, TIMER_OVERFLOW )
+{
+    SleepCompare c(timerFirmware, sizeof(timerFirmware) / sizeof(timerFirmware[0]));
+    for(int i = 0; i < 60000; i++)
+        ASSERT_TRUE(c.Step()) << "Different state in cycle " << c.sleeping->GetCycleCounter()
+                              << ", PC " << c.sleeping->PC << " / " << c.polling->PC << endl;
+    // 3 overflows with prescaler 8 in 6144 cycles, then one each 16384 cycles
+    EXPECT_EQ(6, c.sleeping->GetCoreReg(18)) << "Wrong count of overflows" << endl;
+    EXPECT_LT(0, c.skipped) << "Hardware never skipped" << endl;
+}
+
+// Uart flags and received bytes in loopback change in the same cycle as
+// with polling
+TEST( SESSION_HWSLEEP, UART_BAUD )
+{
+    SleepCompare c(uartFirmware, sizeof(uartFirmware) / sizeof(uartFirmware[0]));
+    Net sleepingLoop, pollingLoop;
+    sleepingLoop.Add(c.sleeping->GetPin("D1"));
+    sleepingLoop.Add(c.sleeping->GetPin("D0"));
+    pollingLoop.Add(c.polling->GetPin("D1"));
+    pollingLoop.Add(c.polling->GetPin("D0"));
+
+    for(int i = 0; i < 10000; i++)
+        ASSERT_TRUE(c.Step()) << "Different state in cycle " << c.sleeping->GetCycleCounter()
+                              << ", PC " << c.sleeping->PC << " / " << c.polling->PC << endl;
+    // 640 cycles per frame
+    EXPECT_LE(10, c.sleeping->GetCoreReg(20)) << "Too few bytes received" << endl;
+    EXPECT_EQ(c.sleeping->GetCoreReg(20) - 1, c.sleeping->GetCoreReg(19)) << "Wrong byte received" << endl;
+    EXPECT_LT(0, c.skipped) << "Hardware never skipped" << endl;
+}
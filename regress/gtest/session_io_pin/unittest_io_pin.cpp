@@ -45,3 +45,73 @@ TEST( SESSION_IO_PIN, OPEN_DRAIN1 )
     EXPECT_EQ(0x08, (unsigned char)(*(dev1->rw[17]))) << "wrong value read back from PORTB R17" << endl;
     EXPECT_EQ(0x04, (unsigned char)(*(dev1->rw[18]))) << "wrong value read back from PORTB R18" << endl;
 }
+
+TEST( SESSION_IO_PIN, NET_PULLUP_PULLDOWN )
+{
+    Net net;
+    Pin pullUp(Pin::PULLUP);
+    Pin pullDown(Pin::PULLDOWN);
+    Pin input;
+    net.Add( &pullUp );
+    net.Add( &input );
+    EXPECT_EQ(Pin::PULLUP, net.result.outState) << "pull up only" << endl;
+    EXPECT_EQ(AnalogValue::ST_VCC, input.analogVal.getD()) << "pull up only" << endl;
+
+    net.Add( &pullDown );
+    EXPECT_EQ(Pin::TRISTATE, net.result.outState) << "pull up and pull down" << endl;
+    EXPECT_EQ(AnalogValue::ST_FLOATING, input.analogVal.getD()) << "pull up and pull down" << endl;
+
+    pullUp = 'H';
+    pullUp.CalcPin();
+    EXPECT_EQ(Pin::HIGH, net.result.outState) << "high and pull down" << endl;
+    EXPECT_EQ(AnalogValue::ST_VCC, input.analogVal.getD()) << "high and pull down" << endl;
+}
+
+TEST( SESSION_IO_PIN, NET_ANALOG_SHORTED )
+{
+    Net net;
+    Pin analog(2.5f);
+    Pin other(Pin::TRISTATE);
+    Pin input;
+    net.Add( &analog );
+    net.Add( &other );
+    net.Add( &input );
+    EXPECT_EQ(Pin::ANALOG, net.result.outState) << "one analog source" << endl;
+    EXPECT_FLOAT_EQ(2.5, input.GetAnalogValue(5.0)) << "one analog source" << endl;
+
+    other = 'L';
+    other.CalcPin();
+    EXPECT_EQ(Pin::ANALOG_SHORTED, net.result.outState) << "analog and low" << endl;
+
+    other = 't';
+    other.CalcPin();
+    EXPECT_EQ(Pin::ANALOG, net.result.outState) << "analog, other back to tristate" << endl;
+
+    other = 'a';
+    other.SetAnalogValue(1.0);
+    EXPECT_EQ(Pin::ANALOG_SHORTED, net.result.outState) << "two analog sources" << endl;
+}
+
+TEST( SESSION_IO_PIN, OPEN_DRAIN_FOLLOWS_CONTROL )
+{
+    Pin control(Pin::LOW);
+    Net net;
+    OpenDrain drain( &control );
+    Pin extPullUp(Pin::PULLUP);
+    Pin input;
+    net.Add( &drain );
+    net.Add( &extPullUp );
+    net.Add( &input );
+    EXPECT_EQ(Pin::PULLUP, net.result.outState) << "control low" << endl;
+    EXPECT_TRUE((bool)input) << "control low" << endl;
+
+    control = 'H';
+    control.CalcPin();
+    EXPECT_EQ(Pin::LOW, net.result.outState) << "control high" << endl;
+    EXPECT_FALSE((bool)input) << "control high" << endl;
+
+    control = 'L';
+    control.CalcPin();
+    EXPECT_EQ(Pin::PULLUP, net.result.outState) << "control low again" << endl;
+    EXPECT_TRUE((bool)input) << "control low again" << endl;
+}
@@ -0,0 +1,73 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#undef _SFR_IO8
+#define _SFR_IO8(x) (x)
+#undef _SFR_IO16
+#define _SFR_IO16(x) (x)
+
+#define VECTORS 0x0100
+
+; INT0 (low level) and timer 0 overflow are pending together, the irq with the
+; lower vector number must be taken first. The INT0 handler releases the pin,
+; so the INT0 irq, which is pending again after entering handler, must be
+; dropped. Every handler writes its vector number to RAM at VECTORS.
+.global main
+main:
+    ldi r26, lo8(VECTORS)  ; X points to list of taken vectors
+    ldi r27, hi8(VECTORS)
+    ldi r20, 0x00          ; count of taken irqs
+    sbi DDRD, 2            ; PD2 (INT0) is output and low
+    ldi r16, (1<<TOIE0)    ; timer 0 overflow irq
+    out TIMSK, r16
+
+; 1st run: both pending, level is active
+    rcall overflow         ; timer 0 overflow pending
+    ldi r16, (1<<INT0)     ; INT0 pending, default is low level irq
+    out GICR, r16
+    sei                    ; expect INT0, then TIMER0_OVF
+    nop
+    nop
+    nop
+    cli
+
+; 2nd run: both pending, but level released before sei
+    cbi PORTD, 2           ; INT0 pending again
+    rcall overflow
+    sbi PORTD, 2           ; release level
+    sei                    ; expect TIMER0_OVF only
+    nop
+    nop
+    nop
+    cli
+
+.global stopsim
+stopsim:
+    rjmp stopsim
+
+; run timer 0 until overflow flag is set, then stop it
+overflow:
+    ldi r16, (1<<CS00)
+    out TCCR0, r16
+wait:
+    in r16, TIFR
+    sbrs r16, TOV0
+    rjmp wait
+    ldi r16, 0x00
+    out TCCR0, r16
+    ret
+
+.global INT0_vect
+INT0_vect:
+    ldi r16, 1
+    st X+, r16
+    inc r20
+    sbi PORTD, 2           ; release level
+    reti
+
+.global TIMER0_OVF_vect
+TIMER0_OVF_vect:
+    ldi r16, 11
+    st X+, r16
+    inc r20
+    reti
@@ -95,3 +95,19 @@ TEST( SESSION_IRQ, TC5)
    EXPECT_EQ( 0x08, (unsigned char)(*(dev1->rw[addr_of_vector++]))) << "Wrong IRQ Order " << endl;
 }
 
+
+TEST( SESSION_IRQ, TC6)
+{
+   AvrDevice *dev1= new AvrDevice_atmega32;
+   dev1->Load("session_irq_check/tc6.atmega32.o");
+   dev1->SetClockFreq(136);    // 7.3728
+   dev1->RegisterTerminationSymbol("stopsim");
+   SystemClock::Instance().Add(dev1);
+   SystemClock::Instance().Endless();
+
+   // INT0 has higher priority than TIMER0_OVF, released level irq isn't taken
+   EXPECT_EQ( 3, (unsigned char)(*(dev1->rw[20]))) << "Wrong count of taken irqs" << endl;
+   EXPECT_EQ( 1, (unsigned char)(*(dev1->rw[0x100]))) << "Wrong IRQ Order " << endl;
+   EXPECT_EQ( 11, (unsigned char)(*(dev1->rw[0x101]))) << "Wrong IRQ Order " << endl;
+   EXPECT_EQ( 11, (unsigned char)(*(dev1->rw[0x102]))) << "Wrong IRQ Order " << endl;
+}
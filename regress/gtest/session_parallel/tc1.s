@@ -0,0 +1,20 @@
+#include <avr/io.h>
+
+#undef _SFR_IO8
+#define _SFR_IO8(x) (x)
+
+; signal generator: toggles PB3 every 95 cycles
+.global main
+main:
+    sbi DDRB, 3
+    ldi r17, (1<<PB3)
+
+loop:
+    in r16, PORTB
+    eor r16, r17
+    out PORTB, r16
+    ldi r18, 30
+delay:
+    dec r18
+    brne delay
+    rjmp loop
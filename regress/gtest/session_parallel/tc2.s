@@ -0,0 +1,30 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#undef _SFR_IO8
+#define _SFR_IO8(x) (x)
+
+#define EDGES 20
+
+; counts rising edges on INT0 (PD2) and stops after EDGES edges
+.global main
+main:
+    ldi r20, 0x00          ; count of edges
+    ldi r16, (1<<ISC01)|(1<<ISC00)
+    out MCUCR, r16
+    ldi r16, (1<<INT0)
+    out GICR, r16
+    sei
+
+loop:
+    cpi r20, EDGES
+    brne loop
+
+.global stopsim
+stopsim:
+    rjmp stopsim
+
+.global INT0_vect
+INT0_vect:
+    inc r20
+    reti
@@ -0,0 +1,28 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#undef _SFR_IO8
+#define _SFR_IO8(x) (x)
+
+#define EDGES 5
+
+; counts rising edges on INT0 (PD2), after EDGES edges it executes EICALL,
+; which is a illegal opcode on atmega32
+.global main
+main:
+    ldi r20, 0x00          ; count of edges
+    ldi r16, (1<<ISC01)|(1<<ISC00)
+    out MCUCR, r16
+    ldi r16, (1<<INT0)
+    out GICR, r16
+    sei
+
+loop:
+    cpi r20, EDGES
+    brne loop
+    .word 0x9519           ; EICALL
+
+.global INT0_vect
+INT0_vect:
+    inc r20
+    reti
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <string.h>
+using namespace std;
+
+#include "gtest.h"
+
+#include "avrdevice.h"
+#include "atmega16_32.h"
+#include "systemclock.h"
+#include "avrerror.h"
+#include "net.h"
+
+//! time quantum for parallel simulation, shorter than half signal period (23.75us)
+static const SystemClockOffset quantum = 5000;
+
+//! Create signal generator (tc1) and edge counter, connect generator PB3 to counter PD2
+static AvrDevice *CreateDevices(SystemClock &clock, Net &net, const char *counterFile) {
+    clock.ResetClock();
+    AvrDevice *gen = new AvrDevice_atmega32;
+    gen->Load("session_parallel/tc1.atmega32.o");
+    gen->SetClockFreq(250);     // 4MHz
+    clock.Add(gen);
+
+    AvrDevice *cnt = new AvrDevice_atmega32;
+    cnt->Load(counterFile);
+    cnt->SetClockFreq(100);     // 10MHz
+    clock.Add(cnt);
+
+    net.Add(gen->GetPin("B3"));
+    net.Add(cnt->GetPin("D2"));
+    return cnt;
+}
+
+// Parallel simulation with a quantum shorter than the signal period counts the
+// same edges as sequential simulation and stops on exit point of counter
+TEST( SESSION_PARALLEL, COMPARE_SEQUENTIAL )
+{
+    SystemClock &clock = SystemClock::Instance();
+
+    Net net1;
+    AvrDevice *cnt1 = CreateDevices(clock, net1, "session_parallel/tc2.atmega32.o");
+    cnt1->RegisterTerminationSymbol("stopsim");
+    clock.RunTimeRange(220000);
+    unsigned char edges1 = *(cnt1->rw[20]);
+    clock.Endless();
+    SystemClockOffset stop1 = clock.GetCurrentTime();
+    unsigned int pc1 = cnt1->PC;
+
+    Net net2;
+    AvrDevice *cnt2 = CreateDevices(clock, net2, "session_parallel/tc2.atmega32.o");
+    cnt2->RegisterTerminationSymbol("stopsim");
+    clock.SetParallel(2, quantum);
+    clock.RunTimeRange(220000);
+    unsigned char edges2 = *(cnt2->rw[20]);
+    clock.Endless();
+    SystemClockOffset stop2 = clock.GetCurrentTime();
+    unsigned int pc2 = cnt2->PC;
+    clock.SetParallel(0);
+
+    EXPECT_EQ(5, edges1) << "Wrong count of edges" << endl;
+    EXPECT_EQ(edges1, edges2) << "Different count of edges in parallel simulation" << endl;
+    EXPECT_EQ(20, (unsigned char)(*(cnt2->rw[20]))) << "Not stopped after all edges" << endl;
+    EXPECT_EQ(pc1, pc2) << "Not stopped on exit point" << endl;
+    // output changes are seen up to one quantum late, all partitions stop on next horizon
+    EXPECT_LE(stop1, stop2) << "Stopped too early" << endl;
+    EXPECT_GE(stop1 + 2 * quantum, stop2) << "Stopped too late" << endl;
+}
+
+// A fatal error on a partition thread stops the simulation and is raised
+// again on the calling thread
+TEST( SESSION_PARALLEL, ERROR_IN_PARTITION )
+{
+    SystemClock &clock = SystemClock::Instance();
+    SystemConsoleHandler &con = SystemConsoleHandler::Current();
+
+    Net net;
+    CreateDevices(clock, net, "session_parallel/tc3.atmega32.o");
+    clock.SetParallel(2, quantum);
+    con.SetUseExit(false);
+    bool raised = false;
+    try {
+        clock.RunTimeRange(1000000);
+    } catch(const char *msg) {
+        raised = true;
+        EXPECT_TRUE(strstr(msg, "Illegal opcode") != NULL) << "Wrong message: " << msg << endl;
+    }
+    std::ostream *wrn = con.GetWarningStream();
+    con.SetUseExit(true);
+    clock.SetParallel(0);
+
+    EXPECT_TRUE(raised) << "Error not raised" << endl;
+    EXPECT_GT(1000000, clock.GetCurrentTime()) << "Simulation not stopped" << endl;
+    EXPECT_EQ(&cerr, wrn) << "Warning stream of console handler not restored" << endl;
+}
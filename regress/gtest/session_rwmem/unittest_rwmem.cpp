@@ -0,0 +1,135 @@
+#include <iostream>
+using namespace std;
+
+#include "gtest.h"
+
+#include "avrdevice.h"
+#include "atmega16_32.h"
+#include "flash.h"
+#include "systemclock.h"
+#include "traceval.h"
+
+// Access by index operator on a plain cell goes to image and doesn't take
+// the cell from the fast path
+TEST( SESSION_RWMEM, PLAIN_VIEW )
+{
+    AvrDevice *dev = new AvrDevice_atmega32;
+
+    *(dev->rw[5]) = 0x12;
+    *(dev->rw[0x100]) = 0x34;
+    EXPECT_EQ(0x12, dev->rw.image[5]) << "Register not written to image" << endl;
+    EXPECT_EQ(0x34, dev->rw.image[0x100]) << "RAM not written to image" << endl;
+    dev->rw.image[0x101] = 0x56;
+    EXPECT_EQ(0x56, (unsigned char)*(dev->rw[0x101])) << "RAM not read from image" << endl;
+    EXPECT_EQ(0x56, dev->GetRWMem(0x101)) << "RAM not read from image" << endl;
+    EXPECT_TRUE(dev->rw.IsPlain(5)) << "Register isn't plain after access" << endl;
+    EXPECT_TRUE(dev->rw.IsPlain(0x100)) << "RAM isn't plain after access" << endl;
+    EXPECT_TRUE(dev->rw.IsPlain(0x101)) << "RAM isn't plain after access" << endl;
+    EXPECT_TRUE(dev->GetMemRegisterInstance(7) != NULL) << "No instance for register" << endl;
+    EXPECT_TRUE(dev->rw.IsPlain(7)) << "Register isn't plain after GetMemRegisterInstance" << endl;
+
+    // IO registers are dispatched always
+    EXPECT_FALSE(dev->rw.IsPlain(0x5f)) << "SREG is plain" << endl;
+    EXPECT_TRUE(dev->rw[0x5f] == dev->statusRegister) << "Wrong instance for SREG" << endl;
+
+    delete dev;
+}
+
+// A traced cell and a replaced cell are dispatched to their instance
+TEST( SESSION_RWMEM, TRACED_AND_REPLACED )
+{
+    AvrDevice *dev = new AvrDevice_atmega32;
+
+    TraceValue *tv = dev->coreTraceGroup.GetTraceValueByName("r9");
+    ASSERT_TRUE(tv != NULL) << "No trace value for r9" << endl;
+    EXPECT_FALSE(dev->rw.IsPlain(9)) << "Traced register is plain" << endl;
+    EXPECT_TRUE(dev->rw.IsPlain(8)) << "Neighbour of traced register isn't plain" << endl;
+    dev->SetCoreReg(9, 0x77);
+    EXPECT_EQ(0x77, dev->rw.image[9]) << "Traced register not written to image" << endl;
+    EXPECT_TRUE(tv->written()) << "Write on traced register not seen by trace value" << endl;
+
+    GPIORegister gpio(dev, &dev->coreTraceGroup, "");
+    dev->rw.SetMember(0x200, &gpio);
+    EXPECT_FALSE(dev->rw.IsPlain(0x200)) << "Replaced cell is plain" << endl;
+    dev->SetRWMem(0x200, 0x42);
+    EXPECT_EQ(0x42, (unsigned char)gpio) << "Write not dispatched to replaced cell" << endl;
+    EXPECT_EQ(0x42, dev->GetRWMem(0x200)) << "Read not dispatched to replaced cell" << endl;
+    EXPECT_TRUE(dev->rw[0x200] == &gpio) << "Wrong instance for replaced cell" << endl;
+
+    delete dev;
+}
+
+// A watchpoint on a register doesn't install a instance and the register is
+// plain again after removing, debugger access doesn't hit a watchpoint
+TEST( SESSION_RWMEM, WATCHPOINT_FLAGS )
+{
+    AvrDevice *dev = new AvrDevice_atmega32;
+    int kind;
+    unsigned int addr;
+
+    ASSERT_TRUE(dev->AddWatchpoint(5, 1, AvrDevice::WATCH_ACCESS)) << "Watchpoint not set" << endl;
+    ASSERT_TRUE(dev->AddWatchpoint(0x100, 2, AvrDevice::WATCH_WRITE)) << "Watchpoint not set" << endl;
+    EXPECT_FALSE(dev->rw.IsPlain(5)) << "Watched register is plain" << endl;
+    EXPECT_EQ(0, dev->rw.flags[5] & RWMemoryMap::FLAG_DISPATCH) << "Watched register is dispatched" << endl;
+
+    dev->SetRWMemDebug(5, 0x11);
+    dev->SetRWMemDebug(0x101, 0x22);
+    EXPECT_EQ(0x11, dev->GetRWMemDebug(5)) << "Wrong register value read by debugger" << endl;
+    EXPECT_EQ(0x22, dev->GetRWMemDebug(0x101)) << "Wrong RAM value read by debugger" << endl;
+    EXPECT_FALSE(dev->GetWatchHit(kind, addr)) << "Debugger access hits watchpoint" << endl;
+
+    dev->GetCoreReg(5);
+    ASSERT_TRUE(dev->GetWatchHit(kind, addr)) << "Register read doesn't hit watchpoint" << endl;
+    EXPECT_EQ(5U, addr) << "Wrong address of watchpoint hit" << endl;
+    dev->SetRWMem(0x101, 0x23);
+    ASSERT_TRUE(dev->GetWatchHit(kind, addr)) << "RAM write doesn't hit watchpoint" << endl;
+    EXPECT_EQ(0x101U, addr) << "Wrong address of watchpoint hit" << endl;
+    EXPECT_EQ(AvrDevice::WATCH_WRITE, kind) << "Wrong kind of watchpoint hit" << endl;
+
+    EXPECT_TRUE(dev->RemoveWatchpoint(5, 1, AvrDevice::WATCH_ACCESS)) << "Watchpoint not removed" << endl;
+    dev->DeleteAllWatchpoints();
+    EXPECT_TRUE(dev->rw.IsPlain(5)) << "Register isn't plain after removing watchpoint" << endl;
+    EXPECT_TRUE(dev->rw.IsPlain(0x100)) << "RAM isn't plain after removing watchpoint" << endl;
+    EXPECT_TRUE(dev->rw.IsPlain(0x101)) << "RAM isn't plain after removing watchpoint" << endl;
+
+    delete dev;
+}
+
+// Registers and RAM of atmega32 are plain cells of one image, IO registers are
+// dispatched, instructions write to the image and a trace value for a RAM cell
+// is created on demand
+TEST( SESSION_RWMEM, FLAT_IMAGE )
+{
+    AvrDevice *dev = new AvrDevice_atmega32;
+
+    for(unsigned a = 0; a < 0x20; a++)
+        EXPECT_TRUE(dev->rw.IsPlain(a)) << "Register isn't plain: " << a << endl;
+    for(unsigned a = 0x20; a < 0x60; a++)
+        EXPECT_NE(0, dev->rw.flags[a] & RWMemoryMap::FLAG_DISPATCH) << "IO register isn't dispatched: " << a << endl;
+    for(unsigned a = 0x60; a < 0x860; a++)
+        EXPECT_TRUE(dev->rw.IsPlain(a)) << "RAM isn't plain: " << a << endl;
+
+    // nop ; ldi r16,0xa5 ; sts 0x0200,r16 ; mov r5,r16 (5 cycles)
+    unsigned char code[] = { 0x00, 0x00, 0x05, 0xea, 0x00, 0x93, 0x00, 0x02, 0x50, 0x2e };
+    dev->Flash->WriteMem(code, 0, sizeof(code));
+    for(int i = 0; i < 5; i++) {
+        bool done;
+        dev->Step(done);
+    }
+    EXPECT_EQ(0xa5, dev->rw.image[0x200]) << "sts not written to image" << endl;
+    EXPECT_EQ(0xa5, dev->rw.image[5]) << "mov not written to image" << endl;
+    EXPECT_TRUE(dev->rw.IsPlain(0x200)) << "RAM isn't plain after sts" << endl;
+    EXPECT_TRUE(dev->rw.IsPlain(5)) << "Register isn't plain after mov" << endl;
+
+    // IRAM index counts from start of internal RAM
+    TraceValue *tv = dev->coreTraceGroup.GetTraceValueByName("IRAM416");
+    ASSERT_TRUE(tv != NULL) << "No trace value for IRAM416" << endl;
+    EXPECT_FALSE(dev->rw.IsPlain(0x200)) << "Traced RAM is plain" << endl;
+    EXPECT_TRUE(dev->rw.IsPlain(0x201)) << "Neighbour of traced RAM isn't plain" << endl;
+    EXPECT_EQ(0xa5, dev->GetRWMem(0x200)) << "Traced RAM lost image value" << endl;
+    dev->SetRWMem(0x200, 0x11);
+    EXPECT_EQ(0x11, dev->rw.image[0x200]) << "Traced RAM not written to image" << endl;
+    EXPECT_TRUE(tv->written()) << "Write on traced RAM not seen by trace value" << endl;
+
+    delete dev;
+}
@@ -0,0 +1,37 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#undef _SFR_IO8
+#define _SFR_IO8(x) (x)
+#undef _SFR_IO16
+#define _SFR_IO16(x) (x)
+
+#define WAKEUPS 8
+
+; timer 0 overflow wakes up the core from idle sleep mode, the core sleeps
+; 2048 cycles between wakeups, so the simulator could skip the sleep cycles
+.global main
+main:
+    ldi r20, 0x00          ; count of wakeups
+    ldi r16, (1<<SE)       ; enable idle sleep mode
+    out MCUCR, r16
+    ldi r16, (1<<TOIE0)    ; timer 0 overflow irq
+    out TIMSK, r16
+    ldi r16, (1<<CS01)     ; timer 0 clock is cpu clock / 8
+    out TCCR0, r16
+    sei
+
+loop:
+    sleep
+    in r21, TCNT0          ; timer value after wakeup
+    cpi r20, WAKEUPS
+    brne loop
+
+.global stopsim
+stopsim:
+    rjmp stopsim
+
+.global TIMER0_OVF_vect
+TIMER0_OVF_vect:
+    inc r20
+    reti
@@ -0,0 +1,43 @@
+#include <iostream>
+using namespace std;
+
+#include "gtest.h"
+
+#include "avrdevice.h"
+#include "atmega16_32.h"
+#include "systemclock.h"
+
+// Wakeup of a sleeping core by timer irq must happen on the same cycle, if
+// sleep cycles are skipped (Endless, Run) or not (single steps, like scripts)
+TEST( SESSION_SLEEP, TIMER_WAKEUP )
+{
+    SystemClock &clock = SystemClock::Instance();
+
+    clock.ResetClock();
+    AvrDevice *dev1 = new AvrDevice_atmega32;
+    dev1->Load("session_sleep/tc1.atmega32.o");
+    dev1->SetClockFreq(125);    // 8MHz
+    dev1->RegisterTerminationSymbol("stopsim");
+    clock.Add(dev1);
+    long skipSteps = clock.Endless();
+    SystemClockOffset skipTime = clock.GetCurrentTime();
+
+    clock.ResetClock();
+    AvrDevice *dev2 = new AvrDevice_atmega32;
+    dev2->Load("session_sleep/tc1.atmega32.o");
+    dev2->SetClockFreq(125);
+    dev2->RegisterTerminationSymbol("stopsim");
+    clock.Add(dev2);
+    long steps = 0;
+    bool untilCoreStepFinished = false;
+    do {
+        steps++;
+    } while(clock.Step(untilCoreStepFinished) == 0);
+
+    EXPECT_EQ(8, (unsigned char)(*(dev1->rw[20]))) << "Wrong count of wakeups" << endl;
+    EXPECT_EQ(8, (unsigned char)(*(dev2->rw[20]))) << "Wrong count of wakeups without skip" << endl;
+    EXPECT_EQ((unsigned char)(*(dev2->rw[21])), (unsigned char)(*(dev1->rw[21]))) << "Different timer value after wakeup" << endl;
+    EXPECT_EQ(dev2->GetCycleCounter(), dev1->GetCycleCounter()) << "Different cycle count" << endl;
+    EXPECT_EQ(clock.GetCurrentTime(), skipTime) << "Different simulation time" << endl;
+    EXPECT_LT(skipSteps, steps) << "Sleep cycles not skipped" << endl;
+}
@@ -0,0 +1,43 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#undef _SFR_IO8
+#define _SFR_IO8(x) (x)
+#undef _SFR_IO16
+#define _SFR_IO16(x) (x)
+
+#define OVERFLOWS 10
+#define COUNTER 0x0100
+
+; timer 0 overflow irq counts in r20 and in RAM, main loop counts loops in
+; r23:r22, so the state at end depends on core, RAM, timer and irq state
+.global main
+main:
+    ldi r20, 0x00          ; count of overflows
+    ldi r22, 0x00          ; count of loops
+    ldi r23, 0x00
+    ldi r16, (1<<TOIE0)    ; timer 0 overflow irq
+    out TIMSK, r16
+    ldi r16, (1<<CS01)     ; timer 0 clock is cpu clock / 8
+    out TCCR0, r16
+    sei
+
+loop:
+    subi r22, 0xff         ; r23:r22 += 1
+    sbci r23, 0xff
+    cpi r20, OVERFLOWS
+    brne loop
+
+.global stopsim
+stopsim:
+    rjmp stopsim
+
+.global TIMER0_OVF_vect
+TIMER0_OVF_vect:
+    push r16
+    in r16, SREG
+    inc r20
+    sts COUNTER, r20
+    out SREG, r16
+    pop r16
+    reti
@@ -0,0 +1,9 @@
+; another program, a state of tc1 doesn't fit to it
+.global main
+main:
+    inc r16
+    rjmp main
+
+.global stopsim
+stopsim:
+    rjmp stopsim
@@ -0,0 +1,131 @@
+#include <iostream>
+#include <string>
+#include <string.h>
+using namespace std;
+
+#include "gtest.h"
+
+#include "avrdevice.h"
+#include "atmega16_32.h"
+#include "systemclock.h"
+#include "simulationcontext.h"
+#include "avrerror.h"
+
+//! Values of a device, which are compared between runs
+struct DeviceState {
+    unsigned char regs[32];
+    unsigned char counter;
+    int sreg;
+    unsigned int pc;
+    unsigned long long cycles;
+    SystemClockOffset time;
+};
+
+static void GetDeviceState(AvrDevice *dev, SystemClock &clock, DeviceState &s) {
+    for(int i = 0; i < 32; i++)
+        s.regs[i] = *(dev->rw[i]);
+    s.counter = *(dev->rw[0x100]);
+    s.sreg = *(dev->status);
+    s.pc = dev->PC;
+    s.cycles = dev->GetCycleCounter();
+    s.time = clock.GetCurrentTime();
+}
+
+//! Create a device in current context and add it to clock
+static AvrDevice *CreateDevice(SystemClock &clock, AvrDevice *dev, const char *file) {
+    dev->Load(file);
+    dev->SetClockFreq(125);     // 8MHz
+    dev->RegisterTerminationSymbol("stopsim");
+    clock.Add(dev);
+    return dev;
+}
+
+//! Run tc1 for 1ms and return the saved state
+static string SaveTc1State(void) {
+    SimulationContext ctx;
+    SimulationContext::Scope scope(ctx);
+    SystemClock &clock = ctx.GetSystemClock();
+    AvrDevice *dev = CreateDevice(clock, new AvrDevice_atmega32, "session_snapshot/tc1.atmega32.o");
+    clock.RunTimeRange(1000000);
+    string state = clock.SaveState();
+    delete dev;
+    return state;
+}
+
+//! Restore state into a new device, returns the error message or "" if restored
+static string RestoreInto(const string &state, AvrDevice *(*create)(void), const char *file) {
+    SimulationContext ctx;
+    SimulationContext::Scope scope(ctx);
+    ctx.GetConsoleHandler().SetUseExit(false);
+    SystemClock &clock = ctx.GetSystemClock();
+    AvrDevice *dev = CreateDevice(clock, create(), file);
+    string msg;
+    try {
+        clock.RestoreState(state);
+    } catch(const char *m) {
+        msg = m;
+    }
+    delete dev;
+    return msg;
+}
+
+static AvrDevice *NewAtmega32(void) { return new AvrDevice_atmega32; }
+static AvrDevice *NewAtmega16(void) { return new AvrDevice_atmega16; }
+
+// Save, restore into a new simulation and continue gives the same result as
+// a simulation, which runs straight on
+TEST( SESSION_SNAPSHOT, RESTORE_CONTINUE )
+{
+    string state;
+    unsigned char overflowsOnSave;
+    DeviceState straight, restored;
+
+    {
+        SimulationContext ctx;
+        SimulationContext::Scope scope(ctx);
+        SystemClock &clock = ctx.GetSystemClock();
+        AvrDevice *dev = CreateDevice(clock, new AvrDevice_atmega32, "session_snapshot/tc1.atmega32.o");
+        clock.RunTimeRange(1000000);
+        state = clock.SaveState();
+        overflowsOnSave = *(dev->rw[20]);
+        clock.Endless();
+        GetDeviceState(dev, clock, straight);
+        delete dev;
+    }
+
+    {
+        SimulationContext ctx;
+        SimulationContext::Scope scope(ctx);
+        SystemClock &clock = ctx.GetSystemClock();
+        AvrDevice *dev = CreateDevice(clock, new AvrDevice_atmega32, "session_snapshot/tc1.atmega32.o");
+        clock.RestoreState(state);
+        clock.Endless();
+        GetDeviceState(dev, clock, restored);
+        delete dev;
+    }
+
+    EXPECT_LT(0, overflowsOnSave) << "State saved before first irq" << endl;
+    EXPECT_GT(10, overflowsOnSave) << "State saved after end" << endl;
+    EXPECT_EQ(10, straight.regs[20]) << "Wrong count of overflows" << endl;
+    for(int i = 0; i < 32; i++)
+        EXPECT_EQ(straight.regs[i], restored.regs[i]) << "Different value of r" << i << endl;
+    EXPECT_EQ(straight.counter, restored.counter) << "Different value in RAM" << endl;
+    EXPECT_EQ(straight.sreg, restored.sreg) << "Different SREG" << endl;
+    EXPECT_EQ(straight.pc, restored.pc) << "Different PC" << endl;
+    EXPECT_EQ(straight.cycles, restored.cycles) << "Different cycle count" << endl;
+    EXPECT_EQ(straight.time, restored.time) << "Different simulation time" << endl;
+}
+
+// A state doesn't fit to a device with another program
+TEST( SESSION_SNAPSHOT, OTHER_PROGRAM )
+{
+    string msg = RestoreInto(SaveTc1State(), NewAtmega32, "session_snapshot/tc2.atmega32.o");
+    EXPECT_TRUE(strstr(msg.c_str(), "flash checksum") != NULL) << "Wrong error: '" << msg << "'" << endl;
+}
+
+// A state doesn't fit to another device type
+TEST( SESSION_SNAPSHOT, OTHER_DEVICE )
+{
+    string msg = RestoreInto(SaveTc1State(), NewAtmega16, "session_snapshot/tc1.atmega32.o");
+    EXPECT_TRUE(strstr(msg.c_str(), "doesn't fit") != NULL) << "Wrong error: '" << msg << "'" << endl;
+}
@@ -0,0 +1,163 @@
+#include <iostream>
+using namespace std;
+
+#include "gtest.h"
+
+#include "avrdevice.h"
+#include "atmega16_32.h"
+#include "flash.h"
+#include "hwsreg.h"
+
+enum { C = 0x01, Z = 0x02, N = 0x04, V = 0x08, S = 0x10, H = 0x20 };
+
+//! Instructions under test, operands are r16 (Rd) and r17 (Rr)
+enum Op { ADD, ADC, SUB, SBC, CPC, NEG, INC, DEC, OPS };
+
+static const char *opNames[OPS] = { "ADD", "ADC", "SUB", "SBC", "CPC", "NEG", "INC", "DEC" };
+
+static unsigned int Opcode(Op op) {
+    switch(op) {
+        case ADD: return 0x0f01; // add r16, r17
+        case ADC: return 0x1f01; // adc r16, r17
+        case SUB: return 0x1b01; // sub r16, r17
+        case SBC: return 0x0b01; // sbc r16, r17
+        case CPC: return 0x0701; // cpc r16, r17
+        case NEG: return 0x9501; // neg r16
+        case INC: return 0x9503; // inc r16
+        default:  return 0x950a; // dec r16
+    }
+}
+
+//! Reference: result in rd and SREG after instruction, from AVR instruction set manual
+static void Expected(Op op, unsigned char &rd, unsigned char rr, unsigned char &sreg) {
+    unsigned char d = rd, r = 0;
+    int c = sreg & C;
+    unsigned char flags = 0;
+    switch(op) {
+        case ADD:
+        case ADC: {
+            int ci = (op == ADC) ? c : 0;
+            r = d + rr + ci;
+            if((d & 0xf) + (rr & 0xf) + ci > 0xf) flags |= H;
+            if(d + rr + ci > 0xff) flags |= C;
+            if((d ^ r) & (rr ^ r) & 0x80) flags |= V;
+            if(r == 0) flags |= Z;
+            break;
+        }
+        case SUB:
+        case SBC:
+        case CPC: {
+            int ci = (op == SUB) ? 0 : c;
+            r = d - rr - ci;
+            if((d & 0xf) < (rr & 0xf) + ci) flags |= H;
+            if(d < rr + ci) flags |= C;
+            if((d ^ rr) & (d ^ r) & 0x80) flags |= V;
+            if(r == 0 && (op == SUB || (sreg & Z))) flags |= Z;
+            break;
+        }
+        case NEG:
+            r = 0 - d;
+            if((r | d) & 0x08) flags |= H;
+            if(r != 0) flags |= C;
+            if(r == 0x80) flags |= V;
+            if(r == 0) flags |= Z;
+            break;
+        case INC:
+            r = d + 1;
+            flags |= sreg & (H | C);
+            if(d == 0x7f) flags |= V;
+            if(r == 0) flags |= Z;
+            break;
+        default:
+            r = d - 1;
+            flags |= sreg & (H | C);
+            if(d == 0x80) flags |= V;
+            if(r == 0) flags |= Z;
+            break;
+    }
+    if(r & 0x80) flags |= N;
+    if(((flags & N) != 0) != ((flags & V) != 0)) flags |= S;
+    if(op != CPC)
+        rd = r;
+    sreg = (sreg & 0xc0) | flags;
+}
+
+//! Process one instruction including wait cycles
+static void Instruction(AvrDevice *dev) {
+    bool done = false;
+    do {
+        dev->Step(done);
+    } while(!done);
+}
+
+// Flags of arithmetic instructions are right, if SREG is read by IN SREG
+// (GetIOReg), data memory access, the SREG register instance, the
+// conversion of HWSreg or only by a branch
+TEST( SESSION_SREG, ARITHMETIC_FLAGS )
+{
+    static const unsigned char values[] = { 0x00, 0x01, 0x0f, 0x10, 0x7f, 0x80, 0x81, 0xfe, 0xff };
+    static const unsigned char sregs[] = { 0x00, 0x41, 0x02, 0x7f };
+    const int nvalues = sizeof(values) / sizeof(values[0]);
+    const int nsregs = sizeof(sregs) / sizeof(sregs[0]);
+    AvrDevice *dev = new AvrDevice_atmega32;
+    int n = 0;
+
+    for(int op = 0; op < OPS; op++) {
+        for(int i = 0; i < nvalues; i++) for(int j = 0; j < nvalues; j++) for(int k = 0; k < nsregs; k++, n++) {
+            unsigned char rd = values[i], rr = values[j], sreg = sregs[k];
+            unsigned char expRd = rd, expSreg = sreg;
+            Expected((Op)op, expRd, rr, expSreg);
+
+            // instruction, then BRBS with a flag and offset 1
+            int bit = n % 6;
+            unsigned int brbs = 0xf000 | (1 << 3) | bit;
+            unsigned char code[6] = { Opcode((Op)op) & 0xff, Opcode((Op)op) >> 8, brbs & 0xff, brbs >> 8, 0, 0 };
+            dev->Flash->WriteMem(code, 0, sizeof(code));
+            dev->SetCoreReg(16, rd);
+            dev->SetCoreReg(17, rr);
+            *(dev->status) = sreg;
+            dev->PC = 0;
+
+            Instruction(dev);
+            ASSERT_EQ(expRd, dev->GetCoreReg(16)) << opNames[op] << " " << (int)rd << "," << (int)rr << ": wrong result" << endl;
+            int got = -1;
+            switch(n % 5) {
+                case 0: got = dev->GetIOReg(0x3f); break;
+                case 1: got = dev->GetRWMem(0x5f); break;
+                case 2: got = (unsigned char)*(dev->rw[0x5f]); break;
+                case 3: got = (int)*(dev->status); break;
+                default: break; // only branch reads flags
+            }
+            if(got >= 0)
+                ASSERT_EQ(expSreg, got) << opNames[op] << " " << (int)rd << "," << (int)rr << " SREG " << (int)sreg
+                                        << ": wrong flags, read " << (n % 5) << endl;
+
+            Instruction(dev);
+            unsigned int expPC = (expSreg & (1 << bit)) ? 3 : 2;
+            ASSERT_EQ(expPC, dev->PC) << opNames[op] << " " << (int)rd << "," << (int)rr << " SREG " << (int)sreg
+                                      << ": wrong branch on bit " << bit << endl;
+            ASSERT_EQ(expSreg, (int)*(dev->status)) << opNames[op] << ": wrong flags after branch" << endl;
+            dev->status->Update();
+            ASSERT_EQ(((expSreg & Z) != 0), dev->status->Z) << opNames[op] << ": wrong Z member" << endl;
+            ASSERT_EQ(((expSreg & C) != 0), dev->status->C) << opNames[op] << ": wrong C member" << endl;
+        }
+    }
+
+    delete dev;
+}
+
+// A flag set directly after a lazy operation keeps the other pending flags
+TEST( SESSION_SREG, SET_AFTER_LAZY )
+{
+    HWSreg s;
+    s = 0;
+    s.SetLazy(HWSreg::LAZY_ADD, 0x100, 0x80, 0x80); // 0x80 + 0x80
+    s.Update();
+    s.Z = false;
+    EXPECT_EQ(C | V | S, (int)s) << "Wrong flags after set of Z" << endl;
+
+    s = 0x80;
+    s.SetLazy(HWSreg::LAZY_SUB, 0xff, 0x05, 0x06); // 5 - 6
+    s.SetLazy(HWSreg::LAZY_INC, 0x01, 0x00);        // inc 0, keeps H and C of SUB
+    EXPECT_EQ(0x80 | H | C, (int)s) << "Wrong flags after sub and inc" << endl;
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+using namespace std;
+
+#include "gtest.h"
+
+#include "memory.h"
+#include "avrerror.h"
+#include "simulationcontext.h"
+
+//! Symbols added out of order, two symbols on one address
+static void AddSymbols(Memory &m) {
+    m.AddSymbol(make_pair(0x40u, string("stop")));
+    m.AddSymbol(make_pair(0x10u, string("main")));
+    m.AddSymbol(make_pair(0x20u, string("loop")));
+    m.AddSymbol(make_pair(0x10u, string("start")));
+}
+
+// Address on, between, before and behind symbols
+TEST( SESSION_SYMBOLS, SYMBOL_AT_ADDRESS )
+{
+    Data d;
+    EXPECT_EQ("", d.GetSymbolAtAddress(0x10)) << "Symbol without symbols" << endl;
+
+    AddSymbols(d);
+    EXPECT_EQ("", d.GetSymbolAtAddress(0)) << "Symbol before first symbol" << endl;
+    EXPECT_EQ("", d.GetSymbolAtAddress(0xf)) << "Symbol before first symbol" << endl;
+    EXPECT_EQ("main,start", d.GetSymbolAtAddress(0x10)) << "Wrong symbols on address" << endl;
+    EXPECT_EQ("main,start+0x1", d.GetSymbolAtAddress(0x11)) << "Wrong offset between symbols" << endl;
+    EXPECT_EQ("main,start+0xf", d.GetSymbolAtAddress(0x1f)) << "Wrong offset before next symbol" << endl;
+    EXPECT_EQ("loop", d.GetSymbolAtAddress(0x20)) << "Wrong symbol" << endl;
+    EXPECT_EQ("loop+0x1f", d.GetSymbolAtAddress(0x3f)) << "Wrong offset before last symbol" << endl;
+    EXPECT_EQ("stop", d.GetSymbolAtAddress(0x40)) << "Wrong last symbol" << endl;
+    EXPECT_EQ("stop+0x11f4", d.GetSymbolAtAddress(0x1234)) << "Wrong offset behind last symbol" << endl;
+    EXPECT_EQ("stop+0xffffffbf", d.GetSymbolAtAddress(0xffffffff)) << "Wrong offset on highest address" << endl;
+
+    // symbol added after lookup
+    d.AddSymbol(make_pair(0x30u, string("isr")));
+    EXPECT_EQ("loop+0xf", d.GetSymbolAtAddress(0x2f)) << "Wrong offset before added symbol" << endl;
+    EXPECT_EQ("isr+0x1", d.GetSymbolAtAddress(0x31)) << "Added symbol not found" << endl;
+}
+
+// Address of a symbol, the lowest one for a symbol on more addresses, hex
+// strings are converted
+TEST( SESSION_SYMBOLS, ADDRESS_AT_SYMBOL )
+{
+    SystemConsoleHandler console;
+    ostringstream warnings;
+    console.SetUseExit(false);
+    console.SetWarningStream(&warnings);
+    SimulationContext ctx(&console);
+    SimulationContext::Scope scope(ctx);
+
+    Data d;
+    AddSymbols(d);
+    EXPECT_EQ(0x40u, d.GetAddressAtSymbol("stop")) << "Wrong address" << endl;
+    EXPECT_EQ(0x10u, d.GetAddressAtSymbol("start")) << "Wrong address for second symbol on address" << endl;
+    EXPECT_EQ(0x1au, d.GetAddressAtSymbol("1a")) << "Hex string not converted" << endl;
+
+    d.AddSymbol(make_pair(0x50u, string("main")));
+    EXPECT_EQ(0x10u, d.GetAddressAtSymbol("main")) << "Not lowest address of symbol" << endl;
+    EXPECT_EQ("main", d.GetSymbolAtAddress(0x50)) << "Added symbol not found" << endl;
+
+    bool caught = false;
+    try {
+        d.GetAddressAtSymbol("missing");
+    } catch(const char *msg) {
+        caught = true;
+        EXPECT_NE(string::npos, string(msg).find("'missing' not found")) << "Wrong error: " << msg << endl;
+    }
+    EXPECT_TRUE(caught) << "No error for unknown symbol" << endl;
+}
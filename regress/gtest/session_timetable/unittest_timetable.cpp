@@ -0,0 +1,106 @@
+#include <iostream>
+#include <vector>
+using namespace std;
+
+#include <stdlib.h>
+
+#include "gtest.h"
+
+#include "systemclock.h"
+#include "simulationmember.h"
+
+//! Simulation member, which is only scheduled, never stepped
+class Event: public SimulationMember {
+    public:
+        int Step(bool &trueHwStep, SystemClockOffset *timeToNextStepIn_ns) { return 0; }
+};
+
+//! Removes all members from table, appends their index in events and checks, that time doesn't go back
+static vector<int> Drain(TimeTable &tt, Event *events) {
+    vector<int> order;
+    SystemClockOffset last = 0;
+    while(!tt.IsEmpty()) {
+        SystemClockOffset min = tt.GetMinimumKey();
+        SystemClockOffset key;
+        SimulationMember *m = tt.RemoveMinimum(key);
+        EXPECT_EQ(min, key) << "GetMinimumKey differs from removed time" << endl;
+        EXPECT_LE(last, key) << "Time goes back" << endl;
+        last = key;
+        order.push_back((Event *)m - events);
+    }
+    return order;
+}
+
+//! Equal, past and far future times: past members come first, members with
+//! equal time in order of insertion
+static void CheckOrder(TimeTable &tt) {
+    Event e[8];
+    const SystemClockOffset far = 1000000000000LL; // many wheel turns ahead
+    tt.Insert(1000, &e[0]);
+    tt.Insert(far, &e[1]);
+    tt.Insert(1000, &e[2]);
+    tt.Insert(1000000, &e[3]);  // some wheel turns ahead
+    tt.Insert(1000, &e[4]);
+
+    SystemClockOffset key;
+    EXPECT_EQ(&e[0], tt.RemoveMinimum(key)) << "First of equal times not first" << endl;
+    EXPECT_EQ(1000, key);
+    // before the time of the last removed member
+    tt.Insert(500, &e[5]);
+    tt.Insert(1000, &e[6]);
+    tt.Insert(far, &e[7]);
+
+    int expected[] = { 5, 2, 4, 6, 3, 1, 7 };
+    vector<int> order = Drain(tt, e);
+    ASSERT_EQ(7u, order.size());
+    for(int i = 0; i < 7; i++)
+        EXPECT_EQ(expected[i], order[i]) << "Wrong member at position " << i << endl;
+}
+
+TEST( SESSION_TIMETABLE, ORDER_HEAP )
+{
+    HeapTimeTable tt;
+    CheckOrder(tt);
+}
+
+TEST( SESSION_TIMETABLE, ORDER_WHEEL )
+{
+    TimingWheel tt;
+    CheckOrder(tt);
+}
+
+// Both backends return the same order for a simulation like sequence of
+// removals and inserts with many equal times, also after removal of members
+TEST( SESSION_TIMETABLE, SAME_ORDER_BOTH_BACKENDS )
+{
+    const int count = 40;
+    Event e[count];
+    HeapTimeTable heap;
+    TimingWheel wheel;
+    srand(1);
+    for(int i = 0; i < count; i++) {
+        SystemClockOffset t = (rand() % 8) * 125;
+        heap.Insert(t, &e[i]);
+        wheel.Insert(t, &e[i]);
+    }
+    for(int step = 0; step < 2000; step++) {
+        SystemClockOffset hk, wk;
+        SimulationMember *h = heap.RemoveMinimum(hk);
+        SimulationMember *w = wheel.RemoveMinimum(wk);
+        ASSERT_EQ(hk, wk) << "Different time in step " << step << endl;
+        ASSERT_EQ(h, w) << "Different member in step " << step << endl;
+        // cores with 8MHz and 16MHz clock, seldom a long sleep
+        SystemClockOffset next = hk + ((rand() % 2) ? 125 : 62) + ((rand() % 100 == 0) ? 100000000 : 0);
+        heap.Insert(next, h);
+        wheel.Insert(next, w);
+        if(step % 100 == 50) {
+            Event *r = &e[rand() % count];
+            ASSERT_EQ(heap.Remove(r), wheel.Remove(r)) << "Remove differs in step " << step << endl;
+            heap.Insert(hk + 125, r);
+            wheel.Insert(hk + 125, r);
+        }
+    }
+    vector<int> ho = Drain(heap, e);
+    vector<int> wo = Drain(wheel, e);
+    EXPECT_TRUE(ho == wo) << "Different order of remaining members" << endl;
+}
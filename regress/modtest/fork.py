@@ -0,0 +1,75 @@
+import sys
+from simtestutil import SimTestCase, SimTestLoader
+import pysimulavr
+
+class TestCase(SimTestCase):
+
+  ADC_CLOCK = 8000 # ADC clock is 125kHz
+
+  adc0_pin = {
+    "atmega8":   "C0",
+    "atmega16":  "A0",
+  }
+
+  # analog level on ADC0 for each forked simulation
+  levels = (0.5, 1.25, 2.0)
+
+  def adcValue(self, level):
+    return int((level / 2.5) * 1024) & 0x3ff
+
+  def runChild(self, fork, apin):
+    """convert own analog level, write result to stdout and exit"""
+    code = 100
+    try:
+      level = self.levels[fork.GetChildIndex()]
+      apin.SetAnalogValue(level)
+      self.sim.setByteByName(self.dev, "complete", 2)
+      self.sim.doRun(self.sim.getCurrentTime() + (15 * self.ADC_CLOCK))
+      sys.stdout.write("adc=%d\n" % self.sim.getWordByName(self.dev, "adc_value"))
+      if self.sim.getByteByName(self.dev, "complete") == 1:
+        code = fork.GetChildIndex() + 1
+    except Exception as e:
+      sys.stdout.write("error: %s\n" % str(e))
+    sys.stdout.flush()
+    pysimulavr.SimulationFork.Exit(code)
+
+  def test_00(self):
+    """check forked simulations with own analog input"""
+    self.assertDevice()
+    self.assertStartTime()
+    apin = pysimulavr.Pin(1.0) # set to 1V level
+    net1 = pysimulavr.Net()
+    net1.Add(apin)
+    net1.Add(self.dev.GetPin(self.adc0_pin[self.processorName]))
+    rpin = pysimulavr.Pin(2.5) # set to 2.5V level
+    net2 = pysimulavr.Net()
+    net2.Add(rpin)
+    net2.Add(self.dev.GetPin("AREF"))
+    # warm up: first conversion in parent
+    self.assertInitDone()
+    self.sim.doRun(self.sim.getCurrentTime() + (27 * self.ADC_CLOCK))
+    self.assertEqual(self.sim.getWordByName(self.dev, "adc_value"), self.adcValue(1.0))
+    forkTime = self.sim.getCurrentTime()
+    # less parallel children than forks, so Fork has to wait for a child
+    sys.stdout.flush()
+    fork = pysimulavr.SimulationFork(2)
+    for i in range(len(self.levels)):
+      if fork.Fork():
+        self.runChild(fork, apin)
+    fork.Wait()
+    self.assertEqual(fork.GetChildCount(), len(self.levels))
+    for i in range(len(self.levels)):
+      self.assertEqual(fork.GetOutput(i), "adc=%d\n" % self.adcValue(self.levels[i]),
+                       "output of child %d: %s" % (i, fork.GetOutput(i)))
+      self.assertEqual(fork.GetExitCode(i), i + 1, "exit code of child %d" % i)
+    # children don't change the parent simulation
+    self.assertEqual(self.sim.getCurrentTime(), forkTime)
+    self.assertEqual(self.sim.getWordByName(self.dev, "adc_value"), self.adcValue(1.0))
+
+if __name__ == '__main__':
+
+  from unittest import TextTestRunner
+  tests = SimTestLoader("fork_atmega16.elf").loadTestsFromTestCase(TestCase)
+  TextTestRunner(verbosity = 2).run(tests)
+
+# EOF
@@ -0,0 +1,65 @@
+from simtestutil import PyTestCase, PyTestLoader
+import pysimulavr
+
+class TestCase(PyTestCase):
+
+  """
+  This testcase checks the flag access of SREG from python. Flags H, S, V, N,
+  Z and C are calculated on demand after a arithmetic operation, the flag
+  attributes have to give the calculated values.
+  """
+
+  def setUp(self):
+    # create a avr core, type isn't important
+    self.core = pysimulavr.AvrFactory.instance().makeDevice("atmega16")
+    self.sreg = self.core.status
+
+  def tearDown(self):
+    del self.sreg
+    del self.core
+
+  def test_00(self):
+    """read flags after pending add operation"""
+    self.sreg.SetValue(0)
+    self.sreg.SetLazy(pysimulavr.HWSreg.LAZY_ADD, 0x100, 0x80, 0x80) # 0x80 + 0x80
+    self.assertTrue(self.sreg.C, "C is set")
+    self.assertTrue(self.sreg.Z, "Z is set")
+    self.assertTrue(self.sreg.V, "V is set")
+    self.assertFalse(self.sreg.N, "N is clear")
+    self.assertTrue(self.sreg.S, "S is set")
+    self.assertFalse(self.sreg.H, "H is clear")
+    self.assertEqual(self.sreg.GetValue(), 0x1b, "SREG value is 0x1b")
+
+  def test_01(self):
+    """read value after pending sub operation"""
+    self.sreg.SetValue(0x80)
+    self.sreg.SetLazy(pysimulavr.HWSreg.LAZY_SUB, 0xff, 0x05, 0x06) # 5 - 6
+    self.assertEqual(self.sreg.GetValue(), 0xb5, "SREG value is 0xb5")
+
+  def test_02(self):
+    """set a flag after pending sub operation, other flags are kept"""
+    self.sreg.SetValue(0x80)
+    self.sreg.SetLazy(pysimulavr.HWSreg.LAZY_SUB, 0xff, 0x05, 0x06) # 5 - 6
+    self.sreg.Z = True
+    self.assertTrue(self.sreg.Z, "Z is set")
+    self.assertTrue(self.sreg.H, "H is set")
+    self.assertTrue(self.sreg.C, "C is set")
+    self.assertEqual(self.sreg.GetValue(), 0xb7, "SREG value is 0xb7")
+
+  def test_03(self):
+    """I and T flag aren't calculated"""
+    self.sreg.SetValue(0)
+    self.sreg.I = True
+    self.sreg.T = True
+    self.sreg.SetLazy(pysimulavr.HWSreg.LAZY_INC, 0x01, 0x00) # inc 0
+    self.assertTrue(self.sreg.I, "I is set")
+    self.assertTrue(self.sreg.T, "T is set")
+    self.assertEqual(self.sreg.GetValue(), 0xc0, "SREG value is 0xc0")
+
+if __name__ == '__main__':
+
+  from unittest import TextTestRunner
+  tests = PyTestLoader("sreg").loadTestsFromTestCase(TestCase)
+  TextTestRunner(verbosity = 2).run(tests)
+
+# EOF
@@ -254,6 +254,30 @@ class opcode_rampz_mixin:
 		return self.target.write_sram(self.rampz_register_address, 1, [val])
 
 
+class sequence_mixin:
+	"""Mixin Class for testing sequences of instructions.
+
+	setup() returns a list of 16 bit words, the last one must be a BREAK
+	instruction. The sequence is run with a continue command till BREAK, so in
+	fast core mode the register operations are processed as a block.
+	"""
+	BREAK = 0x9598
+
+	def run(self):
+		self.ensure_target_supports_opcode()
+		self.common_setup()
+		self.reply = self.target.cont()
+		if self.reply[:3] != 'T05':
+			raise TestFail, 'Not stopped by BREAK: reply=%s' % (self.reply)
+		self.common_analyze_results()
+
+	def common_build_opcode(self, raw_opcode):
+		"""Build up the opcode array for a single word or a list of words.
+		"""
+		if type(raw_opcode) != type([]):
+			raw_opcode = [raw_opcode]
+		return array.array( 'B', struct.pack('<%dH' % len(raw_opcode), *raw_opcode) )
+
 class opcode_32_test(opcode_32_mixin, opcode_test):
 	pass
 
@@ -273,3 +297,6 @@ class opcode_eind_test(opcode_eind_mixin, opcode_test):
 
 class opcode_rampz_test(opcode_rampz_mixin, opcode_test):
 	pass
+
+class sequence_test(sequence_mixin, opcode_test):
+	pass
@@ -54,6 +54,10 @@ class GdbRemoteSerialProtocol:
 	  S   step with signal
 	  z   remove break or watchpoint
 	  Z   insert break or watchpoint
+	  X   write memory with binary data
+	  vFlashErase, vFlashWrite, vFlashDone  program flash
+	  qXfer:memory-map:read  read memory map
+	  QStartNoAckMode  stop acknowledging packets
 	"""
 	
 	def __init__(self, host='localhost', port=1212, ofile=None):
@@ -61,6 +65,9 @@ class GdbRemoteSerialProtocol:
 		"""
 		# where to write the output of print statements
 		self.ofile = ofile
+
+		# packets are acknowledged until QStartNoAckMode
+		self.noack = False
 		
 		# connect to remote target
 		self.socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
@@ -95,10 +102,15 @@ class GdbRemoteSerialProtocol:
 		self.out( 'Send: "+" (Ack)' )
 		self.socket.send('+')
 		
+	def packet(self, msg):
+		return '$'+msg+'#'+'%02x'%(self.cksum(msg))
+
 	def send(self, msg):
-		s = '$'+msg+'#'+'%02x'%(self.cksum(msg))
+		s = self.packet(msg)
 		self.out( 'Sent: "%s"' % (s) )
 		self.socket.send(s)
+		if self.noack:
+			return
 		reply = self.socket.recv(1)
 		if reply != '+':
 			raise ErrReply, reply
@@ -132,6 +144,19 @@ class GdbRemoteSerialProtocol:
 
 		return None
 
+	def escape(self, arr):
+		"""Convert an array of 8-bit binary values to the binary data of a X or
+		vFlashWrite packet.
+		"""
+		s = ''
+		for i in arr:
+			if chr(i) in '#$}*':
+				s += '}' + chr(i ^ 0x20)
+			else:
+				s += chr(i)
+
+		return s
+
 	def str2bin(self, s):
 		"""Convert a string of ascii hex digit pairs to an array of 8-bit binary values.
 		"""
@@ -211,6 +236,58 @@ class GdbRemoteSerialProtocol:
 			raise ErrReply
 		self.out( 'Recv: "%s"' % (reply) )
 
+	def write_mem_binary(self, addr, buf):
+		self.send( 'X%x,%x:' %(addr,len(buf)) + self.escape(buf) )
+		reply = self.recv()
+		if reply != 'OK':
+			raise ErrReply
+		self.out( 'Recv: "%s"' % (reply) )
+
+	def flash_erase(self, addr, _len):
+		self.send( 'vFlashErase:%x,%x' % (addr,_len) )
+		reply = self.recv()
+		if reply != 'OK':
+			raise ErrReply
+		self.out( 'Recv: "%s"' % (reply) )
+
+	def flash_write(self, addr, buf):
+		self.send( 'vFlashWrite:%x:' % (addr) + self.escape(buf) )
+		reply = self.recv()
+		if reply != 'OK':
+			raise ErrReply
+		self.out( 'Recv: "%s"' % (reply) )
+
+	def flash_done(self):
+		self.send( 'vFlashDone' )
+		reply = self.recv()
+		if reply != 'OK':
+			raise ErrReply
+		self.out( 'Recv: "%s"' % (reply) )
+
+	def read_memory_map(self):
+		"""Read the memory map xml document in parts, which fit into recv.
+		"""
+		doc = ''
+		while 1:
+			self.send( 'qXfer:memory-map:read::%x,100' % (len(doc)) )
+			reply = self.recv()
+			self.out( 'Recv: "%s"' % (reply) )
+			if reply[0] not in 'ml':
+				raise ErrReply, reply
+			doc += reply[1:]
+			if reply[0] == 'l':
+				break
+
+		return doc
+
+	def start_noack(self):
+		self.send( 'QStartNoAckMode' )
+		reply = self.recv()
+		if reply != 'OK':
+			raise ErrReply
+		self.out( 'Recv: "%s"' % (reply) )
+		self.noack = True
+
 	def handle_reply(self):
 		"""The C, c, S, s and ? packets all expect the same reply.
 		"""
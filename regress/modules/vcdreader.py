@@ -223,7 +223,7 @@ class VCD(object):
     "m": 0.001,
     "":  1.0,
   }
-  __rx_edge = compile(r"^(([01zx])(\S)|b([01zx]+)\s(\S+))$")
+  __rx_edge = compile(r"^(([01zx])(\S+)|b([01zx]+)\s(\S+))$")
   
   def __init__(self, filename):
     self.__time = None
@@ -0,0 +1,151 @@
+#! /usr/bin/env python
+###############################################################################
+#
+# simulavr - A simulator for the Atmel AVR family of microcontrollers.
+# Copyright (C) 2001, 2002  Theodore A. Roth
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+###############################################################################
+#
+# $Id$
+#
+
+"""Test the gdb remote serial protocol session: binary memory writes (X),
+flash programming (vFlash*), the memory map, packets, which arrive together
+or in parts, and QStartNoAckMode.
+"""
+
+import array, time
+
+import base_test
+
+class RSP_TestFail(base_test.TestFail): pass
+
+# bytes, which have to be escaped in binary data
+escaped = array.array('B', [ 0x23, 0x24, 0x7d, 0x2a, 0x00, 0xff, 0x5a, 0xa5 ])
+
+class base_RSP:
+	"""Generic test case for the gdb session.
+
+	The derived class must provide the run method.
+	"""
+	def __init__(self, target):
+		self.target = target
+
+	def fail(self, s):
+		raise RSP_TestFail, s
+
+	def expect_mem(self, addr, expect):
+		got = self.target.read_mem(addr, len(expect))
+		if got != expect:
+			self.fail('memory at %x: expect=%s, got=%s' % (addr, expect.tolist(), got.tolist()))
+
+class test_RSP_X_SRAM(base_RSP):
+	"""X packet writes escaped binary data to data memory."""
+	def run(self):
+		addr = self.target.offset_sram + 0x200
+		self.target.write_mem_binary(addr, escaped)
+		self.expect_mem(addr, escaped)
+
+class test_RSP_X_FLASH(base_RSP):
+	"""X packet writes flash, also starting on a odd address."""
+	def run(self):
+		addr = self.target.offset_flash + 0x1000
+		self.target.write_mem_binary(addr, escaped)
+		self.expect_mem(addr, escaped)
+		self.target.write_mem_binary(addr + 3, array.array('B', [ 0x11, 0x22 ]))
+		self.expect_mem(addr + 1, array.array('B', [ 0x24, 0x7d, 0x11, 0x22, 0xff ]))
+
+class test_RSP_M_FLASH(base_RSP):
+	"""M packets on flash are still accepted, though the memory map marks flash
+	as flash region."""
+	def run(self):
+		addr = self.target.offset_flash + 0x1010
+		buf = array.array('B', [ 0x12, 0x34, 0x56, 0x78 ])
+		self.target.write_mem(addr, len(buf), buf)
+		self.expect_mem(addr, buf)
+
+class test_RSP_FLASH_PROGRAM(base_RSP):
+	"""vFlashErase fills with 0xff, vFlashWrite programs escaped data."""
+	def run(self):
+		addr = self.target.offset_flash + 0x1100
+		self.target.write_mem_binary(addr, escaped)
+		self.target.flash_erase(addr, 0x100)
+		self.expect_mem(addr, array.array('B', [ 0xff ] * 16))
+		self.target.flash_write(addr + 2, escaped)
+		self.target.flash_done()
+		self.expect_mem(addr, array.array('B', [ 0xff, 0xff ]) + escaped + array.array('B', [ 0xff ]))
+
+class test_RSP_MEMORY_MAP(base_RSP):
+	"""The memory map has a flash region with the flash size and data memory."""
+	def run(self):
+		doc = self.target.read_memory_map()
+		if doc[:5] != '<?xml' or doc.find('</memory-map>') < 0:
+			self.fail('memory map incomplete: %s' % doc)
+		size = { 'atmega128': 0x20000, 'atmega2560': 0x40000 }.get(self.target.device)
+		if size is not None and doc.find('<memory type="flash" start="0x0" length="0x%x">' % size) < 0:
+			self.fail('flash region missing: %s' % doc)
+		if doc.find('<memory type="ram" start="0x%x" length="0x10000"/>' % self.target.offset_sram) < 0:
+			self.fail('data memory region missing: %s' % doc)
+
+class test_RSP_PIPELINED(base_RSP):
+	"""Several packets in one write are all processed, a packet split into
+	several writes too."""
+	def run(self):
+		t = self.target
+		addr = t.offset_sram + 0x210
+		buf = array.array('B', [ 0x01, 0x02, 0x03, 0x04 ])
+		t.write_mem(addr, len(buf), buf)
+
+		t.socket.send(t.packet('m%x,2' % addr) + t.packet('m%x,2' % (addr + 2)))
+		replies = []
+		while len(replies) < 2:
+			reply = t.recv()
+			if reply is not None:
+				replies.append(reply)
+		if replies != [ '0102', '0304' ]:
+			self.fail('pipelined replies: %s' % replies)
+
+		pkt = t.packet('m%x,4' % addr)
+		for i in range(0, len(pkt), 3):
+			t.socket.send(pkt[i:i+3])
+			time.sleep(0.01)
+		reply = t.recv()
+		while reply is None:
+			reply = t.recv()
+		if reply != '01020304':
+			self.fail('split packet reply: %s' % reply)
+
+class test_RSP_ZZ_NOACK(base_RSP):
+	"""After QStartNoAckMode the session works without acks. The mode stays
+	until the connection is closed, so this test runs last (test cases run in
+	name order)."""
+	def run(self):
+		t = self.target
+		t.start_noack()
+		addr = t.offset_sram + 0x220
+		t.write_mem_binary(addr, escaped)
+		self.expect_mem(addr, escaped)
+		t.socket.setblocking(0)
+		try:
+			try:
+				c = t.socket.recv(1)
+			except:
+				c = ''
+		finally:
+			t.socket.setblocking(1)
+		if c != '':
+			self.fail('unexpected data after reply: %r' % c)
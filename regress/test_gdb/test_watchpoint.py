@@ -0,0 +1,182 @@
+#! /usr/bin/env python
+###############################################################################
+#
+# simulavr - A simulator for the Atmel AVR family of microcontrollers.
+# Copyright (C) 2001, 2002  Theodore A. Roth
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+###############################################################################
+#
+# $Id$
+#
+
+"""Test the gdb watchpoints (Z2, Z3 and Z4 packets).
+"""
+
+import base_test
+from registers import Reg
+
+class WATCH_TestFail(base_test.TestFail): pass
+
+class base_WATCH(base_test.opcode_32_test):
+	"""Generic test case for testing data watchpoints.
+
+	The derived class must provide the kind, op, k and w members and the fail
+	method.
+
+	A watchpoint of the given kind is set on data address w, then a LDS (op = 0)
+	or STS (op = 1) to data address k is executed with a continue command. A
+	breakpoint on the next instruction stops the target, if the watchpoint
+	isn't hit.
+	"""
+	reasons = { 2: 'watch', 3: 'rwatch', 4: 'awatch' }
+
+	def run(self):
+		self.ensure_target_supports_opcode()
+		self.common_setup()
+		next_pc = self.setup_regs[Reg.PC] + 4
+		self.prog_word_write(next_pc, 0x0000)		# nop
+		self.target.break_insert(0, next_pc, 2)
+		self.target.break_insert(self.kind, self.target.offset_sram + self.w, 1)
+		try:
+			self.reply = self.target.cont()
+		finally:
+			self.target.break_remove(self.kind, self.target.offset_sram + self.w, 1)
+			self.target.break_remove(0, next_pc, 2)
+		self.common_analyze_results()
+
+	def setup(self):
+		self.setup_regs[Reg.PC] = 0xff * 2
+		self.setup_regs[Reg.R16] = 0x5a
+
+		self.mem_byte_write(self.k, 0xa5)
+
+		if self.op:
+			op = 0x9200 | (Reg.R16 << 4)		# sts k, r16
+		else:
+			op = 0x9000 | (Reg.R16 << 4)		# lds r16, k
+		return ( (op << 16) | (self.k & 0xffff) )
+
+	def is_hit(self):
+		if self.k != self.w:
+			return False
+		if self.kind == 2:
+			return self.op == 1
+		if self.kind == 3:
+			return self.op == 0
+		return True
+
+	def analyze_results(self):
+		self.is_pc_checked = 1
+		if not self.op:
+			self.reg_changed.extend( [Reg.R16] )
+
+		# watchpoint and breakpoint stop after the instruction
+		expect = self.setup_regs[Reg.PC] + 4
+		got = self.anal_regs[Reg.PC]
+		if expect != got:
+			self.fail('stop pc: expect=%x, got=%x' % (expect, got))
+
+		if self.reply[:3] != 'T05':
+			self.fail('stop reply: expect=T05..., got=%s' % self.reply)
+
+		reason = None
+		for field in self.reply[3:].split(';'):
+			if field[:field.find(':')] in self.reasons.values():
+				reason = field
+		if self.is_hit():
+			expect = '%s:%x' % (self.reasons[self.kind], self.target.offset_sram + self.w)
+		else:
+			expect = None
+		if expect != reason:
+			self.fail('stop reason: expect=%s, got=%s' % (expect, reason))
+
+		if self.op:
+			expect = 0x5a
+		else:
+			expect = 0xa5
+		got = self.mem_byte_read(self.k)
+		if expect != got:
+			self.fail('memory: expect=%x, got=%x' % (expect, got))
+
+class base_WATCH_DEBUGGER(base_WATCH):
+	"""Accesses of the debugger don't hit a watchpoint.
+
+	Like base_WATCH, but gdb reads and writes the watched address w after the
+	watchpoint is set. The instruction doesn't access w, so only the
+	breakpoint stops the target.
+	"""
+	def run(self):
+		self.ensure_target_supports_opcode()
+		self.common_setup()
+		next_pc = self.setup_regs[Reg.PC] + 4
+		self.prog_word_write(next_pc, 0x0000)		# nop
+		self.target.break_insert(0, next_pc, 2)
+		self.target.break_insert(self.kind, self.target.offset_sram + self.w, 1)
+		try:
+			self.mem_byte_read(self.w)
+			self.mem_byte_write(self.w, 0x33)
+			self.reply = self.target.cont()
+		finally:
+			self.target.break_remove(self.kind, self.target.offset_sram + self.w, 1)
+			self.target.break_remove(0, next_pc, 2)
+		self.common_analyze_results()
+
+	def analyze_results(self):
+		base_WATCH.analyze_results(self)
+		got = self.mem_byte_read(self.w)
+		if got != 0x33:
+			self.fail('memory written by debugger: expect=33, got=%x' % got)
+
+#
+# Template code for test case.
+# The fail method will raise a test specific exception.
+#
+template = """
+class WATCH_z%d_op%d_k%04x_w%04x_TestFail(WATCH_TestFail): pass
+
+class test_WATCH_z%d_op%d_k%04x_w%04x(base_WATCH):
+	kind = %d
+	op = %d
+	k = 0x%x
+	w = 0x%x
+	def fail(self,s):
+		raise WATCH_z%d_op%d_k%04x_w%04x_TestFail, s
+"""
+
+template_debugger = """
+class WATCH_DEBUGGER_z%d_op%d_TestFail(WATCH_TestFail): pass
+
+class test_WATCH_DEBUGGER_z%d_op%d(base_WATCH_DEBUGGER):
+	kind = %d
+	op = %d
+	k = 0x2f0
+	w = 0x2f1
+	def fail(self,s):
+		raise WATCH_DEBUGGER_z%d_op%d_TestFail, s
+"""
+
+#
+# automagically generate the test_WATCH_* class definitions
+#
+code = ''
+for kind in (2, 3, 4):
+	for op in (0, 1):
+		for k, w in ((0x2f0, 0x2f0), (0x2f0, 0x2f1)):
+			args = (kind,op,k,w)*4
+			code += template % args
+		code += template_debugger % ((kind,op)*4)
+exec code
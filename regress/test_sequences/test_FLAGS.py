@@ -0,0 +1,149 @@
+#! /usr/bin/env python
+###############################################################################
+#
+# simulavr - A simulator for the Atmel AVR family of microcontrollers.
+# Copyright (C) 2001, 2002  Theodore A. Roth
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+###############################################################################
+#
+# $Id$
+#
+
+"""Test SREG flags after sequences of register operations.
+
+In fast core mode flags, which are overwritten before they are read, are not
+calculated. This checks, that the flags at end of sequence are right anyway.
+"""
+
+import base_test
+from registers import Reg, SREG
+
+class FLAGS_TestFail(base_test.TestFail): pass
+
+def op_rr(op, d, r):
+	return op | ((r & 0x10) << 5) | (d << 4) | (r & 0xf)
+
+def op_rk(op, d, k):
+	return op | ((k & 0xf0) << 4) | ((d - 16) << 4) | (k & 0xf)
+
+ADD  = lambda d, r: op_rr(0x0c00, d, r)
+ADC  = lambda d, r: op_rr(0x1c00, d, r)
+SUB  = lambda d, r: op_rr(0x1800, d, r)
+CP   = lambda d, r: op_rr(0x1400, d, r)
+CPC  = lambda d, r: op_rr(0x0400, d, r)
+EOR  = lambda d, r: op_rr(0x2400, d, r)
+MOV  = lambda d, r: op_rr(0x2c00, d, r)
+SUBI = lambda d, k: op_rk(0x5000, d, k)
+SBCI = lambda d, k: op_rk(0x4000, d, k)
+INC  = lambda d: 0x9403 | (d << 4)
+COM  = lambda d: 0x9400 | (d << 4)
+LSR  = lambda d: 0x9406 | (d << 4)
+SWAP = lambda d: 0x9402 | (d << 4)
+ADIW = lambda d, k: 0x9600 | ((k & 0x30) << 2) | (((d - 24) / 2) << 4) | (k & 0xf)
+
+H = 1 << SREG.H
+S = 1 << SREG.S
+V = 1 << SREG.V
+N = 1 << SREG.N
+Z = 1 << SREG.Z
+C = 1 << SREG.C
+
+class base_FLAGS(base_test.sequence_test):
+	"""Generic test case for testing flags after a sequence.
+
+	The derived class must provide the regs (register values before),
+	seq (instructions), result (changed register values), sreg and the fail
+	method.
+	"""
+	def setup(self):
+		self.setup_regs[Reg.PC] = 0x100 * 2
+		self.setup_regs[Reg.SREG] = 0
+		for r, v in self.regs.items():
+			self.setup_regs[r] = v
+		return self.seq + [self.BREAK]
+
+	def analyze_results(self):
+		self.is_pc_checked = 1
+		self.reg_changed.extend( self.result.keys() + [Reg.SREG] )
+
+		expect = self.setup_regs[Reg.PC] + 2 * (len(self.seq) + 1)
+		got = self.anal_regs[Reg.PC]
+		if expect != got:
+			self.fail('PC: expect=%x, got=%x' % (expect, got))
+
+		for r, v in self.result.items():
+			got = self.anal_regs[r]
+			if v != got:
+				self.fail('Register %d: expect=%x, got=%x' % (r, v, got))
+
+		got = self.anal_regs[Reg.SREG]
+		if self.sreg != got:
+			self.fail('SREG: expect=%02x, got=%02x' % (self.sreg, got))
+
+#
+# Test cases: name, registers before, sequence, registers after, SREG after
+#
+cases = (
+	# H and C of ADD are live, because INC doesn't write them
+	('ADD_INC', {16: 0x7f, 17: 0x01, 18: 0x10},
+	 [ADD(16, 17), INC(18)], {16: 0x80, 18: 0x11}, H),
+	# all flags of ADD are overwritten by SUB
+	('ADD_SUB', {16: 0xff, 17: 0x01, 18: 0x05, 19: 0x03},
+	 [ADD(16, 17), SUB(18, 19)], {16: 0x00, 18: 0x02}, 0),
+	# C of ADD is read by ADC
+	('ADD_ADC', {16: 0xff, 17: 0x01, 18: 0x00, 19: 0x00},
+	 [ADD(16, 17), ADC(18, 19)], {16: 0x00, 18: 0x01}, 0),
+	# Z and C of CP are read by CPC, SWAP doesn't change flags
+	('CP_CPC_SWAP', {16: 0x10, 17: 0x10, 18: 0x20, 19: 0x20, 21: 0x12},
+	 [CP(16, 17), CPC(18, 19), SWAP(21)], {21: 0x21}, Z),
+	# C of LSR is live, EOR writes S, V, N and Z only
+	('LSR_EOR', {16: 0x03, 17: 0x5a},
+	 [LSR(16), EOR(17, 17)], {16: 0x01, 17: 0x00}, Z | C),
+	# ADIW is a multi cycle instruction in block, MOV doesn't change flags
+	('ADIW_MOV', {24: 0xff, 25: 0xff, 1: 0x33},
+	 [ADIW(24, 1), MOV(0, 1)], {24: 0x00, 25: 0x00, 0: 0x33}, Z | C),
+	# H of SUBI is live, COM writes S, V, N, Z and C
+	('SUBI_COM', {16: 0x00, 17: 0x0f},
+	 [SUBI(16, 1), COM(17)], {16: 0xff, 17: 0xf0}, H | S | N | C),
+	# flags of ADD are dead, SBCI reads C and Z of SUBI
+	('ADD_SUBI_SBCI', {16: 0x01, 17: 0x01, 24: 0x01, 25: 0x00},
+	 [ADD(16, 17), SUBI(24, 1), SBCI(25, 0)], {16: 0x02, 24: 0x00, 25: 0x00}, Z),
+)
+
+#
+# Template code for test case.
+# The fail method will raise a test specific exception.
+#
+template = """
+class FLAGS_%s_TestFail(FLAGS_TestFail): pass
+
+class test_FLAGS_%s(base_FLAGS):
+	regs = %r
+	seq = %r
+	result = %r
+	sreg = 0x%02x
+	def fail(self,s):
+		raise FLAGS_%s_TestFail, s
+"""
+
+#
+# automagically generate the test_FLAGS_* class definitions
+#
+code = ''
+for name, regs, seq, result, sreg in cases:
+	code += template % (name, name, regs, seq, result, sreg, name)
+exec code
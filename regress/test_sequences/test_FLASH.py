@@ -0,0 +1,190 @@
+#! /usr/bin/env python
+###############################################################################
+#
+# simulavr - A simulator for the Atmel AVR family of microcontrollers.
+# Copyright (C) 2001, 2002  Theodore A. Roth
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+###############################################################################
+#
+# $Id$
+#
+
+"""Test instruction sequences after flash rewrite.
+
+In fast core mode decoded instructions are cached in blocks. This checks, that
+a block is rebuilt, if flash is written by gdb or by SPM.
+"""
+
+import base_test
+from registers import Reg, SREG
+
+class FLASH_TestFail(base_test.TestFail): pass
+
+def op_rr(op, d, r):
+	return op | ((r & 0x10) << 5) | (d << 4) | (r & 0xf)
+
+ADD  = lambda d, r: op_rr(0x0c00, d, r)
+SUB  = lambda d, r: op_rr(0x1800, d, r)
+MOV  = lambda d, r: op_rr(0x2c00, d, r)
+LDI  = lambda d, k: 0xe000 | ((k & 0xf0) << 4) | ((d - 16) << 4) | (k & 0xf)
+STS  = lambda k, r: [0x9200 | (r << 4), k]
+CALL = lambda k: [0x940e | ((k >> 13) & 0x1f0) | ((k >> 16) & 0x1), k & 0xffff]
+RET  = 0x9508
+SPM  = 0x95e8
+
+H = 1 << SREG.H
+S = 1 << SREG.S
+V = 1 << SREG.V
+N = 1 << SREG.N
+Z = 1 << SREG.Z
+C = 1 << SREG.C
+
+class base_FLASH(base_test.sequence_test):
+	"""Generic test case for running a sequence twice with rewritten flash.
+
+	The derived class must provide the regs (register values before), seq
+	(instructions), rewrite (word address and instruction to write into flash
+	after first run), result1 and result2 (changed register values after first
+	and second run), sreg1 and sreg2 and the fail method.
+	"""
+	def setup(self):
+		self.setup_regs[Reg.PC] = 0x100 * 2
+		self.setup_regs[Reg.SREG] = 0
+		for r, v in self.regs.items():
+			self.setup_regs[r] = v
+		return self.seq + [self.BREAK]
+
+	def run(self):
+		self.result, self.sreg = self.result1, self.sreg1
+		base_test.sequence_test.run(self)
+
+		# now rewrite one instruction, the cached block has to be dropped
+		addr, op = self.rewrite
+		self.prog_word_write(self.setup_regs[Reg.PC] + 2 * addr, op)
+		self.target.write_regs(self.setup_regs)
+		self.result, self.sreg = self.result2, self.sreg2
+		self.reply = self.target.cont()
+		if self.reply[:3] != 'T05':
+			raise base_test.TestFail, 'Not stopped by BREAK: reply=%s' % (self.reply)
+		self.common_analyze_results()
+
+	def analyze_results(self):
+		self.is_pc_checked = 1
+		self.reg_changed.extend( self.result.keys() + [Reg.SREG] )
+
+		expect = self.setup_regs[Reg.PC] + 2 * (len(self.seq) + 1)
+		got = self.anal_regs[Reg.PC]
+		if expect != got:
+			self.fail('PC: expect=%x, got=%x' % (expect, got))
+
+		for r, v in self.result.items():
+			got = self.anal_regs[r]
+			if v != got:
+				self.fail('Register %d: expect=%x, got=%x' % (r, v, got))
+
+		got = self.anal_regs[Reg.SREG]
+		if self.sreg != got:
+			self.fail('SREG: expect=%02x, got=%02x' % (self.sreg, got))
+
+class test_FLASH_GDB_REWRITE(base_FLASH):
+	"""Replace SUB by MOV with a gdb memory write, flags of ADD are live then.
+	"""
+	regs = {16: 0xff, 17: 0x01, 18: 0x05, 19: 0x03}
+	seq = [ADD(16, 17), SUB(18, 19)]
+	rewrite = (1, MOV(18, 19))
+	result1 = {16: 0x00, 18: 0x02}
+	sreg1 = 0
+	result2 = {16: 0x00, 18: 0x03}
+	sreg2 = H | Z | C
+	def fail(self, s):
+		raise FLASH_TestFail, s
+
+class test_FLASH_SPM_REWRITE(base_test.sequence_test):
+	"""Rewrite a subroutine by SPM and call it again.
+
+	The sequence runs from start of NRWW section and calls a subroutine in RWW
+	section, which is "add r24,r25; sub r22,r23; ret". Then the flash page is
+	erased, filled with "add r24,r25; mov r22,r23; ret" and written, RWW
+	section is enabled again and the subroutine is called once more.
+	"""
+	# device: (byte address of NRWW section, data address of SPMCSR)
+	devices = {
+		'atmega128':  (0x1e000, 0x68),
+		'atmega2560': (0x3e000, 0x57),
+	}
+	page = 0x1000  # byte address of flash page with subroutine
+	SP_val = 0x10ff
+
+	def ensure_target_supports_opcode(self):
+		if self.target.device not in self.devices:
+			self.opcode_not_supported()
+
+	def write_words(self, addr, words):
+		self.target.write_flash(addr, 2 * len(words), self.common_build_opcode(words))
+
+	def spm(self, spmcsr, cmd):
+		return [LDI(20, cmd)] + STS(spmcsr, 20) + [SPM]
+
+	def setup(self):
+		start, spmcsr = self.devices[self.target.device]
+		self.setup_regs[Reg.PC] = start
+		self.setup_regs[Reg.SP] = self.SP_val
+		self.setup_regs[Reg.SREG] = 0
+		for r, v in ((22, 0x09), (23, 0x04), (24, 0x78), (25, 0x08)):
+			self.setup_regs[r] = v
+		self.write_words(self.page, [ADD(24, 25), SUB(22, 23), RET])
+
+		seq = CALL(self.page / 2)
+		# erase page
+		seq += [LDI(30, self.page & 0xff), LDI(31, self.page >> 8)]
+		seq += self.spm(spmcsr, 0x03)
+		# fill page buffer
+		for i, w in enumerate([ADD(24, 25), MOV(22, 23), RET]):
+			seq += [LDI(26, w & 0xff), LDI(27, w >> 8), MOV(0, 26), MOV(1, 27),
+			        LDI(30, (self.page + 2 * i) & 0xff)]
+			seq += self.spm(spmcsr, 0x01)
+		# write page and enable RWW section
+		seq += [LDI(30, self.page & 0xff)]
+		seq += self.spm(spmcsr, 0x05)
+		seq += self.spm(spmcsr, 0x11)
+		seq += CALL(self.page / 2)
+		self.seq = seq
+		return seq + [self.BREAK]
+
+	def analyze_results(self):
+		self.is_pc_checked = 1
+		# helper registers for SPM
+		self.reg_changed.extend( [0, 1, 20, 26, 27, 30, 31] )
+
+		expect = self.setup_regs[Reg.PC] + 2 * (len(self.seq) + 1)
+		got = self.anal_regs[Reg.PC]
+		if expect != got:
+			self.fail('PC: expect=%x, got=%x' % (expect, got))
+
+		# first call: 0x78 + 0x08, 0x09 - 0x04, second call: 0x80 + 0x08, move
+		self.reg_changed.extend( [22, 24, Reg.SREG] )
+		for r, v in ((22, 0x04), (24, 0x88)):
+			got = self.anal_regs[r]
+			if v != got:
+				self.fail('Register %d: expect=%x, got=%x' % (r, v, got))
+
+		got = self.anal_regs[Reg.SREG]
+		if (S | N) != got:
+			self.fail('SREG: expect=%02x, got=%02x' % (S | N, got))
+
+	def fail(self, s):
+		raise FLASH_TestFail, s
@@ -0,0 +1,68 @@
+#! /usr/bin/env python
+"""Compare a text trace with a text trace, which is converted by itrace2txt.
+
+usage: compare_itrace.py [-s <symbol>] <trace-file> <converted-trace-file>
+
+Both files have to be written from the same simulation, the first by -t, the
+second by itrace2txt from the binary trace. Messages of the irq system are
+removed from both, because they aren't part of the binary trace and are
+written on replay, where the replayed instructions trigger them. Without -s
+all lines have to be the same, with -s the converted file holds only the lines
+for instructions from <symbol> up to the next symbol (itrace2txt -s <symbol>).
+"""
+from sys import argv, stderr, exit
+from getopt import getopt, GetoptError
+import re
+
+def readTrace(name):
+  f = open(name)
+  text = f.read()
+  f.close()
+  # messages start with the device name, which starts also each trace line
+  device = re.escape(text.split(" ", 1)[0])
+  irqMessage = re.compile(device + r" (interrupt on index \d+( is pending|cleared)|" +
+                          r"IrqSystem: IrqHandler(Started| Finished) Vec: \d+)\n")
+  return irqMessage.sub("", text).splitlines()
+
+def inSymbol(line, symbol):
+  fields = line.split()
+  if len(fields) < 3:
+    return False
+  return fields[2] == symbol or fields[2].startswith(symbol + "+")
+
+def compareLines(trace, conv):
+  if len(trace) != len(conv):
+    print >> stderr, "%d lines in trace, %d lines converted" % (len(trace), len(conv))
+  for i in range(min(len(trace), len(conv))):
+    if trace[i] != conv[i]:
+      print >> stderr, "line %d differs:\n  %s\n  %s" % (i + 1, trace[i], conv[i])
+      return 1
+  if len(trace) != len(conv):
+    return 1
+  return 0
+
+def usage():
+  print >> stderr, __doc__.strip()
+  exit(2)
+
+if __name__ == "__main__":
+  try:
+    opts, args = getopt(argv[1:], "s:")
+  except GetoptError:
+    usage()
+  symbol = None
+  for o, a in opts:
+    if o == "-s": symbol = a
+  if len(args) != 2:
+    usage()
+  trace = readTrace(args[0])
+  conv = readTrace(args[1])
+  if symbol is not None:
+    trace = [l for l in trace if inSymbol(l, symbol)]
+  if len(conv) == 0:
+    print >> stderr, "converted trace is empty"
+    exit(1)
+  if compareLines(trace, conv):
+    exit(1)
+
+# EOF
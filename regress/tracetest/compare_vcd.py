@@ -0,0 +1,80 @@
+#! /usr/bin/env python
+"""Compare a VCD file with a VCD file, which is converted by trace2vcd.
+
+usage: compare_vcd.py [-s <start> -e <end>] <vcd-file> <converted-vcd-file>
+
+Both files have to be written from the same simulation, the first by the vcd
+dumper, the second by the bin dumper and trace2vcd. Without -s and -e all
+value changes have to be the same. With -s and -e the converted file holds
+only the part from <start> to <end> (trace2vcd seeks the block with <start>),
+then all values have to be the same on every change time in this range.
+"""
+from sys import argv, stderr, exit
+from getopt import getopt, GetoptError
+
+from vcdreader import VCD, VCDError
+
+def edgeList(var):
+  return [(e.internalTime, e.value) for e in var.getEdges()]
+
+def compareAll(vcd, conv):
+  errors = 0
+  for var in vcd.variables:
+    if edgeList(var) != edgeList(conv.getVariable(var.name)):
+      print >> stderr, "%s: value changes differ" % var.name
+      errors += 1
+  return errors
+
+def compareRange(vcd, conv, start, end):
+  errors = 0
+  if conv.starttime != start or conv.endtime != end:
+    print >> stderr, "converted file from %d to %d, expected %d to %d" % \
+      (conv.starttime, conv.endtime, start, end)
+    errors += 1
+  for var in vcd.variables:
+    a = edgeList(var)
+    b = edgeList(conv.getVariable(var.name))
+    times = set([t for t, v in a if start <= t <= end] + [t for t, v in b])
+    # walk through both lists, value at a time is the last change till then
+    ia = ib = 0
+    va = vb = None
+    for t in sorted(times):
+      while ia < len(a) and a[ia][0] <= t:
+        va = a[ia][1]
+        ia += 1
+      while ib < len(b) and b[ib][0] <= t:
+        vb = b[ib][1]
+        ib += 1
+      if va != vb:
+        print >> stderr, "%s: value at %d is %s, but %s in converted file" % \
+          (var.name, t, va, vb)
+        errors += 1
+        break
+  return errors
+
+if __name__ == "__main__":
+  try:
+    opts, args = getopt(argv[1:], "s:e:")
+  except GetoptError, e:
+    print >> stderr, str(e)
+    exit(2)
+  if len(args) != 2:
+    print >> stderr, __doc__
+    exit(2)
+  opts = dict(opts)
+  try:
+    vcd = VCD(args[0])
+    conv = VCD(args[1])
+    if "-s" in opts or "-e" in opts:
+      errors = compareRange(vcd, conv, long(opts["-s"]), long(opts["-e"]))
+    else:
+      errors = compareAll(vcd, conv)
+  except VCDError, e:
+    print >> stderr, str(e)
+    exit(1)
+  if errors:
+    print >> stderr, "%s and %s differ" % (args[0], args[1])
+    exit(1)
+  print "%s and %s are the same" % (args[0], args[1])
+
+# EOF
@@ -0,0 +1,21 @@
+/* timer 0 overflow irq writes a counter to port B, main loop counts loops,
+   so the trace has many value changes and more than one block */
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+volatile unsigned char counter;
+volatile unsigned int loops;
+
+ISR(TIMER0_OVF_vect) {
+    counter++;
+    PORTB = counter;
+}
+
+int main(void) {
+    DDRB = 0xff;
+    TCCR0 = (1 << CS01);    /* timer 0 clock is cpu clock / 8 */
+    TIMSK = (1 << TOIE0);
+    sei();
+    for(;;)
+        loops++;
+}
@@ -35,9 +35,11 @@ class Application {
         std::vector <Printable*> printable;
 
     private:
-        Application() {} // no way to create an object
+        Application() {} // only created by SimulationContext
+        friend class SimulationContext;
 
     public:
+        //! Returns the instance of the current simulation context
         static Application* GetInstance();
         void RegisterPrintable(Printable *x);
         void PrintResults();
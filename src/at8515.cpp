@@ -93,69 +93,70 @@ AvrDevice_at90s8515::AvrDevice_at90s8515():
     gimsk_reg = new IOSpecialReg(&coreTraceGroup, "GIMSK");
     gifr_reg = new IOSpecialReg(&coreTraceGroup, "GIFR");
     mcucr_reg = new IOSpecialReg(&coreTraceGroup, "MCUCR");
+    SetSleepControl(mcucr_reg, 0x20); // SE bit
     extirq = new ExternalIRQHandler(this, irqSystem, gimsk_reg, gifr_reg);
     extirq->registerIrq(1, 6, new ExternalIRQSingle(mcucr_reg, 0, 2, GetPin("D2"), true));
     extirq->registerIrq(2, 7, new ExternalIRQSingle(mcucr_reg, 2, 2, GetPin("D3"), true));
 
-    rw[0x5f]= statusRegister;
-    rw[0x5e]= & ((HWStackSram *)stack)->sph_reg;
-    rw[0x5d]= & ((HWStackSram *)stack)->spl_reg;
+    rw.SetMember(0x5f, statusRegister);
+    rw.SetMember(0x5e, & ((HWStackSram *)stack)->sph_reg);
+    rw.SetMember(0x5d, & ((HWStackSram *)stack)->spl_reg);
     // 0x5c reserved
-    rw[0x5b]= gimsk_reg;
-    rw[0x5a]= gifr_reg;
-    rw[0x59]= & timer01irq->timsk_reg;
-    rw[0x58]= & timer01irq->tifr_reg;
+    rw.SetMember(0x5b, gimsk_reg);
+    rw.SetMember(0x5a, gifr_reg);
+    rw.SetMember(0x59, & timer01irq->timsk_reg);
+    rw.SetMember(0x58, & timer01irq->tifr_reg);
 
-    rw[0x55]= mcucr_reg;
+    rw.SetMember(0x55, mcucr_reg);
 
-    rw[0x53]= & timer0->tccr_reg;
-    rw[0x52]= & timer0->tcnt_reg;
+    rw.SetMember(0x53, & timer0->tccr_reg);
+    rw.SetMember(0x52, & timer0->tcnt_reg);
 
-    rw[0x4f]= & timer1->tccra_reg;
-    rw[0x4e]= & timer1->tccrb_reg;
-    rw[0x4d]= & timer1->tcnt_h_reg;
-    rw[0x4c]= & timer1->tcnt_l_reg;
-    rw[0x4b]= & timer1->ocra_h_reg;
-    rw[0x4a]= & timer1->ocra_l_reg;
-    rw[0x49]= & timer1->ocrb_h_reg;
-    rw[0x48]= & timer1->ocrb_l_reg;
+    rw.SetMember(0x4f, & timer1->tccra_reg);
+    rw.SetMember(0x4e, & timer1->tccrb_reg);
+    rw.SetMember(0x4d, & timer1->tcnt_h_reg);
+    rw.SetMember(0x4c, & timer1->tcnt_l_reg);
+    rw.SetMember(0x4b, & timer1->ocra_h_reg);
+    rw.SetMember(0x4a, & timer1->ocra_l_reg);
+    rw.SetMember(0x49, & timer1->ocrb_h_reg);
+    rw.SetMember(0x48, & timer1->ocrb_l_reg);
 
-    rw[0x45]= & timer1->icr_h_reg;
-    rw[0x44]= & timer1->icr_l_reg;
+    rw.SetMember(0x45, & timer1->icr_h_reg);
+    rw.SetMember(0x44, & timer1->icr_l_reg);
 
-    rw[0x41]= & wado->wdtcr_reg;
+    rw.SetMember(0x41, & wado->wdtcr_reg);
 
-    rw[0x3f]= & eeprom->eearh_reg;
-    rw[0x3e]= & eeprom->eearl_reg;
-    rw[0x3d]= & eeprom->eedr_reg;
-    rw[0x3c]= & eeprom->eecr_reg;
+    rw.SetMember(0x3f, & eeprom->eearh_reg);
+    rw.SetMember(0x3e, & eeprom->eearl_reg);
+    rw.SetMember(0x3d, & eeprom->eedr_reg);
+    rw.SetMember(0x3c, & eeprom->eecr_reg);
 
-    rw[0x3b]= & porta->port_reg;
-    rw[0x3a]= & porta->ddr_reg;
-    rw[0x39]= & porta->pin_reg;
+    rw.SetMember(0x3b, & porta->port_reg);
+    rw.SetMember(0x3a, & porta->ddr_reg);
+    rw.SetMember(0x39, & porta->pin_reg);
 
-    rw[0x38]= & portb->port_reg;
-    rw[0x37]= & portb->ddr_reg;
-    rw[0x36]= & portb->pin_reg;
+    rw.SetMember(0x38, & portb->port_reg);
+    rw.SetMember(0x37, & portb->ddr_reg);
+    rw.SetMember(0x36, & portb->pin_reg);
 
-    rw[0x35]= & portc->port_reg;
-    rw[0x34]= & portc->ddr_reg;
-    rw[0x33]= & portc->pin_reg;
+    rw.SetMember(0x35, & portc->port_reg);
+    rw.SetMember(0x34, & portc->ddr_reg);
+    rw.SetMember(0x33, & portc->pin_reg);
 
-    rw[0x32]= & portd->port_reg;
-    rw[0x31]= & portd->ddr_reg;
-    rw[0x30]= & portd->pin_reg;
+    rw.SetMember(0x32, & portd->port_reg);
+    rw.SetMember(0x31, & portd->ddr_reg);
+    rw.SetMember(0x30, & portd->pin_reg);
 
-    rw[0x2f]= & spi->spdr_reg;
-    rw[0x2e]= & spi->spsr_reg;
-    rw[0x2d]= & spi->spcr_reg;
+    rw.SetMember(0x2f, & spi->spdr_reg);
+    rw.SetMember(0x2e, & spi->spsr_reg);
+    rw.SetMember(0x2d, & spi->spcr_reg);
 
-    rw[0x2c]= & uart->udr_reg;
-    rw[0x2b]= & uart->usr_reg;
-    rw[0x2a]= & uart->ucr_reg;
-    rw[0x29]= & uart->ubrr_reg;
+    rw.SetMember(0x2c, & uart->udr_reg);
+    rw.SetMember(0x2b, & uart->usr_reg);
+    rw.SetMember(0x2a, & uart->ucr_reg);
+    rw.SetMember(0x29, & uart->ubrr_reg);
 
-    rw[0x28]= & acomp->acsr_reg;
+    rw.SetMember(0x28, & acomp->acsr_reg);
 
     Reset();
 }
@@ -86,6 +86,7 @@ AvrDevice_at90canbase::AvrDevice_at90canbase(unsigned ram_bytes,
     portg(this, "G", true),
     gtccr_reg(&coreTraceGroup, "GTCCR"),
     assr_reg(&coreTraceGroup, "ASSR"),
+    smcr_reg(&coreTraceGroup, "SMCR"),
     prescaler013(this, "01", &gtccr_reg, 0, 7),
     prescaler2(this, "2", PinAtPort(&portc, 7), &assr_reg, 5, &gtccr_reg, 1, 7) {
     flagELPMInstructions = true;
@@ -103,6 +104,7 @@ AvrDevice_at90canbase::AvrDevice_at90canbase(unsigned ram_bytes,
         }
     }
     irqSystem = new HWIrqSystem(this, 4, 37);
+    SetSleepControl(&smcr_reg, 0x01); // SE bit
 
     eeprom = new HWEeprom(this, irqSystem, ee_bytes, 26, HWEeprom::DEVMODE_EXTENDED); 
     stack = new HWStackSram(this, 16);
@@ -236,153 +238,153 @@ AvrDevice_at90canbase::AvrDevice_at90canbase(unsigned ram_bytes,
     /* 0xfb - 0xff reserved */
     /* 0xd8 - 0xfa CANBUS TODO */
     /* 0xcf - 0xd7 reserved */
-    rw[0xce]= & usart1->udr_reg;
-    rw[0xcd]= & usart1->ubrrhi_reg;
+    rw.SetMember(0xce, & usart1->udr_reg);
+    rw.SetMember(0xcd, & usart1->ubrrhi_reg);
     /* 0xcb reserved */
-    rw[0xca]= & usart1->ucsrc_reg;
-    rw[0xcc]= & usart1->ubrr_reg;
-    rw[0xc9]= & usart1->ucsrb_reg;
-    rw[0xc8]= & usart1->ucsra_reg;
+    rw.SetMember(0xca, & usart1->ucsrc_reg);
+    rw.SetMember(0xcc, & usart1->ubrr_reg);
+    rw.SetMember(0xc9, & usart1->ucsrb_reg);
+    rw.SetMember(0xc8, & usart1->ucsra_reg);
     /* 0xc7 reserved */
-    rw[0xc6]= & usart0->udr_reg;
-    rw[0xc5]= & usart0->ubrrhi_reg;
-    rw[0xc4]= & usart0->ubrr_reg;
+    rw.SetMember(0xc6, & usart0->udr_reg);
+    rw.SetMember(0xc5, & usart0->ubrrhi_reg);
+    rw.SetMember(0xc4, & usart0->ubrr_reg);
     /* 0xc3 reserved */
-    rw[0xc2]= & usart0->ucsrc_reg;
-    rw[0xc1]= & usart0->ucsrb_reg;
-    rw[0xc0]= & usart0->ucsra_reg;
+    rw.SetMember(0xc2, & usart0->ucsrc_reg);
+    rw.SetMember(0xc1, & usart0->ucsrb_reg);
+    rw.SetMember(0xc0, & usart0->ucsra_reg);
     /* 0xbd - 0xbf reserved */
-    rw[0xBC]= new NotSimulatedRegister("TWI register TWCR not simulated");
-    rw[0xBB]= new NotSimulatedRegister("TWI register TWDR not simulated");
-    rw[0xBA]= new NotSimulatedRegister("TWI register TWAR not simulated");
-    rw[0xB9]= new NotSimulatedRegister("TWI register TWSR not simulated");
-    rw[0xB8]= new NotSimulatedRegister("TWI register TWBR not simulated");
+    rw.SetMember(0xBC, new NotSimulatedRegister("TWI register TWCR not simulated"));
+    rw.SetMember(0xBB, new NotSimulatedRegister("TWI register TWDR not simulated"));
+    rw.SetMember(0xBA, new NotSimulatedRegister("TWI register TWAR not simulated"));
+    rw.SetMember(0xB9, new NotSimulatedRegister("TWI register TWSR not simulated"));
+    rw.SetMember(0xB8, new NotSimulatedRegister("TWI register TWBR not simulated"));
     /* 0xb7 reserved */
-    rw[0xb6]= & assr_reg;
+    rw.SetMember(0xb6, & assr_reg);
     /* 0xb4 - 0xb5 reserved */
-    rw[0xb3]= & timer2->ocra_reg;
-    rw[0xb2]= & timer2->tcnt_reg;
+    rw.SetMember(0xb3, & timer2->ocra_reg);
+    rw.SetMember(0xb2, & timer2->tcnt_reg);
     /* 0xb1 reserved */
-    rw[0xb0]= & timer2->tccr_reg;
+    rw.SetMember(0xb0, & timer2->tccr_reg);
     /* 0x9e - 0xaf reserved */
-    rw[0x9d]= & timer3->ocrc_h_reg;
-    rw[0x9c]= & timer3->ocrc_l_reg;
-    rw[0x9b]= & timer3->ocrb_h_reg;
-    rw[0x9a]= & timer3->ocrb_l_reg;
-    rw[0x99]= & timer3->ocra_h_reg;
-    rw[0x98]= & timer3->ocra_l_reg;
-    rw[0x97]= & timer3->icr_h_reg;
-    rw[0x96]= & timer3->icr_l_reg;
-    rw[0x95]= & timer3->tcnt_h_reg;
-    rw[0x94]= & timer3->tcnt_l_reg;
+    rw.SetMember(0x9d, & timer3->ocrc_h_reg);
+    rw.SetMember(0x9c, & timer3->ocrc_l_reg);
+    rw.SetMember(0x9b, & timer3->ocrb_h_reg);
+    rw.SetMember(0x9a, & timer3->ocrb_l_reg);
+    rw.SetMember(0x99, & timer3->ocra_h_reg);
+    rw.SetMember(0x98, & timer3->ocra_l_reg);
+    rw.SetMember(0x97, & timer3->icr_h_reg);
+    rw.SetMember(0x96, & timer3->icr_l_reg);
+    rw.SetMember(0x95, & timer3->tcnt_h_reg);
+    rw.SetMember(0x94, & timer3->tcnt_l_reg);
     /* 0x93 reserved */
-    rw[0x92]= & timer3->tccrc_reg;
-    rw[0x91]= & timer3->tccrb_reg;
-    rw[0x90]= & timer3->tccra_reg;
+    rw.SetMember(0x92, & timer3->tccrc_reg);
+    rw.SetMember(0x91, & timer3->tccrb_reg);
+    rw.SetMember(0x90, & timer3->tccra_reg);
     /* 0x8e - 0x8f reserved */
-    rw[0x8d]= & timer1->ocrc_h_reg;
-    rw[0x8c]= & timer1->ocrc_l_reg;
-    rw[0x8b]= & timer1->ocrb_h_reg;
-    rw[0x8a]= & timer1->ocrb_l_reg;
-    rw[0x89]= & timer1->ocra_h_reg;
-    rw[0x88]= & timer1->ocra_l_reg;
-    rw[0x87]= & timer1->icr_h_reg;
-    rw[0x86]= & timer1->icr_l_reg;
-    rw[0x85]= & timer1->tcnt_h_reg;
-    rw[0x84]= & timer1->tcnt_l_reg;
+    rw.SetMember(0x8d, & timer1->ocrc_h_reg);
+    rw.SetMember(0x8c, & timer1->ocrc_l_reg);
+    rw.SetMember(0x8b, & timer1->ocrb_h_reg);
+    rw.SetMember(0x8a, & timer1->ocrb_l_reg);
+    rw.SetMember(0x89, & timer1->ocra_h_reg);
+    rw.SetMember(0x88, & timer1->ocra_l_reg);
+    rw.SetMember(0x87, & timer1->icr_h_reg);
+    rw.SetMember(0x86, & timer1->icr_l_reg);
+    rw.SetMember(0x85, & timer1->tcnt_h_reg);
+    rw.SetMember(0x84, & timer1->tcnt_l_reg);
     // 0x83 reserved
-    rw[0x82]= & timer1->tccrc_reg;
-    rw[0x81]= & timer1->tccrb_reg;
-    rw[0x80]= & timer1->tccra_reg;
+    rw.SetMember(0x82, & timer1->tccrc_reg);
+    rw.SetMember(0x81, & timer1->tccrb_reg);
+    rw.SetMember(0x80, & timer1->tccra_reg);
     /* 0x7e-0x7f DIDR TODO */
-    rw[0x7C]= & ad->admux_reg;
-    rw[0x7B]= & ad->adcsrb_reg;
-    rw[0x7A]= & ad->adcsra_reg;
-    rw[0x79]= & ad->adch_reg;
-    rw[0x78]= & ad->adcl_reg;
+    rw.SetMember(0x7C, & ad->admux_reg);
+    rw.SetMember(0x7B, & ad->adcsrb_reg);
+    rw.SetMember(0x7A, & ad->adcsra_reg);
+    rw.SetMember(0x79, & ad->adch_reg);
+    rw.SetMember(0x78, & ad->adcl_reg);
     /* 0x76-0x77 reserved */
     /* 0x74-0x75 External memory control registers TODO */
     /* 0x72-0x73 reserved */
-    rw[0x71] = & timerIrq3->timsk_reg;
-    rw[0x70]= & timerIrq2->timsk_reg;
-    rw[0x6F]= & timerIrq1->timsk_reg;
-    rw[0x6E]= & timerIrq0->timsk_reg;
+    rw.SetMember(0x71, & timerIrq3->timsk_reg);
+    rw.SetMember(0x70, & timerIrq2->timsk_reg);
+    rw.SetMember(0x6F, & timerIrq1->timsk_reg);
+    rw.SetMember(0x6E, & timerIrq0->timsk_reg);
     /* 0x6b-0x6d Reserved */
-    rw[0x6A]= eicrb_reg;
-    rw[0x69]= eicra_reg;
+    rw.SetMember(0x6A, eicrb_reg);
+    rw.SetMember(0x69, eicra_reg);
     /* 0x67-0x68 Reserved */
-    rw[0x66]= osccal_reg;
+    rw.SetMember(0x66, osccal_reg);
     /* 0x62-0x65 Reserved */
-    rw[0x61]= clkpr_reg;
-    rw[0x60]= & wado->wdtcr_reg;
-    rw[0x5f]= statusRegister;
-    rw[0x5e]= & ((HWStackSram *)stack)->sph_reg;
-    rw[0x5d]= & ((HWStackSram *)stack)->spl_reg;
+    rw.SetMember(0x61, clkpr_reg);
+    rw.SetMember(0x60, & wado->wdtcr_reg);
+    rw.SetMember(0x5f, statusRegister);
+    rw.SetMember(0x5e, & ((HWStackSram *)stack)->sph_reg);
+    rw.SetMember(0x5d, & ((HWStackSram *)stack)->spl_reg);
     /* 0x5c reserved */
-    rw[0x5b]= & rampz->ext_reg;
+    rw.SetMember(0x5b, & rampz->ext_reg);
     /* 0x58-0x5A Reserved */
-    rw[0x57]= & spmRegister->spmcr_reg;
+    rw.SetMember(0x57, & spmRegister->spmcr_reg);
     /* 0x56 Reserved */
     /* 0x55 MCUCR -- Memory control TODO */
     /* 0x54 MCUSR -- Memory control TODO */
-    /* 0x53 SMCR -- sleep register TODO */
+    rw.SetMember(0x53, & smcr_reg);
     /* 0x52 Reserved */
     /* 0x51 OCDR */
-    rw[0x50]= & acomp->acsr_reg;
+    rw.SetMember(0x50, & acomp->acsr_reg);
     /* 0x4f reserved */
-    rw[0x4E]= & spi->spdr_reg;
-    rw[0x4D]= & spi->spsr_reg;
-    rw[0x4C]= & spi->spcr_reg;
-    rw[0x4B]= gpior2_reg;
-    rw[0x4A]= gpior1_reg;
+    rw.SetMember(0x4E, & spi->spdr_reg);
+    rw.SetMember(0x4D, & spi->spsr_reg);
+    rw.SetMember(0x4C, & spi->spcr_reg);
+    rw.SetMember(0x4B, gpior2_reg);
+    rw.SetMember(0x4A, gpior1_reg);
     /* 0x48 - 0x49 reserved */
-    rw[0x47]= & timer0->ocra_reg;
-    rw[0x46]= & timer0->tcnt_reg;
+    rw.SetMember(0x47, & timer0->ocra_reg);
+    rw.SetMember(0x46, & timer0->tcnt_reg);
     /* 0x45 reserved */
-    rw[0x44]= & timer0->tccr_reg;
-    rw[0x43]= & gtccr_reg;
-    rw[0x42]= & eeprom->eearh_reg;
-    rw[0x41]= & eeprom->eearl_reg;
-    rw[0x40]= & eeprom->eedr_reg;
-    rw[0x3F]= & eeprom->eecr_reg;
+    rw.SetMember(0x44, & timer0->tccr_reg);
+    rw.SetMember(0x43, & gtccr_reg);
+    rw.SetMember(0x42, & eeprom->eearh_reg);
+    rw.SetMember(0x41, & eeprom->eearl_reg);
+    rw.SetMember(0x40, & eeprom->eedr_reg);
+    rw.SetMember(0x3F, & eeprom->eecr_reg);
 
-    rw[0x3E]= gpior0_reg;
-    rw[0x3D]= eimsk_reg;
-    rw[0x3C]= eifr_reg;
+    rw.SetMember(0x3E, gpior0_reg);
+    rw.SetMember(0x3D, eimsk_reg);
+    rw.SetMember(0x3C, eifr_reg);
 
     /* 0x39-0x3b Reserved */
-    rw[0x38]= & timerIrq3->tifr_reg;
-    rw[0x37]= & timerIrq2->tifr_reg;
-    rw[0x36]= & timerIrq1->tifr_reg;
-    rw[0x35]= & timerIrq0->tifr_reg;
+    rw.SetMember(0x38, & timerIrq3->tifr_reg);
+    rw.SetMember(0x37, & timerIrq2->tifr_reg);
+    rw.SetMember(0x36, & timerIrq1->tifr_reg);
+    rw.SetMember(0x35, & timerIrq0->tifr_reg);
 
-    rw[0x34]= & portg.port_reg;
-    rw[0x33]= & portg.ddr_reg;
-    rw[0x32]= & portg.pin_reg;
+    rw.SetMember(0x34, & portg.port_reg);
+    rw.SetMember(0x33, & portg.ddr_reg);
+    rw.SetMember(0x32, & portg.pin_reg);
 
-    rw[0x31]= & portf.port_reg;
-    rw[0x30]= & portf.ddr_reg;
-    rw[0x2F]= & portf.pin_reg;
+    rw.SetMember(0x31, & portf.port_reg);
+    rw.SetMember(0x30, & portf.ddr_reg);
+    rw.SetMember(0x2F, & portf.pin_reg);
 
-    rw[0x2E]= & porte.port_reg;
-    rw[0x2D]= & porte.ddr_reg;
-    rw[0x2C]= & porte.pin_reg;
+    rw.SetMember(0x2E, & porte.port_reg);
+    rw.SetMember(0x2D, & porte.ddr_reg);
+    rw.SetMember(0x2C, & porte.pin_reg);
 
-    rw[0x2B]= & portd.port_reg;
-    rw[0x2A]= & portd.ddr_reg;
-    rw[0x29]= & portd.pin_reg;
+    rw.SetMember(0x2B, & portd.port_reg);
+    rw.SetMember(0x2A, & portd.ddr_reg);
+    rw.SetMember(0x29, & portd.pin_reg);
 
-    rw[0x28]= & portc.port_reg;
-    rw[0x27]= & portc.ddr_reg;
-    rw[0x26]= & portc.pin_reg;
+    rw.SetMember(0x28, & portc.port_reg);
+    rw.SetMember(0x27, & portc.ddr_reg);
+    rw.SetMember(0x26, & portc.pin_reg);
 
-    rw[0x25]= & portb.port_reg;
-    rw[0x24]= & portb.ddr_reg;
-    rw[0x23]= & portb.pin_reg;
+    rw.SetMember(0x25, & portb.port_reg);
+    rw.SetMember(0x24, & portb.ddr_reg);
+    rw.SetMember(0x23, & portb.pin_reg);
 
-    rw[0x22]= & porta.port_reg;
-    rw[0x21]= & porta.ddr_reg;
-    rw[0x20]= & porta.pin_reg;
+    rw.SetMember(0x22, & porta.port_reg);
+    rw.SetMember(0x21, & porta.ddr_reg);
+    rw.SetMember(0x20, & porta.pin_reg);
 
     Reset();
 }
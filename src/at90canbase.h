@@ -57,6 +57,7 @@ class AvrDevice_at90canbase: public AvrDevice {
         HWPort              portg;       //!< port G
         IOSpecialReg        gtccr_reg;   //!< GTCCR IO register
         IOSpecialReg        assr_reg;    //!< ASSR IO register
+        IOSpecialReg        smcr_reg;    //!< SMCR IO register
         HWPrescaler         prescaler013; //!< prescaler unit for timer 0, 1 and 3
         HWPrescalerAsync    prescaler2;  //!< prescaler unit for timer 2
         ExternalIRQHandler* extirq01;    //!< external interrupt support for INT0, INT1, INT2, INT3, INT4, INT5, INT6, INT7
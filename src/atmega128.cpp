@@ -56,6 +56,7 @@ AvrDevice_atmega128base::~AvrDevice_atmega128base() {
     delete prescaler0;
     delete assr_reg;
     delete extirq;
+    delete mcucr_reg;
     delete eifr_reg;
     delete eimsk_reg;
     delete eicrb_reg;
@@ -131,6 +132,8 @@ AvrDevice_atmega128base::AvrDevice_atmega128base(unsigned flash_bytes,
     eicrb_reg = new IOSpecialReg(&coreTraceGroup, "EICRB");
     eimsk_reg = new IOSpecialReg(&coreTraceGroup, "EIMSK");
     eifr_reg = new IOSpecialReg(&coreTraceGroup, "EIFR");
+    mcucr_reg = new IOSpecialReg(&coreTraceGroup, "MCUCR");
+    SetSleepControl(mcucr_reg, 0x20); // SE bit
     extirq = new ExternalIRQHandler(this, irqSystem, eimsk_reg, eifr_reg);
     extirq->registerIrq(1, 0, new ExternalIRQSingle(eicra_reg, 0, 2, GetPin("D0")));
     extirq->registerIrq(2, 1, new ExternalIRQSingle(eicra_reg, 2, 2, GetPin("D1")));
@@ -213,117 +216,118 @@ AvrDevice_atmega128base::AvrDevice_atmega128base(unsigned flash_bytes,
   
     acomp = new HWAcomp(this, irqSystem, PinAtPort(porte, 2), PinAtPort(porte, 3), 23, ad, timer1, sfior_reg);
 
-    rw[0x9d]= & usart1->ucsrc_reg;
-    rw[0x9c]= & usart1->udr_reg;
-    rw[0x9b]= & usart1->ucsra_reg;
-    rw[0x9a]= & usart1->ucsrb_reg;
-    rw[0x99]= & usart1->ubrr_reg;
-    rw[0x98]= & usart1->ubrrhi_reg;
+    rw.SetMember(0x9d, & usart1->ucsrc_reg);
+    rw.SetMember(0x9c, & usart1->udr_reg);
+    rw.SetMember(0x9b, & usart1->ucsra_reg);
+    rw.SetMember(0x9a, & usart1->ucsrb_reg);
+    rw.SetMember(0x99, & usart1->ubrr_reg);
+    rw.SetMember(0x98, & usart1->ubrrhi_reg);
     // 0x97, 0x96 reserved
-    rw[0x95]= & usart0->ucsrc_reg;
+    rw.SetMember(0x95, & usart0->ucsrc_reg);
     // 0x94 - 0x91 reserved
-    rw[0x90]= & usart0->ubrrhi_reg;
+    rw.SetMember(0x90, & usart0->ubrrhi_reg);
     // 0x8f reserved
     if(!is_m128)
-        rw[0x8e]= & ad->adcsrb_reg;
+        rw.SetMember(0x8e, & ad->adcsrb_reg);
     // 0x8d reserved
-    rw[0x8c]= & timer3->tccrc_reg;
-    rw[0x8b]= & timer3->tccra_reg;
-    rw[0x8a]= & timer3->tccrb_reg;
-    rw[0x89]= & timer3->tcnt_h_reg;
-    rw[0x88]= & timer3->tcnt_l_reg;
-    rw[0x87]= & timer3->ocra_h_reg;
-    rw[0x86]= & timer3->ocra_l_reg;
-    rw[0x85]= & timer3->ocrb_h_reg;
-    rw[0x84]= & timer3->ocrb_l_reg;
-    rw[0x83]= & timer3->ocrc_h_reg;
-    rw[0x82]= & timer3->ocrc_l_reg;
-    rw[0x81]= & timer3->icr_h_reg;
-    rw[0x80]= & timer3->icr_l_reg;
+    rw.SetMember(0x8c, & timer3->tccrc_reg);
+    rw.SetMember(0x8b, & timer3->tccra_reg);
+    rw.SetMember(0x8a, & timer3->tccrb_reg);
+    rw.SetMember(0x89, & timer3->tcnt_h_reg);
+    rw.SetMember(0x88, & timer3->tcnt_l_reg);
+    rw.SetMember(0x87, & timer3->ocra_h_reg);
+    rw.SetMember(0x86, & timer3->ocra_l_reg);
+    rw.SetMember(0x85, & timer3->ocrb_h_reg);
+    rw.SetMember(0x84, & timer3->ocrb_l_reg);
+    rw.SetMember(0x83, & timer3->ocrc_h_reg);
+    rw.SetMember(0x82, & timer3->ocrc_l_reg);
+    rw.SetMember(0x81, & timer3->icr_h_reg);
+    rw.SetMember(0x80, & timer3->icr_l_reg);
     // 0x7f, 0x7e reserved
-    rw[0x7d]= & timer3irq->timsk_reg;
-    rw[0x7c]= & timer3irq->tifr_reg;
+    rw.SetMember(0x7d, & timer3irq->timsk_reg);
+    rw.SetMember(0x7c, & timer3irq->tifr_reg);
     // 0x7b reserved
-    rw[0x7a]= & timer1->tccrc_reg;
-    rw[0x79]= & timer1->ocrc_h_reg;
-    rw[0x78]= & timer1->ocrc_l_reg;
+    rw.SetMember(0x7a, & timer1->tccrc_reg);
+    rw.SetMember(0x79, & timer1->ocrc_h_reg);
+    rw.SetMember(0x78, & timer1->ocrc_l_reg);
     
-    rw[0x6f]= osccal_reg;
+    rw.SetMember(0x6f, osccal_reg);
 
-    rw[0x6a]= eicra_reg;
-    rw[0x68]= & spmRegister->spmcr_reg;
+    rw.SetMember(0x6a, eicra_reg);
+    rw.SetMember(0x68, & spmRegister->spmcr_reg);
     
-    rw[0x65]= & portg->port_reg;
-    rw[0x64]= & portg->ddr_reg;
-    rw[0x63]= & portg->pin_reg;
-    rw[0x62]= & portf->port_reg;
-    rw[0x61]= & portf->ddr_reg;
+    rw.SetMember(0x65, & portg->port_reg);
+    rw.SetMember(0x64, & portg->ddr_reg);
+    rw.SetMember(0x63, & portg->pin_reg);
+    rw.SetMember(0x62, & portf->port_reg);
+    rw.SetMember(0x61, & portf->ddr_reg);
     
-    rw[0x5f]= statusRegister;
-    rw[0x5e]= & ((HWStackSram *)stack)->sph_reg;
-    rw[0x5d]= & ((HWStackSram *)stack)->spl_reg;
-    rw[0x5c]= xdiv_reg;
+    rw.SetMember(0x5f, statusRegister);
+    rw.SetMember(0x5e, & ((HWStackSram *)stack)->sph_reg);
+    rw.SetMember(0x5d, & ((HWStackSram *)stack)->spl_reg);
+    rw.SetMember(0x5c, xdiv_reg);
     if(is_m128)
-        rw[0x5b]= & rampz->ext_reg;
-    rw[0x5a]= eicrb_reg;
-    rw[0x59]= eimsk_reg;
-    rw[0x58]= eifr_reg;
-    rw[0x57]= & timer012irq->timsk_reg;
-    rw[0x56]= & timer012irq->tifr_reg;
+        rw.SetMember(0x5b, & rampz->ext_reg);
+    rw.SetMember(0x5a, eicrb_reg);
+    rw.SetMember(0x59, eimsk_reg);
+    rw.SetMember(0x58, eifr_reg);
+    rw.SetMember(0x57, & timer012irq->timsk_reg);
+    rw.SetMember(0x56, & timer012irq->tifr_reg);
+    rw.SetMember(0x55, mcucr_reg);
     
-    rw[0x53]= & timer0->tccr_reg;
-    rw[0x52]= & timer0->tcnt_reg;
-    rw[0x51]= & timer0->ocra_reg;
-    rw[0x50]= assr_reg;
-    rw[0x4f]= & timer1->tccra_reg; 
-    rw[0x4e]= & timer1->tccrb_reg;
-    rw[0x4d]= & timer1->tcnt_h_reg;
-    rw[0x4c]= & timer1->tcnt_l_reg;
-    rw[0x4b]= & timer1->ocra_h_reg;
-    rw[0x4a]= & timer1->ocra_l_reg;
-    rw[0x49]= & timer1->ocrb_h_reg;
-    rw[0x48]= & timer1->ocrb_l_reg;
-    rw[0x47]= & timer1->icr_h_reg;
-    rw[0x46]= & timer1->icr_l_reg;
-    rw[0x45]= & timer2->tccr_reg;
-    rw[0x44]= & timer2->tcnt_reg;
-    rw[0x43]= & timer2->ocra_reg;
+    rw.SetMember(0x53, & timer0->tccr_reg);
+    rw.SetMember(0x52, & timer0->tcnt_reg);
+    rw.SetMember(0x51, & timer0->ocra_reg);
+    rw.SetMember(0x50, assr_reg);
+    rw.SetMember(0x4f, & timer1->tccra_reg); 
+    rw.SetMember(0x4e, & timer1->tccrb_reg);
+    rw.SetMember(0x4d, & timer1->tcnt_h_reg);
+    rw.SetMember(0x4c, & timer1->tcnt_l_reg);
+    rw.SetMember(0x4b, & timer1->ocra_h_reg);
+    rw.SetMember(0x4a, & timer1->ocra_l_reg);
+    rw.SetMember(0x49, & timer1->ocrb_h_reg);
+    rw.SetMember(0x48, & timer1->ocrb_l_reg);
+    rw.SetMember(0x47, & timer1->icr_h_reg);
+    rw.SetMember(0x46, & timer1->icr_l_reg);
+    rw.SetMember(0x45, & timer2->tccr_reg);
+    rw.SetMember(0x44, & timer2->tcnt_reg);
+    rw.SetMember(0x43, & timer2->ocra_reg);
 
     //0x42: on chip debug
 
-    rw[0x40]= sfior_reg;
-    rw[0x3f]= & eeprom->eearh_reg;
-    rw[0x3e]= & eeprom->eearl_reg;
-    rw[0x3d]= & eeprom->eedr_reg;
-    rw[0x3c]= & eeprom->eecr_reg;
-    rw[0x3b]= & porta->port_reg;
-    rw[0x3a]= & porta->ddr_reg;
-    rw[0x39]= & porta->pin_reg;
-    rw[0x38]= & portb->port_reg;
-    rw[0x37]= & portb->ddr_reg;
-    rw[0x36]= & portb->pin_reg;
-    rw[0x35]= & portc->port_reg;
-    rw[0x34]= & portc->ddr_reg;
-    rw[0x33]= & portc->pin_reg;
-    rw[0x32]= & portd->port_reg;
-    rw[0x31]= & portd->ddr_reg;
-    rw[0x30]= & portd->pin_reg;
-    rw[0x2f]= & spi->spdr_reg;
-    rw[0x2e]= & spi->spsr_reg;
-    rw[0x2d]= & spi->spcr_reg;
-    rw[0x2c]= & usart0->udr_reg;
-    rw[0x2b]= & usart0->ucsra_reg;
-    rw[0x2a]= & usart0->ucsrb_reg;
-    rw[0x29]= & usart0->ubrr_reg;
-    rw[0x28]= & acomp->acsr_reg;
-    rw[0x27]= & ad->admux_reg;
-    rw[0x26]= & ad->adcsra_reg;
-    rw[0x25]= & ad->adch_reg;
-    rw[0x24]= & ad->adcl_reg;
-    rw[0x23]= & porte->port_reg;
-    rw[0x22]= & porte->ddr_reg;
-    rw[0x21]= & porte->pin_reg;
-    rw[0x20]= & portf->pin_reg;
+    rw.SetMember(0x40, sfior_reg);
+    rw.SetMember(0x3f, & eeprom->eearh_reg);
+    rw.SetMember(0x3e, & eeprom->eearl_reg);
+    rw.SetMember(0x3d, & eeprom->eedr_reg);
+    rw.SetMember(0x3c, & eeprom->eecr_reg);
+    rw.SetMember(0x3b, & porta->port_reg);
+    rw.SetMember(0x3a, & porta->ddr_reg);
+    rw.SetMember(0x39, & porta->pin_reg);
+    rw.SetMember(0x38, & portb->port_reg);
+    rw.SetMember(0x37, & portb->ddr_reg);
+    rw.SetMember(0x36, & portb->pin_reg);
+    rw.SetMember(0x35, & portc->port_reg);
+    rw.SetMember(0x34, & portc->ddr_reg);
+    rw.SetMember(0x33, & portc->pin_reg);
+    rw.SetMember(0x32, & portd->port_reg);
+    rw.SetMember(0x31, & portd->ddr_reg);
+    rw.SetMember(0x30, & portd->pin_reg);
+    rw.SetMember(0x2f, & spi->spdr_reg);
+    rw.SetMember(0x2e, & spi->spsr_reg);
+    rw.SetMember(0x2d, & spi->spcr_reg);
+    rw.SetMember(0x2c, & usart0->udr_reg);
+    rw.SetMember(0x2b, & usart0->ucsra_reg);
+    rw.SetMember(0x2a, & usart0->ucsrb_reg);
+    rw.SetMember(0x29, & usart0->ubrr_reg);
+    rw.SetMember(0x28, & acomp->acsr_reg);
+    rw.SetMember(0x27, & ad->admux_reg);
+    rw.SetMember(0x26, & ad->adcsra_reg);
+    rw.SetMember(0x25, & ad->adch_reg);
+    rw.SetMember(0x24, & ad->adcl_reg);
+    rw.SetMember(0x23, & porte->port_reg);
+    rw.SetMember(0x22, & porte->ddr_reg);
+    rw.SetMember(0x21, & porte->pin_reg);
+    rw.SetMember(0x20, & portf->pin_reg);
 
     Reset();
 }
@@ -57,6 +57,7 @@ class AvrDevice_atmega128base: public AvrDevice {
         IOSpecialReg *eicrb_reg;        //!< EICRB IO register
         IOSpecialReg *eimsk_reg;        //!< EIMSK IO register
         IOSpecialReg *eifr_reg;         //!< EIFR IO register
+        IOSpecialReg *mcucr_reg;        //!< MCUCR IO register
         XDIVRegister *xdiv_reg;         //!< XDIV IO register
         OSCCALRegister *osccal_reg;     //!< OSCCAL IO register
 
@@ -50,6 +50,7 @@ protected:
     HWPort              portd;       //!< port D
     IOSpecialReg        gtccr_reg;   //!< GTCCR IO register
     IOSpecialReg        assr_reg;    //!< ASSR IO register
+    IOSpecialReg        smcr_reg;    //!< SMCR IO register
     HWPrescaler         prescaler01; //!< prescaler unit for timer 0 and 1
     HWPrescalerAsync    prescaler2;  //!< prescaler unit for timer 2
     ExternalIRQHandler* extirq012;   //!< external interrupt support for INT0, INT1, INT2
@@ -113,6 +113,7 @@ AvrDevice_atmega16_32::AvrDevice_atmega16_32(unsigned ram_bytes,
     gicr_reg = new IOSpecialReg(&coreTraceGroup, "GICR");
     gifr_reg = new IOSpecialReg(&coreTraceGroup, "GIFR");
     mcucr_reg = new IOSpecialReg(&coreTraceGroup, "MCUCR");
+    SetSleepControl(mcucr_reg, atmega16 ? 0x40 : 0x80); // SE bit
     mcucsr_reg = new IOSpecialReg(&coreTraceGroup, "MCUCSR");
     extirq = new ExternalIRQHandler(this, irqSystem, gicr_reg, gifr_reg);
     extirq->registerIrq(1, 6, new ExternalIRQSingle(mcucr_reg, 0, 2, GetPin("D2")));  // INT0
@@ -167,66 +168,66 @@ AvrDevice_atmega16_32::AvrDevice_atmega16_32(unsigned ram_bytes,
     
     acomp = new HWAcomp(this, irqSystem, PinAtPort(portb, 2), PinAtPort(portb, 3), atmega16 ? 16 : 18, ad, timer1, sfior_reg);
 
-    rw[0x5f]= statusRegister;
-    rw[0x5e]= & ((HWStackSram *)stack)->sph_reg;
-    rw[0x5d]= & ((HWStackSram *)stack)->spl_reg;
-    rw[0x5c]= & timer0->ocra_reg;
-    rw[0x5b]= gicr_reg;
-    rw[0x5a]= gifr_reg;
-    rw[0x59]= & timer012irq->timsk_reg;
-    rw[0x58]= & timer012irq->tifr_reg;
-    rw[0x57]= & spmRegister->spmcr_reg;
+    rw.SetMember(0x5f, statusRegister);
+    rw.SetMember(0x5e, & ((HWStackSram *)stack)->sph_reg);
+    rw.SetMember(0x5d, & ((HWStackSram *)stack)->spl_reg);
+    rw.SetMember(0x5c, & timer0->ocra_reg);
+    rw.SetMember(0x5b, gicr_reg);
+    rw.SetMember(0x5a, gifr_reg);
+    rw.SetMember(0x59, & timer012irq->timsk_reg);
+    rw.SetMember(0x58, & timer012irq->tifr_reg);
+    rw.SetMember(0x57, & spmRegister->spmcr_reg);
     //rw[0x56] TWCR
-    rw[0x55] = mcucr_reg;
-    rw[0x54] = mcucsr_reg;
-    rw[0x53]= & timer0->tccr_reg;
-    rw[0x52]= & timer0->tcnt_reg;
-    rw[0x51]= osccal_reg; // Attention! OCDR register isn't simulated!
-    rw[0x50]= sfior_reg;
-    rw[0x4f]= & timer1->tccra_reg; 
-    rw[0x4e]= & timer1->tccrb_reg;
-    rw[0x4d]= & timer1->tcnt_h_reg;
-    rw[0x4c]= & timer1->tcnt_l_reg;
-    rw[0x4b]= & timer1->ocra_h_reg;
-    rw[0x4a]= & timer1->ocra_l_reg;
-    rw[0x49]= & timer1->ocrb_h_reg;
-    rw[0x48]= & timer1->ocrb_l_reg;
-    rw[0x47]= & timer1->icr_h_reg;
-    rw[0x46]= & timer1->icr_l_reg;
-    rw[0x45]= & timer2->tccr_reg;
-    rw[0x44]= & timer2->tcnt_reg;
-    rw[0x43]= & timer2->ocra_reg;
-    rw[0x42]= assr_reg;
-    rw[0x41]= & wado->wdtcr_reg;
-    rw[0x40]= & usart->ucsrc_ubrrh_reg;
-    rw[0x3f]= & eeprom->eearh_reg;
-    rw[0x3e]= & eeprom->eearl_reg;
-    rw[0x3d]= & eeprom->eedr_reg;
-    rw[0x3c]= & eeprom->eecr_reg;
-    rw[0x3b]= & porta->port_reg;
-    rw[0x3a]= & porta->ddr_reg;
-    rw[0x39]= & porta->pin_reg;
-    rw[0x38]= & portb->port_reg;
-    rw[0x37]= & portb->ddr_reg;
-    rw[0x36]= & portb->pin_reg;
-    rw[0x35]= & portc->port_reg;
-    rw[0x34]= & portc->ddr_reg;
-    rw[0x33]= & portc->pin_reg;
-    rw[0x32]= & portd->port_reg;
-    rw[0x31]= & portd->ddr_reg;
-    rw[0x30]= & portd->pin_reg;
-    rw[0x2f]= & spi->spdr_reg;
-    rw[0x2e]= & spi->spsr_reg;
-    rw[0x2d]= & spi->spcr_reg;
-    rw[0x2c]= & usart->udr_reg;
-    rw[0x2b]= & usart->ucsra_reg;
-    rw[0x2a]= & usart->ucsrb_reg;
-    rw[0x29]= & usart->ubrr_reg;
-    rw[0x28]= & acomp->acsr_reg;
-    rw[0x27]= & ad->admux_reg;
-    rw[0x26]= & ad->adcsra_reg;
-    rw[0x25]= & ad->adch_reg;
-    rw[0x24]= & ad->adcl_reg;
+    rw.SetMember(0x55, mcucr_reg);
+    rw.SetMember(0x54, mcucsr_reg);
+    rw.SetMember(0x53, & timer0->tccr_reg);
+    rw.SetMember(0x52, & timer0->tcnt_reg);
+    rw.SetMember(0x51, osccal_reg); // Attention! OCDR register isn't simulated!
+    rw.SetMember(0x50, sfior_reg);
+    rw.SetMember(0x4f, & timer1->tccra_reg); 
+    rw.SetMember(0x4e, & timer1->tccrb_reg);
+    rw.SetMember(0x4d, & timer1->tcnt_h_reg);
+    rw.SetMember(0x4c, & timer1->tcnt_l_reg);
+    rw.SetMember(0x4b, & timer1->ocra_h_reg);
+    rw.SetMember(0x4a, & timer1->ocra_l_reg);
+    rw.SetMember(0x49, & timer1->ocrb_h_reg);
+    rw.SetMember(0x48, & timer1->ocrb_l_reg);
+    rw.SetMember(0x47, & timer1->icr_h_reg);
+    rw.SetMember(0x46, & timer1->icr_l_reg);
+    rw.SetMember(0x45, & timer2->tccr_reg);
+    rw.SetMember(0x44, & timer2->tcnt_reg);
+    rw.SetMember(0x43, & timer2->ocra_reg);
+    rw.SetMember(0x42, assr_reg);
+    rw.SetMember(0x41, & wado->wdtcr_reg);
+    rw.SetMember(0x40, & usart->ucsrc_ubrrh_reg);
+    rw.SetMember(0x3f, & eeprom->eearh_reg);
+    rw.SetMember(0x3e, & eeprom->eearl_reg);
+    rw.SetMember(0x3d, & eeprom->eedr_reg);
+    rw.SetMember(0x3c, & eeprom->eecr_reg);
+    rw.SetMember(0x3b, & porta->port_reg);
+    rw.SetMember(0x3a, & porta->ddr_reg);
+    rw.SetMember(0x39, & porta->pin_reg);
+    rw.SetMember(0x38, & portb->port_reg);
+    rw.SetMember(0x37, & portb->ddr_reg);
+    rw.SetMember(0x36, & portb->pin_reg);
+    rw.SetMember(0x35, & portc->port_reg);
+    rw.SetMember(0x34, & portc->ddr_reg);
+    rw.SetMember(0x33, & portc->pin_reg);
+    rw.SetMember(0x32, & portd->port_reg);
+    rw.SetMember(0x31, & portd->ddr_reg);
+    rw.SetMember(0x30, & portd->pin_reg);
+    rw.SetMember(0x2f, & spi->spdr_reg);
+    rw.SetMember(0x2e, & spi->spsr_reg);
+    rw.SetMember(0x2d, & spi->spcr_reg);
+    rw.SetMember(0x2c, & usart->udr_reg);
+    rw.SetMember(0x2b, & usart->ucsra_reg);
+    rw.SetMember(0x2a, & usart->ucsrb_reg);
+    rw.SetMember(0x29, & usart->ubrr_reg);
+    rw.SetMember(0x28, & acomp->acsr_reg);
+    rw.SetMember(0x27, & ad->admux_reg);
+    rw.SetMember(0x26, & ad->adcsra_reg);
+    rw.SetMember(0x25, & ad->adch_reg);
+    rw.SetMember(0x24, & ad->adcl_reg);
     //rw[0x23] TWDR
     //rw[0x22] TWAR
     //rw[0x21] TWSR
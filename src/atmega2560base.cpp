@@ -106,6 +106,7 @@ AvrDevice_atmega2560base::AvrDevice_atmega2560base(unsigned ram_bytes,
     portl(this, "L", true),
     gtccr_reg(&coreTraceGroup, "GTCCR"),
     assr_reg(&coreTraceGroup, "ASSR"),
+    smcr_reg(&coreTraceGroup, "SMCR"),
     prescaler1(this, "1", &gtccr_reg, 0, 7),
     prescaler2(this, "2", PinAtPort(&portg, 4), &assr_reg, 5, &gtccr_reg, 1, 7)
 { 
@@ -116,6 +117,7 @@ AvrDevice_atmega2560base::AvrDevice_atmega2560base(unsigned ram_bytes,
     spmRegister = new FlashProgramming(this, 128, nrww_start, FlashProgramming::SPM_MEGA_MODE);
 
     irqSystem = new HWIrqSystem(this, 4, 57);
+    SetSleepControl(&smcr_reg, 0x01); // SE bit
 
     eeprom = new HWEeprom(this, irqSystem, ee_bytes, 30, HWEeprom::DEVMODE_EXTENDED); 
     stack = new HWStackSram(this, 16, true);
@@ -335,219 +337,219 @@ AvrDevice_atmega2560base::AvrDevice_atmega2560base(unsigned ram_bytes,
                          56,   // (57) TX complete vector
                          3);   // instance_id for tracking in UI
 
-    rw[0x136]= & usart3->udr_reg;
-    rw[0x135]= & usart3->ubrrhi_reg;
-    rw[0x134]= & usart3->ubrr_reg;
+    rw.SetMember(0x136, & usart3->udr_reg);
+    rw.SetMember(0x135, & usart3->ubrrhi_reg);
+    rw.SetMember(0x134, & usart3->ubrr_reg);
     // 0x133 reserved
-    rw[0x132]= & usart3->ucsrc_reg;
-    rw[0x131]= & usart3->ucsrb_reg;
-    rw[0x130]= & usart3->ucsra_reg;
+    rw.SetMember(0x132, & usart3->ucsrc_reg);
+    rw.SetMember(0x131, & usart3->ucsrb_reg);
+    rw.SetMember(0x130, & usart3->ucsra_reg);
     // 0x12F and 0x12E reserved
-    rw[0x12D]= & timer5->ocrc_h_reg;
-    rw[0x12C]= & timer5->ocrc_l_reg;
-    rw[0x12B]= & timer5->ocrb_h_reg;
-    rw[0x12A]= & timer5->ocrb_l_reg;
-    rw[0x129]= & timer5->ocra_h_reg;
-    rw[0x128]= & timer5->ocra_l_reg;
-    rw[0x127]= & timer5->icr_h_reg;
-    rw[0x126]= & timer5->icr_l_reg;
-    rw[0x125]= & timer5->tcnt_h_reg;
-    rw[0x124]= & timer5->tcnt_l_reg;
+    rw.SetMember(0x12D, & timer5->ocrc_h_reg);
+    rw.SetMember(0x12C, & timer5->ocrc_l_reg);
+    rw.SetMember(0x12B, & timer5->ocrb_h_reg);
+    rw.SetMember(0x12A, & timer5->ocrb_l_reg);
+    rw.SetMember(0x129, & timer5->ocra_h_reg);
+    rw.SetMember(0x128, & timer5->ocra_l_reg);
+    rw.SetMember(0x127, & timer5->icr_h_reg);
+    rw.SetMember(0x126, & timer5->icr_l_reg);
+    rw.SetMember(0x125, & timer5->tcnt_h_reg);
+    rw.SetMember(0x124, & timer5->tcnt_l_reg);
     // 0x123 reserved
-    rw[0x122]= & timer5->tccrc_reg;
-    rw[0x121]= & timer5->tccrb_reg;
-    rw[0x120]= & timer5->tccra_reg;
+    rw.SetMember(0x122, & timer5->tccrc_reg);
+    rw.SetMember(0x121, & timer5->tccrb_reg);
+    rw.SetMember(0x120, & timer5->tccra_reg);
     // 0x10C - 0x11F reserved
-    rw[0x10B]= & portl.port_reg;
-    rw[0x10A]= & portl.ddr_reg;
-    rw[0x109]= & portl.pin_reg;
-    rw[0x108]= & portk.port_reg;
-    rw[0x107]= & portk.ddr_reg;
-    rw[0x106]= & portk.pin_reg;
-    rw[0x105]= & portj.port_reg;
-    rw[0x104]= & portj.ddr_reg;
-    rw[0x103]= & portj.pin_reg;
-    rw[0x102]= & porth.port_reg;
-    rw[0x101]= & porth.ddr_reg;
-    rw[0x100]= & porth.pin_reg;
+    rw.SetMember(0x10B, & portl.port_reg);
+    rw.SetMember(0x10A, & portl.ddr_reg);
+    rw.SetMember(0x109, & portl.pin_reg);
+    rw.SetMember(0x108, & portk.port_reg);
+    rw.SetMember(0x107, & portk.ddr_reg);
+    rw.SetMember(0x106, & portk.pin_reg);
+    rw.SetMember(0x105, & portj.port_reg);
+    rw.SetMember(0x104, & portj.ddr_reg);
+    rw.SetMember(0x103, & portj.pin_reg);
+    rw.SetMember(0x102, & porth.port_reg);
+    rw.SetMember(0x101, & porth.ddr_reg);
+    rw.SetMember(0x100, & porth.pin_reg);
     // 0xD7 - 0xFF reserved
-    rw[0xD6]= & usart2->udr_reg;
-    rw[0xD5]= & usart2->ubrrhi_reg;
-    rw[0xD4]= & usart2->ubrr_reg;
+    rw.SetMember(0xD6, & usart2->udr_reg);
+    rw.SetMember(0xD5, & usart2->ubrrhi_reg);
+    rw.SetMember(0xD4, & usart2->ubrr_reg);
     // 0xD3 reserved
-    rw[0xD2]= & usart2->ucsrc_reg;
-    rw[0xD1]= & usart2->ucsrb_reg;
-    rw[0xD0]= & usart2->ucsra_reg;
+    rw.SetMember(0xD2, & usart2->ucsrc_reg);
+    rw.SetMember(0xD1, & usart2->ucsrb_reg);
+    rw.SetMember(0xD0, & usart2->ucsra_reg);
     // 0xCF reserved
-    rw[0xCE]= & usart1->udr_reg;
-    rw[0xCD]= & usart1->ubrrhi_reg;
-    rw[0xCC]= & usart1->ubrr_reg;
+    rw.SetMember(0xCE, & usart1->udr_reg);
+    rw.SetMember(0xCD, & usart1->ubrrhi_reg);
+    rw.SetMember(0xCC, & usart1->ubrr_reg);
     // 0xCB reserved
-    rw[0xCA]= & usart1->ucsrc_reg;
-    rw[0xC9]= & usart1->ucsrb_reg;
-    rw[0xC8]= & usart1->ucsra_reg;
+    rw.SetMember(0xCA, & usart1->ucsrc_reg);
+    rw.SetMember(0xC9, & usart1->ucsrb_reg);
+    rw.SetMember(0xC8, & usart1->ucsra_reg);
     // 0xC7 reserved
-    rw[0xC6]= & usart0->udr_reg;
-    rw[0xC5]= & usart0->ubrrhi_reg;
-    rw[0xC4]= & usart0->ubrr_reg;
+    rw.SetMember(0xC6, & usart0->udr_reg);
+    rw.SetMember(0xC5, & usart0->ubrrhi_reg);
+    rw.SetMember(0xC4, & usart0->ubrr_reg);
     // 0xC3 reserved
-    rw[0xC2]= & usart0->ucsrc_reg;
-    rw[0xC1]= & usart0->ucsrb_reg;
-    rw[0xC0]= & usart0->ucsra_reg;
+    rw.SetMember(0xC2, & usart0->ucsrc_reg);
+    rw.SetMember(0xC1, & usart0->ucsrb_reg);
+    rw.SetMember(0xC0, & usart0->ucsra_reg);
     // 0xBF reserved
     // 0xBE reserved
-    rw[0xBD]= new NotSimulatedRegister("TWI register TWAMR not simulated");
-    rw[0xBC]= new NotSimulatedRegister("TWI register TWCR not simulated");
-    rw[0xBB]= new NotSimulatedRegister("TWI register TWDR not simulated");
-    rw[0xBA]= new NotSimulatedRegister("TWI register TWAR not simulated");
-    rw[0xB9]= new NotSimulatedRegister("TWI register TWSR not simulated");
-    rw[0xB8]= new NotSimulatedRegister("TWI register TWBR not simulated");
+    rw.SetMember(0xBD, new NotSimulatedRegister("TWI register TWAMR not simulated"));
+    rw.SetMember(0xBC, new NotSimulatedRegister("TWI register TWCR not simulated"));
+    rw.SetMember(0xBB, new NotSimulatedRegister("TWI register TWDR not simulated"));
+    rw.SetMember(0xBA, new NotSimulatedRegister("TWI register TWAR not simulated"));
+    rw.SetMember(0xB9, new NotSimulatedRegister("TWI register TWSR not simulated"));
+    rw.SetMember(0xB8, new NotSimulatedRegister("TWI register TWBR not simulated"));
     // 0xB7 reserved
-    rw[0xB6]= & assr_reg;
+    rw.SetMember(0xB6, & assr_reg);
     // 0xB5 reserved
-    rw[0xB4]= & timer2->ocrb_reg;
-    rw[0xB3]= & timer2->ocra_reg;
-    rw[0xB2]= & timer2->tcnt_reg;
-    rw[0xB1]= & timer2->tccrb_reg;
-    rw[0xB0]= & timer2->tccra_reg;
+    rw.SetMember(0xB4, & timer2->ocrb_reg);
+    rw.SetMember(0xB3, & timer2->ocra_reg);
+    rw.SetMember(0xB2, & timer2->tcnt_reg);
+    rw.SetMember(0xB1, & timer2->tccrb_reg);
+    rw.SetMember(0xB0, & timer2->tccra_reg);
     // 0xAE and 0xAF reserved
-    rw[0xAD]= & timer4->ocrc_h_reg;
-    rw[0xAC]= & timer4->ocrc_l_reg;
-    rw[0xAB]= & timer4->ocrb_h_reg;
-    rw[0xAA]= & timer4->ocrb_l_reg;
-    rw[0xA9]= & timer4->ocra_h_reg;
-    rw[0xA8]= & timer4->ocra_l_reg;
-    rw[0xA7]= & timer4->icr_h_reg;
-    rw[0xA6]= & timer4->icr_l_reg;
-    rw[0xA5]= & timer4->tcnt_h_reg;
-    rw[0xA4]= & timer4->tcnt_l_reg;
+    rw.SetMember(0xAD, & timer4->ocrc_h_reg);
+    rw.SetMember(0xAC, & timer4->ocrc_l_reg);
+    rw.SetMember(0xAB, & timer4->ocrb_h_reg);
+    rw.SetMember(0xAA, & timer4->ocrb_l_reg);
+    rw.SetMember(0xA9, & timer4->ocra_h_reg);
+    rw.SetMember(0xA8, & timer4->ocra_l_reg);
+    rw.SetMember(0xA7, & timer4->icr_h_reg);
+    rw.SetMember(0xA6, & timer4->icr_l_reg);
+    rw.SetMember(0xA5, & timer4->tcnt_h_reg);
+    rw.SetMember(0xA4, & timer4->tcnt_l_reg);
     // 0xA3 reserved
-    rw[0xA2]= & timer4->tccrc_reg;
-    rw[0xA1]= & timer4->tccrb_reg;
-    rw[0xA0]= & timer4->tccra_reg;
+    rw.SetMember(0xA2, & timer4->tccrc_reg);
+    rw.SetMember(0xA1, & timer4->tccrb_reg);
+    rw.SetMember(0xA0, & timer4->tccra_reg);
     // 0x9E  and 0x9F reserved
-    rw[0x9D]= & timer3->ocrc_h_reg;
-    rw[0x9C]= & timer3->ocrc_l_reg;
-    rw[0x9B]= & timer3->ocrb_h_reg;
-    rw[0x9A]= & timer3->ocrb_l_reg;
-    rw[0x99]= & timer3->ocra_h_reg;
-    rw[0x98]= & timer3->ocra_l_reg;
-    rw[0x97]= & timer3->icr_h_reg;
-    rw[0x96]= & timer3->icr_l_reg;
-    rw[0x95]= & timer3->tcnt_h_reg;
-    rw[0x94]= & timer3->tcnt_l_reg;
+    rw.SetMember(0x9D, & timer3->ocrc_h_reg);
+    rw.SetMember(0x9C, & timer3->ocrc_l_reg);
+    rw.SetMember(0x9B, & timer3->ocrb_h_reg);
+    rw.SetMember(0x9A, & timer3->ocrb_l_reg);
+    rw.SetMember(0x99, & timer3->ocra_h_reg);
+    rw.SetMember(0x98, & timer3->ocra_l_reg);
+    rw.SetMember(0x97, & timer3->icr_h_reg);
+    rw.SetMember(0x96, & timer3->icr_l_reg);
+    rw.SetMember(0x95, & timer3->tcnt_h_reg);
+    rw.SetMember(0x94, & timer3->tcnt_l_reg);
     // 0x93 reserved
-    rw[0x92]= & timer3->tccrc_reg;
-    rw[0x91]= & timer3->tccrb_reg;
-    rw[0x90]= & timer3->tccra_reg;
+    rw.SetMember(0x92, & timer3->tccrc_reg);
+    rw.SetMember(0x91, & timer3->tccrb_reg);
+    rw.SetMember(0x90, & timer3->tccra_reg);
     // 0x8E  and 0x8F reserved
-    rw[0x8D]= & timer1->ocrc_h_reg;
-    rw[0x8C]= & timer1->ocrc_l_reg;
-    rw[0x8B]= & timer1->ocrb_h_reg;
-    rw[0x8A]= & timer1->ocrb_l_reg;
-    rw[0x89]= & timer1->ocra_h_reg;
-    rw[0x88]= & timer1->ocra_l_reg;
-    rw[0x87]= & timer1->icr_h_reg;
-    rw[0x86]= & timer1->icr_l_reg;
-    rw[0x85]= & timer1->tcnt_h_reg;
-    rw[0x84]= & timer1->tcnt_l_reg;
+    rw.SetMember(0x8D, & timer1->ocrc_h_reg);
+    rw.SetMember(0x8C, & timer1->ocrc_l_reg);
+    rw.SetMember(0x8B, & timer1->ocrb_h_reg);
+    rw.SetMember(0x8A, & timer1->ocrb_l_reg);
+    rw.SetMember(0x89, & timer1->ocra_h_reg);
+    rw.SetMember(0x88, & timer1->ocra_l_reg);
+    rw.SetMember(0x87, & timer1->icr_h_reg);
+    rw.SetMember(0x86, & timer1->icr_l_reg);
+    rw.SetMember(0x85, & timer1->tcnt_h_reg);
+    rw.SetMember(0x84, & timer1->tcnt_l_reg);
     // 0x83 reserved
-    rw[0x82]= & timer1->tccrc_reg;
-    rw[0x81]= & timer1->tccrb_reg;
-    rw[0x80]= & timer1->tccra_reg;
-    rw[0x7F]= new NotSimulatedRegister("ADC register DIDR1 not simulated");
-    rw[0x7E]= new NotSimulatedRegister("ADC register DIDR0 not simulated");
-    rw[0x7D]= new NotSimulatedRegister("ADC register DIDR2 not simulated");
-    rw[0x7C]= & ad->admux_reg;
-    rw[0x7B]= & ad->adcsrb_reg;
-    rw[0x7A]= & ad->adcsra_reg;
-    rw[0x79]= & ad->adch_reg;
-    rw[0x78]= & ad->adcl_reg;
+    rw.SetMember(0x82, & timer1->tccrc_reg);
+    rw.SetMember(0x81, & timer1->tccrb_reg);
+    rw.SetMember(0x80, & timer1->tccra_reg);
+    rw.SetMember(0x7F, new NotSimulatedRegister("ADC register DIDR1 not simulated"));
+    rw.SetMember(0x7E, new NotSimulatedRegister("ADC register DIDR0 not simulated"));
+    rw.SetMember(0x7D, new NotSimulatedRegister("ADC register DIDR2 not simulated"));
+    rw.SetMember(0x7C, & ad->admux_reg);
+    rw.SetMember(0x7B, & ad->adcsrb_reg);
+    rw.SetMember(0x7A, & ad->adcsra_reg);
+    rw.SetMember(0x79, & ad->adch_reg);
+    rw.SetMember(0x78, & ad->adcl_reg);
     // 0x76, 0x77 reserved
-    rw[0x75]= new NotSimulatedRegister("External Memory Control Register B not simulated");
-    rw[0x74]= new NotSimulatedRegister("External Memory Control Register A not simulated");
-    rw[0x73]= & timerIrq5->timsk_reg;
-    rw[0x72]= & timerIrq4->timsk_reg;
-    rw[0x71]= & timerIrq3->timsk_reg;
-    rw[0x70]= & timerIrq2->timsk_reg;
-    rw[0x6F]= & timerIrq1->timsk_reg;
-    rw[0x6E]= & timerIrq0->timsk_reg;
-    rw[0x6D]= pcmsk2_reg;
-    rw[0x6C]= pcmsk1_reg;
-    rw[0x6B]= pcmsk0_reg;
-    rw[0x6A]= eicrb_reg;
-    rw[0x69]= eicra_reg;
-    rw[0x68]= pcicr_reg;
+    rw.SetMember(0x75, new NotSimulatedRegister("External Memory Control Register B not simulated"));
+    rw.SetMember(0x74, new NotSimulatedRegister("External Memory Control Register A not simulated"));
+    rw.SetMember(0x73, & timerIrq5->timsk_reg);
+    rw.SetMember(0x72, & timerIrq4->timsk_reg);
+    rw.SetMember(0x71, & timerIrq3->timsk_reg);
+    rw.SetMember(0x70, & timerIrq2->timsk_reg);
+    rw.SetMember(0x6F, & timerIrq1->timsk_reg);
+    rw.SetMember(0x6E, & timerIrq0->timsk_reg);
+    rw.SetMember(0x6D, pcmsk2_reg);
+    rw.SetMember(0x6C, pcmsk1_reg);
+    rw.SetMember(0x6B, pcmsk0_reg);
+    rw.SetMember(0x6A, eicrb_reg);
+    rw.SetMember(0x69, eicra_reg);
+    rw.SetMember(0x68, pcicr_reg);
     // 0x67 reserved
-    rw[0x66]= osccal_reg;
-    rw[0x65]= new NotSimulatedRegister("MCU register PRR1 not simulated");
-    rw[0x64]= new NotSimulatedRegister("MCU register PRR0 not simulated");
+    rw.SetMember(0x66, osccal_reg);
+    rw.SetMember(0x65, new NotSimulatedRegister("MCU register PRR1 not simulated"));
+    rw.SetMember(0x64, new NotSimulatedRegister("MCU register PRR0 not simulated"));
     // 0x63 reserved
     // 0x62 reserved
-    rw[0x61]= clkpr_reg;
-    rw[0x60]= new NotSimulatedRegister("MCU register WDTCSR not simulated");
-    rw[0x5F]= statusRegister;
-    rw[0x5E]= & ((HWStackSram *)stack)->sph_reg;
-    rw[0x5D]= & ((HWStackSram *)stack)->spl_reg;
-    rw[0x5C]= & eind->ext_reg;
-    rw[0x5B]= & rampz->ext_reg;
+    rw.SetMember(0x61, clkpr_reg);
+    rw.SetMember(0x60, new NotSimulatedRegister("MCU register WDTCSR not simulated"));
+    rw.SetMember(0x5F, statusRegister);
+    rw.SetMember(0x5E, & ((HWStackSram *)stack)->sph_reg);
+    rw.SetMember(0x5D, & ((HWStackSram *)stack)->spl_reg);
+    rw.SetMember(0x5C, & eind->ext_reg);
+    rw.SetMember(0x5B, & rampz->ext_reg);
     // 0x58 - 0x5A reserved
-    rw[0x57]= & spmRegister->spmcr_reg;
+    rw.SetMember(0x57, & spmRegister->spmcr_reg);
     // 0x56 reserved
-    rw[0x55]= new NotSimulatedRegister("MCU register MCUCR not simulated");
-    rw[0x54]= new NotSimulatedRegister("MCU register MCUSR not simulated");
-    rw[0x53]= new NotSimulatedRegister("MCU register SMCR not simulated");
+    rw.SetMember(0x55, new NotSimulatedRegister("MCU register MCUCR not simulated"));
+    rw.SetMember(0x54, new NotSimulatedRegister("MCU register MCUSR not simulated"));
+    rw.SetMember(0x53, & smcr_reg);
     // 0x52 reserved
-    rw[0x51]= new NotSimulatedRegister("On-chip debug register OCDR not simulated");
-    rw[0x50]= & acomp->acsr_reg;
+    rw.SetMember(0x51, new NotSimulatedRegister("On-chip debug register OCDR not simulated"));
+    rw.SetMember(0x50, & acomp->acsr_reg);
     // 0x4F reserved
-    rw[0x4E]= & spi->spdr_reg;
-    rw[0x4D]= & spi->spsr_reg;
-    rw[0x4C]= & spi->spcr_reg;
-    rw[0x4B]= gpior2_reg;
-    rw[0x4A]= gpior1_reg;
+    rw.SetMember(0x4E, & spi->spdr_reg);
+    rw.SetMember(0x4D, & spi->spsr_reg);
+    rw.SetMember(0x4C, & spi->spcr_reg);
+    rw.SetMember(0x4B, gpior2_reg);
+    rw.SetMember(0x4A, gpior1_reg);
     // 0x49 reserved
-    rw[0x48]= & timer0->ocrb_reg;
-    rw[0x47]= & timer0->ocra_reg;
-    rw[0x46]= & timer0->tcnt_reg;
-    rw[0x45]= & timer0->tccrb_reg;
-    rw[0x44]= & timer0->tccra_reg;
-    rw[0x43]= & gtccr_reg;
-    rw[0x42]= & eeprom->eearh_reg;
-    rw[0x41]= & eeprom->eearl_reg;
-    rw[0x40]= & eeprom->eedr_reg;
-    rw[0x3F]= & eeprom->eecr_reg;
-    rw[0x3E]= gpior0_reg;
-    rw[0x3D]= eimsk_reg;
-    rw[0x3C]= eifr_reg;
-    rw[0x3b]= pcifr_reg;
-    rw[0x3A]= & timerIrq5->tifr_reg;
-    rw[0x39]= & timerIrq4->tifr_reg;
-    rw[0x38]= & timerIrq3->tifr_reg;
-    rw[0x37]= & timerIrq2->tifr_reg;
-    rw[0x36]= & timerIrq1->tifr_reg;
-    rw[0x35]= & timerIrq0->tifr_reg;
-    rw[0x34]= & portg.port_reg;
-    rw[0x33]= & portg.ddr_reg;
-    rw[0x32]= & portg.pin_reg;
-    rw[0x31]= & portf.port_reg;
-    rw[0x30]= & portf.ddr_reg;
-    rw[0x2F]= & portf.pin_reg;
-    rw[0x2E]= & porte.port_reg;
-    rw[0x2D]= & porte.ddr_reg;
-    rw[0x2C]= & porte.pin_reg;
-    rw[0x2B]= & portd.port_reg;
-    rw[0x2A]= & portd.ddr_reg;
-    rw[0x29]= & portd.pin_reg;
-    rw[0x28]= & portc.port_reg;
-    rw[0x27]= & portc.ddr_reg;
-    rw[0x26]= & portc.pin_reg;
-    rw[0x25]= & portb.port_reg;
-    rw[0x24]= & portb.ddr_reg;
-    rw[0x23]= & portb.pin_reg;
-    rw[0x22]= & porta.port_reg;
-    rw[0x21]= & porta.ddr_reg;
-    rw[0x20]= & porta.pin_reg;
+    rw.SetMember(0x48, & timer0->ocrb_reg);
+    rw.SetMember(0x47, & timer0->ocra_reg);
+    rw.SetMember(0x46, & timer0->tcnt_reg);
+    rw.SetMember(0x45, & timer0->tccrb_reg);
+    rw.SetMember(0x44, & timer0->tccra_reg);
+    rw.SetMember(0x43, & gtccr_reg);
+    rw.SetMember(0x42, & eeprom->eearh_reg);
+    rw.SetMember(0x41, & eeprom->eearl_reg);
+    rw.SetMember(0x40, & eeprom->eedr_reg);
+    rw.SetMember(0x3F, & eeprom->eecr_reg);
+    rw.SetMember(0x3E, gpior0_reg);
+    rw.SetMember(0x3D, eimsk_reg);
+    rw.SetMember(0x3C, eifr_reg);
+    rw.SetMember(0x3b, pcifr_reg);
+    rw.SetMember(0x3A, & timerIrq5->tifr_reg);
+    rw.SetMember(0x39, & timerIrq4->tifr_reg);
+    rw.SetMember(0x38, & timerIrq3->tifr_reg);
+    rw.SetMember(0x37, & timerIrq2->tifr_reg);
+    rw.SetMember(0x36, & timerIrq1->tifr_reg);
+    rw.SetMember(0x35, & timerIrq0->tifr_reg);
+    rw.SetMember(0x34, & portg.port_reg);
+    rw.SetMember(0x33, & portg.ddr_reg);
+    rw.SetMember(0x32, & portg.pin_reg);
+    rw.SetMember(0x31, & portf.port_reg);
+    rw.SetMember(0x30, & portf.ddr_reg);
+    rw.SetMember(0x2F, & portf.pin_reg);
+    rw.SetMember(0x2E, & porte.port_reg);
+    rw.SetMember(0x2D, & porte.ddr_reg);
+    rw.SetMember(0x2C, & porte.pin_reg);
+    rw.SetMember(0x2B, & portd.port_reg);
+    rw.SetMember(0x2A, & portd.ddr_reg);
+    rw.SetMember(0x29, & portd.pin_reg);
+    rw.SetMember(0x28, & portc.port_reg);
+    rw.SetMember(0x27, & portc.ddr_reg);
+    rw.SetMember(0x26, & portc.pin_reg);
+    rw.SetMember(0x25, & portb.port_reg);
+    rw.SetMember(0x24, & portb.ddr_reg);
+    rw.SetMember(0x23, & portb.pin_reg);
+    rw.SetMember(0x22, & porta.port_reg);
+    rw.SetMember(0x21, & porta.ddr_reg);
+    rw.SetMember(0x20, & porta.pin_reg);
 
     Reset();
 }
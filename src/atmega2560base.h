@@ -57,6 +57,7 @@ protected:
 
     IOSpecialReg        gtccr_reg;   //!< GTCCR IO register
     IOSpecialReg        assr_reg;    //!< ASSR IO register
+    IOSpecialReg        smcr_reg;    //!< SMCR IO register
     HWPrescaler         prescaler1;  //!< prescaler unit for timer 0, 1, 3, 4 and 5
     HWPrescalerAsync    prescaler2;  //!< prescaler unit for timer 2
     ExternalIRQHandler* extirq;      //!< external interrupt support for INT0 to INT7
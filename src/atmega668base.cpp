@@ -85,6 +85,7 @@ AvrDevice_atmega668base::AvrDevice_atmega668base(unsigned ram_bytes,
     portd(this, "D", true),
     gtccr_reg(&coreTraceGroup, "GTCCR"),
     assr_reg(&coreTraceGroup, "ASSR"),
+    smcr_reg(&coreTraceGroup, "SMCR"),
     prescaler01(this, "01", &gtccr_reg, 0, 7),
     prescaler2(this, "2", PinAtPort(&portb, 6), &assr_reg, 5, &gtccr_reg, 1, 7)
 { 
@@ -115,6 +116,7 @@ AvrDevice_atmega668base::AvrDevice_atmega668base(unsigned ram_bytes,
         spmRegister = new FlashProgramming(this, 32, 0x0000, FlashProgramming::SPM_MEGA_MODE);
     }
     irqSystem = new HWIrqSystem(this, (flash_bytes > 8U * 1024U) ? 4 : 2, 26);
+    SetSleepControl(&smcr_reg, 0x01); // SE bit
     
     eeprom = new HWEeprom(this, irqSystem, ee_bytes, 22, HWEeprom::DEVMODE_EXTENDED);
     // initialize stack: size=10,11,11,12 bit and init to RAMEND
@@ -234,121 +236,121 @@ AvrDevice_atmega668base::AvrDevice_atmega668base(unsigned ram_bytes,
                          19,   // (19) UDRE vector
                          20);  // (20) TX complete vector
 
-    rw[0xE6]= new NotSimulatedRegister("UDR0 register is placed 0xC6!");
-    rw[0xE4]= new NotSimulatedRegister("UBRR0L register is placed 0xC4!");
-    rw[0xE1]= new NotSimulatedRegister("UCSR0B register is placed 0xC1!");
-    rw[0xE1]= new NotSimulatedRegister("UCSR0A register is placed 0xC0!");
-    rw[0xC6]= & usart0->udr_reg;
-    rw[0xC5]= & usart0->ubrrhi_reg;
-    rw[0xC4]= & usart0->ubrr_reg;
+    rw.SetMember(0xE6, new NotSimulatedRegister("UDR0 register is placed 0xC6!"));
+    rw.SetMember(0xE4, new NotSimulatedRegister("UBRR0L register is placed 0xC4!"));
+    rw.SetMember(0xE1, new NotSimulatedRegister("UCSR0B register is placed 0xC1!"));
+    rw.SetMember(0xE1, new NotSimulatedRegister("UCSR0A register is placed 0xC0!"));
+    rw.SetMember(0xC6, & usart0->udr_reg);
+    rw.SetMember(0xC5, & usart0->ubrrhi_reg);
+    rw.SetMember(0xC4, & usart0->ubrr_reg);
     // 0xC3 reserved
-    rw[0xC2]= & usart0->ucsrc_reg;
-    rw[0xC1]= & usart0->ucsrb_reg;
-    rw[0xC0]= & usart0->ucsra_reg;
+    rw.SetMember(0xC2, & usart0->ucsrc_reg);
+    rw.SetMember(0xC1, & usart0->ucsrb_reg);
+    rw.SetMember(0xC0, & usart0->ucsra_reg);
     // 0xBF reserved
-    rw[0xBD]= new NotSimulatedRegister("TWI register TWAMR not simulated");
-    rw[0xBC]= new NotSimulatedRegister("TWI register TWCR not simulated");
-    rw[0xBB]= new NotSimulatedRegister("TWI register TWDR not simulated");
-    rw[0xBA]= new NotSimulatedRegister("TWI register TWAR not simulated");
-    rw[0xB9]= new NotSimulatedRegister("TWI register TWSR not simulated");
-    rw[0xB8]= new NotSimulatedRegister("TWI register TWBR not simulated");
+    rw.SetMember(0xBD, new NotSimulatedRegister("TWI register TWAMR not simulated"));
+    rw.SetMember(0xBC, new NotSimulatedRegister("TWI register TWCR not simulated"));
+    rw.SetMember(0xBB, new NotSimulatedRegister("TWI register TWDR not simulated"));
+    rw.SetMember(0xBA, new NotSimulatedRegister("TWI register TWAR not simulated"));
+    rw.SetMember(0xB9, new NotSimulatedRegister("TWI register TWSR not simulated"));
+    rw.SetMember(0xB8, new NotSimulatedRegister("TWI register TWBR not simulated"));
     // 0xB7 reserved
-    rw[0xb6]= & assr_reg;
+    rw.SetMember(0xb6, & assr_reg);
     // 0xb5 reserved
-    rw[0xb4]= & timer2->ocrb_reg;
-    rw[0xb3]= & timer2->ocra_reg;
-    rw[0xb2]= & timer2->tcnt_reg;
-    rw[0xb1]= & timer2->tccrb_reg;
-    rw[0xb0]= & timer2->tccra_reg;
+    rw.SetMember(0xb4, & timer2->ocrb_reg);
+    rw.SetMember(0xb3, & timer2->ocra_reg);
+    rw.SetMember(0xb2, & timer2->tcnt_reg);
+    rw.SetMember(0xb1, & timer2->tccrb_reg);
+    rw.SetMember(0xb0, & timer2->tccra_reg);
     // 0x8c - 0xaf reserved
-    rw[0x8b]= & timer1->ocrb_h_reg;
-    rw[0x8a]= & timer1->ocrb_l_reg;
-    rw[0x89]= & timer1->ocra_h_reg;
-    rw[0x88]= & timer1->ocra_l_reg;
-    rw[0x87]= & timer1->icr_h_reg;
-    rw[0x86]= & timer1->icr_l_reg;
-    rw[0x85]= & timer1->tcnt_h_reg;
-    rw[0x84]= & timer1->tcnt_l_reg;
+    rw.SetMember(0x8b, & timer1->ocrb_h_reg);
+    rw.SetMember(0x8a, & timer1->ocrb_l_reg);
+    rw.SetMember(0x89, & timer1->ocra_h_reg);
+    rw.SetMember(0x88, & timer1->ocra_l_reg);
+    rw.SetMember(0x87, & timer1->icr_h_reg);
+    rw.SetMember(0x86, & timer1->icr_l_reg);
+    rw.SetMember(0x85, & timer1->tcnt_h_reg);
+    rw.SetMember(0x84, & timer1->tcnt_l_reg);
     // 0x83 reserved
-    rw[0x82]= & timer1->tccrc_reg;
-    rw[0x81]= & timer1->tccrb_reg;
-    rw[0x80]= & timer1->tccra_reg;
-    rw[0x7F]= new NotSimulatedRegister("ADC register DIDR1 not simulated");
-    rw[0x7E]= new NotSimulatedRegister("ADC register DIDR0 not simulated");
+    rw.SetMember(0x82, & timer1->tccrc_reg);
+    rw.SetMember(0x81, & timer1->tccrb_reg);
+    rw.SetMember(0x80, & timer1->tccra_reg);
+    rw.SetMember(0x7F, new NotSimulatedRegister("ADC register DIDR1 not simulated"));
+    rw.SetMember(0x7E, new NotSimulatedRegister("ADC register DIDR0 not simulated"));
     // 0x7D reserved
-    rw[0x7C]= & ad->admux_reg;
-    rw[0x7B]= & ad->adcsrb_reg;
-    rw[0x7A]= & ad->adcsra_reg;
-    rw[0x79]= & ad->adch_reg;
-    rw[0x78]= & ad->adcl_reg;
+    rw.SetMember(0x7C, & ad->admux_reg);
+    rw.SetMember(0x7B, & ad->adcsrb_reg);
+    rw.SetMember(0x7A, & ad->adcsra_reg);
+    rw.SetMember(0x79, & ad->adch_reg);
+    rw.SetMember(0x78, & ad->adcl_reg);
     // 0x71 - 0x77 reserved
-    rw[0x70]= & timerIrq2->timsk_reg;
-    rw[0x6F]= & timerIrq1->timsk_reg;
-    rw[0x6E]= & timerIrq0->timsk_reg;
+    rw.SetMember(0x70, & timerIrq2->timsk_reg);
+    rw.SetMember(0x6F, & timerIrq1->timsk_reg);
+    rw.SetMember(0x6E, & timerIrq0->timsk_reg);
 
-    rw[0x6d]= pcmsk2_reg;
-    rw[0x6c]= pcmsk1_reg;
-    rw[0x6b]= pcmsk0_reg;
+    rw.SetMember(0x6d, pcmsk2_reg);
+    rw.SetMember(0x6c, pcmsk1_reg);
+    rw.SetMember(0x6b, pcmsk0_reg);
     // 0x6A reserved
-    rw[0x69]= eicra_reg;
-    rw[0x68]= pcicr_reg;
+    rw.SetMember(0x69, eicra_reg);
+    rw.SetMember(0x68, pcicr_reg);
     // 0x67 reserved
-    rw[0x66]= osccal_reg;
+    rw.SetMember(0x66, osccal_reg);
     // 0x65 reserved
-    rw[0x64]= new NotSimulatedRegister("MCU register PRR not simulated");
+    rw.SetMember(0x64, new NotSimulatedRegister("MCU register PRR not simulated"));
     // 0x63 reserved
     // 0x62 reserved
-    rw[0x61]= clkpr_reg;
-    rw[0x60]= new NotSimulatedRegister("MCU register WDTCSR not simulated");
-    rw[0x5f]= statusRegister;
-    rw[0x5e]= & ((HWStackSram *)stack)->sph_reg;
-    rw[0x5d]= & ((HWStackSram *)stack)->spl_reg;
+    rw.SetMember(0x61, clkpr_reg);
+    rw.SetMember(0x60, new NotSimulatedRegister("MCU register WDTCSR not simulated"));
+    rw.SetMember(0x5f, statusRegister);
+    rw.SetMember(0x5e, & ((HWStackSram *)stack)->sph_reg);
+    rw.SetMember(0x5d, & ((HWStackSram *)stack)->spl_reg);
     // 0x58 - 0x5C reserved
-    rw[0x57]= & spmRegister->spmcr_reg;
+    rw.SetMember(0x57, & spmRegister->spmcr_reg);
     // 0x56 reserved
-    rw[0x55]= new NotSimulatedRegister("MCU register MCUCR not simulated");
-    rw[0x54]= new NotSimulatedRegister("MCU register MCUSR not simulated");
-    rw[0x53]= new NotSimulatedRegister("MCU register SMCR not simulated");
+    rw.SetMember(0x55, new NotSimulatedRegister("MCU register MCUCR not simulated"));
+    rw.SetMember(0x54, new NotSimulatedRegister("MCU register MCUSR not simulated"));
+    rw.SetMember(0x53, & smcr_reg);
     // 0x52 reserved
     // 0x51 reserved
-    rw[0x50]= & acomp->acsr_reg;
+    rw.SetMember(0x50, & acomp->acsr_reg);
     // 0x4F reserved
-    rw[0x4E]= & spi->spdr_reg;
-    rw[0x4D]= & spi->spsr_reg;
-    rw[0x4C]= & spi->spcr_reg;
-    rw[0x4B]= gpior2_reg;
-    rw[0x4A]= gpior1_reg;
+    rw.SetMember(0x4E, & spi->spdr_reg);
+    rw.SetMember(0x4D, & spi->spsr_reg);
+    rw.SetMember(0x4C, & spi->spcr_reg);
+    rw.SetMember(0x4B, gpior2_reg);
+    rw.SetMember(0x4A, gpior1_reg);
     // 0x49 reserved
-    rw[0x48]= & timer0->ocrb_reg;
-    rw[0x47]= & timer0->ocra_reg;
-    rw[0x46]= & timer0->tcnt_reg;
-    rw[0x45]= & timer0->tccrb_reg;
-    rw[0x44]= & timer0->tccra_reg;
-    rw[0x43]= & gtccr_reg;
-    rw[0x42]= & eeprom->eearh_reg;
-    rw[0x41]= & eeprom->eearl_reg;
-    rw[0x40]= & eeprom->eedr_reg;
-    rw[0x3F]= & eeprom->eecr_reg;
-    rw[0x3E]= gpior0_reg;
-    rw[0x3D]= eimsk_reg;
-    rw[0x3C]= eifr_reg;
-    rw[0x3b]= pcifr_reg;
+    rw.SetMember(0x48, & timer0->ocrb_reg);
+    rw.SetMember(0x47, & timer0->ocra_reg);
+    rw.SetMember(0x46, & timer0->tcnt_reg);
+    rw.SetMember(0x45, & timer0->tccrb_reg);
+    rw.SetMember(0x44, & timer0->tccra_reg);
+    rw.SetMember(0x43, & gtccr_reg);
+    rw.SetMember(0x42, & eeprom->eearh_reg);
+    rw.SetMember(0x41, & eeprom->eearl_reg);
+    rw.SetMember(0x40, & eeprom->eedr_reg);
+    rw.SetMember(0x3F, & eeprom->eecr_reg);
+    rw.SetMember(0x3E, gpior0_reg);
+    rw.SetMember(0x3D, eimsk_reg);
+    rw.SetMember(0x3C, eifr_reg);
+    rw.SetMember(0x3b, pcifr_reg);
     // 0x38, 0x39, 0x3A reserved
-    rw[0x37]= & timerIrq2->tifr_reg;
-    rw[0x36]= & timerIrq1->tifr_reg;
-    rw[0x35]= & timerIrq0->tifr_reg;
+    rw.SetMember(0x37, & timerIrq2->tifr_reg);
+    rw.SetMember(0x36, & timerIrq1->tifr_reg);
+    rw.SetMember(0x35, & timerIrq0->tifr_reg);
     // 0x2C - 0x34 reserved
-    rw[0x2B]= & portd.port_reg;
-    rw[0x2A]= & portd.ddr_reg;
-    rw[0x29]= & portd.pin_reg;
+    rw.SetMember(0x2B, & portd.port_reg);
+    rw.SetMember(0x2A, & portd.ddr_reg);
+    rw.SetMember(0x29, & portd.pin_reg);
     
-    rw[0x28]= & portc.port_reg;
-    rw[0x27]= & portc.ddr_reg;
-    rw[0x26]= & portc.pin_reg;
+    rw.SetMember(0x28, & portc.port_reg);
+    rw.SetMember(0x27, & portc.ddr_reg);
+    rw.SetMember(0x26, & portc.pin_reg);
     
-    rw[0x25]= & portb.port_reg;
-    rw[0x24]= & portb.ddr_reg;
-    rw[0x23]= & portb.pin_reg;
+    rw.SetMember(0x25, & portb.port_reg);
+    rw.SetMember(0x24, & portb.ddr_reg);
+    rw.SetMember(0x23, & portb.pin_reg);
 
     Reset();
 }
@@ -49,6 +49,7 @@ class AvrDevice_atmega668base: public AvrDevice {
         HWPort              portd;       //!< port D
         IOSpecialReg        gtccr_reg;   //!< GTCCR IO register
         IOSpecialReg        assr_reg;    //!< ASSR IO register
+        IOSpecialReg        smcr_reg;    //!< SMCR IO register
         HWPrescaler         prescaler01; //!< prescaler unit for timer 0 and 1
         HWPrescalerAsync    prescaler2;  //!< prescaler unit for timer 2
         ExternalIRQHandler* extirq01;    //!< external interrupt support for INT0, INT1
@@ -96,6 +96,7 @@ AvrDevice_attiny2313::AvrDevice_attiny2313():
     gimsk_reg = new IOSpecialReg(&coreTraceGroup, "GIMSK");
     eifr_reg = new IOSpecialReg(&coreTraceGroup, "EIFR");
     mcucr_reg = new IOSpecialReg(&coreTraceGroup, "MCUCR");
+    SetSleepControl(mcucr_reg, 0x20); // SE bit
     pcmsk_reg = new IOSpecialReg(&coreTraceGroup, "PCMSK");
     extirq = new ExternalIRQHandler(this, irqSystem, gimsk_reg, eifr_reg);
     extirq->registerIrq(1, 6, new ExternalIRQSingle(mcucr_reg, 0, 2, GetPin("D2")));
@@ -143,68 +144,68 @@ AvrDevice_attiny2313::AvrDevice_attiny2313():
     // USI
     usi = new HWUSI(this, irqSystem, PinAtPort(portb, 0), PinAtPort(portb, 1), PinAtPort(portb, 2), 15, 16);
 
-    rw[0x5f]= statusRegister;
-    rw[0x5e]= & ((HWStackSram *)stack)->sph_reg;
-    rw[0x5d]= & ((HWStackSram *)stack)->spl_reg;
-    rw[0x5c]= & timer0->ocrb_reg;
-    rw[0x5b]= gimsk_reg;
-    rw[0x5a]= eifr_reg;
-    rw[0x59]= & timer01irq->timsk_reg;
-    rw[0x58]= & timer01irq->tifr_reg;
-    rw[0x57]= & spmRegister->spmcr_reg;
-    rw[0x56]= & timer0->ocra_reg;
-    rw[0x55]= mcucr_reg;
+    rw.SetMember(0x5f, statusRegister);
+    rw.SetMember(0x5e, & ((HWStackSram *)stack)->sph_reg);
+    rw.SetMember(0x5d, & ((HWStackSram *)stack)->spl_reg);
+    rw.SetMember(0x5c, & timer0->ocrb_reg);
+    rw.SetMember(0x5b, gimsk_reg);
+    rw.SetMember(0x5a, eifr_reg);
+    rw.SetMember(0x59, & timer01irq->timsk_reg);
+    rw.SetMember(0x58, & timer01irq->tifr_reg);
+    rw.SetMember(0x57, & spmRegister->spmcr_reg);
+    rw.SetMember(0x56, & timer0->ocra_reg);
+    rw.SetMember(0x55, mcucr_reg);
     //rw[0x54] MCUSR
-    rw[0x53]= & timer0->tccrb_reg;
-    rw[0x52]= & timer0->tcnt_reg;
-    rw[0x51]= osccal_reg;
-    rw[0x50]= & timer0->tccra_reg;
-    rw[0x4f]= & timer1->tccra_reg; 
-    rw[0x4e]= & timer1->tccrb_reg;
-    rw[0x4d]= & timer1->tcnt_h_reg;
-    rw[0x4c]= & timer1->tcnt_l_reg;
-    rw[0x4b]= & timer1->ocra_h_reg;
-    rw[0x4a]= & timer1->ocra_l_reg;
-    rw[0x49]= & timer1->ocrb_h_reg;
-    rw[0x48]= & timer1->ocrb_l_reg;
+    rw.SetMember(0x53, & timer0->tccrb_reg);
+    rw.SetMember(0x52, & timer0->tcnt_reg);
+    rw.SetMember(0x51, osccal_reg);
+    rw.SetMember(0x50, & timer0->tccra_reg);
+    rw.SetMember(0x4f, & timer1->tccra_reg); 
+    rw.SetMember(0x4e, & timer1->tccrb_reg);
+    rw.SetMember(0x4d, & timer1->tcnt_h_reg);
+    rw.SetMember(0x4c, & timer1->tcnt_l_reg);
+    rw.SetMember(0x4b, & timer1->ocra_h_reg);
+    rw.SetMember(0x4a, & timer1->ocra_l_reg);
+    rw.SetMember(0x49, & timer1->ocrb_h_reg);
+    rw.SetMember(0x48, & timer1->ocrb_l_reg);
     //rw[0x47] reserved
-    rw[0x46]= clkpr_reg;
-    rw[0x45]= & timer1->icr_h_reg;
-    rw[0x44]= & timer1->icr_l_reg;
-    rw[0x43]= gtccr_reg;
-    rw[0x42]= & timer1->tccrc_reg;
+    rw.SetMember(0x46, clkpr_reg);
+    rw.SetMember(0x45, & timer1->icr_h_reg);
+    rw.SetMember(0x44, & timer1->icr_l_reg);
+    rw.SetMember(0x43, gtccr_reg);
+    rw.SetMember(0x42, & timer1->tccrc_reg);
     //rw[0x41]= & wado->wdtcr_reg;
-    rw[0x40]= pcmsk_reg;
-    rw[0x3f]= & eeprom->eearh_reg; // register normally reserved, but used by avr-libc!
-    rw[0x3e]= & eeprom->eearl_reg;
-    rw[0x3d]= & eeprom->eedr_reg;
-    rw[0x3c]= & eeprom->eecr_reg;
-    rw[0x3b]= & porta->port_reg;
-    rw[0x3a]= & porta->ddr_reg;
-    rw[0x39]= & porta->pin_reg;
-    rw[0x38]= & portb->port_reg;
-    rw[0x37]= & portb->ddr_reg;
-    rw[0x36]= & portb->pin_reg;
-    rw[0x35]= gpior2_reg;
-    rw[0x34]= gpior1_reg;
-    rw[0x33]= gpior0_reg;
-    rw[0x32]= & portd->port_reg;
-    rw[0x31]= & portd->ddr_reg;
-    rw[0x30]= & portd->pin_reg;
-    rw[0x2f]= & usi->usidr_reg;
-    rw[0x2e]= & usi->usisr_reg;
-    rw[0x2d]= & usi->usicr_reg;
-    rw[0x2c]= & usart->udr_reg;
-    rw[0x2b]= & usart->ucsra_reg;
-    rw[0x2a]= & usart->ucsrb_reg;
-    rw[0x29]= & usart->ubrr_reg;
-    rw[0x28]= & acomp->acsr_reg;
+    rw.SetMember(0x40, pcmsk_reg);
+    rw.SetMember(0x3f, & eeprom->eearh_reg); // register normally reserved, but used by avr-libc!
+    rw.SetMember(0x3e, & eeprom->eearl_reg);
+    rw.SetMember(0x3d, & eeprom->eedr_reg);
+    rw.SetMember(0x3c, & eeprom->eecr_reg);
+    rw.SetMember(0x3b, & porta->port_reg);
+    rw.SetMember(0x3a, & porta->ddr_reg);
+    rw.SetMember(0x39, & porta->pin_reg);
+    rw.SetMember(0x38, & portb->port_reg);
+    rw.SetMember(0x37, & portb->ddr_reg);
+    rw.SetMember(0x36, & portb->pin_reg);
+    rw.SetMember(0x35, gpior2_reg);
+    rw.SetMember(0x34, gpior1_reg);
+    rw.SetMember(0x33, gpior0_reg);
+    rw.SetMember(0x32, & portd->port_reg);
+    rw.SetMember(0x31, & portd->ddr_reg);
+    rw.SetMember(0x30, & portd->pin_reg);
+    rw.SetMember(0x2f, & usi->usidr_reg);
+    rw.SetMember(0x2e, & usi->usisr_reg);
+    rw.SetMember(0x2d, & usi->usicr_reg);
+    rw.SetMember(0x2c, & usart->udr_reg);
+    rw.SetMember(0x2b, & usart->ucsra_reg);
+    rw.SetMember(0x2a, & usart->ucsrb_reg);
+    rw.SetMember(0x29, & usart->ubrr_reg);
+    rw.SetMember(0x28, & acomp->acsr_reg);
     //rw[0x27] reserved
     //rw[0x26] reserved
     //rw[0x25] reserved
     //rw[0x24] reserved
-    rw[0x23]= & usart->ucsrc_reg;
-    rw[0x22]= & usart->ubrrh_reg;
+    rw.SetMember(0x23, & usart->ucsrc_reg);
+    rw.SetMember(0x22, & usart->ubrrh_reg);
     //rw[0x21] DIDR
     //rw[0x20] reserved
     
@@ -108,6 +108,7 @@ AvrDevice_attinyX5::AvrDevice_attinyX5(unsigned ram_bytes,
     gimsk_reg = new IOSpecialReg(&coreTraceGroup, "GIMSK");
     gifr_reg = new IOSpecialReg(&coreTraceGroup, "GIFR");
     mcucr_reg = new IOSpecialReg(&coreTraceGroup, "MCUCR");
+    SetSleepControl(mcucr_reg, 0x20); // SE bit
     pcmsk_reg = new IOSpecialReg(&coreTraceGroup, "PCMSK");
     extirq = new ExternalIRQHandler(this, irqSystem, gimsk_reg, gifr_reg);
     extirq->registerIrq(1, 6, new ExternalIRQSingle(mcucr_reg, 0, 2, GetPin("B2")));
@@ -160,70 +161,70 @@ AvrDevice_attinyX5::AvrDevice_attinyX5(unsigned ram_bytes,
     timer0->SetTimerEventListener(usi);
 
     // IO register set
-    rw[0x5f]= statusRegister;
-    rw[0x5e]= & ((HWStackSram *)stack)->sph_reg;
-    rw[0x5d]= & ((HWStackSram *)stack)->spl_reg;
+    rw.SetMember(0x5f, statusRegister);
+    rw.SetMember(0x5e, & ((HWStackSram *)stack)->sph_reg);
+    rw.SetMember(0x5d, & ((HWStackSram *)stack)->spl_reg);
     //rw[0x5c] reserved
-    rw[0x5b]= gimsk_reg;
-    rw[0x5a]= gifr_reg;
-    rw[0x59]= & timer01irq->timsk_reg;
-    rw[0x58]= & timer01irq->tifr_reg;
-    rw[0x57]= & spmRegister->spmcr_reg;
+    rw.SetMember(0x5b, gimsk_reg);
+    rw.SetMember(0x5a, gifr_reg);
+    rw.SetMember(0x59, & timer01irq->timsk_reg);
+    rw.SetMember(0x58, & timer01irq->tifr_reg);
+    rw.SetMember(0x57, & spmRegister->spmcr_reg);
     //rw[0x56] reserved
-    rw[0x55]= mcucr_reg;
+    rw.SetMember(0x55, mcucr_reg);
     //rw[0x54] reserved
-    rw[0x53]= & timer0->tccrb_reg;
-    rw[0x52]= & timer0->tcnt_reg;
-    rw[0x51]= osccal_reg;
-    rw[0x50]= & timer1->tccr_reg;
-
-    rw[0x4f]= & timer1->tcnt_reg;
-    rw[0x4e]= & timer1->tocra_reg;
-    rw[0x4d]= & timer1->tocrc_reg;
-    rw[0x4c]= gtccr_reg;
-    rw[0x4b]= & timer1->tocrb_reg;
-    rw[0x4a]= & timer0->tccra_reg;
-    rw[0x49]= & timer0->ocra_reg;
-    rw[0x48]= & timer0->ocrb_reg;
-    rw[0x47]= pllcsr_reg;
-    rw[0x46]= clkpr_reg;
-    rw[0x45]= & timer1->dt1a_reg;
-    rw[0x44]= & timer1->dt1b_reg;
-    rw[0x43]= & timer1->dtps1_reg;
+    rw.SetMember(0x53, & timer0->tccrb_reg);
+    rw.SetMember(0x52, & timer0->tcnt_reg);
+    rw.SetMember(0x51, osccal_reg);
+    rw.SetMember(0x50, & timer1->tccr_reg);
+
+    rw.SetMember(0x4f, & timer1->tcnt_reg);
+    rw.SetMember(0x4e, & timer1->tocra_reg);
+    rw.SetMember(0x4d, & timer1->tocrc_reg);
+    rw.SetMember(0x4c, gtccr_reg);
+    rw.SetMember(0x4b, & timer1->tocrb_reg);
+    rw.SetMember(0x4a, & timer0->tccra_reg);
+    rw.SetMember(0x49, & timer0->ocra_reg);
+    rw.SetMember(0x48, & timer0->ocrb_reg);
+    rw.SetMember(0x47, pllcsr_reg);
+    rw.SetMember(0x46, clkpr_reg);
+    rw.SetMember(0x45, & timer1->dt1a_reg);
+    rw.SetMember(0x44, & timer1->dt1b_reg);
+    rw.SetMember(0x43, & timer1->dtps1_reg);
     //rw[0x42] reserved
     //rw[0x41] reserved
     //rw[0x40] reserved
 
-    rw[0x3f]= & eeprom->eearh_reg;
-    rw[0x3e]= & eeprom->eearl_reg;
-    rw[0x3d]= & eeprom->eedr_reg;
-    rw[0x3c]= & eeprom->eecr_reg;
+    rw.SetMember(0x3f, & eeprom->eearh_reg);
+    rw.SetMember(0x3e, & eeprom->eearl_reg);
+    rw.SetMember(0x3d, & eeprom->eedr_reg);
+    rw.SetMember(0x3c, & eeprom->eecr_reg);
     //rw[0x3b] reserved
     //rw[0x3a] reserved
     //rw[0x39] reserved
-    rw[0x38]= & portb->port_reg;
-    rw[0x37]= & portb->ddr_reg;
-    rw[0x36]= & portb->pin_reg;
-    rw[0x35]= pcmsk_reg;
+    rw.SetMember(0x38, & portb->port_reg);
+    rw.SetMember(0x37, & portb->ddr_reg);
+    rw.SetMember(0x36, & portb->pin_reg);
+    rw.SetMember(0x35, pcmsk_reg);
     //rw[0x34] reserved
-    rw[0x33]= gpior2_reg;
-    rw[0x32]= gpior1_reg;
-    rw[0x31]= gpior0_reg;
-    rw[0x30]= &usi->usibr_reg;
-
-    rw[0x2f]= &usi->usidr_reg;
-    rw[0x2e]= &usi->usisr_reg;
-    rw[0x2d]= &usi->usicr_reg;
+    rw.SetMember(0x33, gpior2_reg);
+    rw.SetMember(0x32, gpior1_reg);
+    rw.SetMember(0x31, gpior0_reg);
+    rw.SetMember(0x30, &usi->usibr_reg);
+
+    rw.SetMember(0x2f, &usi->usidr_reg);
+    rw.SetMember(0x2e, &usi->usisr_reg);
+    rw.SetMember(0x2d, &usi->usicr_reg);
     //rw[0x2c] reserved
     //rw[0x2b] reserved
     //rw[0x2a] reserved
     //rw[0x29] reserved
-    rw[0x28]= &acomp->acsr_reg;
-    rw[0x27]= &ad->admux_reg;
-    rw[0x26]= &ad->adcsra_reg;
-    rw[0x25]= &ad->adch_reg;
-    rw[0x24]= &ad->adcl_reg;
-    rw[0x23]= &ad->adcsrb_reg;
+    rw.SetMember(0x28, &acomp->acsr_reg);
+    rw.SetMember(0x27, &ad->admux_reg);
+    rw.SetMember(0x26, &ad->adcsra_reg);
+    rw.SetMember(0x25, &ad->adch_reg);
+    rw.SetMember(0x24, &ad->adcl_reg);
+    rw.SetMember(0x23, &ad->adcsrb_reg);
     //rw[0x22] reserved
     //rw[0x21] reserved
     //rw[0x20] reserved
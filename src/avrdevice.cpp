@@ -30,9 +30,11 @@
 #include "helper.h"
 #include "irqsystem.h"  //GetNewPc
 #include "systemclock.h"
+#include "simulationcontext.h"
 #include "avrerror.h"
 #include "avrmalloc.h"
 #include "avrreadelf.h"
+#include "snapshot.h"
 #include <assert.h>
 
 #include "avrdevice_impl.h"
@@ -50,6 +52,7 @@ void AvrDevice::AddToResetList(Hardware *hw) {
 void AvrDevice::AddToCycleList(Hardware *hw) {
     if(find(hwCycleList.begin(), hwCycleList.end(), hw) == hwCycleList.end())
         hwCycleList.push_back(hw);
+    WakeUpHardware(hw);
 }
         
 void AvrDevice::RemoveFromCycleList(Hardware *hw) {
@@ -59,6 +62,72 @@ void AvrDevice::RemoveFromCycleList(Hardware *hw) {
         hwCycleList.erase(element);
 }
 
+void AvrDevice::SleepHardware(Hardware *hw, unsigned long long cycles) {
+    hw->wakeupCycle = cycleCounter + cycles;
+}
+
+void AvrDevice::SuspendHardware(Hardware *hw) {
+    hw->wakeupCycle = ~0ULL;
+}
+
+void AvrDevice::WakeUpHardware(Hardware *hw) {
+    hw->wakeupCycle = 0;
+    nextHwCycle = 0;
+}
+
+void AvrDevice::WakeUpAllHardware(void) {
+    for(unsigned i = 0; i < hwCycleList.size(); i++)
+        hwCycleList[i]->wakeupCycle = 0;
+    nextHwCycle = 0;
+}
+
+SystemClockOffset AvrDevice::SkipSleepCycles(void) {
+    if(nextHwCycle <= cycleCounter + 1)
+        return 0;
+    // nothing happens in core and hardware till next hardware wakeup
+    unsigned long long skip = nextHwCycle - cycleCounter - 1;
+    // but other simulation members could change pins and raise a interrupt,
+    // so the next step must not be behind the first own step after this event
+    SystemClock &clk = context->GetSystemClock();
+    SystemClockOffset limit = clk.GetSkipLimit();
+    // without a limit the caller steps the clock itself (a script for example)
+    // and expects, that time advances only by one cycle per step
+    if(limit < 0)
+        return 0;
+    SystemClockOffset diff = limit - clk.GetCurrentTime();
+    if(diff <= clockFreq)
+        return 0;
+    unsigned long long maxSkip = (diff - 1) / clockFreq;
+    if(maxSkip > (1ULL << 32))
+        maxSkip = 1ULL << 32; // keep time calculation away from overflow
+    if(skip > maxSkip)
+        skip = maxSkip;
+    cycleCounter += skip;
+    return skip * clockFreq;
+}
+
+void AvrDevice::Sleep(void) {
+    // without set SE bit, SLEEP is a NOP
+    if(sleepControlRegister != NULL && (sleepControlRegister->GetRegValue() & sleepEnableMask) != 0)
+        sleeping = true;
+}
+
+bool AvrDevice::CycleHardwareList(void) {
+    bool hwWait = false;
+    unsigned long long next = ~0ULL;
+    nextHwCycle = ~0ULL; // WakeUpHardware could be called while processing the list
+    for(unsigned i = 0; i < hwCycleList.size(); i++) {
+        Hardware *p = hwCycleList[i];
+        if(p->wakeupCycle <= cycleCounter && p->CpuCycle() > 0)
+            hwWait = true;
+        if(p->wakeupCycle < next)
+            next = p->wakeupCycle;
+    }
+    if(next < nextHwCycle)
+        nextHwCycle = next;
+    return hwWait;
+}
+
 void AvrDevice::Load(const char* fname) {
     actualFilename = fname;
     ELFLoad(this);
@@ -72,6 +141,29 @@ SystemClockOffset AvrDevice::GetClockFreq() {
     return clockFreq;
 }
 
+void CodeAddressList::Add(dword addr) {
+    addresses.push_back(addr);
+    unsigned int idx = (unsigned int)addr >> 5;
+    if(idx >= bitmap.size())
+        bitmap.resize(idx + 1, 0);
+    bitmap[idx] |= 1U << (addr & 0x1f);
+}
+
+void CodeAddressList::Remove(dword addr) {
+    std::vector<dword>::iterator ii = find(addresses.begin(), addresses.end(), addr);
+    if(ii == addresses.end())
+        return;
+    addresses.erase(ii);
+    // address could be in list more than one time
+    if(find(addresses.begin(), addresses.end(), addr) == addresses.end())
+        bitmap[(unsigned int)addr >> 5] &= ~(1U << (addr & 0x1f));
+}
+
+void CodeAddressList::Clear(void) {
+    addresses.clear();
+    bitmap.clear();
+}
+
 Pin *AvrDevice::GetPin(const char *name) {
     Pin *ret = allPins[name];
     if(!ret)
@@ -91,21 +183,14 @@ AvrDevice::~AvrDevice() {
         delete invalidRW[idx];
     delete [] invalidRW;
     
-    // delete Ram cells and registers
-    for(unsigned idx = 0; idx < registerSpaceSize; idx++)
-        delete rw[idx];
-    size = registerSpaceSize + ioSpaceSize + iRamSize + eRamSize;
-    for(unsigned idx = (registerSpaceSize + ioSpaceSize); idx < size; idx++)
-        delete rw[idx];
-    
-    // delete rw and other allocated objects
+    // delete allocated objects, RAM cells and registers are deleted by rw
     delete Flash;
     delete statusRegister;
     delete status;
-    delete [] rw;
     delete data;
     delete fuses;
     delete lockbits;
+    delete instrTrace;
 }
 
 /*! To ease debugging, also supply the option to have the PC*2 in the trace
@@ -120,6 +205,8 @@ public:
         change(ref->value()*2);
         set_written();
     }
+    
+    virtual bool polled() const { return true; }
 private:
     TraceValue *ref; // Reference value that will be doubled
 };
@@ -135,9 +222,12 @@ AvrDevice::AvrDevice(unsigned int _ioSpaceSize,
     iRamSize(IRamSize),
     eRamSize(ERamSize),
     devSignature(numeric_limits<unsigned int>::max()),
+    PC_size(pcSize),
     abortOnInvalidAccess(false),
     coreTraceGroup(this),
     deferIrq(false),
+    fastCoreMode(false),
+    singleStep(false),
     newIrqPc(0xffffffff),
     v_supply(5.0),  // assume 5V supply voltage
     v_bandgap(1.1), // assume a bandgap ref unit with 1.1V
@@ -152,10 +242,22 @@ AvrDevice::AvrDevice(unsigned int _ioSpaceSize,
     flagTiny10(false),
     flagTiny1x(false),
     flagXMega(false),
-    PC_size(pcSize)
+    watchHit(false),
+    watchHitKind(0),
+    watchHitAddr(0),
+    rw(&coreTraceGroup, totalIoSpace),
+    flightRecorder(this)
 {
-    dumpManager = DumpManager::Instance();
+    cycleCounter = 0;
+    nextHwCycle = 0;
+    sleeping = false;
+    sleepControlRegister = NULL;
+    sleepEnableMask = 0;
+    context = &SimulationContext::Current();
+    console = &context->GetConsoleHandler();
+    dumpManager = context->GetDumpManager();
     dumpManager->registerAvrDevice(this);
+    instrTrace = NULL;
     DebugRecentJumpsIndex = 0;
     
     TraceValue* pc_tracer=trace_direct(&coreTraceGroup, "PC", &cPC);
@@ -170,9 +272,8 @@ AvrDevice::AvrDevice(unsigned int _ioSpaceSize,
     rampz = NULL;
     eind = NULL;
     
-    // memory space for all RW-Memory addresses + shadow store for invalid cells
+    // shadow store for invalid cells
     unsigned invalidSize = totalIoSpace - registerSpaceSize - IRamSize - ERamSize; 
-    rw = new RWMemoryMember* [totalIoSpace];
     invalidRW = new RWMemoryMember* [invalidSize];
     
     // the status register is generic to all devices
@@ -191,16 +292,15 @@ AvrDevice::AvrDevice(unsigned int _ioSpaceSize,
     if(Flash == NULL)
         avr_error("Not enough memory for Flash in AvrDevice::AvrDevice");
 
-    // create all registers
-    unsigned currentOffset = 0;
-    unsigned invalidRWOffset = 0;
+    // registers, internal and external ram are plain memory in rw, RAM cells
+    // are created there on demand
+    rw.AddPlainRegion(0, registerSpaceSize, "r");
+    rw.AddPlainRegion(registerSpaceSize + ioSpaceSize, IRamSize, "IRAM");
+    // TODO: make the configuration of external ram from mcucr available here
+    rw.AddPlainRegion(registerSpaceSize + ioSpaceSize + IRamSize, ERamSize, "ERAM");
 
-    for(unsigned ii = 0; ii < registerSpaceSize; ii++) {
-        rw[currentOffset] = new RAM(&coreTraceGroup, "r", ii, registerSpaceSize);
-        if(rw[currentOffset] == NULL)
-            avr_error("Not enough memory for registers in AvrDevice::AvrDevice");
-        currentOffset++;
-    }      
+    unsigned currentOffset = registerSpaceSize;
+    unsigned invalidRWOffset = 0;
 
     /* Create invalid registers in I/O space which will fail on access (to
        make simulavr more robust!)  In all well implemented devices, these
@@ -211,27 +311,11 @@ AvrDevice::AvrDevice(unsigned int _ioSpaceSize,
         invalidRW[invalidRWOffset] = new InvalidMem(this, currentOffset);
         if(invalidRW[invalidRWOffset] == NULL)
             avr_error("Not enough memory for io space in AvrDevice::AvrDevice");
-        rw[currentOffset] = invalidRW[invalidRWOffset];
+        rw.SetMember(currentOffset, invalidRW[invalidRWOffset]);
         currentOffset++;
         invalidRWOffset++;
     }
-
-    // create the internal ram handlers 
-    for(unsigned ii = 0; ii < IRamSize; ii++ ) {
-        rw[currentOffset] = new RAM(&coreTraceGroup, "IRAM", ii, IRamSize);
-        if(rw[currentOffset] == NULL)
-            avr_error("Not enough memory for IRAM in AvrDevice::AvrDevice");
-        currentOffset++;
-    }
-
-    // create the external ram handlers, TODO: make the configuration from
-    // mcucr available here
-    for(unsigned ii = 0; ii < ERamSize; ii++ ) {
-        rw[currentOffset] = new RAM(&coreTraceGroup, "ERAM", ii, ERamSize);
-        if(rw[currentOffset] == NULL)
-            avr_error("Not enough memory for io space in AvrDevice::AvrDevice");
-        currentOffset++;
-    }
+    currentOffset += IRamSize + ERamSize;
 
     assert(currentOffset<=totalIoSpace);
     // fill the rest of the address space with error handlers
@@ -239,41 +323,72 @@ AvrDevice::AvrDevice(unsigned int _ioSpaceSize,
         invalidRW[invalidRWOffset] = new InvalidMem(this, currentOffset);
         if(invalidRW[invalidRWOffset] == NULL)
             avr_error("Not enough memory for fill address space in AvrDevice::AvrDevice");
-        rw[currentOffset] = invalidRW[invalidRWOffset];
+        rw.SetMember(currentOffset, invalidRW[invalidRWOffset]);
     }
 }
 
 // do a single core step, (0)->a real hardware step, (1) until the uC finish the opcode!
 int AvrDevice::Step(bool &untilCoreStepFinished, SystemClockOffset *nextStepIn_ns) {
-    if (cpuCycles<=0)
+    if (cpuCycles<=0) {
         cPC=PC;
+        watchHit = false;
+    }
 
     if(trace_on == 1) {
-        traceOut << actualFilename << " ";
-        traceOut << HexShort(cPC << 1) << dec << ": ";
+        TraceOut() << actualFilename << " ";
+        TraceOut() << HexShort(cPC << 1) << dec << ": ";
 
         string sym(Flash->GetSymbolAtAddress(cPC));
-        traceOut << sym << " ";
+        TraceOut() << sym << " ";
         for (int len = sym.length(); len < 30;len++)
-            traceOut << " " ;
+            TraceOut() << " " ;
     }
 
-    bool hwWait = false;
-    for(unsigned i = 0; i < hwCycleList.size(); i++) {
-        Hardware * p = hwCycleList[i];
-        if (p->CpuCycle() > 0)
-            hwWait = true;
-    }
+    bool hwWait = CycleHardware();
 
+    SystemClockOffset sleepTime = 0;
+    bool instrTraced = false; // a event is recorded in instrTrace
     if(hwWait) {
         if(trace_on)
-            traceOut << "CPU-Hold by IO-Hardware ";
+            TraceOut() << "CPU-Hold by IO-Hardware ";
+        if(instrTrace) {
+            instrTrace->Event(InstructionTrace::HOLD, cycleCounter, cPC, 0);
+            instrTraced = true;
+        }
+    } else if(sleeping && (cpuCycles <= 0)) {
+        if(irqSystem->IsIrqPending()) {
+            /* Wake up by interrupt: core is halted for 4 cycles (start-up time
+             * isn't simulated), then a enabled interrupt is entered without
+             * executing a instruction before. */
+            if(trace_on)
+                TraceOut() << "CPU-wakeup";
+            if(instrTrace) {
+                instrTrace->Event(InstructionTrace::WAKEUP, cycleCounter, cPC, 0);
+                instrTraced = true;
+            }
+            sleeping = false;
+            if(status->I == 1)
+                deferIrq = true;
+            cpuCycles = 3;
+        } else {
+            /* Sleep mode: core does nothing till a interrupt occurs. If all hardware
+             * in cycle list is sleeping too, jump directly to the next cycle,
+             * where hardware could raise a interrupt. */
+            if(instrTrace) {
+                instrTrace->Event(InstructionTrace::SLEEP, cycleCounter, cPC, 0);
+                instrTraced = true;
+            }
+            if(trace_on)
+                TraceOut() << "CPU-sleep";
+            else if(nextStepIn_ns != NULL)
+                sleepTime = SkipSleepCycles();
+        }
     } else if(cpuCycles <= 0) {
 
             //check for enabled breakpoints here
-            if(BP.end() != find(BP.begin(), BP.end(), PC)) {
+            if(BP.Contains(PC)) {
                 if(trace_on)
-                    traceOut << "Breakpoint found at 0x" << hex << PC << dec << endl;
+                    TraceOut() << "Breakpoint found at 0x" << hex << PC << dec << endl;
                 if(nextStepIn_ns != 0)
                     *nextStepIn_ns=clockFreq;
                 untilCoreStepFinished = !(cpuCycles > 0);
@@ -281,9 +396,9 @@ int AvrDevice::Step(bool &untilCoreStepFinished, SystemClockOffset *nextStepIn_n
                 return BREAK_POINT;
             }
 
-            if(EP.end() != find(EP.begin(), EP.end(), PC)) {
+            if(EP.Contains(PC)) {
                 avr_message("Simulation finished!");
-                SystemClock::Instance().Stop();
+                context->GetSystemClock().Stop();
                 dumpManager->cycle();
                 return 0;
             }
@@ -314,11 +429,15 @@ int AvrDevice::Step(bool &untilCoreStepFinished, SystemClockOffset *nextStepIn_n
                     if ( newIrqPc != 0xffffffff )
                     {
                         if(trace_on)
-                            traceOut << "IRQ DETECTED: VectorAddr: " << newIrqPc ;
+                            TraceOut() << "IRQ DETECTED: VectorAddr: " << newIrqPc ;
+                        if(instrTrace) {
+                            instrTrace->Event(InstructionTrace::IRQ, cycleCounter, cPC, newIrqPc);
+                            instrTraced = true;
+                        }
+                        flightRecorder.Irq(cycleCounter, cPC, newIrqPc, stack->GetStackPointer(), (int)*status);
 
                         irqSystem->IrqHandlerStarted(actualIrqVector);    //what vector we raise?
-                        Funktor* fkt = new IrqFunktor(irqSystem, &HWIrqSystem::IrqHandlerFinished, actualIrqVector);
-                        stack->SetReturnPoint(stack->GetStackPointer(), fkt);
+                        stack->SetIrqReturnPoint(stack->GetStackPointer(), actualIrqVector);
                         stack->PushAddr(PC);
                         cpuCycles = 4; //push needs 4 cycles! (on external RAM +2, this is handled from HWExtRam!)
                         status->I = 0; //irq started so remove I-Flag from SREG
@@ -341,15 +460,20 @@ int AvrDevice::Step(bool &untilCoreStepFinished, SystemClockOffset *nextStepIn_n
                     os << actualFilename << " Simulation runs out of Flash Space at " << hex << (PC << 1);
                     string s = os.str();
                     if(trace_on)
-                        traceOut << s << endl;
+                        TraceOut() << s << endl;
                     avr_error("%s", s.c_str());
                 }
 
-                DecodedInstruction *de = (Flash->GetInstruction(PC));
+                flightRecorder.Instruction(cycleCounter, PC, Flash->ReadMemRawWord(PC << 1), stack->GetStackPointer(), (int)*status);
+                if(instrTrace) {
+                    instrTrace->Event(InstructionTrace::INSTRUCTION, cycleCounter, PC, Flash->ReadMemRawWord(PC << 1));
+                    instrTraced = true;
+                }
                 if(trace_on) {
-                    cpuCycles = de->Trace();
+                    cpuCycles = Flash->GetInstruction(PC)->Trace(this);
                 } else {
-                    cpuCycles = (*de)(); 
+                    const DecodedRecord &rec = Flash->GetDecodedRecord(PC);
+                    cpuCycles = rec.handler(this, rec);
                 }
                 // report changes on status
                 statusRegister->trigger_change();
@@ -359,38 +483,286 @@ int AvrDevice::Step(bool &untilCoreStepFinished, SystemClockOffset *nextStepIn_n
             cpuCycles--;
     } else { //cpuCycles>0
         if(trace_on == 1)
-            traceOut << "CPU-waitstate";
+            TraceOut() << "CPU-waitstate";
         cpuCycles--;
     }
+    if(instrTraced)
+        instrTrace->Finish(this, cpuCycles);
+
+    SystemClockOffset catchUpTime = 0;
+    if(fastCoreMode && !trace_on && ((cpuCycles > 0) || IsFastCoreStepPossible())) {
+        /* Fast core mode: process the wait cycles of a multi cycle instruction
+         * and the register operations following in the same block (see
+         * AvrFlash::GetDecodedBlock) right now instead of returning to the
+         * scheduler for each cycle. Peripherals are caught up cycle by cycle
+         * with the right system time, so timers, irq flags and dumps see the
+         * same clock as in normal mode. A block is left on a pending interrupt,
+         * break- or exitpoint, so they are handled on the same cycle as before,
+         * and before the next step of a other simulation member or the end of
+         * a Run call (see SystemClock::GetSkipLimit), so that nothing runs
+         * ahead of events from outside. */
+        SystemClock &clk = context->GetSystemClock();
+        SystemClockOffset stepTime = clk.GetCurrentTime();
+        SystemClockOffset limit = clk.GetSkipLimit();
+        if(limit < 0 || stepTime + clockFreq < limit) {
+            dumpManager->cycle(); // dump for the first cycle, before time is advanced
+            do {
+                catchUpTime += clockFreq;
+                clk.SetCurrentTime(stepTime + catchUpTime);
+                hwWait = CycleHardware();
+                if(!hwWait) {
+                    if(cpuCycles <= 0) {
+                        // next register operation in block, like in a normal step
+                        // a irq, which becomes pending now, is entered after it
+                        if(status->I && irqSystem->IsIrqPending())
+                            deferIrq = true;
+                        cPC = PC;
+                        const DecodedRecord &rec = Flash->GetDecodedRecord(PC);
+                        flightRecorder.Instruction(cycleCounter, PC, Flash->ReadMemRawWord(PC << 1), stack->GetStackPointer(), (int)*status);
+                        if(instrTrace) {
+                            instrTrace->Event(InstructionTrace::INSTRUCTION, cycleCounter, PC, Flash->ReadMemRawWord(PC << 1));
+                            cpuCycles = rec.handler(this, rec);
+                            instrTrace->Finish(this, cpuCycles - 1);
+                        } else if(!statusRegister->IsTraced() && BP.IsEmpty() && !deferIrq && !EP.Contains(PC + 1) &&
+                                  (limit < 0 || stepTime + catchUpTime + 2 * clockFreq < limit))
+                            // flags, which the next instruction overwrites, are skipped only, if the
+                            // next instruction is processed in this block too, so SREG is complete,
+                            // if this step returns
+                            cpuCycles = Flash->GetDecodedBlock(PC).handler(this, rec);
+                        else
+                            cpuCycles = rec.handler(this, rec);
+                        statusRegister->trigger_change();
+                        PC++;
+                    }
+                    cpuCycles--;
+                } else if(instrTrace) {
+                    instrTrace->Event(InstructionTrace::HOLD, cycleCounter, cPC, 0);
+                    instrTrace->Finish(this, cpuCycles);
+                }
+                dumpManager->cycle();
+            } while(((cpuCycles > 0) || IsFastCoreStepPossible()) &&
+                    (limit < 0 || stepTime + catchUpTime + clockFreq < limit));
+            clk.SetCurrentTime(stepTime);
+        }
+    }
 
     if(nextStepIn_ns != NULL)
-        *nextStepIn_ns = clockFreq;
+        *nextStepIn_ns = clockFreq + catchUpTime + sleepTime;
 
     if(trace_on == 1) {
-        traceOut << endl;
-        sysConHandler.TraceNextLine();
+        TraceOut() << endl;
+        console->TraceNextLine();
     }
 
     untilCoreStepFinished = !((cpuCycles > 0) || hwWait);
-    dumpManager->cycle();
+    if(catchUpTime == 0)
+        dumpManager->cycle();
+    // a watchpoint stops after the instruction, which has hit it
+    if(watchHit && untilCoreStepFinished)
+        return WATCH_POINT;
     return (cpuCycles < 0) ? cpuCycles : 0;
 }
 
+void AvrDevice::SetInstructionTrace(InstructionTrace *t) {
+    delete instrTrace;
+    instrTrace = t;
+    if(t != NULL)
+        t->Start(this);
+}
+
+bool AvrDevice::IsFastCoreStepPossible(void) {
+    // gdb single step stops after one instruction
+    if(singleStep)
+        return false;
+    // a sleeping core waits for interrupts in normal steps
+    if(sleeping)
+        return false;
+    // a interrupt has to be entered by a normal step
+    if(deferIrq)
+        return false;
+    // only register operations could be processed in a block
+    if((PC << 1) >= (unsigned int)Flash->GetSize() || Flash->IsRWWLock(PC << 1))
+        return false;
+    if(Flash->GetDecodedBlock(PC).length == 0)
+        return false;
+    if(BP.Contains(PC) || EP.Contains(PC))
+        return false;
+    // a watchpoint hit has to stop after the instruction
+    if(!watchpoints.empty())
+        return false;
+    return true;
+}
+
 void AvrDevice::Reset() {
     cPC = PC = fuses->GetResetAddr();
 
     vector<Hardware *>::iterator ii;
     for(ii= hwResetList.begin(); ii != hwResetList.end(); ii++)
         (*ii)->Reset();
+    WakeUpAllHardware();
 
     *status = 0;
 
     // init the old static vars from Step()
     cpuCycles = 0;
+    sleeping = false;
+}
+
+int AvrDevice::GetHardwareIndex(const Hardware *hw) const {
+    for(size_t i = 0; i < hwResetList.size(); i++)
+        if(hwResetList[i] == hw)
+            return i;
+    return -1;
+}
+
+Hardware *AvrDevice::GetHardware(int index) const {
+    if(index < 0 || index >= (int)hwResetList.size())
+        return NULL;
+    return hwResetList[index];
+}
+
+void AvrDevice::Snapshot(SnapshotArchive &ar) {
+    ar.Tag(devName.c_str());
+    ar.Check(hwResetList.size(), "count of hardware units");
+
+    // core
+    ar.Item(PC);
+    ar.Item(cPC);
+    ar.Item(clockFreq);
+    ar.Item(cpuCycles);
+    ar.Item(cycleCounter);
+    ar.Item(sleeping);
+    ar.Item(deferIrq);
+    ar.Item(newIrqPc);
+    ar.Item(actualIrqVector);
+    ar.Array(DebugRecentJumps, sizeof(DebugRecentJumps) / sizeof(DebugRecentJumps[0]));
+    ar.Item(DebugRecentJumpsIndex);
+    int sreg = *status;
+    ar.Item(sreg);
+    if(ar.IsRestoring())
+        *status = sreg;
+
+    // registers and RAM, IO registers are saved with IOSpecialReg or hardware
+    ar.Block(rw.image, registerSpaceSize);
+    ar.Block(rw.image + registerSpaceSize + ioSpaceSize, iRamSize + eRamSize);
+    Flash->Snapshot(ar);
+    stack->Snapshot(ar);
+
+    // hardware units, IO registers after them, because a unit could set
+    // register values on restore
+    ar.Tag("hardware");
+    for(size_t i = 0; i < hwResetList.size(); i++)
+        hwResetList[i]->Snapshot(ar);
+    for(unsigned int addr = registerSpaceSize; addr < registerSpaceSize + ioSpaceSize; addr++) {
+        IOSpecialReg *reg = dynamic_cast<IOSpecialReg *>(rw[addr]);
+        if(reg != NULL)
+            reg->Snapshot(ar);
+    }
+
+    // hardware, which has to be called on cpu cycles
+    ar.Tag("cycle list");
+    unsigned int count = hwCycleList.size();
+    ar.Item(count);
+    if(ar.IsRestoring())
+        hwCycleList.resize(count);
+    for(unsigned int i = 0; i < count; i++) {
+        int idx = GetHardwareIndex(hwCycleList[i]);
+        ar.Item(idx);
+        Hardware *hw = GetHardware(idx);
+        if(hw == NULL)
+            avr_error("simulation state doesn't fit: hardware unit %d not found", idx);
+        hwCycleList[i] = hw;
+        ar.Item(hw->wakeupCycle);
+    }
+    ar.Item(nextHwCycle);
+
+    irqSystem->Snapshot(ar);
 }
 
 void AvrDevice::DeleteAllBreakpoints() {
-    BP.erase(BP.begin(), BP.end());
+    BP.Clear();
+}
+
+bool AvrDevice::AddWatchpoint(unsigned int addr, unsigned int len, int kind) {
+    if(len == 0 || addr >= GetMemTotalSize() || len > GetMemTotalSize() - addr)
+        return false;
+    if(kind != WATCH_WRITE && kind != WATCH_READ && kind != WATCH_ACCESS)
+        return false;
+    Watchpoint w;
+    w.addr = addr;
+    w.len = len;
+    w.kind = kind;
+    watchpoints.push_back(w);
+    UpdateWatchFlags(addr, len);
+    return true;
+}
+
+bool AvrDevice::RemoveWatchpoint(unsigned int addr, unsigned int len, int kind) {
+    for(std::vector<Watchpoint>::iterator i = watchpoints.begin(); i != watchpoints.end(); i++) {
+        if(i->addr == addr && i->len == len && i->kind == kind) {
+            watchpoints.erase(i);
+            UpdateWatchFlags(addr, len);
+            return true;
+        }
+    }
+    return false;
+}
+
+void AvrDevice::DeleteAllWatchpoints() {
+    while(!watchpoints.empty()) {
+        Watchpoint w = watchpoints.back();
+        watchpoints.pop_back();
+        UpdateWatchFlags(w.addr, w.len);
+    }
+    watchHit = false;
+}
+
+bool AvrDevice::GetWatchHit(int &kind, unsigned int &addr) {
+    if(!watchHit)
+        return false;
+    kind = watchHitKind;
+    addr = watchHitAddr;
+    watchHit = false;
+    return true;
+}
+
+void AvrDevice::UpdateWatchFlags(unsigned int addr, unsigned int len) {
+    for(unsigned int a = addr; a < addr + len; a++) {
+        unsigned char f = rw.flags[a] & ~RWMemoryMap::FLAG_WATCH;
+        for(size_t i = 0; i < watchpoints.size(); i++) {
+            const Watchpoint &w = watchpoints[i];
+            if(a < w.addr || a >= w.addr + w.len)
+                continue;
+            if(w.kind != WATCH_WRITE)
+                f |= RWMemoryMap::FLAG_WATCH_READ;
+            if(w.kind != WATCH_READ)
+                f |= RWMemoryMap::FLAG_WATCH_WRITE;
+        }
+        rw.flags[a] = f;
+    }
+}
+
+void AvrDevice::WatchAccess(unsigned addr, bool write) {
+    // report the first hit of a instruction, a watchpoint of the access kind wins
+    if(watchHit)
+        return;
+    int kind = 0;
+    for(size_t i = 0; i < watchpoints.size(); i++) {
+        const Watchpoint &w = watchpoints[i];
+        if(addr < w.addr || addr >= w.addr + w.len)
+            continue;
+        if(w.kind == (write ? WATCH_WRITE : WATCH_READ)) {
+            kind = w.kind;
+            break;
+        }
+        if(w.kind == WATCH_ACCESS)
+            kind = WATCH_ACCESS;
+    }
+    if(kind != 0) {
+        watchHit = true;
+        watchHitKind = kind;
+        watchHitAddr = addr;
+    }
 }
 
 void AvrDevice::SetDeviceNameAndSignature(const std::string &name, unsigned int signature) {
@@ -401,12 +773,12 @@ void AvrDevice::SetDeviceNameAndSignature(const std::string &name, unsigned int
 void AvrDevice::ReplaceIoRegister(unsigned int offset, RWMemoryMember *newMember) {
     if (offset >= ioSpaceSize + registerSpaceSize)
         avr_error("Could not replace register in non existing IoRegisterSpace");
-    rw[offset] = newMember;
+    rw.SetMember(offset, newMember);
 }
 
 bool AvrDevice::ReplaceMemRegister(unsigned int offset, RWMemoryMember *newMember) {
     if(offset < totalIoSpace) {
-        rw[offset] = newMember;
+        rw.SetMember(offset, newMember);
         return true;
     }
     return false;
@@ -424,7 +796,7 @@ void AvrDevice::RegisterTerminationSymbol(const char *symbol) {
     assert(false);  // TODO: Implement loading symbols from ELF file
 #endif
     unsigned int epa = Flash->GetAddressAtSymbol(symbol);
-    EP.push_back(epa);
+    EP.Add(epa);
 }
 
 void AvrDevice::DebugOnJump()
@@ -439,34 +811,75 @@ void AvrDevice::DebugOnJump()
 unsigned char AvrDevice::GetRWMem(unsigned addr) {
     if(addr >= GetMemTotalSize())
         return 0;
-    return *(rw[addr]);
+    if(rw.IsPlain(addr))
+        return rw.image[addr];
+    return GetFlaggedMem(addr);
+}
+
+unsigned char AvrDevice::GetFlaggedMem(unsigned addr) {
+    unsigned char f = rw.flags[addr];
+    if(f & RWMemoryMap::FLAG_WATCH_READ)
+        WatchAccess(addr, false);
+    if(f & RWMemoryMap::FLAG_DISPATCH)
+        return *(rw[addr]);
+    return rw.image[addr];
+}
+
+void AvrDevice::SetFlaggedMem(unsigned addr, unsigned char val) {
+    unsigned char f = rw.flags[addr];
+    if(f & RWMemoryMap::FLAG_WATCH_WRITE)
+        WatchAccess(addr, true);
+    if(f & RWMemoryMap::FLAG_DISPATCH)
+        *(rw[addr]) = val;
+    else
+        rw.image[addr] = val;
 }
 
 bool AvrDevice::SetRWMem(unsigned addr, unsigned char val) {
     if(addr >= GetMemTotalSize())
         return false;
-    *(rw[addr]) = val;
+    flightRecorder.MemoryWrite(addr, val);
+    if(instrTrace)
+        instrTrace->MemoryWrite(addr, val);
+    if(rw.IsPlain(addr))
+        rw.image[addr] = val;
+    else
+        SetFlaggedMem(addr, val);
     return true;
 }
 
-unsigned char AvrDevice::GetCoreReg(unsigned addr) {
-    assert(addr < registerSpaceSize);
-    return *(rw[addr]);
+unsigned char AvrDevice::GetRWMemDebug(unsigned addr) {
+    if(addr >= GetMemTotalSize())
+        return 0;
+    if(rw.flags[addr] & RWMemoryMap::FLAG_DISPATCH)
+        return *(rw[addr]);
+    return rw.image[addr];
 }
 
-bool AvrDevice::SetCoreReg(unsigned addr, unsigned char val) {
-    assert(addr < registerSpaceSize);
-    *(rw[addr]) = val;
+bool AvrDevice::SetRWMemDebug(unsigned addr, unsigned char val) {
+    if(addr >= GetMemTotalSize())
+        return false;
+    if(rw.flags[addr] & RWMemoryMap::FLAG_DISPATCH)
+        *(rw[addr]) = val;
+    else
+        rw.image[addr] = val;
     return true;
 }
 
 unsigned char AvrDevice::GetIOReg(unsigned addr) {
     assert(addr < ioSpaceSize);  // callers do use 0x00 base, not 0x20
+    if(rw.flags[addr + registerSpaceSize] & RWMemoryMap::FLAG_WATCH_READ)
+        WatchAccess(addr + registerSpaceSize, false);
     return *(rw[addr + registerSpaceSize]);
 }
 
 bool AvrDevice::SetIOReg(unsigned addr, unsigned char val) {
     assert(addr < ioSpaceSize);  // callers do use 0x00 base, not 0x20
+    flightRecorder.MemoryWrite(addr + registerSpaceSize, val);
+    if(instrTrace)
+        instrTrace->MemoryWrite(addr + registerSpaceSize, val);
+    if(rw.flags[addr + registerSpaceSize] & RWMemoryMap::FLAG_WATCH_WRITE)
+        WatchAccess(addr + registerSpaceSize, true);
     *(rw[addr + registerSpaceSize]) = val;
     return true;
 }
@@ -478,23 +891,28 @@ bool AvrDevice::SetIORegBit(unsigned addr, unsigned bitaddr, bool bval) {
       val |= 1 << bitaddr;
     else
       val &= ~(1 << bitaddr);
+    flightRecorder.MemoryWrite(addr + registerSpaceSize, val);
+    if(instrTrace)
+        instrTrace->MemoryWrite(addr + registerSpaceSize, val);
+    if(rw.flags[addr + registerSpaceSize] & RWMemoryMap::FLAG_WATCH_WRITE)
+        WatchAccess(addr + registerSpaceSize, true);
     *(rw[addr + registerSpaceSize]) = val;
     return true;
 }
 
 unsigned AvrDevice::GetRegX(void) {
     // R27:R26
-    return (*(rw[27]) << 8) + *(rw[26]);
+    return (GetCoreReg(27) << 8) + GetCoreReg(26);
 }
 
 unsigned AvrDevice::GetRegY(void) {
     // R29:R28
-    return (*(rw[29]) << 8) + *(rw[28]);
+    return (GetCoreReg(29) << 8) + GetCoreReg(28);
 }
 
 unsigned AvrDevice::GetRegZ(void) {
     // R31:R30
-    return (*(rw[31]) << 8) + *(rw[30]);
+    return (GetCoreReg(31) << 8) + GetCoreReg(30);
 }
 
 // EOF
@@ -32,20 +32,53 @@
 #include "net.h"
 #include "traceval.h"
 #include "flashprog.h"
+#include "rwmem.h"
+#include "instrtrace.h"
 
 #include <string>
 #include <map>
 #include <vector>
 #include <algorithm>
+#include <cassert>
 #include "types.h" // for dword
 
 // transfered from global.h
+#define WATCH_POINT    -3
 #define BREAK_POINT    -2
 #define INVALID_OPCODE -1
 
+class SimulationContext;
+
+//! List of flash word addresses, like breakpoints, with a fast lookup for Step
+/*! Beside the list a bitmap with one bit per flash word is hold, so that the
+  check, if there is a entry for a address, is only a bit test. */
+class CodeAddressList {
+
+    public:
+        //! Add a address to list (a address could be added more than one time)
+        void Add(dword addr);
+        //! Remove a address from list, if found
+        void Remove(dword addr);
+        //! Remove all addresses
+        void Clear(void);
+        //! Returns true, if address is in list
+        bool Contains(dword addr) const {
+            unsigned int idx = (unsigned int)addr >> 5;
+            return (idx < bitmap.size()) && ((bitmap[idx] >> (addr & 0x1f)) & 1);
+        }
+        //! Returns true, if list is empty
+        bool IsEmpty(void) const { return addresses.empty(); }
+        //! Returns count of entries in list
+        unsigned int GetCount(void) const { return addresses.size(); }
+
+    private:
+        std::vector<dword> addresses;
+        std::vector<unsigned int> bitmap; //!< one bit per flash word, set if address is in list
+};
+
 // transfered from breakpoint.h
-class Breakpoints: public std::vector<dword> { };
-class Exitpoints: public std::vector<dword> { };
+class Breakpoints: public CodeAddressList { };
+class Exitpoints: public CodeAddressList { };
 
 // from hwsreg.h, but not included, because of circular include with this header
 class HWSreg;
@@ -61,6 +94,7 @@ class RWMemoryMember;
 class Hardware;
 class DumpManager;
 class AddressExtensionRegister;
+class SnapshotArchive;
 
 //! Basic AVR device, contains the core functionality
 class AvrDevice: public SimulationMember, public TraceValueRegister {
@@ -74,9 +108,26 @@ class AvrDevice: public SimulationMember, public TraceValueRegister {
         const unsigned int eRamSize;
         unsigned int devSignature; //!< hold the device signature for this core
         std::string devName; //!< hold the device name, which this core simulate
+        SimulationContext *context; //!< simulation context, which was current on construction
+        SystemConsoleHandler *console; //!< console handler of context, cached for trace output
 
         friend class DumpManager;
         void detachDumpManager() { dumpManager = NULL; }
+        friend class ParallelSimulation;
+
+        //! Check, if next instruction could be processed inside a fast core step
+        bool IsFastCoreStepPossible(void);
+        //! Count a cpu cycle and call CpuCycle of all hardware in cycle list, which isn't sleeping
+        /*! Returns true, if a hardware holds the cpu. */
+        bool CycleHardware(void) {
+            cycleCounter++;
+            if(cycleCounter < nextHwCycle)
+                return false;
+            return CycleHardwareList();
+        }
+        bool CycleHardwareList(void);
+        //! Fast forward a sleeping core till next hardware wakeup, returns skipped time
+        SystemClockOffset SkipSleepCycles(void);
 
     protected:
         SystemClockOffset clockFreq;  ///< Period of a tick (1/F_OSC) in [ns]
@@ -85,6 +136,11 @@ class AvrDevice: public SimulationMember, public TraceValueRegister {
         
         /// Count of cycles before next instruction is executed (i.e. countdown)
         int cpuCycles;
+        unsigned long long cycleCounter; //!< count of cpu cycles since start of simulation
+        unsigned long long nextHwCycle;  //!< earliest wakeup cycle of hardware in hwCycleList
+        bool sleeping; //!< core is in sleep mode, see Sleep()
+        IOSpecialReg *sleepControlRegister; //!< register with sleep enable bit, NULL if SLEEP isn't supported
+        unsigned char sleepEnableMask; //!< mask for sleep enable bit in sleepControlRegister
 
     public:
         int trace_on;
@@ -106,6 +162,8 @@ class AvrDevice: public SimulationMember, public TraceValueRegister {
         bool abortOnInvalidAccess; //!< Flag, that simulation abort if an invalid access occured, default is false
         TraceValueCoreRegister coreTraceGroup;
         bool deferIrq;  ///< Almost always false.
+        bool fastCoreMode; //!< Flag, that all wait cycles of a instruction and following register operations are processed in one step, default is false
+        bool singleStep; //!< Flag, that a step processes only one instruction with all SREG flags, also in fast core mode (gdb single step)
         unsigned int newIrqPc;
         unsigned int actualIrqVector; 
         Pin v_supply; //!< represents supply voltage level, needed for analog peripherals
@@ -122,10 +180,22 @@ class AvrDevice: public SimulationMember, public TraceValueRegister {
         bool flagTiny10; //!< core is a tiny4/5/9/10, change used clocks on some instructions and disables instructions
         bool flagTiny1x; //!< core is a tiny1x (but not tiny10!), change used clocks on some instructions and disables instructions
         bool flagXMega; //!< core is a XMEGA device, change used clocks on some instructions
+        //! A data watchpoint, see AddWatchpoint
+        struct Watchpoint {
+            unsigned int addr;
+            unsigned int len;
+            int kind;
+        };
+        std::vector<Watchpoint> watchpoints; //!< active data watchpoints
+        bool watchHit; //!< a watchpoint was hit by current instruction
+        int watchHitKind; //!< kind of watchpoint hit, see WatchKind
+        unsigned int watchHitAddr; //!< data address of access, which hit a watchpoint
         int DebugRecentJumps[20];  ///< Addresses of last few 'call' and 'jump' executed. For debugging.
         int DebugRecentJumpsIndex;  ///< Index to address of the most recent jump
 
-        RWMemoryMember **rw;  ///< The whole memory: R0-R31, IO, Internal RAM.
+#ifndef SWIG
+        RWMemoryMap rw;  ///< The whole memory: R0-R31, IO, Internal RAM.
+#endif
 
         HWStack *stack;
         HWSreg *status;           //!< the status register itself
@@ -136,6 +206,8 @@ class AvrDevice: public SimulationMember, public TraceValueRegister {
         std::vector<Hardware *> hwCycleList; 
 
         DumpManager *dumpManager;
+        InstructionTrace *instrTrace; //!< binary instruction trace, NULL if not used
+        FlightRecorder flightRecorder; //!< last instructions for post-mortem analysis
     
         AvrDevice(unsigned int ioSpaceSize, unsigned int IRamSize, unsigned int ERamSize, unsigned int flashSize, unsigned int pcSize = 2);
         virtual ~AvrDevice();
@@ -151,6 +223,33 @@ class AvrDevice: public SimulationMember, public TraceValueRegister {
         //! Removes from the cycle list, if possible.
         /*! Does nothing if the part is not in the cycle list. */
         void RemoveFromCycleList(Hardware *hw);
+
+        //! Skip CpuCycle calls for a part in cycle list
+        /*! CpuCycle will be called next time after given count of cycles, 1
+          means in next cycle. Normally called by the part itself in CpuCycle. */
+        void SleepHardware(Hardware *hw, unsigned long long cycles);
+
+        //! Skip CpuCycle calls for a part in cycle list till WakeUpHardware is called
+        void SuspendHardware(Hardware *hw);
+
+        //! CpuCycle of a sleeping or suspended part will be called again from next cycle on
+        void WakeUpHardware(Hardware *hw);
+
+        //! Wake up all parts in cycle list, see WakeUpHardware
+        void WakeUpAllHardware(void);
+
+        //! Returns the count of cpu cycles since start of simulation
+        unsigned long long GetCycleCounter(void) const { return cycleCounter; }
+
+        //! Set register and bit mask for sleep enable bit (SE), used by SLEEP instruction
+        void SetSleepControl(IOSpecialReg *reg, unsigned char seMask) {
+            sleepControlRegister = reg;
+            sleepEnableMask = seMask;
+        }
+        //! Process SLEEP instruction, core sleeps till next interrupt, if SE bit is set
+        void Sleep(void);
+        //! Returns true, if core is in sleep mode
+        bool IsSleeping(void) const { return sleeping; }
     
         void Load(const char* n); //!< Load flash, eeprom, signature, fuses from elf file, wrapper for LoadBFD or LoadSimpleELF
         void ReplaceIoRegister(unsigned int offset, RWMemoryMember *);
@@ -163,9 +262,22 @@ class AvrDevice: public SimulationMember, public TraceValueRegister {
           \param untilCoreStepFinished iff true, steps a core step and not a
           single clock cycle. */
         int Step(bool &untilCoreStepFinished, SystemClockOffset *nextStepIn_ns =0);
+        AvrDevice *GetDevice(void) { return this; }
         void Reset();
+        //! Save or restore the state of core, memory and all hardware units, see SystemClock::SaveState
+        void Snapshot(SnapshotArchive &ar);
+        //! Returns the index of a hardware unit in hwResetList, -1 for NULL or a unknown unit
+        int GetHardwareIndex(const Hardware *hw) const;
+        //! Returns hardware unit with index in hwResetList, NULL for a index out of range
+        Hardware *GetHardware(int index) const;
         void SetClockFreq(SystemClockOffset f);
         SystemClockOffset GetClockFreq();
+        //! Enable or disable fast core mode, see Step()
+        void SetFastCoreMode(bool enable) { fastCoreMode = enable; }
+        //! Process only one instruction in next steps, also in fast core mode, used by gdb server for single steps
+        void SetSingleStep(bool enable) { singleStep = enable; }
+        //! Record executed instructions to a binary trace, device takes ownership, NULL stops recording
+        void SetInstructionTrace(InstructionTrace *t);
 
         void RegisterPin(const std::string &name, Pin *p) {
             allPins.insert(std::pair<std::string, Pin*>(name, p));
@@ -174,12 +286,36 @@ class AvrDevice: public SimulationMember, public TraceValueRegister {
         //! Clear all breakpoints in device
         void DeleteAllBreakpoints(void);
 
+        //! Kind of data watchpoint, values are the same as the type in GDB Z packet
+        enum WatchKind {
+            WATCH_WRITE = 2,  //!< stop after a write access
+            WATCH_READ = 3,   //!< stop after a read access
+            WATCH_ACCESS = 4  //!< stop after a read or write access
+        };
+        //! Set a watchpoint on len bytes of data memory from addr on
+        /*! If a instruction accesses a watched address, Step returns WATCH_POINT
+          after the instruction is finished. Returns false, if the range is
+          outside of data memory. */
+        bool AddWatchpoint(unsigned int addr, unsigned int len, int kind);
+        //! Remove a watchpoint, which was set with the same parameters before
+        bool RemoveWatchpoint(unsigned int addr, unsigned int len, int kind);
+        //! Clear all watchpoints in device
+        void DeleteAllWatchpoints(void);
+        //! Get and clear the watchpoint hit, returns false, if last core step hasn't hit one
+        bool GetWatchHit(int &kind, unsigned int &addr);
+
         //! Return filename from loaded program
         const std::string &GetFname(void) { return actualFilename; }
         //! Return device name
         const std::string &GetDeviceName(void) { return devName; }
         //! Return device signature
         unsigned int GetDeviceSignature(void) { return devSignature; }
+        //! Return simulation context of this device
+        SimulationContext *GetContext(void) { return context; }
+        //! Return console handler of the context of this device
+        SystemConsoleHandler &GetConsoleHandler(void) { return *console; }
+        //! Return trace stream of this device, without lookup of the current context
+        std::ostream &TraceOut(void) { return console->traceOutStream(); }
         //! Set device signature and name
         void SetDeviceNameAndSignature(const std::string &name, unsigned int signature);
 
@@ -198,10 +334,26 @@ class AvrDevice: public SimulationMember, public TraceValueRegister {
         unsigned char GetRWMem(unsigned addr);
         //! Set a value to RW memory cell
         bool SetRWMem(unsigned addr, unsigned char val);
+        //! Get a value of RW memory cell for a debugger, doesn't hit watchpoints
+        unsigned char GetRWMemDebug(unsigned addr);
+        //! Set a value to RW memory cell for a debugger, doesn't hit watchpoints and isn't recorded
+        bool SetRWMemDebug(unsigned addr, unsigned char val);
         //! Get a value from core register
-        unsigned char GetCoreReg(unsigned addr);
+        unsigned char GetCoreReg(unsigned addr) {
+            assert(addr < registerSpaceSize);
+            if(rw.IsPlain(addr))
+                return rw.image[addr];
+            return GetFlaggedMem(addr);
+        }
         //! Set a value to core register
-        bool SetCoreReg(unsigned addr, unsigned char val);
+        bool SetCoreReg(unsigned addr, unsigned char val) {
+            assert(addr < registerSpaceSize);
+            if(rw.IsPlain(addr))
+                rw.image[addr] = val;
+            else
+                SetFlaggedMem(addr, val);
+            return true;
+        }
         //! Get a value from IO register (without offset of 0x20!)
         unsigned char GetIOReg(unsigned addr);
         //! Set a value to IO register (without offset of 0x20!)
@@ -224,6 +376,16 @@ class AvrDevice: public SimulationMember, public TraceValueRegister {
 
         friend void ELFLoad(const AvrDevice * core);
 
+    private:
+        //! Access on a address, which isn't plain: watchpoint check and dispatch
+        unsigned char GetFlaggedMem(unsigned addr);
+        //! Write on a address, which isn't plain: watchpoint check and dispatch
+        void SetFlaggedMem(unsigned addr, unsigned char val);
+        //! Record a access on a watched address
+        void WatchAccess(unsigned addr, bool write);
+        //! Set watch flags in memory map for a address range from watchpoint list
+        void UpdateWatchFlags(unsigned int addr, unsigned int len);
+
 };
 
 #endif
@@ -42,6 +42,7 @@
 
 #include "avrerror.h"
 #include "helper.h"
+#include "simulationcontext.h"
 
 /* for preprocessor symbol HAVE_SYS_MINGW */
 #include "config.h"
@@ -57,6 +58,7 @@ SystemConsoleHandler::SystemConsoleHandler() {
     wrnStream = &std::cerr;
     traceStream = nullStream;
     traceEnabled = false;
+    inFatalReport = false;
 }
 
 SystemConsoleHandler::~SystemConsoleHandler() {
@@ -105,6 +107,29 @@ void SystemConsoleHandler::StopTrace(void) {
     traceEnabled = false;
 }
 
+void SystemConsoleHandler::AddFatalReport(FatalReport *r) {
+    fatalReports.push_back(r);
+}
+
+void SystemConsoleHandler::RemoveFatalReport(FatalReport *r) {
+    for(std::vector<FatalReport *>::iterator i = fatalReports.begin(); i != fatalReports.end(); i++) {
+        if(*i == r) {
+            fatalReports.erase(i);
+            break;
+        }
+    }
+}
+
+void SystemConsoleHandler::WriteFatalReports(void) {
+    // a error while writing reports should not end in a loop
+    if(inFatalReport)
+        return;
+    inFatalReport = true;
+    for(size_t i = 0; i < fatalReports.size(); i++)
+        fatalReports[i]->WriteFatalReport(*wrnStream);
+    inFatalReport = false;
+}
+
 void SystemConsoleHandler::TraceNextLine(void) {
     if(!traceEnabled || !traceToFile)
         return;
@@ -174,16 +199,29 @@ void SystemConsoleHandler::vffatal(const char *file, int line, const char *fmt,
     va_start(ap, fmt);
     vsnprintf(messageStringBuffer, sizeof(messageStringBuffer), mfmt, ap);
     va_end(ap);
+    FatalMessage(messageStringBuffer);
+}
+
+void SystemConsoleHandler::FatalMessage(const char *msg) {
+    // the exception holds a pointer to the message, so it has to be in our buffer
+    if(msg != messageStringBuffer) {
+        strncpy(messageStringBuffer, msg, sizeof(messageStringBuffer) - 1);
+        messageStringBuffer[sizeof(messageStringBuffer) - 1] = '\0';
+    }
     if(useExitAndAbort) {
         *wrnStream << "\n" << messageStringBuffer << "\n" << std::endl;
+        WriteFatalReports();
         exit(1);
     } else {
+        // the catcher (python, gtest) gets the message, the reports go to warning stream
+        WriteFatalReports();
         throw (char const*)messageStringBuffer;
     }
 }
 
 void SystemConsoleHandler::AbortApplication(int code) {
     if(useExitAndAbort) {
+        WriteFatalReports();
 #if defined(HAVE_SYS_MINGW) || defined(_MSC_VER)
         /* TODO: changed because of problems on windows7 with abort call, with abort it will bring up a
            message box and break regression test. It will also irritate user. There is a call _set_abort_behavior
@@ -193,6 +231,7 @@ void SystemConsoleHandler::AbortApplication(int code) {
         abort();
 #endif
     } else {
+        WriteFatalReports();
         throw -code;
     }
 }
@@ -220,13 +259,17 @@ char* SystemConsoleHandler::getFormatString(const char *prefix,
     return formatStringBuffer;
 }
 
+SystemConsoleHandler &SystemConsoleHandler::Current(void) {
+    return SimulationContext::CurrentConsoleHandler();
+}
+
 // create the handler instance
 SystemConsoleHandler sysConHandler;
 
 int global_verbose_on = 0;
 
 void trioaccess(const char *t, unsigned char val) {
-    sysConHandler.traceOutStream() << t << "=" << HexChar(val) << " ";
+    traceOut << t << "=" << HexChar(val) << " ";
 }
 
 // EOF
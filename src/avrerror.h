@@ -27,6 +27,7 @@
 #define SIM_AVRERROR_H
 
 #include <iostream>
+#include <vector>
 
 #if defined(_MSC_VER) && !defined(SWIG)
 #define ATTRIBUTE_NORETURN __declspec(noreturn)
@@ -43,22 +44,42 @@
 #define ATTRIBUTE_PRINTF(string_arg, first_arg)
 #endif
 
+//! Interface for a report, which is written, if application stops on a fatal error
+/*! See SystemConsoleHandler::AddFatalReport */
+class FatalReport {
+
+    public:
+        virtual ~FatalReport() {}
+        //! Write report to stream
+        virtual void WriteFatalReport(std::ostream &os) = 0;
+};
+
 //! Class, that handle messages to console and also exit/abort calls
 class SystemConsoleHandler {
     
     public:
         //! creates a SystemConsoleHandler instance
-        /*! This is needed only once for a application, see global variable
-          sysConHandler, where such instance is created by default. */
+        /*! This is needed only once for a simulation context, see global
+          variable sysConHandler, where such instance is created by default
+          for the default context. */
         SystemConsoleHandler();
         ~SystemConsoleHandler();
+
+        //! Returns the handler of the current simulation context, see SimulationContext
+        static SystemConsoleHandler &Current(void);
         
         //! Tells the handler, that exit/abort is to use instead of exceptions
         void SetUseExit(bool useExit = true);
+        //! Returns true, if exit/abort is used instead of exceptions
+        bool GetUseExit(void) { return useExitAndAbort; }
         //! Sets the output stream, where messages are sent to
         void SetMessageStream(std::ostream *s);
+        //! Returns the output stream, where messages are sent to
+        std::ostream *GetMessageStream(void) { return msgStream; }
         //! Sets the output stream, where warnings and errors are sent to
         void SetWarningStream(std::ostream *s);
+        //! Returns the output stream, where warnings and errors are sent to
+        std::ostream *GetWarningStream(void) { return wrnStream; }
         
         //! Sets the trace to file stream and enables tracing global
         void SetTraceFile(const char *name, unsigned int maxlines = 0);
@@ -73,6 +94,13 @@ class SystemConsoleHandler {
         //! Ends a trace line, performs reopen new filestream, if necessary
         void TraceNextLine(void);
         
+        //! Register a report, which is written to warning stream on a fatal error or abort
+        /*! Reports are written before exit/abort or before the exception is
+          thrown, see SetUseExit. */
+        void AddFatalReport(FatalReport *r);
+        //! Unregister a report
+        void RemoveFatalReport(FatalReport *r);
+        
         //! Format and send a message to message stream (default stdout)
         void vfmessage(const char *fmt, ...)
             ATTRIBUTE_PRINTF(2, 3);
@@ -86,6 +114,10 @@ class SystemConsoleHandler {
         ATTRIBUTE_NORETURN
         void vffatal(const char *file, int line, const char *fmt, ...)
             ATTRIBUTE_PRINTF(4, 5);
+        //! Send a already formatted fatal error message to stderr and call exit or raise a exception
+        /*! Used to raise a error again, which was caught on a other thread. */
+        ATTRIBUTE_NORETURN
+        void FatalMessage(const char *msg);
         
         //! Aborts application: uses abort or exception depending on useExitAndAbort
         ATTRIBUTE_NORETURN
@@ -108,16 +140,21 @@ class SystemConsoleHandler {
         unsigned int traceLinesOnFile; //!< how much lines will be written on one trace file 0->means endless
         unsigned int traceLines; //!< how much lines are written on current trace file
         int traceFileCount; //!< Counter for trace files
+        std::vector<FatalReport *> fatalReports; //!< reports to write on fatal error
+        bool inFatalReport; //!< flag, true while writing fatal reports
         
+        //! Write all fatal reports to warning stream
+        void WriteFatalReports(void);
         //! Creates the format string for formatting a message
         char *getFormatString(const char *prefix, const char *file, int line, const char *fmtstr);
 };
 
-//! The SystemConsoleHandler instance for common usage
+//! The SystemConsoleHandler instance of the default simulation context
 extern SystemConsoleHandler sysConHandler;
 
-// redirect old definition ostream traceOut to SystemConsoleHandler.traceStream
-#define traceOut sysConHandler.traceOutStream()
+// redirect old definition ostream traceOut to SystemConsoleHandler.traceStream,
+// device code uses AvrDevice::TraceOut instead, which needs no context lookup
+#define traceOut SystemConsoleHandler::Current().traceOutStream()
 
 // moved from trace.h
 //! Verbose enable flag
@@ -127,9 +164,9 @@ extern int global_verbose_on;
 //! Helper function for writing trace (trace IO access)
 void trioaccess(const char *t, unsigned char val);
 
-#define avr_message(...) sysConHandler.vfmessage(__VA_ARGS__)
-#define avr_warning(...) sysConHandler.vfwarning(__FILE__, __LINE__, ## __VA_ARGS__)
-#define avr_failure(...) sysConHandler.vferror(__FILE__, __LINE__, ## __VA_ARGS__)
-#define avr_error(...)   sysConHandler.vffatal(__FILE__, __LINE__, ## __VA_ARGS__)
+#define avr_message(...) SystemConsoleHandler::Current().vfmessage(__VA_ARGS__)
+#define avr_warning(...) SystemConsoleHandler::Current().vfwarning(__FILE__, __LINE__, ## __VA_ARGS__)
+#define avr_failure(...) SystemConsoleHandler::Current().vferror(__FILE__, __LINE__, ## __VA_ARGS__)
+#define avr_error(...)   SystemConsoleHandler::Current().vffatal(__FILE__, __LINE__, ## __VA_ARGS__)
 
 #endif /* SIM_AVRERROR_H */
@@ -33,8 +33,24 @@
 #include <string>
 #include <map>
 #include <limits>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#ifndef _MSC_VER
+#   include <sys/types.h>
+#   include <sys/stat.h>
+#endif
+#if !(defined(_MSC_VER) || defined(HAVE_SYS_MINGW))
+#   include <sys/mman.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <utime.h>
+#   define USE_MMAP
+#endif
 
 #include "avrdevice_impl.h"
+#include "simulationcontext.h"
 
 #include "avrreadelf.h"
 
@@ -135,7 +151,414 @@ unsigned int ELFGetSignature(const char *filename) {
 
 #ifndef _MSC_VER
 
+//! Header of a firmware cache file
+/*! The header is followed by records (FirmwareCacheRecord), each followed by
+  its data padded to a multiple of 4 bytes. All numbers are stored in byte
+  order of the writing host. */
+struct FirmwareCacheHeader {
+    char magic[8];        //!< "SAVRFWC2"
+    uint32_t byteOrder;   //!< 0x01020304, written as number
+    uint32_t records;     //!< count of records
+    uint64_t elfHash;     //!< FNV-1a hash of elf file
+    uint64_t elfSize;     //!< size of elf file
+    uint64_t elfMtime;    //!< modification time of elf file in seconds
+    uint64_t elfInode;    //!< inode of elf file
+    uint64_t elfDevice;   //!< device of elf file
+    uint64_t size;        //!< size of cache file
+};
+
+//! A segment or symbol in a firmware cache file
+struct FirmwareCacheRecord {
+    uint32_t kind;        //!< SEGMENT or SYMBOL
+    uint32_t vma;         //!< virtual address of segment or value of symbol
+    uint32_t pma;         //!< physical address of segment
+    uint32_t size;        //!< size of segment data or length of symbol name
+};
+
+//! On-disk cache of the loadable content of a elf file, see SimulationContext::SetFirmwareCacheDirectory
+/*! The cache file is found by size, modification time, inode and device of
+  the elf file (like make does), so a hit doesn't read the elf file. A elf
+  file, which is changed again in the same second as the cache file was
+  written, has the same key. In this case the elf file content is checked
+  against the hash in the cache file (like git does for "racily clean"
+  files) and, if it's ok, the cache file is touched to end this state.
+
+  The cache file holds the already filtered symbols and the loadable
+  segments, so the elf file isn't parsed again. If found, the file is mapped
+  into memory. */
+class FirmwareCache {
+
+    public:
+        enum { SEGMENT = 1, SYMBOL = 2 };
+
+        //! Look up cache for elf file in directory, does nothing, if directory is empty
+        FirmwareCache(const std::string &elfFilename, const std::string &directory);
+        ~FirmwareCache();
+
+        bool IsEnabled(void) const { return !path.empty(); }
+        //! True, if a valid cache file for elf file was found
+        bool IsValid(void) const { return image != NULL; }
+        //! Call f for all records of found cache file
+        template<class F> void ForEach(F &f);
+
+        //! Record a symbol for a new cache file
+        void AddSymbol(unsigned int value, const std::string &name) {
+            Add(SYMBOL, value, 0, (const unsigned char *)name.data(), name.size());
+        }
+        //! Record a segment for a new cache file
+        void AddSegment(unsigned int vma, unsigned int pma, const unsigned char *data, unsigned int size) {
+            Add(SEGMENT, vma, pma, data, size);
+        }
+        //! Write recorded symbols and segments to a new cache file
+        void Write(void);
+
+    private:
+        std::string elfFilename;
+        std::string path;       //!< name of cache file
+        uint64_t elfSize;
+        uint64_t elfMtime;
+        uint64_t elfInode;
+        uint64_t elfDevice;
+        const unsigned char *image; //!< content of found cache file or NULL
+        size_t imageSize;
+        std::string buffer;     //!< cache file without mmap or records to write
+        uint32_t recordCount;   //!< count of records in buffer
+
+        void Add(uint32_t kind, uint32_t vma, uint32_t pma, const unsigned char *data, uint32_t size);
+        bool Check(void);
+        bool CheckContent(time_t cacheMtime);
+        void Drop(void);
+
+        // no copies!
+        FirmwareCache(const FirmwareCache &);
+        FirmwareCache &operator=(const FirmwareCache &);
+};
+
+static inline size_t Padded(size_t size) {
+    return (size + 3) & ~(size_t)3;
+}
+
+static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+
+//! Continue FNV-1a hash over data
+static uint64_t HashBytes(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *p = (const unsigned char *)data;
+    for(size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//! FNV-1a hash over file content, false if file can't be read
+static bool HashFile(const std::string &filename, uint64_t &hash) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if(f == NULL)
+        return false;
+    unsigned char buf[65536];
+    size_t l;
+    hash = FNV_OFFSET;
+    while((l = fread(buf, 1, sizeof(buf), f)) > 0)
+        hash = HashBytes(hash, buf, l);
+    fclose(f);
+    return true;
+}
+
+FirmwareCache::FirmwareCache(const std::string &_elfFilename, const std::string &directory):
+    elfFilename(_elfFilename),
+    elfSize(0),
+    elfMtime(0),
+    elfInode(0),
+    elfDevice(0),
+    image(NULL),
+    imageSize(0),
+    recordCount(0)
+{
+    if(directory.empty())
+        return;
+
+    struct stat est;
+    if(stat(elfFilename.c_str(), &est) != 0)
+        return; // error is reported by elf loader
+    elfSize = est.st_size;
+    elfMtime = est.st_mtime;
+    elfInode = est.st_ino;
+    elfDevice = est.st_dev;
+
+    uint64_t key = FNV_OFFSET;
+    key = HashBytes(key, &elfSize, sizeof(elfSize));
+    key = HashBytes(key, &elfMtime, sizeof(elfMtime));
+    key = HashBytes(key, &elfInode, sizeof(elfInode));
+    key = HashBytes(key, &elfDevice, sizeof(elfDevice));
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.fwc", (unsigned long long)key);
+    path = directory + name;
+
+    struct stat st;
+#ifdef USE_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return;
+    if(fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(FirmwareCacheHeader)) {
+        void *mem = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mem != MAP_FAILED) {
+            image = (const unsigned char *)mem;
+            imageSize = st.st_size;
+        }
+    }
+    close(fd);
+#else
+    if(stat(path.c_str(), &st) != 0)
+        return;
+    FILE *f = fopen(path.c_str(), "rb");
+    if(f == NULL)
+        return;
+    unsigned char buf[65536];
+    size_t l;
+    while((l = fread(buf, 1, sizeof(buf), f)) > 0)
+        buffer.append((const char *)buf, l);
+    fclose(f);
+    image = (const unsigned char *)buffer.data();
+    imageSize = buffer.size();
+#endif
+    if(!Check()) {
+        avr_warning("firmware cache file '%s' is invalid, ignored", path.c_str());
+        Drop();
+    } else if(!CheckContent(st.st_mtime))
+        Drop();
+}
+
+FirmwareCache::~FirmwareCache() {
+    Drop();
+}
+
+//! Forget found cache file
+void FirmwareCache::Drop(void) {
+#ifdef USE_MMAP
+    if(image != NULL)
+        munmap((void *)image, imageSize);
+#endif
+    image = NULL;
+    buffer.clear();
+}
+
+//! Check elf file content against hash, if the elf file could be changed after cache file was written
+bool FirmwareCache::CheckContent(time_t cacheMtime) {
+    if((time_t)elfMtime < cacheMtime)
+        return true;
+    const FirmwareCacheHeader *h = (const FirmwareCacheHeader *)image;
+    uint64_t hash;
+    if(!HashFile(elfFilename, hash) || hash != h->elfHash)
+        return false;
+#ifdef USE_MMAP
+    // elf file can't be changed any more in the second of its mtime
+    if(time(NULL) > (time_t)elfMtime)
+        utime(path.c_str(), NULL);
+#endif
+    return true;
+}
+
+bool FirmwareCache::Check(void) {
+    if(image == NULL || imageSize < sizeof(FirmwareCacheHeader))
+        return false;
+    const FirmwareCacheHeader *h = (const FirmwareCacheHeader *)image;
+    if(memcmp(h->magic, "SAVRFWC2", 8) != 0 || h->byteOrder != 0x01020304 ||
+       h->elfSize != elfSize || h->elfMtime != elfMtime || h->elfInode != elfInode ||
+       h->elfDevice != elfDevice || h->size != imageSize)
+        return false;
+    // all records have to be inside of file
+    size_t pos = sizeof(FirmwareCacheHeader);
+    for(uint32_t i = 0; i < h->records; i++) {
+        if(pos + sizeof(FirmwareCacheRecord) > imageSize)
+            return false;
+        const FirmwareCacheRecord *r = (const FirmwareCacheRecord *)(image + pos);
+        pos += sizeof(FirmwareCacheRecord) + Padded(r->size);
+        if(pos > imageSize || (r->kind != SEGMENT && r->kind != SYMBOL))
+            return false;
+    }
+    return pos == imageSize;
+}
+
+template<class F> void FirmwareCache::ForEach(F &f) {
+    const FirmwareCacheHeader *h = (const FirmwareCacheHeader *)image;
+    size_t pos = sizeof(FirmwareCacheHeader);
+    for(uint32_t i = 0; i < h->records; i++) {
+        const FirmwareCacheRecord *r = (const FirmwareCacheRecord *)(image + pos);
+        const unsigned char *data = image + pos + sizeof(FirmwareCacheRecord);
+        pos += sizeof(FirmwareCacheRecord) + Padded(r->size);
+        f(*r, data);
+    }
+}
+
+void FirmwareCache::Add(uint32_t kind, uint32_t vma, uint32_t pma, const unsigned char *data, uint32_t size) {
+    if(!IsEnabled())
+        return;
+    FirmwareCacheRecord r;
+    r.kind = kind;
+    r.vma = vma;
+    r.pma = pma;
+    r.size = size;
+    buffer.append((const char *)&r, sizeof(r));
+    buffer.append((const char *)data, size);
+    buffer.append(Padded(size) - size, '\0');
+    recordCount++;
+}
+
+void FirmwareCache::Write(void) {
+    if(!IsEnabled())
+        return;
+    FirmwareCacheHeader h;
+    memcpy(h.magic, "SAVRFWC2", 8);
+    h.byteOrder = 0x01020304;
+    h.records = recordCount;
+    if(!HashFile(elfFilename, h.elfHash))
+        return;
+    h.elfSize = elfSize;
+    h.elfMtime = elfMtime;
+    h.elfInode = elfInode;
+    h.elfDevice = elfDevice;
+    h.size = sizeof(h) + buffer.size();
+
+    // write to a temporary file and rename it, so a parallel run never sees a
+    // partial file, process id and this make the name unique for threads too
+    char suffix[64];
+#ifdef USE_MMAP
+    snprintf(suffix, sizeof(suffix), ".%d.%p.tmp", (int)getpid(), (void *)this);
+#else
+    snprintf(suffix, sizeof(suffix), ".%p.tmp", (void *)this);
+#endif
+    std::string tmp = path + suffix;
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if(f == NULL) {
+        avr_warning("can't write firmware cache file '%s'", tmp.c_str());
+        return;
+    }
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    if(buffer.size() > 0)
+        ok = ok && fwrite(buffer.data(), buffer.size(), 1, f) == 1;
+    ok = (fclose(f) == 0) && ok;
+    if(!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(tmp.c_str());
+        avr_warning("can't write firmware cache file '%s'", path.c_str());
+    }
+}
+
+//! Add a symbol from elf file to the memory, which it belongs to
+static void LoadSymbol(const AvrDevice *core, unsigned long long value, const std::string &name) {
+    if(value < 0x800000) {
+        // range of flash space (.text)
+        std::pair<unsigned int, std::string> p(value >> 1, name);
+
+        core->Flash->AddSymbol(p);
+    } else if(value < 0x810000) {
+        // range of ram (.data)
+        unsigned long long offset = value - 0x800000;
+        std::pair<unsigned int, std::string> p(offset, name);
+
+        core->data->AddSymbol(p);
+    } else if(value < 0x820000) {
+        // range of eeprom (.eeprom)
+        unsigned long long offset = value - 0x810000;
+        std::pair<unsigned int, std::string> p(offset, name);
+
+        core->eeprom->AddSymbol(p);
+    } else if(value < 0x820400) {
+        /* fuses space starting from 0x820000, do nothing */;
+    } else if(value >= 0x830000 && value < 0x830400) {
+        /* lock bits starting from 0x830000, do nothing */;
+    } else if(value >= 0x840000 && value < 0x840400) {
+        /* signature space starting from 0x840000, do nothing */;
+    } else
+        avr_warning("Unknown symbol address range found! (symbol='%s', address=0x%llx)",
+                    name.c_str(),
+                    value);
+}
+
+//! Load a segment from elf file into flash, eeprom, fuses or lock bits or check signature
+static void LoadSegment(const AvrDevice *core, unsigned int devSignature,
+                        unsigned long long vma, unsigned long long pma,
+                        const unsigned char *data, unsigned long long filesize) {
+    if(vma < 0x810000) {
+        // read program, space below 0x810000 (.text)
+        core->Flash->WriteMem(data, pma, filesize);
+    } else if(vma >= 0x810000 && vma < 0x820000) {
+        // read eeprom content, if available, space from 0x810000 to 0x820000 (.eeprom)
+        unsigned int offset = vma - 0x810000;
+
+        core->eeprom->WriteMem(data, offset, filesize);
+    } else if(vma >= 0x820000 && vma < 0x820400) {
+        // read fuses, if available, space from 0x820000 to 0x820400
+        if(!core->fuses->LoadFuses(data, filesize))
+            avr_error("wrong byte size of fuses");
+    } else if(vma >= 0x830000 && vma < 0x830400) {
+        // read lock bits, if available, space from 0x830000 to 0x830400
+        if(!core->lockbits->LoadLockBits(data, filesize))
+            avr_error("wrong byte size of lock bits");
+    } else if(vma >= 0x840000 && vma < 0x840400) {
+        // read and check signature, if available, space from 0x840000 to 0x840400
+        if(filesize != 3)
+            avr_error("wrong device signature size in elf file, expected=3, given=%llu",
+                      filesize);
+        else {
+            unsigned int sig = (((data[2] << 8) + data[1]) << 8) + data[0];
+
+            if(devSignature != std::numeric_limits<unsigned int>::max() && sig != devSignature)
+                avr_error("wrong device signature, expected=0x%x, given=0x%x",
+                          devSignature,
+                          sig);
+        }
+    }
+}
+
+//! Loads records of a firmware cache into a device
+class CacheLoader {
+
+    public:
+        CacheLoader(const AvrDevice *_core, unsigned int _devSignature, bool _symbols):
+            core(_core), devSignature(_devSignature), symbols(_symbols) {}
+
+        void operator()(const FirmwareCacheRecord &r, const unsigned char *data) {
+            if(r.kind == FirmwareCache::SYMBOL && symbols)
+                LoadSymbol(core, r.vma, std::string((const char *)data, r.size));
+            else if(r.kind == FirmwareCache::SEGMENT && !symbols)
+                LoadSegment(core, devSignature, r.vma, r.pma, data, r.size);
+        }
+
+    private:
+        const AvrDevice *core;
+        unsigned int devSignature;
+        bool symbols; //!< load symbols or segments
+};
+
+//! Finds signature in records of a firmware cache
+class CacheSignature {
+
+    public:
+        CacheSignature(): signature(std::numeric_limits<unsigned int>::max()) {}
+
+        void operator()(const FirmwareCacheRecord &r, const unsigned char *data) {
+            if(r.kind == FirmwareCache::SEGMENT && r.vma >= 0x840000 && r.vma < 0x840400 && r.size == 3)
+                signature = (((data[2] << 8) + data[1]) << 8) + data[0];
+        }
+
+        unsigned int signature;
+};
+
 void ELFLoad(const AvrDevice * core) {
+    FirmwareCache cache(core->actualFilename, core->context->GetFirmwareCacheDirectory());
+
+    if(cache.IsValid()) {
+        // symbols first, like from elf file
+        CacheLoader symbolLoader(core, core->devSignature, true);
+        cache.ForEach(symbolLoader);
+        core->Flash->BuildSymbolIndex();
+        core->data->BuildSymbolIndex();
+        core->eeprom->BuildSymbolIndex();
+        CacheLoader segmentLoader(core, core->devSignature, false);
+        cache.ForEach(segmentLoader);
+        return;
+    }
+
     ELFIO::elfio reader;
 
     if(!reader.load(core->actualFilename))
@@ -181,37 +604,14 @@ void ELFLoad(const AvrDevice * core) {
                 if((bind == STB_LOCAL) && (type != STT_NOTYPE))
                     continue;
 
-                if(value < 0x800000) {
-                    // range of flash space (.text)
-                    std::pair<unsigned int, std::string> p(value >> 1, name);
-
-                    core->Flash->AddSymbol(p);
-                } else if(value < 0x810000) {
-                    // range of ram (.data)
-                    ELFIO::Elf64_Addr offset = value - 0x800000;
-                    std::pair<unsigned int, std::string> p(offset, name);
-
-                    core->data->AddSymbol(p);
-                } else if(value < 0x820000) {
-                    // range of eeprom (.eeprom)
-                    ELFIO::Elf64_Addr offset = value - 0x810000;
-                    std::pair<unsigned int, std::string> p(offset, name);
-
-                    core->eeprom->AddSymbol(p);
-                } else if(value < 0x820400) {
-                    /* fuses space starting from 0x820000, do nothing */;
-                } else if(value >= 0x830000 && value < 0x830400) {
-                    /* lock bits starting from 0x830000, do nothing */;
-                } else if(value >= 0x840000 && value < 0x840400) {
-                    /* signature space starting from 0x840000, do nothing */;
-                } else
-                    avr_warning("Unknown symbol address range found! (symbol='%s', address=0x%llx)",
-                                name.c_str(),
-                                value);
-
+                LoadSymbol(core, value, name);
+                cache.AddSymbol(value, name);
             }
         }
     }
+    core->Flash->BuildSymbolIndex();
+    core->data->BuildSymbolIndex();
+    core->eeprom->BuildSymbolIndex();
 
     // load program, data and - if available - eeprom, fuses and signature
     ELFIO::Elf_Half seg_num = reader.segments.size();
@@ -229,42 +629,24 @@ void ELFLoad(const AvrDevice * core) {
 
             const unsigned char* data = (const unsigned char*)pseg->get_data();
 
-            if(vma < 0x810000) {
-                // read program, space below 0x810000 (.text)
-                core->Flash->WriteMem(data, pma, filesize);
-            } else if(vma >= 0x810000 && vma < 0x820000) {
-                // read eeprom content, if available, space from 0x810000 to 0x820000 (.eeprom)
-                unsigned int offset = vma - 0x810000;
-
-                core->eeprom->WriteMem(data, offset, filesize);
-            } else if(vma >= 0x820000 && vma < 0x820400) {
-                // read fuses, if available, space from 0x820000 to 0x820400
-                if(!core->fuses->LoadFuses(data, filesize))
-                    avr_error("wrong byte size of fuses");
-            } else if(vma >= 0x830000 && vma < 0x830400) {
-                // read lock bits, if available, space from 0x830000 to 0x830400
-                if(!core->lockbits->LoadLockBits(data, filesize))
-                    avr_error("wrong byte size of lock bits");
-            } else if(vma >= 0x840000 && vma < 0x840400) {
-                // read and check signature, if available, space from 0x840000 to 0x840400
-                if(filesize != 3)
-                    avr_error("wrong device signature size in elf file, expected=3, given=%llu",
-                              filesize);
-                else {
-                    unsigned int sig = (((data[2] << 8) + data[1]) << 8) + data[0];
-
-                    if(core->devSignature != std::numeric_limits<unsigned int>::max() && sig != core->devSignature)
-                        avr_error("wrong device signature, expected=0x%x, given=0x%x",
-                                  core->devSignature,
-                                  sig);
-                }
-            }
+            LoadSegment(core, core->devSignature, vma, pma, data, filesize);
+            cache.AddSegment(vma, pma, data, filesize);
         }
     }
+
+    cache.Write();
 }
 
 unsigned int ELFGetSignature(const char *filename) {
     unsigned int signature = std::numeric_limits<unsigned int>::max();
+    FirmwareCache cache(filename, SimulationContext::Current().GetFirmwareCacheDirectory());
+
+    if(cache.IsValid()) {
+        CacheSignature cacheSignature;
+        cache.ForEach(cacheSignature);
+        return cacheSignature.signature;
+    }
+
     ELFIO::elfio reader;
 
     if(!reader.load(filename))
@@ -28,7 +28,10 @@
 
 #include "avrdevice.h"
 
+//! Returns device signature from elf file, uses firmware cache of current simulation context
 unsigned int ELFGetSignature(const char *filename);
+//! Loads elf file into device, uses firmware cache of device's simulation context
+/*! See SimulationContext::SetFirmwareCacheDirectory */
 void ELFLoad(const AvrDevice * core);
 
 #endif
@@ -77,6 +77,19 @@ void SetDumpTraceArgs(const vector<string> &traceopts, AvrDevice *dev) {
                     avr_error("Invalid read/write strobe specifier '%s'", ls[3].c_str());
             }
             d = new DumpVCD(ls[2], "ns", rs, ws);
+        } else if (ls[0] == "bin") {
+            cerr << "bin'." << endl;
+            if(ls.size() != 3)
+                avr_error("Invalid number of options for 'bin'.");
+            cerr << "Reading values to trace from '" << ls[1] << "'." << endl;
+        
+            ifstream is(ls[1].c_str());
+            if(is.is_open() == 0)
+                avr_error("Can't open '%s'", ls[1].c_str());
+        
+            cerr << "Output binary trace file is '" << ls[2] << "'." << endl;
+            ts = dman->load(is);
+            d = new DumpBinary(ls[2], "ns");
         } else
             avr_error("Unknown tracer '%s'", ls[0].c_str());
         dman->addDumper(d, ts);
@@ -142,7 +155,7 @@ static void WriteCoreDumpRAM(ostream &outf, AvrDevice *dev, int offs, int size)
     string lastLine("");
 
     for(int i = 0; i < size; i++) {
-        buf << hex << setw(2) << setfill('0') << (int)((unsigned char)*(dev->rw[i + offs])) << " ";
+        buf << hex << setw(2) << setfill('0') << (int)dev->GetRWMemDebug(i + offs) << " ";
         if(++j == maxLineByte) {
             if(buf.str() == lastLine) // check for duplicate line
               dup++;
@@ -249,7 +262,7 @@ void WriteCoreDump(const string &outname, AvrDevice *dev) {
     *outf << "General Purpose Register Dump:" << endl;
     for(unsigned int i = 0, j = 0; i < dev->GetMemRegisterSize(); i++) {
         *outf << dec << "r" << setw(2) << setfill('0') << i << "="
-              << hex << setw(2) << setfill('0') << (int)((unsigned char)*(dev->rw[i])) << "  ";
+              << hex << setw(2) << setfill('0') << (int)dev->GetRWMemDebug(i) << "  ";
         j++;
         if(j == 8) {
             *outf << endl;
@@ -285,6 +298,11 @@ void WriteCoreDump(const string &outname, AvrDevice *dev) {
     WriteCoreDumpFlash(*outf, dev, dev->Flash->GetSize());
     *outf << endl;
 
+    // write out last instructions
+    *outf << "Flight Recorder, ";
+    dev->flightRecorder.Write(*outf);
+    *outf << endl;
+
     // close file
     if(outf != &cout)
         delete outf;
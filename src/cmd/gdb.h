@@ -42,11 +42,13 @@
 #endif
 
 #include <vector>
+#include <string>
 #include "avrdevice.h"
 #include "types.h"
 #include "simulationmember.h"
 
 #define MAX_BUF 400 /* Maximum size of read/write buffers. */
+#define GDB_READ_BUF 4096 /* Size of receive buffer of server socket */
 
 // this are similar to unix signal numbers, but here used only as number, not
 // as signal! See signum.h on unix systems for the values.
@@ -56,6 +58,10 @@
 #define GDB_SIGTRAP 5      // Trace trap (POSIX).
 
 //! Interface for server socket wrapper
+/*! ReadByte returns the next received byte (0 .. 255) or -1, if the socket is
+  in non-blocking mode and nothing is received. The implementations read all
+  available bytes at once into a buffer, so a packet or a pipeline of packets
+  costs one read call. */
 class GdbServerSocket {
     public:
         //GdbServerSocket(int port);
@@ -79,6 +85,10 @@ class GdbServerSocketMingW: public GdbServerSocket {
         static int socketCount;
         SOCKET _socket;
         SOCKET _conn;
+        int blockingMode; //!< current blocking mode of connection, -1 if unknown
+        char readBuf[GDB_READ_BUF]; //!< received, but not yet read bytes
+        int readPos; //!< position of next byte in readBuf
+        int readLen; //!< count of bytes in readBuf
         
     public:
         GdbServerSocketMingW(int port);
@@ -99,6 +109,10 @@ class GdbServerSocketUnix: public GdbServerSocket {
         int sock;       //!< socket for listening for a new client
         int conn;       //!< the TCP connection from gdb client
         struct sockaddr_in address[1];
+        int blockingMode; //!< current blocking mode of connection, -1 if unknown
+        char readBuf[GDB_READ_BUF]; //!< received, but not yet read bytes
+        int readPos; //!< position of next byte in readBuf
+        int readLen; //!< count of bytes in readBuf
 
     public:
         GdbServerSocketUnix(int port);
@@ -131,18 +145,19 @@ class GdbServer: public SimulationMember {
         bool exitOnKillRequest; //!< flag for regression test to shutdown simulator on kill request from gdb
         int runMode;
         bool lastCoreStepFinished;
+        int pollCountdown; //!< core steps till next check for gdb packets in continue mode
+        bool ackPending; //!< a ack for a received packet has to be sent with next write
+        bool noAckMode; //!< gdb has requested QStartNoAckMode, packets aren't acknowledged
 
         //old function local static vars, must move to class, no way to handle
         //method local static vars.
         char *last_reply;  //used in last_reply();
-        char buf[MAX_BUF]; //used in send_reply();
         int m_gdb_thread_id;  ///< For queries by GDB. First thread ID is 1. See http://sources.redhat.com/gdb/current/onlinedocs/gdb/Packets.html#thread-id
 
 
         bool avr_core_flash_read(int addr, word& val) ;
-        void avr_core_flash_write(int addr, word val) ;
-        void avr_core_flash_write_hi8( int addr, byte val) ;
-        void avr_core_flash_write_lo8( int addr, byte val) ;
+        bool avr_core_flash_write(unsigned int addr, const byte *data, int len);
+        bool avr_core_flash_erase(unsigned int addr, int len);
         void avr_core_remove_breakpoint(dword pc) ;
         void avr_core_insert_breakpoint(dword pc) ;
         int signal_has_occurred(int signo); 
@@ -152,7 +167,10 @@ class GdbServer: public SimulationMember {
         int hex2nib(char hex);
         const char* gdb_last_reply(const char *reply);
         void gdb_send_ack();
+        void gdb_flush_ack();
         void gdb_send_reply(const char *reply);
+        void gdb_send_xfer(const std::string &data, const char *pkt);
+        std::string gdb_memory_map();
         void gdb_send_hex_reply(const char *reply, const char *reply_to_encode);
         void gdb_read_registers();
         void gdb_write_registers(const char *pkt);
@@ -162,12 +180,16 @@ class GdbServer: public SimulationMember {
         int gdb_get_addr_len(const char *pkt, char a_end, char l_end, unsigned int *addr, int *len);
         void gdb_read_memory(const char *pkt);
         void gdb_write_memory(const char *pkt);
+        void gdb_write_memory_binary(const char *pkt, int pktlen);
+        bool gdb_write_memory_bytes(unsigned int addr, const byte *data, int len);
+        int gdb_unescape_binary(const char *src, int srclen, byte *dst);
+        void gdb_flash_packet(const char *pkt, int pktlen);
         void gdb_break_point(const char *pkt);
         void gdb_select_thread(const char *pkt);
         void gdb_is_thread_alive(const char *pkt);
         void gdb_get_thread_list(const char *pkt);
         int gdb_get_signal(const char *pkt);
-        int gdb_parse_packet(const char *pkt);
+        int gdb_parse_packet(const char *pkt, int pktlen);
         int gdb_receive_and_process_packet(int blocking);
         void gdb_main_loop(); 
         void gdb_interact(int port, int debug_on);
@@ -175,6 +197,7 @@ class GdbServer: public SimulationMember {
 
     public:
         int Step(bool &trueHwStep, SystemClockOffset *timeToNextStepIn_ns=0) ;
+        AvrDevice *GetDevice(void) { return core; }
         int InternalStep(bool &trueHwStep, SystemClockOffset *timeToNextStepIn_ns=0) ;
         void TryConnectGdb();
         void SendPosition(int signal); //send gdb the actual position where the simulation is stopped
@@ -54,6 +54,7 @@ using namespace std;
 #ifndef DOXYGEN /* have doxygen system ignore this. */
 enum {
     MAX_READ_RETRY = 50,          /* Maximum number of retries if a read is incomplete. */
+    POLL_STEPS = 1024,            /* Core steps between checks for gdb packets in continue mode. */
 
     MEM_SPACE_MASK = 0x00ff0000,  /* mask to get bits which determine memory space */
     FLASH_OFFSET   = 0x00000000,  /* Data in flash has this offset from gdb */
@@ -91,7 +92,13 @@ void GdbServerSocketMingW::End() {
     WSACleanup();
 }
 
-GdbServerSocketMingW::GdbServerSocketMingW(int port): _socket(0), _conn(0) {
+GdbServerSocketMingW::GdbServerSocketMingW(int port):
+    _socket(0),
+    _conn(0),
+    blockingMode(-1),
+    readPos(0),
+    readLen(0)
+{
     sockaddr_in sa;
     
     Start();
@@ -126,11 +133,14 @@ void GdbServerSocketMingW::Close(void) {
 }
 
 int GdbServerSocketMingW::ReadByte(void) {
-    char buf[1];
-    int rv = recv(_conn, buf, 1, 0);
+    if(readPos < readLen)
+        return (unsigned char)readBuf[readPos++];
+    int rv = recv(_conn, readBuf, sizeof(readBuf), 0);
     if(rv <= 0)
         return -1;
-    return buf[0];
+    readLen = rv;
+    readPos = 1;
+    return (unsigned char)readBuf[0];
 }
 
 void GdbServerSocketMingW::Write(const void* buf, size_t count) {
@@ -138,6 +148,9 @@ void GdbServerSocketMingW::Write(const void* buf, size_t count) {
 }
 
 void GdbServerSocketMingW::SetBlockingMode(int mode) {
+    if(mode == blockingMode)
+        return;
+    blockingMode = mode;
     u_long arg = 1;
     if(mode)
         arg = 0;
@@ -155,17 +168,22 @@ bool GdbServerSocketMingW::Connect(void) {
         else
             avr_error("Couldn't connect: INVALID_SOCKET");
     }
+    blockingMode = -1;
+    readPos = readLen = 0;
     return true;
 }
 
 void GdbServerSocketMingW::CloseConnection(void) {
     closesocket(_conn);
+    readPos = readLen = 0;
 }
 
 #else
 
 GdbServerSocketUnix::GdbServerSocketUnix(int port) {
     conn = -1;        //no connection opened
+    blockingMode = -1;
+    readPos = readLen = 0;
     
     if((sock = socket(PF_INET, SOCK_STREAM, 0)) < 0)
         avr_error("Can't create socket: %s", strerror(errno));
@@ -198,12 +216,14 @@ void GdbServerSocketUnix::Close(void) {
 }
 
 int GdbServerSocketUnix::ReadByte(void) {
-    char c;
     int res;
     int cnt = MAX_READ_RETRY;
 
+    if(readPos < readLen)
+        return (unsigned char)readBuf[readPos++];
+
     while(cnt--) {
-        res = read(conn, &c, 1);
+        res = read(conn, readBuf, sizeof(readBuf));
         if(res < 0) {
             if (errno == EAGAIN)
                 /* fd was set to non-blocking and no data was available */
@@ -217,7 +237,9 @@ int GdbServerSocketUnix::ReadByte(void) {
             avr_warning("incomplete read\n");
             continue;
         }
-        return c;
+        readLen = res;
+        readPos = 1;
+        return (unsigned char)readBuf[0];
     }
     avr_error("Maximum read reties reached");
 
@@ -240,6 +262,9 @@ void GdbServerSocketUnix::Write(const void* buf, size_t count) {
 }
 
 void GdbServerSocketUnix::SetBlockingMode(int mode) {
+    if(mode == blockingMode)
+        return;
+    blockingMode = mode;
     if(mode) {
         /* turn non-blocking mode off */
         if(fcntl(conn, F_SETFL, fcntl(conn, F_GETFL, 0) & ~O_NONBLOCK) < 0)
@@ -272,6 +297,8 @@ bool GdbServerSocketUnix::Connect(void) {
         processing. */
         fprintf(stderr, "Connection opened by host %s, port %hu.\n",
                 inet_ntoa(address->sin_addr), ntohs(address->sin_port));
+        blockingMode = -1;
+        readPos = readLen = 0;
 
         return true;
     } else
@@ -281,6 +308,7 @@ bool GdbServerSocketUnix::Connect(void) {
 void GdbServerSocketUnix::CloseConnection(void) {
     close(conn);
     conn = -1;
+    readPos = readLen = 0;
 }
 
 #endif
@@ -294,6 +322,9 @@ GdbServer::GdbServer(AvrDevice *c, int _port, int debug, int _waitForGdbConnecti
     last_reply = NULL; //init static var for last_reply()
     runMode = GDB_RET_NOTHING_RECEIVED;
     lastCoreStepFinished = true;
+    pollCountdown = 0;
+    ackPending = false;
+    noAckMode = false;
     connState = false;
     m_gdb_thread_id = 1;  // we start with the first thread already created
 
@@ -326,35 +357,32 @@ bool GdbServer::avr_core_flash_read(int addr, word& val ) {
     return false;
 }
 
-void GdbServer::avr_core_flash_write(int addr, word val) {
-    if((addr + 1) >= (int)core->Flash->GetSize())
-        avr_error("try to write in flash after last valid address!");
-    core->Flash->WriteMemByte(val & 0xff, addr + 1);
-    core->Flash->WriteMemByte((val >> 8) & 0xff, addr);
-    core->Flash->Decode(addr);
-}
-
-void GdbServer::avr_core_flash_write_hi8(int addr, byte val) {
-    if(addr >= (int)core->Flash->GetSize())
-        avr_error("try to write in flash after last valid address! (hi8)");
-    core->Flash->WriteMemByte(val, addr);
-    core->Flash->Decode();
+/*! Write bytes in gdb byte order (low byte of a word first) to flash and
+decode the changed instructions once. Returns false, if range is outside of
+flash. */
+bool GdbServer::avr_core_flash_write(unsigned int addr, const byte *data, int len) {
+    if(len <= 0)
+        return true;
+    if(addr >= core->Flash->GetSize() || (unsigned int)len > core->Flash->GetSize() - addr)
+        return false;
+    for(int i = 0; i < len; i++)
+        core->Flash->WriteMemByte(data[i], (addr + i) ^ 1);
+    core->Flash->Decode(addr & ~1, ((addr + len + 1) & ~1) - (addr & ~1));
+    return true;
 }
 
-void GdbServer::avr_core_flash_write_lo8(int addr, byte val) {
-    if(addr + 1 >= (int)core->Flash->GetSize())
-        avr_error("try to write in flash after last valid address! (lo8)");
-    core->Flash->WriteMemByte(val, addr + 1);
-    core->Flash->Decode();
+//! Erase a flash range, erased flash is decoded as invalid instruction
+bool GdbServer::avr_core_flash_erase(unsigned int addr, int len) {
+    std::vector<byte> erased(len > 0 ? len : 0, 0xff);
+    return avr_core_flash_write(addr, erased.empty() ? NULL : &erased[0], len);
 }
 
 void GdbServer::avr_core_remove_breakpoint(dword pc) {
-    Breakpoints::iterator ii;
-    if ((ii= find(core->BP.begin(), core->BP.end(), pc)) != core->BP.end()) core->BP.erase(ii);
+    core->BP.Remove(pc);
 }
 
 void GdbServer::avr_core_insert_breakpoint(dword pc) {
-    core->BP.push_back(pc);
+    core->BP.Add(pc);
 }
 
 int GdbServer::signal_has_occurred(int signo) {return 0;}
@@ -403,20 +431,34 @@ const char* GdbServer::gdb_last_reply( const char *reply )
     return last_reply;
 }
 
-//! Acknowledge a packet from GDB
+/*! Acknowledge a packet from GDB. The ack is sent together with the reply
+in one write, see gdb_flush_ack. */
 void GdbServer::gdb_send_ack( )
 {
+    if (noAckMode)
+        return;
+
     if (global_debug_on)
         fprintf( stderr, " Ack -> gdb\n");
 
-    server->Write( "+", 1 );
+    ackPending = true;
+}
+
+//! Send a pending ack, if the packet has no reply
+void GdbServer::gdb_flush_ack( )
+{
+    if (ackPending)
+    {
+        ackPending = false;
+        server->Write( "+", 1 );
+    }
 }
 
 //! Send a reply to GDB.
 void GdbServer::gdb_send_reply( const char *reply )
 {
     int cksum = 0;
-    int bytes;
+    std::string out;
 
     /* Save the reply to last reply so we can resend if need be. */
     gdb_last_reply( reply );
@@ -424,44 +466,84 @@ void GdbServer::gdb_send_reply( const char *reply )
     if (global_debug_on)
         fprintf( stderr, "Sent: $%s#", reply );
 
-    if (*reply == '\0')
+    if (ackPending)
     {
-        server->Write( "$#00", 4 );
-
-        if (global_debug_on)
-            fprintf( stderr, "%02x\n", cksum & 0xff );
+        out = "+";
+        ackPending = false;
     }
-    else
+    out += '$';
+    while (*reply)
     {
-        memset( buf, '\0', sizeof(buf) );
+        cksum += (unsigned char)*reply;
+        out += *reply++;
+    }
 
-        buf[0] = '$';
-        bytes = 1;
+    if (global_debug_on)
+        fprintf( stderr, "%02x\n", cksum & 0xff );
 
-        while (*reply)
-        {
-            cksum += (unsigned char)*reply;
-            buf[bytes] = *reply;
-            bytes++;
-            reply++;
+    out += '#';
+    out += HEX_DIGIT[(cksum >> 4) & 0xf];
+    out += HEX_DIGIT[cksum & 0xf];
 
-            /* must account for "#cc" to be added */
-            if (bytes == (sizeof(buf) - 3))
-            {
-                /* FIXME: TRoth 2002/02/18 - splitting reply would be better */
-                avr_error( "buffer overflow" );
-            }
-        }
+    /* one write for the whole packet, see GdbServerSocketUnix::Connect */
+    server->Write( out.data(), out.size() );
+}
 
-        if (global_debug_on)
-            fprintf( stderr, "%02x\n", cksum & 0xff );
+/*! Send a part of data as reply to a qXfer read request, pkt points to
+"<offset>,<length>" of the request. */
+void GdbServer::gdb_send_xfer(const std::string &data, const char *pkt)
+{
+    unsigned int offset = 0;
+    int len = 0;
 
-        buf[bytes++] = '#';
-        buf[bytes++] = HEX_DIGIT[(cksum >> 4) & 0xf];
-        buf[bytes++] = HEX_DIGIT[cksum & 0xf];
+    gdb_get_addr_len( pkt, ',', '\0', &offset, &len );
+    if (offset >= data.size())
+    {
+        gdb_send_reply( "l" );
+        return;
+    }
+    std::string part = data.substr( offset, len );
+    part.insert( 0, (offset + part.size() < data.size()) ? "m" : "l" );
+    gdb_send_reply( part.c_str() );
+}
+
+/*! Memory map for gdb: flash is programmed with vFlashErase, vFlashWrite and
+vFlashDone, data memory and eeprom are written with X or M packets.
 
-        server->Write( buf, bytes );
+gdb doesn't write a flash region with X or M, so "set var" on flash is refused
+by gdb, while load works. gdb_write_memory_bytes still accepts flash addresses
+for debuggers, which don't ask for the memory map. */
+std::string GdbServer::gdb_memory_map()
+{
+    char region[200];
+    std::string map = "<?xml version=\"1.0\"?>\n"
+                      "<!DOCTYPE memory-map PUBLIC \"+//IDN gnu.org//DTD GDB Memory Map V1.0//EN\" "
+                      "\"http://sourceware.org/gdb/gdb-memory-map.dtd\">\n"
+                      "<memory-map>\n";
+    unsigned int blocksize = core->spmRegister ? core->spmRegister->GetPageSize() * 2 : 2;
+
+    snprintf( region, sizeof(region),
+              "  <memory type=\"flash\" start=\"0x%x\" length=\"0x%x\">\n"
+              "    <property name=\"blocksize\">0x%x</property>\n"
+              "  </memory>\n",
+              FLASH_OFFSET, core->Flash->GetSize(), blocksize );
+    map += region;
+    /* data memory is read as 0 beyond the end, so the whole 64k are mapped */
+    snprintf( region, sizeof(region),
+              "  <memory type=\"ram\" start=\"0x%x\" length=\"0x10000\"/>\n", SRAM_OFFSET );
+    map += region;
+    if (core->eeprom && core->eeprom->GetSize() > 0)
+    {
+        snprintf( region, sizeof(region),
+                  "  <memory type=\"ram\" start=\"0x%x\" length=\"0x%x\"/>\n",
+                  EEPROM_OFFSET, core->eeprom->GetSize() );
+        map += region;
     }
+    snprintf( region, sizeof(region),
+              "  <memory type=\"ram\" start=\"0x%x\" length=\"0x3\"/>\n", SIGNATURE_OFFSET );
+    map += region;
+    map += "</memory-map>\n";
+    return map;
 }
 
 void GdbServer::gdb_send_hex_reply(const char *reply, const char *reply_to_encode)
@@ -499,7 +581,7 @@ void GdbServer::gdb_read_registers( )
     /* 32 gen purpose working registers */
     for ( i=0; i<32; i++ )
     {
-        val = current ? core->GetCoreReg(i) : nonrunning->registers[i];
+        val = current ? core->GetRWMemDebug(i) : nonrunning->registers[i];
         buf[i*2]   = HEX_DIGIT[(val >> 4) & 0xf];
         buf[i*2+1] = HEX_DIGIT[val & 0xf];
     }
@@ -556,7 +638,7 @@ void GdbServer::gdb_write_registers(const char *pkt) {
     {
         bval  = hex2nib(*pkt++) << 4;
         bval += hex2nib(*pkt++);
-        core->SetCoreReg(i, bval);
+        core->SetRWMemDebug(i, bval);
 
     }
 
@@ -636,7 +718,7 @@ void GdbServer::gdb_read_register(const char *pkt) {
 
     if ( (reg >= 0) && (reg < 32) )
     {                           /* general regs */
-        byte val = core->GetCoreReg(reg);
+        byte val = core->GetRWMemDebug(reg);
         snprintf(reply, sizeof(reply), "%02x", val);
     }
     else if (reg == 32)         /* sreg */
@@ -692,7 +774,7 @@ void GdbServer::gdb_write_register(const char *pkt) {
             *(core->status)=val&0xff;
         }
         else
-            core->SetCoreReg(reg, val & 0xff);
+            core->SetRWMemDebug(reg, val & 0xff);
     }
     else if (reg == 33)
     {
@@ -804,7 +886,7 @@ void GdbServer::gdb_read_memory(const char *pkt) {
         {
             for ( i=0; i<len; i++ )
             {
-                uint8_t bval = core->GetRWMem(addr + i);
+                uint8_t bval = core->GetRWMemDebug(addr + i);
                 buf[i*2]   = HEX_DIGIT[bval >> 4];
                 buf[i*2+1] = HEX_DIGIT[bval & 0xf];
             }
@@ -821,7 +903,7 @@ void GdbServer::gdb_read_memory(const char *pkt) {
         {
             word val;
 
-            if ( avr_core_flash_read( addr, val ) )
+            if ( avr_core_flash_read( addr - 1, val ) )
             {
                 val >>=8;
                 buf[i++] = HEX_DIGIT[val >> 4];
@@ -867,7 +949,7 @@ void GdbServer::gdb_read_memory(const char *pkt) {
             {
                 byte bval;
 
-                bval &= 0xff;
+                bval = val & 0xff;
                 buf[i++] = HEX_DIGIT[bval >> 4];
                 buf[i++] = HEX_DIGIT[bval & 0xf];
             }
@@ -903,29 +985,70 @@ void GdbServer::gdb_read_memory(const char *pkt) {
 void GdbServer::gdb_write_memory(const char *pkt) {
     unsigned int addr = 0;
     int  len  = 0;
-    byte bval;
-    unsigned int  i;
     char reply[10];
 
+    pkt += gdb_get_addr_len( pkt, ',', ':', &addr, &len );
+
+    std::vector<byte> data( len > 0 ? len : 0 );
+    for ( int i = 0; i < len; i++ )
+    {
+        data[i]  = hex2nib(*pkt++) << 4;
+        data[i] += hex2nib(*pkt++);
+    }
+
     /* Set the default reply. */
     strncpy( reply, "OK", sizeof(reply) );
+    if ( !gdb_write_memory_bytes( addr, data.empty() ? NULL : &data[0], len ) )
+        snprintf( reply, sizeof(reply), "E%02x", EIO );
 
-    pkt += gdb_get_addr_len( pkt, ',', ':', &addr, &len );
+    gdb_send_reply( reply );
+}
+
+/*! Write memory with binary data, packet form: 'Xaddr,length:XX...', data
+is escaped, see gdb_unescape_binary. A packet with length 0 is used by gdb
+to detect support of this packet. */
+void GdbServer::gdb_write_memory_binary(const char *pkt, int pktlen) {
+    unsigned int addr = 0;
+    int  len  = 0;
+    char reply[10];
+
+    int n = gdb_get_addr_len( pkt, ',', ':', &addr, &len );
+
+    std::vector<byte> data( pktlen - n + 1 );
+    int size = gdb_unescape_binary( pkt + n, pktlen - n, &data[0] );
+
+    strncpy( reply, "OK", sizeof(reply) );
+    if ( size != len || !gdb_write_memory_bytes( addr, &data[0], len ) )
+        snprintf( reply, sizeof(reply), "E%02x", EIO );
+
+    gdb_send_reply( reply );
+}
 
+/*! Decode binary data of X and vFlashWrite packets: 0x7d escapes the next
+byte, which is xor'ed with 0x20. Returns count of bytes in dst. */
+int GdbServer::gdb_unescape_binary(const char *src, int srclen, byte *dst) {
+    int n = 0;
 
+    for ( int i = 0; i < srclen; i++ )
+    {
+        if ( src[i] == 0x7d && i + 1 < srclen )
+            dst[n++] = src[++i] ^ 0x20;
+        else
+            dst[n++] = src[i];
+    }
+    return n;
+}
+
+//! Write len bytes to memory at gdb address addr, returns false on invalid address
+bool GdbServer::gdb_write_memory_bytes(unsigned int addr, const byte *data, int len) {
     if ( (addr & MEM_SPACE_MASK) == EEPROM_OFFSET )
     {
         /* addressing eeprom */
 
         addr = addr & ~MEM_SPACE_MASK; /* remove the offset bits */
 
-        while (len>0) {
-            bval  = hex2nib(*pkt++) << 4;
-            bval += hex2nib(*pkt++);
-            len--;
-            core->eeprom->WriteAtAddress(addr, bval);
-            addr++;
-        }
+        for ( int i = 0; i < len; i++ )
+            core->eeprom->WriteAtAddress(addr + i, data[i]);
     }
     else if ( (addr & MEM_SPACE_MASK) == SRAM_OFFSET )
     {
@@ -933,73 +1056,70 @@ void GdbServer::gdb_write_memory(const char *pkt) {
 
         addr = addr & ~MEM_SPACE_MASK; /* remove the offset bits */
 
-        /* Return error. See gdb_read_memory for reasoning. */
-        /* FIXME: [TRoth 2002/03/31] This isn't working quite the way I
-        thought it would so I've removed it for now.*/
-        /* if ( (addr >= 0) && (addr < 32) ) */
-        if (0)
-        {
-            snprintf( reply, sizeof(reply), "E%02x", EIO );
-        }
-        else
-        {
-            for ( i=addr; i < addr+len; i++ )
-            {
-                bval  = hex2nib(*pkt++) << 4;
-                bval += hex2nib(*pkt++);
-                core->SetRWMem(i, bval);
-            }
-        }
+        for ( int i = 0; i < len; i++ )
+            core->SetRWMemDebug(addr + i, data[i]);
     }
     else if ( (addr & MEM_SPACE_MASK) < SRAM_OFFSET)
     {
         /* addressing flash */
 
-        if (addr % 2)
-        {
-            bval  = hex2nib(*pkt++) << 4;
-            bval += hex2nib(*pkt++);
-            avr_core_flash_write_hi8(addr, bval);
-            len--;
-            addr++;
-        }
-
-        while (len > 1)
+        if ( !avr_core_flash_write( addr, data, len ) )
         {
-            word wval;
-            wval  = hex2nib(*pkt++) << 4; /* low byte first */
-            wval += hex2nib(*pkt++);
-            wval += hex2nib(*pkt++) << 12; /* high byte last */
-            wval += hex2nib(*pkt++) << 8;
-            avr_core_flash_write( addr, wval);
-            len  -= 2;
-            addr += 2;
-        }
-
-        if ( len == 1 )
-        {
-            /* one more byte to write */
-            bval  = hex2nib(*pkt++) << 4;
-            bval += hex2nib(*pkt++);
-            avr_core_flash_write_lo8( addr, bval );
+            avr_warning( "Invalid flash address: 0x%x.\n", addr );
+            return false;
         }
     }
     else if ( (addr & MEM_SPACE_MASK) == SIGNATURE_OFFSET && len >= 3)
     {
-        int sig3 = (hex2nib(*pkt++) << 4); sig3 += hex2nib(*pkt++);
-        int sig2 = (hex2nib(*pkt++) << 4); sig2 += hex2nib(*pkt++);
-        int sig1 = (hex2nib(*pkt++) << 4); sig1 += hex2nib(*pkt++);
         if (global_debug_on)
-            fprintf(stderr, "Device signature %02x %02x %02x\n", sig1, sig2, sig3);
+            fprintf(stderr, "Device signature %02x %02x %02x\n", data[2], data[1], data[0]);
     }
     else
     {
         /* gdb asked for memory space which doesn't exist */
         avr_warning( "Invalid memory address: 0x%x.\n", addr );
-        snprintf( reply, sizeof(reply), "E%02x", EIO );
+        return false;
     }
 
-    gdb_send_reply( reply );
+    return true;
+}
+
+/*! Flash programming packets, used by gdb for load into the flash region of
+the memory map:
+
+vFlashErase:addr,length
+vFlashWrite:addr:XX... (binary data, escaped like in X packet)
+vFlashDone */
+void GdbServer::gdb_flash_packet(const char *pkt, int pktlen) {
+    unsigned int addr = 0;
+    int len = 0;
+    bool ok = true;
+
+    if ( strncmp( pkt, "vFlashErase:", 12 ) == 0 )
+    {
+        gdb_get_addr_len( pkt + 12, ',', '\0', &addr, &len );
+        ok = avr_core_flash_erase( addr, len );
+    }
+    else if ( strncmp( pkt, "vFlashWrite:", 12 ) == 0 )
+    {
+        const char *p = pkt + 12;
+        while ( p < pkt + pktlen && *p != ':' )
+            addr = (addr << 4) + hex2nib(*p++);
+        if ( p < pkt + pktlen )
+            p++;                /* skip over ':' */
+        std::vector<byte> data( pkt + pktlen - p + 1 );
+        len = gdb_unescape_binary( p, pkt + pktlen - p, &data[0] );
+        ok = avr_core_flash_write( addr, &data[0], len );
+    }
+    else if ( strcmp( pkt, "vFlashDone" ) != 0 )
+    {
+        gdb_send_reply( "" );
+        return;
+    }
+
+    if ( !ok )
+        avr_warning( "Invalid flash address: 0x%x.\n", addr );
+    gdb_send_reply( ok ? "OK" : "E01" );
 }
 
 /*! Format of breakpoint commands (both insert and remove):
@@ -1064,24 +1184,26 @@ void GdbServer::gdb_break_point(const char *pkt) {
             break;
 
         case '2':               /* write watchpoint */
-            //cout << "Try to set a watchpoint" << endl;
-            //cout << "at address :" << addr << " with len " << len << endl;
-            gdb_send_reply( "" );
-            return;
-            break;
-
         case '3':               /* read watchpoint */
-            //cout << "Try to set a read watchpoint" << endl;
-            //cout << "at address :" << addr << " with len " << len << endl;
-            gdb_send_reply( "" );
-            return;
-            break;
-
         case '4':               /* access watchpoint */
-            //cout << "try to set a access watchpoint" << endl;
-            //cout << "at address :" << addr << " with len " << len << endl;
-            gdb_send_reply( "" );
-            return;             /* unsupported yet */
+            /* Watchpoints only on data memory, flash and eeprom aren't
+               written by normal instructions. */
+            if ( (addr & MEM_SPACE_MASK) != SRAM_OFFSET || len <= 0 )
+            {
+                gdb_send_reply( "E01" );
+                return;
+            }
+            addr = addr & ~MEM_SPACE_MASK; /* remove the offset bits */
+
+            if (z == 'z')
+                core->RemoveWatchpoint( addr, len, t - '0' );
+            else if ( !core->AddWatchpoint( addr, len, t - '0' ) )
+            {
+                avr_warning( "Attempt to set watchpoint at invalid addr\n" );
+                gdb_send_reply( "E01" );
+                return;
+            }
+            break;
     }
 
     gdb_send_reply( "OK" );
@@ -1194,10 +1316,11 @@ int GdbServer::gdb_get_signal(const char *pkt) {
     return signo;
 }
 
-/*! Parse the packet. Assumes that packet is null terminated.
+/*! Parse the packet. Assumes that packet is null terminated, pktlen is the
+length of packet, which may contain binary data with null bytes.
 Return GDB_RET_KILL_REQUEST if packet is 'kill' command,
 GDB_RET_OK otherwise. */
-int GdbServer::gdb_parse_packet(const char *pkt) {
+int GdbServer::gdb_parse_packet(const char *pkt, int pktlen) {
     switch (*pkt++) {
         case '?':               /* last signal */
             gdb_send_reply("S05"); /* signal # 5 is SIGTRAP */
@@ -1233,6 +1356,34 @@ int GdbServer::gdb_parse_packet(const char *pkt) {
             gdb_write_memory(pkt);
             break;
 
+        case 'X':               /* write memory with binary data */
+            gdb_write_memory_binary(pkt, pktlen - 1);
+            break;
+
+        case 'v':               /* flash programming */
+            pkt--;
+            if(strncmp(pkt, "vFlash", 6) == 0) {
+                gdb_flash_packet(pkt, pktlen);
+                return GDB_RET_OK;
+            }
+            if(global_debug_on)
+                fprintf(stderr, "gdb command '%s' not supported\n", pkt);
+            gdb_send_reply("");
+            break;
+
+        case 'Q':               /* set requests */
+            pkt--;
+            if(strcmp(pkt, "QStartNoAckMode") == 0) {
+                // this packet is acknowledged, all following packets not
+                gdb_send_reply("OK");
+                noAckMode = true;
+                return GDB_RET_OK;
+            }
+            if(global_debug_on)
+                fprintf(stderr, "gdb command '%s' not supported\n", pkt);
+            gdb_send_reply("");
+            break;
+
         case 'D':               /* detach the debugger */
         case 'k':               /* kill request */
             /* Reset the simulator since there may be another connection
@@ -1281,17 +1432,19 @@ int GdbServer::gdb_parse_packet(const char *pkt) {
         case 'q':               /* query requests */
             pkt--;
             if(memcmp(pkt, "qSupported", 10) == 0) {
-                gdb_send_reply("PacketSize=800;qXfer:features:read+");
+                gdb_send_reply("PacketSize=1000;qXfer:features:read+;qXfer:memory-map:read+;QStartNoAckMode+");
                 return GDB_RET_OK;
             } else if(memcmp(pkt, "qXfer:features:read:target.xml:", 31) == 0) {
                 // GDB XML target descriptions, since GDB 6.7 (2007-10-10)
                 // see http://sources.redhat.com/gdb/current/onlinedocs/gdb/Target-Descriptions.html
-                gdb_send_reply("l"
-                               "<?xml version=\"1.0\"?>\n"
-                               "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">\n"
-                               "<target version=\"1.0\">\n"
-                               "    <architecture>avr</architecture>\n"
-                               "</target>\n");
+                gdb_send_xfer("<?xml version=\"1.0\"?>\n"
+                              "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">\n"
+                              "<target version=\"1.0\">\n"
+                              "    <architecture>avr</architecture>\n"
+                              "</target>\n", pkt + 31);
+                return GDB_RET_OK;
+            } else if(memcmp(pkt, "qXfer:memory-map:read::", 23) == 0) {
+                gdb_send_xfer(gdb_memory_map(), pkt + 23);
                 return GDB_RET_OK;
             } else if(strcmp(pkt, "qC") == 0) {
                 int thread_id = core->stack->m_ThreadList.GetCurrentThreadForGDB();
@@ -1368,10 +1521,12 @@ int GdbServer::gdb_receive_and_process_packet(int blocking) {
             if(global_debug_on)
                 fprintf(stderr, "Recv: \"$%s#%02x\"\n", pkt_buf.c_str(), cksum);
 
-            /* always acknowledge a well formed packet immediately */
+            /* always acknowledge a well formed packet, the ack is sent
+            together with the reply */
             gdb_send_ack();
 
-            res = gdb_parse_packet(pkt_buf.c_str());
+            res = gdb_parse_packet(pkt_buf.c_str(), pkt_buf.size());
+            gdb_flush_ack();
             if(res < 0)
                 return res;
 
@@ -1504,9 +1659,14 @@ int GdbServer::InternalStep(bool &untilCoreStepFinished, SystemClockOffset *time
     //cout << "Internal Step entered" << endl;
     //cout << "RunMode: " << dec << runMode << endl;
 
-    if (lastCoreStepFinished) {
+    /* While running, gdb is asked for packets only every POLL_STEPS core
+    steps, so a ctrl-c is processed a bit later. Break- and watchpoints stop
+    the core immediately. */
+    if (lastCoreStepFinished && (runMode != GDB_RET_CONTINUE || --pollCountdown <= 0)) {
         bool leave;
 
+        pollCountdown = POLL_STEPS;
+
         do {
             //cout << "Loop" << endl;
             int gdbRet=gdb_receive_and_process_packet((runMode==GDB_RET_CONTINUE) ? GDB_BLOCKING_OFF : GDB_BLOCKING_ON);
@@ -1539,7 +1699,13 @@ int GdbServer::InternalStep(bool &untilCoreStepFinished, SystemClockOffset *time
                     core->Reset();
                     server->CloseConnection();   //we are not longer connected
                     connState = false;
+                    noAckMode = false;
                     core->DeleteAllBreakpoints();
+                    core->DeleteAllWatchpoints();
+                    core->SetSingleStep(false);
+                    // stay in simulation to accept the next connection
+                    if (timeToNextStepIn_ns != 0)
+                        *timeToNextStepIn_ns = core->GetClockFreq();
                     return 0; 
             } //end switch GDB_RETURN_VALUE
 
@@ -1563,10 +1729,11 @@ int GdbServer::InternalStep(bool &untilCoreStepFinished, SystemClockOffset *time
 
     } //last core step finished
 
+    core->SetSingleStep(runMode == GDB_RET_SINGLE_STEP);
     int res=core->Step(untilCoreStepFinished, timeToNextStepIn_ns);
     lastCoreStepFinished=untilCoreStepFinished;
 
-    if (res == BREAK_POINT) {
+    if (res == BREAK_POINT || res == WATCH_POINT) {
         runMode=GDB_RET_OK; //we will stop next call from GdbServer::Step
         SendPosition(GDB_SIGTRAP);
     }
@@ -1602,6 +1769,15 @@ void GdbServer::SendPosition(int signo) {
 
     bytes = snprintf(reply, sizeof(reply), "T%02x", signo);
 
+    /* stop reason of a watchpoint, address in gdb address space */
+    int kind;
+    unsigned int addr;
+    if (core->GetWatchHit(kind, addr)) {
+        static const char *reasons[] = { "watch", "rwatch", "awatch" };
+        bytes += snprintf(reply + bytes, sizeof(reply) - bytes, "%s:%x;",
+                          reasons[kind - AvrDevice::WATCH_WRITE], addr | SRAM_OFFSET);
+    }
+
     /* SREG, SP & PC */
     snprintf(reply + bytes, sizeof(reply) - bytes,
             "20:%02x;" "21:%02x%02x;" "22:%02x%02x%02x%02x;" "thread:%d;",
@@ -0,0 +1,318 @@
+/*
+ ****************************************************************************
+ *
+ * simulavr - A simulator for the Atmel AVR family of microcontrollers.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ ****************************************************************************
+ *
+ *  $Id$
+ */
+
+/* Renders a binary instruction trace (see InstructionTrace in instrtrace.h)
+   as text, like option -t does, optional only for some address ranges or
+   functions.
+
+   The mnemonics and the register values in the text are made by Trace() of
+   the instructions on a second device, which has loaded the same program.
+   Before each instruction this device gets the recorded state of registers,
+   SREG, stack pointer and written RAM, so the text is the same as with -t.
+   Values read from IO registers come from this device and may differ. */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <stdlib.h>
+#include <string.h>
+using namespace std;
+
+#include "avrdevice.h"
+#include "avrfactory.h"
+#include "avrerror.h"
+#include "flash.h"
+#include "hwsreg.h"
+#include "hwstack.h"
+#include "helper.h"
+#include "instrtrace.h"
+
+static void fail(const string &msg) {
+    cerr << "itrace2txt: " << msg << endl;
+    exit(1);
+}
+
+//! Range of word addresses, from is included, to not
+struct AddressRange {
+    unsigned int from;
+    unsigned int to;
+};
+
+//! Renders events with a device, which replays the recorded state
+class TraceRenderer {
+
+    public:
+        TraceRenderer(AvrDevice *_dev, ostream &_os, const string &_program, const vector<AddressRange> &_ranges):
+            dev(_dev), os(_os), program(_program), ranges(_ranges), sp(0) {}
+
+        //! Render a event record, called before the deltas of this event are applied
+        void Event(const InstructionTraceRecord &r, unsigned long long nextCycle) {
+            unsigned int pc = r.event.pc;
+            if(r.event.kind == InstructionTrace::SYNC || !Selected(pc))
+                return;
+            switch(r.event.kind) {
+                case InstructionTrace::INSTRUCTION:
+                    Prefix(pc);
+                    Execute(pc, r.event.opcode);
+                    os << endl;
+                    break;
+                case InstructionTrace::IRQ:
+                    Prefix(pc);
+                    os << "IRQ DETECTED: VectorAddr: " << r.event.opcode;
+                    SaveState();
+                    dev->stack->PushAddr(pc);
+                    RestoreState();
+                    os << endl;
+                    break;
+                case InstructionTrace::WAKEUP:
+                    Prefix(pc);
+                    os << "CPU-wakeup" << endl;
+                    break;
+                case InstructionTrace::SLEEP:
+                    for(unsigned long long c = r.event.cycle; c == r.event.cycle || c < nextCycle; c++) {
+                        Prefix(pc);
+                        os << "CPU-sleep" << endl;
+                    }
+                    break;
+                case InstructionTrace::HOLD:
+                    Prefix(pc);
+                    os << "CPU-Hold by IO-Hardware " << endl;
+                    break;
+                default:
+                    fail("invalid record in trace");
+            }
+            for(int i = 0; i < r.event.waitstates; i++) {
+                Prefix(pc);
+                os << "CPU-waitstate" << endl;
+            }
+        }
+
+        //! Apply recorded changes
+        void Delta(const InstructionTraceRecord &r) {
+            for(int i = 0; i < r.delta.count && i < 4; i++) {
+                unsigned int addr = r.delta.addr[i];
+                unsigned char val = r.delta.value[i];
+                if(addr == InstructionTrace::SREG)
+                    *dev->status = val;
+                else if(addr == InstructionTrace::SP_LOW)
+                    sp = (sp & ~0xffUL) | val;
+                else if(addr == InstructionTrace::SP_HIGH)
+                    sp = (sp & ~0xff00UL) | (val << 8);
+                else if(addr < dev->GetMemRegisterSize())
+                    dev->SetCoreReg(addr, val);
+                else if(addr < dev->GetMemTotalSize() && dev->rw.IsPlain(addr))
+                    dev->rw.image[addr] = val;
+                // changes on IO registers are ignored, they would trigger hardware
+            }
+            dev->stack->SetStackPointer(sp);
+        }
+
+    private:
+        AvrDevice *dev;
+        ostream &os;
+        string program;
+        const vector<AddressRange> &ranges;
+        unsigned long sp;            //!< recorded stack pointer
+        unsigned char regs[32];      //!< saved register file
+        unsigned char sreg;          //!< saved SREG
+
+        bool Selected(unsigned int pc) const {
+            if(ranges.empty())
+                return true;
+            for(size_t i = 0; i < ranges.size(); i++)
+                if(pc >= ranges[i].from && pc < ranges[i].to)
+                    return true;
+            return false;
+        }
+
+        //! Same start of line as in AvrDevice::Step
+        void Prefix(unsigned int pc) {
+            os << program << " ";
+            os << HexShort(pc << 1) << dec << ": ";
+            string sym(dev->Flash->GetSymbolAtAddress(pc));
+            os << sym << " ";
+            for(int len = sym.length(); len < 30; len++)
+                os << " ";
+        }
+
+        void SaveState(void) {
+            for(int i = 0; i < 32; i++)
+                regs[i] = dev->GetCoreReg(i);
+            sreg = (int)*dev->status;
+        }
+
+        //! Reset the state changed by the device, the deltas in trace follow
+        void RestoreState(void) {
+            for(int i = 0; i < 32; i++)
+                dev->SetCoreReg(i, regs[i]);
+            *dev->status = sreg;
+            dev->stack->SetStackPointer(sp);
+        }
+
+        void Execute(unsigned int pc, unsigned int opcode) {
+            if((pc << 1) >= dev->Flash->GetSize())
+                fail("PC in trace is outside of flash");
+            if(dev->Flash->ReadMemRawWord(pc << 1) != opcode) {
+                // flash was changed by SPM, load the recorded instruction
+                unsigned char w[2] = { (unsigned char)(opcode & 0xff), (unsigned char)(opcode >> 8) };
+                dev->Flash->WriteMem(w, pc << 1, 2);
+            }
+            SaveState();
+            dev->PC = pc;
+            dev->Flash->GetInstruction(pc)->Trace(dev);
+            RestoreState();
+        }
+};
+
+static void usage(void) {
+    cerr << "usage: itrace2txt [-d <device>] [-f <file>] [-a <from>,<to>] [-s <symbol>] <trace-file> [<text-file>|-]\n"
+            "  -d <device>       device name, default is taken from trace\n"
+            "  -f <file>         elf file of program, default is taken from trace\n"
+            "  -a <from>,<to>    render only instructions on flash addresses from <from> up to\n"
+            "                    <to> (excluded), hex byte addresses like in text trace\n"
+            "  -s <symbol>       render only instructions from <symbol> up to next symbol\n"
+            "  -a and -s can be given multiple times\n";
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    string device, program;
+    vector<string> rangeArgs, symbolArgs, files;
+    for(int i = 1; i < argc; i++) {
+        string a = argv[i];
+        if(a == "-d" && i + 1 < argc)
+            device = argv[++i];
+        else if(a == "-f" && i + 1 < argc)
+            program = argv[++i];
+        else if(a == "-a" && i + 1 < argc)
+            rangeArgs.push_back(argv[++i]);
+        else if(a == "-s" && i + 1 < argc)
+            symbolArgs.push_back(argv[++i]);
+        else if(a[0] == '-' && a != "-")
+            usage();
+        else
+            files.push_back(a);
+    }
+    if(files.size() < 1 || files.size() > 2)
+        usage();
+
+    // read trace
+    ifstream is(files[0].c_str(), ios::in | ios::binary);
+    if(!is.is_open())
+        fail("can't open '" + files[0] + "'");
+    InstructionTraceHeader header;
+    is.read((char *)&header, sizeof(header));
+    if(is.gcount() != sizeof(header) || memcmp(header.magic, "SAVRITR1", 8) != 0)
+        fail("'" + files[0] + "' isn't a simulavr instruction trace");
+    if(header.byteOrder != 0x01020304 || header.recordSize != sizeof(InstructionTraceRecord))
+        fail("trace is written on a host with other byte order");
+    vector<InstructionTraceRecord> ring(header.capacity);
+    is.read((char *)&ring[0], header.capacity * sizeof(InstructionTraceRecord));
+    if((unsigned long long)is.gcount() != header.capacity * sizeof(InstructionTraceRecord))
+        fail("trace file is truncated");
+    header.device[sizeof(header.device) - 1] = 0;
+    header.program[sizeof(header.program) - 1] = 0;
+    string traceProgram(header.program);
+    if(device.empty())
+        device = header.device;
+    if(program.empty())
+        program = traceProgram;
+
+    // device for rendering
+    AvrDevice *dev = AvrFactory::instance().makeDevice(device.c_str());
+    dev->Load(program.c_str());
+    dev->SetClockFreq(header.clockPeriod);
+    dev->trace_on = 1;
+
+    // address ranges
+    vector<AddressRange> ranges;
+    for(size_t i = 0; i < rangeArgs.size(); i++) {
+        AddressRange r;
+        char *end;
+        r.from = strtoul(rangeArgs[i].c_str(), &end, 16) >> 1;
+        if(*end != ',')
+            usage();
+        r.to = strtoul(end + 1, &end, 16) >> 1;
+        if(*end != 0)
+            usage();
+        ranges.push_back(r);
+    }
+    for(size_t i = 0; i < symbolArgs.size(); i++) {
+        AddressRange r;
+        r.from = dev->Flash->GetAddressAtSymbol(symbolArgs[i]);
+        multimap<unsigned int, string>::iterator ii = dev->Flash->sym.upper_bound(r.from);
+        r.to = (ii == dev->Flash->sym.end()) ? dev->Flash->GetSize() / 2 : ii->first;
+        ranges.push_back(r);
+    }
+
+    ostream *os = &cout;
+    ofstream ofs;
+    if(files.size() == 2 && files[1] != "-") {
+        ofs.open(files[1].c_str());
+        if(!ofs.is_open())
+            fail("can't open '" + files[1] + "'");
+        os = &ofs;
+    }
+    sysConHandler.SetTraceStream(os);
+    TraceRenderer renderer(dev, *os, traceProgram, ranges);
+
+    // oldest record, after ring overflow decoding starts on a SYNC event
+    unsigned long long count = header.written, pos = 0;
+    bool synced = true;
+    if(header.written > header.capacity) {
+        count = header.capacity;
+        pos = header.written % header.capacity;
+        synced = false;
+    }
+    for(unsigned long long n = 0; n < count; n++) {
+        const InstructionTraceRecord &r = ring[pos];
+        pos = (pos + 1) % header.capacity;
+        if(r.event.kind == InstructionTrace::DELTA) {
+            if(synced)
+                renderer.Delta(r);
+            continue;
+        }
+        if(r.event.kind == InstructionTrace::SYNC)
+            synced = true;
+        if(!synced)
+            continue;
+        // a sleep phase lasts till next event, if it's the last one, it's rendered for one cycle
+        unsigned long long nextCycle = r.event.cycle;
+        if(r.event.kind == InstructionTrace::SLEEP) {
+            for(unsigned long long m = n + 1, p = pos; m < count; m++, p = (p + 1) % header.capacity) {
+                if(ring[p].event.kind != InstructionTrace::DELTA) {
+                    nextCycle = ring[p].event.cycle;
+                    break;
+                }
+            }
+        }
+        renderer.Event(r, nextCycle);
+    }
+    os->flush();
+
+    return 0;
+}
@@ -57,6 +57,11 @@ using namespace std;
 #include "helper.h"
 #include "specialmem.h"
 #include "irqsystem.h"
+#include "instrtrace.h"
+#include "net.h"
+#include "adcpin.h"
+#include "simulationfork.h"
+#include "simulationcontext.h"
 
 #include "dumpargs.h"
 
@@ -89,11 +94,77 @@ const char *SplitOffsetFile(const char *arg,
     return end;
 }
 
+//! codes for options without a short option character
+enum {
+    OPT_FAST_CORE = 0x100,
+    OPT_TIMING_WHEEL,
+    OPT_BINARY_TRACE,
+    OPT_BINARY_TRACE_SIZE,
+    OPT_FIRMWARE_CACHE,
+    OPT_SAVE_STATE,
+    OPT_LOAD_STATE,
+    OPT_FORK_AT,
+    OPT_FORK_AFTER,
+    OPT_FORK_INPUT,
+    OPT_FORK_ANALOG
+};
+
+//! Run to the fork point and start a child simulation for every stimulus
+/*! Returns the number of the child in a child process. The parent waits for
+  all children, prints their results and returns -1, failed is set, if a
+  child didn't exit with 0. */
+static int ForkSimulations(AvrDevice *dev,
+                           const string &forkAt,
+                           unsigned long long forkAfter,
+                           size_t count,
+                           bool &failed)
+{
+    SystemClock &clock = SystemClock::Instance();
+    
+    // run to the fork point, breakpoint or time, what comes first
+    unsigned int addr = 0;
+    if(forkAt.size()) {
+        addr = dev->Flash->GetAddressAtSymbol(forkAt);
+        dev->BP.Add(addr);
+    }
+    if(forkAfter)
+        clock.Run(clock.GetCurrentTime() + forkAfter);
+    else if(forkAt.size())
+        clock.Run(numeric_limits<SystemClockOffset>::max());
+    if(forkAt.size())
+        dev->BP.Remove(addr);
+    avr_message("Fork %d simulations at %lld ns", (int)count, clock.GetCurrentTime());
+    
+    SimulationFork fork;
+    for(size_t i = 0; i < count; i++) {
+        if(fork.Fork())
+            return fork.GetChildIndex();
+    }
+    fork.Wait();
+    
+    failed = false;
+    for(int i = 0; i < fork.GetChildCount(); i++) {
+        int code = fork.GetExitCode(i);
+        cout << "Forked simulation " << i << ": ";
+        if(code < 0)
+            cout << "killed by signal " << -code << endl;
+        else
+            cout << "exit code " << code << endl;
+        cout << fork.GetOutput(i);
+        if(code != 0)
+            failed = true;
+    }
+    return -1;
+}
+
 const char Usage[] = 
     "AVR-Simulator Version " VERSION "\n"
     "-u                    run with user interface for external pin\n"
     "                      handling at port 7777\n"
     "-f --file <name>      load elf-file <name> for simulation in simulated target\n"
+    "   --firmware-cache <dir>\n"
+    "                      keep parsed elf files in directory <dir>, a repeated load\n"
+    "                      of the same elf file doesn't parse it again\n"
     "-d --device <name>    simulate device <name> \n"
     "-g --gdbserver        listen for GDB connection on TCP port defined by -p\n"
     "-G --gdb-debug        listen for GDB connection and write debug info\n"
@@ -105,6 +176,12 @@ const char Usage[] =
     "-l --linestotrace <number>\n"
     "                      maximum number of lines in each trace file.\n"
     "                      0 means endless. Attention: if you use gdb & trace, please use always 0!\n"
+    "   --binary-trace <file>\n"
+    "                      record executed instructions to binary trace <file>, use\n"
+    "                      itrace2txt to get the same text as with -t\n"
+    "   --binary-trace-size <number>\n"
+    "                      size of ring in binary trace, in records of 16 bytes, only\n"
+    "                      the last records are kept, default is 4194304\n"
     "-n --nogdbwait        do not wait for gdb connection\n"
     "-F --cpufrequency     set the cpu frequency to <Hz> \n"
     "-s --irqstatistic     prints statistic informations about irq usage after simulation\n"
@@ -122,7 +199,29 @@ const char Usage[] =
     "                      add a special register at IO-offset\n"
     "                      which exits simulator run\n"
     "-C --core-dump <name> dump a core memory image <name> to file on exit\n"
+    "   --save-state <file>\n"
+    "                      save the simulation state to <file> on exit\n"
+    "   --load-state <file>\n"
+    "                      continue simulation from a state in <file>, which was saved\n"
+    "                      with the same device and program by --save-state\n"
+    "   --fork-at <label> or <address>\n"
+    "                      run to <label> or <address> and then continue in forked\n"
+    "                      processes, one for each --fork-input or --fork-analog,\n"
+    "                      not available with -c, -t or --binary-trace\n"
+    "   --fork-after <nanoseconds>\n"
+    "                      same as --fork-at, but fork after <nanoseconds>\n"
+    "   --fork-input <file>\n"
+    "                      forked simulation reads the pipe register (see -R) from\n"
+    "                      <file>, one simulation is forked for each --fork-input\n"
+    "   --fork-analog <pin>,<file>\n"
+    "                      forked simulation gets analog values for <pin> from\n"
+    "                      <file>, is combined with --fork-input in the given order\n"
     "-v --verbose          output some hints to console\n"
+    "   --fast-core        process all cycles of a instruction and following register\n"
+    "                      operations in one simulation step, peripherals are caught\n"
+    "                      up cycle by cycle, gdb single steps stay exact\n"
+    "   --timing-wheel     schedule simulation members with a timing wheel instead\n"
+    "                      of a heap, faster with many devices or peripherals\n"
     "-T --terminate <label> or <address>\n"
     "                      stops simulation if PC runs on <label> or <address>\n"
     "-B --breakpoint <label> or <address>\n"
@@ -164,6 +263,15 @@ int main(int argc, char *argv[]) {
     vector<string> tracer_opts;
     bool tracer_dump_avail = false;
     string tracer_avail_out;
+    bool fastCoreMode = false;
+    string binaryTraceFile;
+    string saveStateFile;
+    string loadStateFile;
+    string forkAt;
+    unsigned long long forkAfter = 0;
+    vector<string> forkInputs;
+    vector<string> forkAnalogs;
+    unsigned long long binaryTraceSize = 4194304;
     
     while (1) {
         //int this_option_optind = optind ? optind : 1;
@@ -190,6 +298,17 @@ int main(int argc, char *argv[]) {
             {"core-dump", 1, 0, 'C'},
             {"irqstatistic", 0, 0, 's'},
             {"help", 0, 0, 'h'},
+            {"fast-core", 0, 0, OPT_FAST_CORE},
+            {"timing-wheel", 0, 0, OPT_TIMING_WHEEL},
+            {"binary-trace", 1, 0, OPT_BINARY_TRACE},
+            {"binary-trace-size", 1, 0, OPT_BINARY_TRACE_SIZE},
+            {"firmware-cache", 1, 0, OPT_FIRMWARE_CACHE},
+            {"save-state", 1, 0, OPT_SAVE_STATE},
+            {"load-state", 1, 0, OPT_LOAD_STATE},
+            {"fork-at", 1, 0, OPT_FORK_AT},
+            {"fork-after", 1, 0, OPT_FORK_AFTER},
+            {"fork-input", 1, 0, OPT_FORK_INPUT},
+            {"fork-analog", 1, 0, OPT_FORK_ANALOG},
             {0, 0, 0, 0}
         };
         
@@ -331,11 +450,73 @@ int main(int argc, char *argv[]) {
                 enableIRQStatistic = true;
                 break;
             
+            case OPT_FAST_CORE:
+                avr_message("Fast core mode enabled");
+                fastCoreMode = true;
+                break;
+            
+            case OPT_TIMING_WHEEL:
+                avr_message("Timing wheel scheduler enabled");
+                SystemClock::Instance().SetTimeTable(new TimingWheel);
+                break;
+            
+            case OPT_BINARY_TRACE:
+                avr_message("Record binary instruction trace to file: %s", optarg);
+                binaryTraceFile = optarg;
+                break;
+            
+            case OPT_BINARY_TRACE_SIZE:
+                if(!StringToUnsignedLongLong(optarg, &binaryTraceSize, NULL, 10)) {
+                    cerr << "binary trace size is not a number" << endl;
+                    exit(1);
+                }
+                break;
+            
+            case OPT_FIRMWARE_CACHE:
+                avr_message("Use firmware cache in directory: %s", optarg);
+                SimulationContext::Default().SetFirmwareCacheDirectory(optarg);
+                break;
+            
             case 'C':
                 avr_message("Write core dump on exit to file: %s", optarg);
                 coredumpfile = optarg;
                 break;
             
+            case OPT_SAVE_STATE:
+                avr_message("Save simulation state on exit to file: %s", optarg);
+                saveStateFile = optarg;
+                break;
+            
+            case OPT_LOAD_STATE:
+                avr_message("Load simulation state from file: %s", optarg);
+                loadStateFile = optarg;
+                break;
+            
+            case OPT_FORK_AT:
+                avr_message("Fork simulations at: %s", optarg);
+                forkAt = optarg;
+                break;
+            
+            case OPT_FORK_AFTER:
+                if(!StringToUnsignedLongLong(optarg, &forkAfter, NULL, 10)) {
+                    cerr << "fork time is not a number" << endl;
+                    exit(1);
+                }
+                avr_message("Fork simulations after: %lld ns", forkAfter);
+                break;
+            
+            case OPT_FORK_INPUT:
+                forkInputs.push_back(optarg);
+                break;
+            
+            case OPT_FORK_ANALOG:
+                if(string(optarg).find(',') == string::npos) {
+                    cerr << "fork-analog: argument does not have comma before filename" << endl;
+                    exit(1);
+                }
+                forkAnalogs.push_back(optarg);
+                break;
+            
             default:
                 cout << Usage
                      << "Supported devices:" << endl
@@ -395,12 +576,36 @@ int main(int argc, char *argv[]) {
         exit(1);
     }
     
+    size_t forkCount = max(forkInputs.size(), forkAnalogs.size());
+    if(forkInputs.size() && forkAnalogs.size() && forkInputs.size() != forkAnalogs.size()) {
+        cerr << "Give the same count of --fork-input and --fork-analog options" << endl;
+        exit(1);
+    }
+    if(forkInputs.size() && readFromPipeFileName == "") {
+        cerr << "--fork-input needs a pipe register, see -R" << endl;
+        exit(1);
+    }
+    if(forkCount && gdbserver_flag) {
+        cerr << "Forked simulations aren't available with gdb server" << endl;
+        exit(1);
+    }
+    if(forkCount && (tracer_opts.size() || sysConHandler.GetTraceState() || binaryTraceFile.size())) {
+        // forked processes would write to the same files
+        cerr << "Forked simulations aren't available with -c, -t or --binary-trace" << endl;
+        exit(1);
+    }
+    if((forkAt.size() || forkAfter) && forkCount == 0) {
+        cerr << "Give --fork-input or --fork-analog for forked simulations" << endl;
+        exit(1);
+    }
+    
     //if we want to insert some special "pipe" Registers we could do this here:
+    RWReadFromFile *readFromPipe = NULL;
     if(readFromPipeFileName != "") {
         avr_message("Add ReadFromPipe-Register at 0x%lx and read from file: %s",
                     readFromPipeOffset, readFromPipeFileName.c_str());
-        dev1->ReplaceIoRegister(readFromPipeOffset,
-            new RWReadFromFile(dev1, "FREAD", readFromPipeFileName.c_str()));
+        readFromPipe = new RWReadFromFile(dev1, "FREAD", readFromPipeFileName.c_str());
+        dev1->ReplaceIoRegister(readFromPipeOffset, readFromPipe);
     }
     
     if(writeToPipeFileName != "") {
@@ -440,23 +645,59 @@ int main(int argc, char *argv[]) {
     if(sysConHandler.GetTraceState())
         dev1->trace_on = 1;
     
+    dev1->SetFastCoreMode(fastCoreMode);
+    
+    if(binaryTraceFile.size())
+        dev1->SetInstructionTrace(new InstructionTrace(binaryTraceFile, binaryTraceSize));
+    
     dman->start(); // start dump session
     
     long steps = 0;
     if(gdbserver_flag == 0) { // no gdb
         SystemClock::Instance().Add(dev1);
+        if(loadStateFile.size())
+            SystemClock::Instance().RestoreStateFromFile(loadStateFile);
+        if(forkCount) {
+            bool failed = false;
+            int child = ForkSimulations(dev1, forkAt, forkAfter, forkCount, failed);
+            if(child < 0) {
+                // parent, all is done by the forked simulations
+                dman->stopApplication();
+                delete ui;
+                delete dev1;
+                return failed ? 1 : 0;
+            }
+            if(forkInputs.size())
+                readFromPipe->SetFile(forkInputs[child]);
+            if(forkAnalogs.size()) {
+                string arg = forkAnalogs[child];
+                size_t pos = arg.find(',');
+                Net *net = new Net;
+                net->Add(dev1->GetPin(arg.substr(0, pos).c_str()));
+                SystemClock::Instance().Add(new AdcPin(arg.substr(pos + 1).c_str(), *net));
+            }
+            // output files of each forked simulation
+            ostringstream suffix;
+            suffix << "." << child;
+            if(saveStateFile.size())
+                saveStateFile += suffix.str();
+            if(coredumpfile != "unknown")
+                coredumpfile += suffix.str();
+        }
         if(maxRunTime == 0) {
             steps = SystemClock::Instance().Endless();
             cout << "SystemClock::Endless stopped" << endl
                  << "number of cpu cycles simulated: " << dec << steps << endl;
         } else {                                           // limited
-            steps = SystemClock::Instance().Run(maxRunTime);
+            steps = SystemClock::Instance().Run(SystemClock::Instance().GetCurrentTime() + maxRunTime);
             cout << "Ran too long.  Terminated after " << dec << maxRunTime
                  << " ns (simulated) and " << endl 
                  << dec << steps << " cpu cycles" << endl;
         }
         Application::GetInstance()->PrintResults();
     } else { // gdb should be activated
+        if(loadStateFile.size())
+            SystemClock::Instance().RestoreStateFromFile(loadStateFile);
         avr_message("Waiting for gdb connection ...");
         GdbServer gdb1(dev1, global_gdbserver_port, global_gdb_debug, globalWaitForGdbConnection);
         SystemClock::Instance().Add(&gdb1);
@@ -470,6 +711,11 @@ int main(int argc, char *argv[]) {
     
     dman->stopApplication(); // stop dump session. Close dump files, if necessary
     
+    if(saveStateFile.size()) {
+        avr_message("write simulation state file ...");
+        SystemClock::Instance().SaveStateToFile(saveStateFile);
+    }
+    
     if(coredumpfile != "unknown") {
         avr_message("write core dump file ...");
         WriteCoreDump(coredumpfile, dev1);
@@ -0,0 +1,415 @@
+/*
+ ****************************************************************************
+ *
+ * simulavr - A simulator for the Atmel AVR family of microcontrollers.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ ****************************************************************************
+ *
+ *  $Id$
+ */
+
+/* Converts a simulavr binary trace (see DumpBinary in traceval.h) into a
+   VCD file, optional only for a time range. */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+using namespace std;
+
+#include "config.h"
+#ifdef HAVE_ZLIB
+#   include <zlib.h>
+#endif
+#include "traceval.h"
+
+static void fail(const string &msg) {
+    cerr << "trace2vcd: " << msg << endl;
+    exit(1);
+}
+
+//! Simple reader for LEB128 numbers, fixed size numbers and strings out of a memory buffer
+class BinReader {
+
+    public:
+        BinReader(const string &_data): data(_data), pos(0) {}
+
+        bool atEnd(void) const { return pos >= data.size(); }
+
+        unsigned long long varint(void) {
+            unsigned long long v = 0;
+            int shift = 0;
+            unsigned char c;
+            do {
+                if(atEnd())
+                    fail("unexpected end of data");
+                c = data[pos++];
+                v |= (unsigned long long)(c & 0x7f) << shift;
+                shift += 7;
+            } while(c & 0x80);
+            return v;
+        }
+
+        unsigned long long fixed(int size) {
+            if(pos + size > data.size())
+                fail("unexpected end of data");
+            unsigned long long v = 0;
+            for(int i = 0; i < size; i++)
+                v |= (unsigned long long)(unsigned char)data[pos++] << (8 * i);
+            return v;
+        }
+
+        string str(void) {
+            size_t l = varint();
+            if(pos + l > data.size())
+                fail("unexpected end of data");
+            string s = data.substr(pos, l);
+            pos += l;
+            return s;
+        }
+
+        size_t position(void) const { return pos; }
+
+    private:
+        const string &data;
+        size_t pos;
+};
+
+//! read size bytes from file at position pos
+static string readAt(ifstream &is, unsigned long long pos, size_t size) {
+    string s(size, '\0');
+    is.seekg(pos);
+    if(size > 0)
+        is.read(&s[0], size);
+    if((size_t)is.gcount() != size)
+        fail("can't read trace file");
+    return s;
+}
+
+//! Build a VCD identifier code, same as DumpVCD
+static string idCode(size_t num) {
+    string s;
+    do {
+        s += (char)('!' + num % 94);
+        num /= 94;
+    } while(num);
+    return s;
+}
+
+struct Signal {
+    string name;
+    unsigned bits;
+    unsigned value;
+    bool known;
+};
+
+class VcdWriter {
+
+    public:
+        VcdWriter(ostream &_os, vector<Signal> &_sig, bool _rs, bool _ws):
+            os(_os), sig(_sig), rs(_rs), ws(_ws), timeWritten(true), time(0) {
+            for(size_t i = 0; i < sig.size() * (1 + rs + ws); i++)
+                ids.push_back(idCode(i));
+        }
+
+        void header(const string &tscale) {
+            os << "$version\n"
+                  "\tSimulavr VCD dump file generator\n"
+                  "$end\n";
+            os << "$timescale 1" << tscale << " $end\n";
+            for(size_t n = 0; n < sig.size(); n++) {
+                const string &s = sig[n].name;
+                int ld;
+                for(ld = s.size() - 1; ld > 0; ld--)
+                    if(s[ld] == '.') break;
+                os << "$scope module " << s.substr(0, ld) << " $end\n";
+                os << "$var wire " << sig[n].bits << ' ' << ids[n * (1 + rs + ws)] << ' ' << s.substr(ld + 1) << " $end\n";
+                if(rs)
+                    os << "$var wire 1 " << ids[n * (1 + rs + ws) + 1] << ' ' << s.substr(ld + 1) + "_R" << " $end\n";
+                if(ws)
+                    os << "$var wire 1 " << ids[n * (1 + rs + ws) + 1 + rs] << ' ' << s.substr(ld + 1) + "_W" << " $end\n";
+                os << "$upscope $end\n";
+            }
+            os << "$enddefinitions $end\n";
+        }
+
+        void dumpvars(SystemClockOffset t) {
+            os << "#" << t << "\n$dumpvars\n";
+            for(size_t n = 0; n < sig.size(); n++) {
+                value(n);
+                if(rs)
+                    os << '0' << ids[n * (1 + rs + ws) + 1] << '\n';
+                if(ws)
+                    os << '0' << ids[n * (1 + rs + ws) + 1 + rs] << '\n';
+            }
+            os << "$end\n";
+            time = t;
+            timeWritten = false;
+        }
+
+        //! new time step, resets all strobes
+        void step(SystemClockOffset t) {
+            time = t;
+            timeWritten = false;
+            for(size_t i = 0; i < marked.size(); i++) {
+                timeout();
+                os << '0' << ids[marked[i]] << '\n';
+            }
+            marked.clear();
+        }
+
+        void change(size_t n) {
+            timeout();
+            value(n);
+        }
+
+        void strobe(size_t n, bool write) {
+            if(write ? !ws : !rs)
+                return;
+            size_t num = n * (1 + rs + ws) + 1 + (write ? rs : 0);
+            timeout();
+            os << '1' << ids[num] << '\n';
+            marked.push_back(num);
+        }
+
+        void end(SystemClockOffset t) {
+            os << "#" << t << '\n';
+        }
+
+    private:
+        ostream &os;
+        vector<Signal> &sig;
+        bool rs, ws;
+        vector<string> ids;
+        vector<size_t> marked;
+        bool timeWritten;
+        SystemClockOffset time;
+
+        void timeout(void) {
+            if(!timeWritten) {
+                os << "#" << time << '\n';
+                timeWritten = true;
+            }
+        }
+
+        void value(size_t n) {
+            const Signal &s = sig[n];
+            const string &id = ids[n * (1 + rs + ws)];
+            if(s.bits == 1) {
+                static const char states[] = "01zx";
+                os << states[s.value & 3] << id << '\n';
+                return;
+            }
+            os << 'b';
+            if(!s.known) {
+                os << 'x';
+            } else {
+                int i = s.bits - 1;
+                while(i > 0 && !(s.value & (1u << i)))
+                    i--;
+                for(; i >= 0; i--)
+                    os << ((s.value & (1u << i)) ? '1' : '0');
+            }
+            os << ' ' << id << '\n';
+        }
+};
+
+static void usage(void) {
+    cerr << "usage: trace2vcd [-r] [-w] [-s <start>] [-e <end>] <trace-file> <vcd-file|->\n"
+            "  -r          add read strobe signals\n"
+            "  -w          add write strobe signals\n"
+            "  -s <start>  start time of VCD output\n"
+            "  -e <end>    end time of VCD output\n";
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    bool rs = false, ws = false, hasStart = false, hasEnd = false;
+    SystemClockOffset start = 0, end = 0;
+    vector<string> files;
+    for(int i = 1; i < argc; i++) {
+        string a = argv[i];
+        if(a == "-r")
+            rs = true;
+        else if(a == "-w")
+            ws = true;
+        else if(a == "-s" && i + 1 < argc) {
+            start = atoll(argv[++i]);
+            hasStart = true;
+        } else if(a == "-e" && i + 1 < argc) {
+            end = atoll(argv[++i]);
+            hasEnd = true;
+        } else if(a[0] == '-' && a != "-")
+            usage();
+        else
+            files.push_back(a);
+    }
+    if(files.size() != 2)
+        usage();
+
+    ifstream is(files[0].c_str(), ios::in | ios::binary);
+    if(!is.is_open())
+        fail("can't open '" + files[0] + "'");
+
+    // footer and index
+    is.seekg(0, ios::end);
+    unsigned long long fileSize = is.tellg();
+    if(fileSize < 32)
+        fail("file too short, no binary trace");
+    string footer = readAt(is, fileSize - 16, 16);
+    if(footer.substr(8) != "SAVRBIX1")
+        fail("no index found, trace file incomplete?");
+    BinReader fr(footer);
+    unsigned long long indexPos = fr.fixed(8);
+    string idxData = readAt(is, indexPos, fileSize - 16 - indexPos);
+    BinReader ir(idxData);
+    vector<unsigned long long> blockPos;
+    vector<SystemClockOffset> blockTime;
+    size_t blocks = ir.varint();
+    for(size_t i = 0; i < blocks; i++) {
+        blockPos.push_back(ir.fixed(8));
+        blockTime.push_back(ir.fixed(8));
+    }
+    if(blocks == 0)
+        fail("trace has no blocks");
+
+    // header
+    string hdr = readAt(is, 0, blockPos[0]);
+    if(hdr.substr(0, 8) != "SAVRBTR1")
+        fail("'" + files[0] + "' isn't a simulavr binary trace");
+    BinReader hr(hdr);
+    hr.fixed(8);
+    string tscale = hr.str();
+    vector<Signal> sig(hr.varint());
+    for(size_t i = 0; i < sig.size(); i++) {
+        sig[i].name = hr.str();
+        sig[i].bits = hr.varint();
+    }
+
+    // seek the block, which contains start time
+    size_t b = 0;
+    if(hasStart) {
+        while(b + 1 < blocks && blockTime[b + 1] <= start)
+            b++;
+    }
+
+    ostream *os = &cout;
+    ofstream ofs;
+    if(files[1] != "-") {
+        ofs.open(files[1].c_str());
+        if(!ofs.is_open())
+            fail("can't open '" + files[1] + "'");
+        os = &ofs;
+    }
+    VcdWriter vcd(*os, sig, rs, ws);
+    vcd.header(tscale);
+
+    bool started = false;
+    SystemClockOffset time = 0;
+    for(bool first = true; b < blocks; b++, first = false) {
+        // read and decompress block
+        string bh = readAt(is, blockPos[b], 17);
+        BinReader bhr(bh);
+        SystemClockOffset t = bhr.fixed(8);
+        size_t rawSize = bhr.fixed(4);
+        size_t storedSize = bhr.fixed(4);
+        int compression = bhr.fixed(1);
+        string data = readAt(is, blockPos[b] + 17, storedSize);
+        if(compression == 1) {
+#ifdef HAVE_ZLIB
+            string raw(rawSize, '\0');
+            uLongf size = rawSize;
+            if(uncompress((Bytef *)&raw[0], &size, (const Bytef *)data.data(), storedSize) != Z_OK || size != rawSize)
+                fail("can't decompress block");
+            data = raw;
+#else
+            fail("trace is compressed, but trace2vcd is build without zlib");
+#endif
+        } else if(compression != 0 || storedSize != rawSize)
+            fail("unknown block compression");
+
+        BinReader br(data);
+        for(size_t i = 0; i < sig.size(); i++) {
+            unsigned long long v = br.varint();
+            if(first) {
+                sig[i].value = v >> 1;
+                sig[i].known = v & 1;
+            }
+        }
+        time = t;
+        if(!started && (!hasStart || time >= start)) {
+            vcd.dumpvars(hasStart ? start : time);
+            started = true;
+        } else if(started)
+            vcd.step(time);
+
+        while(!br.atEnd()) {
+            unsigned long long tag = br.varint();
+            if(tag == 0) {
+                time += br.varint();
+                if(hasEnd && time > end)
+                    break;
+                if(!started && time >= start) {
+                    vcd.dumpvars(start);
+                    started = true;
+                }
+                if(started)
+                    vcd.step(time);
+                continue;
+            }
+            tag--;
+            size_t n = tag >> 2;
+            if(n >= sig.size())
+                fail("invalid signal in trace data");
+            switch(tag & 3) {
+                case DumpBinary::CHANGE: {
+                    unsigned d = br.varint();
+                    sig[n].value += (d >> 1) ^ -(d & 1);
+                    sig[n].known = true;
+                    if(started)
+                        vcd.change(n);
+                    break;
+                }
+                case DumpBinary::UNKNOWN:
+                    sig[n].known = false;
+                    if(started)
+                        vcd.change(n);
+                    break;
+                case DumpBinary::READ:
+                    if(started)
+                        vcd.strobe(n, false);
+                    break;
+                case DumpBinary::WRITE:
+                    if(started)
+                        vcd.strobe(n, true);
+                    break;
+            }
+        }
+        if(hasEnd && time > end) {
+            time = end;
+            break;
+        }
+    }
+    if(!started)
+        vcd.dumpvars(start);
+    vcd.end(time);
+
+    return 0;
+}
+
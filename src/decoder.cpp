@@ -23,6 +23,14 @@
  *  $Id$
  */
 
+#include <map>
+
+#include "config.h"
+#if defined(HAVE_PTHREAD) && defined(__GNUC__)
+#   include <pthread.h>
+#   define USE_THREADS
+#endif
+
 #include "decoder.h"
 #include "hwstack.h"
 #include "flash.h"
@@ -33,12 +41,11 @@
 
 static int n_bit_unsigned_to_signed(unsigned int val, int n );
 
-static int get_add_carry( byte res, byte rd, byte rr, int b );
-static int get_add_overflow( byte res, byte rd, byte rr );
-static int get_sub_carry( byte res, byte rd, byte rr, int b );
-static int get_sub_overflow( byte res, byte rd, byte rr );
-static int get_compare_carry( byte res, byte rd, byte rr, int b );
-static int get_compare_overflow( byte res, byte rd, byte rr );
+
+/* SREG flags written by arithmetic and logic instructions */
+static const unsigned char FLAGS_SVNZ = HWSreg::SREG_S | HWSreg::SREG_V | HWSreg::SREG_N | HWSreg::SREG_Z;
+static const unsigned char FLAGS_SVNZC = FLAGS_SVNZ | HWSreg::SREG_C;
+static const unsigned char FLAGS_HSVNZC = FLAGS_SVNZC | HWSreg::SREG_H;
 
 enum decoder_operand_masks {
     /** 2 bit register id  ( R24, R26, R28, R30 ) */
@@ -100,65 +107,88 @@ static int get_q( word opcode );
 static int get_A_5( word opcode );
 static int get_A_6( word opcode );
 
-avr_op_ADC::avr_op_ADC(word opcode, AvrDevice *c): 
-    DecodedInstruction(c),
+avr_op_ADC::avr_op_ADC(word opcode): 
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    R2(get_rr_5(opcode)),
-    status(c->status) {}
+    R2(get_rr_5(opcode)) {
+    SetOperands(R1, R2);
+    SetRegisterOp(HWSreg::SREG_C, FLAGS_HSVNZC, ExecNoFlags);
+}
 
 unsigned char avr_op_ADC::GetModifiedR() const {
     return R1;
 }
-int avr_op_ADC::operator()() { 
+int avr_op_ADC::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+    HWSreg *status = core->status;
+    status->Update();
+
     unsigned char rd = core->GetCoreReg(R1);
     unsigned char rr = core->GetCoreReg(R2);
     unsigned char res = rd + rr + status->C;
 
-    status->H = get_add_carry(res, rd, rr, 3);
-    status->V = get_add_overflow(res, rd, rr);
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0;
-    status->C = get_add_carry(res, rd, rr, 7);
+    status->SetLazy(HWSreg::LAZY_ADD, res, rd, rr);
 
     core->SetCoreReg(R1, res);
 
     return 1;   //used clocks
 }
 
-avr_op_ADD::avr_op_ADD(word opcode, AvrDevice *c): 
-    DecodedInstruction(c),
+int avr_op_ADC::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+
+    core->status->Update();
+    core->SetCoreReg(R1, core->GetCoreReg(R1) + core->GetCoreReg(R2) + core->status->C);
+
+    return 1;
+}
+
+avr_op_ADD::avr_op_ADD(word opcode): 
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    R2(get_rr_5(opcode)), 
-    status(c->status) {}
+    R2(get_rr_5(opcode)) {
+    SetOperands(R1, R2);
+    SetRegisterOp(0, FLAGS_HSVNZC, ExecNoFlags);
+}
 
 unsigned char avr_op_ADD::GetModifiedR() const {
     return R1;
 }
-int avr_op_ADD::operator()() { 
+int avr_op_ADD::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+    HWSreg *status = core->status;
+
     unsigned char rd = core->GetCoreReg(R1);
     unsigned char rr = core->GetCoreReg(R2);
     unsigned char res = rd + rr;
 
-    status->H = get_add_carry(res, rd, rr, 3);
-    status->V = get_add_overflow(res, rd, rr);
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0;
-    status->C = get_add_carry(res, rd, rr, 7);
+    status->SetLazy(HWSreg::LAZY_ADD, res, rd, rr);
 
     core->SetCoreReg(R1, res);
 
     return 1;   //used clocks
 }
 
-avr_op_ADIW::avr_op_ADIW(word opcode, AvrDevice *c): 
-    DecodedInstruction(c),
+int avr_op_ADD::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+
+    core->SetCoreReg(R1, core->GetCoreReg(R1) + core->GetCoreReg(R2));
+
+    return 1;
+}
+
+avr_op_ADIW::avr_op_ADIW(word opcode): 
+    DecodedInstruction(Exec),
     Rl(get_rd_2(opcode)),
     Rh(get_rd_2(opcode) + 1),
-    K(get_K_6(opcode)),
-    status(c->status) {
-    }
+    K(get_K_6(opcode)) {
+    SetOperands(Rl, Rh, K);
+    SetRegisterOp(0, FLAGS_SVNZC, ExecNoFlags);
+}
 
 unsigned char avr_op_ADIW::GetModifiedR() const {
     return Rl;
@@ -166,17 +196,18 @@ unsigned char avr_op_ADIW::GetModifiedR() const {
 unsigned char avr_op_ADIW::GetModifiedRHi() const {
     return Rh;
 }
-int avr_op_ADIW::operator()() {
+int avr_op_ADIW::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rl = rec.op1;
+    unsigned char Rh = rec.op2;
+    unsigned char K = rec.k;
+    HWSreg *status = core->status;
+
     word rd = (core->GetCoreReg(Rh) << 8) + core->GetCoreReg(Rl);
     word res = rd + K;
     unsigned char rdh = core->GetCoreReg(Rh);
 
 
-    status->V = ~(rdh >> 7 & 0x1) & (res >> 15 & 0x1); 
-    status->N = (res >> 15) & 0x1;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xffff) == 0;
-    status->C = ~(res >> 15 & 0x1) & (rdh >> 7 & 0x1); 
+    status->SetLazy(HWSreg::LAZY_ADIW, res, rdh);
 
     core->SetCoreReg(Rl, res & 0xff);
     core->SetCoreReg(Rh, res >> 8);
@@ -184,84 +215,141 @@ int avr_op_ADIW::operator()() {
     return 2; 
 }
 
-avr_op_AND::avr_op_AND(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+int avr_op_ADIW::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rl = rec.op1;
+    unsigned char Rh = rec.op2;
+    unsigned char K = rec.k;
+
+    word res = (core->GetCoreReg(Rh) << 8) + core->GetCoreReg(Rl) + K;
+
+    core->SetCoreReg(Rl, res & 0xff);
+    core->SetCoreReg(Rh, res >> 8);
+
+    return 2;
+}
+
+avr_op_AND::avr_op_AND(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    R2(get_rr_5(opcode)),
-    status(c->status) {}
+    R2(get_rr_5(opcode)) {
+    SetOperands(R1, R2);
+    SetRegisterOp(0, FLAGS_SVNZ, ExecNoFlags);
+}
+
+int avr_op_AND::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_AND::operator()() {
     unsigned char res = core->GetCoreReg(R1) & core->GetCoreReg(R2);
 
-    status->V = 0;
-    status->N = (res >> 7) & 0x1; 
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0; 
+    status->SetLazy(HWSreg::LAZY_LOGIC, res);
 
     core->SetCoreReg(R1, res);
 
     return 1; 
 }
 
-avr_op_ANDI::avr_op_ANDI(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+int avr_op_AND::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+
+    core->SetCoreReg(R1, core->GetCoreReg(R1) & core->GetCoreReg(R2));
+
+    return 1;
+}
+
+avr_op_ANDI::avr_op_ANDI(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_4(opcode)),
-    K(get_K_8(opcode)),
-    status(c->status) {}
+    K(get_K_8(opcode)) {
+    SetOperands(R1, K);
+    SetRegisterOp(0, FLAGS_SVNZ, ExecNoFlags);
+}
+
+int avr_op_ANDI::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_ANDI::operator()() {
     unsigned char rd = core->GetCoreReg(R1);
     unsigned char res = rd & K;
 
-    status->V = 0;
-    status->N = (res >> 7) & 0x1; 
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0; 
+    status->SetLazy(HWSreg::LAZY_LOGIC, res);
 
     core->SetCoreReg(R1, res);
     
     return 1;
 }
 
-avr_op_ASR::avr_op_ASR(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)),
-    status(c->status) {}
+int avr_op_ANDI::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
+
+    core->SetCoreReg(R1, core->GetCoreReg(R1) & K);
+
+    return 1;
+}
+
+avr_op_ASR::avr_op_ASR(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+    SetRegisterOp(0, FLAGS_SVNZC, ExecNoFlags);
+}
+
+int avr_op_ASR::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    HWSreg *status = core->status;
 
-int avr_op_ASR::operator()() {
     unsigned char rd = core->GetCoreReg(R1); 
     unsigned char res = (rd >> 1) + (rd & 0x80);
 
-    status->N = (res >> 7) & 0x1;
-    status->C = rd & 0x1;
-    status->V = status->N ^ status->C;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0;
+    status->SetLazy(HWSreg::LAZY_SHIFT, res, rd);
 
     core->SetCoreReg(R1, res);
 
     return 1;
 }
 
+int avr_op_ASR::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+
+    byte rd = core->GetCoreReg(R1);
+    core->SetCoreReg(R1, (rd >> 1) + (rd & 0x80));
+
+    return 1;
+}
 
-avr_op_BCLR::avr_op_BCLR(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    status(c->status),
-    Kbit(get_sreg_bit(opcode)) {}
 
-int avr_op_BCLR::operator()() {
+avr_op_BCLR::avr_op_BCLR(word opcode):
+    DecodedInstruction(Exec),
+    Kbit(get_sreg_bit(opcode)) {
+    SetOperands(Kbit);
+}
+
+int avr_op_BCLR::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Kbit = rec.op1;
+    HWSreg *status = core->status;
+
     *status = (*status) & ~(1 << Kbit);
     
     return 1;
 }
 
-avr_op_BLD::avr_op_BLD(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_BLD::avr_op_BLD(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    Kbit(get_reg_bit(opcode)),
-    status(c->status) {}
+    Kbit(get_reg_bit(opcode)) {
+    SetOperands(R1, Kbit);
+    SetRegisterOp(HWSreg::SREG_T, 0);
+}
+
+int avr_op_BLD::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char Kbit = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_BLD::operator()() {
     unsigned char rd = core->GetCoreReg(R1);
     int T = status->T;
     unsigned char res;
@@ -276,13 +364,18 @@ int avr_op_BLD::operator()() {
     return 1;
 }
 
-avr_op_BRBC::avr_op_BRBC(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    status(c->status),
+avr_op_BRBC::avr_op_BRBC(word opcode):
+    DecodedInstruction(Exec),
     bitmask(1 << get_reg_bit(opcode)),
-    offset(n_bit_unsigned_to_signed(get_k_7(opcode), 7)) {}
+    offset(n_bit_unsigned_to_signed(get_k_7(opcode), 7)) {
+    SetOperands(bitmask, 0, offset);
+}
+
+int avr_op_BRBC::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char bitmask = rec.op1;
+    signed char offset = rec.k;
+    HWSreg *status = core->status;
 
-int avr_op_BRBC::operator()() {
     int clks;
 
     if((bitmask & (*(status))) == 0) {
@@ -296,13 +389,18 @@ int avr_op_BRBC::operator()() {
     return clks;
 }
 
-avr_op_BRBS::avr_op_BRBS(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    status(c->status),
+avr_op_BRBS::avr_op_BRBS(word opcode):
+    DecodedInstruction(Exec),
     bitmask(1 << get_reg_bit(opcode)),
-    offset(n_bit_unsigned_to_signed(get_k_7(opcode), 7)) {}
+    offset(n_bit_unsigned_to_signed(get_k_7(opcode), 7)) {
+    SetOperands(bitmask, 0, offset);
+}
+
+int avr_op_BRBS::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char bitmask = rec.op1;
+    signed char offset = rec.k;
+    HWSreg *status = core->status;
 
-int avr_op_BRBS::operator()() {
     int clks;
 
     if((bitmask & (*(status))) != 0) {
@@ -316,35 +414,49 @@ int avr_op_BRBS::operator()() {
     return clks;
 }
 
-avr_op_BSET::avr_op_BSET(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    status(c->status),
-    Kbit(get_sreg_bit(opcode)) {}
+avr_op_BSET::avr_op_BSET(word opcode):
+    DecodedInstruction(Exec),
+    Kbit(get_sreg_bit(opcode)) {
+    SetOperands(Kbit);
+}
+
+int avr_op_BSET::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Kbit = rec.op1;
+    HWSreg *status = core->status;
 
-int avr_op_BSET::operator()() {
     *(status) = *(status) | 1 << Kbit;
     
     return 1;
 }
 
-avr_op_BST::avr_op_BST(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_BST::avr_op_BST(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    Kbit(get_reg_bit(opcode)),
-    status(c->status) {}
+    Kbit(get_reg_bit(opcode)) {
+    SetOperands(R1, Kbit);
+    SetRegisterOp(0, HWSreg::SREG_T);
+}
+
+int avr_op_BST::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char Kbit = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_BST::operator()() {
     status->T = ((core->GetCoreReg(R1) & (1 << Kbit)) != 0); 
 
     return 1;
 }
 
-avr_op_CALL::avr_op_CALL(word opcode, AvrDevice *c):
-    DecodedInstruction(c, true),
-    KH(get_k_22(opcode)) {}
+avr_op_CALL::avr_op_CALL(word opcode):
+    DecodedInstruction(Exec, true),
+    KH(get_k_22(opcode)) {
+    SetOperands(KH);
+}
 
-int avr_op_CALL::operator()() 
+int avr_op_CALL::Exec(AvrDevice *core, const DecodedRecord &rec) 
 {
+    unsigned char KH = rec.op1;
+
     word K_lsb = core->Flash->ReadMemWord((core->PC + 1) * 2);
     int k = (KH << 16) + K_lsb;
     int clkadd = core->flagXMega ? 1 : 2;
@@ -357,12 +469,17 @@ int avr_op_CALL::operator()()
     return core->PC_size + clkadd;
 }
 
-avr_op_CBI::avr_op_CBI(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_CBI::avr_op_CBI(word opcode):
+    DecodedInstruction(Exec),
     ioreg(get_A_5(opcode)),
-    Kbit(get_reg_bit(opcode)) {}
+    Kbit(get_reg_bit(opcode)) {
+    SetOperands(ioreg, Kbit);
+}
+
+int avr_op_CBI::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char ioreg = rec.op1;
+    unsigned char Kbit = rec.op2;
 
-int avr_op_CBI::operator()() {
     int clks = (core->flagXMega || core->flagTiny10) ? 1 : 2;
     
     core->SetIORegBit(ioreg, Kbit, false);
@@ -370,106 +487,120 @@ int avr_op_CBI::operator()() {
     return clks;
 }
 
-avr_op_COM::avr_op_COM(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)),
-    status(c->status) {}
+avr_op_COM::avr_op_COM(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+    SetRegisterOp(0, FLAGS_SVNZC, ExecNoFlags);
+}
+
+int avr_op_COM::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    HWSreg *status = core->status;
 
-int avr_op_COM::operator()() {
     byte rd  = core->GetCoreReg(R1);
     byte res = 0xff - rd;
 
-    status->N = (res >> 7) & 0x1;
-    status->C = 1;
-    status->V = 0;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0;
+    status->SetLazy(HWSreg::LAZY_COM, res);
 
     core->SetCoreReg(R1, res);
 
     return 1;
 }
 
-avr_op_CP::avr_op_CP(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+int avr_op_COM::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+
+    byte rd = core->GetCoreReg(R1);
+    core->SetCoreReg(R1, 0xff - rd);
+
+    return 1;
+}
+
+avr_op_CP::avr_op_CP(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    R2(get_rr_5(opcode)),
-    status(c->status) {}
+    R2(get_rr_5(opcode)) {
+    SetOperands(R1, R2);
+    SetRegisterOp(0, FLAGS_HSVNZC, avr_op_NOP::Exec);
+}
+
+int avr_op_CP::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_CP::operator()() {
     byte rd  = core->GetCoreReg(R1);
     byte rr  = core->GetCoreReg(R2);
     byte res = rd - rr;
 
-    status->H = get_compare_carry(res, rd, rr, 3);
-    status->V = get_compare_overflow(res, rd, rr);
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0;
-    status->C = get_compare_carry(res, rd, rr, 7);
+    status->SetLazy(HWSreg::LAZY_SUB, res, rd, rr);
 
     return 1;
 }
 
-avr_op_CPC::avr_op_CPC(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_CPC::avr_op_CPC(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    R2(get_rr_5(opcode)),
-    status(c->status) {}
+    R2(get_rr_5(opcode)) {
+    SetOperands(R1, R2);
+    SetRegisterOp(HWSreg::SREG_C | HWSreg::SREG_Z, FLAGS_HSVNZC, avr_op_NOP::Exec);
+}
+
+int avr_op_CPC::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+    HWSreg *status = core->status;
+    status->Update();
 
-int avr_op_CPC::operator()() {
     byte rd  = core->GetCoreReg(R1);
     byte rr  = core->GetCoreReg(R2);
     byte res = rd - rr - status->C;
 
-    status->H = get_compare_carry(res, rd, rr, 3);
-    status->V = get_compare_overflow(res, rd, rr);
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->C = get_compare_carry(res, rd, rr, 7);
-
-    /* Previous value remains unchanged when result is 0; cleared otherwise */
-    bool Z = (res & 0xff) == 0;
-    bool prev_Z = status->Z;
-    status->Z = Z && prev_Z;
+    status->SetLazy(HWSreg::LAZY_SBC, res, rd, rr);
 
     return 1;
 }
 
 
-avr_op_CPI::avr_op_CPI(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_CPI::avr_op_CPI(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_4(opcode)),
-    K(get_K_8(opcode)), 
-    status(c->status) {}
+    K(get_K_8(opcode)) {
+    SetOperands(R1, K);
+    SetRegisterOp(0, FLAGS_HSVNZC, avr_op_NOP::Exec);
+}
+
+int avr_op_CPI::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_CPI::operator()() {
     byte rd  = core->GetCoreReg(R1);
     byte res = rd - K;
 
-    status->H = get_compare_carry(res, rd, K, 3);
-    status->V = get_compare_overflow(res, rd, K);
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0;
-    status->C = get_compare_carry(res, rd, K, 7);
+    status->SetLazy(HWSreg::LAZY_SUB, res, rd, K);
 
     return 1;
 }
 
-avr_op_CPSE::avr_op_CPSE(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_CPSE::avr_op_CPSE(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    R2(get_rr_5(opcode)),
-    status(c->status) {}
+    R2(get_rr_5(opcode)) {
+    SetOperands(R1, R2);
+}
+
+int avr_op_CPSE::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
 
-int avr_op_CPSE::operator()() {
     int skip;
     byte rd = core->GetCoreReg(R1);
     byte rr = core->GetCoreReg(R2);
     int clks;
 
-    if(core->Flash->DecodedMem[core->PC + 1]->IsInstruction2Words())
+    if(core->Flash->IsInstruction2Words(core->PC + 1))
         skip = 3;
     else
         skip = 2;
@@ -484,28 +615,39 @@ int avr_op_CPSE::operator()() {
     return clks;
 }
 
-avr_op_DEC::avr_op_DEC(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)),
-    status(c->status) {}
+avr_op_DEC::avr_op_DEC(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+    SetRegisterOp(0, FLAGS_SVNZ, ExecNoFlags);
+}
+
+int avr_op_DEC::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    HWSreg *status = core->status;
 
-int avr_op_DEC::operator()() {
     byte res = core->GetCoreReg(R1) - 1;
 
-    status->N = (res >> 7) & 0x1;
-    status->V = res == 0x7f;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0;
+    status->SetLazy(HWSreg::LAZY_DEC, res);
 
     core->SetCoreReg(R1, res);
 
     return 1;
 }
 
-avr_op_EICALL::avr_op_EICALL(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+int avr_op_DEC::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_EICALL::operator()() {
+    byte rd = core->GetCoreReg(R1);
+    core->SetCoreReg(R1, rd - 1);
+
+    return 1;
+}
+
+avr_op_EICALL::avr_op_EICALL(word opcode):
+    DecodedInstruction(Exec) {}
+
+int avr_op_EICALL::Exec(AvrDevice *core, const DecodedRecord &rec) {
     unsigned new_PC = core->GetRegZ() + (core->eind->GetRegVal() << 16);
 
     core->stack->m_ThreadList.OnCall();
@@ -517,21 +659,25 @@ int avr_op_EICALL::operator()() {
     return core->flagXMega ? 3 : 4;
 }
 
-avr_op_EIJMP::avr_op_EIJMP(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+avr_op_EIJMP::avr_op_EIJMP(word opcode):
+    DecodedInstruction(Exec) {}
 
-int avr_op_EIJMP::operator()() {
+int avr_op_EIJMP::Exec(AvrDevice *core, const DecodedRecord &rec) {
     core->DebugOnJump();
     core->PC = (core->eind->GetRegVal() << 16) + core->GetRegZ() - 1;
 
     return 2;
 }
 
-avr_op_ELPM_Z::avr_op_ELPM_Z(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)) {}
+avr_op_ELPM_Z::avr_op_ELPM_Z(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_ELPM_Z::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_ELPM_Z::operator()() {
     unsigned int Z;
     unsigned char rampz = 0;
 
@@ -544,11 +690,15 @@ int avr_op_ELPM_Z::operator()() {
     return 3;
 }
 
-avr_op_ELPM_Z_incr::avr_op_ELPM_Z_incr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)) {}
+avr_op_ELPM_Z_incr::avr_op_ELPM_Z_incr(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_ELPM_Z_incr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_ELPM_Z_incr::operator()() {
     unsigned int Z;
     unsigned char rampz = 0;
 
@@ -568,10 +718,10 @@ int avr_op_ELPM_Z_incr::operator()() {
     return 3;
 }
 
-avr_op_ELPM::avr_op_ELPM(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+avr_op_ELPM::avr_op_ELPM(word opcode):
+    DecodedInstruction(Exec) {}
 
-int avr_op_ELPM::operator()() {
+int avr_op_ELPM::Exec(AvrDevice *core, const DecodedRecord &rec) {
     unsigned char rampz = 0;
 
     if(core->rampz != NULL)
@@ -583,31 +733,43 @@ int avr_op_ELPM::operator()() {
     return 3;
 }
 
-avr_op_EOR::avr_op_EOR(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_EOR::avr_op_EOR(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    R2(get_rr_5(opcode)),
-    status(c->status) {}
+    R2(get_rr_5(opcode)) {
+    SetOperands(R1, R2);
+    SetRegisterOp(0, FLAGS_SVNZ, ExecNoFlags);
+}
+
+int avr_op_EOR::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_EOR::operator()() {
     byte rd = core->GetCoreReg(R1); 
     byte rr = core->GetCoreReg(R2);
     byte res = rd ^ rr;
 
-    status->V = 0;
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0;
+    status->SetLazy(HWSreg::LAZY_LOGIC, res);
 
     core->SetCoreReg(R1, res);
 
     return 1;
 }
 
-avr_op_ESPM::avr_op_ESPM(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+int avr_op_EOR::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+
+    core->SetCoreReg(R1, core->GetCoreReg(R1) ^ core->GetCoreReg(R2));
 
-int avr_op_ESPM::operator()() {
+    return 1;
+}
+
+avr_op_ESPM::avr_op_ESPM(word opcode):
+    DecodedInstruction(Exec) {}
+
+int avr_op_ESPM::Exec(AvrDevice *core, const DecodedRecord &rec) {
     unsigned char xaddr = 0;
     int cycles = 1;
     if(core->rampz != NULL)
@@ -626,19 +788,26 @@ int avr_op_ESPM::operator()() {
     return cycles;
 }
 
-avr_op_FMUL::avr_op_FMUL(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_FMUL::avr_op_FMUL(word opcode):
+    DecodedInstruction(Exec),
     Rd(get_rd_3(opcode)),
-    Rr(get_rr_3(opcode)),
-    status(c->status) {}
+    Rr(get_rr_3(opcode)) {
+    SetOperands(Rd, Rr);
+    SetRegisterOp(0, HWSreg::SREG_C | HWSreg::SREG_Z);
+}
+
+int avr_op_FMUL::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
+    unsigned char Rr = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_FMUL::operator()() {
     byte rd = core->GetCoreReg(Rd);
     byte rr = core->GetCoreReg(Rr);
 
     word resp = rd * rr;
     word res = resp << 1;
 
+    status->Update();
     status->Z = (res & 0xffff) == 0;
     status->C= (resp >> 15) & 0x1;
 
@@ -650,19 +819,26 @@ int avr_op_FMUL::operator()() {
 }
 
 
-avr_op_FMULS::avr_op_FMULS(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_FMULS::avr_op_FMULS(word opcode):
+    DecodedInstruction(Exec),
     Rd(get_rd_3(opcode)),
-    Rr(get_rr_3(opcode)),
-    status(c->status) {}
+    Rr(get_rr_3(opcode)) {
+    SetOperands(Rd, Rr);
+    SetRegisterOp(0, HWSreg::SREG_C | HWSreg::SREG_Z);
+}
+
+int avr_op_FMULS::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
+    unsigned char Rr = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_FMULS::operator()() {
     sbyte rd = core->GetCoreReg(Rd); 
     sbyte rr = core->GetCoreReg(Rr);
 
     word resp = rd * rr;
     word res = resp << 1;
 
+    status->Update();
     status->Z = (res & 0xffff) == 0;
     status->C = (resp >> 15) & 0x1;
 
@@ -674,19 +850,26 @@ int avr_op_FMULS::operator()() {
 }
 
 
-avr_op_FMULSU::avr_op_FMULSU(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_FMULSU::avr_op_FMULSU(word opcode):
+    DecodedInstruction(Exec),
     Rd(get_rd_3(opcode)),
-    Rr(get_rr_3(opcode)),
-    status(c->status) {}
+    Rr(get_rr_3(opcode)) {
+    SetOperands(Rd, Rr);
+    SetRegisterOp(0, HWSreg::SREG_C | HWSreg::SREG_Z);
+}
+
+int avr_op_FMULSU::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
+    unsigned char Rr = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_FMULSU::operator()() {
     sbyte rd = core->GetCoreReg(Rd);
     byte rr = core->GetCoreReg(Rr);
 
     word resp = rd * rr;
     word res = resp << 1;
 
+    status->Update();
     status->Z = (res & 0xffff) == 0;
     status->C = (resp >> 15) & 0x1;
 
@@ -696,10 +879,10 @@ int avr_op_FMULSU::operator()() {
     return 2;
 }
 
-avr_op_ICALL::avr_op_ICALL(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+avr_op_ICALL::avr_op_ICALL(word opcode):
+    DecodedInstruction(Exec) {}
 
-int avr_op_ICALL::operator()() {
+int avr_op_ICALL::Exec(AvrDevice *core, const DecodedRecord &rec) {
     unsigned int pc = core->PC;
     /* Z is R31:R30 */
     unsigned int new_pc = core->GetRegZ();
@@ -713,10 +896,10 @@ int avr_op_ICALL::operator()() {
     return core->PC_size + (core->flagXMega ? 0 : 1);
 }
 
-avr_op_IJMP::avr_op_IJMP(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+avr_op_IJMP::avr_op_IJMP(word opcode):
+    DecodedInstruction(Exec) {}
 
-int avr_op_IJMP::operator()() {
+int avr_op_IJMP::Exec(AvrDevice *core, const DecodedRecord &rec) {
     int new_pc = core->GetRegZ();
     
     core->DebugOnJump();
@@ -725,53 +908,78 @@ int avr_op_IJMP::operator()() {
     return 2;
 }
 
-avr_op_IN::avr_op_IN(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_IN::avr_op_IN(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    ioreg(get_A_6(opcode)) {}
+    ioreg(get_A_6(opcode)) {
+    SetOperands(R1, ioreg);
+}
+
+int avr_op_IN::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char ioreg = rec.op2;
 
-int avr_op_IN::operator()() {
     core->SetCoreReg(R1, core->GetIOReg(ioreg));
 
     return 1;
 }
 
-avr_op_INC::avr_op_INC(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)),
-    status(c->status) {}
+avr_op_INC::avr_op_INC(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+    SetRegisterOp(0, FLAGS_SVNZ, ExecNoFlags);
+}
+
+int avr_op_INC::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    HWSreg *status = core->status;
 
-int avr_op_INC::operator()() {
     byte rd  = core->GetCoreReg(R1);
     byte res = rd + 1;
 
-    status->N = (res >> 7) & 0x1;
-    status->V = rd == 0x7f;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0;
+    status->SetLazy(HWSreg::LAZY_INC, res, rd);
 
     core->SetCoreReg(R1, res);
 
     return 1;
 }
 
-avr_op_JMP::avr_op_JMP(word opcode, AvrDevice *c):
-    DecodedInstruction(c, true),
-    K(get_k_22(opcode)) {}
+int avr_op_INC::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+
+    byte rd = core->GetCoreReg(R1);
+    core->SetCoreReg(R1, rd + 1);
+
+    return 1;
+}
+
+avr_op_JMP::avr_op_JMP(word opcode):
+    DecodedInstruction(Exec, true),
+    K(get_k_22(opcode)) {
+    SetOperands(0, 0, K);
+}
+
+int avr_op_JMP::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned int K = rec.k;
 
-int avr_op_JMP::operator()() {
     word K_lsb = core->Flash->ReadMemWord((core->PC + 1) * 2);
     core->DebugOnJump();
     core->PC = (K << 16) + K_lsb - 1;
     return 3;
 }
 
-avr_op_LDD_Y::avr_op_LDD_Y(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_LDD_Y::avr_op_LDD_Y(word opcode):
+    DecodedInstruction(Exec),
     Rd(get_rd_5(opcode)),
-    K(get_q(opcode)) {}
+    K(get_q(opcode)) {
+    SetOperands(Rd, K);
+}
+
+int avr_op_LDD_Y::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
+    unsigned char K = rec.op2;
 
-int avr_op_LDD_Y::operator()() {
     /* Y is R29:R28 */
     word Y = core->GetRegY();
 
@@ -780,12 +988,17 @@ int avr_op_LDD_Y::operator()() {
     return ((core->flagXMega || core->flagTiny10) && K == 0) ? 1 : 2;
 }
 
-avr_op_LDD_Z::avr_op_LDD_Z(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_LDD_Z::avr_op_LDD_Z(word opcode):
+    DecodedInstruction(Exec),
     Rd(get_rd_5(opcode)),
-    K(get_q(opcode)) {}
+    K(get_q(opcode)) {
+    SetOperands(Rd, K);
+}
+
+int avr_op_LDD_Z::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
+    unsigned char K = rec.op2;
 
-int avr_op_LDD_Z::operator()() {
     /* Z is R31:R30 */
     word Z = core->GetRegZ();
 
@@ -794,25 +1007,35 @@ int avr_op_LDD_Z::operator()() {
     return ((core->flagXMega || core->flagTiny10) && K == 0) ? 1 : 2;
 }
 
-avr_op_LDI::avr_op_LDI(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_LDI::avr_op_LDI(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_4(opcode)),
-    K(get_K_8(opcode)) {}
+    K(get_K_8(opcode)) {
+    SetOperands(R1, K);
+    SetRegisterOp(0, 0);
+}
 
 unsigned char avr_op_LDI::GetModifiedR() const {
     return R1;
 }
-int avr_op_LDI::operator()() { 
+int avr_op_LDI::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
+
     core->SetCoreReg(R1, K);
 
     return 1;
 }
 
-avr_op_LDS::avr_op_LDS(word opcode, AvrDevice *c):
-    DecodedInstruction(c, true),
-    R1(get_rd_5(opcode)) {}
+avr_op_LDS::avr_op_LDS(word opcode):
+    DecodedInstruction(Exec, true),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_LDS::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_LDS::operator()() {
     /* Get data at k in current data segment and put into Rd */
     word offset = core->Flash->ReadMemWord((core->PC + 1) * 2);
     
@@ -822,11 +1045,15 @@ int avr_op_LDS::operator()() {
     return 2;
 }
 
-avr_op_LD_X::avr_op_LD_X(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    Rd(get_rd_5(opcode)) {}
+avr_op_LD_X::avr_op_LD_X(word opcode):
+    DecodedInstruction(Exec),
+    Rd(get_rd_5(opcode)) {
+    SetOperands(Rd);
+}
+
+int avr_op_LD_X::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
 
-int avr_op_LD_X::operator()() {
     /* X is R27:R26 */
     word X = core->GetRegX();
 
@@ -835,11 +1062,15 @@ int avr_op_LD_X::operator()() {
     return (core->flagXMega || core->flagTiny10) ? 1 : 2;
 }
 
-avr_op_LD_X_decr::avr_op_LD_X_decr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    Rd(get_rd_5(opcode)) {}
+avr_op_LD_X_decr::avr_op_LD_X_decr(word opcode):
+    DecodedInstruction(Exec),
+    Rd(get_rd_5(opcode)) {
+    SetOperands(Rd);
+}
+
+int avr_op_LD_X_decr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
 
-int avr_op_LD_X_decr::operator()() {
     /* X is R27:R26 */
     word X = core->GetRegX();
     if (Rd == 26 || Rd == 27)
@@ -854,11 +1085,15 @@ int avr_op_LD_X_decr::operator()() {
     return core->flagTiny10 ? 3 : 2;
 }
 
-avr_op_LD_X_incr::avr_op_LD_X_incr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    Rd(get_rd_5(opcode)) {}
+avr_op_LD_X_incr::avr_op_LD_X_incr(word opcode):
+    DecodedInstruction(Exec),
+    Rd(get_rd_5(opcode)) {
+    SetOperands(Rd);
+}
+
+int avr_op_LD_X_incr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
 
-int avr_op_LD_X_incr::operator()() {
     /* X is R27:R26 */
     word X = core->GetRegX();
     if (Rd == 26 || Rd == 27)
@@ -873,11 +1108,15 @@ int avr_op_LD_X_incr::operator()() {
     return core->flagXMega ? 1 : 2;
 }
 
-avr_op_LD_Y_decr::avr_op_LD_Y_decr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    Rd(get_rd_5(opcode)) {}
+avr_op_LD_Y_decr::avr_op_LD_Y_decr(word opcode):
+    DecodedInstruction(Exec),
+    Rd(get_rd_5(opcode)) {
+    SetOperands(Rd);
+}
+
+int avr_op_LD_Y_decr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
 
-int avr_op_LD_Y_decr::operator()() {
     /* Y is R29:R28 */
     word Y = core->GetRegY();
     if (Rd == 28 || Rd == 29)
@@ -892,11 +1131,15 @@ int avr_op_LD_Y_decr::operator()() {
     return core->flagTiny10 ? 3 : 2;
 }
 
-avr_op_LD_Y_incr::avr_op_LD_Y_incr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    Rd(get_rd_5(opcode)) {}
+avr_op_LD_Y_incr::avr_op_LD_Y_incr(word opcode):
+    DecodedInstruction(Exec),
+    Rd(get_rd_5(opcode)) {
+    SetOperands(Rd);
+}
+
+int avr_op_LD_Y_incr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
 
-int avr_op_LD_Y_incr::operator()() {
     /* Y is R29:R28 */
     word Y = core->GetRegY();
     if (Rd == 28 || Rd == 29)
@@ -911,11 +1154,15 @@ int avr_op_LD_Y_incr::operator()() {
     return core->flagXMega ? 1 : 2;
 }
 
-avr_op_LD_Z_incr::avr_op_LD_Z_incr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    Rd(get_rd_5(opcode)) {}
+avr_op_LD_Z_incr::avr_op_LD_Z_incr(word opcode):
+    DecodedInstruction(Exec),
+    Rd(get_rd_5(opcode)) {
+    SetOperands(Rd);
+}
+
+int avr_op_LD_Z_incr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
 
-int avr_op_LD_Z_incr::operator()() {
     /* Z is R31:R30 */
     word Z = core->GetRegZ();
     if (Rd == 30 || Rd == 31)
@@ -930,11 +1177,15 @@ int avr_op_LD_Z_incr::operator()() {
     return core->flagXMega ? 1 : 2;
 }
 
-avr_op_LD_Z_decr::avr_op_LD_Z_decr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    Rd(get_rd_5(opcode)) {}
+avr_op_LD_Z_decr::avr_op_LD_Z_decr(word opcode):
+    DecodedInstruction(Exec),
+    Rd(get_rd_5(opcode)) {
+    SetOperands(Rd);
+}
+
+int avr_op_LD_Z_decr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
 
-int avr_op_LD_Z_decr::operator()() {
     /* Z is R31:R30 */
     word Z = core->GetRegZ();
     if (Rd == 30 || Rd == 31)
@@ -949,11 +1200,15 @@ int avr_op_LD_Z_decr::operator()() {
     return core->flagTiny10 ? 3 : 2;
 }
 
-avr_op_LPM_Z::avr_op_LPM_Z(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    Rd(get_rd_5(opcode)) {}
+avr_op_LPM_Z::avr_op_LPM_Z(word opcode):
+    DecodedInstruction(Exec),
+    Rd(get_rd_5(opcode)) {
+    SetOperands(Rd);
+}
+
+int  avr_op_LPM_Z::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
 
-int  avr_op_LPM_Z::operator()() {
     /* Z is R31:R30 */
     word Z = core->GetRegZ();
 
@@ -963,10 +1218,10 @@ int  avr_op_LPM_Z::operator()() {
     return 3;
 }
 
-avr_op_LPM::avr_op_LPM(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+avr_op_LPM::avr_op_LPM(word opcode):
+    DecodedInstruction(Exec) {}
 
-int avr_op_LPM::operator()() {
+int avr_op_LPM::Exec(AvrDevice *core, const DecodedRecord &rec) {
     /* Z is R31:R30 */
     word Z = core->GetRegZ();
     
@@ -976,11 +1231,15 @@ int avr_op_LPM::operator()() {
     return 3;
 }
 
-avr_op_LPM_Z_incr::avr_op_LPM_Z_incr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    Rd(get_rd_5(opcode)) {}
+avr_op_LPM_Z_incr::avr_op_LPM_Z_incr(word opcode):
+    DecodedInstruction(Exec),
+    Rd(get_rd_5(opcode)) {
+    SetOperands(Rd);
+}
+
+int avr_op_LPM_Z_incr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
 
-int avr_op_LPM_Z_incr::operator()() {
     /* Z is R31:R30 */
     word Z = core->GetRegZ();
 
@@ -993,61 +1252,90 @@ int avr_op_LPM_Z_incr::operator()() {
     return 3;
 }
 
-avr_op_LSR::avr_op_LSR(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    Rd(get_rd_5(opcode)),
-    status(c->status) {}
+avr_op_LSR::avr_op_LSR(word opcode):
+    DecodedInstruction(Exec),
+    Rd(get_rd_5(opcode)) {
+    SetOperands(Rd);
+    SetRegisterOp(0, FLAGS_SVNZC, ExecNoFlags);
+}
+
+int avr_op_LSR::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
+    HWSreg *status = core->status;
 
-int avr_op_LSR::operator()() {
     byte rd = core->GetCoreReg(Rd); 
 
     byte res = (rd >> 1) & 0x7f;
 
-    status->C = rd & 0x1;
-    status->N = 0;
-    status->V = status->N ^ status->C;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0;
+    status->SetLazy(HWSreg::LAZY_SHIFT, res, rd);
 
     core->SetCoreReg(Rd, res);
 
     return 1;
 }
 
-avr_op_MOV::avr_op_MOV(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+int avr_op_LSR::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+
+    byte rd = core->GetCoreReg(R1);
+    core->SetCoreReg(R1, (rd >> 1) & 0x7f);
+
+    return 1;
+}
+
+avr_op_MOV::avr_op_MOV(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    R2(get_rr_5(opcode)) {}
+    R2(get_rr_5(opcode)) {
+    SetOperands(R1, R2);
+    SetRegisterOp(0, 0);
+}
+
+int avr_op_MOV::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
 
-int avr_op_MOV::operator()() {
     core->SetCoreReg(R1, core->GetCoreReg(R2));
     return 1;
 }
 
-avr_op_MOVW::avr_op_MOVW(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_MOVW::avr_op_MOVW(word opcode):
+    DecodedInstruction(Exec),
     Rd((get_rd_4(opcode) - 16) << 1),
-    Rs((get_rr_4(opcode) - 16) << 1) {}
+    Rs((get_rr_4(opcode) - 16) << 1) {
+    SetOperands(Rd, Rs);
+    SetRegisterOp(0, 0);
+}
+
+int avr_op_MOVW::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
+    unsigned char Rs = rec.op2;
 
-int avr_op_MOVW::operator()() {
     core->SetCoreReg(Rd, core->GetCoreReg(Rs));
     core->SetCoreReg(Rd + 1, core->GetCoreReg(Rs + 1));
 
     return 1;
 }
 
-avr_op_MUL::avr_op_MUL(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_MUL::avr_op_MUL(word opcode):
+    DecodedInstruction(Exec),
     Rd(get_rd_5(opcode)),
-    Rr(get_rr_5(opcode)),
-    status(c->status) {}
+    Rr(get_rr_5(opcode)) {
+    SetOperands(Rd, Rr);
+    SetRegisterOp(0, HWSreg::SREG_C | HWSreg::SREG_Z);
+}
+
+int avr_op_MUL::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
+    unsigned char Rr = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_MUL::operator()() {
     byte rd = core->GetCoreReg(Rd);
     byte rr = core->GetCoreReg(Rr);
 
     word res = rd * rr;
 
+    status->Update();
     status->Z = (res & 0xffff) == 0;
     status->C = (res >> 15) & 0x1;
 
@@ -1058,18 +1346,25 @@ int avr_op_MUL::operator()() {
     return 2;
 }
 
-avr_op_MULS::avr_op_MULS(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_MULS::avr_op_MULS(word opcode):
+    DecodedInstruction(Exec),
     Rd(get_rd_4(opcode)),
-    Rr(get_rr_4(opcode)),
-    status(c->status) {}
+    Rr(get_rr_4(opcode)) {
+    SetOperands(Rd, Rr);
+    SetRegisterOp(0, HWSreg::SREG_C | HWSreg::SREG_Z);
+}
+
+int avr_op_MULS::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
+    unsigned char Rr = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_MULS::operator()() {
     sbyte rd = (sbyte)core->GetCoreReg(Rd);
     sbyte rr = (sbyte)core->GetCoreReg(Rr);
 
     sword res = rd * rr;
 
+    status->Update();
     status->Z = (res & 0xffff) == 0;
     status->C = (res >> 15) & 0x1;
 
@@ -1080,18 +1375,25 @@ int avr_op_MULS::operator()() {
     return 2;
 }
 
-avr_op_MULSU::avr_op_MULSU(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_MULSU::avr_op_MULSU(word opcode):
+    DecodedInstruction(Exec),
     Rd(get_rd_3(opcode)),
-    Rr(get_rr_3(opcode)),
-    status(c->status) {}
+    Rr(get_rr_3(opcode)) {
+    SetOperands(Rd, Rr);
+    SetRegisterOp(0, HWSreg::SREG_C | HWSreg::SREG_Z);
+}
+
+int avr_op_MULSU::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
+    unsigned char Rr = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_MULSU::operator()() {
     sbyte rd = (sbyte)core->GetCoreReg(Rd);
     byte rr = core->GetCoreReg(Rr);
 
     sword res = rd * rr;
 
+    status->Update();
     status->Z = (res & 0xffff) == 0;
     status->C = (res >> 15) & 0x1;
 
@@ -1103,108 +1405,160 @@ int avr_op_MULSU::operator()() {
     return 2;
 }
 
-avr_op_NEG::avr_op_NEG(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    Rd(get_rd_5(opcode)),
-    status(c->status) {}
+avr_op_NEG::avr_op_NEG(word opcode):
+    DecodedInstruction(Exec),
+    Rd(get_rd_5(opcode)) {
+    SetOperands(Rd);
+    SetRegisterOp(0, FLAGS_HSVNZC, ExecNoFlags);
+}
+
+int avr_op_NEG::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
+    HWSreg *status = core->status;
 
-int avr_op_NEG::operator()() {
     byte rd  = core->GetCoreReg(Rd);
     byte res = (0x0 - rd) & 0xff;
 
-    status->H = ((res >> 3) | (rd >> 3)) & 0x1;
-    status->V = res == 0x80;
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->Z = res == 0x0;
-    status->C = res != 0x0;
+    status->SetLazy(HWSreg::LAZY_NEG, res, rd);
 
     core->SetCoreReg(Rd, res);
 
     return 1;
 }
 
-avr_op_NOP::avr_op_NOP(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+int avr_op_NEG::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_NOP::operator()() {
+    byte rd = core->GetCoreReg(R1);
+    core->SetCoreReg(R1, (0x0 - rd) & 0xff);
+
+    return 1;
+}
+
+avr_op_NOP::avr_op_NOP(word opcode):
+    DecodedInstruction(Exec) {
+    SetRegisterOp(0, 0);
+}
+
+int avr_op_NOP::Exec(AvrDevice *core, const DecodedRecord &rec) {
     return 1;
 }
 
-avr_op_OR::avr_op_OR(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_OR::avr_op_OR(word opcode):
+    DecodedInstruction(Exec),
     Rd(get_rd_5(opcode)),
-    Rr(get_rr_5(opcode)),
-    status(c->status) {}
+    Rr(get_rr_5(opcode)) {
+    SetOperands(Rd, Rr);
+    SetRegisterOp(0, FLAGS_SVNZ, ExecNoFlags);
+}
+
+int avr_op_OR::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char Rd = rec.op1;
+    unsigned char Rr = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_OR::operator()() {
     byte res = core->GetCoreReg(Rd) | core->GetCoreReg(Rr);
 
-    status->V = 0;
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->Z = res == 0x0;
+    status->SetLazy(HWSreg::LAZY_LOGIC, res);
 
     core->SetCoreReg(Rd, res);
 
     return 1;
 }
 
-avr_op_ORI::avr_op_ORI(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+int avr_op_OR::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+
+    core->SetCoreReg(R1, core->GetCoreReg(R1) | core->GetCoreReg(R2));
+
+    return 1;
+}
+
+avr_op_ORI::avr_op_ORI(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_4(opcode)),
-    K(get_K_8(opcode)),
-    status(c->status) {}
+    K(get_K_8(opcode)) {
+    SetOperands(R1, K);
+    SetRegisterOp(0, FLAGS_SVNZ, ExecNoFlags);
+}
+
+int avr_op_ORI::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
+    HWSreg *status = core->status;
 
-int avr_op_ORI::operator()() {
     byte res = core->GetCoreReg(R1) | K;
 
-    status->V = 0;
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->Z = res == 0x0;
+    status->SetLazy(HWSreg::LAZY_LOGIC, res);
 
     core->SetCoreReg(R1, res);
 
     return 1;
 }
 
-avr_op_OUT::avr_op_OUT(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+int avr_op_ORI::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
+
+    core->SetCoreReg(R1, core->GetCoreReg(R1) | K);
+
+    return 1;
+}
+
+avr_op_OUT::avr_op_OUT(word opcode):
+    DecodedInstruction(Exec),
     ioreg(get_A_6(opcode)),
-    R1(get_rd_5(opcode)) {}
+    R1(get_rd_5(opcode)) {
+    SetOperands(ioreg, R1);
+}
+
+int avr_op_OUT::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char ioreg = rec.op1;
+    unsigned char R1 = rec.op2;
 
-int avr_op_OUT::operator()() {
     core->SetIOReg(ioreg, core->GetCoreReg(R1));
 
     return 1;
 }
 
-avr_op_POP::avr_op_POP(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)) {}
+avr_op_POP::avr_op_POP(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_POP::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_POP::operator()() {
     core->SetCoreReg(R1, core->stack->Pop());
 
     return 2;
 }
 
-avr_op_PUSH::avr_op_PUSH(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)) {}
+avr_op_PUSH::avr_op_PUSH(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_PUSH::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_PUSH::operator()() {
     core->stack->Push(core->GetCoreReg(R1));
 
     return core->flagXMega ? 1 : 2;
 }
 
-avr_op_RCALL::avr_op_RCALL(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    K(n_bit_unsigned_to_signed(get_k_12(opcode), 12)) {}
+avr_op_RCALL::avr_op_RCALL(word opcode):
+    DecodedInstruction(Exec),
+    K(n_bit_unsigned_to_signed(get_k_12(opcode), 12)) {
+    SetOperands(0, 0, K);
+}
+
+int avr_op_RCALL::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    signed int K = rec.k;
 
-int avr_op_RCALL::operator()() {
     core->stack->PushAddr(core->PC + 1);
     core->stack->m_ThreadList.OnCall();
     core->DebugOnJump();
@@ -1217,31 +1571,36 @@ int avr_op_RCALL::operator()() {
     
 }
 
-avr_op_RET::avr_op_RET(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+avr_op_RET::avr_op_RET(word opcode):
+    DecodedInstruction(Exec) {}
 
-int avr_op_RET::operator()() {
+int avr_op_RET::Exec(AvrDevice *core, const DecodedRecord &rec) {
     core->PC = core->stack->PopAddr() - 1;
 
     return core->PC_size + 2;
 }
 
-avr_op_RETI::avr_op_RETI(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    status(c->status) {}
+avr_op_RETI::avr_op_RETI(word opcode):
+    DecodedInstruction(Exec) {}
+
+int avr_op_RETI::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    HWSreg *status = core->status;
 
-int avr_op_RETI::operator()() {
     core->PC = core->stack->PopAddr() - 1;
     status->I = 1;
 
     return core->PC_size + 2;
 }
 
-avr_op_RJMP::avr_op_RJMP(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    K(n_bit_unsigned_to_signed(get_k_12(opcode), 12)) {}
+avr_op_RJMP::avr_op_RJMP(word opcode):
+    DecodedInstruction(Exec),
+    K(n_bit_unsigned_to_signed(get_k_12(opcode), 12)) {
+    SetOperands(0, 0, K);
+}
+
+int avr_op_RJMP::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    signed int K = rec.k;
 
-int avr_op_RJMP::operator()() {
     core->DebugOnJump();
     core->PC += K;
     core->PC &= (core->Flash->GetSize() - 1) >> 1;
@@ -1249,91 +1608,128 @@ int avr_op_RJMP::operator()() {
     return 2;
 }
 
-avr_op_ROR::avr_op_ROR(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)),
-    status(c->status) {}
+avr_op_ROR::avr_op_ROR(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+    SetRegisterOp(HWSreg::SREG_C, FLAGS_SVNZC, ExecNoFlags);
+}
+
+int avr_op_ROR::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    HWSreg *status = core->status;
+    status->Update();
 
-int avr_op_ROR::operator()() {
     byte rd = core->GetCoreReg(R1);
 
     byte res = (rd >> 1) | ((status->C << 7) & 0x80);
 
-    status->C = rd & 0x1;
-    status->N = (res >> 7) & 0x1;
-    status->V = status->N ^ status->C;
-    status->S = status->N ^ status->V;
-    status->Z = res == 0;
+    status->SetLazy(HWSreg::LAZY_SHIFT, res, rd);
 
     core->SetCoreReg(R1, res);
 
     return 1;
 }
 
+int avr_op_ROR::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+
+    byte rd = core->GetCoreReg(R1);
+    core->status->Update();
+    core->SetCoreReg(R1, (rd >> 1) | ((core->status->C << 7) & 0x80));
+
+    return 1;
+}
+
 
-avr_op_SBC::avr_op_SBC(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_SBC::avr_op_SBC(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    R2(get_rr_5(opcode)),
-    status(c->status) {}
+    R2(get_rr_5(opcode)) {
+    SetOperands(R1, R2);
+    SetRegisterOp(HWSreg::SREG_C | HWSreg::SREG_Z, FLAGS_HSVNZC, ExecNoFlags);
+}
 
 unsigned char avr_op_SBC::GetModifiedR() const {
     return R1;
 }
-int avr_op_SBC::operator()() {
+int avr_op_SBC::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+    HWSreg *status = core->status;
+    status->Update();
+
     byte rd = core->GetCoreReg(R1);
     byte rr = core->GetCoreReg(R2);
 
     byte res = rd - rr - status->C;
 
-    status->H = get_sub_carry(res, rd, rr, 3);
-    status->V = get_sub_overflow(res, rd, rr);
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->C = get_sub_carry(res, rd, rr, 7);
-
-    if((res & 0xff) != 0)
-        status->Z = 0;
+    status->SetLazy(HWSreg::LAZY_SBC, res, rd, rr);
 
     core->SetCoreReg(R1, res);
 
     return 1;
 }
 
-avr_op_SBCI::avr_op_SBCI(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+int avr_op_SBC::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+
+    core->status->Update();
+    core->SetCoreReg(R1, core->GetCoreReg(R1) - core->GetCoreReg(R2) - core->status->C);
+
+    return 1;
+}
+
+avr_op_SBCI::avr_op_SBCI(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_4(opcode)),
-    K(get_K_8(opcode)),
-    status(c->status) {}
+    K(get_K_8(opcode)) {
+    SetOperands(R1, K);
+    SetRegisterOp(HWSreg::SREG_C | HWSreg::SREG_Z, FLAGS_HSVNZC, ExecNoFlags);
+}
 
 unsigned char avr_op_SBCI::GetModifiedR() const {
     return R1;
 }
-int avr_op_SBCI::operator()() {
+int avr_op_SBCI::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
+    HWSreg *status = core->status;
+    status->Update();
+
     byte rd = core->GetCoreReg(R1);
 
     byte res = rd - K - status->C;
 
-    status->H = get_sub_carry(res, rd, K, 3);
-    status->V = get_sub_overflow(res, rd, K);
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->C = get_sub_carry(res, rd, K, 7);
-
-    if((res & 0xff) != 0)
-        status->Z = 0;
+    status->SetLazy(HWSreg::LAZY_SBC, res, rd, K);
 
     core->SetCoreReg(R1, res);
 
     return 1;
 }
 
-avr_op_SBI::avr_op_SBI(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+int avr_op_SBCI::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
+
+    core->status->Update();
+    core->SetCoreReg(R1, core->GetCoreReg(R1) - K - core->status->C);
+
+    return 1;
+}
+
+avr_op_SBI::avr_op_SBI(word opcode):
+    DecodedInstruction(Exec),
     ioreg(get_A_5(opcode)),
-    Kbit(get_reg_bit(opcode)) {}
+    Kbit(get_reg_bit(opcode)) {
+    SetOperands(ioreg, Kbit);
+}
+
+int avr_op_SBI::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char ioreg = rec.op1;
+    unsigned char Kbit = rec.op2;
 
-int avr_op_SBI::operator()() {
     int clks = (core->flagXMega || core->flagTiny10) ? 1 : 2;
     
     core->SetIORegBit(ioreg, Kbit, true);
@@ -1341,15 +1737,20 @@ int avr_op_SBI::operator()() {
     return clks;
 }
 
-avr_op_SBIC::avr_op_SBIC(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_SBIC::avr_op_SBIC(word opcode):
+    DecodedInstruction(Exec),
     ioreg(get_A_5(opcode)),
-    Kbit(get_reg_bit(opcode)) {}
+    Kbit(get_reg_bit(opcode)) {
+    SetOperands(ioreg, Kbit);
+}
+
+int avr_op_SBIC::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char ioreg = rec.op1;
+    unsigned char Kbit = rec.op2;
 
-int avr_op_SBIC::operator()() {
     int skip, clks;
 
-    if(core->Flash->DecodedMem[core->PC + 1]->IsInstruction2Words())
+    if(core->Flash->IsInstruction2Words(core->PC + 1))
         skip = 3;
     else
         skip = 2;
@@ -1367,15 +1768,20 @@ int avr_op_SBIC::operator()() {
     return clks;
 }
 
-avr_op_SBIS::avr_op_SBIS(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_SBIS::avr_op_SBIS(word opcode):
+    DecodedInstruction(Exec),
     ioreg(get_A_5(opcode)),
-    Kbit(get_reg_bit(opcode)) {}
+    Kbit(get_reg_bit(opcode)) {
+    SetOperands(ioreg, Kbit);
+}
+
+int avr_op_SBIS::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char ioreg = rec.op1;
+    unsigned char Kbit = rec.op2;
 
-int avr_op_SBIS::operator()() {
     int skip, clks;
 
-    if(core->Flash->DecodedMem[core->PC + 1]->IsInstruction2Words())
+    if(core->Flash->IsInstruction2Words(core->PC + 1))
         skip = 3;
     else
         skip = 2;
@@ -1394,11 +1800,13 @@ int avr_op_SBIS::operator()() {
 }
 
 
-avr_op_SBIW::avr_op_SBIW(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_SBIW::avr_op_SBIW(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_2(opcode)),
-    K(get_K_6(opcode)),
-    status(c->status) {}
+    K(get_K_6(opcode)) {
+    SetOperands(R1, K);
+    SetRegisterOp(0, FLAGS_SVNZC, ExecNoFlags);
+}
 
 unsigned char avr_op_SBIW::GetModifiedR() const {
     return R1;
@@ -1406,18 +1814,18 @@ unsigned char avr_op_SBIW::GetModifiedR() const {
 unsigned char avr_op_SBIW::GetModifiedRHi() const {
     return R1 + 1;
 }
-int avr_op_SBIW::operator()() {
+int avr_op_SBIW::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
+    HWSreg *status = core->status;
+
     byte rdl = core->GetCoreReg(R1);
     byte rdh = core->GetCoreReg(R1 + 1);
 
     word rd = (rdh << 8) + rdl;
     word res = rd - K;
 
-    status->V = (rdh >> 7 & 0x1) & ~(res >> 15 & 0x1);
-    status->N = (res >> 15) & 0x1;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xffff) == 0;
-    status->C = (res >> 15 & 0x1) & ~(rdh >> 7 & 0x1);
+    status->SetLazy(HWSreg::LAZY_SBIW, res, rdh);
 
     core->SetCoreReg(R1, res & 0xff);
     core->SetCoreReg(R1 + 1, (res >> 8) & 0xff);
@@ -1425,15 +1833,32 @@ int avr_op_SBIW::operator()() {
     return 2;
 }
 
-avr_op_SBRC::avr_op_SBRC(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+int avr_op_SBIW::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
+
+    word res = (core->GetCoreReg(R1 + 1) << 8) + core->GetCoreReg(R1) - K;
+
+    core->SetCoreReg(R1, res & 0xff);
+    core->SetCoreReg(R1 + 1, (res >> 8) & 0xff);
+
+    return 2;
+}
+
+avr_op_SBRC::avr_op_SBRC(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    Kbit(get_reg_bit(opcode)) {}
+    Kbit(get_reg_bit(opcode)) {
+    SetOperands(R1, Kbit);
+}
+
+int avr_op_SBRC::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char Kbit = rec.op2;
 
-int avr_op_SBRC::operator()() {
     int skip, clks;
 
-    if(core->Flash->DecodedMem[core->PC + 1]->IsInstruction2Words())
+    if(core->Flash->IsInstruction2Words(core->PC + 1))
         skip = 3;
     else
         skip = 2;
@@ -1448,15 +1873,20 @@ int avr_op_SBRC::operator()() {
     return clks;
 }
 
-avr_op_SBRS::avr_op_SBRS(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_SBRS::avr_op_SBRS(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    Kbit(get_reg_bit(opcode)) {}
+    Kbit(get_reg_bit(opcode)) {
+    SetOperands(R1, Kbit);
+}
+
+int avr_op_SBRS::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char Kbit = rec.op2;
 
-int avr_op_SBRS::operator()() {
     int skip, clks;
 
-    if(core->Flash->DecodedMem[core->PC + 1]->IsInstruction2Words())
+    if(core->Flash->IsInstruction2Words(core->PC + 1))
         skip = 3;
     else
         skip = 2;
@@ -1471,38 +1901,19 @@ int avr_op_SBRS::operator()() {
     return clks;
 }
 
-avr_op_SLEEP::avr_op_SLEEP(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
-
-int avr_op_SLEEP::operator()() {
-#if 0  //TODO
-    MCUCR *mcucr = (MCUCR *)avr_core_get_vdev_by_name( core, "MCUCR" );
-
-    if (mcucr == NULL)
-        avr_error( "MCUCR register not installed" );
-
-    /* See if sleep mode is enabled */
-    if ( mcucr_get_bit(mcucr, bit_SE) )
-    {
-        if ( mcucr_get_bit(mcucr, bit_SM) == 0 )
-        {
-            /* Idle Mode */
-            avr_core_set_sleep_mode( core, SLEEP_MODE_IDLE);
-        }
-        else
-        {
-            /* Power Down Mode */
-            avr_core_set_sleep_mode( core, SLEEP_MODE_PWR_DOWN);
-        }
-    }
-#endif
+avr_op_SLEEP::avr_op_SLEEP(word opcode):
+    DecodedInstruction(Exec) {}
+
+int avr_op_SLEEP::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    // sleep modes are not distinguished, all hardware continues like in idle mode
+    core->Sleep();
     return 1;
 }
 
-avr_op_SPM::avr_op_SPM(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+avr_op_SPM::avr_op_SPM(word opcode):
+    DecodedInstruction(Exec) {}
 
-int avr_op_SPM::operator()() {
+int avr_op_SPM::Exec(AvrDevice *core, const DecodedRecord &rec) {
     unsigned char xaddr = 0;
     int cycles = 1;
     if(core->rampz != NULL)
@@ -1515,12 +1926,17 @@ int avr_op_SPM::operator()() {
     return cycles;
 }
 
-avr_op_STD_Y::avr_op_STD_Y(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_STD_Y::avr_op_STD_Y(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    K(get_q(opcode)) {}
+    K(get_q(opcode)) {
+    SetOperands(R1, K);
+}
+
+int avr_op_STD_Y::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
 
-int avr_op_STD_Y::operator()() {
     /* Y is R29:R28 */
     unsigned int Y = core->GetRegY();
 
@@ -1529,12 +1945,17 @@ int avr_op_STD_Y::operator()() {
     return (K == 0 && (core->flagXMega || core->flagTiny10)) ? 1 : 2;
 }
 
-avr_op_STD_Z::avr_op_STD_Z(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_STD_Z::avr_op_STD_Z(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    K(get_q(opcode)) {}
+    K(get_q(opcode)) {
+    SetOperands(R1, K);
+}
+
+int avr_op_STD_Z::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
 
-int avr_op_STD_Z::operator()() {
     /* Z is R31:R30 */
     int Z = core->GetRegZ();
 
@@ -1543,11 +1964,15 @@ int avr_op_STD_Z::operator()() {
     return (K == 0 && (core->flagXMega || core->flagTiny10)) ? 1 : 2;
 }
 
-avr_op_STS::avr_op_STS(word opcode, AvrDevice *c):
-    DecodedInstruction(c, true),
-    R1(get_rd_5(opcode)) {}
+avr_op_STS::avr_op_STS(word opcode):
+    DecodedInstruction(Exec, true),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_STS::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_STS::operator()() {
     /* Get data at k in current data segment and put into Rd */
     word k = core->Flash->ReadMemWord((core->PC + 1) * 2);
 
@@ -1557,11 +1982,15 @@ int avr_op_STS::operator()() {
     return 2;
 }
 
-avr_op_ST_X::avr_op_ST_X(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)) {}
+avr_op_ST_X::avr_op_ST_X(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_ST_X::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_ST_X::operator()() {
     /* X is R27:R26 */
     word X = core->GetRegX();
     
@@ -1570,11 +1999,15 @@ int avr_op_ST_X::operator()() {
     return (core->flagXMega || core->flagTiny10) ? 1 : 2;
 }
 
-avr_op_ST_X_decr::avr_op_ST_X_decr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)) {}
+avr_op_ST_X_decr::avr_op_ST_X_decr(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_ST_X_decr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_ST_X_decr::operator()() {
     /* X is R27:R26 */
     word X = core->GetRegX();
     if (R1 == 26 || R1 == 27)
@@ -1589,11 +2022,15 @@ int avr_op_ST_X_decr::operator()() {
     return 2;
 }
 
-avr_op_ST_X_incr::avr_op_ST_X_incr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)) {}
+avr_op_ST_X_incr::avr_op_ST_X_incr(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_ST_X_incr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_ST_X_incr::operator()() {
     /* X is R27:R26 */
     word X = core->GetRegX();
     if (R1 == 26 || R1 == 27)
@@ -1609,11 +2046,15 @@ int avr_op_ST_X_incr::operator()() {
     return (core->flagXMega || core->flagTiny10) ? 1 : 2;
 }
 
-avr_op_ST_Y_decr::avr_op_ST_Y_decr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)) {}
+avr_op_ST_Y_decr::avr_op_ST_Y_decr(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_ST_Y_decr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_ST_Y_decr::operator()() {
     /* Y is R29:R28 */
     word Y = core->GetRegY();
     if (R1 == 28 || R1 == 29)
@@ -1628,11 +2069,15 @@ int avr_op_ST_Y_decr::operator()() {
     return 2;
 }
 
-avr_op_ST_Y_incr::avr_op_ST_Y_incr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)) {}
+avr_op_ST_Y_incr::avr_op_ST_Y_incr(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_ST_Y_incr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_ST_Y_incr::operator()() {
     /* Y is R29:R28 */
     word Y = core->GetRegY();
     if (R1 == 28 || R1 == 29)
@@ -1648,11 +2093,15 @@ int avr_op_ST_Y_incr::operator()() {
     return (core->flagXMega || core->flagTiny10) ? 1 : 2;
 }
 
-avr_op_ST_Z_decr::avr_op_ST_Z_decr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)) {}
+avr_op_ST_Z_decr::avr_op_ST_Z_decr(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_ST_Z_decr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_ST_Z_decr::operator()() {
     /* Z is R31:R30 */
     word Z = core->GetRegZ();
     if (R1 == 30 || R1 == 31)
@@ -1667,11 +2116,15 @@ int avr_op_ST_Z_decr::operator()() {
     return 2;
 }
 
-avr_op_ST_Z_incr::avr_op_ST_Z_incr(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)) {}
+avr_op_ST_Z_incr::avr_op_ST_Z_incr(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+}
+
+int avr_op_ST_Z_incr::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_ST_Z_incr::operator()() {
     /* Z is R31:R30 */
     word Z = core->GetRegZ();
     if (R1 == 30 || R1 == 31)
@@ -1687,63 +2140,88 @@ int avr_op_ST_Z_incr::operator()() {
     return (core->flagXMega || core->flagTiny10) ? 1 : 2;
 }
 
-avr_op_SUB::avr_op_SUB(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+avr_op_SUB::avr_op_SUB(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_5(opcode)),
-    R2(get_rr_5(opcode)),
-    status(c->status) {}
+    R2(get_rr_5(opcode)) {
+    SetOperands(R1, R2);
+    SetRegisterOp(0, FLAGS_HSVNZC, ExecNoFlags);
+}
 
 unsigned char avr_op_SUB::GetModifiedR() const {
     return R1;
 }
-int avr_op_SUB::operator()() {
+int avr_op_SUB::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+    HWSreg *status = core->status;
+
     byte rd = core->GetCoreReg(R1);
     byte rr = core->GetCoreReg(R2);
 
     byte res = rd - rr;
 
-    status->H = get_sub_carry(res, rd, rr, 3);
-    status->V = get_sub_overflow(res, rd, rr);
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0;
-    status->C = get_sub_carry(res, rd, rr, 7);
+    status->SetLazy(HWSreg::LAZY_SUB, res, rd, rr);
     
     core->SetCoreReg(R1, res);
 
     return 1;
 }
 
-avr_op_SUBI::avr_op_SUBI(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
+int avr_op_SUB::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char R2 = rec.op2;
+
+    core->SetCoreReg(R1, core->GetCoreReg(R1) - core->GetCoreReg(R2));
+
+    return 1;
+}
+
+avr_op_SUBI::avr_op_SUBI(word opcode):
+    DecodedInstruction(Exec),
     R1(get_rd_4(opcode)),
-    status(c->status),
-    K(get_K_8(opcode)) {}
+    K(get_K_8(opcode)) {
+    SetOperands(R1, K);
+    SetRegisterOp(0, FLAGS_HSVNZC, ExecNoFlags);
+}
 
 unsigned char avr_op_SUBI::GetModifiedR() const {
     return R1;
 }
-int avr_op_SUBI::operator()() {
+int avr_op_SUBI::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
+    HWSreg *status = core->status;
+
     byte rd = core->GetCoreReg(R1);
     byte res = rd - K;
 
-    status->H = get_sub_carry(res, rd, K, 3);
-    status->V = get_sub_overflow(res, rd, K);
-    status->N = (res >> 7) & 0x1;
-    status->S = status->N ^ status->V;
-    status->Z = (res & 0xff) == 0;
-    status->C = get_sub_carry(res, rd, K, 7);
+    status->SetLazy(HWSreg::LAZY_SUB, res, rd, K);
 
     core->SetCoreReg(R1, res);
 
     return 1;
 }
 
-avr_op_SWAP::avr_op_SWAP(word opcode, AvrDevice *c):
-    DecodedInstruction(c),
-    R1(get_rd_5(opcode)) {}
+int avr_op_SUBI::ExecNoFlags(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
+    unsigned char K = rec.op2;
+
+    core->SetCoreReg(R1, core->GetCoreReg(R1) - K);
+
+    return 1;
+}
+
+avr_op_SWAP::avr_op_SWAP(word opcode):
+    DecodedInstruction(Exec),
+    R1(get_rd_5(opcode)) {
+    SetOperands(R1);
+    SetRegisterOp(0, 0);
+}
+
+int avr_op_SWAP::Exec(AvrDevice *core, const DecodedRecord &rec) {
+    unsigned char R1 = rec.op1;
 
-int avr_op_SWAP::operator()() {
     byte rd = core->GetCoreReg(R1);
     byte res = ((rd << 4) & 0xf0) | ((rd >> 4) & 0x0f);
 
@@ -1752,81 +2230,32 @@ int avr_op_SWAP::operator()() {
     return 1;
 }
 
-avr_op_WDR::avr_op_WDR(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+avr_op_WDR::avr_op_WDR(word opcode):
+    DecodedInstruction(Exec) {}
 
-int avr_op_WDR::operator()() {
+int avr_op_WDR::Exec(AvrDevice *core, const DecodedRecord &rec) {
     if(core->wado != NULL)
         core->wado->Wdr();
 
     return 1;
 }
 
-avr_op_BREAK::avr_op_BREAK(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+avr_op_BREAK::avr_op_BREAK(word opcode):
+    DecodedInstruction(Exec) {}
 
-int avr_op_BREAK::operator()() {
+int avr_op_BREAK::Exec(AvrDevice *core, const DecodedRecord &rec) {
     return BREAK_POINT+1;
 }
 
-avr_op_ILLEGAL::avr_op_ILLEGAL(word opcode, AvrDevice *c):
-    DecodedInstruction(c) {}
+avr_op_ILLEGAL::avr_op_ILLEGAL(word opcode):
+    DecodedInstruction(Exec) {}
 
-int avr_op_ILLEGAL::operator()() {
+int avr_op_ILLEGAL::Exec(AvrDevice *core, const DecodedRecord &rec) {
     avr_error("Illegal opcode '%02x %02x' executed at PC=0x%x (%d)! Simulation terminated!",
         core->Flash->myMemory[core->PC*2+1], core->Flash->myMemory[core->PC*2], core->PC*2, core->PC);
     return 0;
 }
 
-static int get_add_carry( byte res, byte rd, byte rr, int b )
-{
-    byte resb = res >> b & 0x1;
-    byte rdb  = rd  >> b & 0x1;
-    byte rrb  = rr  >> b & 0x1;
-    return (rdb & rrb) | (rrb & ~resb) | (~resb & rdb);
-}
-
-static int get_add_overflow( byte res, byte rd, byte rr )
-{
-    byte res7 = res >> 7 & 0x1;
-    byte rd7  = rd  >> 7 & 0x1;
-    byte rr7  = rr  >> 7 & 0x1;
-    return (rd7 & rr7 & ~res7) | (~rd7 & ~rr7 & res7);
-}
-
-static int get_sub_carry( byte res, byte rd, byte rr, int b )
-{
-    byte resb = res >> b & 0x1;
-    byte rdb  = rd  >> b & 0x1;
-    byte rrb  = rr  >> b & 0x1;
-    return (~rdb & rrb) | (rrb & resb) | (resb & ~rdb);
-}
-
-static int get_sub_overflow( byte res, byte rd, byte rr )
-{
-    byte res7 = res >> 7 & 0x1;
-    byte rd7  = rd  >> 7 & 0x1;
-    byte rr7  = rr  >> 7 & 0x1;
-    return (rd7 & ~rr7 & ~res7) | (~rd7 & rr7 & res7);
-}
-
-static int get_compare_carry( byte res, byte rd, byte rr, int b )
-{
-    byte resb = res >> b & 0x1;
-    byte rdb  = rd  >> b & 0x1;
-    byte rrb  = rr  >> b & 0x1;
-    return (~rdb & rrb) | (rrb & resb) | (resb & ~rdb);
-}
-
-static int get_compare_overflow( byte res, byte rd, byte rr )
-{
-    byte res7 = res >> 7 & 0x1;
-    byte rd7  = rd  >> 7 & 0x1;
-    byte rr7  = rr  >> 7 & 0x1;
-    /* The atmel data sheet says the second term is ~rd7 for CP
-     * but that doesn't make any sense. You be the judge. */
-    return (rd7 & ~rr7 & ~res7) | (~rd7 & rr7 & res7);
-}
 static int n_bit_unsigned_to_signed( unsigned int val, int n ) 
 {
     /* Convert n-bit unsigned value to a signed value. */
@@ -1954,234 +2383,234 @@ DecodedInstruction* lookup_opcode( word opcode, AvrDevice *core )
         /* opcodes with no operands */
         case 0x9519:
             if(core->flagEIJMPInstructions)
-                return new avr_op_EICALL(opcode, core);                    /* 1001 0101 0001 1001 | EICALL */
+                return new avr_op_EICALL(opcode);                          /* 1001 0101 0001 1001 | EICALL */
             else
-                return new avr_op_ILLEGAL(opcode, core);
+                return new avr_op_ILLEGAL(opcode);
         case 0x9419:
             if(core->flagEIJMPInstructions)
-                return new avr_op_EIJMP(opcode, core);                     /* 1001 0100 0001 1001 | EIJMP */
+                return new avr_op_EIJMP(opcode);                           /* 1001 0100 0001 1001 | EIJMP */
             else
-                return new avr_op_ILLEGAL(opcode, core);
+                return new avr_op_ILLEGAL(opcode);
         case 0x95D8:
             if(core->flagELPMInstructions)
-                return new avr_op_ELPM(opcode, core);                      /* 1001 0101 1101 1000 | ELPM */
+                return new avr_op_ELPM(opcode);                            /* 1001 0101 1101 1000 | ELPM */
             else
-                return new avr_op_ILLEGAL(opcode, core);
+                return new avr_op_ILLEGAL(opcode);
         case 0x95F8:
             if(core->flagLPMInstructions)
-                return new avr_op_ESPM(opcode, core);                      /* 1001 0101 1111 1000 | ESPM */
+                return new avr_op_ESPM(opcode);                            /* 1001 0101 1111 1000 | ESPM */
             else
-                return new avr_op_ILLEGAL(opcode, core);
+                return new avr_op_ILLEGAL(opcode);
         case 0x9509:
             if(core->flagIJMPInstructions)
-                return new avr_op_ICALL(opcode, core);                     /* 1001 0101 0000 1001 | ICALL */
+                return new avr_op_ICALL(opcode);                           /* 1001 0101 0000 1001 | ICALL */
             else
-                return new avr_op_ILLEGAL(opcode, core);
+                return new avr_op_ILLEGAL(opcode);
         case 0x9409:
             if(core->flagIJMPInstructions)
-                return new avr_op_IJMP(opcode, core);                      /* 1001 0100 0000 1001 | IJMP */
+                return new avr_op_IJMP(opcode);                            /* 1001 0100 0000 1001 | IJMP */
             else
-                return new avr_op_ILLEGAL(opcode, core);
+                return new avr_op_ILLEGAL(opcode);
         case 0x95C8:
             if(!core->flagTiny10)
                 /* except tiny10, all devices provide LPM instruction! */
-                return new avr_op_LPM(opcode, core);                       /* 1001 0101 1100 1000 | LPM */
+                return new avr_op_LPM(opcode);                             /* 1001 0101 1100 1000 | LPM */
             else
-                return new avr_op_ILLEGAL(opcode, core);
-        case 0x0000: return new  avr_op_NOP(opcode, core);                 /* 0000 0000 0000 0000 | NOP */
-        case 0x9508: return new  avr_op_RET(opcode, core);                 /* 1001 0101 0000 1000 | RET */
-        case 0x9518: return new  avr_op_RETI(opcode, core);                /* 1001 0101 0001 1000 | RETI */
-        case 0x9588: return new  avr_op_SLEEP(opcode, core);               /* 1001 0101 1000 1000 | SLEEP */
+                return new avr_op_ILLEGAL(opcode);
+        case 0x0000: return new  avr_op_NOP(opcode);                       /* 0000 0000 0000 0000 | NOP */
+        case 0x9508: return new  avr_op_RET(opcode);                       /* 1001 0101 0000 1000 | RET */
+        case 0x9518: return new  avr_op_RETI(opcode);                      /* 1001 0101 0001 1000 | RETI */
+        case 0x9588: return new  avr_op_SLEEP(opcode);                     /* 1001 0101 1000 1000 | SLEEP */
         case 0x95E8:
             if(core->flagLPMInstructions)
-                return new avr_op_SPM(opcode, core);                       /* 1001 0101 1110 1000 | SPM */
+                return new avr_op_SPM(opcode);                             /* 1001 0101 1110 1000 | SPM */
             else
-                return new avr_op_ILLEGAL(opcode, core);
-        case 0x95A8: return new  avr_op_WDR(opcode, core);                 /* 1001 0101 1010 1000 | WDR */
-        case 0x9598: return new  avr_op_BREAK(opcode, core);               /* 1001 0101 1001 1000 | BREAK */
+                return new avr_op_ILLEGAL(opcode);
+        case 0x95A8: return new  avr_op_WDR(opcode);                       /* 1001 0101 1010 1000 | WDR */
+        case 0x9598: return new  avr_op_BREAK(opcode);                     /* 1001 0101 1001 1000 | BREAK */
         default:
                      {
                          /* opcodes with two 5-bit register (Rd and Rr) operands */
                          decode = opcode & ~(mask_Rd_5 | mask_Rr_5);
                          switch ( decode ) {
-                             case 0x1C00: return new  avr_op_ADC(opcode, core);         /* 0001 11rd dddd rrrr | ADC or ROL */
-                             case 0x0C00: return new  avr_op_ADD(opcode, core);         /* 0000 11rd dddd rrrr | ADD or LSL */
-                             case 0x2000: return new  avr_op_AND(opcode, core);         /* 0010 00rd dddd rrrr | AND or TST */
-                             case 0x1400: return new  avr_op_CP(opcode, core);          /* 0001 01rd dddd rrrr | CP */
-                             case 0x0400: return new  avr_op_CPC(opcode, core);         /* 0000 01rd dddd rrrr | CPC */
-                             case 0x1000: return new  avr_op_CPSE(opcode, core);        /* 0001 00rd dddd rrrr | CPSE */
-                             case 0x2400: return new  avr_op_EOR(opcode, core);         /* 0010 01rd dddd rrrr | EOR or CLR */
-                             case 0x2C00: return new  avr_op_MOV(opcode, core);         /* 0010 11rd dddd rrrr | MOV */
+                             case 0x1C00: return new  avr_op_ADC(opcode);               /* 0001 11rd dddd rrrr | ADC or ROL */
+                             case 0x0C00: return new  avr_op_ADD(opcode);               /* 0000 11rd dddd rrrr | ADD or LSL */
+                             case 0x2000: return new  avr_op_AND(opcode);               /* 0010 00rd dddd rrrr | AND or TST */
+                             case 0x1400: return new  avr_op_CP(opcode);                /* 0001 01rd dddd rrrr | CP */
+                             case 0x0400: return new  avr_op_CPC(opcode);               /* 0000 01rd dddd rrrr | CPC */
+                             case 0x1000: return new  avr_op_CPSE(opcode);              /* 0001 00rd dddd rrrr | CPSE */
+                             case 0x2400: return new  avr_op_EOR(opcode);               /* 0010 01rd dddd rrrr | EOR or CLR */
+                             case 0x2C00: return new  avr_op_MOV(opcode);               /* 0010 11rd dddd rrrr | MOV */
                              case 0x9C00:
                                  if(core->flagMULInstructions)
-                                     return new avr_op_MUL(opcode, core);               /* 1001 11rd dddd rrrr | MUL */
+                                     return new avr_op_MUL(opcode);                     /* 1001 11rd dddd rrrr | MUL */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
-                             case 0x2800: return new  avr_op_OR(opcode, core);          /* 0010 10rd dddd rrrr | OR */
-                             case 0x0800: return new  avr_op_SBC(opcode, core);         /* 0000 10rd dddd rrrr | SBC */
-                             case 0x1800: return new  avr_op_SUB(opcode, core);         /* 0001 10rd dddd rrrr | SUB */
+                                     return new avr_op_ILLEGAL(opcode);
+                             case 0x2800: return new  avr_op_OR(opcode);                /* 0010 10rd dddd rrrr | OR */
+                             case 0x0800: return new  avr_op_SBC(opcode);               /* 0000 10rd dddd rrrr | SBC */
+                             case 0x1800: return new  avr_op_SUB(opcode);               /* 0001 10rd dddd rrrr | SUB */
                          }
 
                          /* opcode with a single register (Rd) as operand */
                          decode = opcode & ~(mask_Rd_5);
                          switch (decode) {
-                             case 0x9405: return new  avr_op_ASR(opcode, core);         /* 1001 010d dddd 0101 | ASR */
-                             case 0x9400: return new  avr_op_COM(opcode, core);         /* 1001 010d dddd 0000 | COM */
-                             case 0x940A: return new  avr_op_DEC(opcode, core);         /* 1001 010d dddd 1010 | DEC */
+                             case 0x9405: return new  avr_op_ASR(opcode);               /* 1001 010d dddd 0101 | ASR */
+                             case 0x9400: return new  avr_op_COM(opcode);               /* 1001 010d dddd 0000 | COM */
+                             case 0x940A: return new  avr_op_DEC(opcode);               /* 1001 010d dddd 1010 | DEC */
                              case 0x9006:
                                  if(core->flagELPMInstructions)
-                                     return new avr_op_ELPM_Z(opcode, core);            /* 1001 000d dddd 0110 | ELPM */
+                                     return new avr_op_ELPM_Z(opcode);                  /* 1001 000d dddd 0110 | ELPM */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x9007:
                                  if(core->flagELPMInstructions)
-                                     return new avr_op_ELPM_Z_incr(opcode, core);       /* 1001 000d dddd 0111 | ELPM */
+                                     return new avr_op_ELPM_Z_incr(opcode);             /* 1001 000d dddd 0111 | ELPM */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
-                             case 0x9403: return new  avr_op_INC(opcode, core);         /* 1001 010d dddd 0011 | INC */
-                             case 0x9000: return new  avr_op_LDS(opcode, core);         /* 1001 000d dddd 0000 | LDS */
+                                     return new avr_op_ILLEGAL(opcode);
+                             case 0x9403: return new  avr_op_INC(opcode);               /* 1001 010d dddd 0011 | INC */
+                             case 0x9000: return new  avr_op_LDS(opcode);               /* 1001 000d dddd 0000 | LDS */
                              case 0x900C:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_LD_X(opcode, core);              /* 1001 000d dddd 1100 | LD */
+                                     return new avr_op_LD_X(opcode);                    /* 1001 000d dddd 1100 | LD */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x900E:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_LD_X_decr(opcode, core);         /* 1001 000d dddd 1110 | LD */
+                                     return new avr_op_LD_X_decr(opcode);               /* 1001 000d dddd 1110 | LD */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x900D:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_LD_X_incr(opcode, core);         /* 1001 000d dddd 1101 | LD */
+                                     return new avr_op_LD_X_incr(opcode);               /* 1001 000d dddd 1101 | LD */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x8008:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_LDD_Y(opcode, core);             /* 1000 000d dddd 1000 | LD */
+                                     return new avr_op_LDD_Y(opcode);                   /* 1000 000d dddd 1000 | LD */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x900A:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_LD_Y_decr(opcode, core);         /* 1001 000d dddd 1010 | LD */
+                                     return new avr_op_LD_Y_decr(opcode);               /* 1001 000d dddd 1010 | LD */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x9009:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_LD_Y_incr(opcode, core);         /* 1001 000d dddd 1001 | LD */
+                                     return new avr_op_LD_Y_incr(opcode);               /* 1001 000d dddd 1001 | LD */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
-                             case 0x8000: return new avr_op_LDD_Z(opcode, core);        /* 1000 000d dddd 0000 | LD */
+                                     return new avr_op_ILLEGAL(opcode);
+                             case 0x8000: return new avr_op_LDD_Z(opcode);              /* 1000 000d dddd 0000 | LD */
                              case 0x9002:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_LD_Z_decr(opcode, core);         /* 1001 000d dddd 0010 | LD */
+                                     return new avr_op_LD_Z_decr(opcode);               /* 1001 000d dddd 0010 | LD */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x9001:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_LD_Z_incr(opcode, core);         /* 1001 000d dddd 0001 | LD */
+                                     return new avr_op_LD_Z_incr(opcode);               /* 1001 000d dddd 0001 | LD */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x9004:
                                  if(core->flagLPMInstructions)
-                                     return new avr_op_LPM_Z(opcode, core);             /* 1001 000d dddd 0100 | LPM */
+                                     return new avr_op_LPM_Z(opcode);                   /* 1001 000d dddd 0100 | LPM */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x9005:
                                  if(core->flagLPMInstructions)
-                                     return new avr_op_LPM_Z_incr(opcode, core);        /* 1001 000d dddd 0101 | LPM */
+                                     return new avr_op_LPM_Z_incr(opcode);              /* 1001 000d dddd 0101 | LPM */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
-                             case 0x9406: return new  avr_op_LSR(opcode, core);         /* 1001 010d dddd 0110 | LSR */
-                             case 0x9401: return new  avr_op_NEG(opcode, core);         /* 1001 010d dddd 0001 | NEG */
+                                     return new avr_op_ILLEGAL(opcode);
+                             case 0x9406: return new  avr_op_LSR(opcode);               /* 1001 010d dddd 0110 | LSR */
+                             case 0x9401: return new  avr_op_NEG(opcode);               /* 1001 010d dddd 0001 | NEG */
                              case 0x900F:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_POP(opcode, core);               /* 1001 000d dddd 1111 | POP */
+                                     return new avr_op_POP(opcode);                     /* 1001 000d dddd 1111 | POP */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x920F:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_PUSH(opcode, core);              /* 1001 001d dddd 1111 | PUSH */
+                                     return new avr_op_PUSH(opcode);                    /* 1001 001d dddd 1111 | PUSH */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
-                             case 0x9407: return new  avr_op_ROR(opcode, core);         /* 1001 010d dddd 0111 | ROR */
-                             case 0x9200: return new  avr_op_STS(opcode, core);         /* 1001 001d dddd 0000 | STS */
+                                     return new avr_op_ILLEGAL(opcode);
+                             case 0x9407: return new  avr_op_ROR(opcode);               /* 1001 010d dddd 0111 | ROR */
+                             case 0x9200: return new  avr_op_STS(opcode);               /* 1001 001d dddd 0000 | STS */
                              case 0x920C:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_ST_X(opcode, core);              /* 1001 001d dddd 1100 | ST */
+                                     return new avr_op_ST_X(opcode);                    /* 1001 001d dddd 1100 | ST */
                              case 0x920E:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_ST_X_decr(opcode, core);         /* 1001 001d dddd 1110 | ST */
+                                     return new avr_op_ST_X_decr(opcode);               /* 1001 001d dddd 1110 | ST */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x920D:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_ST_X_incr(opcode, core);         /* 1001 001d dddd 1101 | ST */
+                                     return new avr_op_ST_X_incr(opcode);               /* 1001 001d dddd 1101 | ST */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x8208:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_STD_Y(opcode, core);             /* 1000 001d dddd 1000 | ST */
+                                     return new avr_op_STD_Y(opcode);                   /* 1000 001d dddd 1000 | ST */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x920A:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_ST_Y_decr(opcode, core);         /* 1001 001d dddd 1010 | ST */
+                                     return new avr_op_ST_Y_decr(opcode);               /* 1001 001d dddd 1010 | ST */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x9209:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_ST_Y_incr(opcode, core);         /* 1001 001d dddd 1001 | ST */
+                                     return new avr_op_ST_Y_incr(opcode);               /* 1001 001d dddd 1001 | ST */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
-                             case 0x8200: return new  avr_op_STD_Z(opcode, core);       /* 1000 001d dddd 0000 | ST */
+                                     return new avr_op_ILLEGAL(opcode);
+                             case 0x8200: return new  avr_op_STD_Z(opcode);             /* 1000 001d dddd 0000 | ST */
                              case 0x9202:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_ST_Z_decr(opcode, core);         /* 1001 001d dddd 0010 | ST */
+                                     return new avr_op_ST_Z_decr(opcode);               /* 1001 001d dddd 0010 | ST */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x9201:
                                  if(!core->flagTiny1x)
-                                     return new avr_op_ST_Z_incr(opcode, core);         /* 1001 001d dddd 0001 | ST */
+                                     return new avr_op_ST_Z_incr(opcode);               /* 1001 001d dddd 0001 | ST */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
-                             case 0x9402: return new  avr_op_SWAP(opcode, core);        /* 1001 010d dddd 0010 | SWAP */
+                                     return new avr_op_ILLEGAL(opcode);
+                             case 0x9402: return new  avr_op_SWAP(opcode);              /* 1001 010d dddd 0010 | SWAP */
                          }
 
                          /* opcodes with a register (Rd) and a constant data (K) as operands */
                          decode = opcode & ~(mask_Rd_4 | mask_K_8);
                          switch ( decode ) {
-                             case 0x7000: return new  avr_op_ANDI(opcode, core);        /* 0111 KKKK dddd KKKK | CBR or ANDI */
-                             case 0x3000: return new  avr_op_CPI(opcode, core);         /* 0011 KKKK dddd KKKK | CPI */
-                             case 0xE000: return new  avr_op_LDI(opcode, core);         /* 1110 KKKK dddd KKKK | LDI or SER */
-                             case 0x6000: return new  avr_op_ORI(opcode, core);         /* 0110 KKKK dddd KKKK | SBR or ORI */
-                             case 0x4000: return new  avr_op_SBCI(opcode, core);        /* 0100 KKKK dddd KKKK | SBCI */
-                             case 0x5000: return new  avr_op_SUBI(opcode, core);        /* 0101 KKKK dddd KKKK | SUBI */
+                             case 0x7000: return new  avr_op_ANDI(opcode);              /* 0111 KKKK dddd KKKK | CBR or ANDI */
+                             case 0x3000: return new  avr_op_CPI(opcode);               /* 0011 KKKK dddd KKKK | CPI */
+                             case 0xE000: return new  avr_op_LDI(opcode);               /* 1110 KKKK dddd KKKK | LDI or SER */
+                             case 0x6000: return new  avr_op_ORI(opcode);               /* 0110 KKKK dddd KKKK | SBR or ORI */
+                             case 0x4000: return new  avr_op_SBCI(opcode);              /* 0100 KKKK dddd KKKK | SBCI */
+                             case 0x5000: return new  avr_op_SUBI(opcode);              /* 0101 KKKK dddd KKKK | SUBI */
                          }
 
                          /* opcodes with a register (Rd) and a register bit number (b) as operands */
                          decode = opcode & ~(mask_Rd_5 | mask_reg_bit);
                          switch ( decode ) {
-                             case 0xF800: return new  avr_op_BLD(opcode, core);         /* 1111 100d dddd 0bbb | BLD */
-                             case 0xFA00: return new  avr_op_BST(opcode, core);         /* 1111 101d dddd 0bbb | BST */
-                             case 0xFC00: return new  avr_op_SBRC(opcode, core);        /* 1111 110d dddd 0bbb | SBRC */
-                             case 0xFE00: return new  avr_op_SBRS(opcode, core);        /* 1111 111d dddd 0bbb | SBRS */
+                             case 0xF800: return new  avr_op_BLD(opcode);               /* 1111 100d dddd 0bbb | BLD */
+                             case 0xFA00: return new  avr_op_BST(opcode);               /* 1111 101d dddd 0bbb | BST */
+                             case 0xFC00: return new  avr_op_SBRC(opcode);              /* 1111 110d dddd 0bbb | SBRC */
+                             case 0xFE00: return new  avr_op_SBRS(opcode);              /* 1111 111d dddd 0bbb | SBRS */
                          }
 
                          /* opcodes with a relative 7-bit address (k) and a register bit number (b) as operands */
                          decode = opcode & ~(mask_k_7 | mask_reg_bit);
                          switch ( decode ) {
-                             case 0xF400: return new  avr_op_BRBC(opcode, core);        /* 1111 01kk kkkk kbbb | BRBC */
-                             case 0xF000: return new  avr_op_BRBS(opcode, core);        /* 1111 00kk kkkk kbbb | BRBS */
+                             case 0xF400: return new  avr_op_BRBC(opcode);              /* 1111 01kk kkkk kbbb | BRBC */
+                             case 0xF000: return new  avr_op_BRBS(opcode);              /* 1111 00kk kkkk kbbb | BRBS */
                          }
 
                          /* opcodes with a 6-bit address displacement (q) and a register (Rd) as operands */
                          if(!core->flagTiny10 && !core->flagTiny1x) {
                              decode = opcode & ~(mask_Rd_5 | mask_q_displ);
                              switch ( decode ) {
-                                 case 0x8008: return new  avr_op_LDD_Y(opcode, core);   /* 10q0 qq0d dddd 1qqq | LDD */
-                                 case 0x8000: return new  avr_op_LDD_Z(opcode, core);   /* 10q0 qq0d dddd 0qqq | LDD */
-                                 case 0x8208: return new  avr_op_STD_Y(opcode, core);   /* 10q0 qq1d dddd 1qqq | STD */
-                                 case 0x8200: return new  avr_op_STD_Z(opcode, core);   /* 10q0 qq1d dddd 0qqq | STD */
+                                 case 0x8008: return new  avr_op_LDD_Y(opcode);         /* 10q0 qq0d dddd 1qqq | LDD */
+                                 case 0x8000: return new  avr_op_LDD_Z(opcode);         /* 10q0 qq0d dddd 0qqq | LDD */
+                                 case 0x8208: return new  avr_op_STD_Y(opcode);         /* 10q0 qq1d dddd 1qqq | STD */
+                                 case 0x8200: return new  avr_op_STD_Z(opcode);         /* 10q0 qq1d dddd 0qqq | STD */
                              }
                          }
                          
@@ -2190,14 +2619,14 @@ DecodedInstruction* lookup_opcode( word opcode, AvrDevice *core )
                          switch ( decode ) {
                              case 0x940E:
                                  if(core->flagJMPInstructions)
-                                     return new avr_op_CALL(opcode, core);              /* 1001 010k kkkk 111k | CALL */
+                                     return new avr_op_CALL(opcode);                    /* 1001 010k kkkk 111k | CALL */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x940C:
                                  if(core->flagJMPInstructions)
-                                     return new avr_op_JMP(opcode, core);               /* 1001 010k kkkk 110k | JMP */
+                                     return new avr_op_JMP(opcode);                     /* 1001 010k kkkk 110k | JMP */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                          }
 
                          /* opcode with a sreg bit select (s) operand */
@@ -2205,8 +2634,8 @@ DecodedInstruction* lookup_opcode( word opcode, AvrDevice *core )
                          switch ( decode ) {
                              /* BCLR takes place of CL{C,Z,N,V,S,H,T,I} */
                              /* BSET takes place of SE{C,Z,N,V,S,H,T,I} */
-                             case 0x9488: return new  avr_op_BCLR(opcode, core);        /* 1001 0100 1sss 1000 | BCLR */
-                             case 0x9408: return new  avr_op_BSET(opcode, core);        /* 1001 0100 0sss 1000 | BSET */
+                             case 0x9488: return new  avr_op_BCLR(opcode);              /* 1001 0100 1sss 1000 | BCLR */
+                             case 0x9408: return new  avr_op_BSET(opcode);              /* 1001 0100 0sss 1000 | BSET */
                          }
 
                          /* opcodes with a 6-bit constant (K) and a register (Rd) as operands */
@@ -2214,37 +2643,37 @@ DecodedInstruction* lookup_opcode( word opcode, AvrDevice *core )
                          switch ( decode ) {
                              case 0x9600:
                                  if(core->flagIWInstructions)
-                                     return new avr_op_ADIW(opcode, core);              /* 1001 0110 KKdd KKKK | ADIW */
+                                     return new avr_op_ADIW(opcode);                    /* 1001 0110 KKdd KKKK | ADIW */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x9700:
                                  if(core->flagIWInstructions)
-                                     return new avr_op_SBIW(opcode, core);              /* 1001 0111 KKdd KKKK | SBIW */
+                                     return new avr_op_SBIW(opcode);                    /* 1001 0111 KKdd KKKK | SBIW */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                          }
 
                          /* opcodes with a 5-bit IO Addr (A) and register bit number (b) as operands */
                          decode = opcode & ~(mask_A_5 | mask_reg_bit);
                          switch ( decode ) {
-                             case 0x9800: return new  avr_op_CBI(opcode, core);         /* 1001 1000 AAAA Abbb | CBI */
-                             case 0x9A00: return new  avr_op_SBI(opcode, core);         /* 1001 1010 AAAA Abbb | SBI */
-                             case 0x9900: return new  avr_op_SBIC(opcode, core);        /* 1001 1001 AAAA Abbb | SBIC */
-                             case 0x9B00: return new  avr_op_SBIS(opcode, core);        /* 1001 1011 AAAA Abbb | SBIS */
+                             case 0x9800: return new  avr_op_CBI(opcode);               /* 1001 1000 AAAA Abbb | CBI */
+                             case 0x9A00: return new  avr_op_SBI(opcode);               /* 1001 1010 AAAA Abbb | SBI */
+                             case 0x9900: return new  avr_op_SBIC(opcode);              /* 1001 1001 AAAA Abbb | SBIC */
+                             case 0x9B00: return new  avr_op_SBIS(opcode);              /* 1001 1011 AAAA Abbb | SBIS */
                          }
 
                          /* opcodes with a 6-bit IO Addr (A) and register (Rd) as operands */
                          decode = opcode & ~(mask_A_6 | mask_Rd_5);
                          switch ( decode ) {
-                             case 0xB000: return new  avr_op_IN(opcode, core);          /* 1011 0AAd dddd AAAA | IN */
-                             case 0xB800: return new  avr_op_OUT(opcode, core);         /* 1011 1AAd dddd AAAA | OUT */
+                             case 0xB000: return new  avr_op_IN(opcode);                /* 1011 0AAd dddd AAAA | IN */
+                             case 0xB800: return new  avr_op_OUT(opcode);               /* 1011 1AAd dddd AAAA | OUT */
                          }
 
                          /* opcodes with a relative 12-bit address (k) operand */
                          decode = opcode & ~(mask_k_12);
                          switch ( decode ) {
-                             case 0xD000: return new  avr_op_RCALL(opcode, core);       /* 1101 kkkk kkkk kkkk | RCALL */
-                             case 0xC000: return new  avr_op_RJMP(opcode, core);        /* 1100 kkkk kkkk kkkk | RJMP */
+                             case 0xD000: return new  avr_op_RCALL(opcode);             /* 1101 kkkk kkkk kkkk | RCALL */
+                             case 0xC000: return new  avr_op_RJMP(opcode);              /* 1100 kkkk kkkk kkkk | RJMP */
                          }
 
                          /* opcodes with two 4-bit register (Rd and Rr) operands */
@@ -2252,14 +2681,14 @@ DecodedInstruction* lookup_opcode( word opcode, AvrDevice *core )
                          switch ( decode ) {
                              case 0x0100:
                                  if(core->flagMOVWInstruction)
-                                     return new avr_op_MOVW(opcode, core);              /* 0000 0001 dddd rrrr | MOVW */
+                                     return new avr_op_MOVW(opcode);                    /* 0000 0001 dddd rrrr | MOVW */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x0200:
                                  if(core->flagMULInstructions)
-                                     return new avr_op_MULS(opcode, core);              /* 0000 0010 dddd rrrr | MULS */
+                                     return new avr_op_MULS(opcode);                    /* 0000 0010 dddd rrrr | MULS */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                          }
 
                          /* opcodes with two 3-bit register (Rd and Rr) operands */
@@ -2267,31 +2696,95 @@ DecodedInstruction* lookup_opcode( word opcode, AvrDevice *core )
                          switch ( decode ) {
                              case 0x0300:
                                  if(core->flagMULInstructions)
-                                     return new avr_op_MULSU(opcode, core);             /* 0000 0011 0ddd 0rrr | MULSU */
+                                     return new avr_op_MULSU(opcode);                   /* 0000 0011 0ddd 0rrr | MULSU */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x0308:
                                  if(core->flagMULInstructions)
-                                     return new avr_op_FMUL(opcode, core);              /* 0000 0011 0ddd 1rrr | FMUL */
+                                     return new avr_op_FMUL(opcode);                    /* 0000 0011 0ddd 1rrr | FMUL */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x0380:
                                  if(core->flagMULInstructions)
-                                     return new avr_op_FMULS(opcode, core);             /* 0000 0011 1ddd 0rrr | FMULS */
+                                     return new avr_op_FMULS(opcode);                   /* 0000 0011 1ddd 0rrr | FMULS */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                              case 0x0388:
                                  if(core->flagMULInstructions)
-                                     return new avr_op_FMULSU(opcode, core);            /* 0000 0011 1ddd 1rrr | FMULSU */
+                                     return new avr_op_FMULSU(opcode);                  /* 0000 0011 1ddd 1rrr | FMULSU */
                                  else
-                                     return new avr_op_ILLEGAL(opcode, core);
+                                     return new avr_op_ILLEGAL(opcode);
                          }
 
                      } /* default */
     } /* first switch */
 
     //return NULL;
-    return new avr_op_ILLEGAL(opcode, core);
+    return new avr_op_ILLEGAL(opcode);
 
 } /* decode opcode function */
 
+#ifdef USE_THREADS
+//! protects the decoded instruction tables, devices could decode in parallel threads
+static pthread_mutex_t tableMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+DecodedInstructionTable::Lock::Lock() {
+#ifdef USE_THREADS
+    pthread_mutex_lock(&tableMutex);
+#endif
+}
+
+DecodedInstructionTable::Lock::~Lock() {
+#ifdef USE_THREADS
+    pthread_mutex_unlock(&tableMutex);
+#endif
+}
+
+//! all tables, which are in use, by instruction set flags
+/*! The map isn't destroyed, devices could be destroyed on exit after it. */
+static std::map<unsigned int, DecodedInstructionTable*> &DecodedTables(void) {
+    static std::map<unsigned int, DecodedInstructionTable*> *tables = NULL;
+    if(tables == NULL)
+        tables = new std::map<unsigned int, DecodedInstructionTable*>;
+    return *tables;
+}
+
+DecodedInstructionTable *DecodedInstructionTable::ForCore(AvrDevice *core) {
+    // all flags, which change decoding of a opcode
+    unsigned int key = (core->flagIWInstructions << 0) |
+                       (core->flagJMPInstructions << 1) |
+                       (core->flagIJMPInstructions << 2) |
+                       (core->flagEIJMPInstructions << 3) |
+                       (core->flagLPMInstructions << 4) |
+                       (core->flagELPMInstructions << 5) |
+                       (core->flagMULInstructions << 6) |
+                       (core->flagMOVWInstruction << 7) |
+                       (core->flagTiny10 << 8) |
+                       (core->flagTiny1x << 9) |
+                       (core->flagXMega << 10);
+
+    DecodedInstructionTable *&table = DecodedTables()[key];
+    if(table == NULL)
+        table = new DecodedInstructionTable(key);
+    return table;
+}
+
+void DecodedInstructionTable::Unref(void) {
+    if(--refCount > 0)
+        return;
+    DecodedTables().erase(key);
+    delete this;
+}
+
+DecodedInstructionTable::~DecodedInstructionTable() {
+    for(unsigned int i = 0; i < instructions.size(); i++)
+        delete instructions[i];
+}
+
+DecodedInstruction *DecodedInstructionTable::Lookup(word opcode, AvrDevice *core) {
+    DecodedInstruction *&instr = instructions[opcode];
+    if(instr == NULL)
+        instr = lookup_opcode(opcode, core);
+    return instr;
+}
@@ -27,6 +27,7 @@
 #define DECODER
 
 #include <iostream>
+#include <vector>
 
 #include "rwmem.h"
 #include "types.h"
@@ -34,25 +35,91 @@
 
 class AvrFlash;
 
+struct DecodedRecord;
+
+//! Handler for a decoded instruction
+/*! Performs the instruction described by rec on core and returns the used clocks */
+typedef int (*DecodedHandler)(AvrDevice *core, const DecodedRecord &rec);
+
+//! Compact form of a decoded instruction
+/*! Holds the handler of the instruction and the operands extracted from opcode.
+  It doesn't depend on a core instance, so a program can be held as a contiguous
+  array of these records and executed by calling handler for the record at PC. */
+struct DecodedRecord {
+    DecodedHandler handler; //!< specialised handler for this instruction
+    unsigned char op1;      //!< first operand (register, IO address, bit or bitmask)
+    unsigned char op2;      //!< second operand (register, bit or constant)
+    short k;                //!< further operand (constant, displacement or address)
+    bool size2Word;         //!< Flag: true, if instruction has 2 words
+};
+
 //! Base class of core instruction
-/*! All instruction are derived from this class */
+/*! All instruction are derived from this class. A instance holds only operands
+  and doesn't depend on a core, the core is given on execution. So a instance
+  is shared by all devices with the same instruction set, see
+  DecodedInstructionTable. */
 class DecodedInstruction {
     
     protected:
-        AvrDevice *core; //!< Link to device instance
-        bool size2Word; //!< Flag: true, if instruction has 2 words
-
-    public:
-        DecodedInstruction(AvrDevice *c, bool s2w = false): core(c), size2Word(s2w) {}
+        DecodedRecord rec; //!< compact form of this instruction
+        bool registerOp; //!< Flag: true, if instruction accesses only core registers and SREG flags
+        unsigned char flagsRead; //!< SREG flags read by a register operation
+        unsigned char flagsWritten; //!< SREG flags written by a register operation
+        DecodedHandler noFlagsHandler; //!< handler without update of SREG flags or NULL
+
+        //! Set operands in compact form, called by constructor of derived class
+        void SetOperands(unsigned char op1, unsigned char op2 = 0, short k = 0) {
+            rec.op1 = op1;
+            rec.op2 = op2;
+            rec.k = k;
+        }
+
+        //! Mark instruction as register operation, called by constructor of derived class
+        /*! A register operation doesn't change program flow and accesses only core
+          registers and the given SREG flags (see HWSreg::SREG_C and so on).
+          \param read SREG flags, which are read by instruction
+          \param written SREG flags, which are written by instruction
+          \param noflags handler, which does the same as instruction, but without SREG update */
+        void SetRegisterOp(unsigned char read, unsigned char written, DecodedHandler noflags = NULL) {
+            registerOp = true;
+            flagsRead = read;
+            flagsWritten = written;
+            noFlagsHandler = noflags;
+        }
+
+    public:
+        DecodedInstruction(DecodedHandler h, bool s2w = false):
+            registerOp(false),
+            flagsRead(0xff),
+            flagsWritten(0),
+            noFlagsHandler(NULL)
+        {
+            rec.handler = h;
+            rec.op1 = rec.op2 = 0;
+            rec.k = 0;
+            rec.size2Word = s2w;
+        }
         virtual ~DecodedInstruction() {}
 
         //! Returns true, if instruction need 2 words (4byte)
-        bool IsInstruction2Words() { return size2Word; } 
-
-        //! Performs instruction
-        virtual int operator()() = 0;
-        //! Performs instruction and write out instruction mnemonic for trace
-        virtual int Trace() = 0;
+        bool IsInstruction2Words() { return rec.size2Word; } 
+
+        //! Returns instruction in compact form
+        const DecodedRecord &GetRecord() const { return rec; }
+
+        //! Returns true, if instruction is a register operation, see SetRegisterOp
+        bool IsRegisterOp() const { return registerOp; }
+        //! Returns SREG flags read by instruction, all flags for a non register operation
+        unsigned char GetFlagsRead() const { return flagsRead; }
+        //! Returns SREG flags written by instruction
+        unsigned char GetFlagsWritten() const { return flagsWritten; }
+        //! Returns handler without update of SREG flags, NULL if not available
+        DecodedHandler GetNoFlagsHandler() const { return noFlagsHandler; }
+
+        //! Performs instruction on core
+        int operator()(AvrDevice *core) { return rec.handler(core, rec); }
+        //! Performs instruction on core and write out instruction mnemonic for trace
+        virtual int Trace(AvrDevice *core) = 0;
 		//! If this instruction modifies a R0-R31 register then return its number, otherwise -1.
 		virtual unsigned char GetModifiedR() const {return -1;}
 		//! If this instruction modifies a pair of R0-R31 registers then ...
@@ -60,8 +127,49 @@ class DecodedInstruction {
 };
 
 //! Translates an opcode to a instance of DecodedInstruction
+/*! The core is used to check the instruction set only. Use
+  DecodedInstructionTable to get a shared instance. */
 DecodedInstruction* lookup_opcode(word opcode, AvrDevice *core);
 
+//! Decoded instructions of one instruction set, shared by all devices
+/*! A decoded instruction depends only on opcode and instruction set of the
+  core (see AvrDevice::flagJMPInstructions and so on), so tables are keyed on
+  these flags and not on device type and firmware: devices running the same
+  firmware use the same opcodes and so share all instances anyway, and a
+  flash write (SPM, gdb) just points the written word of this device to
+  another shared instance, no copy of a table is needed.
+
+  A instance is made on first lookup of opcode. A table lives, as long as a
+  flash holds a reference on it (see Ref and Unref). All access to tables has
+  to be done with a Lock, AvrFlash takes it once for a decoded range. */
+class DecodedInstructionTable {
+    
+    public:
+        //! Locks all tables for the lifetime of the scope object
+        class Lock {
+            public:
+                Lock();
+                ~Lock();
+        };
+
+        //! Returns the table for the instruction set of core, caller holds a Lock
+        static DecodedInstructionTable *ForCore(AvrDevice *core);
+        //! Returns shared instance of decoded instruction for opcode, caller holds a Lock
+        DecodedInstruction *Lookup(word opcode, AvrDevice *core);
+        //! Adds a reference on table, caller holds a Lock
+        void Ref(void) { refCount++; }
+        //! Removes a reference, the last one deletes table and instances, caller holds a Lock
+        void Unref(void);
+        
+    private:
+        unsigned int key; //!< instruction set flags, see ForCore
+        int refCount; //!< count of flashes, which use this table
+        std::vector<DecodedInstruction*> instructions; //!< one per opcode, NULL if not decoded yet
+        
+        DecodedInstructionTable(unsigned int k): key(k), refCount(0), instructions(0x10000, (DecodedInstruction*)NULL) {}
+        ~DecodedInstructionTable();
+};
+
 class avr_op_ADC: public DecodedInstruction {
     /*
      * Add with Carry.
@@ -75,13 +183,13 @@ class avr_op_ADC: public DecodedInstruction {
     protected:
         unsigned char R1;
         unsigned char R2;
-        HWSreg *status;
 
     public:
-        avr_op_ADC(word opcode, AvrDevice *c);
+        avr_op_ADC(word opcode);
         virtual unsigned char GetModifiedR() const;
-        int operator()();
-        int Trace(); 
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core); 
 }; //end of class 
 
 class avr_op_ADD: public DecodedInstruction {
@@ -97,13 +205,13 @@ class avr_op_ADD: public DecodedInstruction {
     protected:
         unsigned char R1;
         unsigned char R2;
-        HWSreg *status;
 
     public:
-        avr_op_ADD(word opcode, AvrDevice *c); 
+        avr_op_ADD(word opcode); 
         virtual unsigned char GetModifiedR() const;
-        int operator()();
-        int Trace(); 
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core); 
 }; //end of class 
 
 
@@ -125,14 +233,14 @@ class avr_op_ADIW: public DecodedInstruction
         unsigned char Rl;
         unsigned char Rh;
         unsigned char K;
-        HWSreg *status;
 
     public:
-        avr_op_ADIW(word opcode, AvrDevice *c);
+        avr_op_ADIW(word opcode);
         virtual unsigned char GetModifiedR() const;
         virtual unsigned char GetModifiedRHi() const;
-        int operator()();
-        int Trace();
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_AND: public DecodedInstruction
@@ -150,12 +258,12 @@ class avr_op_AND: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char R2;
-        HWSreg *status;
 
     public:
-        avr_op_AND(word opcode, AvrDevice *c); 
-        int operator()();
-        int Trace();
+        avr_op_AND(word opcode); 
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ANDI: public DecodedInstruction
@@ -173,12 +281,12 @@ class avr_op_ANDI: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char K;
-        HWSreg *status;
 
     public:
-        avr_op_ANDI(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ANDI(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ASR:public DecodedInstruction
@@ -195,12 +303,12 @@ class avr_op_ASR:public DecodedInstruction
 
     protected:
         unsigned char R1;
-        HWSreg *status;
 
     public:
-        avr_op_ASR(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ASR(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_BCLR: public DecodedInstruction
@@ -216,13 +324,12 @@ class avr_op_BCLR: public DecodedInstruction
      */
 
     protected:
-        HWSreg *status;
         unsigned char Kbit;
 
     public:
-        avr_op_BCLR(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_BCLR(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 
@@ -240,12 +347,11 @@ class avr_op_BLD: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char Kbit;
-        HWSreg *status;
 
     public:
-        avr_op_BLD(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_BLD(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_BRBC: public DecodedInstruction
@@ -266,14 +372,13 @@ class avr_op_BRBC: public DecodedInstruction
      */
 
     protected:
-        HWSreg *status;
         unsigned char bitmask;
         signed char offset;
 
     public:
-        avr_op_BRBC(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_BRBC(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_BRBS: public DecodedInstruction
@@ -294,14 +399,13 @@ class avr_op_BRBS: public DecodedInstruction
      */
 
     protected:
-        HWSreg *status;
         unsigned char bitmask;
         signed char offset;
 
     public:
-        avr_op_BRBS(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_BRBS(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_BSET: public DecodedInstruction
@@ -317,13 +421,12 @@ class avr_op_BSET: public DecodedInstruction
      */
 
     protected:
-        HWSreg *status;
         unsigned char Kbit;
 
     public:
-        avr_op_BSET(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_BSET(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_BST: public DecodedInstruction
@@ -341,12 +444,11 @@ class avr_op_BST: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char Kbit;
-        HWSreg *status;
 
     public:
-        avr_op_BST(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_BST(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 
 };
 
@@ -366,9 +468,9 @@ class avr_op_CALL: public DecodedInstruction
         unsigned char KH;
 
     public:
-        avr_op_CALL(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_CALL(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_CBI: public DecodedInstruction
@@ -386,12 +488,11 @@ class avr_op_CBI: public DecodedInstruction
     protected:
         unsigned char ioreg;
         unsigned char Kbit;
-        HWSreg *status;
 
     public:
-        avr_op_CBI(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_CBI(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_COM: public DecodedInstruction
@@ -408,12 +509,12 @@ class avr_op_COM: public DecodedInstruction
 
     protected:
         unsigned char R1;
-        HWSreg *status;
 
     public:
-        avr_op_COM(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_COM(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_CP: public DecodedInstruction
@@ -431,12 +532,11 @@ class avr_op_CP: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char R2;
-        HWSreg *status;
 
     public:
-        avr_op_CP(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_CP(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_CPC: public DecodedInstruction
@@ -454,12 +554,11 @@ class avr_op_CPC: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char R2;
-        HWSreg *status;
 
     public:
-        avr_op_CPC(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_CPC(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_CPI: public DecodedInstruction
@@ -477,12 +576,11 @@ class avr_op_CPI: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char K;
-        HWSreg *status;
 
     public:
-        avr_op_CPI(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_CPI(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 
 };
 
@@ -501,12 +599,11 @@ class avr_op_CPSE: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char R2;
-        HWSreg *status;
 
     public:
-        avr_op_CPSE(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_CPSE(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_DEC: public DecodedInstruction
@@ -523,12 +620,12 @@ class avr_op_DEC: public DecodedInstruction
 
     protected:
         unsigned char R1;
-        HWSreg *status;
 
     public:
-        avr_op_DEC(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_DEC(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_EICALL: public DecodedInstruction
@@ -544,9 +641,9 @@ class avr_op_EICALL: public DecodedInstruction
      */
 
     public:
-        avr_op_EICALL(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_EICALL(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_EIJMP: public DecodedInstruction
@@ -562,9 +659,9 @@ class avr_op_EIJMP: public DecodedInstruction
      */
 
     public:
-        avr_op_EIJMP(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_EIJMP(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ELPM_Z: public DecodedInstruction
@@ -583,9 +680,9 @@ class avr_op_ELPM_Z: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_ELPM_Z(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ELPM_Z(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ELPM_Z_incr: public DecodedInstruction
@@ -604,9 +701,9 @@ class avr_op_ELPM_Z_incr: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_ELPM_Z_incr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ELPM_Z_incr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ELPM: public DecodedInstruction
@@ -623,9 +720,9 @@ class avr_op_ELPM: public DecodedInstruction
      */
 
     public:
-        avr_op_ELPM(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ELPM(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_EOR: public DecodedInstruction
@@ -643,12 +740,12 @@ class avr_op_EOR: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char R2;
-        HWSreg *status;
 
     public:
-        avr_op_EOR(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_EOR(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ESPM: public DecodedInstruction
@@ -665,9 +762,9 @@ class avr_op_ESPM: public DecodedInstruction
      */
 
     public:
-        avr_op_ESPM(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ESPM(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_FMUL:public DecodedInstruction
@@ -685,12 +782,11 @@ class avr_op_FMUL:public DecodedInstruction
     protected:
         unsigned char Rd;
         unsigned char Rr;
-        HWSreg *status;
 
     public:
-        avr_op_FMUL(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_FMUL(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_FMULS: public DecodedInstruction
@@ -708,12 +804,11 @@ class avr_op_FMULS: public DecodedInstruction
     protected:
         unsigned char Rd;
         unsigned char Rr;
-        HWSreg *status;
 
     public:
-        avr_op_FMULS(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_FMULS(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_FMULSU: public DecodedInstruction
@@ -731,12 +826,11 @@ class avr_op_FMULSU: public DecodedInstruction
     protected:
         unsigned char Rd;
         unsigned char Rr;
-        HWSreg *status;
 
     public:
-        avr_op_FMULSU(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_FMULSU(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ICALL: public DecodedInstruction
@@ -752,9 +846,9 @@ class avr_op_ICALL: public DecodedInstruction
      */
 
     public:
-        avr_op_ICALL(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ICALL(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_IJMP: public DecodedInstruction
@@ -770,9 +864,9 @@ class avr_op_IJMP: public DecodedInstruction
      */
 
     public:
-        avr_op_IJMP (word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_IJMP(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_IN: public DecodedInstruction
@@ -792,9 +886,9 @@ class avr_op_IN: public DecodedInstruction
         unsigned char ioreg;
 
     public:
-        avr_op_IN(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_IN(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_INC: public DecodedInstruction
@@ -811,12 +905,12 @@ class avr_op_INC: public DecodedInstruction
 
     protected:
         unsigned char R1;
-        HWSreg *status;
 
     public:
-        avr_op_INC(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_INC(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_JMP: public DecodedInstruction
@@ -835,9 +929,9 @@ class avr_op_JMP: public DecodedInstruction
         unsigned int K;
 
     public:
-        avr_op_JMP (word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_JMP(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LDD_Y: public DecodedInstruction
@@ -857,9 +951,9 @@ class avr_op_LDD_Y: public DecodedInstruction
         unsigned char K;
 
     public:
-        avr_op_LDD_Y(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LDD_Y(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LDD_Z: public DecodedInstruction
@@ -879,9 +973,9 @@ class avr_op_LDD_Z: public DecodedInstruction
         unsigned char K;
 
     public:
-        avr_op_LDD_Z(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LDD_Z(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LDI: public DecodedInstruction
@@ -901,10 +995,10 @@ class avr_op_LDI: public DecodedInstruction
         unsigned char K;
 
     public:
-        avr_op_LDI(word opcode, AvrDevice *c);
+        avr_op_LDI(word opcode);
         virtual unsigned char GetModifiedR() const;
-        int operator()();
-        int Trace();
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LDS: public DecodedInstruction
@@ -923,9 +1017,9 @@ class avr_op_LDS: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_LDS(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LDS(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LD_X: public DecodedInstruction
@@ -944,9 +1038,9 @@ class avr_op_LD_X: public DecodedInstruction
         unsigned char Rd;
 
     public:
-        avr_op_LD_X(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LD_X(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LD_X_decr: public DecodedInstruction
@@ -965,9 +1059,9 @@ class avr_op_LD_X_decr: public DecodedInstruction
         unsigned char Rd;
 
     public:
-        avr_op_LD_X_decr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LD_X_decr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LD_X_incr: public DecodedInstruction
@@ -986,9 +1080,9 @@ class avr_op_LD_X_incr: public DecodedInstruction
         unsigned char Rd;
 
     public:
-        avr_op_LD_X_incr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LD_X_incr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LD_Y_decr: public DecodedInstruction
@@ -1008,9 +1102,9 @@ class avr_op_LD_Y_decr: public DecodedInstruction
         unsigned char Rd;
 
     public:
-        avr_op_LD_Y_decr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LD_Y_decr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LD_Y_incr: public DecodedInstruction
@@ -1029,9 +1123,9 @@ class avr_op_LD_Y_incr: public DecodedInstruction
         unsigned char Rd;
 
     public:
-        avr_op_LD_Y_incr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LD_Y_incr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LD_Z_incr: public DecodedInstruction
@@ -1050,9 +1144,9 @@ class avr_op_LD_Z_incr: public DecodedInstruction
         unsigned char Rd;
 
     public:
-        avr_op_LD_Z_incr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LD_Z_incr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LD_Z_decr: public DecodedInstruction
@@ -1071,9 +1165,9 @@ class avr_op_LD_Z_decr: public DecodedInstruction
         unsigned char Rd;
 
     public:
-        avr_op_LD_Z_decr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LD_Z_decr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LPM_Z: public DecodedInstruction
@@ -1092,9 +1186,9 @@ class avr_op_LPM_Z: public DecodedInstruction
         unsigned char Rd;
 
     public:
-        avr_op_LPM_Z(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LPM_Z(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LPM: public DecodedInstruction
@@ -1112,9 +1206,9 @@ class avr_op_LPM: public DecodedInstruction
     //return avr_op_LPM_Z:public DecodedInstruction
 
     public:
-        avr_op_LPM(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LPM(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LPM_Z_incr: public DecodedInstruction
@@ -1133,9 +1227,9 @@ class avr_op_LPM_Z_incr: public DecodedInstruction
         unsigned char Rd;
 
     public:
-        avr_op_LPM_Z_incr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LPM_Z_incr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_LSR: public DecodedInstruction
@@ -1152,12 +1246,12 @@ class avr_op_LSR: public DecodedInstruction
 
     protected:
         unsigned char Rd;
-        HWSreg *status;
 
     public:
-        avr_op_LSR(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_LSR(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_MOV: public DecodedInstruction
@@ -1176,9 +1270,9 @@ class avr_op_MOV: public DecodedInstruction
         unsigned char R2;
 
     public:
-        avr_op_MOV(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_MOV(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_MOVW: public DecodedInstruction
@@ -1198,9 +1292,9 @@ class avr_op_MOVW: public DecodedInstruction
         unsigned char Rs;
 
     public:
-        avr_op_MOVW(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_MOVW(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_MUL: public DecodedInstruction
@@ -1218,12 +1312,11 @@ class avr_op_MUL: public DecodedInstruction
     protected:
         unsigned char Rd;
         unsigned char Rr;
-        HWSreg *status;
 
     public:
-        avr_op_MUL(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_MUL(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_MULS: public DecodedInstruction
@@ -1241,12 +1334,11 @@ class avr_op_MULS: public DecodedInstruction
     protected:
         unsigned char Rd;
         unsigned char Rr;
-        HWSreg *status;
 
     public:
-        avr_op_MULS(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_MULS(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_MULSU: public DecodedInstruction
@@ -1267,12 +1359,11 @@ class avr_op_MULSU: public DecodedInstruction
     protected:
         unsigned char Rd;
         unsigned char Rr;
-        HWSreg *status;
 
     public:
-        avr_op_MULSU(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_MULSU(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_NEG: public DecodedInstruction
@@ -1289,12 +1380,12 @@ class avr_op_NEG: public DecodedInstruction
 
     protected:
         unsigned char Rd;
-        HWSreg *status;
 
     public:
-        avr_op_NEG(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_NEG(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_NOP: public DecodedInstruction
@@ -1311,9 +1402,9 @@ class avr_op_NOP: public DecodedInstruction
 
 
     public:
-        avr_op_NOP(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_NOP(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_OR:public DecodedInstruction
@@ -1331,12 +1422,12 @@ class avr_op_OR:public DecodedInstruction
     protected:
         unsigned char Rd;
         unsigned char Rr;
-        HWSreg *status;
 
     public:
-        avr_op_OR(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_OR(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ORI: public DecodedInstruction
@@ -1354,12 +1445,12 @@ class avr_op_ORI: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char K;
-        HWSreg *status;
 
     public:
-        avr_op_ORI(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ORI(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_OUT: public DecodedInstruction
@@ -1379,9 +1470,9 @@ class avr_op_OUT: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_OUT(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_OUT(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 
     friend class AvrFlash;  // AvrFlash::LooksLikeContextSwitch() needs to read ioreg
 };
@@ -1402,9 +1493,9 @@ class avr_op_POP: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_POP(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_POP(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_PUSH: public DecodedInstruction
@@ -1423,9 +1514,9 @@ class avr_op_PUSH: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_PUSH(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_PUSH(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_RCALL: public DecodedInstruction
@@ -1444,9 +1535,9 @@ class avr_op_RCALL: public DecodedInstruction
         signed int K;
 
     public:
-        avr_op_RCALL(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_RCALL(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_RET: public DecodedInstruction
@@ -1462,9 +1553,9 @@ class avr_op_RET: public DecodedInstruction
      */
 
     public:
-        avr_op_RET(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_RET(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_RETI: public DecodedInstruction
@@ -1480,12 +1571,11 @@ class avr_op_RETI: public DecodedInstruction
      */
 
     protected:
-        HWSreg *status;
 
     public:
-        avr_op_RETI(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_RETI(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_RJMP: public DecodedInstruction
@@ -1504,9 +1594,9 @@ class avr_op_RJMP: public DecodedInstruction
         signed int K;
 
     public:
-        avr_op_RJMP(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_RJMP(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ROR: public DecodedInstruction
@@ -1523,12 +1613,12 @@ class avr_op_ROR: public DecodedInstruction
 
     protected:
         unsigned char R1;
-        HWSreg *status;
 
     public:
-        avr_op_ROR(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ROR(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_SBC: public DecodedInstruction
@@ -1546,13 +1636,13 @@ class avr_op_SBC: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char R2;
-        HWSreg *status;
 
     public:
-        avr_op_SBC(word opcode, AvrDevice *c);
+        avr_op_SBC(word opcode);
         virtual unsigned char GetModifiedR() const;
-        int operator()();
-        int Trace();
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_SBCI: public DecodedInstruction
@@ -1570,13 +1660,13 @@ class avr_op_SBCI: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char K;
-        HWSreg *status;
 
     public:
-        avr_op_SBCI(word opcode, AvrDevice *c);
+        avr_op_SBCI(word opcode);
         virtual unsigned char GetModifiedR() const;
-        int operator()();
-        int Trace();
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_SBI: public DecodedInstruction
@@ -1596,9 +1686,9 @@ class avr_op_SBI: public DecodedInstruction
         unsigned char Kbit;
 
     public:
-        avr_op_SBI(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_SBI(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_SBIC: public DecodedInstruction
@@ -1618,9 +1708,9 @@ class avr_op_SBIC: public DecodedInstruction
         unsigned char Kbit;
 
     public:
-        avr_op_SBIC(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_SBIC(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_SBIS: public DecodedInstruction
@@ -1640,9 +1730,9 @@ class avr_op_SBIS: public DecodedInstruction
         unsigned char Kbit;
 
     public:
-        avr_op_SBIS(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_SBIS(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_SBIW: public DecodedInstruction
@@ -1660,14 +1750,14 @@ class avr_op_SBIW: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char K;
-        HWSreg *status;
 
     public:
-        avr_op_SBIW(word opcode, AvrDevice *c);
+        avr_op_SBIW(word opcode);
         virtual unsigned char GetModifiedR() const;
         virtual unsigned char GetModifiedRHi() const;
-        int operator()();
-        int Trace();
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_SBRC: public DecodedInstruction
@@ -1687,9 +1777,9 @@ class avr_op_SBRC: public DecodedInstruction
         unsigned char Kbit;
 
     public:
-        avr_op_SBRC(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_SBRC(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_SBRS: public DecodedInstruction
@@ -1709,9 +1799,9 @@ class avr_op_SBRS: public DecodedInstruction
         unsigned char Kbit;
 
     public:
-        avr_op_SBRS(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_SBRS(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 /*! \todo SLEEP instruction not implemented */
@@ -1731,9 +1821,9 @@ class avr_op_SLEEP: public DecodedInstruction
 
 
     public:
-        avr_op_SLEEP(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_SLEEP(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_SPM: public DecodedInstruction
@@ -1749,9 +1839,9 @@ class avr_op_SPM: public DecodedInstruction
      */
 
     public:
-        avr_op_SPM(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_SPM(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_STD_Y: public DecodedInstruction
@@ -1771,9 +1861,9 @@ class avr_op_STD_Y: public DecodedInstruction
         unsigned char K;
 
     public:
-        avr_op_STD_Y(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_STD_Y(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_STD_Z: public DecodedInstruction
@@ -1793,9 +1883,9 @@ class avr_op_STD_Z: public DecodedInstruction
         unsigned char K;
 
     public:
-        avr_op_STD_Z(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_STD_Z(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_STS: public DecodedInstruction
@@ -1814,9 +1904,9 @@ class avr_op_STS: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_STS(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_STS(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ST_X: public DecodedInstruction
@@ -1835,9 +1925,9 @@ class avr_op_ST_X: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_ST_X(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ST_X(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ST_X_decr: public DecodedInstruction
@@ -1856,9 +1946,9 @@ class avr_op_ST_X_decr: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_ST_X_decr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ST_X_decr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ST_X_incr: public DecodedInstruction
@@ -1877,9 +1967,9 @@ class avr_op_ST_X_incr: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_ST_X_incr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ST_X_incr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ST_Y_decr: public DecodedInstruction
@@ -1898,9 +1988,9 @@ class avr_op_ST_Y_decr: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_ST_Y_decr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ST_Y_decr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ST_Y_incr: public DecodedInstruction
@@ -1919,9 +2009,9 @@ class avr_op_ST_Y_incr: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_ST_Y_incr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ST_Y_incr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ST_Z_decr: public DecodedInstruction
@@ -1940,9 +2030,9 @@ class avr_op_ST_Z_decr: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_ST_Z_decr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ST_Z_decr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ST_Z_incr: public DecodedInstruction
@@ -1961,9 +2051,9 @@ class avr_op_ST_Z_incr: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_ST_Z_incr(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ST_Z_incr(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_SUB: public DecodedInstruction
@@ -1981,13 +2071,13 @@ class avr_op_SUB: public DecodedInstruction
     protected:
         unsigned char R1;
         unsigned char R2;
-        HWSreg *status;
 
     public:
-        avr_op_SUB(word opcode, AvrDevice *c);
+        avr_op_SUB(word opcode);
         virtual unsigned char GetModifiedR() const;
-        int operator()();
-        int Trace();
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_SUBI: public DecodedInstruction
@@ -2004,14 +2094,14 @@ class avr_op_SUBI: public DecodedInstruction
 
     protected:
         unsigned char R1;
-        HWSreg *status;
         unsigned char K;
 
     public:
-        avr_op_SUBI(word opcode, AvrDevice *c);
+        avr_op_SUBI(word opcode);
         virtual unsigned char GetModifiedR() const;
-        int operator()();
-        int Trace();
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        static int ExecNoFlags(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_SWAP: public DecodedInstruction
@@ -2030,9 +2120,9 @@ class avr_op_SWAP: public DecodedInstruction
         unsigned char R1;
 
     public:
-        avr_op_SWAP(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_SWAP(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_WDR: public DecodedInstruction
@@ -2050,9 +2140,9 @@ class avr_op_WDR: public DecodedInstruction
      */
 
     public:
-        avr_op_WDR(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_WDR(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_BREAK: public DecodedInstruction
@@ -2070,9 +2160,9 @@ class avr_op_BREAK: public DecodedInstruction
      */
 
     public:
-        avr_op_BREAK(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_BREAK(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 class avr_op_ILLEGAL: public DecodedInstruction
@@ -2080,9 +2170,9 @@ class avr_op_ILLEGAL: public DecodedInstruction
     //illegal instruction
 
     public:
-        avr_op_ILLEGAL(word opcode, AvrDevice *c);
-        int operator()();
-        int Trace();
+        avr_op_ILLEGAL(word opcode);
+        static int Exec(AvrDevice *core, const DecodedRecord &rec);
+        int Trace(AvrDevice *core);
 };
 
 #endif
@@ -34,7 +34,7 @@
 #include "ioregs.h"
 #include "avrerror.h"
 
-#define MONSREG traceOut << (string)(*(core->status))  
+#define MONSREG core->TraceOut() << (string)(*(core->status))  
 
 using namespace std;
 
@@ -56,44 +56,44 @@ int abort_in_expression()
     return 0;
 }
 
-int avr_op_ADC::Trace()  {
-    traceOut << "ADC R" << (int)R1 << ", R" << (int)R2 << " ";
-    int ret = this->operator()();
+int avr_op_ADC::Trace(AvrDevice *core)  {
+    core->TraceOut() << "ADC R" << (int)R1 << ", R" << (int)R2 << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_ADD::Trace() {
-    traceOut << "ADD R" << (int)R1 << ", R" << (int)R2 << " ";
-    int ret = this->operator()();
+int avr_op_ADD::Trace(AvrDevice *core) {
+    core->TraceOut() << "ADD R" << (int)R1 << ", R" << (int)R2 << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_ADIW::Trace() {
-    traceOut << "ADIW R" << (int)Rl << ", " << (int)K << " ";
-    int ret = this->operator()();
+int avr_op_ADIW::Trace(AvrDevice *core) {
+    core->TraceOut() << "ADIW R" << (int)Rl << ", " << (int)K << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_AND::Trace() {
-    traceOut << "AND R" << (int)R1 << ", R" << (int)R2 << " ";
-    int ret=this->operator()();
+int avr_op_AND::Trace(AvrDevice *core) {
+    core->TraceOut() << "AND R" << (int)R1 << ", R" << (int)R2 << " ";
+    int ret=this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_ANDI::Trace() {
-    traceOut << "ANDI R" << (int)R1 << ", " << HexChar(K) << " ";
-    int ret=this->operator()();
+int avr_op_ANDI::Trace(AvrDevice *core) {
+    core->TraceOut() << "ANDI R" << (int)R1 << ", " << HexChar(K) << " ";
+    int ret=this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_ASR::Trace() {
-    traceOut << "ASR R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_ASR::Trace(AvrDevice *core) {
+    core->TraceOut() << "ASR R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
@@ -109,16 +109,16 @@ const char *opcodes_bclr[8]= {
     "CLI"
 };
 
-int avr_op_BCLR::Trace() {
-    traceOut << opcodes_bclr[Kbit] << " ";
-    int ret = this->operator()();
+int avr_op_BCLR::Trace(AvrDevice *core) {
+    core->TraceOut() << opcodes_bclr[Kbit] << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_BLD::Trace() {
-    traceOut << "BLD R" << (int)R1 << ", " << (int)Kbit << " ";
-    int ret = this->operator()();
+int avr_op_BLD::Trace(AvrDevice *core) {
+    core->TraceOut() << "BLD R" << (int)R1 << ", " << (int)Kbit << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
@@ -133,15 +133,15 @@ const char *branch_opcodes_clear[8] = {
     "BRID"
 };
 
-int avr_op_BRBC::Trace() {
-    traceOut << branch_opcodes_clear[INDEX_FROM_BITMASK(bitmask)]
+int avr_op_BRBC::Trace(AvrDevice *core) {
+    core->TraceOut() << branch_opcodes_clear[INDEX_FROM_BITMASK(bitmask)]
              << " ->" << HexShort(offset * 2) << " ";
     string sym(core->Flash->GetSymbolAtAddress(core->PC+1+offset));
-    int ret = this->operator()();
+    int ret = this->operator()(core);
     
-    traceOut << sym << " ";
+    core->TraceOut() << sym << " ";
     for(int len = sym.length(); len < 30; len++)
-        traceOut << " ";
+        core->TraceOut() << " ";
 
     return ret;
 }
@@ -157,15 +157,15 @@ const char *branch_opcodes_set[8] = {
     "BRIE"
 };
 
-int avr_op_BRBS::Trace() {
-    traceOut << branch_opcodes_set[INDEX_FROM_BITMASK(bitmask)]
+int avr_op_BRBS::Trace(AvrDevice *core) {
+    core->TraceOut() << branch_opcodes_set[INDEX_FROM_BITMASK(bitmask)]
              << " ->" << HexShort(offset * 2) << " ";
     string sym(core->Flash->GetSymbolAtAddress(core->PC+1+offset));
-    int ret=this->operator()();
+    int ret=this->operator()(core);
 
-    traceOut << sym << " ";
+    core->TraceOut() << sym << " ";
     for(int len = sym.length(); len < 30; len++)
-        traceOut << " ";
+        core->TraceOut() << " ";
 
     return ret;
 }
@@ -181,578 +181,578 @@ const char *opcodes_bset[8]= {
     "SEI"
 };
 
-int avr_op_BSET::Trace() {
-    traceOut << opcodes_bset[Kbit] << " ";
-    int ret = this->operator()();
+int avr_op_BSET::Trace(AvrDevice *core) {
+    core->TraceOut() << opcodes_bset[Kbit] << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_BST::Trace() {
-    traceOut << "BST R" << (int)R1 << ", " << (int)Kbit << " ";
-    int ret = this->operator()();
+int avr_op_BST::Trace(AvrDevice *core) {
+    core->TraceOut() << "BST R" << (int)R1 << ", " << (int)Kbit << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_CALL::Trace() {
+int avr_op_CALL::Trace(AvrDevice *core) {
     word K_lsb = core->Flash->ReadMemWord((core->PC + 1) * 2);
     int k = (KH << 16) | K_lsb;
-    traceOut << "CALL 0x" << hex << k * 2 << dec << " ";
-    int ret = this->operator()();
+    core->TraceOut() << "CALL 0x" << hex << k * 2 << dec << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_CBI::Trace() {
-    traceOut << "CBI " << HexChar(ioreg) << ", " << (int)Kbit << " ";
-    int ret = this->operator()();
+int avr_op_CBI::Trace(AvrDevice *core) {
+    core->TraceOut() << "CBI " << HexChar(ioreg) << ", " << (int)Kbit << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_COM::Trace() {
-    traceOut << "COM R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_COM::Trace(AvrDevice *core) {
+    core->TraceOut() << "COM R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_CP::Trace() {
-    traceOut << "CP R" << (int)R1 << ", R" << (int)R2 << " ";
-    int ret = this->operator()();
+int avr_op_CP::Trace(AvrDevice *core) {
+    core->TraceOut() << "CP R" << (int)R1 << ", R" << (int)R2 << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_CPC::Trace() {
-    traceOut << "CPC R" << (int)R1 << ", R" << (int)R2 << " ";
-    int ret = this->operator()();
+int avr_op_CPC::Trace(AvrDevice *core) {
+    core->TraceOut() << "CPC R" << (int)R1 << ", R" << (int)R2 << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_CPI::Trace() {
-    traceOut << "CPI R" << (int)R1 << ", " << HexChar(K) << " ";
-    int ret = this->operator()();
+int avr_op_CPI::Trace(AvrDevice *core) {
+    core->TraceOut() << "CPI R" << (int)R1 << ", " << HexChar(K) << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_CPSE::Trace() {
-    traceOut << "CPSE R" << (int)R1 << ", R" << (int)R2 << " ";
-    int ret = this->operator()();
+int avr_op_CPSE::Trace(AvrDevice *core) {
+    core->TraceOut() << "CPSE R" << (int)R1 << ", R" << (int)R2 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_DEC::Trace() {
-    traceOut << "DEC R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_DEC::Trace(AvrDevice *core) {
+    core->TraceOut() << "DEC R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_EICALL::Trace() {
-    traceOut << "EICALL ";
-    int ret = this->operator()();
+int avr_op_EICALL::Trace(AvrDevice *core) {
+    core->TraceOut() << "EICALL ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_EIJMP::Trace() {
-    traceOut << "EIJMP ";
-    int ret = this->operator()();
+int avr_op_EIJMP::Trace(AvrDevice *core) {
+    core->TraceOut() << "EIJMP ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_ELPM_Z::Trace() {
-    traceOut << "ELPM R" << (int)R1 << ", Z " ;
-    int ret = this->operator()();
+int avr_op_ELPM_Z::Trace(AvrDevice *core) {
+    core->TraceOut() << "ELPM R" << (int)R1 << ", Z " ;
+    int ret = this->operator()(core);
 
     unsigned char rampz = 0;
     if(core->rampz != NULL)
         rampz = core->rampz->GetRegVal();
     unsigned int Z = (rampz << 16) + core->GetRegZ();
 
-    traceOut << " Flash[0x" << hex << Z << dec << "] ";
+    core->TraceOut() << " Flash[0x" << hex << Z << dec << "] ";
 
     return ret;
 }
 
-int avr_op_ELPM_Z_incr::Trace() {
-    traceOut << "ELPM R" << (int)R1 << ", Z+ ";
+int avr_op_ELPM_Z_incr::Trace(AvrDevice *core) {
+    core->TraceOut() << "ELPM R" << (int)R1 << ", Z+ ";
     unsigned char rampz = 0;
     if(core->rampz != NULL)
         rampz = core->rampz->GetRegVal();
     unsigned int Z = (rampz << 16) + core->GetRegZ();
-    int ret = this->operator()();
+    int ret = this->operator()(core);
 
-    traceOut << " Flash[0x" << hex << Z << dec << "] ";
+    core->TraceOut() << " Flash[0x" << hex << Z << dec << "] ";
 
     return ret;
 }
 
-int avr_op_ELPM::Trace() {
-    traceOut << "ELPM ";
-    int ret = this->operator()();
+int avr_op_ELPM::Trace(AvrDevice *core) {
+    core->TraceOut() << "ELPM ";
+    int ret = this->operator()(core);
 
     unsigned char rampz = 0;
     if(core->rampz != NULL)
         rampz = core->rampz->GetRegVal();
     unsigned int Z = (rampz << 16) + core->GetRegZ();
 
-    traceOut << " Flash[0x" << hex << Z << dec << "] ";
+    core->TraceOut() << " Flash[0x" << hex << Z << dec << "] ";
 
     return ret;
 }
 
-int avr_op_EOR::Trace() {
-    traceOut << "EOR R" << (int)R1 << ", R" << (int)R2 << " ";
-    int ret = this->operator()();
+int avr_op_EOR::Trace(AvrDevice *core) {
+    core->TraceOut() << "EOR R" << (int)R1 << ", R" << (int)R2 << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_ESPM::Trace() {
-    traceOut << "SPM Z+ ";
-    int ret = this->operator()();
+int avr_op_ESPM::Trace(AvrDevice *core) {
+    core->TraceOut() << "SPM Z+ ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_FMUL::Trace() {
-    traceOut << "FMUL R" << (int)Rd << ", R" << (int)Rr << " ";
-    int ret = this->operator()();
+int avr_op_FMUL::Trace(AvrDevice *core) {
+    core->TraceOut() << "FMUL R" << (int)Rd << ", R" << (int)Rr << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_FMULS::Trace() {
-    traceOut << "FMULS R" << (int)Rd << ", R" << (int)Rr << " ";
-    int ret = this->operator()();
+int avr_op_FMULS::Trace(AvrDevice *core) {
+    core->TraceOut() << "FMULS R" << (int)Rd << ", R" << (int)Rr << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_FMULSU::Trace() {
-    traceOut << "FMULSU R" << (int)Rd << ", R" << (int)Rr << " ";
-    int ret = this->operator()();
+int avr_op_FMULSU::Trace(AvrDevice *core) {
+    core->TraceOut() << "FMULSU R" << (int)Rd << ", R" << (int)Rr << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_ICALL::Trace() {
-    traceOut << "ICALL Z " ;
-    int ret = this->operator()();
+int avr_op_ICALL::Trace(AvrDevice *core) {
+    core->TraceOut() << "ICALL Z " ;
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_IJMP::Trace() {
-    traceOut << "IJMP Z " ;
-    int ret = this->operator()();
+int avr_op_IJMP::Trace(AvrDevice *core) {
+    core->TraceOut() << "IJMP Z " ;
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_IN::Trace() {
-    traceOut << "IN R" << (int)R1 << ", " << HexChar(ioreg) << " ";
-    int ret = this->operator()();
+int avr_op_IN::Trace(AvrDevice *core) {
+    core->TraceOut() << "IN R" << (int)R1 << ", " << HexChar(ioreg) << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_INC::Trace() {
-    traceOut << "INC R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_INC::Trace(AvrDevice *core) {
+    core->TraceOut() << "INC R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_JMP::Trace() {
-    traceOut << "JMP ";
+int avr_op_JMP::Trace(AvrDevice *core) {
+    core->TraceOut() << "JMP ";
     word offset = core->Flash->ReadMemWord((core->PC + 1) * 2);  //this is k!
-    int ret = this->operator()();
-    traceOut << hex << 2 * offset << dec << " ";
+    int ret = this->operator()(core);
+    core->TraceOut() << hex << 2 * offset << dec << " ";
 
     string sym(core->Flash->GetSymbolAtAddress(offset));
-    traceOut << sym << " ";
+    core->TraceOut() << sym << " ";
     for(int len = sym.length(); len < 30; len++)
-        traceOut << " " ;
+        core->TraceOut() << " " ;
 
     return ret;
 }
 
-int avr_op_LDD_Y::Trace() {
-    traceOut << "LDD R" << (int)Rd << ", Y+" << (int)K << " ";
-    int ret = this->operator()();
+int avr_op_LDD_Y::Trace(AvrDevice *core) {
+    core->TraceOut() << "LDD R" << (int)Rd << ", Y+" << (int)K << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_LDD_Z::Trace() {
-    traceOut << "LDD R" << (int)Rd << ", Z+" << (int)K << " ";
-    int ret = this->operator()();
+int avr_op_LDD_Z::Trace(AvrDevice *core) {
+    core->TraceOut() << "LDD R" << (int)Rd << ", Z+" << (int)K << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_LDI::Trace() {
-    traceOut << "LDI R" << (int)R1 << ", " << HexChar(K) << " ";
-    int ret = this->operator()();
+int avr_op_LDI::Trace(AvrDevice *core) {
+    core->TraceOut() << "LDI R" << (int)R1 << ", " << HexChar(K) << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_LDS::Trace() {
+int avr_op_LDS::Trace(AvrDevice *core) {
     word offset = core->Flash->ReadMemWord((core->PC + 1) * 2);  //this is k!
-    traceOut << "LDS R" << (int)R1 << ", " << hex << "0x" << offset << dec  << " ";
-    int ret = this->operator()();
+    core->TraceOut() << "LDS R" << (int)R1 << ", " << hex << "0x" << offset << dec  << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_LD_X::Trace() {
-    traceOut << "LD R" << (int)Rd << ", X ";
-    int ret = this->operator()();
+int avr_op_LD_X::Trace(AvrDevice *core) {
+    core->TraceOut() << "LD R" << (int)Rd << ", X ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_LD_X_decr::Trace() {
-    traceOut << "LD R" << (int)Rd << ", -X ";
-    int ret = this->operator()();
+int avr_op_LD_X_decr::Trace(AvrDevice *core) {
+    core->TraceOut() << "LD R" << (int)Rd << ", -X ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_LD_X_incr::Trace() {
-    traceOut << "LD R" << (int)Rd << ", X+ ";
-    int ret = this->operator()();
+int avr_op_LD_X_incr::Trace(AvrDevice *core) {
+    core->TraceOut() << "LD R" << (int)Rd << ", X+ ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_LD_Y_decr::Trace() {
-    traceOut << "LD R" << (int)Rd << ", -Y ";
-    int ret = this->operator()();
+int avr_op_LD_Y_decr::Trace(AvrDevice *core) {
+    core->TraceOut() << "LD R" << (int)Rd << ", -Y ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_LD_Y_incr::Trace() {
-    traceOut << "LD R" << (int)Rd << ", Y+ " ;
-    int ret = this->operator()();
+int avr_op_LD_Y_incr::Trace(AvrDevice *core) {
+    core->TraceOut() << "LD R" << (int)Rd << ", Y+ " ;
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_LD_Z_incr::Trace() {
-    traceOut << "LD R" << (int)Rd << ", Z+ ";
-    int ret = this->operator()();
+int avr_op_LD_Z_incr::Trace(AvrDevice *core) {
+    core->TraceOut() << "LD R" << (int)Rd << ", Z+ ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_LD_Z_decr::Trace() {
-    traceOut << "LD R" << (int)Rd << ", -Z";
-    int ret = this->operator()();
+int avr_op_LD_Z_decr::Trace(AvrDevice *core) {
+    core->TraceOut() << "LD R" << (int)Rd << ", -Z";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_LPM_Z::Trace() {
-    traceOut << "LPM R" << (int)Rd << ", Z ";
-    int ret = this->operator()();
+int avr_op_LPM_Z::Trace(AvrDevice *core) {
+    core->TraceOut() << "LPM R" << (int)Rd << ", Z ";
+    int ret = this->operator()(core);
 
     /* Z is R31:R30 */
     unsigned int Z = core->GetRegZ();
     string sym(core->Flash->GetSymbolAtAddress(Z));
-    traceOut << "FLASH[" << hex << Z << dec << "," << sym << "] ";
+    core->TraceOut() << "FLASH[" << hex << Z << dec << "," << sym << "] ";
 
     return ret;
 }
 
-int avr_op_LPM::Trace() {
-    traceOut << "LPM R0, Z "; 
-    int ret = this->operator()();
+int avr_op_LPM::Trace(AvrDevice *core) {
+    core->TraceOut() << "LPM R0, Z "; 
+    int ret = this->operator()(core);
 
     /* Z is R31:R30 */
     unsigned int Z = core->GetRegZ();
     string sym(core->Flash->GetSymbolAtAddress(Z));
-    traceOut << "FLASH[" << hex << Z << dec << "," << sym << "] ";
+    core->TraceOut() << "FLASH[" << hex << Z << dec << "," << sym << "] ";
 
     return ret;
 }
 
-int avr_op_LPM_Z_incr::Trace() {
-    traceOut << "LPM R" << (int)Rd << ", Z+ " ;
+int avr_op_LPM_Z_incr::Trace(AvrDevice *core) {
+    core->TraceOut() << "LPM R" << (int)Rd << ", Z+ " ;
     /* Z is R31:R30 */
     unsigned int Z = core->GetRegZ();
-    int ret = this->operator()();
+    int ret = this->operator()(core);
     
     string sym(core->Flash->GetSymbolAtAddress(Z));
-    traceOut << "FLASH[" << hex << Z << dec << "," << sym << "] ";
+    core->TraceOut() << "FLASH[" << hex << Z << dec << "," << sym << "] ";
     return ret;
 }
 
-int avr_op_LSR::Trace() {
-    traceOut << "LSR R" << (int)Rd << " ";
-    int ret = this->operator()();
+int avr_op_LSR::Trace(AvrDevice *core) {
+    core->TraceOut() << "LSR R" << (int)Rd << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_MOV::Trace() {
-    traceOut << "MOV R" << (int)R1 << ", R" << (int)R2 << " ";
-    int ret = this->operator()();
+int avr_op_MOV::Trace(AvrDevice *core) {
+    core->TraceOut() << "MOV R" << (int)R1 << ", R" << (int)R2 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_MOVW::Trace() {
-    traceOut << "MOVW R" << (int)Rd << ", R" << (int)Rs << " ";
-    int ret = this->operator()();
+int avr_op_MOVW::Trace(AvrDevice *core) {
+    core->TraceOut() << "MOVW R" << (int)Rd << ", R" << (int)Rs << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_MUL::Trace() {
-    traceOut << "MUL R" << (int)Rd << ", R" << (int)Rr << " ";
-    int ret = this->operator()();
+int avr_op_MUL::Trace(AvrDevice *core) {
+    core->TraceOut() << "MUL R" << (int)Rd << ", R" << (int)Rr << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_MULS::Trace() {
-    traceOut << "MULS R" << (int)Rd << ", R" << (int)Rr << " ";
-    int ret = this->operator()();
+int avr_op_MULS::Trace(AvrDevice *core) {
+    core->TraceOut() << "MULS R" << (int)Rd << ", R" << (int)Rr << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_MULSU::Trace() {
-    traceOut << "MULSU R" << (int)Rd << ", R" << (int)Rr << " ";
-    int ret = this->operator()();
+int avr_op_MULSU::Trace(AvrDevice *core) {
+    core->TraceOut() << "MULSU R" << (int)Rd << ", R" << (int)Rr << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_NEG::Trace() {
-    traceOut << "NEG R" << (int)Rd <<" ";
-    int ret = this->operator()();
+int avr_op_NEG::Trace(AvrDevice *core) {
+    core->TraceOut() << "NEG R" << (int)Rd <<" ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_NOP::Trace() {
-    traceOut << "NOP ";
-    int ret = this->operator()();
+int avr_op_NOP::Trace(AvrDevice *core) {
+    core->TraceOut() << "NOP ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_OR::Trace() {
-    traceOut << "OR R" << (int)Rd << ", R" << (int)Rr << " ";
-    int ret = this->operator()();
+int avr_op_OR::Trace(AvrDevice *core) {
+    core->TraceOut() << "OR R" << (int)Rd << ", R" << (int)Rr << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_ORI::Trace() {
-    traceOut << "ORI R" << (int)R1 << ", " << HexChar(K) << " ";
-    int ret = this->operator()();
+int avr_op_ORI::Trace(AvrDevice *core) {
+    core->TraceOut() << "ORI R" << (int)R1 << ", " << HexChar(K) << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_OUT::Trace() {
-    traceOut << "OUT " << HexChar(ioreg) << ", R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_OUT::Trace(AvrDevice *core) {
+    core->TraceOut() << "OUT " << HexChar(ioreg) << ", R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_POP::Trace() {
-    traceOut << "POP R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_POP::Trace(AvrDevice *core) {
+    core->TraceOut() << "POP R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_PUSH::Trace() {
-    traceOut << "PUSH R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_PUSH::Trace(AvrDevice *core) {
+    core->TraceOut() << "PUSH R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_RCALL::Trace() {
-    traceOut << "RCALL " << hex << ((core->PC + K + 1) << 1) << dec << " ";
-    int ret = this->operator()();
+int avr_op_RCALL::Trace(AvrDevice *core) {
+    core->TraceOut() << "RCALL " << hex << ((core->PC + K + 1) << 1) << dec << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_RET::Trace() {
-    traceOut << "RET " ;
-    int ret = this->operator()();
+int avr_op_RET::Trace(AvrDevice *core) {
+    core->TraceOut() << "RET " ;
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_RETI::Trace() {
-    traceOut << "RETI ";
-    int ret = this->operator()();
+int avr_op_RETI::Trace(AvrDevice *core) {
+    core->TraceOut() << "RETI ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_RJMP::Trace() {
-    traceOut << "RJMP " << hex << ((core->PC + K + 1) << 1) << dec << " ";
-    int ret = this->operator()();
+int avr_op_RJMP::Trace(AvrDevice *core) {
+    core->TraceOut() << "RJMP " << hex << ((core->PC + K + 1) << 1) << dec << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_ROR::Trace() {
-    traceOut << "ROR R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_ROR::Trace(AvrDevice *core) {
+    core->TraceOut() << "ROR R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_SBC::Trace() {
-    traceOut << "SBC R" << (int)R1 << ", R" << (int)R2 << " ";
-    int ret = this->operator()();
+int avr_op_SBC::Trace(AvrDevice *core) {
+    core->TraceOut() << "SBC R" << (int)R1 << ", R" << (int)R2 << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_SBCI::Trace() {
-    traceOut << "SBCI R" << (int)R1 << ", " << HexChar(K) << " ";
-    int ret = this->operator()();
+int avr_op_SBCI::Trace(AvrDevice *core) {
+    core->TraceOut() << "SBCI R" << (int)R1 << ", " << HexChar(K) << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_SBI::Trace() {
-    traceOut << "SBI " << HexChar(ioreg) << ", " << (int)Kbit << " ";
-    int ret = this->operator()();
+int avr_op_SBI::Trace(AvrDevice *core) {
+    core->TraceOut() << "SBI " << HexChar(ioreg) << ", " << (int)Kbit << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_SBIC::Trace() {
-    traceOut << "SBIC " << HexChar(ioreg) << ", " << (int)Kbit << " ";
-    int ret = this->operator()();
+int avr_op_SBIC::Trace(AvrDevice *core) {
+    core->TraceOut() << "SBIC " << HexChar(ioreg) << ", " << (int)Kbit << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_SBIS::Trace() {
-    traceOut << "SBIS " << HexChar(ioreg) << ", " << (int)Kbit << " ";
-    int ret = this->operator()();
+int avr_op_SBIS::Trace(AvrDevice *core) {
+    core->TraceOut() << "SBIS " << HexChar(ioreg) << ", " << (int)Kbit << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_SBIW::Trace( ) {
-    traceOut << "SBIW R" << (int)R1 << ", " << HexChar(K) << " ";
-    int ret=this->operator()();
+int avr_op_SBIW::Trace(AvrDevice *core) {
+    core->TraceOut() << "SBIW R" << (int)R1 << ", " << HexChar(K) << " ";
+    int ret=this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_SBRC::Trace() {
-    traceOut << "SBRC R" << (int)R1 << ", " << (int)Kbit << " ";
-    int ret = this->operator()();
+int avr_op_SBRC::Trace(AvrDevice *core) {
+    core->TraceOut() << "SBRC R" << (int)R1 << ", " << (int)Kbit << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_SBRS::Trace() {
-    traceOut << "SBRS R" << (int)R1 << ", " << (int)Kbit << " ";
-    int ret = this->operator()();
+int avr_op_SBRS::Trace(AvrDevice *core) {
+    core->TraceOut() << "SBRS R" << (int)R1 << ", " << (int)Kbit << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_SLEEP::Trace() {
-    traceOut << "SLEEP " ;
-    int ret = this->operator()();
+int avr_op_SLEEP::Trace(AvrDevice *core) {
+    core->TraceOut() << "SLEEP " ;
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_SPM::Trace() {
-    traceOut << "SPM " ;
-    int ret = this->operator()();
+int avr_op_SPM::Trace(AvrDevice *core) {
+    core->TraceOut() << "SPM " ;
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_STD_Y::Trace() {
-    traceOut << "STD Y+" << (int)K << ", R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_STD_Y::Trace(AvrDevice *core) {
+    core->TraceOut() << "STD Y+" << (int)K << ", R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_STD_Z::Trace() {
-    traceOut << "STD Z+" << (int)K << ", R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_STD_Z::Trace(AvrDevice *core) {
+    core->TraceOut() << "STD Z+" << (int)K << ", R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_STS::Trace() {
+int avr_op_STS::Trace(AvrDevice *core) {
     word offset = core->Flash->ReadMemWord((core->PC + 1) * 2);  //this is k!
-    traceOut << "STS " << "0x" << hex << offset << dec << ", R" << (int)R1 << " ";
-    int ret = this->operator()();
+    core->TraceOut() << "STS " << "0x" << hex << offset << dec << ", R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_ST_X::Trace() {
-    traceOut << "ST X, R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_ST_X::Trace(AvrDevice *core) {
+    core->TraceOut() << "ST X, R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_ST_X_decr::Trace() {
-    traceOut << "ST -X, R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_ST_X_decr::Trace(AvrDevice *core) {
+    core->TraceOut() << "ST -X, R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_ST_X_incr::Trace() {
-    traceOut << "ST X+, R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_ST_X_incr::Trace(AvrDevice *core) {
+    core->TraceOut() << "ST X+, R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_ST_Y_decr::Trace() {
-    traceOut << "ST -Y, R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_ST_Y_decr::Trace(AvrDevice *core) {
+    core->TraceOut() << "ST -Y, R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_ST_Y_incr::Trace() {
-    traceOut << "ST Y+, R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_ST_Y_incr::Trace(AvrDevice *core) {
+    core->TraceOut() << "ST Y+, R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_ST_Z_decr::Trace() {
-    traceOut << "ST -Z, R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_ST_Z_decr::Trace(AvrDevice *core) {
+    core->TraceOut() << "ST -Z, R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_ST_Z_incr::Trace() {
-    traceOut << "ST Z+, R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_ST_Z_incr::Trace(AvrDevice *core) {
+    core->TraceOut() << "ST Z+, R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_SUB::Trace() {
-    traceOut << "SUB R" << (int)R1 << ", R" << (int)R2 << " ";
-    int ret = this->operator()();
+int avr_op_SUB::Trace(AvrDevice *core) {
+    core->TraceOut() << "SUB R" << (int)R1 << ", R" << (int)R2 << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_SUBI::Trace() {
-    traceOut << "SUBI R" << (int)R1 << ", " << HexChar(K) << " ";
-    int ret = this->operator()();
+int avr_op_SUBI::Trace(AvrDevice *core) {
+    core->TraceOut() << "SUBI R" << (int)R1 << ", " << HexChar(K) << " ";
+    int ret = this->operator()(core);
     MONSREG;
     return ret;
 }
 
-int avr_op_SWAP::Trace() {
-    traceOut << "SWAP R" << (int)R1 << " ";
-    int ret = this->operator()();
+int avr_op_SWAP::Trace(AvrDevice *core) {
+    core->TraceOut() << "SWAP R" << (int)R1 << " ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_WDR::Trace() {
-    traceOut << "WDR ";
-    int ret = this->operator()();
+int avr_op_WDR::Trace(AvrDevice *core) {
+    core->TraceOut() << "WDR ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_BREAK::Trace() {
-    traceOut << "BREAK ";
-    int ret = this->operator()();
+int avr_op_BREAK::Trace(AvrDevice *core) {
+    core->TraceOut() << "BREAK ";
+    int ret = this->operator()(core);
     return ret;
 }
 
-int avr_op_ILLEGAL::Trace() {
-    traceOut << "Invalid Instruction! ";
-    int ret = this->operator()();
+int avr_op_ILLEGAL::Trace(AvrDevice *core) {
+    core->TraceOut() << "Invalid Instruction! ";
+    int ret = this->operator()(core);
     return ret;
 }
 
@@ -25,6 +25,7 @@
 
 #include "externalirq.h"
 #include "avrerror.h"
+#include "snapshot.h"
 
 ExternalIRQHandler::ExternalIRQHandler(AvrDevice* c,
                                        HWIrqSystem* irqsys,
@@ -107,6 +108,13 @@ void ExternalIRQHandler::Reset(void) {
         extirqs[idx]->ResetMode();
 }
 
+void ExternalIRQHandler::Snapshot(SnapshotArchive &ar) {
+    ar.Item(irq_mask);
+    ar.Item(irq_flag);
+    for(unsigned int idx = 0; idx < extirqs.size(); idx++)
+        extirqs[idx]->Snapshot(ar);
+}
+
 unsigned char ExternalIRQHandler::set_from_reg(const IOSpecialReg* reg, unsigned char nv) {
     if(reg == mask_reg) {
         // mask register: trigger interrupt, if mask bit is new set and flag is true or fireAgain()
@@ -156,6 +164,10 @@ unsigned char ExternalIRQ::get_from_client(const IOSpecialReg* reg, unsigned cha
     return (v & ~mask) | (mode << bitshift);
 }
 
+void ExternalIRQ::Snapshot(SnapshotArchive &ar) {
+    ar.Item(mode);
+}
+
 ExternalIRQSingle::ExternalIRQSingle(IOSpecialReg *ctrl, int ctrlOffset, int ctrlBits, Pin *pin, bool _8515mode):
     ExternalIRQ(ctrl, ctrlOffset, ctrlBits)
 {
@@ -166,6 +178,11 @@ ExternalIRQSingle::ExternalIRQSingle(IOSpecialReg *ctrl, int ctrlOffset, int ctr
     ResetMode();
 }
 
+void ExternalIRQSingle::Snapshot(SnapshotArchive &ar) {
+    ExternalIRQ::Snapshot(ar);
+    ar.Item(state);
+}
+
 void ExternalIRQSingle::PinStateHasChanged(Pin *pin) {
     // new state
     bool s = (bool)*pin;
@@ -253,6 +270,11 @@ ExternalIRQPort::ExternalIRQPort(IOSpecialReg *ctrl, Pin* pinList[8]):
     ResetMode();
 }
 
+void ExternalIRQPort::Snapshot(SnapshotArchive &ar) {
+    ExternalIRQ::Snapshot(ar);
+    ar.Array(state, portSize);
+}
+
 void ExternalIRQPort::PinStateHasChanged(Pin *pin) {
     // new state
     bool s = (bool)*pin;
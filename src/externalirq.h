@@ -64,6 +64,7 @@ class ExternalIRQHandler: public Hardware, public IOSpecialRegClient {
         // from Hardware
         virtual void ClearIrqFlag(unsigned int vector);
         virtual void Reset(void);
+        virtual void Snapshot(SnapshotArchive &ar);
         virtual bool IsLevelInterrupt(unsigned int vector);
         virtual bool LevelInterruptPending(unsigned int vector);
         
@@ -91,6 +92,8 @@ class ExternalIRQ: public IOSpecialRegClient {
         virtual void ResetMode(void) { mode = 0; }
         //! Handle change of control register
         virtual void ChangeMode(unsigned char m) { mode = m; }
+        //! Save or restore mode and pin states
+        virtual void Snapshot(SnapshotArchive &ar);
         //! does the interrupt source fire again? (for interrupt on level)
         virtual bool fireAgain(void) { return false; }
         //! does fire interrupt set the interrupt flag? (level interrupt does this not!)
@@ -126,6 +129,7 @@ class ExternalIRQSingle: public ExternalIRQ, public HasPinNotifyFunction {
         
         // from ExternalIRQ
         void ChangeMode(unsigned char m);
+        void Snapshot(SnapshotArchive &ar);
         bool fireAgain(void);
         bool mustSetFlagOnFire(void);
         
@@ -145,6 +149,9 @@ class ExternalIRQPort: public ExternalIRQ, public HasPinNotifyFunction {
         ExternalIRQPort(IOSpecialReg *ctrl, HWPort *port);
         ExternalIRQPort(IOSpecialReg *ctrl, Pin* pinList[8]);
         
+        // from ExternalIRQ
+        void Snapshot(SnapshotArchive &ar);
+        
         // from HasPinNotifyFunction
         void PinStateHasChanged(Pin *pin);
 };
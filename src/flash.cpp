@@ -34,28 +34,32 @@
 #include "helper.h"
 #include "memory.h"
 #include "avrerror.h"
+#include "snapshot.h"
 
 void AvrFlash::Decode(){
-    for(unsigned int addr = 0; addr < size ; addr += 2)
-        Decode(addr);
+    Decode(0, size);
 }
 
 AvrFlash::AvrFlash(AvrDevice *c, int _size):
     Memory(_size),
     core(c),
-    DecodedMem(_size),
-    flashLoaded(false) {
+    DecodedMem(_size / 2),
+    DecodedRecords(_size / 2),
+    DecodedBlocks(_size / 2),
+    table(NULL),
+    flashLoaded(false),
+    flashModified(false) {
     for(unsigned int tt = 0; tt < size; tt++)
         myMemory[tt] = 0xff;  // Safeguard, will be decoded as avr_op_ILLEGAL
     rww_lock = 0;
-    // initialize DecodedMem
-    Decode();
+    Decode(); // initialize DecodedMem
 }
 
 AvrFlash::~AvrFlash() {
-    for(unsigned int i = 0; i < size; i++) {
-       if(DecodedMem[i] != NULL)
-          delete DecodedMem[i]; // delete Instruction
+    // instructions are owned by DecodedInstructionTable
+    if(table != NULL) {
+        DecodedInstructionTable::Lock lock;
+        table->Unref();
     }
 }
 
@@ -77,12 +81,34 @@ void AvrFlash::WriteMemByte(unsigned char val, unsigned int offset) {
     flashLoaded = true;
 }
 
+void AvrFlash::Snapshot(SnapshotArchive &ar) {
+    // FNV-1a hash of flash content
+    unsigned long long hash = 14695981039346656037ULL;
+    for(unsigned int i = 0; i < size; i++)
+        hash = (hash ^ myMemory[i]) * 1099511628211ULL;
+    bool modified = flashModified;
+    ar.Item(modified);
+    ar.Item(rww_lock);
+    if(modified) {
+        ar.Block(myMemory, size);
+        if(ar.IsRestoring()) {
+            Decode();
+            flashModified = true;
+        }
+    } else
+        ar.Check(hash, "flash checksum (made with another program?)");
+}
+
 DecodedInstruction* AvrFlash::GetInstruction(unsigned int pc) {
     if(IsRWWLock(pc * 2))
-        avr_error("flash is locked (RWW lock)");
+        RWWLockError();
     return DecodedMem[pc];
 }
 
+void AvrFlash::RWWLockError(void) {
+    avr_error("flash is locked (RWW lock)");
+}
+
 unsigned char AvrFlash::ReadMem(unsigned int offset) {
     if(IsRWWLock(offset)) {
         avr_warning("flash is locked (RWW lock)");
@@ -102,18 +128,62 @@ unsigned int AvrFlash::ReadMemWord(unsigned int offset) {
 }
 
 void AvrFlash::Decode(unsigned int offset, int secSize) {
+    DecodedInstructionTable::Lock lock;
+    DecodedInstructionTable *current = DecodedInstructionTable::ForCore(core);
+    if(current != table) {
+        // first decode or the instruction set of core was changed after it
+        // (the device sets its flags after constructor of AvrFlash), all
+        // instructions are taken from the new table then
+        current->Ref();
+        if(table != NULL)
+            table->Unref();
+        table = current;
+        offset = 0;
+        secSize = size;
+    }
     for(; (offset < size) && (secSize > 0); offset += 2, secSize -= 2)
-        Decode(offset);
+        DecodeWord(offset);
 }
 
 void AvrFlash::Decode(unsigned int addr) {
+    Decode(addr, 2);
+}
+
+void AvrFlash::DecodeWord(unsigned int addr) {
     assert((unsigned)addr < size);
     assert((addr % 2) == 0);
     word opcode = (myMemory[addr] << 8) + myMemory[addr + 1];
     unsigned int index = addr / 2;
-    if(DecodedMem[index] != NULL)
-        delete DecodedMem[index];                     //delete old Instruction here 
-    DecodedMem[index] = lookup_opcode(opcode, core);  //and set new one
+    DecodedMem[index] = table->Lookup(opcode, core);
+    DecodedRecords[index] = DecodedMem[index]->GetRecord();
+    // invalidate all blocks, which could contain this instruction
+    unsigned int first = (index < MaxBlockLength) ? 0 : index - MaxBlockLength + 1;
+    for(unsigned int i = first; i <= index; i++)
+        DecodedBlocks[i].valid = false;
+}
+
+void AvrFlash::AnalyseBlock(unsigned int pc) {
+    DecodedBlock &block = DecodedBlocks[pc];
+    DecodedInstruction *instr = DecodedMem[pc];
+    block.handler = DecodedRecords[pc].handler;
+    block.length = 0;
+    block.valid = true;
+
+    // count register operations in block
+    unsigned int idx = pc;
+    while(idx < DecodedMem.size() && block.length < MaxBlockLength && DecodedMem[idx]->IsRegisterOp()) {
+        block.length++;
+        idx++;
+    }
+
+    // flags written by this instruction are dead, if the next instruction in
+    // block overwrites them without reading them
+    unsigned char written = instr->GetFlagsWritten();
+    if(block.length < 2 || written == 0 || instr->GetNoFlagsHandler() == NULL)
+        return;
+    DecodedInstruction *next = DecodedMem[pc + 1];
+    if((next->GetFlagsRead() & written) == 0 && (next->GetFlagsWritten() & written) == written)
+        block.handler = instr->GetNoFlagsHandler();
 }
 
 /** Returns true if insn at address index*2 looks like switching thread stacks (heuristics).
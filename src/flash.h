@@ -33,21 +33,32 @@
 #include "memory.h"
 
 class DecodedInstruction;
+class SnapshotArchive;
+
+//! Analysis of a straight-line run of register operations in flash
+/*! See AvrFlash::GetDecodedBlock and DecodedInstruction::IsRegisterOp */
+struct DecodedBlock {
+    DecodedHandler handler; //!< handler for instruction at this PC, skips SREG flags overwritten by next instruction
+    unsigned short length;  //!< count of register operations from this PC on, 0 for other instructions
+    bool valid;             //!< Flag: false, if block has to be analysed again
+};
 
 //! Holds AVR flash content and symbol informations.
 class AvrFlash: public Memory {
   
     protected:
         AvrDevice *core;
-        std::vector <DecodedInstruction*> DecodedMem;
+        std::vector <DecodedInstruction*> DecodedMem; //!< decoded instructions, one per flash word, shared with other devices
+        std::vector <DecodedRecord> DecodedRecords; //!< compact copy of DecodedMem for execution
+        std::vector <DecodedBlock> DecodedBlocks; //!< block analysis, one per flash word, made on demand
+        DecodedInstructionTable *table; //!< table of instructions in DecodedMem, holds a reference on it
         unsigned int rww_lock; //!< When Flash write is in progress then addresses below this are inaccesible, otherwise 0.
         bool flashLoaded; //!< Flag, true if there was a write to Flash after constructor call (program load)
-        
-        friend int avr_op_CPSE::operator()();
-        friend int avr_op_SBIC::operator()();
-        friend int avr_op_SBIS::operator()();
-        friend int avr_op_SBRC::operator()();
-        friend int avr_op_SBRS::operator()();
+        bool flashModified; //!< Flag, true if the program has written to flash (SPM)
+
+        void RWWLockError(void); //!< abort simulation because of access to locked flash
+        void AnalyseBlock(unsigned int pc); //!< make block analysis for instruction at PC
+        void DecodeWord(unsigned int addr); //!< decode instruction at address, caller holds a table lock
 
     public:
       
@@ -74,6 +85,14 @@ class AvrFlash: public Memory {
         
         /*! True if flash was written, i.e. a program was loaded */
         bool IsProgramLoaded(void) { return flashLoaded; }
+
+        /*! Flash content was changed by the program itself, see Snapshot */
+        void SetModified(void) { flashModified = true; }
+
+        /*! Save or restore the flash state. The content is only saved, if it
+          was modified by the program, otherwise only a checksum is saved and
+          the loaded program has to be the same on restore. */
+        void Snapshot(SnapshotArchive &ar);
         
         /*! True if simulated Flash write is in progress and the address is in locked area. */
         bool IsRWWLock(unsigned int addr) { return (addr < rww_lock);}
@@ -85,6 +104,30 @@ class AvrFlash: public Memory {
         /*! Returns instruction at pointer PC. Aborts if Flash write is in progress. */
         DecodedInstruction* GetInstruction(unsigned int pc);
         
+        /*! Returns compact record of instruction at pointer PC. Aborts if Flash write is in progress. */
+        const DecodedRecord &GetDecodedRecord(unsigned int pc) {
+            if(IsRWWLock(pc * 2))
+                RWWLockError();
+            return DecodedRecords[pc];
+        }
+        
+        //! max. count of instructions in a block
+        enum { MaxBlockLength = 32 };
+
+        /*! Returns block analysis for instruction at pointer PC. A block is the
+          straight-line run of register operations, which starts at PC. The analysis
+          is invalidated, if one of this instructions is decoded again. */
+        const DecodedBlock &GetDecodedBlock(unsigned int pc) {
+            if(!DecodedBlocks[pc].valid)
+                AnalyseBlock(pc);
+            return DecodedBlocks[pc];
+        }
+        
+        /*! True, if instruction at pointer PC has 2 words. False for a PC behind flash end. */
+        bool IsInstruction2Words(unsigned int pc) const {
+            return (pc < DecodedRecords.size()) && DecodedRecords[pc].size2Word;
+        }
+        
         /*! Returns byte at flash address. Works even during flash writing. */
         unsigned char ReadMemRaw(unsigned int addr) { return myMemory[addr]; }
         
@@ -28,6 +28,7 @@
 #include "systemclock.h"
 #include "avrmalloc.h"
 #include "flash.h"
+#include "snapshot.h"
 
 //#include <iostream>
 //using namespace std;
@@ -100,6 +101,9 @@ unsigned int FlashProgramming::CpuCycle() {
             return 1;
         ClearOperationBits();
     }
+    // nothing to do till next SPMCR write
+    if(opr_enable_count == 0 && action != SPM_ACTION_LOCKCPU)
+        core->SuspendHardware(this);
     return 0;
 }
 
@@ -111,6 +115,15 @@ void FlashProgramming::Reset() {
     timeout = 0;
 }
 
+void FlashProgramming::Snapshot(SnapshotArchive &ar) {
+    ar.Item(spmcr_val);
+    ar.Item(opr_enable_count);
+    ar.Item(action);
+    ar.Item(spm_opr);
+    ar.Item(timeout);
+    ar.Block(tempBuffer, pageSize * 2);
+}
+
 unsigned char FlashProgramming::LPM_action(unsigned int xaddr, unsigned int addr) {
     return 0;
 }
@@ -128,6 +141,7 @@ int FlashProgramming::SPM_action(unsigned int data, unsigned int xaddr, unsigned
     // process/start prepared operation
     if(action == SPM_ACTION_PREPARE) {
         opr_enable_count = 0;
+        core->WakeUpHardware(this);
         if(spm_opr == SPM_OPS_UNLOCKRWW) {
             ClearOperationBits();
             spmcr_val &= ~0x40;
@@ -152,6 +166,7 @@ int FlashProgramming::SPM_action(unsigned int data, unsigned int xaddr, unsigned
             addr &= ~((pageSize * 2) - 1);
             // store temp buffer to flash
             core->Flash->WriteMem(tempBuffer, addr, pageSize * 2);
+            core->Flash->SetModified();
             // calculate system time, where operation is finished
             timeout = SystemClock::Instance().GetCurrentTime() + FlashProgramming::SPM_TIMEOUT;
             // lock cpu while writing flash
@@ -168,6 +183,7 @@ int FlashProgramming::SPM_action(unsigned int data, unsigned int xaddr, unsigned
             for(unsigned int i = 0; i < (pageSize * 2); i++)
                 tempBuffer[i] = 0xff;
             core->Flash->WriteMem(tempBuffer, addr, pageSize * 2);
+            core->Flash->SetModified();
             // calculate system time, where operation is finished
             timeout = SystemClock::Instance().GetCurrentTime() + FlashProgramming::SPM_TIMEOUT;
             // lock cpu while erasing flash
@@ -185,6 +201,7 @@ int FlashProgramming::SPM_action(unsigned int data, unsigned int xaddr, unsigned
 
 void FlashProgramming::SetSpmcr(unsigned char v) {
     spmcr_val = (spmcr_val & ~spmcr_valid_bits) + (v & spmcr_valid_bits);
+    core->WakeUpHardware(this);
     
     // calculate operation
     if(action == SPM_ACTION_NOOP) {
@@ -86,11 +86,14 @@ class FlashProgramming: public Hardware {
         
         unsigned int CpuCycle();
         void Reset();
+        void Snapshot(SnapshotArchive &ar);
         
         unsigned char LPM_action(unsigned int xaddr, unsigned int addr);
         int SPM_action(unsigned int data, unsigned int xaddr, unsigned int addr);
         void SetSpmcr(unsigned char v);
         unsigned char GetSpmcr() { return spmcr_val; }
+        //! Get flash page size in words
+        unsigned int GetPageSize() const { return pageSize; }
 
         IOReg<FlashProgramming> spmcr_reg;
         
@@ -26,6 +26,9 @@
 #include "hardware.h"
 #include "avrdevice.h"
 
-Hardware::Hardware(AvrDevice *core) { core->AddToResetList(this); }
+Hardware::Hardware(AvrDevice *core):
+    wakeupCycle(0) {
+    core->AddToResetList(this);
+}
 
 // EOF
@@ -27,6 +27,7 @@
 #define HARDWARE
 
 class AvrDevice;
+class SnapshotArchive;
 
 /*! Hardware objects are the subsystems of an AVR device. They have a clock and
   reset input and in addition will define various memory registers through
@@ -42,7 +43,12 @@ class Hardware {
 
         /*! Called for each AVR cycle when this hardware has registered itself
           as a receiver for AVR clocks. Returns nonzero if instructions should
-          not be executed (e.g. a Flash write is in progress). */
+          not be executed (e.g. a Flash write is in progress).
+
+          If nothing happens in the next cycles, the hardware can tell the core
+          with AvrDevice::SleepHardware or AvrDevice::SuspendHardware, that it
+          should be skipped till then. Register writes, which change this,
+          have to call AvrDevice::WakeUpHardware. */
         virtual unsigned int CpuCycle(void) { return 0; }
 
         /*! Implement the hardware's reset functionality here. The default
@@ -58,7 +64,19 @@ class Hardware {
         
         /*! Check a level interrupt on the time, where interrupt routine will be called */
         virtual bool LevelInterruptPending(unsigned int vector) { return false; }
+
+#ifndef SWIG
+        /*! Save or restore the internal state of the hardware, see
+          SnapshotArchive. Register values of IOSpecialReg instances are
+          saved by the core, so only state variables of the hardware itself
+          have to be passed. The default is a hardware without state. */
+        virtual void Snapshot(SnapshotArchive &) {}
+#endif
         
+    private:
+        friend class AvrDevice;
+        //! Core cycle, from which on CpuCycle has to be called again, see AvrDevice::SleepHardware
+        unsigned long long wakeupCycle;
 };
 
 #endif
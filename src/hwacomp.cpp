@@ -28,6 +28,7 @@
 #include "irqsystem.h"
 #include "hwad.h"
 #include "hwtimer.h"
+#include "snapshot.h"
 
 HWAcomp::HWAcomp(AvrDevice *core,
                  HWIrqSystem *irqsys,
@@ -90,6 +91,20 @@ void HWAcomp::Reset() {
         acsr |= ACO;
 }
 
+void HWAcomp::Snapshot(SnapshotArchive &ar) {
+    ar.Item(acme_sfior);
+    ar.Item(enabled);
+    ar.Item(acsr);
+    if(ar.IsRestoring()) {
+        // reflect ACIC state to timer
+        bool acic = (acsr & ACIC) == ACIC;
+        if(timerA != NULL)
+            timerA->SetACIC(acic);
+        if(timerB != NULL)
+            timerB->SetACIC(acic);
+    }
+}
+
 void HWAcomp::SetAcsr(unsigned char val) {
     unsigned char old = acsr & (ACO|ACI);
     bool old_acic = (acsr & ACIC) == ACIC;
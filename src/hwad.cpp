@@ -26,6 +26,7 @@
 #include "hwad.h"
 #include "irqsystem.h"
 #include "avrerror.h"
+#include "snapshot.h"
 
 HWARefPin::HWARefPin(AvrDevice *_core):
     HWARef(_core),
@@ -99,6 +100,10 @@ void HWAdmux::SetMuxSelect(int select) {
         notifyClient->NotifySignalChanged();
 }
 
+void HWAdmux::Snapshot(SnapshotArchive &ar) {
+    ar.Item(muxSelect);
+}
+
 void HWAdmux::PinStateHasChanged(Pin* p) {
     Pin *selected = ad[muxSelect];
     if((notifyClient != NULL) && (selected == p))
@@ -333,6 +338,23 @@ void HWAd::Reset(void) {
     adchLocked = false;
 }
 
+void HWAd::Snapshot(SnapshotArchive &ar) {
+    ar.Item(adch);
+    ar.Item(adcl);
+    ar.Item(adcsra);
+    ar.Item(adcsrb);
+    ar.Item(admux);
+    ar.Item(adchLocked);
+    ar.Item(adSample);
+    ar.Item(adMuxConfig);
+    ar.Item(prescaler);
+    ar.Item(prescalerSelect);
+    ar.Item(conversionState);
+    ar.Item(firstConversion);
+    ar.Item(state);
+    mux->Snapshot(ar);
+}
+
 void HWAd::NotifySignalChanged(void) {
     if((notifyClient != NULL) && !IsADEnabled())
         notifyClient->NotifySignalChanged();
@@ -360,6 +382,7 @@ void HWAd::SetAdcsrA(unsigned char val) {
         val |= ADSC;
     // store value
     adcsra = val;
+    core->WakeUpHardware(this);
 
     // set prescaler selection
     prescalerSelect = adcsra & ADPS;
@@ -503,6 +526,12 @@ int HWAd::ConversionUnipolar(float value, float ref) {
 }
 
 unsigned int HWAd::CpuCycle() {
+    // prescaler remains in reset, till ADC is enabled
+    if((adcsra & ADEN) == 0) {
+        prescaler = 0;
+        core->SuspendHardware(this);
+        return 0;
+    }
 
     if(IsPrescalerClock()) { // prescaler clock event
 
@@ -561,7 +590,7 @@ unsigned int HWAd::CpuCycle() {
                     if(adchLocked) {
                         // TODO: how to rewrite this, is traceOut right? Replace output to stderr.
                         if(core->trace_on)
-                            traceOut << "ADC result lost, adch is locked!" << std::endl;
+                            core->TraceOut() << "ADC result lost, adch is locked!" << std::endl;
                         else
                             std::cerr << "AD-Result lost adch is locked!" << std::endl;
                     } else // adch is unlocked
@@ -602,4 +631,9 @@ unsigned char HWAd_SFIOR::set_from_reg(const IOSpecialReg* reg, unsigned char nv
     return nv;
 }
 
+void HWAd_SFIOR::Snapshot(SnapshotArchive &ar) {
+    HWAd::Snapshot(ar);
+    ar.Item(adts);
+}
+
 // EOF
@@ -109,6 +109,7 @@ class HWAdmux: public HasPinNotifyFunction {
         virtual float GetValueAComp(int select, float vcc) { return 0.0; }
         virtual bool IsDifferenceChannel(int select) { return false; }
         void SetMuxSelect(int select);
+        void Snapshot(SnapshotArchive &ar);
         void PinStateHasChanged(Pin*);
         void RegisterNotifyClient(AnalogSignalChange *client) { notifyClient = client; }
         void UnregisterNotifyClient(void) { notifyClient = 0; }
@@ -260,6 +261,7 @@ class HWAd: public Hardware, public TraceValueRegister, public AnalogSignalChang
         void SetAdcsrB(unsigned char);
         void SetAdmux(unsigned char val);
         void Reset(void);
+        void Snapshot(SnapshotArchive &ar);
         void ClearIrqFlag(unsigned int vec);
 
         // interface for notify signal change in multiplexer
@@ -289,6 +291,7 @@ class HWAd_SFIOR: public HWAd, public IOSpecialRegClient {
         HWAd_SFIOR(AvrDevice *c, int _typ, HWIrqSystem *i, unsigned int iv, HWAdmux *a, HWARef *r, IOSpecialReg *s);
 
         void Reset(void) { HWAd::Reset(); adts = 0; }
+        void Snapshot(SnapshotArchive &ar);
 
         unsigned char set_from_reg(const IOSpecialReg* reg, unsigned char nv);
         unsigned char get_from_client(const IOSpecialReg* reg, unsigned char v) { return v; }
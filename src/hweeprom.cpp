@@ -28,6 +28,7 @@
 #include "systemclock.h"
 #include "irqsystem.h"
 #include "avrerror.h"
+#include "snapshot.h"
 #include <assert.h>
 
 using namespace std;
@@ -103,6 +104,18 @@ void HWEeprom::Reset() {
     cpuHoldCycles = 0;
 }
 
+void HWEeprom::Snapshot(SnapshotArchive &ar) {
+    ar.Item(eear);
+    ar.Item(eecr);
+    ar.Item(eedr);
+    ar.Item(opEnableCycles);
+    ar.Item(cpuHoldCycles);
+    ar.Item(opState);
+    ar.Item(opMode);
+    ar.Item(opAddr);
+    ar.Item(writeDoneTime);
+    ar.Block(myMemory, size);
+}
 
 HWEeprom::~HWEeprom() {
     avr_free(myMemory);
@@ -112,7 +125,7 @@ HWEeprom::~HWEeprom() {
 void HWEeprom::SetEearl(unsigned char val) {
     eear = ((eear & 0xff00) + val) & eear_mask;
     if(core->trace_on == 1)
-        traceOut << "EEAR=0x" << hex << eear << dec;
+        core->TraceOut() << "EEAR=0x" << hex << eear << dec;
 }
 
 void HWEeprom::SetEearh(unsigned char val) {
@@ -120,18 +133,18 @@ void HWEeprom::SetEearh(unsigned char val) {
         avr_warning("invalid write access: EEARH=0x%02x, EEPROM size <= 256 byte", val);
     eear = ((eear & 0x00ff) + (val << 8)) & eear_mask;
     if(core->trace_on == 1)
-        traceOut << "EEAR=0x" << hex << eear << dec;
+        core->TraceOut() << "EEAR=0x" << hex << eear << dec;
 }
 
 void HWEeprom::SetEedr(unsigned char val) {
     eedr = val;
     if(core->trace_on == 1)
-        traceOut << "EEDR=0x"<< hex << (unsigned int)eedr << dec;
+        core->TraceOut() << "EEDR=0x"<< hex << (unsigned int)eedr << dec;
 }
 
 void HWEeprom::SetEecr(unsigned char newval) {
     if(core->trace_on == 1)
-        traceOut << "EECR=0x" << hex << (unsigned int)newval << dec;
+        core->TraceOut() << "EECR=0x" << hex << (unsigned int)newval << dec;
     
     eecr = newval & eecr_mask;
 
@@ -153,7 +166,7 @@ void HWEeprom::SetEecr(unsigned char newval) {
                 eecr &= ~CTRL_READ; // reset read bit isn't described in document!
                 core->AddToCycleList(this);
                 if(core->trace_on == 1)
-                    traceOut << " EEPROM: Read = 0x" << hex << (unsigned int)eedr << dec;
+                    core->TraceOut() << " EEPROM: Read = 0x" << hex << (unsigned int)eedr << dec;
             }
             // write will not processed
             eecr &= ~CTRL_WRITE;
@@ -169,7 +182,7 @@ void HWEeprom::SetEecr(unsigned char newval) {
                 eedr = myMemory[eear];
                 eecr &= ~CTRL_READ; // reset read bit isn't described in document!
                 if(core->trace_on == 1)
-                    traceOut << " EEPROM: Read = 0x" << hex << (unsigned int)eedr << dec;
+                    core->TraceOut() << " EEPROM: Read = 0x" << hex << (unsigned int)eedr << dec;
                 break; // to ignore possible write request!
             }
             // start write operation
@@ -198,7 +211,7 @@ void HWEeprom::SetEecr(unsigned char newval) {
                 }
                 writeDoneTime = SystemClock::Instance().GetCurrentTime() + t;
                 if(core->trace_on == 1)
-                    traceOut << " EEPROM: Write start";
+                    core->TraceOut() << " EEPROM: Write start";
             }
             break;
             
@@ -226,7 +239,7 @@ unsigned int HWEeprom::CpuCycle() {
             if(opState == OPSTATE_ENABLED)
                 opState = OPSTATE_READY;
             if(core->trace_on == 1)
-                traceOut << " EEPROM: WriteEnable cleared";
+                core->TraceOut() << " EEPROM: WriteEnable cleared";
         }
     }
     
@@ -252,7 +265,7 @@ unsigned int HWEeprom::CpuCycle() {
                     break;
             }
             if(core->trace_on == 1)
-                traceOut << " EEPROM: Write done";
+                core->TraceOut() << " EEPROM: Write done";
             // now raise irq if enabled and available
             if((irqSystem != NULL) && ((eecr & CTRL_IRQ) == CTRL_IRQ))
                 irqSystem->SetIrqFlag(this, irqVectorNo);
@@ -81,6 +81,7 @@ class HWEeprom: public Hardware, public Memory, public TraceValueRegister {
 
         virtual unsigned int CpuCycle();
         void Reset();
+        void Snapshot(SnapshotArchive &ar);
         void ClearIrqFlag(unsigned int vector);
 
         void WriteMem(const unsigned char *, unsigned int offset, unsigned int size);
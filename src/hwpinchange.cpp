@@ -2,6 +2,7 @@
 #include <iostream>
 #include "hwpinchange.h"
 #include "irqsystem.h"
+#include "snapshot.h"
 
 using namespace std;
 
@@ -159,6 +160,11 @@ void HWPcir::Reset(){
 	_pcifr	= 0;
 	}
 
+void HWPcir::Snapshot(SnapshotArchive &ar){
+	ar.Item(_pcicr);
+	ar.Item(_pcifr);
+	}
+
 void HWPcir::ClearIrqFlag(unsigned int vector){
 	if(vector == _vector0){
 		_pcifr	&= ~(1<<0);
@@ -101,6 +101,7 @@ class HWPcir : public HWPcifrApi , public HWPcirMaskApi , public Hardware {
         
 	private:	// Hardware
         void Reset();
+        void Snapshot(SnapshotArchive &ar);
         void ClearIrqFlag(unsigned int vector);
 
 	
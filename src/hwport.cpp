@@ -29,6 +29,7 @@ using namespace std; // used for string class
 #include "hwport.h"
 #include "avrdevice.h"
 #include "avrerror.h"
+#include "snapshot.h"
 #include <assert.h>
 
 HWPort::HWPort(AvrDevice *core, const string &name, bool portToggle, int size):
@@ -81,6 +82,22 @@ void HWPort::Reset(void) {
     CalcOutputs();
 }
 
+void HWPort::Snapshot(SnapshotArchive &ar) {
+    ar.Item(port);
+    ar.Item(ddr);
+    for(unsigned int i = 0; i < portSize; i++) {
+        ar.Item(p[i].DDOE);
+        ar.Item(p[i].DDOV);
+        ar.Item(p[i].PVOE);
+        ar.Item(p[i].PVOV);
+        ar.Item(p[i].PVOEwDDR);
+        ar.Item(p[i].PUOE);
+        ar.Item(p[i].PUOV);
+    }
+    if(ar.IsRestoring())
+        CalcOutputs();
+}
+
 Pin& HWPort::GetPin(unsigned char pinNo) {
     assert(pinNo < sizeof(p)/sizeof(p[0]));
     return p[pinNo];
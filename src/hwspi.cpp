@@ -32,6 +32,7 @@
 #include "traceval.h"
 #include "irqsystem.h"
 #include "avrerror.h"
+#include "snapshot.h"
 
 //configuration
 #define SPIE 0x80
@@ -110,7 +111,7 @@ void HWSpi::SetSPSR(unsigned char val) {
         updatePrescaler();
     } else {
         ((core->trace_on) ?
-            (traceOut) : (cerr))
+            (core->TraceOut()) : (cerr))
             << "spsr is read only! (0x" << hex << core->PC << " =  " <<
             core->Flash->GetSymbolAtAddress(core->PC) << ")" << endl;
     }
@@ -197,6 +198,21 @@ void HWSpi::Reset() {
     data_write=data_read=shift_in=0;
 }
 
+void HWSpi::Snapshot(SnapshotArchive &ar) {
+    ar.Item(shift_in);
+    ar.Item(data_read);
+    ar.Item(data_write);
+    ar.Item(spsr);
+    ar.Item(spcr);
+    ar.Item(clkdiv);
+    ar.Item(spsr_read);
+    ar.Item(oldsck);
+    ar.Item(bitcnt);
+    ar.Item(clkcnt);
+    ar.Item(spi_cycles);
+    ar.Item(finished);
+}
+
 void HWSpi::ClearIrqFlag(unsigned int vector) {
     if (vector==irq_vector) {
         spsr&=~SPIF;
@@ -223,7 +239,7 @@ void HWSpi::trxend() {
     if (finished) {
     finished=false;
     if (core->trace_on && SPI_VERBOSE)
-        traceOut << "SPI: READ " << int(shift_in) << endl;
+        core->TraceOut() << "SPI: READ " << int(shift_in) << endl;
     /* set also data_write to allow continuous shifting
        when slave. */
     data_write=data_read=shift_in; 
@@ -243,7 +259,7 @@ unsigned int HWSpi::CpuCycle() {
     int bitpos_prec=(spcr&DORD) ? bitcnt-1 : 8-bitcnt;
     
     if (core->trace_on && SPI_VERBOSE) {
-        traceOut << "SPI: " << bitcnt << ", " << bitpos << ", " << clkcnt << endl;
+        core->TraceOut() << "SPI: " << bitcnt << ", " << bitpos << ", " << clkcnt << endl;
     }
     
     if (spcr & MSTR) {
@@ -24,6 +24,7 @@
  */
 
 #include "hwsreg.h"
+#include "types.h"
 
 #include <iostream>
 using namespace std;
@@ -47,7 +48,147 @@ HWSreg_bool::HWSreg_bool() {
     C = Z = N = V = S = H = T = I = 0;
 }
 
+static int get_add_carry( byte res, byte rd, byte rr, int b )
+{
+    byte resb = res >> b & 0x1;
+    byte rdb  = rd  >> b & 0x1;
+    byte rrb  = rr  >> b & 0x1;
+    return (rdb & rrb) | (rrb & ~resb) | (~resb & rdb);
+}
+
+static int get_add_overflow( byte res, byte rd, byte rr )
+{
+    byte res7 = res >> 7 & 0x1;
+    byte rd7  = rd  >> 7 & 0x1;
+    byte rr7  = rr  >> 7 & 0x1;
+    return (rd7 & rr7 & ~res7) | (~rd7 & ~rr7 & res7);
+}
+
+static int get_sub_carry( byte res, byte rd, byte rr, int b )
+{
+    byte resb = res >> b & 0x1;
+    byte rdb  = rd  >> b & 0x1;
+    byte rrb  = rr  >> b & 0x1;
+    return (~rdb & rrb) | (rrb & resb) | (resb & ~rdb);
+}
+
+static int get_sub_overflow( byte res, byte rd, byte rr )
+{
+    byte res7 = res >> 7 & 0x1;
+    byte rd7  = rd  >> 7 & 0x1;
+    byte rr7  = rr  >> 7 & 0x1;
+    return (rd7 & ~rr7 & ~res7) | (~rd7 & rr7 & res7);
+}
+
+const unsigned char HWSreg::lazyFlags[] = {
+    0,                                                  // LAZY_NONE
+    SREG_H | SREG_S | SREG_V | SREG_N | SREG_Z | SREG_C, // LAZY_ADD
+    SREG_H | SREG_S | SREG_V | SREG_N | SREG_Z | SREG_C, // LAZY_SUB
+    SREG_H | SREG_S | SREG_V | SREG_N | SREG_Z | SREG_C, // LAZY_SBC
+    SREG_S | SREG_V | SREG_N | SREG_Z,                   // LAZY_LOGIC
+    SREG_S | SREG_V | SREG_N | SREG_Z,                   // LAZY_INC
+    SREG_S | SREG_V | SREG_N | SREG_Z,                   // LAZY_DEC
+    SREG_S | SREG_V | SREG_N | SREG_Z | SREG_C,          // LAZY_COM
+    SREG_H | SREG_S | SREG_V | SREG_N | SREG_Z | SREG_C, // LAZY_NEG
+    SREG_S | SREG_V | SREG_N | SREG_Z | SREG_C,          // LAZY_SHIFT
+    SREG_S | SREG_V | SREG_N | SREG_Z | SREG_C,          // LAZY_ADIW
+    SREG_S | SREG_V | SREG_N | SREG_Z | SREG_C           // LAZY_SBIW
+};
+
+void HWSreg::UpdateLazy(void) {
+    byte res = lazyRes & 0xff;
+    byte rd = lazyRd;
+    byte rr = lazyRr;
+
+    switch(lazyOp) {
+        case LAZY_ADD:
+            H = get_add_carry(res, rd, rr, 3);
+            V = get_add_overflow(res, rd, rr);
+            N = (res >> 7) & 0x1;
+            Z = res == 0;
+            C = get_add_carry(res, rd, rr, 7);
+            break;
+
+        case LAZY_SUB:
+        case LAZY_SBC:
+            H = get_sub_carry(res, rd, rr, 3);
+            V = get_sub_overflow(res, rd, rr);
+            N = (res >> 7) & 0x1;
+            if(lazyOp == LAZY_SUB)
+                Z = res == 0;
+            else if(res != 0)
+                Z = 0; // Z flag is unchanged, if result is zero
+            C = get_sub_carry(res, rd, rr, 7);
+            break;
+
+        case LAZY_LOGIC:
+            V = 0;
+            N = (res >> 7) & 0x1;
+            Z = res == 0;
+            break;
+
+        case LAZY_INC:
+            V = rd == 0x7f;
+            N = (res >> 7) & 0x1;
+            Z = res == 0;
+            break;
+
+        case LAZY_DEC:
+            V = res == 0x7f;
+            N = (res >> 7) & 0x1;
+            Z = res == 0;
+            break;
+
+        case LAZY_COM:
+            V = 0;
+            N = (res >> 7) & 0x1;
+            Z = res == 0;
+            C = 1;
+            break;
+
+        case LAZY_NEG:
+            H = ((res >> 3) | (rd >> 3)) & 0x1;
+            V = res == 0x80;
+            N = (res >> 7) & 0x1;
+            Z = res == 0;
+            C = res != 0;
+            break;
+
+        case LAZY_SHIFT:
+            C = rd & 0x1;
+            N = (res >> 7) & 0x1;
+            V = N ^ C;
+            Z = res == 0;
+            break;
+
+        case LAZY_ADIW:
+            V = ~(rd >> 7 & 0x1) & (lazyRes >> 15 & 0x1);
+            N = (lazyRes >> 15) & 0x1;
+            Z = lazyRes == 0;
+            C = ~(lazyRes >> 15 & 0x1) & (rd >> 7 & 0x1);
+            break;
+
+        case LAZY_SBIW:
+            V = (rd >> 7 & 0x1) & ~(lazyRes >> 15 & 0x1);
+            N = (lazyRes >> 15) & 0x1;
+            Z = lazyRes == 0;
+            C = (lazyRes >> 15 & 0x1) & ~(rd >> 7 & 0x1);
+            break;
+
+        case LAZY_NONE:
+            break;
+    }
+    S = N ^ V;
+    lazyOp = LAZY_NONE;
+}
+
+HWSreg::operator int() {
+    Update();
+    return HWSreg_bool::operator int();
+}
+
 HWSreg::operator string() {
+    Update();
     string s("SREG=[");
     if(I) s += "I"; else s += "-";
     if(T) s += "T"; else s += "-";
@@ -62,6 +203,7 @@ HWSreg::operator string() {
 }
 
 HWSreg HWSreg::operator =(const int i) {
+    lazyOp = LAZY_NONE;
     C = i & 0x01;
     Z = (i & 0x02) > 1;
     N = (i & 0x04) > 2;
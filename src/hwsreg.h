@@ -52,10 +52,65 @@ class HWSreg_bool {
 class HWSreg: public HWSreg_bool {
     
     public:
+        //! Bit masks of the flags in SREG
+        enum {
+            SREG_C = 0x01,
+            SREG_Z = 0x02,
+            SREG_N = 0x04,
+            SREG_V = 0x08,
+            SREG_S = 0x10,
+            SREG_H = 0x20,
+            SREG_T = 0x40,
+            SREG_I = 0x80
+        };
+        //! ALU operations, which flags are calculated on demand
+        /*! An arithmetic instruction only records the kind of operation, the
+          result and the operands. Flags H, S, V, N, Z and C are derived from
+          this record only, if somebody reads the flags. I and T are never
+          evaluated lazy. */
+        enum LazyOp {
+            LAZY_NONE,  //!< all flags are valid
+            LAZY_ADD,   //!< ADD, ADC
+            LAZY_SUB,   //!< SUB, SUBI, CP, CPI
+            LAZY_SBC,   //!< SBC, SBCI, CPC (Z flag is kept, if result is zero)
+            LAZY_LOGIC, //!< AND, ANDI, OR, ORI, EOR
+            LAZY_INC,   //!< INC
+            LAZY_DEC,   //!< DEC
+            LAZY_COM,   //!< COM
+            LAZY_NEG,   //!< NEG
+            LAZY_SHIFT, //!< ASR, LSR, ROR
+            LAZY_ADIW,  //!< ADIW (16 bit result, rd is high byte of operand)
+            LAZY_SBIW   //!< SBIW (16 bit result, rd is high byte of operand)
+        };
+
+        HWSreg(): lazyOp(LAZY_NONE) {}
+
+        //! Record a ALU operation, flags will be calculated later
+        void SetLazy(LazyOp op, unsigned short res, unsigned char rd = 0, unsigned char rr = 0) {
+            if(lazyOp != LAZY_NONE && (lazyFlags[lazyOp] & ~lazyFlags[op]) != 0)
+                UpdateLazy();
+            lazyOp = op;
+            lazyRes = res;
+            lazyRd = rd;
+            lazyRr = rr;
+        }
+        //! Calculate pending flags, must be called before flags are read or written directly
+        void Update(void) { if(lazyOp != LAZY_NONE) UpdateLazy(); }
+
 #ifndef SWIG
+        operator int();
         operator std::string();
         HWSreg operator =(const int );
 #endif
+
+    protected:
+        LazyOp lazyOp;          //!< pending operation
+        unsigned short lazyRes; //!< result of pending operation
+        unsigned char lazyRd;   //!< first operand of pending operation
+        unsigned char lazyRr;   //!< second operand of pending operation
+        static const unsigned char lazyFlags[]; //!< flags written by a lazy operation
+
+        void UpdateLazy(void);
 };
 
 /*! SREG - ALU status register in IO space
@@ -67,7 +122,9 @@ class RWSreg: public RWMemoryMember {
     public:
         RWSreg(TraceValueRegister *registry, HWSreg *s): RWMemoryMember(registry, "SREG"), status(s) {}
         //! reflect a change, which comes from CPU core
-        void trigger_change(void) { tv->change((int)*status); }
+        void trigger_change(void) { if(tv->enabled()) tv->change((int)*status); }
+        //! Check, if SREG is traced by a dumper
+        bool IsTraced(void) const { return tv->enabled(); }
 
     protected:
         HWSreg *status;
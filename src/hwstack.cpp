@@ -27,6 +27,8 @@
 #include "avrerror.h"
 #include "avrmalloc.h"
 #include "flash.h"
+#include "irqsystem.h"
+#include "snapshot.h"
 #include <assert.h>
 #include <cstdio>  // NULL
 
@@ -36,16 +38,44 @@ HWStack::HWStack(AvrDevice *c):
     core(c),
     m_ThreadList(*c)
 {
+    irqReturnList.reserve(8);
     Reset();
 }
 
 void HWStack::Reset(void) {
     returnPointList.clear();
+    irqReturnList.clear();
     stackPointer = 0;
     lowestStackPointer = 0;
 }
 
-void HWStack::CheckReturnPoints() {
+void HWStack::Snapshot(SnapshotArchive &ar) {
+    ar.Item(stackPointer);
+    ar.Item(lowestStackPointer);
+    unsigned int count = irqReturnList.size();
+    ar.Item(count);
+    if(ar.IsRestoring()) {
+        returnPointList.clear();
+        irqReturnList.resize(count);
+    }
+    for(unsigned int i = 0; i < count; i++) {
+        ar.Item(irqReturnList[i].stackPointer);
+        ar.Item(irqReturnList[i].vector);
+    }
+}
+
+void HWStack::CheckIrqReturnPoints() {
+    for(size_t i = 0; i < irqReturnList.size(); ) {
+        if(irqReturnList[i].stackPointer == stackPointer) {
+            unsigned int vector = irqReturnList[i].vector;
+            irqReturnList.erase(irqReturnList.begin() + i);
+            core->irqSystem->IrqHandlerFinished(vector);
+        } else
+            i++;
+    }
+}
+
+void HWStack::CheckFunktorReturnPoints() {
     typedef multimap<unsigned long, Funktor *>::iterator I;
     pair<I,I> l = returnPointList.equal_range(stackPointer);
     
@@ -60,6 +90,13 @@ void HWStack::SetReturnPoint(unsigned long stackPointer, Funktor *f) {
     returnPointList.insert(make_pair(stackPointer, f));
 }
 
+void HWStack::SetIrqReturnPoint(unsigned long stackPointer, unsigned int vector) {
+    IrqReturnPoint r;
+    r.stackPointer = stackPointer;
+    r.vector = vector;
+    irqReturnList.push_back(r);
+}
+
 HWStackSram::HWStackSram(AvrDevice *c, int bs, bool initRE):
     HWStack(c),
     TraceValueRegister(c, "STACK"),
@@ -75,6 +112,7 @@ HWStackSram::HWStackSram(AvrDevice *c, int bs, bool initRE):
 
 void HWStackSram::Reset() {
     returnPointList.clear();
+    irqReturnList.clear();
     if(initRAMEND)
         stackPointer = core->GetMemIRamSize() +
                        core->GetMemIOSize() +
@@ -93,7 +131,7 @@ void HWStackSram::Push(unsigned char val) {
     sph_reg.hardwareChange((stackPointer & 0x00ff00)>>8);
     
     if(core->trace_on == 1)
-        traceOut << "SP=0x" << hex << stackPointer << " 0x" << int(val) << dec << " ";
+        core->TraceOut() << "SP=0x" << hex << stackPointer << " 0x" << int(val) << dec << " ";
     m_ThreadList.OnPush();
     CheckReturnPoints();
     
@@ -110,7 +148,7 @@ unsigned char HWStackSram::Pop() {
     sph_reg.hardwareChange((stackPointer & 0x00ff00)>>8);
     
     if(core->trace_on == 1)
-        traceOut << "SP=0x" << hex << stackPointer << " 0x" << int(core->GetRWMem(stackPointer)) << dec << " ";
+        core->TraceOut() << "SP=0x" << hex << stackPointer << " 0x" << int(core->GetRWMem(stackPointer)) << dec << " ";
     m_ThreadList.OnPop();
     CheckReturnPoints();
     return core->GetRWMem(stackPointer);
@@ -148,7 +186,7 @@ void HWStackSram::SetSpl(unsigned char val) {
     spl_reg.hardwareChange(stackPointer & 0x0000ff);
     
     if(core->trace_on == 1)
-        traceOut << "SP=0x" << hex << stackPointer << dec << " " ; 
+        core->TraceOut() << "SP=0x" << hex << stackPointer << dec << " " ; 
     if(oldSP != stackPointer)
         m_ThreadList.OnSPWrite(stackPointer);
     CheckReturnPoints();
@@ -165,7 +203,7 @@ void HWStackSram::SetSph(unsigned char val) {
     sph_reg.hardwareChange((stackPointer & 0x00ff00)>>8);
 
     if(core->trace_on == 1)
-        traceOut << "SP=0x" << hex << stackPointer << dec << " " ; 
+        core->TraceOut() << "SP=0x" << hex << stackPointer << dec << " " ; 
     if(oldSP != stackPointer)
         m_ThreadList.OnSPWrite(stackPointer);
     CheckReturnPoints();
@@ -198,10 +236,16 @@ ThreeLevelStack::~ThreeLevelStack() {
 
 void ThreeLevelStack::Reset(void) {
     returnPointList.clear();
+    irqReturnList.clear();
     stackPointer = 3;
     lowestStackPointer = stackPointer;
 }
 
+void ThreeLevelStack::Snapshot(SnapshotArchive &ar) {
+    HWStack::Snapshot(ar);
+    ar.Array(stackArea, 3);
+}
+
 void ThreeLevelStack::Push(unsigned char val) {
     avr_error("Push method isn't available on TreeLevelStack");
 }
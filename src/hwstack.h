@@ -32,6 +32,7 @@
 #include "traceval.h"
 
 #include <map>
+#include <vector>
 
 /** A thread automatically detected in simulated program.
 * We keep track of them in core->stack.m_ThreadList.m_threads[] and
@@ -95,9 +96,22 @@ class HWStack {
         uint32_t stackPointer; //!< current value of stack pointer
         uint32_t lowestStackPointer; //!< marker: lowest stackpointer used by program
         std::multimap<unsigned long, Funktor*> returnPointList; //!< Maps adresses to listeners for return addresses
+        //! Return address of a interrupt handler
+        struct IrqReturnPoint {
+            unsigned long stackPointer; //!< stack pointer before interrupt entry
+            unsigned int vector; //!< interrupt vector
+        };
+        std::vector<IrqReturnPoint> irqReturnList; //!< interrupt handlers, which are running
 
         /// Run functions registered for current stack address and delete them
-        void CheckReturnPoints();
+        void CheckReturnPoints() {
+            if(!irqReturnList.empty())
+                CheckIrqReturnPoints();
+            if(!returnPointList.empty())
+                CheckFunktorReturnPoints();
+        }
+        void CheckIrqReturnPoints(); //!< Finish interrupt handlers, which return to current stack address
+        void CheckFunktorReturnPoints(); //!< Run Funktors registered for current stack address and delete them
         
     public:
         ThreadList m_ThreadList;  ///< List of known threads created within target.
@@ -111,6 +125,10 @@ class HWStack {
         virtual unsigned long PopAddr()=0; //!< Pops a address from stack
 
         virtual void Reset(); //!< Resets stack pointer and listener table
+        //! Save or restore stack pointer and running interrupt handlers, see SnapshotArchive
+        /*! Listeners set by SetReturnPoint and the thread list aren't saved,
+            listeners are removed on restore like on Reset. */
+        virtual void Snapshot(SnapshotArchive &ar);
 
         //! Returns current stack pointer value
         unsigned long GetStackPointer() const { return stackPointer; }
@@ -120,6 +138,9 @@ class HWStack {
         /*! Attention! SetReturnPoint must get a COPY of a Funktor because it
             self destroy this functor after usage! */
         void SetReturnPoint(unsigned long stackPointer, Funktor *listener);
+        //! Calls HWIrqSystem::IrqHandlerFinished, if stack pointer returns to stackPointer
+        /*! Unlike SetReturnPoint no memory is allocated per call. */
+        void SetIrqReturnPoint(unsigned long stackPointer, unsigned int vector);
         
         //! Sets lowest stack marker back to current stackpointer
         void ResetLowestStackpointer(void) { lowestStackPointer = stackPointer; }
@@ -171,6 +192,7 @@ class ThreeLevelStack: public HWStack, public TraceValueRegister {
         virtual unsigned long PopAddr();
 
         virtual void Reset();
+        virtual void Snapshot(SnapshotArchive &ar);
 };
 
 #endif
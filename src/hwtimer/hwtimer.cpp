@@ -29,6 +29,7 @@
 #include "hwtimer.h"
 #include "../helper.h"
 #include "systemclock.h"
+#include "snapshot.h"
 
 #include <cstdlib>
 #include <time.h>
@@ -568,10 +569,40 @@ void BasicTimerUnit::Reset() {
     icapNoiseCanceler = false;
 }
 
+void BasicTimerUnit::Snapshot(SnapshotArchive &ar) {
+    ar.Item(cs);
+    ar.Item(captureInputState);
+    ar.Item(icapNCcounter);
+    ar.Item(icapNCstate);
+    ar.Item(vtcnt);
+    ar.Item(vlast_tcnt);
+    ar.Item(updown_counting);
+    ar.Item(count_down);
+    ar.Item(limit_bottom);
+    ar.Item(limit_top);
+    ar.Item(limit_max);
+    ar.Item(icapRegister);
+    ar.Item(icapRisingEdge);
+    ar.Item(icapNoiseCanceler);
+    ar.Item(wgm);
+    ar.Array(compare, OCRIDX_maxUnits);
+    ar.Array(compare_dbl, OCRIDX_maxUnits);
+    ar.Array(compareEnable, OCRIDX_maxUnits);
+    ar.Array(com, OCRIDX_maxUnits);
+    ar.Array(compare_output_state, OCRIDX_maxUnits);
+    premx->Snapshot(ar);
+}
+
 unsigned int BasicTimerUnit::CpuCycle() {
     if(premx->isClock(cs))
         CountTimer();
     InputCapture();
+    // without input capture nothing happens till next timer clock
+    if(icapSource == NULL || WGMuseICR()) {
+        unsigned int cycles = premx->cyclesToClock(cs);
+        if(cycles > 1)
+            core->SleepHardware(this, cycles);
+    }
     return 0;
 }
 
@@ -772,6 +803,11 @@ void HWTimer16::Reset(void) {
     accessTempRegister = 0;
 }
 
+void HWTimer16::Snapshot(SnapshotArchive &ar) {
+    BasicTimerUnit::Snapshot(ar);
+    ar.Item(accessTempRegister);
+}
+
 void HWTimer16::SetCompareRegister(int idx, bool high, unsigned char val) {
     unsigned long temp;
     if(high) {
@@ -838,6 +874,7 @@ unsigned char HWTimer16::GetComplexRegister(bool is_icr, bool high) {
 
 void HWTimer16::ChangeWGM(WGMtype mode) {
     wgm = mode;
+    core->WakeUpHardware(this); // input capture could be necessary now
     switch(wgm) {
         case WGM_RESERVED:
         case WGM_tablesize:
@@ -938,6 +975,11 @@ void HWTimer8_0C::Reset() {
     tccr_val = 0;
 }
 
+void HWTimer8_0C::Snapshot(SnapshotArchive &ar) {
+    HWTimer8::Snapshot(ar);
+    ar.Item(tccr_val);
+}
+
 HWTimer8_1C::HWTimer8_1C(AvrDevice *core,
                          PrescalerMultiplexer *p,
                          int unit,
@@ -973,6 +1015,11 @@ void HWTimer8_1C::Reset() {
     tccr_val = 0;
 }
 
+void HWTimer8_1C::Snapshot(SnapshotArchive &ar) {
+    HWTimer8::Snapshot(ar);
+    ar.Item(tccr_val);
+}
+
 HWTimer8_2C::HWTimer8_2C(AvrDevice *core,
                          PrescalerMultiplexer *p,
                          int unit,
@@ -1043,6 +1090,13 @@ void HWTimer8_2C::Reset() {
     wgm_raw = 0;
 }
 
+void HWTimer8_2C::Snapshot(SnapshotArchive &ar) {
+    HWTimer8::Snapshot(ar);
+    ar.Item(tccra_val);
+    ar.Item(tccrb_val);
+    ar.Item(wgm_raw);
+}
+
 HWTimer16_1C::HWTimer16_1C(AvrDevice *core,
                            PrescalerMultiplexer *p,
                            int unit,
@@ -1106,6 +1160,13 @@ void HWTimer16_1C::Reset() {
     wgm_raw = 0;
 }
 
+void HWTimer16_1C::Snapshot(SnapshotArchive &ar) {
+    HWTimer16::Snapshot(ar);
+    ar.Item(tccra_val);
+    ar.Item(tccrb_val);
+    ar.Item(wgm_raw);
+}
+
 HWTimer16_2C2::HWTimer16_2C2(AvrDevice *core,
                              PrescalerMultiplexer *p,
                              int unit,
@@ -1187,6 +1248,13 @@ void HWTimer16_2C2::Reset() {
     wgm_raw = 0;
 }
 
+void HWTimer16_2C2::Snapshot(SnapshotArchive &ar) {
+    HWTimer16::Snapshot(ar);
+    ar.Item(tccra_val);
+    ar.Item(tccrb_val);
+    ar.Item(wgm_raw);
+}
+
 HWTimer16_2C3::HWTimer16_2C3(AvrDevice *core,
                              PrescalerMultiplexer *p,
                              int unit,
@@ -1247,6 +1315,12 @@ void HWTimer16_2C3::Reset() {
     tccrb_val = 0;
 }
 
+void HWTimer16_2C3::Snapshot(SnapshotArchive &ar) {
+    HWTimer16::Snapshot(ar);
+    ar.Item(tccra_val);
+    ar.Item(tccrb_val);
+}
+
 HWTimer16_3C::HWTimer16_3C(AvrDevice *core,
                            PrescalerMultiplexer *p,
                            int unit,
@@ -1313,6 +1387,12 @@ void HWTimer16_3C::Reset() {
     tccrb_val = 0;
 }
 
+void HWTimer16_3C::Snapshot(SnapshotArchive &ar) {
+    HWTimer16::Snapshot(ar);
+    ar.Item(tccra_val);
+    ar.Item(tccrb_val);
+}
+
 //! Step time in ns for async clock by pll
 /*! Because system clock steps are counted in ns, we have to calculate so many steps to get
  * over all steps a time in ns without fraction. For 64MHz, e.g. 15,625 ns period, this step
@@ -1418,6 +1498,45 @@ void HWTimerTinyX5::Reset() {
     SetPrescalerClock(false); // reset prescaler to sync. clock mode, if necessary!
 }
 
+void HWTimerTinyX5::Snapshot(SnapshotArchive &ar) {
+    ar.Item(counter);
+    ar.Item(prescaler);
+    ar.Item(dtprescaler);
+    tccr_inout_val.Snapshot(ar);
+    ocra_inout_val.Snapshot(ar);
+    ocrb_inout_val.Snapshot(ar);
+    ocrc_inout_val.Snapshot(ar);
+    gtccr_in_val.Snapshot(ar);
+    ar.Item(dtps1_inout_val);
+    dt1a_inout_val.Snapshot(ar);
+    dt1b_inout_val.Snapshot(ar);
+    ar.Item(tcnt_out_val);
+    ar.Item(tcnt_out_async_tmp);
+    ar.Item(tcnt_in_val);
+    ar.Item(tcnt_set_flag);
+    ar.Item(tov_internal_flag);
+    ar.Item(tocra_internal_flag);
+    ar.Item(tocrb_internal_flag);
+    ar.Item(ocra_internal_val);
+    ar.Item(ocra_compare);
+    ocra_unit.Snapshot(ar);
+    ar.Item(ocrb_internal_val);
+    ar.Item(ocrb_compare);
+    ocrb_unit.Snapshot(ar);
+    ar.Item(cfg_prescaler);
+    ar.Item(cfg_dtprescaler);
+    ar.Item(cfg_mode);
+    ar.Item(cfg_ctc);
+    ar.Item(cfg_com_a);
+    ar.Item(cfg_com_b);
+    ar.Item(asyncClock_step);
+    ar.Item(asyncClock_async);
+    ar.Item(asyncClock_lsm);
+    ar.Item(asyncClock_pll);
+    ar.Item(asyncClock_plllock);
+    ar.Item(asyncClock_locktime);
+}
+
 int HWTimerTinyX5::Step(bool &untilCoreStepFinished, SystemClockOffset *nextStepIn_ns) {
     if(asyncClock_async) {
         *nextStepIn_ns = HWTimerTinyX5_nextdelay[asyncClock_step];
@@ -1768,6 +1887,20 @@ void TimerTinyX5_OCR::Reset() {
     dtCounter = 0;
 }
 
+void TimerTinyX5_OCR::Snapshot(SnapshotArchive &ar) {
+    ar.Item(ocrComMode);
+    ar.Item(ocrPWM);
+    ar.Item(ocrOut);
+    ar.Item(dtHigh);
+    ar.Item(dtLow);
+    ar.Item(dtCounter);
+}
+
+void HWTimerTinyX5_SyncReg::Snapshot(SnapshotArchive &ar) {
+    ar.Item(inValue);
+    ar.Item(regValue);
+}
+
 void TimerTinyX5_OCR::DTClockCycle() {
     if(dtCounter > 0) {
         dtCounter--;
@@ -77,6 +77,8 @@ class BasicTimerUnit: public Hardware, public TraceValueRegister {
         ~BasicTimerUnit();
         //! Perform a reset of this unit
         void Reset();
+        //! Save or restore counter, compare units and configuration
+        void Snapshot(SnapshotArchive &ar);
         
         //! Process timer/counter unit operations by CPU cycle
         virtual unsigned int CpuCycle();
@@ -332,6 +334,8 @@ class HWTimer16: public BasicTimerUnit {
                   ICaptureSource* icapsrc);
         //! Perform a reset of this unit
         void Reset(void);
+        //! Save or restore counter, compare units and configuration
+        void Snapshot(SnapshotArchive &ar);
 };
 
 //! Timer unit with 8Bit counter and no output compare unit
@@ -363,6 +367,8 @@ class HWTimer8_0C: public HWTimer8 {
                     IRQLine* tov);
         //! Perform a reset of this unit
         void Reset(void);
+        //! Save or restore counter, compare units and configuration
+        void Snapshot(SnapshotArchive &ar);
 };
 
 //! Timer unit with 8Bit counter and one output compare unit
@@ -395,6 +401,8 @@ class HWTimer8_1C: public HWTimer8 {
                     PinAtPort* outA);
         //! Perform a reset of this unit
         void Reset(void);
+        //! Save or restore counter, compare units and configuration
+        void Snapshot(SnapshotArchive &ar);
 };
 
 //! Timer unit with 8Bit counter and 2 output compare unit
@@ -449,6 +457,8 @@ class HWTimer8_2C: public HWTimer8 {
                     PinAtPort* outB);
         //! Perform a reset of this unit
         void Reset(void);
+        //! Save or restore counter, compare units and configuration
+        void Snapshot(SnapshotArchive &ar);
 };
 
 //! Timer unit with 16Bit counter and one output compare unit
@@ -503,6 +513,8 @@ class HWTimer16_1C: public HWTimer16 {
                      ICaptureSource* icapsrc);
         //! Perform a reset of this unit
         void Reset(void);
+        //! Save or restore counter, compare units and configuration
+        void Snapshot(SnapshotArchive &ar);
 };
 
 //! Timer unit with 16Bit counter and 2 output compare units and 2 config registers
@@ -565,6 +577,8 @@ class HWTimer16_2C2: public HWTimer16 {
                       bool is_at8515);
         //! Perform a reset of this unit
         void Reset(void);
+        //! Save or restore counter, compare units and configuration
+        void Snapshot(SnapshotArchive &ar);
 };
 
 //! Timer unit with 16Bit counter and 2 output compare units, but 3 config registers
@@ -628,6 +642,8 @@ class HWTimer16_2C3: public HWTimer16 {
                       ICaptureSource* icapsrc);
         //! Perform a reset of this unit
         void Reset(void);
+        //! Save or restore counter, compare units and configuration
+        void Snapshot(SnapshotArchive &ar);
 };
 
 //! Timer unit with 16Bit counter and 3 output compare units
@@ -693,6 +709,8 @@ class HWTimer16_3C: public HWTimer16 {
                      ICaptureSource* icapsrc);
         //! Perform a reset of this unit
         void Reset(void);
+        //! Save or restore counter, compare units and configuration
+        void Snapshot(SnapshotArchive &ar);
 };
 
 //! PWM output unit for timer 1 on ATtiny25/45/85
@@ -722,6 +740,8 @@ class TimerTinyX5_OCR {
 
         //! Reset internal states on device reset
         void Reset();
+        //! Save or restore internal states
+        void Snapshot(SnapshotArchive &ar);
 
         //! Run one clock cycle from dead time prescaler
         void DTClockCycle();
@@ -763,6 +783,9 @@ class HWTimerTinyX5_SyncReg {
         //! read register value on input area
         unsigned char GetBusValue(void) { return inValue; }
 
+        //! Save or restore register values
+        void Snapshot(SnapshotArchive &ar);
+
         //! check after one clock, if register value has changed
         bool ClockAndChanged(void) { if(inValue != regValue) { regValue = inValue; return true; } return false; }
 
@@ -933,8 +956,12 @@ class HWTimerTinyX5: public Hardware,
 
         //! Performs the async clocking, if necessary
         int Step(bool &untilCoreStepFinished, SystemClockOffset *nextStepIn_ns);
+        //! Returns the device of this timer, the async clock is stepped with it
+        AvrDevice *GetDevice(void) { return core; }
         //! Perform a reset of this unit
         void Reset();
+        //! Save or restore counter, prescaler, register values and pll state
+        void Snapshot(SnapshotArchive &ar);
         //! Process timer/counter unit operations by CPU cycle
         unsigned int CpuCycle();
 };
@@ -25,6 +25,7 @@
 
 #include "prescalermux.h"
 #include "avrerror.h"
+#include "snapshot.h"
 
 PrescalerMultiplexer::PrescalerMultiplexer(HWPrescaler *ps):
     prescaler(ps) {}
@@ -62,12 +63,24 @@ bool PrescalerMultiplexer::isClock(unsigned int cs) {
     }
 }
 
+unsigned int PrescalerMultiplexer::cyclesToClock(unsigned int cs) {
+    static const unsigned int divider[8] = { 0, 0, 8, 32, 64, 128, 256, 1024 };
+    
+    if(cs < 2 || cs > 7)
+        return 1;
+    return prescaler->CyclesToMultipleOf(divider[cs]);
+}
+
 PrescalerMultiplexerExt::PrescalerMultiplexerExt(HWPrescaler *ps, PinAtPort pi):
     PrescalerMultiplexer(ps),
     clkpin(pi) {
     clkpin_old = (bool)(clkpin == 1);
 }
 
+void PrescalerMultiplexerExt::Snapshot(SnapshotArchive &ar) {
+    ar.Item(clkpin_old);
+}
+
 bool PrescalerMultiplexerExt::isClock(unsigned int cs) {
     bool current = (bool)(clkpin == 1);
   
@@ -105,6 +118,15 @@ bool PrescalerMultiplexerExt::isClock(unsigned int cs) {
     }
 }
 
+unsigned int PrescalerMultiplexerExt::cyclesToClock(unsigned int cs) {
+    static const unsigned int divider[6] = { 0, 0, 8, 64, 256, 1024 };
+    
+    // pin edges can't be predicted, so only prescaler clocks
+    if(cs < 2 || cs > 5)
+        return 1;
+    return prescaler->CyclesToMultipleOf(divider[cs]);
+}
+
 PrescalerMultiplexerT15::PrescalerMultiplexerT15(HWPrescaler *ps):
     PrescalerMultiplexer(ps) {}
 
@@ -44,6 +44,12 @@ class PrescalerMultiplexer {
         //! @param cs multiplexer select value
         //! @return true, if a clock event occured
         virtual bool isClock(unsigned int cs);
+        //! Returns the count of cycles till next clock event
+        //! @param cs multiplexer select value
+        //! @return cycles till next clock event, 1, if it can't be predicted
+        virtual unsigned int cyclesToClock(unsigned int cs);
+        //! Save or restore the state of multiplexer, the default has no state
+        virtual void Snapshot(SnapshotArchive &) {}
     
 };
 
@@ -61,6 +67,8 @@ class PrescalerMultiplexerExt: public PrescalerMultiplexer {
         //! Creates a multiplexer instance with a count input pin, connected with prescaler
         PrescalerMultiplexerExt(HWPrescaler *ps, PinAtPort pi);
         virtual bool isClock(unsigned int cs);
+        virtual unsigned int cyclesToClock(unsigned int cs);
+        virtual void Snapshot(SnapshotArchive &ar);
     
 };
 
@@ -72,6 +80,7 @@ class PrescalerMultiplexerT15: public PrescalerMultiplexer {
         //! Creates a multiplexer instance for timer 1 on ATTiny15, connected with prescaler
         PrescalerMultiplexerT15(HWPrescaler *ps);
         virtual bool isClock(unsigned int cs);
+        virtual unsigned int cyclesToClock(unsigned int) { return 1; }
     
 };
 
@@ -25,15 +25,20 @@
 
 #include "timerprescaler.h"
 #include "traceval.h"
+#include "snapshot.h"
 
 HWPrescaler::HWPrescaler(AvrDevice *core, const std::string &tracename):
     Hardware(core),
     _resetBit(-1),
     _resetSyncBit(-1),
+    core(core),
     countEnable(true)
 {
     core->AddToCycleList(this);
-    trace_direct(&(core->coreTraceGroup), "PRESCALER" + tracename, &preScaleValue);
+    preScaleTrace = trace_direct(&(core->coreTraceGroup), "PRESCALER" + tracename, &preScaleValue);
+    preScaleValue = 0;
+    preScaleStart = core->GetCycleCounter();
+    cycleCount = true;
     resetRegister = NULL;
 }
 
@@ -44,10 +49,14 @@ HWPrescaler::HWPrescaler(AvrDevice *core,
     Hardware(core),
     _resetBit(resetBit),
     _resetSyncBit(-1),
+    core(core),
     countEnable(true)
 {
     core->AddToCycleList(this);
-    trace_direct(&(core->coreTraceGroup), "PRESCALER" + tracename, &preScaleValue);
+    preScaleTrace = trace_direct(&(core->coreTraceGroup), "PRESCALER" + tracename, &preScaleValue);
+    preScaleValue = 0;
+    preScaleStart = core->GetCycleCounter();
+    cycleCount = true;
     resetRegister = ioreg;
     ioreg->connectSRegClient(this);
 }
@@ -60,14 +69,53 @@ HWPrescaler::HWPrescaler(AvrDevice *core,
     Hardware(core),
     _resetBit(resetBit),
     _resetSyncBit(resetSyncBit),
+    core(core),
     countEnable(true)
 {
     core->AddToCycleList(this);
-    trace_direct(&(core->coreTraceGroup), "PRESCALER" + tracename, &preScaleValue);
+    preScaleTrace = trace_direct(&(core->coreTraceGroup), "PRESCALER" + tracename, &preScaleValue);
+    preScaleValue = 0;
+    preScaleStart = core->GetCycleCounter();
+    cycleCount = true;
     resetRegister = ioreg;
     ioreg->connectSRegClient(this);
 }
 
+unsigned int HWPrescaler::CpuCycle() {
+    if(cycleCount)
+        preScaleValue = GetValue();
+    if(!preScaleTrace->enabled())
+        core->SuspendHardware(this);
+    return 0;
+}
+
+void HWPrescaler::Reset() {
+    preScaleValue = 0;
+    preScaleStart = core->GetCycleCounter();
+    // timers depend on prescaler clock
+    core->WakeUpAllHardware();
+}
+
+void HWPrescaler::Snapshot(SnapshotArchive &ar) {
+    ar.Item(preScaleValue);
+    ar.Item(preScaleStart);
+    ar.Item(cycleCount);
+    ar.Item(countEnable);
+}
+
+void HWPrescaler::UpdateCycleCount(void) {
+    bool c = CountsCoreCycles();
+    if(c == cycleCount)
+        return;
+    // continue counting with current value
+    if(c)
+        preScaleStart = core->GetCycleCounter() - preScaleValue;
+    else
+        preScaleValue = GetValue();
+    cycleCount = c;
+    core->WakeUpAllHardware();
+}
+
 unsigned char HWPrescaler::set_from_reg(const IOSpecialReg *reg, unsigned char nv) {
     // check, if this is the right register
     if(reg != resetRegister) return nv;
@@ -84,8 +132,10 @@ unsigned char HWPrescaler::set_from_reg(const IOSpecialReg *reg, unsigned char n
             countEnable = false; // sync asserted, stop counting
         else {
             countEnable = true;  // let the counter run
+            UpdateCycleCount();
             return ~(1 << _resetBit) & nv; // reset the reset bit immediately, if no sync asserted
         }
+        UpdateCycleCount();
     }
     return nv;  // return value unchanged
 }
@@ -126,12 +176,12 @@ HWPrescalerAsync::HWPrescalerAsync(AvrDevice *core,
 }
 
 unsigned int HWPrescalerAsync::CpuCycle() {
+    if(!clockselect)
+      return HWPrescaler::CpuCycle();
     bool e = true;
-    if(clockselect) {
-      bool ps = tosc_pin.GetPin();
-      if(pinstate || !ps) e = false; // count on positive edge!
-      pinstate = ps;
-    }
+    bool ps = tosc_pin.GetPin();
+    if(pinstate || !ps) e = false; // count on positive edge!
+    pinstate = ps;
     if(e && countEnable) {
       preScaleValue++;
       if(preScaleValue > 1023) preScaleValue = 0;
@@ -139,6 +189,12 @@ unsigned int HWPrescalerAsync::CpuCycle() {
     return 0;
 }
 
+void HWPrescalerAsync::Snapshot(SnapshotArchive &ar) {
+    HWPrescaler::Snapshot(ar);
+    ar.Item(pinstate);
+    ar.Item(clockselect);
+}
+
 unsigned char HWPrescalerAsync::set_from_reg(const IOSpecialReg *reg, unsigned char nv) {
     unsigned char v = HWPrescaler::set_from_reg(reg, nv);
     if(reg != asyncRegister) return v;
@@ -149,6 +205,8 @@ unsigned char HWPrescalerAsync::set_from_reg(const IOSpecialReg *reg, unsigned c
         clockselect = false;
         //tosc_pin.SetAlternatePort(false);
     }
+    UpdateCycleCount();
+    core->WakeUpHardware(this);
     return v;
 }
 
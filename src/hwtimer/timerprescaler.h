@@ -41,13 +41,21 @@ class HWPrescaler: public Hardware, public IOSpecialRegClient {
         int _resetSyncBit; //!< holds sync bit position for prescaler reset synchronisation
         
     protected:
+        AvrDevice *core; //!< pointer to device core
         IOSpecialReg* resetRegister; //!< instance of IO register with reset bits
-        unsigned short preScaleValue; //!< prescaler counter value
+        unsigned short preScaleValue; //!< prescaler counter value, only updated if traced, see cycleCount
+        unsigned long long preScaleStart; //!< core cycle, where counter was 0, see cycleCount
+        bool cycleCount;   //!< counter value is calculated from core cycle counter
+        TraceValue *preScaleTrace; //!< trace value for preScaleValue
         bool countEnable;  //!< enables counting of prescaler (for reset sync)
         //! IO register interface set method, see IOSpecialRegClient
         unsigned char set_from_reg(const IOSpecialReg *reg, unsigned char nv);
         //! IO register interface get method, see IOSpecialRegClient
         unsigned char get_from_client(const IOSpecialReg *reg, unsigned char v) { return v; }
+        //! Returns true, if prescaler counts every core cycle
+        virtual bool CountsCoreCycles(void) { return countEnable; }
+        //! Switch between counting by core cycle counter and counting in CpuCycle
+        void UpdateCycleCount(void);
         
     public:
         //! Creates HWPrescaler instance without reset feature
@@ -64,17 +72,28 @@ class HWPrescaler: public Hardware, public IOSpecialRegClient {
                     int resetBit,
                     int resetSyncBit);
         //! Count functionality for prescaler
-        virtual unsigned int CpuCycle() {
-            if(countEnable) {
-              preScaleValue++;
-              if(preScaleValue > 1023) preScaleValue = 0;
-            }
-            return 0;
-        }
+        /*! The counter value is calculated from the core cycle counter, if
+          prescaler counts every core cycle. So this is only necessary for
+          tracing the counter value, otherwise prescaler suspends itself. */
+        virtual unsigned int CpuCycle();
         //! Get method for current prescaler counter value
-        unsigned short GetValue() { return preScaleValue; }
+        unsigned short GetValue() {
+            if(cycleCount)
+                return (unsigned short)((core->GetCycleCounter() - preScaleStart) & 0x3ff);
+            return preScaleValue;
+        }
+        //! Returns the count of cycles till counter value is a multiple of divider
+        /*! divider must be a power of 2 and less or equal 1024. Returns 1, if
+          it can't be predicted, because counting depends not on core cycles. */
+        unsigned int CyclesToMultipleOf(unsigned int divider) {
+            if(!cycleCount)
+                return 1;
+            return divider - (GetValue() & (divider - 1));
+        }
         //! Reset method, sets prescaler counter to 0
-        void Reset(){ preScaleValue = 0; }
+        void Reset();
+        //! Save or restore prescaler counter and state
+        void Snapshot(SnapshotArchive &ar);
 };
 
 //! Extends HWPrescaler with a external clock oszillator pin
@@ -102,10 +121,14 @@ class HWPrescalerAsync: public HWPrescaler {
                          int resetSyncBit);
         //! Count functionality for prescaler
         virtual unsigned int CpuCycle();
+        //! Save or restore prescaler counter and state
+        void Snapshot(SnapshotArchive &ar);
         
     protected:
         //! IO register interface set method, see IOSpecialRegClient
         unsigned char set_from_reg(const IOSpecialReg *reg, unsigned char nv);
+        //! Returns true, if prescaler counts every core cycle
+        virtual bool CountsCoreCycles(void) { return countEnable && !clockselect; }
         
     private:
         IOSpecialReg* asyncRegister; //!< instance of IO register with assr bits
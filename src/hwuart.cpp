@@ -25,6 +25,7 @@
 
 #include "hwuart.h"
 #include "helper.h"
+#include "snapshot.h"
 
 //usr & ucsra
 #define RXC 0x80
@@ -90,11 +91,15 @@ void HWUart::SetUsr(unsigned char val) {
 } 
 
 void HWUart::SetUbrr(unsigned char val) {
+    CatchUpCycles();
     ubrr = (ubrr & 0xff00) | val;
+    core->WakeUpHardware(this);
 }
 
 void HWUart::SetUbrrhi(unsigned char val) {
+    CatchUpCycles();
     ubrr = (ubrr & 0xff) | ((val & 0xf) << 8);
+    core->WakeUpHardware(this);
 }
 
 void HWUart::SetFrameLengthFromRegister() {
@@ -124,6 +129,9 @@ void HWUart::SetFrameLengthFromRegister() {
 }
 
 void HWUart::SetUcr(unsigned char val) { 
+    CatchUpCycles();
+    core->WakeUpHardware(this);
+
     unsigned char ucrold=ucr;
     ucr=val;
     SetFrameLengthFromRegister();
@@ -168,6 +176,11 @@ void HWUart::SetUcr(unsigned char val) {
 }
 
 unsigned int HWUart::CpuCycle() {
+    unsigned long long cycle = core->GetCycleCounter();
+    if(cycle - lastCycle > 1)
+        SkipCycles(cycle - lastCycle - 1);
+    lastCycle = cycle;
+
     baudCnt++; // TODO: this isn't implemented right, baud clock prescaler is a down counter!
     if(baudCnt >= (ubrr + 1)) {
         baudCnt = 0;
@@ -178,10 +191,29 @@ unsigned int HWUart::CpuCycle() {
     // controling read sequence down counter
     if(regSeq > 0)
         regSeq--;
+    else if(ucr & (RXEN | TXEN))
+        core->SleepHardware(this, ubrr + 1 - baudCnt); // till next baud rate clock
+    else
+        core->SuspendHardware(this); // nothing to do till enabled
       
     return 0;
 }
 
+void HWUart::SkipCycles(unsigned long long cycles) {
+    unsigned long long total = baudCnt + cycles;
+    unsigned long long clocks = total / (ubrr + 1);
+    baudCnt = total % (ubrr + 1);
+    baudCnt16 = (baudCnt16 + clocks) % 16;
+}
+
+void HWUart::CatchUpCycles(void) {
+    unsigned long long cycle = core->GetCycleCounter();
+    if(cycle > lastCycle) {
+        SkipCycles(cycle - lastCycle);
+        lastCycle = cycle;
+    }
+}
+
 unsigned int HWUart::CpuCycleRx() {
     // receiver part
     //
@@ -532,6 +564,7 @@ HWUart::HWUart(AvrDevice *core,
                int instance_id):
     Hardware(core),
     TraceValueRegister(core, "UART" + int2str(instance_id)),
+    core(core),
     irqSystem(s),
     pinTx(tx),
     pinRx(rx),
@@ -612,6 +645,8 @@ void HWUart::Reset() {
     ubrr = 0;
     baudCnt = 0;
     baudCnt16 = 0;
+    lastCycle = core->GetCycleCounter();
+    core->WakeUpHardware(this);
     
     regSeq = 0;
     
@@ -620,6 +655,30 @@ void HWUart::Reset() {
 
     SetFrameLengthFromRegister(); 
 }
+void HWUart::Snapshot(SnapshotArchive &ar) {
+    ar.Item(udrWrite);
+    ar.Item(udrRead);
+    ar.Item(usr);
+    ar.Item(ucr);
+    ar.Item(ucsrc);
+    ar.Item(ubrr);
+    ar.Item(readParity);
+    ar.Item(writeParity);
+    ar.Item(frameLength);
+    ar.Item(regSeq);
+    ar.Item(baudCnt);
+    ar.Item(lastCycle);
+    ar.Item(rxState);
+    ar.Item(txState);
+    ar.Item(cntRxSamples);
+    ar.Item(rxLowCnt);
+    ar.Item(rxHighCnt);
+    ar.Item(rxDataTmp);
+    ar.Item(rxBitCnt);
+    ar.Item(baudCnt16);
+    ar.Item(txDataTmp);
+    ar.Item(txBitCnt);
+}
 
 // implementation of HWUsart
 
@@ -641,6 +700,7 @@ unsigned char HWUsart::GetUcsrc() { return ucsrc; }
 unsigned char HWUsart::GetUcsrcUbrrh() {
     if(regSeq == 0) {
         regSeq = 2;
+        core->WakeUpHardware(this); // count down regSeq
         return GetUbrrhi();
     } else {
         regSeq = 0;
@@ -38,6 +38,7 @@
 class HWUart: public Hardware, public TraceValueRegister {
     
     protected:
+        AvrDevice *core;        //!< pointer to device core
         unsigned char udrWrite; //!< Write stage of UDR register value
         unsigned char udrRead;  //!< Read stage of UDR register value
         unsigned char usr;      //!< USR register value, also used as UCSRA register value
@@ -62,6 +63,7 @@ class HWUart: public Hardware, public TraceValueRegister {
         unsigned char regSeq;    //!< Cycle timer for controling read access to UCSRC/UBRRH combined register
         
         int baudCnt;
+        unsigned long long lastCycle; //!< last core cycle, which is processed by CpuCycle
 
         enum T_RxState {
             RX_DISABLED,
@@ -91,6 +93,13 @@ class HWUart: public Hardware, public TraceValueRegister {
 
         unsigned int CpuCycleRx();
         unsigned int CpuCycleTx();
+        //! Advance baud rate counters for cycles, in which CpuCycle was skipped
+        /*! Receiver or transmitter are only processed on a baud rate clock, so
+          this is only possible, if there was no baud rate clock in skipped
+          cycles or both are disabled. */
+        void SkipCycles(unsigned long long cycles);
+        //! Process all cycles skipped till now, before registers are changed
+        void CatchUpCycles(void);
 
         int cntRxSamples;
         int rxLowCnt;
@@ -115,6 +124,7 @@ class HWUart: public Hardware, public TraceValueRegister {
         virtual unsigned int CpuCycle();
 
         void Reset();
+        void Snapshot(SnapshotArchive &ar);
 
         void SetUdr(unsigned char val);  
         void SetUsr(unsigned char val);  
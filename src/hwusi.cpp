@@ -28,6 +28,7 @@
 #include "avrerror.h"
 #include "hwtimer.h"
 #include "systemclock.h"
+#include "snapshot.h"
 
 void HWUSI::SetUSIDR(unsigned char val) {
     shift_data = val;
@@ -252,6 +253,28 @@ void HWUSI::Reset() {
     controlTWI(false);
 }
 
+void HWUSI::Snapshot(SnapshotArchive &ar) {
+    ar.Item(shift_data);
+    ar.Item(control_data);
+    ar.Item(sck_state);
+    ar.Item(sck_port);
+    ar.Item(sck_ddr);
+    ar.Item(di_state);
+    ar.Item(di_port);
+    ar.Item(di_ddr);
+    ar.Item(scl_hold);
+    ar.Item(irqen_start);
+    ar.Item(irqactive_start);
+    ar.Item(irqen_ovr);
+    ar.Item(irqactive_ovr);
+    ar.Item(flag_stop);
+    ar.Item(flag_dcol);
+    ar.Item(wire_mode);
+    ar.Item(clock_mode);
+    ar.Item(counter_data);
+    ar.Item(is_DI_change);
+}
+
 int HWUSI::Step(bool &untilCoreStepFinished, SystemClockOffset *nextStepIn_ns) {
     /* change SDA or SCK output, if necessary. This can't be made in PiStateHasChanged,
        no pin change inside this method or you'll get a infinite loop ... */
@@ -380,6 +403,11 @@ void HWUSI_BR::Reset() {
     HWUSI::Reset();
 }
 
+void HWUSI_BR::Snapshot(SnapshotArchive &ar) {
+    HWUSI::Snapshot(ar);
+    ar.Item(buffer_data);
+}
+
 void HWUSI_BR::setDataBuffer(unsigned char data) {
     buffer_data = data;
 }
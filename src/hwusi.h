@@ -151,12 +151,14 @@ class HWUSI: public Hardware, public SimulationMember, public TraceValueRegister
 
         /* Interface from Hardware */
         virtual void Reset();
+        virtual void Snapshot(SnapshotArchive &ar);
 
         /* Interface from TimerEventListener */
         virtual void fireEvent(int event);
 
         /* Interface from SimulationMember: for reacting to port pin changes */
         int Step(bool &untilCoreStepFinished, SystemClockOffset *nextStepIn_ns = 0);
+        AvrDevice *GetDevice(void) { return core; }
 
         /* Set and get functions for IO registers */
         void SetUSIDR(unsigned char val);
@@ -194,6 +196,7 @@ class HWUSI_BR: public HWUSI {
 
         /* Interface from Hardware */
         virtual void Reset();
+        virtual void Snapshot(SnapshotArchive &ar);
 
         /* Set and get functions for IO registers */
         void SetUSIBR(unsigned char val); // produce warning: read only
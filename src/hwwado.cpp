@@ -26,6 +26,7 @@
 #include "hwwado.h"
 #include "avrdevice.h"
 #include "systemclock.h"
+#include "snapshot.h"
 
 #define WDTOE 0x10
 #define WDE 0x08
@@ -47,6 +48,7 @@ void HWWado::SetWdtcr(unsigned char val) {
 		cntWde=4;
 	}
 
+	core->WakeUpHardware(this);
 } 
 
 unsigned int HWWado::CpuCycle() {
@@ -57,10 +59,19 @@ unsigned int HWWado::CpuCycle() {
 
 	if (cntWde==0) wdtcr&=(0xff-WDTOE); //clear WDTOE after 4 cpu cycles
 
-	if ((( wdtcr& WDE )!= 0 ) && (timeOutAt < SystemClock::Instance().GetCurrentTime() )) {
+	SystemClockOffset currentTime= SystemClock::Instance().GetCurrentTime();
+	if ((( wdtcr& WDE )!= 0 ) && (timeOutAt < currentTime )) {
 		core->Reset();
+		return 0;
 	}
 
+	// nothing to do till timeout
+	if (cntWde == 0) {
+		if (( wdtcr& WDE )!= 0 )
+			core->SleepHardware(this, (timeOutAt - currentTime) / core->GetClockFreq() + 1);
+		else
+			core->SuspendHardware(this);
+	}
 
 	return 0;
 }
@@ -80,6 +91,11 @@ void HWWado::Reset() {
 	wdtcr=0;
 }
 
+void HWWado::Snapshot(SnapshotArchive &ar) {
+	ar.Item(wdtcr);
+	ar.Item(cntWde);
+	ar.Item(timeOutAt);
+}
 
 void HWWado::Wdr() {
 	SystemClockOffset currentTime= SystemClock::Instance().GetCurrentTime(); 
@@ -117,4 +133,5 @@ void HWWado::Wdr() {
 			break;
 
 	}
+	core->WakeUpHardware(this);
 }
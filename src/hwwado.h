@@ -50,6 +50,7 @@ class HWWado: public Hardware, public TraceValueRegister {
 		unsigned char GetWdtcr() { return wdtcr; }
 		void Wdr(); //reset the wado counter
 		void Reset();
+		void Snapshot(SnapshotArchive &ar);
 
         IOReg<HWWado> wdtcr_reg;
 };
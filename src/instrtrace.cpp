@@ -0,0 +1,239 @@
+/*
+ ****************************************************************************
+ *
+ * simulavr - A simulator for the Atmel AVR family of microcontrollers.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ ****************************************************************************
+ *
+ *  $Id$
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <iomanip>
+
+#include "config.h"
+#if !(defined(_MSC_VER) || defined(HAVE_SYS_MINGW))
+#   include <sys/types.h>
+#   include <sys/mman.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#   define USE_MMAP
+#endif
+
+#include "instrtrace.h"
+#include "avrdevice.h"
+#include "avrerror.h"
+#include "avrmalloc.h"
+#include "hwstack.h"
+#include "hwsreg.h"
+#include "flash.h"
+
+//! interval (in records) for SYNC events
+static const unsigned long long syncInterval = 65536;
+
+InstructionTrace::InstructionTrace(const std::string &_filename, unsigned long long _capacity):
+    filename(_filename),
+    capacity(_capacity),
+    position(0),
+    lastSync(0),
+    lastEvent(NULL),
+    lastDelta(NULL)
+{
+    if(capacity < 1024)
+        capacity = 1024;
+    size_t size = sizeof(InstructionTraceHeader) + capacity * sizeof(InstructionTraceRecord);
+    void *mem = NULL;
+#ifdef USE_MMAP
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if(fd < 0)
+        avr_error("can't open instruction trace file '%s'", filename.c_str());
+    if(ftruncate(fd, size) != 0) {
+        close(fd);
+        avr_error("can't resize instruction trace file '%s'", filename.c_str());
+    }
+    mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mem == MAP_FAILED)
+        avr_error("can't map instruction trace file '%s'", filename.c_str());
+#else
+    // without mmap the ring is hold in memory and written on destruction
+    FILE *f = fopen(filename.c_str(), "wb");
+    if(f == NULL)
+        avr_error("can't open instruction trace file '%s'", filename.c_str());
+    fclose(f);
+    mem = avr_new0(char, size);
+#endif
+    header = (InstructionTraceHeader *)mem;
+    ring = (InstructionTraceRecord *)(header + 1);
+    memcpy(header->magic, "SAVRITR1", 8);
+    header->byteOrder = 0x01020304;
+    header->recordSize = sizeof(InstructionTraceRecord);
+    header->capacity = capacity;
+    header->written = 0;
+    memset(regs, 0, sizeof(regs));
+    sreg = 0;
+    sp = 0;
+}
+
+InstructionTrace::~InstructionTrace() {
+    size_t size = sizeof(InstructionTraceHeader) + capacity * sizeof(InstructionTraceRecord);
+#ifdef USE_MMAP
+    munmap(header, size);
+#else
+    FILE *f = fopen(filename.c_str(), "wb");
+    if(f != NULL) {
+        fwrite(header, 1, size, f);
+        fclose(f);
+    }
+    avr_free(header);
+#endif
+}
+
+void InstructionTrace::Start(AvrDevice *core) {
+    strncpy(header->device, core->GetDeviceName().c_str(), sizeof(header->device) - 1);
+    strncpy(header->program, core->GetFname().c_str(), sizeof(header->program) - 1);
+    header->clockPeriod = core->GetClockFreq();
+    Sync(core, core->GetCycleCounter(), core->PC);
+}
+
+InstructionTraceRecord *InstructionTrace::NextRecord(void) {
+    InstructionTraceRecord *r = &ring[position];
+    if(++position == capacity)
+        position = 0;
+    header->written++;
+    return r;
+}
+
+void InstructionTrace::Delta(unsigned int addr, unsigned char val) {
+    if(lastDelta == NULL || lastDelta->delta.count == 4) {
+        lastDelta = NextRecord();
+        lastDelta->delta.kind = DELTA;
+        lastDelta->delta.count = 0;
+        lastDelta->delta.unused = 0;
+    }
+    int i = lastDelta->delta.count++;
+    lastDelta->delta.addr[i] = addr;
+    lastDelta->delta.value[i] = val;
+}
+
+void InstructionTrace::Sync(AvrDevice *core, unsigned long long cycle, unsigned int pc) {
+    InstructionTraceRecord *r = NextRecord();
+    r->event.cycle = cycle;
+    r->event.pc = pc;
+    r->event.opcode = 0;
+    r->event.kind = SYNC;
+    r->event.waitstates = 0;
+    lastEvent = NULL;
+    lastDelta = NULL;
+    lastSync = header->written;
+    for(int i = 0; i < 32; i++) {
+        regs[i] = core->GetCoreReg(i);
+        Delta(i, regs[i]);
+    }
+    sreg = (int)*core->status;
+    Delta(SREG, sreg);
+    sp = core->stack->GetStackPointer();
+    Delta(SP_LOW, sp & 0xff);
+    Delta(SP_HIGH, (sp >> 8) & 0xff);
+}
+
+void InstructionTrace::Event(Kind kind, unsigned long long cycle, unsigned int pc, unsigned int opcode) {
+    // a sleep phase is recorded once, it lasts till next event
+    if(kind == SLEEP && lastEvent != NULL && lastEvent->event.kind == SLEEP && lastDelta == NULL)
+        return;
+    lastEvent = NextRecord();
+    lastEvent->event.cycle = cycle;
+    lastEvent->event.pc = pc;
+    lastEvent->event.opcode = opcode;
+    lastEvent->event.kind = kind;
+    lastEvent->event.waitstates = 0;
+    lastDelta = NULL;
+}
+
+void InstructionTrace::Finish(AvrDevice *core, int waitstates) {
+    if(lastEvent != NULL)
+        lastEvent->event.waitstates = (waitstates > 0) ? waitstates : 0;
+    for(int i = 0; i < 32; i++) {
+        unsigned char v = core->GetCoreReg(i);
+        if(v != regs[i]) {
+            regs[i] = v;
+            Delta(i, v);
+        }
+    }
+    unsigned char s = (int)*core->status;
+    if(s != sreg) {
+        sreg = s;
+        Delta(SREG, s);
+    }
+    unsigned long p = core->stack->GetStackPointer();
+    if(p != sp) {
+        if((p ^ sp) & 0xff)
+            Delta(SP_LOW, p & 0xff);
+        if((p ^ sp) & 0xff00)
+            Delta(SP_HIGH, (p >> 8) & 0xff);
+        sp = p;
+    }
+    if(header->written - lastSync >= syncInterval)
+        Sync(core, core->GetCycleCounter(), core->PC);
+}
+
+FlightRecorder::FlightRecorder(AvrDevice *_core):
+    core(_core),
+    console(&SystemConsoleHandler::Current()),
+    count(0)
+{
+    current = &ring[0];
+    console->AddFatalReport(this);
+}
+
+FlightRecorder::~FlightRecorder() {
+    console->RemoveFatalReport(this);
+}
+
+void FlightRecorder::Write(std::ostream &os) {
+    unsigned long long n = (count < (unsigned long long)SIZE) ? count : (unsigned long long)SIZE;
+    os << std::dec << "Last " << n << " instructions (oldest first):" << std::endl;
+    for(unsigned long long i = count - n + 1; i <= count; i++) {
+        const Record &r = ring[i & (SIZE - 1)];
+        int sregValue = r.sreg;
+        std::string sym(core->Flash->GetSymbolAtAddress(r.pc));
+        os << std::dec << std::setw(12) << std::setfill(' ') << r.cycle << ": 0x"
+           << std::hex << std::setw(4) << std::setfill('0') << (r.pc << 1) << ' '
+           << std::left << std::setw(30) << std::setfill(' ') << sym << std::right;
+        if(r.irq)
+            os << " IRQ " << std::dec << r.opcode << "  ";
+        else
+            os << " " << std::setw(4) << std::setfill('0') << r.opcode << "    ";
+        os << " SP=0x" << std::setw(4) << std::setfill('0') << r.sp << " SREG=[";
+        for(int b = 7; b >= 0; b--)
+            os << ((sregValue & (1 << b)) ? "CZNVSHTI"[b] : '-');
+        os << "]";
+        if(r.memAddr != NO_WRITE)
+            os << " [0x" << std::setw(4) << std::setfill('0') << r.memAddr << "]=0x"
+               << std::setw(2) << (int)r.memVal;
+        os << std::dec << std::setfill(' ') << std::endl;
+    }
+}
+
+void FlightRecorder::WriteFatalReport(std::ostream &os) {
+    if(count == 0)
+        return;
+    os << "Flight recorder of " << core->GetDeviceName() << " (" << core->GetFname() << "), ";
+    Write(os);
+    os << std::endl;
+}
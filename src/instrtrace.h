@@ -0,0 +1,216 @@
+/*
+ ****************************************************************************
+ *
+ * simulavr - A simulator for the Atmel AVR family of microcontrollers.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ ****************************************************************************
+ *
+ *  $Id$
+ */
+
+#ifndef INSTRTRACE
+#define INSTRTRACE
+
+#include <string>
+#include <iostream>
+#include <stdint.h>
+
+#include "avrerror.h"
+#include "hwsreg.h"
+
+class AvrDevice;
+
+//! Header of a binary instruction trace file
+/*! The header has a size of 512 bytes and is followed by a ring of
+  capacity records, see InstructionTraceRecord. All numbers are stored in
+  byte order of the writing host, byteOrder is used to detect this. */
+struct InstructionTraceHeader {
+    char magic[8];         //!< "SAVRITR1"
+    uint32_t byteOrder;    //!< 0x01020304, written as number
+    uint32_t recordSize;   //!< size of a record, 16
+    uint64_t capacity;     //!< count of records in ring
+    uint64_t written;      //!< count of records written, next record goes to position written % capacity
+    uint64_t clockPeriod;  //!< cpu clock period in ns
+    char device[64];       //!< device name, 0 terminated
+    char program[408];     //!< name of loaded program (elf file), 0 terminated
+};
+
+//! A record in the ring of a binary instruction trace
+/*! An event record (kind isn't DELTA) describes a core step. It is followed
+  by delta records, which hold the changes on registers and memory caused by
+  this step. Addresses in deltas are data memory addresses, SREG and stack
+  pointer are stored on the pseudo addresses SREG, SP_LOW and SP_HIGH. kind is
+  on the same position in both record types. */
+union InstructionTraceRecord {
+    struct {
+        uint64_t cycle;      //!< cpu cycle counter of step
+        uint32_t pc;         //!< PC (word address) of step
+        uint16_t opcode;     //!< first word of instruction, vector address on IRQ
+        uint8_t kind;        //!< event kind, see InstructionTrace::Kind
+        uint8_t waitstates;  //!< count of wait cycles following this step
+    } event;
+    struct {
+        uint16_t addr[4];    //!< addresses of changed cells
+        uint8_t value[4];    //!< new values
+        uint16_t unused;
+        uint8_t kind;        //!< always InstructionTrace::DELTA
+        uint8_t count;       //!< count of valid entries in addr and value
+    } delta;
+};
+
+//! Records executed instructions in a binary, ring buffered trace file
+/*! This is the fast replacement for the text trace (option -t): per core step
+  only a 16 byte record is written to a ring, which is mapped into memory, if
+  the platform supports it. So only the last capacity records are kept, the
+  file content is valid at any time, also if simulation aborts. Register,
+  SREG and stack pointer changes are found by comparing with a shadow copy
+  after each instruction, data memory writes are reported by AvrDevice.
+
+  A SYNC event with the complete register file, SREG and stack pointer is
+  written at start and periodically, so a decoder can start after a ring
+  overflow at a known state. The program itrace2txt renders a trace in the
+  text format of option -t. */
+class InstructionTrace {
+
+    public:
+        //! Kind of record
+        enum Kind {
+            INSTRUCTION = 1, //!< instruction executed
+            IRQ,             //!< interrupt entered, opcode holds vector address
+            SLEEP,           //!< core sleeps from this cycle on till next record
+            WAKEUP,          //!< core wakes up by interrupt
+            HOLD,            //!< cpu is hold by hardware
+            SYNC,            //!< full register state follows
+            DELTA            //!< register and memory changes of previous event
+        };
+        //! Pseudo addresses for SREG and stack pointer in delta records
+        enum {
+            SREG = 0xfffd,
+            SP_LOW = 0xfffe,
+            SP_HIGH = 0xffff
+        };
+
+        /*! Create trace file, capacity is the count of records in ring. Existing
+          file will be overwritten. */
+        InstructionTrace(const std::string &filename, unsigned long long capacity);
+        ~InstructionTrace();
+
+        //! Set device name, program and clock in header and record state of core
+        void Start(AvrDevice *core);
+        //! Record a core step
+        void Event(Kind kind, unsigned long long cycle, unsigned int pc, unsigned int opcode);
+        //! Record changes on registers, SREG and stack pointer after a event and wait cycles
+        void Finish(AvrDevice *core, int waitstates);
+        //! Record a data memory write
+        void MemoryWrite(unsigned int addr, unsigned char val) {
+            if(addr >= 32)
+                Delta(addr, val);
+        }
+
+    private:
+        std::string filename;
+        InstructionTraceHeader *header; //!< mapped header
+        InstructionTraceRecord *ring;   //!< mapped records
+        unsigned long long capacity;    //!< count of records in ring
+        unsigned long long position;    //!< ring position of next record
+        unsigned long long lastSync;    //!< value of header->written on last SYNC
+        InstructionTraceRecord *lastEvent; //!< last event record, NULL after SYNC
+        InstructionTraceRecord *lastDelta; //!< delta record, which isn't full
+        unsigned char regs[32];         //!< shadow of register file
+        unsigned char sreg;             //!< shadow of SREG
+        unsigned long sp;               //!< shadow of stack pointer
+
+        InstructionTraceRecord *NextRecord(void);
+        void Delta(unsigned int addr, unsigned char val);
+        void Sync(AvrDevice *core, unsigned long long cycle, unsigned int pc);
+
+        // no copies!
+        InstructionTrace(const InstructionTrace &);
+        InstructionTrace &operator=(const InstructionTrace &);
+};
+
+//! Always active record of the last instructions of a core, for post-mortem analysis
+/*! Holds cycle, PC, opcode, stack pointer, SREG and the last data memory write
+  of the last SIZE instructions (and interrupt entries) in a fixed ring, no
+  memory is allocated while recording. The ring is written as text to warning
+  stream, if simulation stops on a fatal error or abort, and to the core dump
+  (option -C). */
+class FlightRecorder: public FatalReport {
+
+    public:
+        enum {
+            SIZE = 256,       //!< count of records in ring, must be a power of 2
+            NO_WRITE = 0xffff //!< memAddr for a instruction without memory write
+        };
+
+        FlightRecorder(AvrDevice *core);
+        ~FlightRecorder();
+
+        //! Record a instruction, called before instruction is executed
+        void Instruction(unsigned long long cycle, unsigned int pc, unsigned int opcode,
+                         unsigned int sp, unsigned char sreg) {
+            current = &ring[++count & (SIZE - 1)];
+            current->cycle = cycle;
+            current->pc = pc;
+            current->opcode = opcode;
+            current->sp = sp;
+            current->sreg = sreg;
+            current->irq = false;
+            current->memAddr = NO_WRITE;
+        }
+        //! Record a interrupt entry, vector is the address of interrupt vector
+        void Irq(unsigned long long cycle, unsigned int pc, unsigned int vector,
+                 unsigned int sp, unsigned char sreg) {
+            Instruction(cycle, pc, vector, sp, sreg);
+            current->irq = true;
+        }
+        //! Record a data memory write of current instruction
+        void MemoryWrite(unsigned int addr, unsigned char val) {
+            current->memAddr = addr;
+            current->memVal = val;
+        }
+
+        //! Write recorded instructions as text, oldest first
+        void Write(std::ostream &os);
+
+        // from FatalReport
+        void WriteFatalReport(std::ostream &os);
+
+    private:
+        struct Record {
+            uint64_t cycle;   //!< cpu cycle counter
+            uint32_t pc;      //!< PC (word address)
+            uint16_t opcode;  //!< first word of instruction, vector address on irq
+            uint16_t sp;      //!< stack pointer before instruction
+            uint16_t memAddr; //!< address of last memory write or NO_WRITE
+            uint8_t memVal;   //!< value of last memory write
+            uint8_t sreg;     //!< SREG before instruction
+            bool irq;         //!< record is a interrupt entry
+        };
+
+        AvrDevice *core;
+        SystemConsoleHandler *console; //!< handler, where this report is registered
+        Record ring[SIZE];
+        Record *current;      //!< record of last instruction
+        unsigned long long count; //!< count of records written
+
+        // no copies!
+        FlightRecorder(const FlightRecorder &);
+        FlightRecorder &operator=(const FlightRecorder &);
+};
+
+#endif
@@ -29,6 +29,7 @@
 #include "systemclock.h"
 #include "helper.h"
 #include "avrerror.h"
+#include "snapshot.h"
 
 #include "application.h"
 
@@ -188,6 +189,9 @@ HWIrqSystem::HWIrqSystem(AvrDevice* _core, int bytes, int tblsize):
     bytesPerVector(bytes),
     vectorTableSize(tblsize),
     irqTrace(tblsize),
+    pendingMask((tblsize + 31) / 32, 0),
+    irqPartner(tblsize, (Hardware*)NULL),
+    pendingCount(0),
     core(_core),
     irqStatistic(_core),
     debugInterruptTable(tblsize, (Hardware*)NULL)
@@ -200,60 +204,74 @@ HWIrqSystem::HWIrqSystem(AvrDevice* _core, int bytes, int tblsize):
     }
 }
 
-bool HWIrqSystem::IsIrqPending()
-{
-    return ( irqPartnerList.size() != 0); // if any interrupt is in the list, return true
+//! index of lowest bit set in w, w must not be 0
+static inline unsigned int lowestBit(uint32_t w) {
+#ifdef __GNUC__
+    return __builtin_ctz(w);
+#else
+    unsigned int n = 0;
+    while(!(w & 1)) {
+        w >>= 1;
+        n++;
+    }
+    return n;
+#endif
 }
 
 unsigned int HWIrqSystem::GetNewPc(unsigned int &actualVector) {
-    unsigned int newPC = 0xffffffff;
-
-    static map<unsigned int, Hardware *>::iterator ii;
-    static map<unsigned int, Hardware *>::iterator end;
-    end = irqPartnerList.end();
-
-    //a map is always sorted, so the priority of the irq vector is known and handled correctly
-    for(ii = irqPartnerList.begin(); ii != end; ii++) {
-        Hardware* second = ii->second;
-        unsigned int index = ii->first;
-        assert(index < vectorTableSize);
-
-        if(second->IsLevelInterrupt(index)) {
-            second->ClearIrqFlag(index);
-            if(second->LevelInterruptPending(index)) {
-                actualVector = index;
-                newPC = index * (bytesPerVector / 2);
-                break;
-            }
-        } else {
-            second->ClearIrqFlag(index);
+    // the lowest vector number has the highest priority
+    for(unsigned int word = 0; word < pendingMask.size(); word++) {
+        uint32_t pending = pendingMask[word];
+        while(pending) {
+            unsigned int index = word * 32 + lowestBit(pending);
+            pending &= pending - 1;
+            assert(index < vectorTableSize);
+            Hardware* second = irqPartner[index];
+
+            if(second->IsLevelInterrupt(index)) {
+                second->ClearIrqFlag(index);
+                if(!second->LevelInterruptPending(index))
+                    continue;
+            } else
+                second->ClearIrqFlag(index);
             actualVector = index;
-            newPC = index * (bytesPerVector / 2);
-            break;
+            return index * (bytesPerVector / 2);
         }
     }
 
-    return newPC;
+    return 0xffffffff;
 }
 
 void HWIrqSystem::SetIrqFlag(Hardware *hwp, unsigned int vector) {
     assert(vector < vectorTableSize);
-    irqPartnerList[vector]=hwp;
+    uint32_t bit = 1UL << (vector & 31);
+    if(!(pendingMask[vector >> 5] & bit)) {
+        pendingMask[vector >> 5] |= bit;
+        pendingCount++;
+    }
+    irqPartner[vector] = hwp;
     if (core->trace_on) {
-        traceOut << core->GetFname() << " interrupt on index " << vector << " is pending" << endl;
+        core->TraceOut() << core->GetFname() << " interrupt on index " << vector << " is pending" << endl;
     }
 
-    if ( irqStatistic.entries[vector].actual.flagSet==0) { //the actual entry was not used before... fine!
+    if(enableIRQStatistic && irqStatistic.entries[vector].actual.flagSet==0) { //the actual entry was not used before... fine!
         irqStatistic.entries[vector].actual.flagSet=SystemClock::Instance().GetCurrentTime();
     } 
 }
 
 void HWIrqSystem::ClearIrqFlag(unsigned int vector) {
-    irqPartnerList.erase(vector);
+    assert(vector < vectorTableSize);
+    uint32_t bit = 1UL << (vector & 31);
+    if(pendingMask[vector >> 5] & bit) {
+        pendingMask[vector >> 5] &= ~bit;
+        pendingCount--;
+    }
     if (core->trace_on) {
-        traceOut << core->GetFname() << " interrupt on index " << vector << "cleared" << endl;
+        core->TraceOut() << core->GetFname() << " interrupt on index " << vector << "cleared" << endl;
     }
 
+    if(!enableIRQStatistic)
+        return;
     if (irqStatistic.entries[vector].actual.flagCleared==0) {
         irqStatistic.entries[vector].actual.flagCleared=SystemClock::Instance().GetCurrentTime();
     }
@@ -264,9 +282,11 @@ void HWIrqSystem::ClearIrqFlag(unsigned int vector) {
 void HWIrqSystem::IrqHandlerStarted(unsigned int vector) {
     irqTrace[vector]->change(1);
     if (core->trace_on) {
-        traceOut << core->GetFname() << " IrqSystem: IrqHandlerStarted Vec: " << vector << endl;
+        core->TraceOut() << core->GetFname() << " IrqSystem: IrqHandlerStarted Vec: " << vector << endl;
     }
 
+    if(!enableIRQStatistic)
+        return;
     if (irqStatistic.entries[vector].actual.handlerStarted==0) {
         irqStatistic.entries[vector].actual.handlerStarted=SystemClock::Instance().GetCurrentTime();
     }
@@ -276,15 +296,28 @@ void HWIrqSystem::IrqHandlerStarted(unsigned int vector) {
 void HWIrqSystem::IrqHandlerFinished(unsigned int vector) {
     irqTrace[vector]->change(0);
     if (core->trace_on) {
-        traceOut << core->GetFname() << " IrqSystem: IrqHandler Finished Vec: " << vector << endl;
+        core->TraceOut() << core->GetFname() << " IrqSystem: IrqHandler Finished Vec: " << vector << endl;
     }
 
+    if(!enableIRQStatistic)
+        return;
     if (irqStatistic.entries[vector].actual.handlerFinished==0) {
         irqStatistic.entries[vector].actual.handlerFinished=SystemClock::Instance().GetCurrentTime();
     }
     irqStatistic.entries[vector].CheckComplete();
 }
 
+void HWIrqSystem::Snapshot(SnapshotArchive &ar) {
+    ar.Check(vectorTableSize, "count of interrupt vectors");
+    ar.Array(&pendingMask[0], pendingMask.size());
+    ar.Item(pendingCount);
+    for(unsigned int i = 0; i < vectorTableSize; i++) {
+        int idx = core->GetHardwareIndex(irqPartner[i]);
+        ar.Item(idx);
+        irqPartner[i] = core->GetHardware(idx);
+    }
+}
+
 void HWIrqSystem::DebugVerifyInterruptVector(unsigned int vector, const Hardware* source) {
     assert(vector < vectorTableSize);
     const Hardware* existing = debugInterruptTable[vector];
@@ -123,8 +123,11 @@ class HWIrqSystem: public TraceValueRegister {
         HWSreg *status;
         std::vector<TraceValue*> irqTrace;
         
-        /// priority queue of pending interrupts (i.e. waiting to be processed)
-        std::map<unsigned int, Hardware *> irqPartnerList;
+        /// bitmap of pending interrupts (i.e. waiting to be processed), bit n of word n / 32 is vector n
+        std::vector<uint32_t> pendingMask;
+        /// hardware, which has raised a interrupt, per vector
+        std::vector<Hardware *> irqPartner;
+        unsigned int pendingCount; ///< count of bits set in pendingMask
         AvrDevice *core;
         IrqStatistic irqStatistic;
         std::vector<const Hardware*> debugInterruptTable;
@@ -132,8 +135,8 @@ class HWIrqSystem: public TraceValueRegister {
     public:
         HWIrqSystem (AvrDevice* _core, int bytes_per_vector, int number_of_vectors);
 
-        bool IsIrqPending();
-        /// returns a new PC pointer if interrupt occurred, -1 otherwise.
+        bool IsIrqPending() { return pendingCount != 0; }
+        /// returns a new PC pointer if interrupt occurred, -1 otherwise. Lowest pending vector has highest priority.
         unsigned int GetNewPc(unsigned int &vector_index);
         void SetIrqFlag(Hardware *, unsigned int vector_index);
         void ClearIrqFlag(unsigned int vector_index);
@@ -142,27 +145,9 @@ class HWIrqSystem: public TraceValueRegister {
         /// In datasheets RESET vector is index 1 but we use 0! And not a byte address.
         void DebugVerifyInterruptVector(unsigned int vector_index, const Hardware* source);
         void DebugDumpTable();
+        //! Save or restore pending interrupts, see SnapshotArchive
+        void Snapshot(SnapshotArchive &ar);
 };
 
-#ifndef SWIG
-
-class IrqFunktor: public Funktor {
-    
-    protected:
-        HWIrqSystem *irqSystem;
-        void (HWIrqSystem::*fp)(unsigned int);
-        unsigned int vectorNo;
-
-    public:
-        IrqFunktor(HWIrqSystem *i, void (HWIrqSystem::*_fp)(unsigned int), unsigned int _vector):
-            irqSystem(i),
-            fp(_fp),
-            vectorNo(_vector) {}
-        void operator()() { (irqSystem->*fp)(vectorNo); }
-        Funktor* clone() { return new IrqFunktor(*this); }
-};
-
-#endif // ifndef SWIG
-
 #endif
 
@@ -24,8 +24,8 @@
  */
 
 #include <string.h> //strcpy()
-#include <sstream>
 #include <iostream>
+#include <algorithm>
 
 #include "memory.h"
 #include "avrerror.h"
@@ -51,13 +51,11 @@ unsigned int Memory::GetAddressAtSymbol(const string &s) {
     }
 
     // isn't a number, try to find symbol ...
-    multimap<unsigned int, string>::iterator ii;
-
-    for(ii = sym.begin(); ii != sym.end(); ii++) {
-        if(ii->second == s) {
-            return ii->first;
-        }
-    }
+    if(!symIndexValid)
+        BuildSymbolIndex();
+    map<string, unsigned int>::const_iterator ii = symByName.find(s);
+    if(ii != symByName.end())
+        return ii->second;
 
     avr_error("symbol '%s' not found!", s.c_str());
 
@@ -65,48 +63,49 @@ unsigned int Memory::GetAddressAtSymbol(const string &s) {
 }
 
 string Memory::GetSymbolAtAddress(unsigned int add){
-    string lastName;
-    unsigned int lastAddr = 0;
-    multimap<unsigned int, string>::iterator ii;
-    multimap<unsigned int, string>::iterator last_ii;
-
-    ii = sym.begin();
-    last_ii = ii;
-    if(ii == sym.end())
-        return ""; // we have no symbols at all
+    if(!symIndexValid)
+        BuildSymbolIndex();
+
+    // find last symbol address, which isn't behind add
+    vector<unsigned int>::const_iterator ii = upper_bound(symAddr.begin(), symAddr.end(), add);
+    if(ii == symAddr.begin())
+        return ""; // no symbols at all or address before first symbol
+    size_t idx = (ii - symAddr.begin()) - 1;
+
+    unsigned int offset = add - symAddr[idx];
+    if(offset == 0)
+        return symNames[idx];
+
+    static const char hexDigits[] = "0123456789abcdef";
+    char buf[sizeof(unsigned int) * 2 + 1];
+    char *p = buf + sizeof(buf);
+    *(--p) = 0;
     do {
-        if(lastAddr != ii->first) {
-            last_ii = ii;
-            lastName = ii->second;
-        }
-        lastAddr = ii->first;
-
-        if(ii->first == add)
-            break; // found symbol
-        ii++;
-        if((ii != sym.end()) && (ii->first > add))
-            break; // behind the right symbol
-    } while(ii != sym.end());
-    
-    ostringstream os;
-
-    os << lastName;
-    ii = last_ii;
-    while((++ii) != sym.end()) { 
-        if(lastAddr != ii->first)
-            break;
-        os << "," << ii->second;
-    };
+        *(--p) = hexDigits[offset & 0xf];
+        offset >>= 4;
+    } while(offset != 0);
+    return symNames[idx] + "+0x" + p;
+}
 
-    unsigned int offset = add - lastAddr;
-    if((offset) != 0) {
-        os << "+0x" << hex << offset;
+void Memory::BuildSymbolIndex(void) {
+    symAddr.clear();
+    symNames.clear();
+    symByName.clear();
+    // sym is sorted by address, symbols with same address in order of AddSymbol
+    multimap<unsigned int, string>::const_iterator ii;
+    for(ii = sym.begin(); ii != sym.end(); ii++) {
+        if(symAddr.empty() || symAddr.back() != ii->first) {
+            symAddr.push_back(ii->first);
+            symNames.push_back(ii->second);
+        } else
+            symNames.back() += "," + ii->second;
+        // first found is lowest address for this symbol
+        symByName.insert(make_pair(ii->second, ii->first));
     }
-
-    return os.str();
+    symIndexValid = true;
 }
 
-Memory::Memory(int _size): size(_size) {
+Memory::Memory(int _size): size(_size), symIndexValid(false) {
     myMemory = avr_new(unsigned char, size);
 }
 
@@ -28,6 +28,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include "decoder.h"
 #include "avrmalloc.h"
@@ -39,6 +40,12 @@ class Memory {
     protected:
       
         unsigned int size; /*!< allocated size (in bytes) of myMemory */
+
+        /*! symbol index, built from sym by BuildSymbolIndex */
+        bool symIndexValid; /*!< symAddr, symNames and symByName are up to date with sym */
+        std::vector<unsigned int> symAddr; /*!< sorted addresses, which have symbols */
+        std::vector<std::string> symNames; /*!< symbols for address in symAddr, concatenated by ',' */
+        std::map<std::string, unsigned int> symByName; /*!< symbol to (lowest) address map */
         
     public:
 
@@ -60,7 +67,7 @@ class Memory {
           Seeks for symbols, which are registered for the given address. If the
           address isn't equal to a symbol address, but before the next one, then
           a offset to symbol address will be added. Returns a empty string, if
-          nothing is found. (in case of no given symbols!)
+          nothing is found. (no symbols at all or address before first symbol)
           @param add the given address
           @return a string with all found symbols, concatenated by ',' */
         std::string GetSymbolAtAddress(unsigned int add);
@@ -79,7 +86,13 @@ class Memory {
         /*! Add the (address, symbol) pair
         
           @param p a std::pair with address and symbol string */
-        void AddSymbol(std::pair<unsigned int, std::string> p) { sym.insert(p); }
+        void AddSymbol(std::pair<unsigned int, std::string> p) { sym.insert(p); symIndexValid = false; }
+
+        /*! Build symbol index for fast symbol lookup
+
+          Called after loading symbols, otherwise on next lookup after sym is
+          changed by AddSymbol. */
+        void BuildSymbolIndex(void);
         
         /*! Returns the size in bytes of memory block */
         unsigned int GetSize() { return size; }
@@ -25,6 +25,15 @@
 
 #include "net.h"
 #include "pin.h"
+#include "parallelsim.h"
+
+Net::Net() {
+    for(int i = 0; i <= Pin::ANALOG_SHORTED; i++)
+        drivers[i] = 0;
+    SetResult(Pin(Pin::TRISTATE));
+    propagationDelay = 0;
+    shared = false;
+}
 
 void Net::Add(Pin *p) {
     push_back(p);
@@ -37,6 +46,7 @@ void Net::Delete(Pin *p) {
     for(ii = begin(); ii != end(); ii++) {
         if((Pin*)(*ii) == p) {
             erase(ii);
+            drivers[p->netState]--;
             break;
         }
     }
@@ -47,15 +57,96 @@ Net::~Net() {
         (*begin())->UnRegisterNet(this);
 }
 
+void Net::Count(Pin *p) {
+    Pin s(p->GetPin()); //get state of pin (TRISTATE, HIGH, LOW ....)
+    p->netState = s.outState;
+    p->netValue = s.analogVal;
+    drivers[s.outState]++;
+}
+
+Pin Net::Resolve(void) {
+    unsigned int analog = drivers[Pin::ANALOG];
+    unsigned int others = size() - drivers[Pin::TRISTATE] - analog;
+
+    if(drivers[Pin::ANALOG_SHORTED] || analog > 1 || (analog && others))
+        return Pin(Pin::ANALOG_SHORTED);
+    if(analog) {
+        // exactly one analog source, all other pins are tristate
+        Pin a(Pin::TRISTATE);
+        for(iterator ii = begin(); ii != end(); ii++) {
+            if((*ii)->netState == Pin::ANALOG) {
+                a.outState = Pin::ANALOG;
+                a.analogVal = (*ii)->netValue;
+                break;
+            }
+        }
+        return a;
+    }
+    if(drivers[Pin::SHORTED] || (drivers[Pin::HIGH] && drivers[Pin::LOW]))
+        return Pin(Pin::SHORTED);
+    if(drivers[Pin::HIGH])
+        return Pin(Pin::HIGH);
+    if(drivers[Pin::LOW])
+        return Pin(Pin::LOW);
+    if(drivers[Pin::PULLUP] && drivers[Pin::PULLDOWN])
+        return Pin(Pin::TRISTATE); // any other idea?
+    if(drivers[Pin::PULLUP])
+        return Pin(Pin::PULLUP);
+    if(drivers[Pin::PULLDOWN])
+        return Pin(Pin::PULLDOWN);
+    return Pin(Pin::TRISTATE);
+}
+
+void Net::SetResult(const Pin &r) {
+    // don't use Pin::operator=, it would copy the HWPort and Net references too
+    result.outState = r.outState;
+    result.analogVal = r.analogVal;
+}
+
 bool Net::CalcNet() {
-    Pin result(Pin::TRISTATE);
     iterator ii;
+    for(int i = 0; i <= Pin::ANALOG_SHORTED; i++)
+        drivers[i] = 0;
     for(ii = begin(); ii != end(); ii++)
-        result += ((*ii)->GetPin()); //get state of pin (TRISTATE, HIGH, LOW ....)
+        Count(*ii);
+    SetResult(Resolve());
 
     //new result is now found, so set all pins in the Net to new state
     for(ii = begin(); ii != end(); ii++)
-        (*ii)->SetInState( result); //In-State that means the state of register PIN not the complete pin here
+        (*ii)->SetInState(result); //In-State that means the state of register PIN not the complete pin here
+
+    return (bool)result;
+}
+
+bool Net::PinChanged(Pin *p) {
+    Pin s(p->GetPin());
+    // on a net between threads of a parallel simulation the change is
+    // transfered at end of time quantum
+    if(shared && ParallelSimulation::Defer(this, p, s.outState, s.analogVal))
+        return (bool)result;
+    return SetPinState(p, s.outState, s.analogVal);
+}
+
+bool Net::SetPinState(Pin *p, Pin::T_Pinstate state, const AnalogValue &value) {
+    if(state == p->netState &&
+       (state != Pin::ANALOG ||
+        (value.getD() == p->netValue.getD() && value.getRaw() == p->netValue.getRaw())))
+        return (bool)result; // output stage of pin isn't changed, nothing to do
+
+    drivers[p->netState]--;
+    p->netState = state;
+    p->netValue = value;
+    drivers[state]++;
+
+    Pin r(Resolve());
+    if(r.outState != result.outState ||
+       r.analogVal.getD() != result.analogVal.getD() ||
+       r.analogVal.getRaw() != result.analogVal.getRaw()) {
+        SetResult(r);
+        for(iterator ii = begin(); ii != end(); ii++)
+            (*ii)->SetInState(result);
+    } else
+        p->SetInState(result); // input of other pins is unchanged
 
     return (bool)result;
 }
@@ -28,24 +28,50 @@
 
 #include <vector>
 
+#include "systemclocktypes.h"
 #include "pin.h"
 
 //! Connect Pins to each other and transfers a output change from a pin to input values for all pins
+/*! The net counts, how many pins drive each output state. So a output change
+  of one pin (see Pin::CalcPin) updates only this counters and the resolved
+  state is found from counters without visiting all pins. Pins get a new input
+  value only, if the resolved state has changed, the changed pin itself is
+  always updated. The resolved state doesn't depend on the order of pins. */
 class Net
 #ifndef SWIG
     : public std::vector <Pin *>
 #endif
 {
     public:
-        //Net() {} //!< Common Constructor, initially it'a a "empty net" and useless!
+        Net(); //!< Common Constructor, initially it'a a "empty net" and useless!
         virtual ~Net(); //!< Destructor, disconnects save all pins, which are connected
         void Add(Pin *p); //!< Add a pin to net, e.g. connect a pin to others
         virtual void Delete(Pin *p); //!< Remove a pin from net
          //! Calculate a "electrical potential" on the net and set all pin inputs with this value
         virtual bool CalcNet();
-        
+        //! Update the net after a output change of pin p, only changes are transfered to pins
+        bool PinChanged(Pin *p);
+        //! Set the minimum propagation delay in ns between pins of different devices on this net
+        /*! Only used by parallel simulation, see SystemClock::SetParallel. 0
+          (default) means, that no delay is known. */
+        void SetPropagationDelay(SystemClockOffset d) { propagationDelay = d; }
+        //! Returns the propagation delay, see SetPropagationDelay
+        SystemClockOffset GetPropagationDelay(void) const { return propagationDelay; }
+
     private:
+        unsigned int drivers[Pin::ANALOG_SHORTED + 1]; //!< count of pins per output state
+        Pin result; //!< resolved state of net
+        SystemClockOffset propagationDelay; //!< see SetPropagationDelay
+        bool shared; //!< connects pins of different threads in a running parallel simulation
+
+        Pin Resolve(void); //!< calculate net state from drivers
+        void SetResult(const Pin &r); //!< take over output state and value of r as net state
+        void Count(Pin *p); //!< count output state of pin p and store it on pin
+        //! Update the net for a new output state of pin p
+        bool SetPinState(Pin *p, Pin::T_Pinstate state, const AnalogValue &value);
+
         friend void Pin::RegisterNet(Net*);
+        friend class ParallelSimulation;
 };
 
 #endif
@@ -0,0 +1,490 @@
+/*
+ ****************************************************************************
+ *
+ * simulavr - A simulator for the Atmel AVR family of microcontrollers.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ ****************************************************************************
+ *
+ *  $Id$
+ */
+
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+#include "config.h"
+#if defined(HAVE_PTHREAD) && defined(__GNUC__)
+#   include <pthread.h>
+#   define USE_THREADS
+#endif
+
+#include "parallelsim.h"
+#include "avrdevice.h"
+#include "net.h"
+#include "traceval.h"
+#include "avrerror.h"
+
+//! quantum, if devices aren't connected, only to check stop conditions
+static const SystemClockOffset unconnectedQuantum = 1000000;
+
+SIM_THREAD_LOCAL ParallelSimulation::Partition *ParallelSimulation::current = NULL;
+
+#ifdef USE_THREADS
+//! Lock for output of all partitions to the console streams
+static pthread_mutex_t outputMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+//! Stream buffer, which collects output and writes it on flush to a other stream
+class ForwardBuffer: public std::stringbuf {
+
+    public:
+        ForwardBuffer(std::ostream *t): target(t) {}
+        ~ForwardBuffer() { sync(); }
+
+    protected:
+        int sync(void);
+
+    private:
+        std::ostream *target;
+};
+
+int ForwardBuffer::sync(void) {
+    if(str().empty())
+        return 0;
+#ifdef USE_THREADS
+    pthread_mutex_lock(&outputMutex);
+#endif
+    *target << str();
+    target->flush();
+#ifdef USE_THREADS
+    pthread_mutex_unlock(&outputMutex);
+#endif
+    str(std::string());
+    return 0;
+}
+
+struct ParallelSimulation::Console {
+    ForwardBuffer msgBuf;
+    ForwardBuffer wrnBuf;
+    std::ostream msg;
+    std::ostream wrn;
+
+    Console(std::ostream *m, std::ostream *w): msgBuf(m), wrnBuf(w), msg(&msgBuf), wrn(&wrnBuf) {}
+
+    //! Redirect output of a console handler to this streams and raise exceptions instead of exit
+    void Attach(SystemConsoleHandler &h) {
+        h.SetUseExit(false);
+        h.SetMessageStream(&msg);
+        h.SetWarningStream(&wrn);
+    }
+};
+
+//! Start and end of a quantum
+/*! The calling thread increments generation to start a quantum and waits,
+  till running is 0 again. Threads, which are waiting for the next quantum or
+  for the other threads, sleep on a condition variable. */
+struct ParallelSimulation::Barrier {
+#ifdef USE_THREADS
+    pthread_mutex_t mutex;
+    pthread_cond_t start;   //!< signaled, if generation is incremented
+    pthread_cond_t done;    //!< signaled, if running gets 0
+#endif
+    unsigned int generation; //!< incremented to start a quantum
+    unsigned int running;   //!< count of worker threads, which haven't finished the quantum
+    bool quit;              //!< worker threads have to stop
+
+    Barrier(): generation(0), running(0), quit(false) {
+#ifdef USE_THREADS
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&start, NULL);
+        pthread_cond_init(&done, NULL);
+#endif
+    }
+    ~Barrier() {
+#ifdef USE_THREADS
+        pthread_cond_destroy(&done);
+        pthread_cond_destroy(&start);
+        pthread_mutex_destroy(&mutex);
+#endif
+    }
+
+#ifdef USE_THREADS
+    //! Start next quantum for count worker threads or stop them
+    void Start(unsigned int count, bool stop) {
+        pthread_mutex_lock(&mutex);
+        running = count;
+        quit = stop;
+        generation++;
+        pthread_cond_broadcast(&start);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    //! Wait till all worker threads have finished the quantum
+    void WaitDone(void) {
+        pthread_mutex_lock(&mutex);
+        while(running != 0)
+            pthread_cond_wait(&done, &mutex);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    //! Wait for next quantum after seen, returns false, if thread has to stop
+    bool WaitStart(unsigned int &seen) {
+        pthread_mutex_lock(&mutex);
+        while(generation == seen)
+            pthread_cond_wait(&start, &mutex);
+        seen = generation;
+        bool run = !quit;
+        pthread_mutex_unlock(&mutex);
+        return run;
+    }
+
+    //! Worker thread has finished the quantum
+    void Finished(void) {
+        pthread_mutex_lock(&mutex);
+        if(--running == 0)
+            pthread_cond_signal(&done);
+        pthread_mutex_unlock(&mutex);
+    }
+#endif
+};
+
+ParallelSimulation::ParallelSimulation(SystemClock *_clock, unsigned int _threads, SystemClockOffset _quantum):
+    clock(_clock),
+    threads(_threads),
+    quantum(_quantum),
+    useExit(true),
+    msgStream(NULL),
+    wrnStream(NULL),
+    horizon(0),
+    stopOnResult(true),
+    workers(1),
+    barrier(new Barrier)
+{
+#ifndef USE_THREADS
+    avr_warning("simulavr is built without thread support, parallel simulation runs on one thread");
+#endif
+    main.clock = clock;
+}
+
+ParallelSimulation::~ParallelSimulation() {
+    delete barrier;
+}
+
+long ParallelSimulation::Run(SystemClockOffset limit, bool _stopOnResult) {
+    SystemClockOffset q = Split();
+    if(q == 0)
+        return -1;
+
+    stopOnResult = _stopOnResult;
+    workers = (partitions.size() < threads) ? partitions.size() : threads;
+
+#ifdef USE_THREADS
+    std::vector<Worker> ws(workers);
+    std::vector<pthread_t> ids;
+    for(unsigned int i = 1; i < workers; i++) {
+        pthread_t id;
+        ws[i].sim = this;
+        ws[i].index = i;
+        ws[i].generation = barrier->generation;
+        if(pthread_create(&id, NULL, WorkerMain, &ws[i]) != 0) {
+            avr_warning("can't create thread for parallel simulation");
+            break;
+        }
+        ids.push_back(id);
+    }
+    // partitions of missing threads are stepped by the calling thread
+    workers = ids.size() + 1;
+#else
+    workers = 1;
+#endif
+
+    SystemClockOffset now = clock->currentTime;
+    bool stop = false;
+    while(!stop && !clock->IsBreak() && (limit < 0 || now < limit)) {
+        horizon = now + q;
+        if(limit >= 0 && horizon > limit)
+            horizon = limit;
+
+#ifdef USE_THREADS
+        barrier->Start(workers - 1, false);
+#endif
+        RunPartition(&main);
+        RunSlot(0);
+#ifdef USE_THREADS
+        barrier->WaitDone();
+#endif
+
+        now = horizon;
+        clock->currentTime = now;
+        ApplyChanges();
+        Redistribute();
+
+        if(main.failure || (stopOnResult && main.result))
+            stop = true;
+        for(size_t i = 0; i < partitions.size(); i++) {
+            Partition *p = partitions[i];
+            if(p->failure || (stopOnResult && p->result))
+                stop = true;
+            if(p->clock->breakMessage)
+                clock->breakMessage = true; // stopped by exit point
+        }
+    }
+
+#ifdef USE_THREADS
+    barrier->Start(0, true);
+    for(size_t i = 0; i < ids.size(); i++)
+        pthread_join(ids[i], NULL);
+#endif
+
+    long steps = main.steps;
+    Partition *failed = main.failure ? &main : NULL;
+    for(size_t i = 0; i < partitions.size(); i++) {
+        steps += partitions[i]->steps;
+        if(failed == NULL && partitions[i]->failure)
+            failed = partitions[i];
+    }
+    // raise a error of a partition again on calling thread
+    int failure = 0, errorCode = 0;
+    std::string errorMessage;
+    if(failed != NULL) {
+        failure = failed->failure;
+        errorCode = failed->errorCode;
+        errorMessage = failed->errorMessage;
+    }
+    Merge();
+
+    SystemConsoleHandler &con = clock->context->GetConsoleHandler();
+    if(failure == 1)
+        con.FatalMessage(errorMessage.c_str());
+    if(failure == 2) {
+        if(errorCode < 0)
+            con.AbortApplication(-errorCode);
+        con.ExitApplication(errorCode);
+    }
+    return steps;
+}
+
+SystemClockOffset ParallelSimulation::Split(void) {
+    entries.clear();
+    clock->syncMembers->GetEntries(entries);
+
+    // find devices
+    std::vector<AvrDevice *> devices;
+    std::map<AvrDevice *, int> index;
+    for(size_t i = 0; i < entries.size(); i++) {
+        AvrDevice *d = entries[i].second->GetDevice();
+        if(d != NULL && index.find(d) == index.end()) {
+            index[d] = devices.size();
+            devices.push_back(d);
+        }
+    }
+    if(devices.size() < 2)
+        return 0;
+
+    // find nets between pins of different partitions, pins, which don't
+    // belong to a device, are part of main partition
+    std::map<Pin *, int> owner;
+    for(size_t i = 0; i < devices.size(); i++) {
+        AvrDevice *d = devices[i];
+        if(d->trace_on)
+            avr_error("tracing isn't possible in parallel simulation");
+        if(d->dumpManager != NULL && !d->dumpManager->dumps.empty())
+            avr_error("dumps aren't possible in parallel simulation");
+        for(std::map<std::string, Pin *>::iterator j = d->allPins.begin(); j != d->allPins.end(); j++)
+            owner[j->second] = i;
+    }
+    SystemClockOffset q = quantum;
+    std::set<Net *> visited;
+    for(std::map<Pin *, int>::iterator i = owner.begin(); i != owner.end(); i++) {
+        Net *n = i->first->GetNet();
+        if(n == NULL || visited.find(n) != visited.end())
+            continue;
+        visited.insert(n);
+        bool mixed = false;
+        for(Net::iterator j = n->begin(); j != n->end(); j++) {
+            std::map<Pin *, int>::iterator o = owner.find(*j);
+            if(o == owner.end() || o->second != i->second)
+                mixed = true;
+        }
+        if(mixed) {
+            sharedNets.push_back(n);
+            SystemClockOffset d = n->GetPropagationDelay();
+            if(d > 0 && (q <= 0 || d < q))
+                q = d;
+        }
+    }
+    if(q <= 0) {
+        if(!sharedNets.empty()) {
+            sharedNets.clear();
+            avr_error("parallel simulation needs a time quantum or propagation delays on nets between devices");
+        }
+        q = unconnectedQuantum;
+    }
+
+    // redirect console output, no exit from a thread
+    SystemConsoleHandler &con = clock->context->GetConsoleHandler();
+    useExit = con.GetUseExit();
+    msgStream = con.GetMessageStream();
+    wrnStream = con.GetWarningStream();
+    main.console = new Console(msgStream, wrnStream);
+    main.console->Attach(con);
+
+    // create partitions and move members
+    for(size_t i = 0; i < devices.size(); i++) {
+        Partition *p = new Partition;
+        p->device = devices[i];
+        p->context = new SimulationContext;
+        p->console = new Console(msgStream, wrnStream);
+        p->console->Attach(p->context->GetConsoleHandler());
+        p->deviceContext = p->device->context;
+        p->device->context = p->context;
+        p->clock = &p->context->GetSystemClock();
+        p->clock->currentTime = clock->currentTime;
+        p->clock->breakSignals = clock->breakSignals;
+        partitions.push_back(p);
+        byDevice[p->device] = p;
+    }
+    clock->syncMembers->Clear();
+    for(size_t i = 0; i < entries.size(); i++) {
+        AvrDevice *d = entries[i].second->GetDevice();
+        SystemClock *c = (d != NULL) ? byDevice[d]->clock : clock;
+        c->syncMembers->Insert(entries[i].first, entries[i].second);
+    }
+    for(size_t i = 0; i < sharedNets.size(); i++)
+        sharedNets[i]->shared = true;
+
+    return q;
+}
+
+void ParallelSimulation::Merge(void) {
+    for(size_t i = 0; i < partitions.size(); i++) {
+        Partition *p = partitions[i];
+        entries.clear();
+        p->clock->syncMembers->GetEntries(entries);
+        p->clock->syncMembers->Clear();
+        for(size_t j = 0; j < entries.size(); j++)
+            clock->syncMembers->Insert(entries[j].first, entries[j].second);
+        for(size_t j = 0; j < p->clock->asyncMembers.size(); j++) {
+            if(p->clock->asyncMembers[j] != NULL)
+                clock->AddAsyncMember(p->clock->asyncMembers[j]);
+        }
+        p->clock->asyncMembers.clear();
+        p->device->context = p->deviceContext;
+        delete p->context;
+        delete p->console;
+        delete p;
+    }
+    partitions.clear();
+    byDevice.clear();
+    for(size_t i = 0; i < sharedNets.size(); i++)
+        sharedNets[i]->shared = false;
+    sharedNets.clear();
+
+    SystemConsoleHandler &con = clock->context->GetConsoleHandler();
+    con.SetUseExit(useExit);
+    con.SetMessageStream(msgStream);
+    con.SetWarningStream(wrnStream);
+    delete main.console;
+    main = Partition();
+    main.clock = clock;
+}
+
+void ParallelSimulation::Redistribute(void) {
+    entries.clear();
+    clock->syncMembers->GetEntries(entries);
+    for(size_t i = 0; i < entries.size(); i++) {
+        AvrDevice *d = entries[i].second->GetDevice();
+        if(d == NULL)
+            continue;
+        std::map<AvrDevice *, Partition *>::iterator p = byDevice.find(d);
+        if(p != byDevice.end()) {
+            clock->syncMembers->Remove(entries[i].second);
+            p->second->clock->syncMembers->Insert(entries[i].first, entries[i].second);
+        }
+    }
+}
+
+void ParallelSimulation::ApplyChanges(void) {
+    pending.clear();
+    pending.insert(pending.end(), main.changes.begin(), main.changes.end());
+    main.changes.clear();
+    for(size_t i = 0; i < partitions.size(); i++) {
+        std::vector<PinChange> &c = partitions[i]->changes;
+        pending.insert(pending.end(), c.begin(), c.end());
+        c.clear();
+    }
+    if(pending.empty())
+        return;
+    std::stable_sort(pending.begin(), pending.end(), ChangeLess);
+    for(size_t i = 0; i < pending.size(); i++)
+        pending[i].net->SetPinState(pending[i].pin, pending[i].state, pending[i].value);
+}
+
+bool ParallelSimulation::Defer(Net *net, Pin *pin, Pin::T_Pinstate state, const AnalogValue &value) {
+    Partition *p = current;
+    if(p == NULL)
+        return false;
+    p->changes.push_back(PinChange());
+    PinChange &c = p->changes.back();
+    c.time = p->clock->GetCurrentTime();
+    c.net = net;
+    c.pin = pin;
+    c.state = state;
+    c.value = value;
+    return true;
+}
+
+void ParallelSimulation::RunPartition(Partition *p) {
+    if(p->failure)
+        return;
+    current = p;
+    SimulationContext::Scope scope((p->context != NULL) ? *p->context : *clock->context);
+    try {
+        int result;
+        p->steps += p->clock->RunUntil(horizon, stopOnResult, result);
+        if(result)
+            p->result = result;
+    } catch(const char *msg) {
+        p->failure = 1;
+        p->errorMessage = msg;
+    } catch(int code) {
+        p->failure = 2;
+        p->errorCode = code;
+    }
+    current = NULL;
+}
+
+void ParallelSimulation::RunSlot(unsigned int index) {
+    for(size_t i = index; i < partitions.size(); i += workers)
+        RunPartition(partitions[i]);
+}
+
+void *ParallelSimulation::WorkerMain(void *arg) {
+#ifdef USE_THREADS
+    Worker *w = (Worker *)arg;
+    ParallelSimulation *sim = w->sim;
+    Barrier *b = sim->barrier;
+    unsigned int seen = w->generation;
+    while(b->WaitStart(seen)) {
+        sim->RunSlot(w->index);
+        b->Finished();
+    }
+#endif
+    return NULL;
+}
+
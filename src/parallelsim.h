@@ -0,0 +1,170 @@
+/*
+ ****************************************************************************
+ *
+ * simulavr - A simulator for the Atmel AVR family of microcontrollers.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ ****************************************************************************
+ *
+ *  $Id$
+ */
+
+
+#ifndef PARALLELSIM
+#define PARALLELSIM
+
+#include <vector>
+#include <map>
+#include <string>
+#include <iostream>
+
+#include "systemclocktypes.h"
+#include "systemclock.h"
+#include "simulationcontext.h"
+#include "pin.h"
+
+class AvrDevice;
+class Net;
+class SystemConsoleHandler;
+
+//! Runs the simulation members of a SystemClock in parallel threads, see SystemClock::SetParallel
+/*! On start of a run the simulation members are split into partitions: one
+  for each device with the members, which belong to it (see
+  SimulationMember::GetDevice), and the main partition with all other members.
+  A device partition gets its own SimulationContext and so its own clock, the
+  main partition stays on the SystemClock. The partitions are distributed on
+  the threads, the calling thread steps the main partition and some device
+  partitions too.
+
+  All partitions run up to a common horizon (conservative synchronisation
+  with a fixed time quantum) and wait there for each other. Meanwhile output
+  changes on nets, which connect pins of different partitions, are queued by
+  the partition, which caused them. At the horizon, while all other threads
+  wait, the queued changes are applied in time order. So no locks are
+  necessary inside a quantum. After the run the members are moved back to
+  the SystemClock.
+
+  Each partition has its own console handler, messages and warnings are
+  collected per partition and written under a lock to the streams of the
+  console handler of the SystemClock. While the partitions run, all console
+  handlers raise exceptions instead of calling exit or abort. A error, which
+  has stopped a partition, is raised again on the calling thread after the
+  run. */
+class ParallelSimulation {
+
+    public:
+        ParallelSimulation(SystemClock *clock, unsigned int threads, SystemClockOffset quantum);
+        ~ParallelSimulation();
+
+        //! Run till limit (-1 means endless) or stop
+        /*! If stopOnResult is set, it stops also, if a Step call of a simulation
+          member returns nonzero, like SystemClock::Run. Returns the count of
+          steps or -1, if there aren't at least two devices. */
+        long Run(SystemClockOffset limit, bool stopOnResult);
+
+        //! Queue a output change on a net between partitions
+        /*! Returns false, if the calling thread doesn't run a partition just now,
+          then the change has to be done immediately. */
+        static bool Defer(Net *net, Pin *pin, Pin::T_Pinstate state, const AnalogValue &value);
+
+    private:
+        //! Output change on a net between partitions
+        struct PinChange {
+            SystemClockOffset time;
+            Net *net;
+            Pin *pin;
+            Pin::T_Pinstate state;
+            AnalogValue value;
+        };
+
+        //! Output streams for the console handler of a partition
+        struct Console;
+
+        //! Start and end of a quantum for worker threads
+        struct Barrier;
+
+        //! A group of simulation members, which is stepped on one thread
+        struct Partition {
+            AvrDevice *device;          //!< device of this partition, NULL for main partition
+            SimulationContext *context; //!< own context of a device partition
+            SimulationContext *deviceContext; //!< context of device before run
+            SystemClock *clock;         //!< clock of this partition
+            Console *console;           //!< streams for the console handler of this partition
+            std::vector<PinChange> changes; //!< queued changes on nets between partitions
+            long steps;                 //!< count of steps in this run
+            int result;                 //!< nonzero result of Step, which has stopped this partition
+            int failure;                //!< 0 or kind of exception, which has stopped this partition
+            std::string errorMessage;   //!< message of a fatal error
+            int errorCode;              //!< code of exit or abort
+
+            Partition(): device(NULL), context(NULL), deviceContext(NULL), clock(NULL), console(NULL),
+                         steps(0), result(0), failure(0), errorCode(0) {}
+        };
+
+        //! A thread, which steps some partitions
+        struct Worker {
+            ParallelSimulation *sim;
+            unsigned int index;
+            unsigned int generation;    //!< last quantum before thread start
+        };
+
+        SystemClock *clock;
+        unsigned int threads;       //!< maximum count of threads
+        SystemClockOffset quantum;  //!< time quantum given by user, 0 if not given
+        Partition main;             //!< main partition, members, which don't belong to a device
+        std::vector<Partition *> partitions; //!< device partitions
+        std::map<AvrDevice *, Partition *> byDevice;
+        std::vector<Net *> sharedNets; //!< nets between partitions
+        std::vector<PinChange> pending; //!< changes of all partitions to apply
+        std::vector<TimeTable::Entry> entries; //!< buffer for members of a time table
+
+        // console handler of the SystemClock before run
+        bool useExit;               //!< exit/abort mode of console handler
+        std::ostream *msgStream;    //!< message stream of console handler
+        std::ostream *wrnStream;    //!< warning stream of console handler
+
+        // state shared with worker threads
+        SystemClockOffset horizon;  //!< end time of current quantum
+        bool stopOnResult;
+        unsigned int workers;       //!< count of threads including calling thread
+        Barrier *barrier;           //!< synchronisation with worker threads
+
+        //! Partition, which is stepped by this thread just now, NULL if none
+        static SIM_THREAD_LOCAL Partition *current;
+
+        //! Split members into partitions and find nets between them, returns the quantum
+        SystemClockOffset Split(void);
+        //! Move all members back to main clock, restore devices
+        void Merge(void);
+        //! Move members, which are added to main clock while running, to their partition
+        void Redistribute(void);
+        //! Apply queued changes of all partitions
+        void ApplyChanges(void);
+        //! Step a partition till horizon
+        void RunPartition(Partition *p);
+        //! Step all partitions of a thread till horizon
+        void RunSlot(unsigned int index);
+        //! Waits for quanta and runs them, see Worker
+        static void *WorkerMain(void *arg);
+
+        static bool ChangeLess(const PinChange &a, const PinChange &b) { return a.time < b.time; }
+
+        // no copies!
+        ParallelSimulation(const ParallelSimulation &);
+        ParallelSimulation &operator=(const ParallelSimulation &);
+};
+
+#endif
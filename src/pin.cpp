@@ -60,6 +60,16 @@ void Pin::RegisterCallback(HasPinNotifyFunction *h) {
     notifyList.push_back(h);
 }
 
+void Pin::UnRegisterCallback(HasPinNotifyFunction *h) {
+    std::vector<HasPinNotifyFunction*>::iterator ii;
+    for(ii = notifyList.begin(); ii != notifyList.end(); ii++) {
+        if(*ii == h) {
+            notifyList.erase(ii);
+            break;
+        }
+    }
+}
+
 void Pin::SetInState(const Pin &p) { 
     analogVal = p.analogVal;
 
@@ -85,7 +95,7 @@ bool Pin::CalcPin(void) {
         SetInState(*this);
         return (bool)*this;
     } else {
-        return connectedTo->CalcNet();
+        return connectedTo->PinChanged(this);
     }
 }
 
@@ -95,6 +105,7 @@ Pin::Pin(T_Pinstate ps) {
     mask = 0;
     
     outState = ps;
+    netState = TRISTATE;
 
     // Initialization of analog value
     switch (ps) {
@@ -124,6 +135,7 @@ Pin::Pin() {
     mask = 0;
     
     outState = TRISTATE;
+    netState = TRISTATE;
 }
 
 Pin::~Pin() {
@@ -137,6 +149,7 @@ Pin::Pin( unsigned char *parentPin, unsigned char _mask) {
     connectedTo = NULL;
     
     outState = TRISTATE;
+    netState = TRISTATE;
 }
 
 Pin::Pin(const Pin& p) {
@@ -145,6 +158,7 @@ Pin::Pin(const Pin& p) {
     mask = 0;
     
     outState = p.outState;
+    netState = TRISTATE;
     analogVal = p.analogVal;
 }
 
@@ -155,6 +169,7 @@ Pin::Pin(float analog) {
     analogVal.setA(analog);
 
     outState = ANALOG;
+    netState = TRISTATE;
 }
 
 void Pin::RegisterNet(Net *n) {
@@ -342,6 +357,16 @@ Pin OpenDrain::GetPin() {
 
 OpenDrain::OpenDrain(Pin *p) {
     pin = p;
+    pin->RegisterCallback(this);
+}
+
+OpenDrain::~OpenDrain() {
+    pin->UnRegisterCallback(this);
+    UnRegisterNet(connectedTo);
+}
+
+void OpenDrain::PinStateHasChanged(Pin *) {
+    CalcPin();
 }
 
 PortPin::PortPin() {
@@ -123,6 +123,12 @@ class Pin {
         T_Pinstate outState; //!< discrete value of output stage
         std::vector<HasPinNotifyFunction*> notifyList; //!< listeners for change of input value
 
+    protected:
+        T_Pinstate netState; //!< output state, which is counted by connected net
+        AnalogValue netValue; //!< analog value of output stage, which is counted by connected net
+
+    public:
+
         Pin(void); //!< common constructor, initial output state is tristate
         Pin(const Pin& p); //!< copy constructor, copy values but no refs to Net or HWPort
         Pin(T_Pinstate ps); //!< copy constructor from pin state
@@ -148,13 +154,15 @@ class Pin {
         Pin& SetAnalogValue(float value);  //!< Sets the pin to an real analog value
         void SetRawAnalog(float value) { analogVal.setA(value); }
         void RegisterCallback(HasPinNotifyFunction *); //!< register a listener for input value change
+        void UnRegisterCallback(HasPinNotifyFunction *); //!< remove a listener for input value change
         //! Update input values from output values
         /*! If there is no connection to other pins, then it will reflect the own
-        output value to own input value. Otherwise it calls Net::CalcNet method */
+        output value to own input value. Otherwise it calls Net::PinChanged method */
         bool CalcPin(void);
 
         bool isPortPin(void) { return pinOfPort != NULL; } //!< True, if it's a port pin
         bool isConnected(void) { return connectedTo != NULL; } //!< True, if it's connected to other pins
+        Net *GetNet(void) { return connectedTo; } //!< Net, which connects this pin, or NULL
         bool hasListener(void) { return notifyList.size() != 0; } //!< True, if there change listeners
 
         friend class HWPort;
@@ -202,13 +210,17 @@ class PortPin: public Pin {
 };
 
 //! Open drain Pin class, a special pin with open drain behavior
-class OpenDrain: public Pin {
+/*! The output stage follows the input value of the controlling pin, a change
+  there updates the net of this pin. */
+class OpenDrain: public Pin, public HasPinNotifyFunction {
     protected:
         Pin *pin;        // the connected pin, which control input
 
     public:
         OpenDrain(Pin *p);
+        virtual ~OpenDrain();
         virtual Pin GetPin();
+        void PinStateHasChanged(Pin *); //!< controlling pin has changed
 };
 
 #endif
@@ -5,12 +5,15 @@
   #include "systemclocktypes.h"
   #include "avrdevice.h"
   #include "systemclock.h"
+  #include "simulationcontext.h"
+  #include "simulationfork.h"
   #include "hardware.h"
   #include "externaltype.h"
   #include "irqsystem.h"
   #include "pin.h"
   #include "pinatport.h"
   #include "net.h"
+  #include "adcpin.h"
   #include "rwmem.h"
   #include "hwsreg.h"
   #include "avrfactory.h"
@@ -61,6 +64,11 @@ namespace std {
    %template(string_vector) vector<string>;   
 };
 
+// module is build with -threads, but the GIL is released only while a
+// simulation runs (see SystemClock below), so simulations in own contexts
+// (see SimulationContext) can run in parallel python threads
+%feature("nothreadallow");
+
 %exception {
   try {
     $action
@@ -75,6 +83,9 @@ namespace std {
 
 %include "config.h"
 
+// state of simulation objects is saved with SystemClock::SaveState
+%ignore Snapshot;
+
 %include "systemclocktypes.h"
 %include "simulationmember.h"
 
@@ -97,6 +108,12 @@ namespace std {
     DumpVCD *d = new DumpVCD(vcdname, timebase, rstrobe, wstrobe);
     $self->addDumper(d, $self->load(istr));
   }
+  void addDumpBinary(const std::string &filename,
+                     const std::string &istr,
+                     const std::string &timebase) {
+    DumpBinary *d = new DumpBinary(filename, timebase);
+    $self->addDumper(d, $self->load(istr));
+  }
 }
 
 %extend AvrDevice {
@@ -105,7 +122,35 @@ namespace std {
   bool setRWMem(unsigned a, unsigned char v) { return $self->SetRWMem(a, v); }
 }
 
+// SystemClock takes ownership of a new time table
+%apply SWIGTYPE *DISOWN { TimeTable *tt };
+// release the GIL while a simulation runs, see nothreadallow above
+%feature("nothreadallow", "0") SystemClock::Endless;
+%feature("nothreadallow", "0") SystemClock::Run;
+%feature("nothreadallow", "0") SystemClock::RunTimeRange;
+// a saved simulation state is binary data, use bytes (str on python 2)
+%typemap(out) std::string SystemClock::SaveState {
+%#if PY_VERSION_HEX >= 0x03000000
+  $result = PyBytes_FromStringAndSize($1.data(), $1.size());
+%#else
+  $result = PyString_FromStringAndSize($1.data(), $1.size());
+%#endif
+}
+%typemap(in) const std::string &state (std::string temp) {
+  char *buf;
+  Py_ssize_t len;
+%#if PY_VERSION_HEX >= 0x03000000
+  if(PyBytes_AsStringAndSize($input, &buf, &len) < 0)
+%#else
+  if(PyString_AsStringAndSize($input, &buf, &len) < 0)
+%#endif
+    SWIG_fail;
+  temp.assign(buf, len);
+  $1 = &temp;
+}
 %include "systemclock.h"
+%include "simulationcontext.h"
+%include "simulationfork.h"
 
 %extend SystemClock {
   int Step() {
@@ -140,12 +185,40 @@ namespace std {
 }
 
 %include "net.h"
+%include "adcpin.h"
 
 %feature("director") RWMemoryMember;
 %include "rwmem.h"
 %include "specialmem.h"
 
 %include "hwsreg.h"
+%{
+  // flags H, S, V, N, Z and C are calculated on demand, so pending
+  // flags have to be updated before access
+  #define HWSREG_FLAG_ACCESS(f) \
+    bool HWSreg_##f##_get(HWSreg *s) { s->Update(); return s->f; } \
+    void HWSreg_##f##_set(HWSreg *s, bool v) { s->Update(); s->f = v; }
+  HWSREG_FLAG_ACCESS(H)
+  HWSREG_FLAG_ACCESS(S)
+  HWSREG_FLAG_ACCESS(V)
+  HWSREG_FLAG_ACCESS(N)
+  HWSREG_FLAG_ACCESS(Z)
+  HWSREG_FLAG_ACCESS(C)
+%}
+%extend HWSreg {
+  bool H;
+  bool S;
+  bool V;
+  bool N;
+  bool Z;
+  bool C;
+  unsigned char GetValue(void) {
+    return (int)*$self;
+  }
+  void SetValue(unsigned char v) {
+    *$self = v;
+  }
+}
 %extend RWSreg {
   unsigned char GetValue(void) {
     unsigned char v = *$self;
@@ -177,11 +250,10 @@ namespace std {
 
 %extend Breakpoints {
   void RemoveBreakpoint(unsigned bp) {
-    Breakpoints::iterator ii;
-    if ((ii = find($self->begin(), $self->end(), bp)) != $self->end()) $self->erase(ii);
+    $self->Remove(bp);
   }
   void AddBreakpoint(unsigned bp) {
-    $self->push_back(bp);
+    $self->Add(bp);
   }
 }
 
@@ -30,12 +30,14 @@
  */
 
 #include <cstdio>
+#include <cstring>
 
 #include "avrerror.h"
 #include "traceval.h"
 #include "avrdevice.h"
 #include "helper.h"
 #include "rwmem.h"
+#include "snapshot.h"
 
 using namespace std;
 
@@ -91,6 +93,10 @@ RWMemoryMember::~RWMemoryMember() {
         delete tv;
 }
 
+void GPIORegister::Snapshot(SnapshotArchive &ar) {
+    ar.Item(value);
+}
+
 CLKPRRegister::CLKPRRegister(AvrDevice *core,
                              TraceValueRegister *registry):
         RWMemoryMember(registry, "CLKPR"),
@@ -114,12 +120,18 @@ void CLKPRRegister::Reset(void) {
     activate = 0;
 }
 
+void CLKPRRegister::Snapshot(SnapshotArchive &ar) {
+    ar.Item(value);
+    ar.Item(activate);
+}
+
 unsigned int CLKPRRegister::CpuCycle(void) {
     // control clock set activation
     if(activate > 0) {
         activate--;
         value &= 0x7f; // reset CLKPCE, if set
-    }
+    } else
+        _core->SuspendHardware(this);
     return 0;
 }
 
@@ -138,6 +150,7 @@ void CLKPRRegister::set(unsigned char v) {
         }
     }
     value = v;
+    _core->WakeUpHardware(this);
 }
 
 XDIVRegister::XDIVRegister(AvrDevice *core,
@@ -148,6 +161,10 @@ XDIVRegister::XDIVRegister(AvrDevice *core,
     Reset();
 }
 
+void XDIVRegister::Snapshot(SnapshotArchive &ar) {
+    ar.Item(value);
+}
+
 void XDIVRegister::set(unsigned char v) {
     bool old_enbl = (value & 0x80) == 0x80, new_enbl = (v & 0x80) == 0x80;
     if(new_enbl) {
@@ -184,6 +201,10 @@ void OSCCALRegister::Reset(void) {
         value = 42;
 }
 
+void OSCCALRegister::Snapshot(SnapshotArchive &ar) {
+    ar.Item(value);
+}
+
 void OSCCALRegister::set(unsigned char v) {
     if(cal_type == OSCCAL_V4)
         v &= 0x7f;
@@ -192,9 +213,13 @@ void OSCCALRegister::set(unsigned char v) {
     value = v;
 }
 
-RAM::RAM(TraceValueCoreRegister *_reg, const std::string &name, const size_t number, const size_t maxsize) {
+RAM::RAM(TraceValueCoreRegister *_reg,
+         const std::string &name,
+         const size_t number,
+         const size_t maxsize,
+         unsigned char *cell) {
     corereg = _reg;
-    value = 0xaa;
+    value = cell;
     if(name.size()) {
         tv = new TraceValue(8, corereg->GetTraceValuePrefix() + name, number);
         if(!corereg) {
@@ -206,9 +231,87 @@ RAM::RAM(TraceValueCoreRegister *_reg, const std::string &name, const size_t num
     }
 }
 
-unsigned char RAM::get() const { return value; }
+unsigned char RAM::get() const { return *value; }
+
+void RAM::set(unsigned char v) { *value = v; }
+
+RWMemoryMap::RWMemoryMap(TraceValueCoreRegister *_reg, unsigned int _size):
+    registry(_reg),
+    size(_size)
+{
+    image = new unsigned char [size];
+    flags = new unsigned char [size];
+    members = new RWMemoryMember* [size];
+    // RAM content after power on is undefined, use a significant pattern
+    memset(image, 0xaa, size);
+    // until a region is declared as plain memory, all accesses have to be dispatched
+    memset(flags, FLAG_DISPATCH, size);
+    for(unsigned int i = 0; i < size; i++)
+        members[i] = NULL;
+}
 
-void RAM::set(unsigned char v) { value=v; }
+RWMemoryMap::~RWMemoryMap() {
+    for(size_t i = 0; i < ownMembers.size(); i++)
+        delete ownMembers[i];
+    for(std::map<unsigned int, RWMemoryMember *>::iterator i = views.begin(); i != views.end(); i++)
+        delete i->second;
+    delete [] members;
+    delete [] flags;
+    delete [] image;
+}
+
+void RWMemoryMap::AddPlainRegion(unsigned int base, unsigned int rsize, const std::string &name) {
+    if(base + rsize > size)
+        avr_error("plain memory region '%s' exceeds address space", name.c_str());
+    Region r;
+    r.base = base;
+    r.size = rsize;
+    r.name = name;
+    regions.push_back(r);
+    for(unsigned int i = base; i < base + rsize; i++) {
+        flags[i] = 0;
+        members[i] = NULL;
+    }
+    if(rsize > 0)
+        registry->RegisterTraceSet(name, rsize, this);
+}
+
+RAM *RWMemoryMap::CreateRAM(unsigned int addr, const Region &r) {
+    RAM *ram = new RAM(registry, r.name, addr - r.base, r.size, &image[addr]);
+    ownMembers.push_back(ram);
+    // there is a RAM instance now, so all accesses have to use it
+    if(members[addr] == NULL) {
+        members[addr] = ram;
+        flags[addr] |= FLAG_DISPATCH;
+    }
+    return ram;
+}
+
+RWMemoryMember *&RWMemoryMap::operator[](unsigned int addr) {
+    if(members[addr] != NULL || (flags[addr] & FLAG_DISPATCH))
+        return members[addr];
+    // plain cell: a view without trace value, access through it is the same
+    // as access on image
+    RWMemoryMember *&view = views[addr];
+    if(view == NULL)
+        view = new RAM(registry, "", 0, 0, &image[addr]);
+    return view;
+}
+
+void RWMemoryMap::SetMember(unsigned int addr, RWMemoryMember *member) {
+    members[addr] = member;
+    flags[addr] |= FLAG_DISPATCH;
+}
+
+void RWMemoryMap::CreateTraceSetValue(const std::string &name, size_t index) {
+    for(size_t i = 0; i < regions.size(); i++) {
+        if(regions[i].name == name && index < regions[i].size) {
+            // a replaced cell keeps it's instance, the RAM instance holds only the TraceValue
+            CreateRAM(regions[i].base + index, regions[i]);
+            break;
+        }
+    }
+}
 
 InvalidMem::InvalidMem(AvrDevice* _c, int _a):
     RWMemoryMember(),
@@ -249,6 +352,10 @@ IOSpecialReg::IOSpecialReg(TraceValueRegister *registry, const std::string &name
     Reset();
 }
 
+void IOSpecialReg::Snapshot(SnapshotArchive &ar) {
+    ar.Item(value);
+}
+
 unsigned char IOSpecialReg::get() const {
     unsigned char val = value;
     for(size_t i = 0; i < clients.size(); i++)
@@ -29,6 +29,7 @@
 
 #include <string>       // std::string
 #include <vector>
+#include <map>
 
 #include "traceval.h"
 #include "avrerror.h"
@@ -101,6 +102,7 @@ class GPIORegister: public RWMemoryMember, public Hardware {
         
         // from Hardware
         void Reset(void) { value = 0; }
+        void Snapshot(SnapshotArchive &ar);
         
     protected:
         unsigned char get() const { return value; }
@@ -120,6 +122,7 @@ class CLKPRRegister: public RWMemoryMember, public Hardware {
         // from Hardware
         void Reset(void);
         unsigned int CpuCycle(void);
+        void Snapshot(SnapshotArchive &ar);
 
     protected:
         unsigned char get() const { return value; }
@@ -140,6 +143,7 @@ class XDIVRegister: public RWMemoryMember, public Hardware {
 
         // from Hardware
         void Reset(void) { value = 0; }
+        void Snapshot(SnapshotArchive &ar);
 
     protected:
         unsigned char get() const { return value; }
@@ -166,6 +170,7 @@ class OSCCALRegister: public RWMemoryMember, public Hardware {
 
         // from Hardware
         void Reset(void);
+        void Snapshot(SnapshotArchive &ar);
 
     protected:
         unsigned char get() const { return value; }
@@ -177,24 +182,93 @@ class OSCCALRegister: public RWMemoryMember, public Hardware {
 };
 
 //! One byte in any AVR RAM
-/*! Allows clean read and write accesses and simply has one stored byte. */
+/*! Allows clean read and write accesses on one stored byte. The byte itself
+  is a cell in the memory image of RWMemoryMap. */
 class RAM : public RWMemoryMember {
     
     public:
         RAM(TraceValueCoreRegister *registry,
             const std::string &tracename,
             const size_t number,
-            const size_t maxsize);
+            const size_t maxsize,
+            unsigned char *cell);
         
     protected:
         unsigned char get() const;
         void set(unsigned char);
         
     private:
-        unsigned char value;
+        unsigned char *value;
         TraceValueCoreRegister *corereg;
 };
 
+#ifndef SWIG
+//! The data address space of a AVR core
+/*! Registers, internal and external RAM are plain memory without side effects.
+  The content of this memory is hold in one contiguous byte array, the image.
+  Only addresses with a set flag in the flag table have to dispatch through a
+  RWMemoryMember instance: IO registers, replaced cells and plain cells, for
+  which a RAM instance exists, because the cell is traced or was accessed by
+  index operator. A watchpoint flag makes a cell also not plain, so watched
+  cells take the slow path and all other cells are accessed as before.
+
+  The index operator gives the same access as a RWMemoryMember* array. For a
+  plain address without instance it returns a view on the image cell, which
+  isn't installed, so the cell stays plain. Cells are installed by SetMember,
+  assigning a instance through the index operator has no effect on a plain
+  address. */
+class RWMemoryMap: public TraceSetFactory {
+
+    public:
+        enum {
+            FLAG_DISPATCH = 0x01,    //!< access has to be dispatched through RWMemoryMember instance
+            FLAG_WATCH_READ = 0x02,  //!< a read access hits a watchpoint, see AvrDevice::AddWatchpoint
+            FLAG_WATCH_WRITE = 0x04, //!< a write access hits a watchpoint
+            FLAG_WATCH = FLAG_WATCH_READ | FLAG_WATCH_WRITE
+        };
+
+        RWMemoryMap(TraceValueCoreRegister *registry, unsigned int size);
+        ~RWMemoryMap();
+
+        //! Declare a region of plain memory, cells are traced as name0 .. name(size-1)
+        void AddPlainRegion(unsigned int base, unsigned int size, const std::string &name);
+        //! Get the memory cell instance for address, a view without trace value for plain memory
+        RWMemoryMember *&operator[](unsigned int addr);
+        //! Set the memory cell instance for address, access will be dispatched to it
+        void SetMember(unsigned int addr, RWMemoryMember *member);
+        //! Check, if access on address can be done directly on image
+        bool IsPlain(unsigned int addr) const { return flags[addr] == 0; }
+
+        // from TraceSetFactory
+        void CreateTraceSetValue(const std::string &name, size_t index);
+
+        unsigned char *image; //!< memory content for plain memory
+        unsigned char *flags; //!< access flags for every address, see FLAG_DISPATCH and FLAG_WATCH
+
+    private:
+        //! A region of plain memory
+        struct Region {
+            unsigned int base;
+            unsigned int size;
+            std::string name;
+        };
+
+        TraceValueCoreRegister *registry;
+        unsigned int size; //!< size of address space
+        RWMemoryMember **members; //!< memory cell instances, NULL for plain memory without instance
+        std::vector<Region> regions; //!< declared plain memory regions
+        std::vector<RWMemoryMember *> ownMembers; //!< created RAM instances
+        std::map<unsigned int, RWMemoryMember *> views; //!< views on plain cells, see operator[]
+
+        //! Create RAM instance for address in region
+        RAM *CreateRAM(unsigned int addr, const Region &r);
+
+        // no copies!
+        RWMemoryMap(const RWMemoryMap &);
+        RWMemoryMap &operator=(const RWMemoryMap &);
+};
+#endif
+
 //! Memory on which access should be avoided! :-)
 /*! All accesses to this type of memory will produce an error. */
 class InvalidMem : public RWMemoryMember {
@@ -348,6 +422,12 @@ class IOSpecialReg: public RWMemoryMember {
           @param val the new register value
           @param mask the bitmask for val */
         void hardwareChangeMask(unsigned char val, unsigned char mask) { if(tv) tv->change(val, mask); }
+
+        //! Returns the stored register value, without asking clients and without tracing a read access
+        unsigned char GetRegValue(void) const { return value; }
+
+        //! Save or restore the stored register value, clients aren't informed
+        void Snapshot(SnapshotArchive &ar);
         
     protected:
         std::vector<IOSpecialRegClient*> clients; //!< clients-list with registered clients
@@ -0,0 +1,104 @@
+/*
+ ****************************************************************************
+ *
+ * simulavr - A simulator for the Atmel AVR family of microcontrollers.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ ****************************************************************************
+ *
+ *  $Id$
+ */
+
+
+#include "simulationcontext.h"
+#include "systemclock.h"
+#include "traceval.h"
+#include "application.h"
+#include "avrerror.h"
+
+//! current context of this thread, NULL means default context
+static SIM_THREAD_LOCAL SimulationContext *currentContext = NULL;
+//! console handler of current context of this thread, NULL means sysConHandler
+static SIM_THREAD_LOCAL SystemConsoleHandler *currentConsole = NULL;
+
+SimulationContext::SimulationContext():
+    console(new SystemConsoleHandler),
+    ownConsole(true)
+{
+    Init();
+}
+
+SimulationContext::SimulationContext(SystemConsoleHandler *_console):
+    console(_console),
+    ownConsole(false)
+{
+    Init();
+}
+
+void SimulationContext::Init(void) {
+    clock = new SystemClock(this);
+    dumpManager = NULL;
+    application = new Application;
+}
+
+SimulationContext::~SimulationContext() {
+    if(currentContext == this) {
+        currentContext = NULL;
+        currentConsole = NULL;
+    }
+    if(dumpManager) {
+        dumpManager->detachAvrDevices();
+        delete dumpManager;
+    }
+    delete application;
+    delete clock;
+    if(ownConsole)
+        delete console;
+}
+
+DumpManager *SimulationContext::GetDumpManager(void) {
+    if(dumpManager == NULL)
+        dumpManager = new DumpManager;
+    return dumpManager;
+}
+
+void SimulationContext::Stop(void) {
+    clock->Stop();
+}
+
+SimulationContext &SimulationContext::Default(void) {
+    // never destroyed, devices could be destroyed on exit after this context
+    static SimulationContext *ctx = new SimulationContext(&sysConHandler);
+    return *ctx;
+}
+
+SimulationContext &SimulationContext::Current(void) {
+    if(currentContext != NULL)
+        return *currentContext;
+    return Default();
+}
+
+void SimulationContext::SetCurrent(SimulationContext *ctx) {
+    currentContext = (ctx == &Default()) ? NULL : ctx;
+    currentConsole = (currentContext == NULL) ? NULL : currentContext->console;
+}
+
+SystemConsoleHandler &SimulationContext::CurrentConsoleHandler(void) {
+    if(currentConsole != NULL)
+        return *currentConsole;
+    return sysConHandler;
+}
+
@@ -0,0 +1,134 @@
+/*
+ ****************************************************************************
+ *
+ * simulavr - A simulator for the Atmel AVR family of microcontrollers.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ ****************************************************************************
+ *
+ *  $Id$
+ */
+
+
+#ifndef SIMULATIONCONTEXT
+#define SIMULATIONCONTEXT
+
+#include <string>
+
+class SystemClock;
+class DumpManager;
+class SystemConsoleHandler;
+class Application;
+
+#ifndef SWIG
+//! Storage class for thread local variables
+#   if defined(_MSC_VER)
+#       define SIM_THREAD_LOCAL __declspec(thread)
+#   else
+#       define SIM_THREAD_LOCAL __thread
+#   endif
+#endif
+
+//! Holds the state of one simulation: clock, dump manager, console handler and application
+/*! Before, SystemClock, DumpManager, the console handler and Application were
+  singletons, so only one simulation could run in a process. Now they are
+  owned by a simulation context and SystemClock::Instance(),
+  DumpManager::Instance(), Application::GetInstance() and the avr_* message
+  macros return the members of the current context of the calling thread.
+
+  The default context is current, if a thread hasn't set another one. It uses
+  the global sysConHandler, so a single simulation works as before. For
+  parallel simulations each thread creates its own context and makes it
+  current (see SetCurrent or Scope), before devices and other simulation
+  members are created. A AvrDevice remembers the context, which was current on
+  construction, SystemClock::Run and friends switch to the context of the
+  clock. Devices of different contexts must not be connected (by nets or pins)
+  and a context has to be used by only one thread at a time.
+
+  The device factory (AvrFactory) is a read only registry and shared by all
+  contexts. */
+class SimulationContext {
+
+    public:
+        //! Create a new context with own clock, dump manager, console handler and application
+        SimulationContext();
+        //! Create a new context, which uses the given console handler (it's not taken over)
+        SimulationContext(SystemConsoleHandler *console);
+        //! Destroy the context, all devices created in this context have to be destroyed before
+        ~SimulationContext();
+
+        //! Returns the clock of this context
+        SystemClock &GetSystemClock(void) { return *clock; }
+        //! Returns the console handler of this context
+        SystemConsoleHandler &GetConsoleHandler(void) { return *console; }
+        //! Returns the dump manager of this context, it's created on first call
+        DumpManager *GetDumpManager(void);
+        //! Returns the application of this context
+        Application *GetApplication(void) { return application; }
+        //! Stops a running simulation of this context, can be called from other threads
+        void Stop(void);
+
+        //! Enable firmware cache in directory dir, empty string disables cache (default)
+        /*! With cache the content of a elf file, which is needed by ELFLoad and
+          ELFGetSignature, is written once to a cache file in dir. Later loads of
+          the same elf file take it from there, without parsing the elf file. Not
+          available on MSVC build. */
+        void SetFirmwareCacheDirectory(const std::string &dir) { firmwareCacheDirectory = dir; }
+        //! Returns directory of firmware cache, empty if cache is disabled
+        const std::string &GetFirmwareCacheDirectory(void) const { return firmwareCacheDirectory; }
+
+        //! Returns the default context
+        static SimulationContext &Default(void);
+        //! Returns the current context of the calling thread
+        static SimulationContext &Current(void);
+        //! Set the current context of the calling thread, NULL selects the default context
+        static void SetCurrent(SimulationContext *ctx);
+        //! Returns the console handler of the current context of the calling thread
+        /*! Cached with the current context, so messages (avr_warning etc.) need
+          just one thread local access. */
+        static SystemConsoleHandler &CurrentConsoleHandler(void);
+
+#ifndef SWIG
+        //! Makes a context current for the lifetime of the scope object
+        class Scope {
+            public:
+                Scope(SimulationContext &ctx): previous(&Current()) { SetCurrent(&ctx); }
+                ~Scope() { SetCurrent(previous); }
+            private:
+                SimulationContext *previous;
+                Scope(const Scope &);
+                Scope &operator=(const Scope &);
+        };
+#endif
+
+    private:
+        SystemConsoleHandler *console;
+        bool ownConsole;         //!< console handler is created by this context
+        SystemClock *clock;
+        DumpManager *dumpManager;
+        Application *application;
+        std::string firmwareCacheDirectory; //!< see SetFirmwareCacheDirectory
+
+        friend class DumpManager;
+
+        void Init(void);
+
+        // no copies!
+        SimulationContext(const SimulationContext &);
+        SimulationContext &operator=(const SimulationContext &);
+};
+
+#endif
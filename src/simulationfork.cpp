@@ -0,0 +1,168 @@
+/*
+ ****************************************************************************
+ *
+ * simulavr - A simulator for the Atmel AVR family of microcontrollers.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ ****************************************************************************
+ *
+ *  $Id$
+ */
+
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config.h"
+#if !(defined(_MSC_VER) || defined(HAVE_SYS_MINGW))
+#   include <sys/types.h>
+#   include <sys/wait.h>
+#   include <unistd.h>
+#   include <errno.h>
+#   define USE_FORK
+#endif
+
+#include "simulationfork.h"
+#include "avrerror.h"
+
+SimulationFork::SimulationFork(int _maxChildren):
+    maxChildren(_maxChildren),
+    childIndex(-1),
+    collected(0)
+{
+#ifdef USE_FORK
+    if(maxChildren <= 0)
+        maxChildren = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if(maxChildren <= 0)
+        maxChildren = 1;
+}
+
+SimulationFork::~SimulationFork() {
+    if(!IsChild())
+        Wait();
+}
+
+bool SimulationFork::Fork(void) {
+#ifdef USE_FORK
+    if(IsChild())
+        avr_error("a forked simulation can't fork again with the same controller");
+    while((int)(children.size() - collected) >= maxChildren)
+        Collect();
+
+    // buffered output would be written by parent and child
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(stdout);
+    fflush(stderr);
+
+    int fds[2];
+    if(pipe(fds) < 0)
+        avr_error("can't create pipe for forked simulation");
+    int pid = fork();
+    if(pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        avr_error("can't fork simulation");
+    }
+
+    if(pid == 0) {
+        // child: stdout goes to parent, pipes to older children aren't needed
+        close(fds[0]);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[1]);
+        for(unsigned int i = collected; i < children.size(); i++)
+            close(children[i].fd);
+        childIndex = children.size();
+        children.clear();
+        collected = 0;
+        return true;
+    }
+
+    close(fds[1]);
+    Child c;
+    c.pid = pid;
+    c.fd = fds[0];
+    c.exitCode = 0;
+    children.push_back(c);
+    return false;
+#else
+    avr_error("forked simulations aren't supported on this system");
+    return false;
+#endif
+}
+
+void SimulationFork::Collect(void) {
+#ifdef USE_FORK
+    Child &c = children[collected++];
+    char buffer[4096];
+    for(;;) {
+        ssize_t len = read(c.fd, buffer, sizeof(buffer));
+        if(len > 0)
+            c.output.append(buffer, len);
+        else if(len == 0 || errno != EINTR)
+            break;
+    }
+    close(c.fd);
+    c.fd = -1;
+
+    int status;
+    while(waitpid(c.pid, &status, 0) < 0) {
+        if(errno != EINTR) {
+            status = 0;
+            avr_warning("can't get exit status of forked simulation %d", collected - 1);
+            break;
+        }
+    }
+    if(WIFEXITED(status))
+        c.exitCode = WEXITSTATUS(status);
+    else if(WIFSIGNALED(status))
+        c.exitCode = -WTERMSIG(status);
+#endif
+}
+
+void SimulationFork::Wait(void) {
+    if(IsChild())
+        avr_error("only the parent simulation can wait for forked simulations");
+    while(collected < children.size())
+        Collect();
+}
+
+int SimulationFork::GetExitCode(int child) const {
+    if(child < 0 || child >= (int)collected)
+        avr_error("forked simulation %d isn't finished", child);
+    return children[child].exitCode;
+}
+
+std::string SimulationFork::GetOutput(int child) const {
+    if(child < 0 || child >= (int)collected)
+        avr_error("forked simulation %d isn't finished", child);
+    return children[child].output;
+}
+
+void SimulationFork::Exit(int code) {
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(stdout);
+    fflush(stderr);
+#ifdef USE_FORK
+    _exit(code);
+#else
+    exit(code);
+#endif
+}
+
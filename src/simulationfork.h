@@ -0,0 +1,95 @@
+/*
+ ****************************************************************************
+ *
+ * simulavr - A simulator for the Atmel AVR family of microcontrollers.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ ****************************************************************************
+ *
+ *  $Id$
+ */
+
+
+#ifndef SIMULATIONFORK
+#define SIMULATIONFORK
+
+#include <string>
+#include <vector>
+
+//! Runs copies of a simulation in child processes
+/*! Fork creates a child process, which continues the simulation from the
+  state of the parent. Loaded program, decoded instructions and RAM are shared
+  by fork() copy-on-write, so a child starts immediately and needs memory only
+  for the pages, which it changes. A child sets it's own stimulus (for example
+  RWReadFromFile::SetFile or a AdcPin) and runs on.
+
+  Output of a child to stdout is collected by the parent, see Wait, GetOutput
+  and GetExitCode. A child ends, if it's process exits, see Exit.
+
+  Only available on POSIX systems, not on windows. */
+class SimulationFork {
+
+    public:
+        //! Create a fork controller, at most maxChildren run at the same time
+        /*! With maxChildren = 0 the number of online processors is used. */
+        SimulationFork(int maxChildren = 0);
+        //! Destroy the fork controller, the parent waits for all children
+        ~SimulationFork();
+
+        //! Start a child process, returns true in the child and false in the parent
+        /*! If maxChildren children are running, the parent waits for the
+          oldest child before. */
+        bool Fork(void);
+        //! Returns true, if called in a child process
+        bool IsChild(void) const { return childIndex >= 0; }
+        //! Returns number of the child process (counted from 0), -1 in the parent
+        int GetChildIndex(void) const { return childIndex; }
+
+        //! Wait for all children and collect their output (only in the parent)
+        void Wait(void);
+        //! Returns number of started children
+        int GetChildCount(void) const { return children.size(); }
+        //! Returns exit code of a child after Wait, -signal, if it was killed by a signal
+        int GetExitCode(int child) const;
+        //! Returns collected stdout output of a child after Wait
+        std::string GetOutput(int child) const;
+
+        //! Flush stdout and end the process without cleanup, for a child
+        static void Exit(int code);
+
+    private:
+        //! A started child process
+        struct Child {
+            int pid;
+            int fd;               //!< read end of pipe to stdout of child, -1 after collect
+            int exitCode;
+            std::string output;
+        };
+
+        int maxChildren;
+        int childIndex;           //!< number of this process, if it's a child, otherwise -1
+        unsigned int collected;   //!< children before this index are finished
+        std::vector<Child> children;
+
+        //! Read output and wait for end of the oldest running child
+        void Collect(void);
+
+        // no copies!
+        SimulationFork(const SimulationFork &);
+        SimulationFork &operator=(const SimulationFork &);
+};
+
+#endif
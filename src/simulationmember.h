@@ -26,8 +26,12 @@
 #ifndef SIMULATIONMEMBER
 #define SIMULATIONMEMBER
 
+#include <cstddef>
+
 #include "systemclocktypes.h"
 
+class AvrDevice;
+
 /** Any class which is needs to be notified at certain time implements this.
 * Implementor usually calls SystemClock::Add(this) and its SimulationMember::Step()
 * will be called later. People, please avoid polling. */
@@ -36,6 +40,9 @@ class SimulationMember {
         virtual ~SimulationMember() { }
         /// Return nonzero if a breakpoint was hit.
         virtual int Step(bool &trueHwStep, SystemClockOffset *timeToNextStepIn_ns=0)=0;
+        /// Return the device, which is stepped with this member, or NULL, if it doesn't belong to a device.
+        /// A parallel simulation (see SystemClock::SetParallel) steps such members on the thread of their device.
+        virtual AvrDevice *GetDevice(void) { return NULL; }
 };
 
 #endif 
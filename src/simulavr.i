@@ -12,6 +12,7 @@
 #include "atmega128.h"
 #include "at4433.h"
 #include "systemclock.h"
+#include "simulationcontext.h"
 #include "ui/ui.h"
 #include "hardware.h"
 #include "pin.h"
@@ -49,6 +50,9 @@ namespace std {
 
 %immutable HWStack::m_ThreadList;
 
+// state of simulation objects is saved with SystemClock::SaveState
+%ignore Snapshot;
+
 %include "systemclocktypes.h"
 %include "simulationmember.h"
 %include "externaltype.h"
@@ -61,6 +65,7 @@ namespace std {
 %include "atmega128.h"
 %include "at4433.h"
 %include "systemclock.h"
+%include "simulationcontext.h"
 %include "ui/ui.h"
 %include "hardware.h"
 %include "pin.h"
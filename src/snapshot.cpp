@@ -0,0 +1,108 @@
+/*
+ ****************************************************************************
+ *
+ * simulavr - A simulator for the Atmel AVR family of microcontrollers.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ ****************************************************************************
+ *
+ *  $Id$
+ */
+
+
+#include <string.h>
+#include <stdint.h>
+
+#include "snapshot.h"
+#include "avrerror.h"
+
+void SnapshotArchive::Put(unsigned long long v) {
+    do {
+        unsigned char c = v & 0x7f;
+        v >>= 7;
+        if(v)
+            c |= 0x80;
+        data += (char)c;
+    } while(v);
+}
+
+unsigned long long SnapshotArchive::Get(void) {
+    unsigned long long v = 0;
+    int shift = 0;
+    unsigned char c;
+    do {
+        if(pos >= data.size())
+            avr_error("simulation state is truncated");
+        c = data[pos++];
+        if(shift < 64)
+            v |= (unsigned long long)(c & 0x7f) << shift;
+        shift += 7;
+    } while(c & 0x80);
+    return v;
+}
+
+void SnapshotArchive::Item(float &v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    Item(bits);
+    memcpy(&v, &bits, sizeof(bits));
+}
+
+void SnapshotArchive::Item(double &v) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    Item(bits);
+    memcpy(&v, &bits, sizeof(bits));
+}
+
+void SnapshotArchive::Item(std::string &s) {
+    if(restoring) {
+        size_t len = Get();
+        if(len > data.size() - pos)
+            avr_error("simulation state is truncated");
+        s = data.substr(pos, len);
+        pos += len;
+    } else {
+        Put(s.size());
+        data += s;
+    }
+}
+
+void SnapshotArchive::Block(unsigned char *mem, unsigned int size) {
+    Check(size, "memory size");
+    if(restoring) {
+        if(size > data.size() - pos)
+            avr_error("simulation state is truncated");
+        memcpy(mem, data.data() + pos, size);
+        pos += size;
+    } else
+        data.append((const char *)mem, size);
+}
+
+void SnapshotArchive::Tag(const char *name) {
+    std::string s(name);
+    Item(s);
+    if(restoring && s != name)
+        avr_error("simulation state doesn't fit: expected '%s', found '%s'", name, s.c_str());
+}
+
+void SnapshotArchive::Check(unsigned long long value, const char *what) {
+    unsigned long long v = value;
+    Item(v);
+    if(restoring && v != value)
+        avr_error("simulation state doesn't fit: %s is %llu, but %llu in saved state", what, value, v);
+}
+
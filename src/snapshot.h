@@ -0,0 +1,94 @@
+/*
+ ****************************************************************************
+ *
+ * simulavr - A simulator for the Atmel AVR family of microcontrollers.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ ****************************************************************************
+ *
+ *  $Id$
+ */
+
+
+#ifndef SNAPSHOT
+#define SNAPSHOT
+
+#include <string>
+
+//! Saves or restores the state of simulation objects in a compact binary format
+/*! A object, which has state, gets a method Snapshot(SnapshotArchive &ar),
+  which passes all its state variables to Item, Array or Block. The same
+  method is used for saving and restoring, so both directions can't differ.
+  Numbers are stored as variable length integers (LEB128, signed numbers
+  zigzag encoded), so the size of a state blob depends on the values, not on
+  the types of the variables.
+
+  A archive isn't self describing, only the sequence of items is stored. A
+  state can only be restored into the same set of objects (same devices,
+  same hardware units), as it was saved from. Tag inserts check points, so a
+  restore into another configuration is detected. See SystemClock::SaveState. */
+class SnapshotArchive {
+
+    public:
+        //! Create a empty archive for saving a state
+        SnapshotArchive(void): pos(0), restoring(false) {}
+        //! Create a archive to restore the given state
+        SnapshotArchive(const std::string &_data): data(_data), pos(0), restoring(true) {}
+
+        //! Returns true, if this archive restores a state
+        bool IsRestoring(void) const { return restoring; }
+        //! Returns the saved state
+        const std::string &GetData(void) const { return data; }
+        //! Returns true, if all data is read back on restore
+        bool AtEnd(void) const { return pos >= data.size(); }
+
+        //! Save or restore a integral value (also bool or enum)
+        template<class T> void Item(T &v) {
+            if(restoring)
+                v = (T)GetSigned();
+            else
+                PutSigned((long long)v);
+        }
+        //! Save or restore a float value
+        void Item(float &v);
+        //! Save or restore a double value
+        void Item(double &v);
+        //! Save or restore a string
+        void Item(std::string &s);
+        //! Save or restore count values of a array
+        template<class T> void Array(T *a, unsigned int count) {
+            for(unsigned int i = 0; i < count; i++)
+                Item(a[i]);
+        }
+        //! Save or restore a memory block as it is, size must be the same on restore
+        void Block(unsigned char *mem, unsigned int size);
+        //! Check point, restoring aborts, if the saved name is another
+        void Tag(const char *name);
+        //! Check a value, which isn't restored, but must be the same, like a count of units
+        void Check(unsigned long long value, const char *what);
+
+    private:
+        std::string data;  //!< state data
+        size_t pos;        //!< read position on restore
+        bool restoring;    //!< Flag: archive restores a state
+
+        void Put(unsigned long long v);
+        unsigned long long Get(void);
+        void PutSigned(long long v) { Put(((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63)); }
+        long long GetSigned(void) { unsigned long long v = Get(); return (long long)(v >> 1) ^ -(long long)(v & 1); }
+};
+
+#endif
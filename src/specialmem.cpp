@@ -54,19 +54,33 @@ RWReadFromFile::RWReadFromFile(TraceValueRegister *registry,
                                const string &tracename,
                                const string &filename):
     RWMemoryMember(registry, tracename),
-    is((filename=="-") ? cin : ifs)
+    is((filename=="-") ? &cin : &ifs)
 {
     if(filename != "-")
         ifs.open(filename.c_str());
 }
 
+void RWReadFromFile::SetFile(const string &filename) {
+    if(ifs.is_open())
+        ifs.close();
+    ifs.clear();
+    if(filename == "-") {
+        is = &cin;
+    } else {
+        ifs.open(filename.c_str());
+        if(!ifs)
+            avr_error("Cannot open input file '%s'.", filename.c_str());
+        is = &ifs;
+    }
+}
+
 void RWReadFromFile::set(unsigned char val) {
     avr_warning("Invalid write access to RWWriteToFile register with value %d.", (int)val);
 }
 
 unsigned char RWReadFromFile::get() const { 
     char val;
-    is.get(val);
+    is->get(val);
     return val; 
 } 
 
@@ -79,13 +93,13 @@ RWExit::RWExit(TraceValueRegister *registry,
 void RWExit::set(unsigned char c) {
     avr_message("Exiting at simulated program request (write)");
     DumpManager::Instance()->stopApplication();
-    sysConHandler.ExitApplication(c); 
+    SystemConsoleHandler::Current().ExitApplication(c); 
 }
 
 unsigned char RWExit::get() const {
     avr_message("Exiting at simulated program request (read)");
     DumpManager::Instance()->stopApplication();
-    sysConHandler.ExitApplication(0); 
+    SystemConsoleHandler::Current().ExitApplication(0); 
     return 0;
 }
 
@@ -96,13 +110,13 @@ RWAbort::RWAbort(TraceValueRegister *registry,
 void RWAbort::set(unsigned char c) {
     avr_warning("Aborting at simulated program request (write)");
     DumpManager::Instance()->stopApplication();
-    sysConHandler.AbortApplication(c);
+    SystemConsoleHandler::Current().AbortApplication(c);
 }
 
 unsigned char RWAbort::get() const {
     avr_warning("Aborting at simulated program request (read)");
     DumpManager::Instance()->stopApplication();
-    sysConHandler.AbortApplication(0);
+    SystemConsoleHandler::Current().AbortApplication(0);
     return 0;
 }
 
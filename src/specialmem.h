@@ -62,11 +62,14 @@ class RWReadFromFile: public RWMemoryMember {
     RWReadFromFile(TraceValueRegister *registry,
                    const std::string &tracename,
                    const std::string &filename);
+    //! Read following bytes from another file ('-' is cin)
+    /*! Used to give a forked simulation it's own stimulus. */
+    void SetFile(const std::string &filename);
  protected:
     unsigned char get() const;
     void set(unsigned char);
 
-    std::istream &is;
+    std::istream *is;
     mutable std::ifstream ifs;
 };
 
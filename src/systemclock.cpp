@@ -30,9 +30,17 @@
 #include "application.h"
 #include "avrdevice.h"
 #include "avrerror.h"
+#include "simulationcontext.h"
+#include "parallelsim.h"
+#include "snapshot.h"
+#include "traceval.h"
 
 #include "signal.h"
 #include <assert.h>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
 
 using namespace std;
 
@@ -108,33 +116,201 @@ void MinHeap<Key, Value>::RemoveAtPositionAndInsertInternal(Key k, Value v, unsi
     }
 }
 
-SystemClock::SystemClock() { 
-    static int no = 0;
+template<typename Key, typename Value>
+void MinHeap<Key, Value>::RemoveAtPosition(unsigned pos)
+{
+    assert(pos < this->size());
+    Key k = this->back().first;
+    Value v = this->back().second;
+    this->pop_back();
+    if(pos < this->size())
+        RemoveAtPositionAndInsert(k, v, pos);
+}
+
+HeapTimeTable::HeapTimeTable(): insertCount(0) {}
+
+SimulationMember *HeapTimeTable::RemoveMinimum(SystemClockOffset &key) {
+    key = heap.GetMinimumKey().time;
+    SimulationMember *member = heap.GetMinimumValue();
+    heap.RemoveMinimum();
+    return member;
+}
+
+bool HeapTimeTable::Remove(SimulationMember *member) {
+    for(unsigned i = 0; i < heap.size(); i++) {
+        if(heap[i].second == member) {
+            heap.RemoveAtPosition(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void HeapTimeTable::GetEntries(std::vector<Entry> &entries) const {
+    // in order of time and insertion, so a new table gets the same order
+    std::vector<std::pair<HeapTimeKey, SimulationMember *> > sorted(heap.begin(), heap.end());
+    std::sort(sorted.begin(), sorted.end());
+    for(unsigned i = 0; i < sorted.size(); i++)
+        entries.push_back(Entry(sorted[i].first.time, sorted[i].second));
+}
+
+TimingWheel::TimingWheel(unsigned slotBits, unsigned widthBits):
+    slots(1 << slotBits),
+    widthBits(widthBits),
+    slotMask((1 << slotBits) - 1),
+    count(0),
+    lastTime(0),
+    minSlot(-1) {}
+
+unsigned TimingWheel::FindMinimum() {
+    assert(count > 0);
+    if(minSlot >= 0)
+        return minSlot;
+
+    // look for the first slot with a member in the current wheel turn
+    SystemClockOffset slotTime = lastTime >> widthBits;
+    for(unsigned n = 0; n <= slotMask; n++, slotTime++) {
+        std::vector<Entry> &slot = slots[(unsigned)slotTime & slotMask];
+        if(!slot.empty() && slot.front().first < ((slotTime + 1) << widthBits)) {
+            minSlot = (unsigned)slotTime & slotMask;
+            return minSlot;
+        }
+    }
+
+    // nothing in next wheel turn, search earliest member in all slots
+    for(unsigned i = 0; i <= slotMask; i++) {
+        if(!slots[i].empty() && (minSlot < 0 || slots[i].front().first < slots[minSlot].front().first))
+            minSlot = i;
+    }
+    lastTime = slots[minSlot].front().first;
+    return minSlot;
+}
+
+SimulationMember *TimingWheel::RemoveMinimum(SystemClockOffset &key) {
+    std::vector<Entry> &slot = slots[FindMinimum()];
+    key = slot.front().first;
+    SimulationMember *member = slot.front().second;
+    slot.erase(slot.begin());
+    count--;
+    lastTime = key;
+    // slot holds the earliest member as long as it's in the same wheel turn
+    if(slot.empty() || slot.front().first >= (((key >> widthBits) + 1) << widthBits))
+        minSlot = -1;
+    return member;
+}
+
+void TimingWheel::Insert(SystemClockOffset key, SimulationMember *member) {
+    unsigned idx = SlotOf(key);
+    std::vector<Entry> &slot = slots[idx];
+    // insert behind all members with same or earlier time
+    std::vector<Entry>::iterator i = slot.end();
+    while(i != slot.begin() && (i - 1)->first > key)
+        i--;
+    slot.insert(i, Entry(key, member));
+    count++;
+
+    if(key < lastTime) {
+        lastTime = key;
+        minSlot = idx;
+    } else if(minSlot >= 0 && key < slots[minSlot].front().first)
+        minSlot = idx;
+}
+
+bool TimingWheel::Remove(SimulationMember *member) {
+    for(unsigned i = 0; i <= slotMask; i++) {
+        std::vector<Entry>::iterator j;
+        for(j = slots[i].begin(); j != slots[i].end(); j++) {
+            if(j->second == member) {
+                slots[i].erase(j);
+                count--;
+                minSlot = -1;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void TimingWheel::GetEntries(std::vector<Entry> &entries) const {
+    for(unsigned i = 0; i <= slotMask; i++)
+        entries.insert(entries.end(), slots[i].begin(), slots[i].end());
+}
+
+void TimingWheel::Clear() {
+    for(unsigned i = 0; i <= slotMask; i++)
+        slots[i].clear();
+    count = 0;
+    lastTime = 0;
+    minSlot = -1;
+}
+
+//! count of SIGINT/SIGTERM signals, shared by all clocks
+static volatile sig_atomic_t caughtSignals = 0;
+
+SystemClock::SystemClock(SimulationContext *_context) {
+    context = _context;
     currentTime = 0; 
-    no++;
-    if(no > 1)
-        avr_error("Crazy problem: Second instance of SystemClock created!");
+    runLimit = -1;
+    syncMembers = new HeapTimeTable;
+    asyncMembersRemoved = false;
+    breakMessage = false;
+    breakSignals = caughtSignals;
+    parallel = NULL;
+}
+
+SystemClock::~SystemClock() {
+    delete parallel;
+    delete syncMembers;
+}
+
+void SystemClock::SetParallel(unsigned int threads, SystemClockOffset quantum) {
+    delete parallel;
+    parallel = NULL;
+    if(threads > 0)
+        parallel = new ParallelSimulation(this, threads, quantum);
+}
+
+void SystemClock::SetTimeTable(TimeTable *tt) {
+    vector<TimeTable::Entry> entries;
+    syncMembers->GetEntries(entries);
+    for(unsigned i = 0; i < entries.size(); i++)
+        tt->Insert(entries[i].first, entries[i].second);
+    delete syncMembers;
+    syncMembers = tt;
 }
 
 void SystemClock::SetTraceModeForAllMembers(int trace_on) {
-    MinHeap<SystemClockOffset, SimulationMember *>::iterator mi;
-    for(mi = syncMembers.begin(); mi != syncMembers.end(); mi++)
+    vector<TimeTable::Entry> entries;
+    syncMembers->GetEntries(entries);
+    for(unsigned i = 0; i < entries.size(); i++)
     {
-        AvrDevice* core = dynamic_cast<AvrDevice*>( mi->second );
+        AvrDevice* core = dynamic_cast<AvrDevice*>( entries[i].second );
         if(core != NULL)
             core->trace_on = trace_on;
     }
 } 
 
 void SystemClock::Add(SimulationMember *dev) {
-    syncMembers.Insert(currentTime, dev);
+    syncMembers->Insert(currentTime, dev);
 }
 
 void SystemClock::AddAsyncMember(SimulationMember *dev) {
     asyncMembers.push_back(dev);
 }
 
-volatile bool breakMessage = false;
+void SystemClock::RemoveAsyncMember(SimulationMember *dev) {
+    // only mark as removed, list could be processed just now in Step
+    for(unsigned i = 0; i < asyncMembers.size(); i++) {
+        if(asyncMembers[i] == dev) {
+            asyncMembers[i] = NULL;
+            asyncMembersRemoved = true;
+        }
+    }
+}
+
+bool SystemClock::IsBreak(void) const {
+    return breakMessage || breakSignals != caughtSignals;
+}
 
 int SystemClock::Step(bool &untilCoreStepFinished) {
     // 0-> return also if cpu in waitstate 
@@ -142,16 +318,10 @@ int SystemClock::Step(bool &untilCoreStepFinished) {
     int res = 0; // returns the state from a core step. Needed by gdb-server to
                  // watch for breakpoints
 
-    static vector<SimulationMember*>::iterator ami;
-    static vector<SimulationMember*>::iterator amiEnd;
-
-    if(syncMembers.begin() != syncMembers.end()) {
+    if(!syncMembers->IsEmpty()) {
         // take simulation member and current simulation time from time table
-        SimulationMember * core = syncMembers.begin()->second;
-        currentTime = syncMembers.begin()->first;
+        SimulationMember * core = syncMembers->RemoveMinimum(currentTime);
         SystemClockOffset nextStepIn_ns = -1;
-        
-        syncMembers.RemoveMinimum();
 
         // do a step on simulation member
         int rc = core->Step(untilCoreStepFinished, &nextStepIn_ns);
@@ -159,116 +329,306 @@ int SystemClock::Step(bool &untilCoreStepFinished) {
             res = rc;
 
         if(nextStepIn_ns == 0) { // insert the next step behind the following!
-            nextStepIn_ns = 1 + (syncMembers.IsEmpty() ? currentTime : syncMembers.front().first);
+            nextStepIn_ns = 1 + (syncMembers->IsEmpty() ? currentTime : syncMembers->GetMinimumKey());
         } else if(nextStepIn_ns > 0)
             nextStepIn_ns += currentTime;
         // if nextStepIn_ns is < 0, it means, that this simulation member will not
         // be called anymore!
         
         if(nextStepIn_ns > 0)
-            syncMembers.Insert(nextStepIn_ns, core);
+            syncMembers->Insert(nextStepIn_ns, core);
 
         // handle async simulation members
-        amiEnd = asyncMembers.end();
-        for(ami = asyncMembers.begin(); ami != amiEnd; ami++) {
-            bool untilCoreStepFinished = false;
-            (*ami)->Step(untilCoreStepFinished, 0);
+        for(unsigned i = 0; i < asyncMembers.size(); i++) {
+            if(asyncMembers[i] != NULL) {
+                bool untilCoreStepFinished = false;
+                asyncMembers[i]->Step(untilCoreStepFinished, 0);
+            }
+        }
+        if(asyncMembersRemoved) {
+            asyncMembers.erase(remove(asyncMembers.begin(), asyncMembers.end(), (SimulationMember *)NULL),
+                               asyncMembers.end());
+            asyncMembersRemoved = false;
         }
     }
 
     // honour the stop command
-    if (breakMessage)
+    if (IsBreak())
         return 1;
 
     return res;
 }
 
-void SystemClock::Reschedule(SimulationMember *sm, SystemClockOffset newTime) {
-
-    for(unsigned i = 0; i < syncMembers.size(); i++) {
-        if(syncMembers[i].second == sm) {
-            syncMembers.RemoveAtPositionAndInsert(newTime+currentTime+1, sm, i);
-            return;
-        }
+SystemClockOffset SystemClock::GetSkipLimit(void) {
+    SystemClockOffset limit = runLimit;
+    if(!syncMembers->IsEmpty()) {
+        SystemClockOffset next = syncMembers->GetMinimumKey();
+        if(limit < 0 || next < limit)
+            limit = next;
     }
+    return limit;
+}
 
-    syncMembers.Insert(newTime+currentTime+1, sm);
+void SystemClock::Reschedule(SimulationMember *sm, SystemClockOffset newTime) {
+    syncMembers->Remove(sm);
+    syncMembers->Insert(newTime+currentTime+1, sm);
 }
 
 void OnBreak(int s) {
     signal(SIGINT, SIG_DFL);
     signal(SIGTERM, SIG_DFL);
-    breakMessage = true;
+    caughtSignals = caughtSignals + 1;
 }
 
 void SystemClock::Stop() {
     breakMessage = true;
 }
 
+void SystemClock::StartLoop(void) {
+    breakMessage = false;        // if we run a second loop, clear break before entering loop
+    breakSignals = caughtSignals;
+
+    signal(SIGINT, OnBreak);
+    signal(SIGTERM, OnBreak);
+}
+
 void SystemClock::ResetClock(void) {
     breakMessage = false;
+    breakSignals = caughtSignals;
     asyncMembers.clear();
-    syncMembers.clear();
+    asyncMembersRemoved = false;
+    syncMembers->Clear();
     currentTime = 0;
+    runLimit = -1;
 }
 
 long SystemClock::Endless() {
+    SimulationContext::Scope scope(*context);
     long steps = 0;
 
-    breakMessage = false;        // if we run a second loop, clear break before entering loop
-    
-    signal(SIGINT, OnBreak);
-    signal(SIGTERM, OnBreak);
+    StartLoop();
 
-    while(breakMessage == false) {
+    if(parallel != NULL) {
+        steps = parallel->Run(-1, false);
+        if(steps >= 0)
+            return steps;
+        steps = 0;
+    }
+
+    // no end time, but a sleeping core may skip cycles like in Run
+    runLimit = numeric_limits<SystemClockOffset>::max();
+    while(!IsBreak()) {
         steps++;
         bool untilCoreStepFinished = false;
         Step(untilCoreStepFinished);
     }
+    runLimit = -1;
 
     return steps;
 }
 
 long SystemClock::Run(SystemClockOffset maxRunTime) {
+    SimulationContext::Scope scope(*context);
     long steps = 0;
     
-    breakMessage = false;        // if we run a second loop, clear break before entering loop
-    
-    signal(SIGINT, OnBreak);
-    signal(SIGTERM, OnBreak);
+    StartLoop();
+
+    if(parallel != NULL) {
+        steps = parallel->Run(maxRunTime, true);
+        if(steps >= 0)
+            return steps;
+        steps = 0;
+    }
 
-    while((breakMessage== false) &&
-          (SystemClock::Instance().GetCurrentTime() < maxRunTime)) {
+    runLimit = maxRunTime;
+    while(!IsBreak() && (currentTime < maxRunTime)) {
         steps++;
         bool untilCoreStepFinished = false;
         if (Step(untilCoreStepFinished))
             break;
     }
+    runLimit = -1;
 
     return steps;
 }
 
 long SystemClock::RunTimeRange(SystemClockOffset timeRange) {
+    SimulationContext::Scope scope(*context);
     long steps = 0;
     bool untilCoreStepFinished;
     
-    breakMessage = false;        // if we run a second loop, clear break before entering loop
-    
-    signal(SIGINT, OnBreak);
-    signal(SIGTERM, OnBreak);
+    StartLoop();
     
-    timeRange += SystemClock::Instance().GetCurrentTime();
-    while((breakMessage == false) && (SystemClock::Instance().GetCurrentTime() < timeRange)) {
+    timeRange += currentTime;
+    if(parallel != NULL) {
+        steps = parallel->Run(timeRange, true);
+        if(steps >= 0)
+            return steps;
+        steps = 0;
+    }
+    runLimit = timeRange;
+    while(!IsBreak() && (currentTime < timeRange)) {
         untilCoreStepFinished = false;
         if (Step(untilCoreStepFinished))
             break;
         steps++;
     }
+    runLimit = -1;
     
     return steps;
 }
 
+long SystemClock::RunUntil(SystemClockOffset limit, bool stopOnResult, int &result) {
+    long steps = 0;
+
+    result = 0;
+    runLimit = limit;
+    while(!IsBreak() && !syncMembers->IsEmpty() && syncMembers->GetMinimumKey() < limit) {
+        steps++;
+        bool untilCoreStepFinished = false;
+        int rc = Step(untilCoreStepFinished);
+        if(rc && stopOnResult) {
+            result = rc;
+            break;
+        }
+    }
+    runLimit = -1;
+
+    return steps;
+}
+
+//! Find device and hardware unit of a simulation member for a saved state
+/*! unit is -1 for the device itself. Returns false for other simulation
+  members, which aren't saved. */
+static bool FindStateMember(const vector<AvrDevice *> &devices, SimulationMember *m, int &dev, int &unit) {
+    AvrDevice *core = m->GetDevice();
+    if(core == NULL)
+        return false;
+    for(unsigned i = 0; i < devices.size(); i++) {
+        if(devices[i] == core) {
+            dev = i;
+            if(m == core) {
+                unit = -1;
+                return true;
+            }
+            unit = core->GetHardwareIndex(dynamic_cast<Hardware *>(m));
+            return unit >= 0;
+        }
+    }
+    return false;
+}
+
+string SystemClock::SaveState(void) {
+    SimulationContext::Scope scope(*context);
+    vector<AvrDevice *> &devices = context->GetDumpManager()->devices;
+    SnapshotArchive ar;
+
+    ar.Tag("simulavr state");
+    ar.Item(currentTime);
+    ar.Check(devices.size(), "count of devices");
+    for(unsigned i = 0; i < devices.size(); i++)
+        devices[i]->Snapshot(ar);
+
+    // time table entries of devices and their hardware units
+    ar.Tag("time table");
+    vector<TimeTable::Entry> entries;
+    syncMembers->GetEntries(entries);
+    vector<SystemClockOffset> times;
+    vector<int> devs, units;
+    for(unsigned i = 0; i < entries.size(); i++) {
+        int dev, unit;
+        if(FindStateMember(devices, entries[i].second, dev, unit)) {
+            times.push_back(entries[i].first);
+            devs.push_back(dev);
+            units.push_back(unit);
+        }
+    }
+    unsigned count = times.size();
+    ar.Item(count);
+    for(unsigned i = 0; i < count; i++) {
+        ar.Item(times[i]);
+        ar.Item(devs[i]);
+        ar.Item(units[i]);
+    }
+    return ar.GetData();
+}
+
+void SystemClock::RestoreState(const string &state) {
+    SimulationContext::Scope scope(*context);
+    vector<AvrDevice *> &devices = context->GetDumpManager()->devices;
+    SnapshotArchive ar(state);
+    SystemClockOffset time = 0;
+
+    ar.Tag("simulavr state");
+    ar.Item(time);
+    ar.Check(devices.size(), "count of devices");
+    for(unsigned i = 0; i < devices.size(); i++)
+        devices[i]->Snapshot(ar);
+
+    // saved entries replace entries of devices and their hardware units
+    ar.Tag("time table");
+    vector<TimeTable::Entry> entries, restored;
+    syncMembers->GetEntries(entries);
+    unsigned count = 0;
+    ar.Item(count);
+    for(unsigned i = 0; i < count; i++) {
+        SystemClockOffset t = 0;
+        int dev = 0, unit = 0;
+        ar.Item(t);
+        ar.Item(dev);
+        ar.Item(unit);
+        if(dev < 0 || dev >= (int)devices.size())
+            avr_error("simulation state doesn't fit: device %d not found", dev);
+        SimulationMember *m = devices[dev];
+        if(unit >= 0)
+            m = dynamic_cast<SimulationMember *>(devices[dev]->GetHardware(unit));
+        if(m == NULL)
+            avr_error("simulation state doesn't fit: hardware unit %d of device %d isn't a simulation member", unit, dev);
+        if(unit < 0) {
+            // a device, which isn't scheduled (gdb mode), stays so
+            bool scheduled = false;
+            for(unsigned j = 0; j < entries.size(); j++)
+                if(entries[j].second == m)
+                    scheduled = true;
+            if(!scheduled)
+                continue;
+        }
+        restored.push_back(TimeTable::Entry(t, m));
+    }
+    if(!ar.AtEnd())
+        avr_error("simulation state doesn't fit: unexpected data at end");
+
+    // other members keep distance to current time
+    for(unsigned i = 0; i < entries.size(); i++) {
+        int dev, unit;
+        if(!FindStateMember(devices, entries[i].second, dev, unit))
+            restored.push_back(TimeTable::Entry(time + (entries[i].first - currentTime), entries[i].second));
+    }
+    syncMembers->Clear();
+    for(unsigned i = 0; i < restored.size(); i++)
+        syncMembers->Insert(restored[i].first, restored[i].second);
+    currentTime = time;
+}
+
+void SystemClock::SaveStateToFile(const string &filename) {
+    string state = SaveState();
+    ofstream f(filename.c_str(), ios::out | ios::binary);
+    if(!f)
+        avr_error("Can't open '%s'", filename.c_str());
+    f.write(state.data(), state.size());
+    if(!f)
+        avr_error("Can't write '%s'", filename.c_str());
+}
+
+void SystemClock::RestoreStateFromFile(const string &filename) {
+    ifstream f(filename.c_str(), ios::in | ios::binary);
+    if(!f)
+        avr_error("Can't open '%s'", filename.c_str());
+    ostringstream state;
+    state << f.rdbuf();
+    RestoreState(state.str());
+}
+
 SystemClock& SystemClock::Instance() {
-    static SystemClock obj;
-    return obj;
+    return SimulationContext::Current().GetSystemClock();
 }
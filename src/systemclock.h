@@ -28,10 +28,13 @@
 
 #include <map>
 #include <vector>
+#include <string>
 
 #include "systemclocktypes.h"
 
 class SimulationMember;
+class SimulationContext;
+class ParallelSimulation;
 
 /** A heap data structure optimized for obtaining Value of the smallest Key.
     Example MinHeap<SystemClockOffset, SimulationMember*>. */
@@ -53,17 +56,105 @@ public:
         RemoveAtPositionAndInsertInternal(k, v, 0);
     }
     void RemoveAtPositionAndInsert(Key k, Value v, unsigned pos) {
-        if(k < (*this)[pos-1].first)
-            InsertInternal(k, v, pos);
+        if(pos > 0 && k < (*this)[(pos + 1) / 2 - 1].first)
+            InsertInternal(k, v, pos + 1);
         else
             RemoveAtPositionAndInsertInternal(k, v, pos);
     }
+    void RemoveAtPosition(unsigned pos);
 protected:
     // These are internal because a bad value of `pos' could violate the binary heap invariant.
     void InsertInternal(Key k, Value v, unsigned pos);
     void RemoveAtPositionAndInsertInternal(Key k, Value v, unsigned pos);
 };
 
+//! Time table of SystemClock, orders simulation members by time of next step
+/*! This is the interface for the scheduler backend of SystemClock, see
+    SystemClock::SetTimeTable. Members scheduled for the same time are returned
+    in order of insertion. */
+class TimeTable {
+    public:
+        typedef std::pair<SystemClockOffset, SimulationMember *> Entry;
+
+        virtual ~TimeTable() {}
+        //! Returns true, if no simulation member is scheduled
+        virtual bool IsEmpty() const = 0;
+        //! Returns the time of the earliest scheduled simulation member
+        virtual SystemClockOffset GetMinimumKey() = 0;
+        //! Removes the earliest simulation member and returns it, time is returned in key
+        virtual SimulationMember *RemoveMinimum(SystemClockOffset &key) = 0;
+        //! Schedules a simulation member for the given time
+        virtual void Insert(SystemClockOffset key, SimulationMember *member) = 0;
+        //! Removes a simulation member, returns false, if it wasn't scheduled
+        virtual bool Remove(SimulationMember *member) = 0;
+        //! Appends all scheduled simulation members with their time to list
+        virtual void GetEntries(std::vector<Entry> &entries) const = 0;
+        //! Removes all simulation members
+        virtual void Clear() = 0;
+};
+
+//! Key of HeapTimeTable, members with equal time are ordered by insertion
+struct HeapTimeKey {
+    SystemClockOffset time;
+    unsigned long long inserted; //!< insert count of HeapTimeTable
+
+    HeapTimeKey() {}
+    HeapTimeKey(SystemClockOffset t, unsigned long long i): time(t), inserted(i) {}
+    bool operator<(const HeapTimeKey &k) const { return time < k.time || (time == k.time && inserted < k.inserted); }
+    bool operator<=(const HeapTimeKey &k) const { return !(k < *this); }
+};
+
+//! Time table based on a binary heap, the default backend of SystemClock
+class HeapTimeTable: public TimeTable {
+    protected:
+        MinHeap<HeapTimeKey, SimulationMember *> heap;
+        unsigned long long insertCount; //!< count of inserts, orders members with equal time
+
+    public:
+        HeapTimeTable();
+
+        bool IsEmpty() const { return heap.IsEmpty(); }
+        SystemClockOffset GetMinimumKey() { return heap.GetMinimumKey().time; }
+        SimulationMember *RemoveMinimum(SystemClockOffset &key);
+        void Insert(SystemClockOffset key, SimulationMember *member) { heap.Insert(HeapTimeKey(key, insertCount++), member); }
+        bool Remove(SimulationMember *member);
+        void GetEntries(std::vector<Entry> &entries) const;
+        void Clear() { heap.clear(); }
+};
+
+//! Time table based on a timing wheel (calendar queue)
+/*! The time is divided into slots of 2^widthBits ns, the wheel has 2^slotBits
+    slots. A member is stored in the slot of its time modulo wheel size, so
+    insert and removal of the earliest member don't depend on the number of
+    scheduled members. Members with identical time (for example cores with
+    the same clock) are batched in one slot and stay in order of insertion.
+    Members scheduled more than one wheel turn ahead are found by a full
+    scan, which is only necessary, if the next turn is completly empty. */
+class TimingWheel: public TimeTable {
+    public:
+        TimingWheel(unsigned slotBits = 8, unsigned widthBits = 6);
+
+        bool IsEmpty() const { return count == 0; }
+        SystemClockOffset GetMinimumKey() { return slots[FindMinimum()].front().first; }
+        SimulationMember *RemoveMinimum(SystemClockOffset &key);
+        void Insert(SystemClockOffset key, SimulationMember *member);
+        bool Remove(SimulationMember *member);
+        void GetEntries(std::vector<Entry> &entries) const;
+        void Clear();
+
+    protected:
+        std::vector<std::vector<Entry> > slots; //!< entries of a slot, ordered by time
+        unsigned widthBits;     //!< slot width is 2^widthBits ns
+        unsigned slotMask;      //!< number of slots - 1
+        unsigned count;         //!< number of scheduled members
+        SystemClockOffset lastTime; //!< no member is scheduled before this time
+        int minSlot;            //!< slot with earliest member or -1, if unknown
+
+        unsigned SlotOf(SystemClockOffset t) const { return (unsigned)(t >> widthBits) & slotMask; }
+        //! Returns slot of earliest member, table must not be empty
+        unsigned FindMinimum();
+};
+
 //! Class to store and manage the central simulation time
 /*! This acts as a time table, a simulation member gets a place on this ordered
     table, where it should be called next time, the placement depends on the
@@ -82,13 +173,33 @@ protected:
 class SystemClock
 {
     private:
-        SystemClock(); //!< Do not this constructor from application code!
+        SystemClock(SimulationContext *context); //!< Do not this constructor from application code!
         SystemClock(const SystemClock &); //!< Do not this constructor from application code!
+        ~SystemClock();
+
+        friend class SimulationContext;
+        friend class ParallelSimulation;
+
+        SimulationContext *context; //!< context, which owns this clock
+        volatile bool breakMessage; //!< stop request by Stop
+        int breakSignals;           //!< count of SIGINT/SIGTERM signals on start of Run/Endless
+        ParallelSimulation *parallel; //!< parallel mode, see SetParallel, NULL if not used
+
+        //! Returns true, if Stop was called or a signal was caught since start of Run/Endless
+        bool IsBreak(void) const;
+        //! Clear stop request and install signal handlers before entering a loop
+        void StartLoop(void);
+        //! Step all members, which are scheduled before limit, used by ParallelSimulation
+        /*! If stopOnResult is set, it stops on a nonzero return of Step, this
+          value is returned in result. Returns the count of steps. */
+        long RunUntil(SystemClockOffset limit, bool stopOnResult, int &result);
 
     protected:
         SystemClockOffset currentTime;  //!< time in [ns] since start of simulation
-        MinHeap<SystemClockOffset, SimulationMember *> syncMembers;  //!< earliest first
+        TimeTable *syncMembers;  //!< earliest first
         std::vector<SimulationMember*> asyncMembers; //!< List of asynchron working simulation members, will be called every step!
+        bool asyncMembersRemoved; //!< some entries in asyncMembers are removed (NULL)
+        SystemClockOffset runLimit; //!< end time of a running Run or RunTimeRange call (maximum time in Endless), -1 otherwise
         
     public:
         //! Returns the current simulation time
@@ -103,6 +214,14 @@ class SystemClock
         void Add(SimulationMember *dev);
         //! Add a async simulation member, this will be called every simulation step.
         void AddAsyncMember(SimulationMember *dev);
+        //! Remove a async simulation member
+        /*! A async member should only be registered as long as it has something
+            to do, it can add itself again later with AddAsyncMember. It's safe
+            to call this from Step method of a async member. */
+        void RemoveAsyncMember(SimulationMember *dev);
+        //! Replace the time table (scheduler backend), SystemClock takes ownership
+        /*! Already scheduled simulation members are moved to the new time table. */
+        void SetTimeTable(TimeTable *tt);
         //! Process one simulation step
         int Step(bool &untilCoreStepFinished);
         //! Run simulation endless till SIGINT or SIGTERM signal, return the number of CPU cycles
@@ -111,9 +230,35 @@ class SystemClock
         long Run(SystemClockOffset maxRunTime);
         //! Like Run method, but stops on breakpoint or after given time offset
         long RunTimeRange(SystemClockOffset timeRange);
-        //! Returns the central SystemClock instance for the application
-        /*! There will be only one instance on a application! */
+        //! Run following Endless, Run and RunTimeRange calls in parallel threads
+        /*! Each device is stepped together with its simulation members (see
+          SimulationMember::GetDevice) on one of up to threads threads, all
+          other simulation members on the calling thread. The threads run till
+          a common horizon and wait there for each other, the horizon moves by
+          a time quantum. This is the given quantum or the smallest propagation
+          delay of a net between devices (see Net::SetPropagationDelay), what
+          is shorter.
+
+          Output changes on a net between devices are transfered at the
+          horizon, so the other devices (and also the device itself, if it
+          reads back the pin) see them delayed by up to one quantum. Several
+          changes of a pin within one quantum reach the other devices at the
+          same time, so the quantum should be shorter than the fastest signal
+          on such a net. Trace output and dumps aren't possible in parallel
+          mode, simulation members must not access other devices as through
+          nets. threads = 0 switches back to sequential simulation. */
+        void SetParallel(unsigned int threads, SystemClockOffset quantum = 0);
+        //! Returns the SystemClock instance of the current simulation context
+        /*! There is one instance for each SimulationContext, see there. */
         static SystemClock& Instance();
+        //! Returns the time, till a synchronous simulation member could skip steps
+        /*! This is the next step time of the other synchronous simulation members
+            or the end time of a running Run or RunTimeRange call, what comes first.
+            Events caused by other members can't occur before. Returns -1, if the
+            clock is driven by single Step calls and there isn't a other member,
+            so nothing may be skipped. Called from Step of a simulation member, so this
+            member isn't in time table at this moment. */
+        SystemClockOffset GetSkipLimit(void);
         //! Moves the given simulation member to a new place in time table
         /*! The next time, simulation member will be called, is calculated as a
             given offset to current simulation time + 1.
@@ -122,10 +267,30 @@ class SystemClock
         void Reschedule(SimulationMember *sm, SystemClockOffset newTime);
         //! Switches trace mode for all current found simulation members
         void SetTraceModeForAllMembers(int trace_on);
-        //! Stop Run/Endless or Step asynchronously
+        //! Stop Run/Endless or Step asynchronously, can be called from other threads
         void Stop();
         //! Resets the simulation time and clears table for simulation members and async simulation members
         void ResetClock(void);
+        //! Returns the state of the simulation as compact binary data
+        /*! This contains the simulation time, the state of all devices of the
+          simulation context (core, registers, RAM, EEPROM, flash if it was
+          written by the program, all hardware units, pending interrupts) and
+          the places of devices and their hardware units in time table. Async
+          members and other simulation members, like pin drivers or scripts,
+          aren't saved, also not breakpoints, traces and statistics. */
+        std::string SaveState(void);
+        //! Restore a state, which was returned by SaveState
+        /*! The simulation has to consist of the same devices (same type,
+          created in the same order) with the same program, like on saving.
+          Otherwise or on a damaged state a error is raised, then the
+          simulation is in a undefined state. Other simulation members keep
+          their distance in time to the current simulation time. A device,
+          which isn't in time table (gdb mode), isn't added. */
+        void RestoreState(const std::string &state);
+        //! Save the simulation state to a file, see SaveState
+        void SaveStateToFile(const std::string &filename);
+        //! Restore the simulation state from a file, see RestoreState
+        void RestoreStateFromFile(const std::string &filename);
 };
 
 #endif
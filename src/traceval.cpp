@@ -26,11 +26,16 @@
 #include <fstream>
 #include <sstream>
 #include <stdlib.h>
+#include "config.h"
+#ifdef HAVE_ZLIB
+#   include <zlib.h>
+#endif
 #include "helper.h"
 #include "traceval.h"
 #include "avrdevice.h"
 #include "avrerror.h"
 #include "systemclock.h"
+#include "simulationcontext.h"
 
 using namespace std;
 
@@ -45,7 +50,10 @@ TraceValue::TraceValue(size_t bits,
     v(0xaffeaffe),
     f(0),
     _written(false),
-    _enabled(false) {}
+    _enabled(false),
+    dumpGen(0),
+    dumpMask(0),
+    dumpOrder(0) {}
 
 size_t TraceValue::bits() const { return b; }
 
@@ -65,10 +73,21 @@ bool TraceValue::enabled() const { return _enabled; }
 
 void TraceValue::enable() { _enabled=true; }
 
+void TraceValue::setFlags(int flags) {
+    // queue value for dumping on first access in this cycle, if it is active
+    // in the current DumpManager instance
+    if((f == 0) && (dumpGen != 0)) {
+        DumpManager *dm = DumpManager::Active();
+        if(dm != NULL && dumpGen == dm->generation)
+            dm->changed.push_back(this);
+    }
+    f |= flags;
+}
+
 void TraceValue::change(unsigned val) {
     // this is mostly the same as write, but dosn't set WRITE nor _written flag!
     if ((v != val) || !_written) {
-        f |= CHANGE;
+        setFlags(CHANGE);
         v = val;
     }
 }
@@ -76,22 +95,22 @@ void TraceValue::change(unsigned val) {
 void TraceValue::change(unsigned val, unsigned mask) {
     // this is mostly the same as write, but dosn't set WRITE nor _written flag!
     if (((v & mask) != (val & mask)) || !_written) {
-        f |= CHANGE;
+        setFlags(CHANGE);
         v = (v & ~mask) | (val & mask);
     }
 }
 
 void TraceValue::write(unsigned val) {
     if ((v != val) || !_written) {
-        f |= CHANGE;
+        setFlags(CHANGE | WRITE);
         v = val;
-    }
-    f |= WRITE;
+    } else
+        setFlags(WRITE);
     _written = true;
 }
 
 void TraceValue::read() {
-    f |= READ;
+    setFlags(READ);
 }
 
 bool TraceValue::written() const { return _written;  }
@@ -124,7 +143,7 @@ void TraceValue::cycle() {
             break;
         }
         if (v!=nv) {
-            f|=CHANGE;
+            setFlags(CHANGE);
             _written=true; // FIXME: This detection can fail!
             v=nv;
         }
@@ -143,9 +162,12 @@ void TraceValue::dump(Dumper &d) {
     if (f&CHANGE) {
         d.markChange(this);
     }
-    f=0;
 }
 
+bool TraceValue::polled() const { return shadow != 0; }
+
+void TraceValue::clear_flags() { f = 0; }
+
 char TraceValue::VcdBit(int bitNo) const {
     if (_written)
         return (v & (1 << bitNo)) ? '1' : '0';
@@ -288,26 +310,47 @@ TraceSet* TraceValueRegister::GetAllTraceValuesRecursive(void) {
 TraceValueCoreRegister::TraceValueCoreRegister(TraceValueRegister *parent):
     TraceValueRegister(parent, "CORE") {}
 
-void TraceValueCoreRegister::RegisterTraceSetValue(TraceValue *t, const std::string &name, const size_t size) {
+TraceSet* TraceValueCoreRegister::_tvr_getTraceSet(const std::string &name, const size_t size) {
     // seek TraceSet
-    TraceSet *set = NULL;
     for(setmap_t::iterator i = _tvr_valset.begin(); i != _tvr_valset.end(); i++) {
-        if(name == *(i->first)) {
-            set = i->second;
-            break;
-        }
+        if(name == *(i->first))
+            return i->second;
     }
     // create TraceSet, if not found
-    if(set == NULL) {
-        set = new TraceSet(size, NULL);
-        string *s = new string(name);
-        pair<string*, TraceSet*> v(s, set);
-        _tvr_valset.insert(v);
+    TraceSet *set = new TraceSet(size, NULL);
+    string *s = new string(name);
+    pair<string*, TraceSet*> v(s, set);
+    _tvr_valset.insert(v);
+    return set;
+}
+
+TraceValue* TraceValueCoreRegister::_tvr_getSetValue(TraceSet *set, size_t index) {
+    if((*set)[index] == NULL) {
+        factorymap_t::iterator f = _tvr_factories.find(set);
+        if(f != _tvr_factories.end()) {
+            // the factory registers the new value in set by RegisterTraceSetValue
+            for(setmap_t::iterator i = _tvr_valset.begin(); i != _tvr_valset.end(); i++) {
+                if(i->second == set) {
+                    f->second->CreateTraceSetValue(*(i->first), index);
+                    break;
+                }
+            }
+        }
     }
+    return (*set)[index];
+}
+
+void TraceValueCoreRegister::RegisterTraceSetValue(TraceValue *t, const std::string &name, const size_t size) {
+    TraceSet *set = _tvr_getTraceSet(name, size);
     // set TraceValue to set[idx]
     (*set)[t->index()] = t;
 }
 
+void TraceValueCoreRegister::RegisterTraceSet(const std::string &name, const size_t size, TraceSetFactory *factory) {
+    TraceSet *set = _tvr_getTraceSet(name, size);
+    _tvr_factories[set] = factory;
+}
+
 TraceValue* TraceValueCoreRegister::GetTraceValueByName(const std::string &name) {
     TraceValue *res = TraceValueRegister::GetTraceValueByName(name);
     if(res == NULL) {
@@ -320,7 +363,7 @@ TraceValue* TraceValueCoreRegister::GetTraceValueByName(const std::string &name)
                 if(n == *(i->first)) {
                     TraceSet *set = i->second;
                     if(v < (int)set->size())
-                        res = (*set)[v];
+                        res = _tvr_getSetValue(set, v);
                     break;
                 }
             }
@@ -347,8 +390,11 @@ void TraceValueCoreRegister::_tvr_insertTraceValuesToSet(TraceSet &t) {
     // now insert also all values from _tvr_valset
     for(setmap_t::iterator i = _tvr_valset.begin(); i != _tvr_valset.end(); i++) {
         TraceSet* s = i->second;
-        for(TraceSet::iterator j = s->begin(); j != s->end(); j++)
-            t.push_back(*j);
+        for(size_t j = 0; j < s->size(); j++) {
+            TraceValue *tv = _tvr_getSetValue(s, j);
+            if(tv != NULL)
+                t.push_back(tv);
+        }
     }
 }
 
@@ -380,19 +426,17 @@ bool WarnUnknown::enabled(const TraceValue *t) const {
     return true;
 }
 
-void DumpVCD::valout(const TraceValue *v) {
-    osbuffer << 'b';
-    for (int i = v->bits()-1; i >= 0; i--)
-        osbuffer << v->VcdBit(i);
-
-}
-
-void DumpVCD::flushbuffer(void) {
-    if(changesWritten) {
-        *os << osbuffer.str();
-        changesWritten = false;
-    }
-    osbuffer.str("");
+//! size of DumpVCD output buffer
+static const size_t vcdBufferSize = 256 * 1024;
+
+//! Build a VCD identifier code out of the printable ASCII characters '!' to '~'
+static string vcdIdCode(size_t num) {
+    string s;
+    do {
+        s += (char)('!' + num % 94);
+        num /= 94;
+    } while(num);
+    return s;
 }
 
 DumpVCD::DumpVCD(ostream *_os,
@@ -402,8 +446,12 @@ DumpVCD::DumpVCD(ostream *_os,
     tscale(_tscale),
     rs(rstrobes),
     ws(wstrobes),
-    changesWritten(false),
-    os(_os)
+    os(_os),
+    gzos(NULL),
+    buffer(vcdBufferSize),
+    bufferPos(0),
+    cycleTime(0),
+    cycleTimeWritten(true)
 {}
 
 DumpVCD::DumpVCD(const std::string &_name,
@@ -413,9 +461,24 @@ DumpVCD::DumpVCD(const std::string &_name,
     tscale(_tscale),
     rs(rstrobes),
     ws(wstrobes),
-    changesWritten(false),
-    os(new ofstream(_name.c_str()))
-{}
+    os(NULL),
+    gzos(NULL),
+    buffer(vcdBufferSize),
+    bufferPos(0),
+    cycleTime(0),
+    cycleTimeWritten(true)
+{
+    if(_name.size() > 3 && _name.substr(_name.size() - 3) == ".gz") {
+#ifdef HAVE_ZLIB
+        gzos = gzopen(_name.c_str(), "wb");
+        if(gzos == NULL)
+            avr_error("Can't open '%s'", _name.c_str());
+#else
+        avr_error("Can't write compressed VCD file '%s', simulavr is build without zlib", _name.c_str());
+#endif
+    } else
+        os = new ofstream(_name.c_str());
+}
 
 void DumpVCD::setActiveSignals(const TraceSet &act) {
     tv=act;
@@ -426,15 +489,19 @@ void DumpVCD::setActiveSignals(const TraceSet &act) {
             avr_error("Trace value would be twice in VCD list.");
         id2num[*i]=n++;
     }
+    ids.resize(n*(1+rs+ws));
+    for (size_t i=0; i<ids.size(); i++)
+        ids[i]=vcdIdCode(i);
 }
 
 void DumpVCD::start() {
-    *os <<
+    ostringstream hs;
+    hs <<
         "$version\n"
         "\tSimulavr VCD dump file generator\n"
         "$end\n";
     
-    *os << "$timescale 1" << tscale << " $end\n";
+    hs << "$timescale 1" << tscale << " $end\n";
     typedef TraceSet::iterator iter;
     unsigned n=0;
     for (iter i=tv.begin();
@@ -447,126 +514,412 @@ void DumpVCD::start() {
         for (ld=s.size()-1; ld>0; ld--)
             if (s[ld]=='.') break;
     
-        *os << "$scope module " << s.substr(0, ld) << " $end\n";
-        *os << "$var wire " << (*i)->bits() << ' ' << n*(1+rs+ws) << ' ' << s.substr(ld+1, s.size()-1) << " $end\n";
+        hs << "$scope module " << s.substr(0, ld) << " $end\n";
+        hs << "$var wire " << (*i)->bits() << ' ' << ids[n*(1+rs+ws)] << ' ' << s.substr(ld+1, s.size()-1) << " $end\n";
         if (rs)
-            *os << "$var wire 1 " << n*(1+rs+ws)+1 << ' ' << s.substr(ld+1, s.size()-1)+"_R" << " $end\n";
+            hs << "$var wire 1 " << ids[n*(1+rs+ws)+1] << ' ' << s.substr(ld+1, s.size()-1)+"_R" << " $end\n";
         if (ws)
-            *os << "$var wire 1 " << n*(1+rs+ws)+1+rs << ' ' << s.substr(ld+1, s.size()-1)+"_W" << " $end\n";
-        *os << "$upscope $end\n";
+            hs << "$var wire 1 " << ids[n*(1+rs+ws)+1+rs] << ' ' << s.substr(ld+1, s.size()-1)+"_W" << " $end\n";
+        hs << "$upscope $end\n";
         n++;
     }
-    *os << "$enddefinitions $end\n";
+    hs << "$enddefinitions $end\n";
+    append(hs.str());
 
     // mark initial state
-    changesWritten = true;
-    osbuffer << "#0\n$dumpvars\n";
+    append("#0\n$dumpvars\n");
     n=0;
     for (iter i=tv.begin();
          i!=tv.end(); i++) {
         valout(*i);
-        osbuffer << ' ' << n*(1+rs+ws) << '\n';
         // reset RS, WS
-        if (rs) {
-            osbuffer << "0" << n*(1+rs+ws)+1 << "\n";
-        }
-        if (ws) {
-            if (rs)
-                osbuffer << "0" << n*(1+rs+ws)+2 << "\n";
-            else
-                osbuffer << "0" << n*(1+rs+ws)+1 << "\n";
-        }
+        if (rs)
+            bitout('0', n*(1+rs+ws)+1);
+        if (ws)
+            bitout('0', n*(1+rs+ws)+1+rs);
         n++;
     }
-    osbuffer << "$end\n";
+    append("$end\n");
     flushbuffer();
 }
 
 void DumpVCD::cycle() {
-    // flush the buffer
-    flushbuffer();
-    
-    // write new time marker to buffer
-    SystemClockOffset clock=SystemClock::Instance().GetCurrentTime();
-    osbuffer << "#" << clock << '\n';
+    // remember new time marker, it's written with the first change
+    cycleTime=SystemClock::Instance().GetCurrentTime();
+    cycleTimeWritten=false;
 
     // reset RS, WS states
     for (size_t i=0; i<marked.size(); i++)
-        osbuffer << "0" << marked[i] << "\n";
-    if(marked.size())
-        changesWritten = true;
+        bitout('0', marked[i]);
     marked.clear();
 }
 
 void DumpVCD::stop() {
+    // write a last time marker to report end of dump
+    cycleTime=SystemClock::Instance().GetCurrentTime();
+    cycleTimeWritten=false;
+    timeout();
+
     // flush the buffer
     flushbuffer();
-    
-    // write a last time marker to report end of dump
-    SystemClockOffset clock=SystemClock::Instance().GetCurrentTime();
-    *os << "#" << clock << '\n';
-    
-    os->flush(); // flush stream
+    if(os != NULL)
+        os->flush(); // flush stream
 }
 
 void DumpVCD::markRead(const TraceValue *t) {
     if (rs) {
         // mark read cycle
-        osbuffer << "1" << id2num[t]*(1+rs+ws)+1 << "\n";
-        changesWritten = true;
+        size_t num=id2num[t]*(1+rs+ws)+1;
+        bitout('1', num);
         // mark to disable @ next cycle
-        marked.push_back(id2num[t]*(1+rs+ws)+1);
+        marked.push_back(num);
     }
 }
 
 void DumpVCD::markWrite(const TraceValue *t) {
     if (ws) {
-        osbuffer << "1" << id2num[t]*(1+rs+ws)+1+rs << "\n";
-        changesWritten = true;
-        marked.push_back(id2num[t]*(1+rs+ws)+1+rs);
+        size_t num=id2num[t]*(1+rs+ws)+1+rs;
+        bitout('1', num);
+        marked.push_back(num);
     }
 }
 
 void DumpVCD::markChange(const TraceValue *t) {
     valout(t);
-    osbuffer << " " << id2num[t]*(1+rs+ws) << "\n";
-    changesWritten = true;
+}
+
+void DumpVCD::valout(const TraceValue *v) {
+    size_t num=id2num[v]*(1+rs+ws);
+    int bits=v->bits();
+    if (bits == 1) {
+        bitout(v->VcdBit(0), num);
+        return;
+    }
+    const string &id=ids[num];
+    timeout();
+    reserve(bits+id.size()+3);
+    char *p=&buffer[bufferPos];
+    char *s=p;
+    *p++='b';
+    // leading '0' can be omitted, also a row of leading 'x' or 'z' can be
+    // shortened to one, the vector is then left extended by VCD reader
+    int i=bits-1;
+    char c=v->VcdBit(i);
+    if (c=='0' || c=='1') {
+        while (c=='0' && i>0)
+            c=v->VcdBit(--i);
+    } else {
+        while (i>0 && v->VcdBit(i-1)==c)
+            i--;
+    }
+    *p++=c;
+    while (i>0)
+        *p++=v->VcdBit(--i);
+    *p++=' ';
+    for (size_t j=0; j<id.size(); j++)
+        *p++=id[j];
+    *p++='\n';
+    bufferPos+=p-s;
+}
+
+void DumpVCD::bitout(char bit, size_t num) {
+    const string &id=ids[num];
+    timeout();
+    reserve(id.size()+2);
+    buffer[bufferPos++]=bit;
+    for (size_t j=0; j<id.size(); j++)
+        buffer[bufferPos++]=id[j];
+    buffer[bufferPos++]='\n';
+}
+
+void DumpVCD::timeout(void) {
+    if (cycleTimeWritten)
+        return;
+    cycleTimeWritten=true;
+    char digits[24];
+    int n=0;
+    unsigned long long t=cycleTime;
+    do {
+        digits[n++]='0'+t%10;
+        t/=10;
+    } while (t);
+    reserve(n+2);
+    buffer[bufferPos++]='#';
+    while (n>0)
+        buffer[bufferPos++]=digits[--n];
+    buffer[bufferPos++]='\n';
+}
+
+void DumpVCD::reserve(size_t size) {
+    if (bufferPos+size > buffer.size()) {
+        flushbuffer();
+        if (size > buffer.size())
+            buffer.resize(size);
+    }
+}
+
+void DumpVCD::append(const string &s) {
+    reserve(s.size());
+    s.copy(&buffer[bufferPos], s.size());
+    bufferPos+=s.size();
+}
+
+void DumpVCD::flushbuffer(void) {
+    if (bufferPos==0)
+        return;
+#ifdef HAVE_ZLIB
+    if (gzos != NULL)
+        gzwrite((gzFile)gzos, &buffer[0], bufferPos);
+    else
+#endif
+        os->write(&buffer[0], bufferPos);
+    bufferPos=0;
 }
 
 bool DumpVCD::enabled(const TraceValue *t) const {
     return id2num.find(t)!=id2num.end();
 }
 
-DumpVCD::~DumpVCD() { delete os; }
+DumpVCD::~DumpVCD() {
+    flushbuffer();
+#ifdef HAVE_ZLIB
+    if (gzos != NULL)
+        gzclose((gzFile)gzos);
+#endif
+    delete os;
+}
+
+//! size of raw data in a DumpBinary block, before a new block is started
+static const size_t binBlockSize = 64 * 1024;
+
+//! append unsigned LEB128 number to string
+static void binVarint(string &s, unsigned long long v) {
+    while(v >= 0x80) {
+        s += (char)((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    s += (char)v;
+}
+
+//! append little endian number with size bytes to string
+static void binFixed(string &s, unsigned long long v, int size) {
+    for(int i = 0; i < size; i++) {
+        s += (char)(v & 0xff);
+        v >>= 8;
+    }
+}
+
+//! append string with length to string
+static void binString(string &s, const string &v) {
+    binVarint(s, v.size());
+    s += v;
+}
+
+//! get value of a trace value, as it is stored by DumpBinary
+static unsigned binValue(const TraceValue *t, bool &known) {
+    if(t->bits() == 1) {
+        known = true;
+        switch(t->VcdBit(0)) {
+            case '0': return DumpBinary::STATE_0;
+            case '1': return DumpBinary::STATE_1;
+            case 'z': return DumpBinary::STATE_Z;
+            default:  return DumpBinary::STATE_X;
+        }
+    }
+    known = t->written();
+    return t->value();
+}
+
+DumpBinary::DumpBinary(const std::string &name,
+                       const std::string &_tscale) :
+    tscale(_tscale),
+    os(new ofstream(name.c_str(), ios::out | ios::binary)),
+    blockTime(0),
+    lastTime(0),
+    cycleTime(0),
+    strobed(false),
+    filePos(0)
+{
+    if(!os->good())
+        avr_error("Can't open '%s'", name.c_str());
+}
+
+void DumpBinary::setActiveSignals(const TraceSet &act) {
+    tv = act;
+    unsigned n = 0;
+    for(TraceSet::const_iterator i = act.begin(); i != act.end(); i++) {
+        if(id2num.find(*i) != id2num.end())
+            avr_error("Trace value would be twice in binary trace list.");
+        id2num[*i] = n++;
+    }
+    lastValue.resize(n, 0);
+    lastKnown.resize(n, false);
+}
 
-int DumpManager::_devidx = 0;
-DumpManager *::DumpManager::_instance = NULL;
+void DumpBinary::start() {
+    string h("SAVRBTR1");
+    binString(h, tscale);
+    binVarint(h, tv.size());
+    for(size_t i = 0; i < tv.size(); i++) {
+        binString(h, tv[i]->name());
+        binVarint(h, tv[i]->bits());
+        bool known;
+        lastValue[i] = binValue(tv[i], known);
+        lastKnown[i] = known;
+    }
+    output(h);
+    
+    cycleTime = SystemClock::Instance().GetCurrentTime();
+    beginBlock();
+}
+
+void DumpBinary::cycle() {
+    cycleTime = SystemClock::Instance().GetCurrentTime();
+    if(block.size() >= binBlockSize && !strobed) {
+        flushBlock();
+        beginBlock();
+    } else if(strobed)
+        timeout(true); // a time step marks end of read and write strobes
+}
+
+void DumpBinary::stop() {
+    cycleTime = SystemClock::Instance().GetCurrentTime();
+    timeout(strobed);
+    flushBlock();
+    
+    // time index and footer
+    unsigned long long indexPos = filePos;
+    string idx;
+    binVarint(idx, index.size());
+    for(size_t i = 0; i < index.size(); i++) {
+        binFixed(idx, index[i].first, 8);
+        binFixed(idx, index[i].second, 8);
+    }
+    binFixed(idx, indexPos, 8);
+    idx += "SAVRBIX1";
+    output(idx);
+    os->flush();
+}
+
+void DumpBinary::markRead(const TraceValue *t) {
+    event(t, READ);
+    strobed = true;
+}
+
+void DumpBinary::markWrite(const TraceValue *t) {
+    event(t, WRITE);
+    strobed = true;
+}
+
+void DumpBinary::markChange(const TraceValue *t) {
+    size_t n = id2num[t];
+    bool known;
+    unsigned v = binValue(t, known);
+    if(!known) {
+        if(lastKnown[n])
+            event(t, UNKNOWN);
+    } else if(!lastKnown[n] || v != lastValue[n]) {
+        event(t, CHANGE);
+        // zigzag encoded difference
+        unsigned d = v - lastValue[n];
+        binVarint(block, (d << 1) ^ (((int)d < 0) ? 0xffffffff : 0));
+        lastValue[n] = v;
+    }
+    lastKnown[n] = known;
+}
+
+void DumpBinary::timeout(bool force) {
+    if(cycleTime != lastTime || force) {
+        binVarint(block, 0);
+        binVarint(block, cycleTime - lastTime);
+        lastTime = cycleTime;
+        strobed = false;
+    }
+}
+
+void DumpBinary::event(const TraceValue *t, Event kind) {
+    timeout();
+    binVarint(block, (((unsigned long long)id2num[t] << 2) | kind) + 1);
+}
+
+void DumpBinary::beginBlock(void) {
+    blockTime = lastTime = cycleTime;
+    block.clear();
+    for(size_t i = 0; i < tv.size(); i++)
+        binVarint(block, ((unsigned long long)lastValue[i] << 1) | lastKnown[i]);
+}
+
+void DumpBinary::flushBlock(void) {
+    string h;
+    index.push_back(make_pair(filePos, blockTime));
+    binFixed(h, blockTime, 8);
+    binFixed(h, block.size(), 4);
+#ifdef HAVE_ZLIB
+    uLongf size = compressBound(block.size());
+    vector<Bytef> buf(size);
+    if(compress(&buf[0], &size, (const Bytef *)block.data(), block.size()) == Z_OK) {
+        binFixed(h, size, 4);
+        binFixed(h, 1, 1);
+        output(h);
+        output(string((const char *)&buf[0], size));
+        block.clear();
+        return;
+    }
+#endif
+    binFixed(h, block.size(), 4);
+    binFixed(h, 0, 1);
+    output(h);
+    output(block);
+    block.clear();
+}
+
+void DumpBinary::output(const string &data) {
+    os->write(data.data(), data.size());
+    filePos += data.size();
+}
+
+bool DumpBinary::enabled(const TraceValue *t) const {
+    return id2num.find(t) != id2num.end();
+}
+
+DumpBinary::~DumpBinary() { delete os; }
+
+unsigned DumpManager::lastGeneration = 0;
 
 DumpManager* DumpManager::Instance(void) {
-    if(_instance == NULL)
-        _instance = new DumpManager();
-    return _instance;
+    return SimulationContext::Current().GetDumpManager();
+}
+
+DumpManager* DumpManager::Active(void) {
+    return SimulationContext::Current().dumpManager;
 }
 
 void DumpManager::Reset(void) {
-    if(_instance) {
-        _instance->detachAvrDevices();
-        delete _instance;
+    SimulationContext &ctx = SimulationContext::Current();
+    if(ctx.dumpManager) {
+        ctx.dumpManager->detachAvrDevices();
+        delete ctx.dumpManager;
     }
-    _instance = NULL;
-    _devidx = 0;
+    ctx.dumpManager = NULL;
 }
 
 DumpManager::DumpManager() {
     singleDeviceApp = false;
+    devidx = 0;
+    // instances can be created in parallel threads, see SimulationContext
+#ifdef __GNUC__
+    generation = __sync_add_and_fetch(&lastGeneration, 1);
+#else
+    generation = ++lastGeneration;
+#endif
 }
 
 void DumpManager::appendDeviceName(std::string &s) {
-    _devidx++;
-    if(singleDeviceApp && _devidx > 1)
+    devidx++;
+    if(singleDeviceApp && devidx > 1)
         avr_error("Can't create device name twice, because it's a single device application");
     if(!singleDeviceApp)
-        s += "Dev" + int2str(_devidx);
+        s += "Dev" + int2str(devidx);
 }
 
 void DumpManager::registerAvrDevice(AvrDevice* dev) {
@@ -617,20 +970,40 @@ void DumpManager::SetSingleDeviceApp(void) {
 }
 
 void DumpManager::addDumper(Dumper *dump, const TraceSet &vals) {
+    // check, if dumper exists in dumps list
+    if(find(dumps.begin(), dumps.end(), dump) != dumps.end())
+        avr_error("Internal error: Dumper already registered.");
+    if(dumps.size() >= sizeof(unsigned) * 8)
+        avr_error("Too many dumpers, only %d are possible", (int)(sizeof(unsigned) * 8));
+
     // enable values and insert into active list, if not there
     for(TraceSet::const_iterator i = vals.begin(); i != vals.end(); i++) {
-        (*i)->enable();
-        if(find(active.begin(), active.end(), *i) == active.end())
-            active.push_back(*i);
+        TraceValue *t = *i;
+        t->enable();
+        if(t->dumpGen != generation) {
+            t->dumpGen = generation;
+            t->dumpMask = 0;
+            t->dumpOrder = active.size();
+            active.push_back(t);
+            if(t->polled())
+                polledValues.push_back(t);
+            // accessed before activation, dump it on next cycle
+            if(t->f != 0)
+                changed.push_back(t);
+        }
     }
     
-    // check, if dumper exists in dumps list
-    if(find(dumps.begin(), dumps.end(), dump) != dumps.end())
-        avr_error("Internal error: Dumper already registered.");
     // set active signals for dumper
     dump->setActiveSignals(vals);
     // and insert dumper in dumps list
     dumps.push_back(dump);
+    
+    // update dumper mask on active values
+    unsigned bit = 1 << (dumps.size() - 1);
+    for(TraceSet::iterator i = active.begin(); i != active.end(); i++) {
+        if(dump->enabled(*i))
+            (*i)->dumpMask |= bit;
+    }
 }
 
 const TraceSet& DumpManager::all() {
@@ -661,19 +1034,35 @@ void DumpManager::start() {
 
 }
 
+bool DumpManager::dumpOrderLess(const TraceValue *a, const TraceValue *b) {
+    return a->dumpOrder < b->dumpOrder;
+}
+
 void DumpManager::cycle() {
     // First, call the Dumpers
     for (size_t i=0; i<dumps.size(); i++)
         dumps[i]->cycle();
 
-    // And then, update the TraceValues and dump them
-    for (TraceSet::iterator i=active.begin();
-         i!=active.end(); i++) {
+    // Then update the TraceValues, which can't report changes by itself
+    for (TraceSet::iterator i=polledValues.begin();
+         i!=polledValues.end(); i++)
         (*i)->cycle();
+
+    if (changed.empty())
+        return;
+
+    // And dump the accessed values in order of activation
+    if (changed.size() > 1)
+        sort(changed.begin(), changed.end(), dumpOrderLess);
+    for (TraceSet::iterator i=changed.begin();
+         i!=changed.end(); i++) {
+        TraceValue *t = *i;
         for (size_t j=0; j<dumps.size(); j++)
-            if (dumps[j]->enabled(*i))
-                (*i)->dump(*dumps[j]);
+            if (t->dumpMask & (1 << j))
+                t->dump(*dumps[j]);
+        t->clear_flags();
     }
+    changed.clear();
 }
 
 void DumpManager::stopApplication(void) {
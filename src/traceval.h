@@ -31,6 +31,8 @@
 #include <map>
 #include <vector>
 
+#include "systemclocktypes.h"
+
 /* TODO, notes:
 
    ===========================================================   
@@ -169,13 +171,17 @@ class TraceValue {
         //! Gives the current set of flag readings
         Atype flags() const;
         
-        //! Called at least once for each cycle if this trace value is activated
+        //! Called once for each cycle if this trace value is activated and polled
         /*! This may check for updates to an underlying referenced value etc.
           and update the flags accordingly. */
         virtual void cycle();
         
-        /*! Dump the state or state change somewhere. This also resets the current
-          flags. */
+        /*! Returns true, if this value can't report changes by itself and has
+          to be checked by cycle() on every clock cycle. */
+        virtual bool polled() const;
+        
+        /*! Dump the state or state change somewhere. The flags are reset by
+          DumpManager after all dumpers have seen them. */
         virtual void dump(Dumper &d);
         
         /*! Give back VCD coding of a bit */
@@ -185,8 +191,12 @@ class TraceValue {
         //! Clear all access flags
         void clear_flags();
         friend class TraceKeeper;
+        friend class DumpManager;
         
     private:
+        //! Set access flags and queue value on DumpManager on first access in a cycle
+        void setFlags(int flags);
+        
         std::string _name;
     
         int _index;
@@ -209,6 +219,13 @@ class TraceValue {
         /*! Note that it must additionally be enabled in the particular
           Dumper. */
         bool _enabled;
+        
+        //! DumpManager generation, which has activated this value (0 = never)
+        unsigned dumpGen;
+        //! bit n is set, if DumpManager dumper n traces this value
+        unsigned dumpMask;
+        //! position in DumpManager active list, keeps the dump order stable
+        unsigned dumpOrder;
 };
 
 class TraceValueOutput: public TraceValue {
@@ -262,9 +279,8 @@ class Dumper {
         virtual ~Dumper() {}
     
         //! Returns true iff tracing a particular value is enabled
-        /*! FIXME: For a lot of values to trace,
-          checking enabled() each time by doing find on a map()
-          could be slow. Here is potential for more optimization! */
+        /*! This is asked only once per value, when the dumper is added to
+          DumpManager. */
         virtual bool enabled(const TraceValue *t) const=0;
 };
 
@@ -281,7 +297,12 @@ class WarnUnknown : public Dumper {
         AvrDevice *core;
 };
 
-/*! Produces value change dump files. */
+/*! Produces value change dump files.
+
+  Signals get short identifier codes out of the printable ASCII characters,
+  value changes are formatted into a reusable output buffer, which is written
+  in bulk, and time markers are only written, if there are changes at this
+  time. */
 class DumpVCD : public Dumper {
     
     public:
@@ -290,6 +311,8 @@ class DumpVCD : public Dumper {
             const bool rstrobes = false, const bool wstrobes = false);
         
         //! Create tracer with time scale tscale for output file name
+        /*! If name ends with ".gz", the output will be gzip compressed. This
+          is only available, if simulavr is build with zlib. */
         DumpVCD(const std::string &name, const std::string &tscale = "ns",
             const bool rstrobes = false, const bool wstrobes = false);
         
@@ -301,7 +324,7 @@ class DumpVCD : public Dumper {
         //! Writes a last time marker
         void stop();
     
-        //! Writes next clock cycle and resets all RS and WS states
+        //! Remembers next clock cycle and resets all RS and WS states
         void cycle();
     
         /*! Iff rstrobes is true, this will mark reads on a special
@@ -323,31 +346,155 @@ class DumpVCD : public Dumper {
         std::map<const TraceValue*, size_t> id2num;
         const std::string tscale;
         const bool rs, ws;
-        bool changesWritten;
+        
+        //! identifier code for every VCD signal (1+rs+ws signals for each value)
+        std::vector<std::string> ids;
         
         // list of signals marked last cycle
         std::vector<int> marked;
         std::ostream *os;
-    
-        // buffer for change data
-        std::stringstream osbuffer;
+        //! gzip output stream (gzFile), if output is compressed
+        void *gzos;
         
-        void valout(const TraceValue *v);
+        //! buffer for output data
+        std::vector<char> buffer;
+        //! count of bytes used in buffer
+        size_t bufferPos;
+        
+        //! time of current cycle
+        SystemClockOffset cycleTime;
+        //! time marker for current cycle is written
+        bool cycleTimeWritten;
         
-        //! writes content of osbuffer to os and empty osbuffer afterwards
+        //! writes value and signal identifier of v to buffer
+        void valout(const TraceValue *v);
+        //! writes a single bit change of signal num to buffer
+        void bitout(char bit, size_t num);
+        //! writes time marker for current cycle to buffer, if not done
+        void timeout(void);
+        //! make sure, that size bytes are free in buffer
+        void reserve(size_t size);
+        //! appends string to buffer
+        void append(const std::string &s);
+        
+        //! writes content of buffer to output and empty buffer afterwards
         void flushbuffer(void);
 };
 
+/*! Produces a compact binary change log (simulavr binary trace).
+
+  The file is written in blocks, which are compressed with zlib (if simulavr is
+  build with zlib), and has a time index at the end, so that a reader can start
+  at any block. Use trace2vcd to convert it to a VCD file.
+
+  File layout, "varint" is an unsigned LEB128 number, "u8", "u32" and "u64" are
+  little endian numbers of fixed size, a string is a varint length followed by
+  the characters:
+
+  - header: 8 bytes magic "SAVRBTR1", timescale string, varint count of
+    signals, then for every signal the name string and varint count of bits
+  - blocks: u64 start time, u32 raw size, u32 stored size, u8 compression
+    (0 = stored, 1 = zlib), followed by the stored data. Raw data starts with
+    the state of all signals at start time, varint (value << 1 | known) for
+    every signal. Then follows a stream of varint tags: tag 0 is followed by
+    a varint time step, all following events happen at this time. Other tags
+    are (signal << 2 | kind) + 1, kind is one of the Event values. A CHANGE is
+    followed by a varint zigzag encoded difference to the last signal value.
+  - index: varint count of blocks, then for every block u64 file offset and
+    u64 start time
+  - footer: u64 file offset of index and 8 bytes magic "SAVRBIX1"
+
+  Values of 1 bit signals are stored as the VCD bit state, see VcdState. All
+  blocks start with the full state, so each block can be decoded alone. A time
+  step with no following event marks the end of read and write strobes. */
+class DumpBinary : public Dumper {
+    
+    public:
+        //! Event kinds in block data
+        enum Event {
+            CHANGE = 0, //!< value changed
+            UNKNOWN = 1, //!< value changed to unknown (not written) state
+            READ = 2, //!< read access
+            WRITE = 3 //!< write access
+        };
+        
+        //! Stored values for 1 bit signals
+        enum VcdState {
+            STATE_0 = 0,
+            STATE_1 = 1,
+            STATE_Z = 2,
+            STATE_X = 3
+        };
+        
+        //! Create tracer with time scale tscale for output file name
+        DumpBinary(const std::string &name, const std::string &tscale = "ns");
+        
+        void setActiveSignals(const TraceSet &act);
+        
+        //! Writes header and the initial state
+        void start();
+        
+        //! Writes last time marker, last block and the time index
+        void stop();
+        
+        //! Remembers next clock cycle, starts a new block, if current is full
+        void cycle();
+        
+        void markRead(const TraceValue *t);
+        void markWrite(const TraceValue *t);
+        void markChange(const TraceValue *t);
+        
+        bool enabled(const TraceValue *t) const;
+        ~DumpBinary();
+        
+    private:
+        TraceSet tv;
+        std::map<const TraceValue*, size_t> id2num;
+        const std::string tscale;
+        std::ostream *os;
+        
+        //! last dumped value of every signal
+        std::vector<unsigned> lastValue;
+        //! last dumped known state of every signal
+        std::vector<bool> lastKnown;
+        
+        //! raw data of current block
+        std::string block;
+        //! start time of current block
+        SystemClockOffset blockTime;
+        //! time of last time step in current block
+        SystemClockOffset lastTime;
+        //! time of current cycle
+        SystemClockOffset cycleTime;
+        //! there are read or write strobes in last written time step
+        bool strobed;
+        //! stream position, where next block is written
+        unsigned long long filePos;
+        //! time index, file offset and start time of every block
+        std::vector<std::pair<unsigned long long, SystemClockOffset> > index;
+        
+        //! writes time step for current cycle, if not done or if force is true
+        void timeout(bool force = false);
+        //! writes an event tag for value t
+        void event(const TraceValue *t, Event kind);
+        //! begin a new block with the current state of all signals
+        void beginBlock(void);
+        //! compress and write current block
+        void flushBlock(void);
+        //! write raw data to output and count file position
+        void output(const std::string &data);
+};
+
 /*! Manages all active Dumper instances for a given AvrDevice.
   It also manages all trace values and sets them active as necessary.
   */
 class DumpManager {
     
     public:
-        //! Singleton class access.
+        //! Returns the instance of the current simulation context, creates it, if necessary
         static DumpManager* Instance(void);
         
-        //! Reset DumpManager instance (e.g. delete available instance)
+        //! Reset DumpManager instance of the current simulation context (e.g. delete available instance)
         static void Reset(void);
 
         //! Tell DumpManager, that we have only one device
@@ -372,7 +519,10 @@ class DumpManager {
         void stopApplication(void);
         
         /*! Process one AVR clock cycle. Must be done after the AVR did all
-          processing so that changed values etc. can be collected. */
+          processing so that changed values etc. can be collected.
+          
+          Only polled values are visited on every cycle, all other values queue
+          themselves on the first access in a cycle, see TraceValue::setFlags. */
         void cycle();
     
         //! Destroys the DumpManager instance and shut down all dumpers
@@ -399,10 +549,17 @@ class DumpManager {
         
     private:
         friend class TraceValueRegister;
+        friend class TraceValue;
         friend class AvrDevice;
+        friend class SimulationContext;
+        friend class ParallelSimulation;
+        friend class SystemClock;
         
         //! Private instance constructor
         DumpManager();
+
+        //! Returns the instance of the current simulation context or NULL, if there is none
+        static DumpManager* Active(void);
         
         //! append a unique device name to a string
         void appendDeviceName(std::string &s);
@@ -416,6 +573,9 @@ class DumpManager {
         //! detach all devices
         void detachAvrDevices();
 
+        //! Sort predicate for dump order of values in active list
+        static bool dumpOrderLess(const TraceValue *a, const TraceValue *b);
+
         //! Seek value by name in all devices
         TraceValue* seekValueByName(const std::string &name);
         
@@ -424,6 +584,10 @@ class DumpManager {
         
         //! Set of active tracing values
         TraceSet active;
+        //! Active values, which have to be checked by TraceValue::cycle()
+        TraceSet polledValues;
+        //! Active values, which are accessed in current cycle
+        TraceSet changed;
         //! Set of all traceable values (placeholder instance for all() method)
         TraceSet _all;
         
@@ -433,8 +597,12 @@ class DumpManager {
         //! Device list
         std::vector<AvrDevice*> devices;
 
-        static int _devidx;
-        static DumpManager *_instance;
+        //! Count of device names created by appendDeviceName
+        int devidx;
+        //! Unique number of this instance, invalidates values of a former instance
+        unsigned generation;
+        //! Last generation number given to a instance
+        static unsigned lastGeneration;
 };
 
 //! Build a register for TraceValue's
@@ -501,13 +669,29 @@ class TraceValueRegister {
         TraceSet* GetAllTraceValuesRecursive(void);
 };
 
+//! Creates TraceValue's of a TraceSet in TraceValueCoreRegister on demand
+class TraceSetFactory {
+
+    public:
+        virtual ~TraceSetFactory() {}
+        //! Create the TraceValue for set name and index and register it by RegisterTraceSetValue
+        virtual void CreateTraceSetValue(const std::string &name, size_t index) = 0;
+};
+
 /*! TraceValueRegister for CORE group to hold also RAM groups */
 class TraceValueCoreRegister: public TraceValueRegister {
   
     private:
         typedef std::map<std::string*, TraceSet*> setmap_t; //!< type of TraceSet map
+        typedef std::map<TraceSet*, TraceSetFactory*> factorymap_t; //!< type of factory map
         
         setmap_t _tvr_valset; //!< the registered TraceValue's
+        factorymap_t _tvr_factories; //!< factories for TraceValue's, which are created on demand
+
+        //! Get the TraceSet for name, create it, if not found
+        TraceSet* _tvr_getTraceSet(const std::string &name, const size_t size);
+        //! Get TraceValue from set, create it by factory, if necessary
+        TraceValue* _tvr_getSetValue(TraceSet *set, size_t index);
 
         //! helper function to split up into name an number tail
         int _tvr_numberindex(const std::string &str);
@@ -529,6 +713,8 @@ class TraceValueCoreRegister: public TraceValueRegister {
         
         //! Registers a TraceValue for this register
         void RegisterTraceSetValue(TraceValue *t, const std::string &name, const size_t size);
+        //! Registers a TraceSet, which values are created on demand by factory
+        void RegisterTraceSet(const std::string &name, const size_t size, TraceSetFactory *factory);
         //! Get a here registered TraceValue by it's name
         virtual TraceValue* GetTraceValueByName(const std::string &name);
 };